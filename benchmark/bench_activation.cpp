@@ -0,0 +1,212 @@
+// activation throughput and accuracy
+// the naive libm layer against the optimized layer picked for this cpu in exact and fast mode
+// accuracy is the max ulp and max absolute error against a double precision reference over [-20, 20]
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "modelbin.h"
+#include "paramdict.h"
+#include <chrono>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct activation_func
+{
+    const char* name;
+    const char* type;
+    // param 0 and 1, unset when nan
+    float p0;
+    float p1;
+    double (*ref)(double);
+};
+
+static double ref_sigmoid(double x)
+{
+    return 1.0 / (1.0 + exp(-x));
+}
+
+static double ref_swish(double x)
+{
+    return x / (1.0 + exp(-x));
+}
+
+static double ref_hardsigmoid(double x)
+{
+    double v = x * (double)0.2f + 0.5;
+    return v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+}
+
+static double ref_hardswish(double x)
+{
+    double v = x * (double)(1.f / 6) + 0.5;
+    return x * (v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v));
+}
+
+static double ref_clip(double x)
+{
+    return x < -6.0 ? -6.0 : (x > 6.0 ? 6.0 : x);
+}
+
+static double ref_elu(double x)
+{
+    return x < 0.0 ? expm1(x) : x;
+}
+
+static double ref_gelu(double x)
+{
+    return 0.5 * x * erfc(-x * 0.70710678118654752);
+}
+
+// x * sigmoid(2u), 1 + tanh(u) would cancel in double as well
+static double ref_gelu_tanh(double x)
+{
+    double u = 0.79788456080286536 * (x + 0.044715 * x * x * x);
+    return x / (1.0 + exp(-2.0 * u));
+}
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static tinyinfer::Layer* create(const activation_func& f, int isa)
+{
+    tinyinfer::ParamDict pd;
+    if (!isnan(f.p0))
+        pd.set(0, f.p0);
+    if (!isnan(f.p1))
+        pd.set(1, f.p1);
+
+    const int type = tinyinfer::layer_to_index(f.type);
+    tinyinfer::Layer* op = isa < 0 ? tinyinfer::create_layer(type) : tinyinfer::create_layer_isa(type, isa);
+    op->load_param(pd);
+    return op;
+}
+
+// best ms of one in place forward, the input is restored outside the timed region
+static double bench_layer(const activation_func& f, int isa, const tinyinfer::Mat& bottom, int loop, const tinyinfer::Option& opt)
+{
+    tinyinfer::Layer* op = create(f, isa);
+    op->create_pipeline(opt);
+
+    tinyinfer::Mat m = bottom.clone();
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        memcpy(m.data, bottom.data, bottom.total() * sizeof(float));
+
+        double start = now_ms();
+        op->forward_inplace(m, opt);
+        double t = now_ms() - start;
+
+        // the first run is warm up
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return best;
+}
+
+static double ulp_error(float y, double r)
+{
+    if (isnan(r) || isnan(y))
+        return isnan(r) && isnan(y) ? 0.0 : 1e30;
+    if (isinf((float)r) || isinf(y))
+        return y == (float)r ? 0.0 : 1e30;
+
+    const float rf = (float)fabs(r);
+    const double ulp = rf == 0.f ? FLT_TRUE_MIN : (double)nextafterf(rf, INFINITY) - rf;
+    return fabs(y - r) / ulp;
+}
+
+// max ulp and max absolute error over the sweep
+static void accuracy(const activation_func& f, int isa, const tinyinfer::Mat& x, const tinyinfer::Option& opt, double& max_ulp, double& max_abs)
+{
+    tinyinfer::Layer* op = create(f, isa);
+    op->create_pipeline(opt);
+
+    tinyinfer::Mat y = x.clone();
+    op->forward_inplace(y, opt);
+
+    op->destroy_pipeline(opt);
+    delete op;
+
+    max_ulp = 0.0;
+    max_abs = 0.0;
+    for (int i = 0; i < x.w; i++)
+    {
+        const double r = f.ref((double)x[i]);
+        const double e = ulp_error(y[i], r);
+        const double a = fabs(y[i] - r);
+        if (e > max_ulp)
+            max_ulp = e;
+        if (a > max_abs)
+            max_abs = a;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=10]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 10;
+
+    tinyinfer::Option opt_fast = opt;
+    opt_fast.use_fast_activation = true;
+
+    const activation_func funcs[] = {
+        {"sigmoid", "Sigmoid", NAN, NAN, ref_sigmoid},
+        {"swish", "Swish", NAN, NAN, ref_swish},
+        {"hardsigmoid", "HardSigmoid", 0.2f, 0.5f, ref_hardsigmoid},
+        {"hardswish", "HardSwish", 1.f / 6, 0.5f, ref_hardswish},
+        {"clip", "Clip", -6.f, 6.f, ref_clip},
+        {"elu", "ELU", 1.f, NAN, ref_elu},
+        {"gelu", "GELU", 0.f, NAN, ref_gelu},
+        {"gelu tanh", "GELU", 1.f, NAN, ref_gelu_tanh},
+    };
+
+    // a mobilenet sized feature map
+    tinyinfer::Mat bottom(56, 56, 64);
+    for (int q = 0; q < bottom.c; q++)
+    {
+        float* ptr = bottom.channel(q);
+        for (int i = 0; i < bottom.w * bottom.h; i++)
+        {
+            ptr[i] = (float)(rand() % 16000 - 8000) / 1000.f;
+        }
+    }
+
+    const int n = 1 << 21;
+    tinyinfer::Mat sweep(n);
+    for (int i = 0; i < n; i++)
+    {
+        sweep[i] = -20.f + 40.f * i / (n - 1);
+    }
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d  %d x %d x %d\n", opt.num_threads, loop, tinyinfer::cpu_isa_level(), bottom.w, bottom.h, bottom.c);
+    fprintf(stderr, "%-12s %9s %9s %9s | %9s %9s %9s | %9s %9s %9s\n", "ms", "naive", "exact", "fast", "ulp naive", "exact", "fast", "abs naive", "exact", "fast");
+    for (int i = 0; i < (int)(sizeof(funcs) / sizeof(activation_func)); i++)
+    {
+        const activation_func& f = funcs[i];
+
+        double t_naive = bench_layer(f, TINYINFER_ISA_NAIVE, bottom, loop, opt);
+        double t_exact = bench_layer(f, -1, bottom, loop, opt);
+        double t_fast = bench_layer(f, -1, bottom, loop, opt_fast);
+
+        double ulp_naive, ulp_exact, ulp_fast;
+        double abs_naive, abs_exact, abs_fast;
+        accuracy(f, TINYINFER_ISA_NAIVE, sweep, opt, ulp_naive, abs_naive);
+        accuracy(f, -1, sweep, opt, ulp_exact, abs_exact);
+        accuracy(f, -1, sweep, opt_fast, ulp_fast, abs_fast);
+
+        fprintf(stderr, "%-12s %9.3f %9.3f %9.3f | %9.3g %9.3g %9.3g | %9.2g %9.2g %9.2g\n", f.name, t_naive, t_exact, t_fast, ulp_naive, ulp_exact, ulp_fast, abs_naive, abs_exact, abs_fast);
+    }
+
+    return 0;
+}
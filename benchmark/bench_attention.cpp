@@ -0,0 +1,168 @@
+// attention of 12 heads of 64 over growing sequences
+// the unfused Permute, Gemm, Softmax, Gemm chain that writes the whole seq x seq score matrix
+// against the fused MultiHeadAttention layer, naive row by row and the tiled x86 kernel
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "net.h"
+#include "paramdict.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static tinyinfer::Mat random_mat(int w, int h, int c)
+{
+    tinyinfer::Mat m(w, h, c);
+    for (int q = 0; q < m.c; q++)
+    {
+        float* ptr = m.channel(q);
+        for (int i = 0; i < m.w * m.h; i++)
+        {
+            ptr[i] = (float)(rand() % 1000) / 1000.f - 0.5f;
+        }
+    }
+
+    return m;
+}
+
+static int load_net(tinyinfer::Net& net, const std::string& param)
+{
+    FILE* pp = tmpfile();
+    FILE* bp = tmpfile();
+    if (!pp || !bp)
+        return -1;
+
+    fwrite(param.data(), 1, param.size(), pp);
+    rewind(pp);
+
+    int ret = net.load_param(pp);
+    if (ret == 0)
+        ret = net.load_model(bp);
+
+    fclose(pp);
+    fclose(bp);
+    return ret;
+}
+
+// best ms of one extract
+static double bench_net(const tinyinfer::Net& net, const tinyinfer::Mat& q, const tinyinfer::Mat& k, const tinyinfer::Mat& v, int loop)
+{
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        tinyinfer::Extractor ex = net.create_extractor();
+        ex.input("q", q);
+        ex.input("k", k);
+        ex.input("v", v);
+
+        double start = now_ms();
+        tinyinfer::Mat out;
+        ex.extract("out", out);
+        double t = now_ms() - start;
+
+        // the first run is warm up
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    return best;
+}
+
+// best ms of one forward of the fused layer at the given isa, -1 for the fastest
+static double bench_layer(int isa, const std::vector<tinyinfer::Mat>& bottoms, int loop, const tinyinfer::Option& opt)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(1, 0.125f);
+
+    const int type = tinyinfer::layer_to_index("MultiHeadAttention");
+    tinyinfer::Layer* op = isa < 0 ? tinyinfer::create_layer(type) : tinyinfer::create_layer_isa(type, isa);
+    op->load_param(pd);
+    op->create_pipeline(opt);
+
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        std::vector<tinyinfer::Mat> tops(1);
+        double start = now_ms();
+        op->forward(bottoms, tops, opt);
+        double t = now_ms() - start;
+
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=5]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 5;
+
+    const int heads = 12;
+    const int head_dim = 64;
+
+    const std::string unfused = "202303\n"
+                                "7 7\n"
+                                "Input            q 0 1 q\n"
+                                "Input            k 0 1 k\n"
+                                "Input            v 0 1 v\n"
+                                "Permute          kt 1 1 k kt 0=1\n"
+                                "Gemm             scores 2 1 q kt scores 0=0.125\n"
+                                "Softmax          p 1 1 scores p 0=-1\n"
+                                "Gemm             out 2 1 p v out\n";
+
+    const std::string fused = "202303\n"
+                              "4 4\n"
+                              "Input            q 0 1 q\n"
+                              "Input            k 0 1 k\n"
+                              "Input            v 0 1 v\n"
+                              "MultiHeadAttention out 3 1 q k v out 1=0.125\n";
+
+    tinyinfer::Net net_unfused;
+    tinyinfer::Net net_fused;
+    net_unfused.opt = opt;
+    net_fused.opt = opt;
+    if (load_net(net_unfused, unfused) != 0 || load_net(net_fused, fused) != 0)
+    {
+        fprintf(stderr, "load attention net failed\n");
+        return -1;
+    }
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d  heads = %d  head_dim = %d\n", opt.num_threads, loop, tinyinfer::cpu_isa_level(), heads, head_dim);
+    fprintf(stderr, "%-8s %10s %10s %10s %10s %10s %12s\n", "seq", "unfused", "naive", "fused", "net", "GFLOPS", "scores MB");
+
+    const int seqs[] = {128, 512, 1024, 2048};
+    for (int i = 0; i < (int)(sizeof(seqs) / sizeof(int)); i++)
+    {
+        const int seq = seqs[i];
+
+        std::vector<tinyinfer::Mat> bottoms(3);
+        bottoms[0] = random_mat(head_dim, seq, heads);
+        bottoms[1] = random_mat(head_dim, seq, heads);
+        bottoms[2] = random_mat(head_dim, seq, heads);
+
+        double t_unfused = bench_net(net_unfused, bottoms[0], bottoms[1], bottoms[2], loop);
+        double t_naive = seq <= 512 ? bench_layer(TINYINFER_ISA_NAIVE, bottoms, loop, opt) : 0.0;
+        double t_fused = bench_layer(-1, bottoms, loop, opt);
+        double t_net = bench_net(net_fused, bottoms[0], bottoms[1], bottoms[2], loop);
+
+        // q k^T and p v, the memory the unfused chain spends on scores alone
+        const double flops = 4.0 * heads * seq * seq * head_dim;
+        const double scores_mb = (double)heads * seq * seq * sizeof(float) / (1 << 20);
+        fprintf(stderr, "%-8d %10.3f %10.3f %10.3f %10.3f %10.2f %12.1f\n", seq, t_unfused, t_naive, t_fused, t_net, flops / t_fused / 1e6, scores_mb);
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+// an inception style block, four branches concatenated along the channels and flattened for a classifier
+// bytes copied and ms per forward with the concat producers writing into their slice of the output and without
+#include "cpu.h"
+#include "mat.h"
+#include "net.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* block_param = "202303\n"
+                                  "9 12\n"
+                                  "Input            data 0 1 data 0=28 1=28 2=256\n"
+                                  "Split            splitncnn_0 1 4 data data_0 data_1 data_2 data_3\n"
+                                  "Pooling          b0 1 1 data_0 b0 0=0 1=3 3=1\n"
+                                  "Pooling          b1 1 1 data_1 b1 0=1 1=3 3=1\n"
+                                  "Pooling          b2 1 1 data_2 b2 0=0 1=5 3=2\n"
+                                  "Pooling          b3 1 1 data_3 b3 0=1 1=1\n"
+                                  "ReLU             b3_relu 1 1 b3 b3_relu\n"
+                                  "Concat           cat 4 1 b0 b1 b2 b3_relu cat 0=0\n"
+                                  "Flatten          flat 1 1 cat flat\n";
+
+static int load_block(tinyinfer::Net& net)
+{
+    FILE* pp = tmpfile();
+    FILE* bp = tmpfile();
+    if (!pp || !bp)
+        return -1;
+
+    fwrite(block_param, 1, strlen(block_param), pp);
+    rewind(pp);
+
+    int ret = net.load_param(pp);
+    if (ret == 0)
+        ret = net.load_model(bp);
+
+    fclose(pp);
+    fclose(bp);
+    return ret;
+}
+
+// best ms of one forward and the bytes it copied, the first forward records the concat shape and is warm up
+static double bench_block(const tinyinfer::Net& net, const tinyinfer::Mat& in, int loop, size_t& copied)
+{
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        tinyinfer::Extractor ex = net.create_extractor();
+        ex.input("data", in);
+
+        tinyinfer::reset_mat_copy_bytes();
+        double start = now_ms();
+        tinyinfer::Mat out;
+        ex.extract("flat", out);
+        double t = now_ms() - start;
+        copied = tinyinfer::get_mat_copy_bytes();
+
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=10]
+    int num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 10;
+
+    tinyinfer::Mat in(28, 28, 256);
+    for (int q = 0; q < in.c; q++)
+    {
+        float* ptr = in.channel(q);
+        for (int i = 0; i < in.w * in.h; i++)
+        {
+            ptr[i] = (float)(rand() % 2000 - 1000) / 1000.f;
+        }
+    }
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d  %d x %d x %d\n", num_threads, loop, tinyinfer::cpu_isa_level(), in.w, in.h, in.c);
+    fprintf(stderr, "%-16s %9s %12s\n", "", "ms", "MB copied");
+    for (int inplace = 0; inplace < 2; inplace++)
+    {
+        tinyinfer::Net net;
+        net.opt.num_threads = num_threads;
+        net.opt.use_inplace_concat = inplace == 1;
+        if (load_block(net) != 0)
+        {
+            fprintf(stderr, "load block failed\n");
+            return -1;
+        }
+
+        size_t copied = 0;
+        double t = bench_block(net, in, loop, copied);
+
+        fprintf(stderr, "%-16s %9.3f %12.3f\n", inplace ? "inplace concat" : "copy concat", t, copied / (1024.0 * 1024.0));
+    }
+
+    return 0;
+}
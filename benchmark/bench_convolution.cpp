@@ -0,0 +1,147 @@
+// convolution throughput in GFLOPS on resnet and mobilenet layer shapes, depthwise ones included
+// the naive layer against the optimized layer picked for this cpu, with and without winograd
+#include "allocator.h"
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "modelbin.h"
+#include "paramdict.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct conv_shape
+{
+    const char* name;
+    int w;
+    int h;
+    int c;
+    int outch;
+    int kernel;
+    int stride;
+    int pad;
+    int group;
+};
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void randomize(tinyinfer::Mat& m)
+{
+    for (int q = 0; q < m.c; q++)
+    {
+        float* ptr = m.channel(q);
+        for (int i = 0; i < m.w * m.h; i++)
+        {
+            ptr[i] = (float)(rand() % 2000 - 1000) / 1000.f;
+        }
+    }
+}
+
+// best ms of one forward
+static double bench_layer(const conv_shape& s, int isa, const tinyinfer::Mat& bottom, const tinyinfer::Mat& weight, const tinyinfer::Mat& bias, int loop, const tinyinfer::Option& opt)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, s.outch);
+    pd.set(1, s.kernel);
+    pd.set(3, s.stride);
+    pd.set(4, s.pad);
+    pd.set(5, 1);
+    pd.set(6, (int)weight.total());
+    pd.set(7, s.group);
+    pd.set(9, 1);
+
+    const int type = s.group > 1 ? tinyinfer::LayerType::ConvolutionDepthWise : tinyinfer::LayerType::Convolution;
+    tinyinfer::Layer* op = isa < 0 ? tinyinfer::create_layer(type) : tinyinfer::create_layer_isa(type, isa);
+    op->load_param(pd);
+
+    tinyinfer::Mat weights[2] = {weight, bias};
+    op->load_model(tinyinfer::ModelBinFromMatArray(weights));
+    op->create_pipeline(opt);
+
+    tinyinfer::Mat top;
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        double start = now_ms();
+        op->forward(bottom, top, opt);
+        double t = now_ms() - start;
+
+        // the first run is warm up
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return best;
+}
+
+static double gflops(const conv_shape& s, double ms)
+{
+    const int outw = (s.w + 2 * s.pad - s.kernel) / s.stride + 1;
+    const int outh = (s.h + 2 * s.pad - s.kernel) / s.stride + 1;
+    return 2.0 * outw * outh * s.outch * (s.c / s.group) * s.kernel * s.kernel / (ms * 1e6);
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=10]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 10;
+
+    // scratch buffers come from a pool as they do inside a net, so the timing is free of page faults
+    tinyinfer::PoolAllocator workspace_allocator;
+    opt.workspace_allocator = &workspace_allocator;
+
+    const conv_shape shapes[] = {
+        {"resnet50 conv1", 224, 224, 3, 64, 7, 2, 3, 1},
+        {"resnet50 2a 1x1", 56, 56, 64, 64, 1, 1, 0, 1},
+        {"resnet50 2a 3x3", 56, 56, 64, 64, 3, 1, 1, 1},
+        {"resnet50 2c 1x1", 56, 56, 64, 256, 1, 1, 0, 1},
+        {"resnet50 3a 3x3s2", 56, 56, 128, 128, 3, 2, 1, 1},
+        {"resnet50 3b 3x3", 28, 28, 128, 128, 3, 1, 1, 1},
+        {"resnet50 4b 3x3", 14, 14, 256, 256, 3, 1, 1, 1},
+        {"resnet50 5b 3x3", 7, 7, 512, 512, 3, 1, 1, 1},
+        {"resnet50 5c 1x1", 7, 7, 512, 2048, 1, 1, 0, 1},
+        {"mobilenet conv1", 224, 224, 3, 32, 3, 2, 1, 1},
+        {"mobilenet pw 112", 112, 112, 32, 64, 1, 1, 0, 1},
+        {"mobilenet pw 28", 28, 28, 256, 256, 1, 1, 0, 1},
+        {"mobilenet pw 14", 14, 14, 512, 512, 1, 1, 0, 1},
+        {"mobilenet pw 7", 7, 7, 1024, 1024, 1, 1, 0, 1},
+        {"mobilenet dw 112", 112, 112, 32, 32, 3, 1, 1, 32},
+        {"mobilenet dw 112s2", 112, 112, 64, 64, 3, 2, 1, 64},
+        {"mobilenet dw 28", 28, 28, 256, 256, 3, 1, 1, 256},
+        {"mobilenet dw 14", 14, 14, 512, 512, 3, 1, 1, 512},
+        {"mobilenet dw 7", 7, 7, 1024, 1024, 3, 1, 1, 1024},
+        {"mnasnet dw 5x5 28", 28, 28, 120, 120, 5, 1, 2, 120},
+        {"mnasnet dw 5x5 14s2", 28, 28, 240, 240, 5, 2, 2, 240},
+    };
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d\n", opt.num_threads, loop, tinyinfer::cpu_isa_level());
+    tinyinfer::Option opt_nowinograd = opt;
+    opt_nowinograd.use_winograd_convolution = false;
+
+    fprintf(stderr, "%-20s %5s %5s %5s %3s %3s %12s %12s %12s\n", "shape", "size", "inch", "outch", "k", "s", "naive", "no-winograd", "tinyinfer");
+    for (int i = 0; i < (int)(sizeof(shapes) / sizeof(conv_shape)); i++)
+    {
+        const conv_shape& s = shapes[i];
+
+        tinyinfer::Mat bottom(s.w, s.h, s.c);
+        tinyinfer::Mat weight(s.outch * (s.c / s.group) * s.kernel * s.kernel);
+        tinyinfer::Mat bias(s.outch);
+        randomize(bottom);
+        randomize(weight);
+        randomize(bias);
+
+        double t_naive = bench_layer(s, TINYINFER_ISA_NAIVE, bottom, weight, bias, 1, opt);
+        double t_nowinograd = bench_layer(s, -1, bottom, weight, bias, loop, opt_nowinograd);
+        double t_opt = bench_layer(s, -1, bottom, weight, bias, loop, opt);
+        fprintf(stderr, "%-20s %5d %5d %5d %3d %3d %12.2f %12.2f %12.2f\n", s.name, s.w, s.c, s.outch, s.kernel, s.stride, gflops(s, t_naive), gflops(s, t_nowinograd), gflops(s, t_opt));
+    }
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+// autoregressive decoding through a small pre-norm transformer decoder
+// the prompt runs once into a KVCache and every next token is one extractor over a single row
+// against recomputing the whole prefix for every token, which is what a net without a cache has to do
+#include "cpu.h"
+#include "kvcache.h"
+#include "mat.h"
+#include "net.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static float random_float(float scale)
+{
+    return ((float)(rand() % 2000) / 1000.f - 1.f) * scale;
+}
+
+struct decoder_shape
+{
+    int layers;
+    int dim;
+    int heads;
+    int ffn;
+};
+
+// one decoder layer, ln attention residual ln mlp residual
+//   x -> split -> ln1 -> split -> q k v -> attn -> proj -> add -> split -> ln2 -> up relu -> down -> add
+static void append_layer(std::string& param, int l, const decoder_shape& s)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf), "Split            l%d_split0 1 2 x%d l%d_a l%d_r\n", l, l, l, l);
+    param += buf;
+    snprintf(buf, sizeof(buf), "LayerNorm        l%d_ln1 1 1 l%d_a l%d_n 0=%d 1=1e-5\n", l, l, l, s.dim);
+    param += buf;
+    snprintf(buf, sizeof(buf), "Split            l%d_split1 1 3 l%d_n l%d_nq l%d_nk l%d_nv\n", l, l, l, l, l);
+    param += buf;
+
+    const char* qkv[] = {"q", "k", "v"};
+    for (int i = 0; i < 3; i++)
+    {
+        snprintf(buf, sizeof(buf), "InnerProduct     l%d_%s 1 1 l%d_n%s l%d_%s 0=%d 1=1 2=%d\n", l, qkv[i], l, qkv[i], l, qkv[i], s.dim, s.dim * s.dim);
+        param += buf;
+    }
+
+    snprintf(buf, sizeof(buf), "MultiHeadAttention l%d_attn 3 1 l%d_q l%d_k l%d_v l%d_o 0=%d 2=1 3=1\n", l, l, l, l, l, s.heads);
+    param += buf;
+    snprintf(buf, sizeof(buf), "InnerProduct     l%d_proj 1 1 l%d_o l%d_p 0=%d 1=1 2=%d\n", l, l, l, s.dim, s.dim * s.dim);
+    param += buf;
+    snprintf(buf, sizeof(buf), "BinaryOp         l%d_add0 2 1 l%d_r l%d_p l%d_y 0=0\n", l, l, l, l);
+    param += buf;
+    snprintf(buf, sizeof(buf), "Split            l%d_split2 1 2 l%d_y l%d_ya l%d_yr\n", l, l, l, l);
+    param += buf;
+    snprintf(buf, sizeof(buf), "LayerNorm        l%d_ln2 1 1 l%d_ya l%d_m 0=%d 1=1e-5\n", l, l, l, s.dim);
+    param += buf;
+    snprintf(buf, sizeof(buf), "InnerProduct     l%d_up 1 1 l%d_m l%d_u 0=%d 1=1 2=%d 9=1\n", l, l, l, s.ffn, s.dim * s.ffn);
+    param += buf;
+    snprintf(buf, sizeof(buf), "InnerProduct     l%d_down 1 1 l%d_u l%d_d 0=%d 1=1 2=%d\n", l, l, l, s.dim, s.ffn * s.dim);
+    param += buf;
+    snprintf(buf, sizeof(buf), "BinaryOp         l%d_add1 2 1 l%d_yr l%d_d x%d 0=0\n", l, l, l, l + 1);
+    param += buf;
+}
+
+// layernorm gamma and beta are raw, innerproduct weights carry the float32 tag and the bias is raw
+static void append_layernorm(std::vector<float>& weights, int dim)
+{
+    for (int i = 0; i < dim; i++)
+        weights.push_back(1.f + random_float(0.1f));
+    for (int i = 0; i < dim; i++)
+        weights.push_back(random_float(0.1f));
+}
+
+static void append_innerproduct(std::vector<float>& weights, int num_input, int num_output)
+{
+    weights.push_back(0.f);
+    const float scale = 1.f / sqrtf((float)num_input);
+    for (int i = 0; i < num_input * num_output; i++)
+        weights.push_back(random_float(scale));
+    for (int i = 0; i < num_output; i++)
+        weights.push_back(random_float(0.02f));
+}
+
+static int load_decoder(tinyinfer::Net& net, const decoder_shape& s)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "202303\n%d %d\n", 1 + 14 * s.layers, 1 + 18 * s.layers);
+
+    std::string param = buf;
+    param += "Input            data 0 1 x0\n";
+
+    std::vector<float> weights;
+    for (int l = 0; l < s.layers; l++)
+    {
+        append_layer(param, l, s);
+
+        append_layernorm(weights, s.dim);
+        for (int i = 0; i < 3; i++)
+            append_innerproduct(weights, s.dim, s.dim);
+        append_innerproduct(weights, s.dim, s.dim);
+        append_layernorm(weights, s.dim);
+        append_innerproduct(weights, s.dim, s.ffn);
+        append_innerproduct(weights, s.ffn, s.dim);
+    }
+
+    FILE* pp = tmpfile();
+    FILE* bp = tmpfile();
+    if (!pp || !bp)
+        return -1;
+
+    fwrite(param.data(), 1, param.size(), pp);
+    rewind(pp);
+    fwrite(weights.data(), sizeof(float), weights.size(), bp);
+    rewind(bp);
+
+    int ret = net.load_param(pp);
+    if (ret == 0)
+        ret = net.load_model(bp);
+
+    fclose(pp);
+    fclose(bp);
+    return ret;
+}
+
+// rows [y, y + n) of the embedded sequence
+static tinyinfer::Mat rows(const tinyinfer::Mat& m, int y, int n)
+{
+    tinyinfer::Mat r(m.w, n);
+    memcpy(r.data, m.row(y), (size_t)n * m.w * sizeof(float));
+    return r;
+}
+
+static int run(const tinyinfer::Net& net, const tinyinfer::Mat& in, tinyinfer::KVCache* cache, const char* out_name, tinyinfer::Mat& out)
+{
+    tinyinfer::Extractor ex = net.create_extractor();
+    ex.set_kv_cache(cache);
+    ex.input("x0", in);
+    return ex.extract(out_name, out);
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [prompt=64] [tokens=64]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    const int prompt = argc > 2 ? atoi(argv[2]) : 64;
+    const int tokens = argc > 3 ? atoi(argv[3]) : 64;
+
+    decoder_shape s;
+    s.layers = 4;
+    s.dim = 256;
+    s.heads = 4;
+    s.ffn = 1024;
+
+    tinyinfer::Net net;
+    net.opt = opt;
+    if (load_decoder(net, s) != 0)
+    {
+        fprintf(stderr, "load decoder failed\n");
+        return -1;
+    }
+
+    char out_name[16];
+    snprintf(out_name, sizeof(out_name), "x%d", s.layers);
+
+    // embeddings of the prompt and of the tokens generated after it
+    tinyinfer::Mat seq(s.dim, prompt + tokens);
+    for (int i = 0; i < (int)seq.total(); i++)
+        seq[i] = random_float(1.f);
+
+    fprintf(stderr, "num_threads = %d  isa = %d  layers = %d  dim = %d  heads = %d  ffn = %d  prompt = %d  tokens = %d\n", opt.num_threads, tinyinfer::cpu_isa_level(), s.layers, s.dim, s.heads, s.ffn, prompt, tokens);
+
+    tinyinfer::KVCache cache;
+    tinyinfer::Mat out_cached;
+
+    double start = now_ms();
+    int ret = run(net, rows(seq, 0, prompt), &cache, out_name, out_cached);
+    const double t_prefill = now_ms() - start;
+
+    start = now_ms();
+    for (int t = 0; ret == 0 && t < tokens; t++)
+    {
+        ret = run(net, rows(seq, prompt + t, 1), &cache, out_name, out_cached);
+    }
+    const double t_cached = now_ms() - start;
+
+    tinyinfer::Mat out_full;
+    start = now_ms();
+    for (int t = 0; ret == 0 && t < tokens; t++)
+    {
+        ret = run(net, rows(seq, 0, prompt + t + 1), 0, out_name, out_full);
+    }
+    const double t_full = now_ms() - start;
+
+    if (ret != 0)
+    {
+        fprintf(stderr, "decode failed %d\n", ret);
+        return -1;
+    }
+
+    // the last generated position both ways
+    float max_diff = 0.f;
+    const float* last = out_full.row(out_full.h - 1);
+    for (int i = 0; i < s.dim; i++)
+        max_diff = fmaxf(max_diff, fabsf(out_cached[i] - last[i]));
+
+    fprintf(stderr, "%-10s %12s %12s %12s\n", "", "ms", "ms/token", "tokens/s");
+    fprintf(stderr, "%-10s %12.3f %12.3f %12.1f\n", "prefill", t_prefill, t_prefill / prompt, prompt * 1000.0 / t_prefill);
+    fprintf(stderr, "%-10s %12.3f %12.3f %12.1f\n", "kv cache", t_cached, t_cached / tokens, tokens * 1000.0 / t_cached);
+    fprintf(stderr, "%-10s %12.3f %12.3f %12.1f\n", "recompute", t_full, t_full / tokens, tokens * 1000.0 / t_full);
+    fprintf(stderr, "cache length = %d  max diff = %g\n", cache.length(), max_diff);
+
+    return 0;
+}
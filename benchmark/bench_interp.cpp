@@ -0,0 +1,102 @@
+// interp at cityscapes resolution, fpn neck upsampling and a segmentation decoder resized to the 2048 x 1024 input
+// the naive per pixel layer against the table driven x86 layer with its row buffers and integer scale path
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "paramdict.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct interp_case
+{
+    const char* name;
+    int w;
+    int h;
+    int c;
+    int resize_type;
+    int outw;
+    int outh;
+    int align_corner;
+};
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// best ms of one forward
+static double bench_layer(const interp_case& ic, int isa, const tinyinfer::Mat& bottom, int loop, const tinyinfer::Option& opt)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, ic.resize_type);
+    pd.set(3, ic.outh);
+    pd.set(4, ic.outw);
+    pd.set(6, ic.align_corner);
+
+    const int type = tinyinfer::layer_to_index("Interp");
+    tinyinfer::Layer* op = isa < 0 ? tinyinfer::create_layer(type) : tinyinfer::create_layer_isa(type, isa);
+    op->load_param(pd);
+    op->create_pipeline(opt);
+
+    // the top is kept across runs, so the timing is not dominated by faulting in fresh pages of a large output
+    tinyinfer::Mat top;
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        double start = now_ms();
+        op->forward(bottom, top, opt);
+        double t = now_ms() - start;
+
+        // the first run is warm up
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=5]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 5;
+
+    const interp_case cases[] = {
+        {"fpn nearest 2x", 128, 64, 256, 1, 256, 128, 0},
+        {"fpn bilinear 2x", 128, 64, 256, 2, 256, 128, 0},
+        {"fpn nearest 1.5x", 128, 64, 256, 1, 192, 96, 0},
+        {"decoder nearest 4x", 512, 256, 19, 1, 2048, 1024, 0},
+        {"decoder bilinear 4x", 512, 256, 19, 2, 2048, 1024, 0},
+        {"decoder bilinear 4x aligned", 512, 256, 19, 2, 2048, 1024, 1},
+        {"decoder bicubic 4x", 512, 256, 19, 3, 2048, 1024, 0},
+        {"input bilinear 0.5x", 2048, 1024, 3, 2, 1024, 512, 0},
+    };
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d\n", opt.num_threads, loop, tinyinfer::cpu_isa_level());
+    fprintf(stderr, "%-30s %9s %9s %9s\n", "ms", "naive", "x86", "speedup");
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(interp_case)); i++)
+    {
+        const interp_case& ic = cases[i];
+
+        tinyinfer::Mat bottom(ic.w, ic.h, ic.c);
+        for (int q = 0; q < bottom.c; q++)
+        {
+            float* ptr = bottom.channel(q);
+            for (int j = 0; j < bottom.w * bottom.h; j++)
+            {
+                ptr[j] = (float)(rand() % 1000) / 1000.f;
+            }
+        }
+
+        double t_naive = bench_layer(ic, TINYINFER_ISA_NAIVE, bottom, loop, opt);
+        double t_x86 = bench_layer(ic, -1, bottom, loop, opt);
+
+        fprintf(stderr, "%-30s %9.3f %9.3f %9.2f\n", ic.name, t_naive, t_x86, t_naive / t_x86);
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+// layer, group and instance normalization throughput
+// the naive two pass layers against the single pass welford x86 kernels on transformer and diffusion shapes
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "modelbin.h"
+#include "paramdict.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct normalize_case
+{
+    const char* name;
+    const char* type;
+    int w;
+    int h;
+    int c;
+    // LayerNorm affine_size, GroupNorm group, unused by InstanceNorm
+    int p0;
+};
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static tinyinfer::Mat random_mat(int w, int h, int c)
+{
+    tinyinfer::Mat m = c > 0 ? tinyinfer::Mat(w, h, c) : tinyinfer::Mat(w, h);
+    for (int q = 0; q < m.c; q++)
+    {
+        float* ptr = m.channel(q);
+        for (int i = 0; i < m.w * m.h; i++)
+        {
+            ptr[i] = (float)(rand() % 16000 - 8000) / 1000.f;
+        }
+    }
+
+    return m;
+}
+
+static tinyinfer::Layer* create(const normalize_case& nc, int isa)
+{
+    // gamma and beta along the normalized axis or the channels
+    const int channels = nc.c > 0 ? nc.c : nc.h;
+    const int affine_size = strcmp(nc.type, "LayerNorm") == 0 ? nc.p0 : channels;
+
+    tinyinfer::ParamDict pd;
+    if (strcmp(nc.type, "LayerNorm") == 0)
+    {
+        pd.set(0, nc.p0);
+        pd.set(1, 1e-5f);
+        pd.set(2, 1);
+    }
+    if (strcmp(nc.type, "GroupNorm") == 0)
+    {
+        pd.set(0, nc.p0);
+        pd.set(1, channels);
+        pd.set(2, 1e-5f);
+        pd.set(3, 1);
+    }
+    if (strcmp(nc.type, "InstanceNorm") == 0)
+    {
+        pd.set(0, channels);
+        pd.set(1, 1e-5f);
+        pd.set(2, 1);
+    }
+
+    tinyinfer::Mat weights[2];
+    weights[0] = random_mat(affine_size, 1, 0).reshape(affine_size);
+    weights[1] = random_mat(affine_size, 1, 0).reshape(affine_size);
+
+    const int type = tinyinfer::layer_to_index(nc.type);
+    tinyinfer::Layer* op = isa < 0 ? tinyinfer::create_layer(type) : tinyinfer::create_layer_isa(type, isa);
+    op->load_param(pd);
+    op->load_model(tinyinfer::ModelBinFromMatArray(weights));
+    return op;
+}
+
+// best ms of one in place forward, the input is restored outside the timed region
+static double bench_layer(const normalize_case& nc, int isa, const tinyinfer::Mat& bottom, int loop, const tinyinfer::Option& opt)
+{
+    tinyinfer::Layer* op = create(nc, isa);
+    op->create_pipeline(opt);
+
+    tinyinfer::Mat m = bottom.clone();
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        memcpy(m.data, bottom.data, bottom.total() * sizeof(float));
+
+        double start = now_ms();
+        op->forward_inplace(m, opt);
+        double t = now_ms() - start;
+
+        // the first run is warm up
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=10]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 10;
+
+    const normalize_case cases[] = {
+        {"bert 768 x 512 layernorm", "LayerNorm", 768, 512, 0, 768},
+        {"vit 1024 x 197 layernorm", "LayerNorm", 1024, 197, 0, 1024},
+        {"unet 64 x 64 x 320 groupnorm 32", "GroupNorm", 64, 64, 320, 32},
+        {"unet 64 x 64 x 320 groupnorm 2", "GroupNorm", 64, 64, 320, 2},
+        {"style 128 x 128 x 64 instancenorm", "InstanceNorm", 128, 128, 64, 0},
+    };
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d\n", opt.num_threads, loop, tinyinfer::cpu_isa_level());
+    fprintf(stderr, "%-36s %9s %9s %9s %9s\n", "ms", "naive", "x86", "GB/s", "speedup");
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(normalize_case)); i++)
+    {
+        const normalize_case& nc = cases[i];
+        tinyinfer::Mat bottom = random_mat(nc.w, nc.h, nc.c);
+
+        double t_naive = bench_layer(nc, TINYINFER_ISA_NAIVE, bottom, loop, opt);
+        double t_x86 = bench_layer(nc, -1, bottom, loop, opt);
+
+        // read twice and written once
+        const double bytes = 3.0 * bottom.total() * sizeof(float);
+        fprintf(stderr, "%-36s %9.3f %9.3f %9.2f %9.2f\n", nc.name, t_naive, t_x86, bytes / t_x86 / 1e6, t_naive / t_x86);
+    }
+
+    return 0;
+}
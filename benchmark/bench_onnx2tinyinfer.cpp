@@ -0,0 +1,101 @@
+// converts a synthetic onnx graph with onnx2tinyinfer and reports the wall time and peak rss
+// nodes are written in reverse topological order so the converter has to sort all of them
+#include "onnx.pb.h"
+#include <sys/resource.h>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void make_synthetic_graph(onnx::ModelProto& model, int node_num, int weight_dim)
+{
+    onnx::GraphProto* graph = model.mutable_graph();
+    graph->set_name("synthetic");
+
+    onnx::ValueInfoProto* input = graph->add_input();
+    input->set_name("data");
+
+    for (int i = node_num - 1; i >= 0; i--)
+    {
+        onnx::NodeProto* node = graph->add_node();
+        node->set_name("node" + std::to_string(i));
+        node->add_output("t" + std::to_string(i));
+
+        std::string prev = i == 0 ? std::string("data") : "t" + std::to_string(i - 1);
+
+        // a residual add every 8 nodes, which also exercises the split layer insertion
+        // and a matmul against a weight_dim x weight_dim initializer every 64 nodes
+        if (i % 64 == 32)
+        {
+            std::string weight_name = "w" + std::to_string(i);
+
+            node->set_op_type("MatMul");
+            node->add_input(prev);
+            node->add_input(weight_name);
+
+            onnx::TensorProto* weight = graph->add_initializer();
+            weight->set_name(weight_name);
+            weight->set_data_type(1);
+            weight->add_dims(weight_dim);
+            weight->add_dims(weight_dim);
+            weight->set_raw_data(std::string((size_t)weight_dim * weight_dim * sizeof(float), '\0'));
+        }
+        else if (i % 8 == 7)
+        {
+            node->set_op_type("Add");
+            node->add_input(prev);
+            node->add_input("t" + std::to_string(i - 7));
+        }
+        else
+        {
+            node->set_op_type("Relu");
+            node->add_input(prev);
+        }
+    }
+
+    onnx::ValueInfoProto* output = graph->add_output();
+    output->set_name("t" + std::to_string(node_num - 1));
+}
+
+int main(int argc, char** argv)
+{
+    int node_num = argc > 1 ? atoi(argv[1]) : 100000;
+    int weight_dim = argc > 2 ? atoi(argv[2]) : 64;
+    const char* converter = argc > 3 ? argv[3] : ONNX2TINYINFER_PATH;
+
+    size_t model_size = 0;
+    {
+        onnx::ModelProto model;
+        make_synthetic_graph(model, node_num, weight_dim);
+
+        std::ofstream ofs("synthetic.onnx", std::ofstream::out | std::ofstream::binary);
+        if (!model.SerializeToOstream(&ofs))
+        {
+            fprintf(stderr, "write synthetic.onnx failed\n");
+            return -1;
+        }
+        model_size = model.ByteSizeLong();
+    }
+
+    std::string cmd = std::string(converter) + " synthetic.onnx synthetic.param synthetic.bin";
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    int ret = system(cmd.c_str());
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    if (ret != 0)
+    {
+        fprintf(stderr, "%s failed with %d\n", cmd.c_str(), ret);
+        return -1;
+    }
+
+    // ru_maxrss of the children is the peak resident set of the converter process, in KB on linux
+    struct rusage usage;
+    getrusage(RUSAGE_CHILDREN, &usage);
+
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    fprintf(stderr, "%-24s nodes = %d  model = %.2f MB  time = %.2f ms  peak rss = %.2f MB\n", "onnx2tinyinfer", node_num, model_size / 1024.0 / 1024.0, ms, usage.ru_maxrss / 1024.0);
+
+    return 0;
+}
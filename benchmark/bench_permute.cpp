@@ -0,0 +1,179 @@
+// permute throughput of the naive strided copy and the blocked x86 kernels on transformer and detection head shapes
+// and a gemm reading a transposed operand through a Permute layer against the same gemm with the permute folded away
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "net.h"
+#include "paramdict.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct permute_case
+{
+    const char* name;
+    int dims;
+    int w;
+    int h;
+    int d;
+    int c;
+    int order_type;
+};
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static tinyinfer::Mat make_mat(const permute_case& pc)
+{
+    tinyinfer::Mat m;
+    if (pc.dims == 2)
+        m.create(pc.w, pc.h);
+    if (pc.dims == 3)
+        m.create(pc.w, pc.h, pc.c);
+    if (pc.dims == 4)
+        m.create(pc.w, pc.h, pc.d, pc.c);
+
+    for (int q = 0; q < m.c; q++)
+    {
+        float* ptr = m.channel(q);
+        for (int i = 0; i < m.w * m.h * m.d; i++)
+        {
+            ptr[i] = (float)(rand() % 1000) / 1000.f;
+        }
+    }
+
+    return m;
+}
+
+// best ms of one forward
+static double bench_layer(const permute_case& pc, int isa, const tinyinfer::Mat& bottom, int loop, const tinyinfer::Option& opt)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, pc.order_type);
+
+    const int type = tinyinfer::layer_to_index("Permute");
+    tinyinfer::Layer* op = isa < 0 ? tinyinfer::create_layer(type) : tinyinfer::create_layer_isa(type, isa);
+    op->load_param(pd);
+    op->create_pipeline(opt);
+
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        tinyinfer::Mat top;
+        double start = now_ms();
+        op->forward(bottom, top, opt);
+        double t = now_ms() - start;
+
+        // the first run is warm up
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return best;
+}
+
+// attention scores, q of 64 x 512 per head against k stored 64 wide and permuted to 512 x 64
+static const char* scores_param = "202303\n"
+                                  "4 4\n"
+                                  "Input            q 0 1 q 0=64 1=512 2=12\n"
+                                  "Input            k 0 1 k 0=64 1=512 2=12\n"
+                                  "Permute          kt 1 1 k kt 0=1\n"
+                                  "Gemm             scores 2 1 q kt scores\n";
+
+static int load_scores(tinyinfer::Net& net)
+{
+    FILE* pp = tmpfile();
+    FILE* bp = tmpfile();
+    if (!pp || !bp)
+        return -1;
+
+    fwrite(scores_param, 1, strlen(scores_param), pp);
+    rewind(pp);
+
+    int ret = net.load_param(pp);
+    if (ret == 0)
+        ret = net.load_model(bp);
+
+    fclose(pp);
+    fclose(bp);
+    return ret;
+}
+
+static double bench_scores(const tinyinfer::Net& net, const tinyinfer::Mat& q, const tinyinfer::Mat& k, int loop)
+{
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        tinyinfer::Extractor ex = net.create_extractor();
+        ex.input("q", q);
+        ex.input("k", k);
+
+        double start = now_ms();
+        tinyinfer::Mat out;
+        ex.extract("scores", out);
+        double t = now_ms() - start;
+
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=10]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 10;
+
+    const permute_case cases[] = {
+        {"matrix 1024 x 1024 transpose", 2, 1024, 1024, 1, 1, 1},
+        {"heads 64 x 512 x 12 to w c h", 3, 64, 512, 1, 12, 2},
+        {"heads 64 x 512 x 12 to h w c", 3, 64, 512, 1, 12, 1},
+        {"yolo 6400 x 85 x 3 to c w h", 3, 6400, 85, 1, 3, 3},
+        {"nchw 56 x 56 x 256 to nhwc", 3, 56, 56, 1, 256, 5},
+        {"4d 32 x 32 x 16 x 16 reverse", 4, 32, 32, 16, 16, 23},
+    };
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d\n", opt.num_threads, loop, tinyinfer::cpu_isa_level());
+    fprintf(stderr, "%-32s %9s %9s %9s %9s\n", "ms", "naive", "x86", "GB/s", "speedup");
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(permute_case)); i++)
+    {
+        const permute_case& pc = cases[i];
+        tinyinfer::Mat bottom = make_mat(pc);
+
+        double t_naive = bench_layer(pc, TINYINFER_ISA_NAIVE, bottom, loop, opt);
+        double t_x86 = bench_layer(pc, -1, bottom, loop, opt);
+
+        // read once and written once
+        const double bytes = 2.0 * bottom.w * bottom.h * bottom.d * bottom.c * sizeof(float);
+        fprintf(stderr, "%-32s %9.3f %9.3f %9.2f %9.2f\n", pc.name, t_naive, t_x86, bytes / t_x86 / 1e6, t_naive / t_x86);
+    }
+
+    tinyinfer::Net net;
+    tinyinfer::Net net_fold;
+    net.opt = opt;
+    net.opt.use_permute_fold = false;
+    net_fold.opt = opt;
+    if (load_scores(net) != 0 || load_scores(net_fold) != 0)
+    {
+        fprintf(stderr, "load scores net failed\n");
+        return -1;
+    }
+
+    const permute_case qk = {"", 3, 64, 512, 1, 12, 0};
+    tinyinfer::Mat q = make_mat(qk);
+    tinyinfer::Mat k = make_mat(qk);
+
+    double t_permute = bench_scores(net, q, k, loop);
+    double t_fold = bench_scores(net_fold, q, k, loop);
+    fprintf(stderr, "q k^T 12 x 512 x 512 x 64         permute %9.3f  folded %9.3f\n", t_permute, t_fold);
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+// pooling throughput in GB/s of input read on resnet, vgg, squeezenet and inception shapes and classification heads
+// the naive layer against the optimized layer picked for this cpu
+#include "allocator.h"
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "paramdict.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct pool_shape
+{
+    const char* name;
+    int w;
+    int h;
+    int c;
+    int pooling_type;
+    int kernel;
+    int stride;
+    int pad;
+    int global_pooling;
+    int pad_mode;
+};
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void randomize(tinyinfer::Mat& m)
+{
+    for (int q = 0; q < m.c; q++)
+    {
+        float* ptr = m.channel(q);
+        for (int i = 0; i < m.w * m.h; i++)
+        {
+            ptr[i] = (float)(rand() % 2000 - 1000) / 1000.f;
+        }
+    }
+}
+
+// best ms of one forward
+static double bench_layer(const pool_shape& s, int isa, const tinyinfer::Mat& bottom, int loop, const tinyinfer::Option& opt)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, s.pooling_type);
+    pd.set(1, s.kernel);
+    pd.set(2, s.stride);
+    pd.set(3, s.pad);
+    pd.set(4, s.global_pooling);
+    pd.set(5, s.pad_mode);
+
+    const int type = tinyinfer::LayerType::Pooling;
+    tinyinfer::Layer* op = isa < 0 ? tinyinfer::create_layer(type) : tinyinfer::create_layer_isa(type, isa);
+    op->load_param(pd);
+    op->create_pipeline(opt);
+
+    tinyinfer::Mat top;
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        double start = now_ms();
+        op->forward(bottom, top, opt);
+        double t = now_ms() - start;
+
+        // the first run is warm up
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=10]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 10;
+
+    // scratch buffers come from a pool as they do inside a net, so the timing is free of page faults
+    tinyinfer::PoolAllocator workspace_allocator;
+    opt.workspace_allocator = &workspace_allocator;
+
+    const pool_shape shapes[] = {
+        {"resnet50 max 3x3s2", 112, 112, 64, 0, 3, 2, 1, 0, 1},
+        {"vgg16 max 2x2s2 224", 224, 224, 64, 0, 2, 2, 0, 0, 1},
+        {"vgg16 max 2x2s2 56", 56, 56, 256, 0, 2, 2, 0, 0, 1},
+        {"vgg16 max 2x2s2 14", 14, 14, 512, 0, 2, 2, 0, 0, 1},
+        {"squeezenet max ceil", 55, 55, 96, 0, 3, 2, 0, 0, 0},
+        {"inception avg 3x3s1", 35, 35, 192, 1, 3, 1, 1, 0, 1},
+        {"resnet50 global avg", 7, 7, 2048, 1, 0, 1, 0, 1, 0},
+        {"mobilenetv2 global avg", 7, 7, 1280, 1, 0, 1, 0, 1, 0},
+        {"resnet18 global avg", 7, 7, 512, 1, 0, 1, 0, 1, 0},
+        {"resnet50 global max", 7, 7, 2048, 0, 0, 1, 0, 1, 0},
+        {"global avg 56", 56, 56, 256, 1, 0, 1, 0, 1, 0},
+    };
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d\n", opt.num_threads, loop, tinyinfer::cpu_isa_level());
+    fprintf(stderr, "%-24s %5s %5s %3s %3s %10s %10s %10s %10s\n", "shape", "size", "ch", "k", "s", "naive ms", "ms", "GB/s", "speedup");
+    for (int i = 0; i < (int)(sizeof(shapes) / sizeof(pool_shape)); i++)
+    {
+        const pool_shape& s = shapes[i];
+
+        tinyinfer::Mat bottom(s.w, s.h, s.c);
+        randomize(bottom);
+
+        double t_naive = bench_layer(s, TINYINFER_ISA_NAIVE, bottom, loop, opt);
+        double t_opt = bench_layer(s, -1, bottom, loop, opt);
+        const double gbs = (double)s.w * s.h * s.c * sizeof(float) / (t_opt * 1e6);
+        fprintf(stderr, "%-24s %5d %5d %3d %3d %10.4f %10.4f %10.2f %10.2f\n", s.name, s.w, s.c, s.global_pooling ? s.w : s.kernel, s.stride, t_naive, t_opt, gbs, t_naive / t_opt);
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+// sgemm throughput in GFLOPS, the naive layer, the optimized layer picked for this cpu and a cblas_sgemm
+// constant weights go through InnerProduct with the weight packed once, runtime operands go through Gemm
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "modelbin.h"
+#include "paramdict.h"
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if TINYINFER_BENCH_CBLAS
+#include <cblas.h>
+#endif
+
+struct sgemm_shape
+{
+    const char* name;
+    int M;
+    int N;
+    int K;
+    // B is a runtime blob instead of a constant weight
+    int runtime_b;
+};
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void randomize(tinyinfer::Mat& m)
+{
+    float* ptr = m;
+    for (size_t i = 0; i < m.total(); i++)
+    {
+        ptr[i] = (float)(rand() % 2000 - 1000) / 1000.f;
+    }
+}
+
+// average ms of one forward, A is M x K, W is N x K
+static double bench_layer(const sgemm_shape& s, int isa, const tinyinfer::Mat& A, const tinyinfer::Mat& W, int loop, const tinyinfer::Option& opt)
+{
+    tinyinfer::ParamDict pd;
+    int typeindex;
+    if (s.runtime_b)
+    {
+        typeindex = tinyinfer::LayerType::Gemm;
+        pd.set(3, 1);
+    }
+    else
+    {
+        typeindex = tinyinfer::LayerType::InnerProduct;
+        pd.set(0, s.N);
+        pd.set(1, 0);
+        pd.set(2, s.N * s.K);
+    }
+
+    tinyinfer::Layer* op = isa < 0 ? tinyinfer::create_layer(typeindex) : tinyinfer::create_layer_isa(typeindex, isa);
+    op->load_param(pd);
+
+    tinyinfer::Mat weights[1] = {W.reshape(s.N * s.K)};
+    if (!s.runtime_b)
+        op->load_model(tinyinfer::ModelBinFromMatArray(weights));
+    op->create_pipeline(opt);
+
+    std::vector<tinyinfer::Mat> bottom_blobs(2);
+    bottom_blobs[0] = A;
+    bottom_blobs[1] = W;
+    std::vector<tinyinfer::Mat> top_blobs(1);
+
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        double start = now_ms();
+        if (s.runtime_b)
+            op->forward(bottom_blobs, top_blobs, opt);
+        else
+            op->forward(A, top_blobs[0], opt);
+        double t = now_ms() - start;
+
+        // the first run is warm up
+        if (r > 0 && t < best)
+            best = t;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return best;
+}
+
+#if TINYINFER_BENCH_CBLAS
+static double bench_cblas(const sgemm_shape& s, const tinyinfer::Mat& A, const tinyinfer::Mat& W, int loop)
+{
+    tinyinfer::Mat C(s.N, s.M);
+
+    double best = 1e30;
+    for (int r = 0; r < loop + 1; r++)
+    {
+        double start = now_ms();
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, s.M, s.N, s.K, 1.f, A, s.K, W, s.K, 0.f, C, s.N);
+        double t = now_ms() - start;
+
+        if (r > 0 && t < best)
+            best = t;
+    }
+    return best;
+}
+#endif
+
+static double gflops(const sgemm_shape& s, double ms)
+{
+    return 2.0 * s.M * s.N * s.K / (ms * 1e6);
+}
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=10]
+    tinyinfer::Option opt;
+    opt.num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 10;
+
+    const sgemm_shape shapes[] = {
+        // bert-base like encoder, 128 tokens
+        {"attn qkv", 128, 2304, 768, 0},
+        {"attn out", 128, 768, 768, 0},
+        {"ffn up", 128, 3072, 768, 0},
+        {"ffn down", 128, 768, 3072, 0},
+        {"attn q*k^T", 128, 128, 64, 1},
+        {"decode qkv", 1, 2304, 768, 0},
+        // classifier heads
+        {"resnet50 fc", 1, 1000, 2048, 0},
+        {"mobilenet fc", 1, 1000, 1280, 0},
+        {"resnet50 fc b32", 32, 1000, 2048, 0},
+    };
+
+    fprintf(stderr, "num_threads = %d  loop = %d  isa = %d\n", opt.num_threads, loop, tinyinfer::cpu_isa_level());
+    fprintf(stderr, "%-16s %6s %6s %6s %12s %12s %12s\n", "shape", "M", "N", "K", "naive", "tinyinfer", "cblas");
+    for (int i = 0; i < (int)(sizeof(shapes) / sizeof(sgemm_shape)); i++)
+    {
+        const sgemm_shape& s = shapes[i];
+
+        tinyinfer::Mat A(s.K, s.M);
+        tinyinfer::Mat W(s.K, s.N);
+        randomize(A);
+        randomize(W);
+
+        double t_naive = bench_layer(s, TINYINFER_ISA_NAIVE, A, W, loop > 3 ? 3 : loop, opt);
+        double t_opt = bench_layer(s, -1, A, W, loop, opt);
+#if TINYINFER_BENCH_CBLAS
+        double t_cblas = bench_cblas(s, A, W, loop);
+        fprintf(stderr, "%-16s %6d %6d %6d %12.2f %12.2f %12.2f\n", s.name, s.M, s.N, s.K, gflops(s, t_naive), gflops(s, t_opt), gflops(s, t_cblas));
+#else
+        fprintf(stderr, "%-16s %6d %6d %6d %12.2f %12.2f %12s\n", s.name, s.M, s.N, s.K, gflops(s, t_naive), gflops(s, t_opt), "-");
+#endif
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+// fork/join latency of ThreadPool::parallel_for against an openmp parallel for
+// the loop body is nearly empty, so the time is dominated by dispatch and join
+#include "cpu.h"
+#include "threadpool.h"
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if _OPENMP
+#include <omp.h>
+#endif
+
+static double now_us()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double bench_threadpool(tinyinfer::ThreadPool& pool, std::vector<float>& data, int range, int loop)
+{
+    float* ptr = data.data();
+
+    // one chunk per thread, the same split as the openmp static schedule
+    const int grain = (range + pool.num_threads() - 1) / pool.num_threads();
+
+    // warm up, starts the workers
+    pool.parallel_for(0, range, grain, [&](int i0, int i1) {
+        for (int i = i0; i < i1; i++)
+            ptr[i] += 1.f;
+    });
+
+    double start = now_us();
+    for (int r = 0; r < loop; r++)
+    {
+        pool.parallel_for(0, range, grain, [&](int i0, int i1) {
+            for (int i = i0; i < i1; i++)
+                ptr[i] += 1.f;
+        });
+    }
+    return (now_us() - start) / loop;
+}
+
+#if _OPENMP
+static double bench_openmp(std::vector<float>& data, int range, int loop, int num_threads)
+{
+    float* ptr = data.data();
+
+    #pragma omp parallel for num_threads(num_threads)
+    for (int i = 0; i < range; i++)
+        ptr[i] += 1.f;
+
+    double start = now_us();
+    for (int r = 0; r < loop; r++)
+    {
+        #pragma omp parallel for num_threads(num_threads)
+        for (int i = 0; i < range; i++)
+            ptr[i] += 1.f;
+    }
+    return (now_us() - start) / loop;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    // [num_threads=cpu count] [loop=20000]
+    int num_threads = argc > 1 ? atoi(argv[1]) : tinyinfer::get_cpu_count();
+    int loop = argc > 2 ? atoi(argv[2]) : 20000;
+
+    tinyinfer::ThreadPool pool(num_threads);
+
+    const int ranges[] = {2, 4, 16, 64, 256, 1024, 4096};
+
+    fprintf(stderr, "num_threads = %d  loop = %d\n", num_threads, loop);
+    fprintf(stderr, "%8s %16s %16s\n", "range", "threadpool us", "openmp us");
+    for (int k = 0; k < (int)(sizeof(ranges) / sizeof(int)); k++)
+    {
+        std::vector<float> data(ranges[k], 0.f);
+
+        double t_pool = bench_threadpool(pool, data, ranges[k], loop);
+#if _OPENMP
+        double t_omp = bench_openmp(data, ranges[k], loop, num_threads);
+        fprintf(stderr, "%8d %16.3f %16.3f\n", ranges[k], t_pool, t_omp);
+#else
+        fprintf(stderr, "%8d %16.3f %16s\n", ranges[k], t_pool, "-");
+#endif
+    }
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef BLOB_H
+#define BLOB_H
+
+#include <string>
+
+namespace tinyinfer {
+
+class Blob
+{
+public:
+    Blob();
+
+public:
+    std::string name;
+
+    // layer index which produces this blob as output
+    int producer;
+
+    // layer index which consumes this blob as input, -1 for graph outputs
+    int consumer;
+};
+
+} // namespace tinyinfer
+
+#endif
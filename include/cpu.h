@@ -0,0 +1,26 @@
+#ifndef CPU_H
+#define CPU_H
+
+namespace tinyinfer {
+
+// instruction set levels of layer implementations, a higher level implies the lower ones
+#define TINYINFER_ISA_NAIVE  0
+#define TINYINFER_ISA_SSE2   1
+#define TINYINFER_ISA_AVX2   2 // avx2 + fma + f16c
+#define TINYINFER_ISA_AVX512 3 // avx512 f + bw + vl + dq
+
+// x86 cpu feature, detected once from cpuid and os state
+// return 1 if supported, 0 otherwise
+int cpu_support_x86_sse2();
+int cpu_support_x86_avx2();
+int cpu_support_x86_avx512();
+
+// highest TINYINFER_ISA_* level the running cpu supports
+int cpu_isa_level();
+
+// number of cpus this process may run on
+int get_cpu_count();
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef KVCACHE_H
+#define KVCACHE_H
+
+#include "allocator.h"
+#include "mat.h"
+
+namespace tinyinfer {
+
+// keys and values of one sequence, kept across forwards for autoregressive decoding
+// every MultiHeadAttention layer with kv_cache set owns one slot, numbered by the net when the param is loaded
+// new rows are appended in place, the storage grows by whole chunks of positions so a token rarely reallocates
+class KVCache
+{
+public:
+    KVCache();
+    ~KVCache();
+
+    KVCache(const KVCache&) = delete;            // forbiden copy construction
+    KVCache& operator=(const KVCache&) = delete; // forbiden copy assignment
+
+public:
+    // positions the storage grows by, 256 by default
+    void set_chunk_size(int positions);
+
+    // storage allocator, the default one if null
+    // set before the first append, the storage is reallocated through it when it grows
+    void set_allocator(Allocator* allocator);
+
+    // forget the sequence, the storage is kept for the next one
+    void clear();
+
+    // forget the sequence and free the storage
+    void release();
+
+    // positions stored in every slot, the first slot tells for a forward that ran every layer
+    int length() const;
+    int length(int slot) const;
+
+    // append the rows of k and v, the new positions, to a slot
+    // 3d blobs hold one head per channel, 2d blobs the heads side by side along w, as MultiHeadAttention reads them
+    // return 0 if success, -1 if the shape does not continue what the slot holds, -100 on allocation failure
+    int append(int slot, const Mat& k, const Mat& v);
+
+    // the storage of a slot, length(slot) rows of every head are valid and the rest is capacity
+    const Mat& keys(int slot) const;
+    const Mat& values(int slot) const;
+
+private:
+    class KVCachePrivate;
+    KVCachePrivate* const d;
+};
+
+} // namespace tinyinfer
+
+#endif
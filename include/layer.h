@@ -0,0 +1,147 @@
+#ifndef LAYER_H
+#define LAYER_H
+
+#include "mat.h"
+#include "modelbin.h"
+#include "option.h"
+#include "paramdict.h"
+#include <string>
+#include <vector>
+
+namespace tinyinfer {
+
+class Layer
+{
+public:
+    // empty
+    Layer();
+    // virtual destructor
+    virtual ~Layer();
+
+    // load layer specific parameter from parsed dict
+    // return 0 if success
+    virtual int load_param(const ParamDict& pd);
+
+    // load layer specific weight data from model binary
+    // return 0 if success
+    virtual int load_model(const ModelBin& mb);
+
+    // layer implementation specific setup, weight transform and packing
+    // return 0 if success
+    virtual int create_pipeline(const Option& opt);
+
+    // layer implementation specific clean
+    // return 0 if success
+    virtual int destroy_pipeline(const Option& opt);
+
+public:
+    // one input and one output blob
+    bool one_blob_only;
+
+    // support inplace inference
+    bool support_inplace;
+
+public:
+    // forward is const, weights are shared read-only by every extractor
+    // implement inference
+    // return 0 if success
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+    // implement inplace inference
+    // the multi blob flavor may write into or replace the first tops.size() blobs only
+    // return 0 if success
+    virtual int forward_inplace(std::vector<Mat>& bottom_top_blobs, const Option& opt) const;
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    // layer type index
+    int typeindex;
+    // layer type name
+    std::string type;
+    // layer name
+    std::string name;
+    // blob index which this layer needs as input
+    std::vector<int> bottoms;
+    // blob index which this layer produces as output
+    std::vector<int> tops;
+};
+
+// layer type index, must follow the registry table order in layer.cpp
+// unimplemented types keep their index so param files stay stable
+namespace LayerType {
+enum LayerType
+{
+    Input = 0,
+    MemoryData = 1,
+    Split = 2,
+    BatchNorm = 3,
+    BinaryOp = 4,
+    Clip = 5,
+    Concat = 6,
+    Convolution = 7,
+    Convolution1D = 8,
+    ConvolutionDepthWise = 9,
+    DeConvolution = 10,
+    DeConvolutionDepthWise = 11,
+    Dropout = 12,
+    ELU = 13,
+    ExpandDims = 14,
+    Flatten = 15,
+    Gemm = 16,
+    HardSigmoid = 17,
+    HardSwish = 18,
+    InnerProduct = 19,
+    Interp = 20,
+    Padding = 21,
+    Permute = 22,
+    Pooling = 23,
+    Pooling1D = 24,
+    ReLU = 25,
+    Reshape = 26,
+    Sigmoid = 27,
+    Softmax = 28,
+    Squeeze = 29,
+    Swish = 30,
+    UnaryOp = 31,
+    GELU = 32,
+    LayerNorm = 33,
+    GroupNorm = 34,
+    InstanceNorm = 35,
+    MultiHeadAttention = 36,
+};
+} // namespace LayerType
+
+// layer factory function
+typedef Layer* (*layer_creator_func)();
+
+struct layer_registry_entry
+{
+    // layer type name
+    const char* name;
+    // layer factory entry
+    layer_creator_func creator;
+};
+
+// get layer type from type name, -1 if not registered
+int layer_to_index(const char* type);
+// create layer from type name
+Layer* create_layer(const char* type);
+// create layer from layer type, the fastest implementation for the running cpu
+Layer* create_layer(int index);
+// create layer from layer type, the fastest implementation up to TINYINFER_ISA_* level isa
+// TINYINFER_ISA_NAIVE gives the plain c++ reference
+Layer* create_layer_isa(int index, int isa);
+
+#define DECLARE_LAYER_CREATOR(name) \
+    ::tinyinfer::Layer* name##_layer_creator();
+
+#define DEFINE_LAYER_CREATOR(name)              \
+    ::tinyinfer::Layer* name##_layer_creator()  \
+    {                                           \
+        return new name;                        \
+    }
+
+} // namespace tinyinfer
+
+#endif
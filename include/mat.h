@@ -3,6 +3,7 @@
 
 #include "common.h"
 #include "allocator.h"
+#include "threadpool.h"
 #include <cassert>
 
 namespace tinyinfer {
@@ -38,6 +39,8 @@ public:
     Mat clone(Allocator* allocator = 0) const;
     void clone_from(const tinyinfer::Mat& mat, Allocator* allocator = 0);
 
+    // a blob of the same shape, elemsize and allocator that nobody else references is kept as is
+    // a view of external memory included, so a layer handed a slice of a larger blob writes into it
     void create(int w, size_t elemsize = 4u, Allocator* allocator = 0);
     void create(int w, int h, size_t elemsize = 4u, Allocator* allocator = 0);
     void create(int w, int h, int c, size_t elemsize = 4u, Allocator* allocator = 0);
@@ -55,7 +58,7 @@ public:
     int total() const;
     bool empty() const;
 
-    // reshape
+    // reshape, a view unless the channel padding moves
     Mat reshape(int w, Allocator* allocator = 0) const;
     Mat reshape(int w, int h, Allocator* allocator = 0) const;
     Mat reshape(int w, int h, int c, Allocator* allocator = 0) const;
@@ -111,6 +114,9 @@ public:
     void to_pixels(unsigned char* pixels, int type) const;
     void to_pixels(unsigned char* pixels, int type, int stride) const;
 
+    // (x - mean) * norm per channel, either array can be null
+    void substract_mean_normalize(const float* mean_vals, const float* norm_vals);
+
 public:
     void* data;
 
@@ -132,6 +138,32 @@ public:
     size_t cstep;
 };
 
+// Mat helpers only fork once a chunk covers this many bytes, smaller work stays serial
+#define TINYINFER_MAT_PARALLEL_BYTES (256 * 1024)
+
+// items per parallel chunk when each item spans item_size bytes
+static inline int mat_parallel_grain(size_t item_size)
+{
+    size_t grain = TINYINFER_MAT_PARALLEL_BYTES / (item_size > 0 ? item_size : 1);
+    return grain > 1 ? (int)grain : 1;
+}
+
+// bytes moved by copies, Mat::clone, a copying Mat::reshape and the copy fallback of layers that are views otherwise
+// a net whose data movement layers all run as views leaves it untouched
+void add_mat_copy_bytes(size_t bytes);
+size_t get_mat_copy_bytes();
+void reset_mat_copy_bytes();
+
+// bordered copy of src, type 0 = constant v, 1 = replicate the edge, 2 = reflect without repeating the edge
+// top and bottom pad h of dims 2 and more, left and right pad w, front and behind pad c of dims 3 and d of dims 4
+// dst references src when every pad is 0, dst is empty if the allocation fails
+void copy_make_border(const Mat& src, Mat& dst, int top, int bottom, int left, int right, int type, float v, const Option& opt);
+void copy_make_border_3d(const Mat& src, Mat& dst, int top, int bottom, int left, int right, int front, int behind, int type, float v, const Option& opt);
+
+// fp16 conversion, round to nearest even
+unsigned short float32_to_float16(float value);
+float float16_to_float32(unsigned short value);
+
 FORCEINLINE Mat::Mat()
     : data(0), allocator(0), refcount(0), elemsize(0), elempack(0), dims(0), w(0), h(0), d(0), c(0), cstep(0)
 {
@@ -251,6 +283,7 @@ FORCEINLINE Mat& Mat::operator=(const Mat& m)
 
     data = m.data;
     refcount = m.refcount;
+    allocator = m.allocator;
     elemsize = m.elemsize;
     elempack = m.elempack;
     dims = m.dims;
@@ -299,8 +332,10 @@ FORCEINLINE void Mat::fill(T val)
 
     int total_size = total();
     T* ptr = (T*)data;
-    for (int i = 0; i < total_size; i++)
-        ptr[i] = val;
+    get_default_threadpool()->parallel_for(0, total_size, mat_parallel_grain(sizeof(T)), [&](int i0, int i1) {
+        for (int i = i0; i < i1; i++)
+            ptr[i] = val;
+    });
 }
 
 } // namespace tinyinfer
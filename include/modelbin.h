@@ -0,0 +1,55 @@
+#ifndef MODELBIN_H
+#define MODELBIN_H
+
+#include "mat.h"
+#include <stdio.h>
+
+namespace tinyinfer {
+
+// weight type tag written before tagged weight data in the bin
+#define TINYINFER_WEIGHT_TAG_FLOAT32 0x00000000
+#define TINYINFER_WEIGHT_TAG_FLOAT16 0x01306B47
+
+class ModelBin
+{
+public:
+    ModelBin();
+    virtual ~ModelBin();
+
+    // element type
+    // 0 = auto, read the type tag and decode to float32, float16 storage only shrinks the bin
+    // 1 = float32, untagged
+    virtual Mat load(int w, int type) const = 0;
+    virtual Mat load(int w, int h, int type) const;
+    virtual Mat load(int w, int h, int c, int type) const;
+};
+
+class ModelBinFromStdio : public ModelBin
+{
+public:
+    // the file must stay opened while loading
+    explicit ModelBinFromStdio(FILE* binfp);
+
+    using ModelBin::load;
+    virtual Mat load(int w, int type) const;
+
+private:
+    FILE* binfp;
+};
+
+class ModelBinFromMatArray : public ModelBin
+{
+public:
+    // construct from weight blob array, weights are returned in order, type is ignored
+    explicit ModelBinFromMatArray(const Mat* weights);
+
+    using ModelBin::load;
+    virtual Mat load(int w, int type) const;
+
+private:
+    mutable const Mat* weights;
+};
+
+} // namespace tinyinfer
+
+#endif
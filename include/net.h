@@ -0,0 +1,128 @@
+#ifndef NET_H
+#define NET_H
+
+#include "blob.h"
+#include "kvcache.h"
+#include "layer.h"
+#include "mat.h"
+#include "option.h"
+#include <stdio.h>
+#include <vector>
+
+namespace tinyinfer {
+
+class Extractor;
+class Net
+{
+public:
+    // empty init
+    Net();
+    // clear and destroy
+    ~Net();
+
+    Net(const Net&) = delete;            // forbiden copy construction
+    Net& operator=(const Net&) = delete; // forbiden copy assignment
+
+public:
+    // option can be changed before loading
+    Option opt;
+
+    // load network structure from plain param file
+    // return 0 if success
+    int load_param(FILE* fp);
+    int load_param(const char* protopath);
+
+    // load network weight data from model file
+    // return 0 if success
+    int load_model(FILE* fp);
+    int load_model(const char* modelpath);
+
+    // unload network structure and weight data
+    void clear();
+
+    // construct an Extractor from network
+    // the net must outlive every extractor
+    Extractor create_extractor() const;
+
+    // blob and layer index lookup, -1 if not found
+    int find_blob_index_by_name(const char* name) const;
+    int find_layer_index_by_name(const char* name) const;
+
+    const std::vector<Blob>& blobs() const;
+    const std::vector<Layer*>& layers() const;
+
+    // blob indexes of Input layers and of blobs that no layer consumes
+    const std::vector<int>& input_indexes() const;
+    const std::vector<int>& output_indexes() const;
+
+protected:
+    friend class Extractor;
+
+    // run one layer, bottom blobs must be ready in blob_mats
+    // blob_refs counts the consumers still pending for each blob, used by lightmode
+    // concat_mats holds the preallocated concat outputs producers write into
+    int forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<int>& blob_refs, std::vector<Mat>& concat_mats, const Option& opt) const;
+
+private:
+    class NetPrivate;
+    NetPrivate* const d;
+};
+
+class Extractor
+{
+public:
+    ~Extractor();
+
+    // copy
+    Extractor(const Extractor&);
+
+    // assign
+    Extractor& operator=(const Extractor&);
+
+    // clear blob mats and alloctors
+    void clear();
+
+    // enable light mode
+    // intermediate blob will be recycled when enabled
+    // enabled by default
+    void set_light_mode(bool enable);
+
+    // set blob memory allocator
+    void set_blob_allocator(Allocator* allocator);
+
+    // set workspace memory allocator
+    void set_workspace_allocator(Allocator* allocator);
+
+    // keep the keys and values of caching attention layers in cache, which outlives the extractor
+    // a sequence is decoded by one extractor per step, each fed the next tokens with the same cache set
+    void set_kv_cache(KVCache* cache);
+
+    // set input by blob name
+    // return 0 if success
+    int input(const char* blob_name, const Mat& in);
+
+    // get result by blob name
+    // return 0 if success
+    int extract(const char* blob_name, Mat& feat);
+
+    // set input by blob index
+    // return 0 if success
+    int input(int blob_index, const Mat& in);
+
+    // get result by blob index
+    // only the layers the blob depends on are run, computed blobs are cached
+    // return 0 if success
+    int extract(int blob_index, Mat& feat);
+
+protected:
+    friend Extractor Net::create_extractor() const;
+    Extractor(const Net* net, size_t blob_count);
+
+private:
+    class ExtractorPrivate;
+    ExtractorPrivate* const d;
+};
+
+} // namespace tinyinfer
+
+#endif
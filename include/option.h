@@ -0,0 +1,70 @@
+#ifndef OPTION_H
+#define OPTION_H
+
+#include "allocator.h"
+
+namespace tinyinfer {
+
+class KVCache;
+class ThreadPool;
+
+class Option
+{
+public:
+    // default option
+    Option();
+
+public:
+    // light mode
+    // intermediate blob will be recycled once every consumer has run
+    // enabled by default
+    bool lightmode;
+
+    // blob memory allocator, top blobs of every layer
+    Allocator* blob_allocator;
+
+    // workspace memory allocator, temporary buffers inside a layer
+    Allocator* workspace_allocator;
+
+    // thread count used by layer kernels
+    // default value is the number of cpus
+    int num_threads;
+
+    // pool running layer kernels, the process wide default pool if null
+    ThreadPool* threadpool;
+
+    // keys and values of the sequence for MultiHeadAttention layers with kv_cache set, they attend without one if null
+    // per sequence state, set on the extractor rather than on the net
+    KVCache* kv_cache;
+
+    // 3x3 stride 1 convolution through winograd transformed weights
+    // enabled by default
+    bool use_winograd_convolution;
+
+    // F(6,3) tiles when winograd is used, F(4,3) otherwise
+    // F(6,3) needs fewer multiplies, F(4,3) has less rounding error
+    // enabled by default
+    bool use_winograd63_convolution;
+
+    // cheaper exp and erf approximations and a reciprocal estimate in Sigmoid, Swish and GELU
+    // a few more ulp of error, results saturate outside about +-87
+    // disabled by default
+    bool use_fast_activation;
+
+    // producers of a Concat along its outermost axis write straight into their slice of its output
+    // the output is sized from the previous forward of the net, so the first one still copies
+    // only used in light mode, enabled by default
+    bool use_inplace_concat;
+
+    // a Permute swapping the two innermost axes of a Gemm operand is skipped, the Gemm reads its bottom transposed
+    // applied when the param is loaded, enabled by default
+    bool use_permute_fold;
+
+    // a constant Padding in front of a Convolution or an average Pooling is skipped, the consumer pads itself
+    // applied when the param is loaded, enabled by default
+    bool use_padding_fold;
+};
+
+} // namespace tinyinfer
+
+#endif
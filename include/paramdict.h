@@ -0,0 +1,59 @@
+#ifndef PARAMDICT_H
+#define PARAMDICT_H
+
+#include "mat.h"
+#include <stdio.h>
+
+// at most 32 parameters per layer, id 0 ~ 31
+// array parameters are written with id -23300 - id
+#define TINYINFER_MAX_PARAM_COUNT 32
+
+namespace tinyinfer {
+
+class ParamDict
+{
+public:
+    ParamDict();
+    ~ParamDict();
+
+    ParamDict(const ParamDict&) = delete;            // forbiden copy construction
+    ParamDict& operator=(const ParamDict&) = delete; // forbiden copy assignment
+
+    // 0 = null
+    // 2 = int
+    // 3 = float
+    // 4 = int array
+    // 5 = float array
+    int type(int id) const;
+
+    int get(int id, int def) const;
+    float get(int id, float def) const;
+    Mat get(int id, const Mat& def) const;
+
+    void set(int id, int i);
+    void set(int id, float f);
+    void set(int id, const Mat& v);
+
+    void clear();
+
+    // parse id=value tokens up to the end of the current layer line
+    int load_param(FILE* fp);
+
+private:
+    struct Param
+    {
+        int type;
+        union
+        {
+            int i;
+            float f;
+        };
+        Mat v;
+    };
+
+    Param params[TINYINFER_MAX_PARAM_COUNT];
+};
+
+} // namespace tinyinfer
+
+#endif
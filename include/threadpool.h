@@ -0,0 +1,85 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "option.h"
+#include <vector>
+
+namespace tinyinfer {
+
+// persistent workers for fork-join loops
+// every worker owns a range of chunks and steals half of another range once its own is empty
+// idle workers spin for a short while before sleeping, so back to back loops do not pay a wakeup
+class ThreadPool
+{
+public:
+    // num_threads participants including the calling thread, 0 for one per cpu
+    // workers are started by the first parallel_for
+    explicit ThreadPool(int num_threads = 0);
+    // join workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;            // forbiden copy construction
+    ThreadPool& operator=(const ThreadPool&) = delete; // forbiden copy assignment
+
+    int num_threads() const;
+
+    // pin worker i to cpus[i % cpus.size()], the calling thread keeps its own affinity
+    // return 0 if success
+    int set_affinity(const std::vector<int>& cpus);
+
+    // call fn(i0, i1) on disjoint sub ranges covering [begin, end), at least grain items each
+    // at most max_threads participants, 0 for all
+    // blocks until every sub range is done
+    // nested calls and calls while another thread owns the pool run serially on the caller
+    template<typename Func>
+    void parallel_for(int begin, int end, int grain, const Func& fn, int max_threads = 0);
+
+private:
+    typedef void (*range_func)(void* ctx, int begin, int end);
+
+    void run(int begin, int end, int grain, range_func func, void* ctx, int max_threads);
+
+    template<typename Func>
+    static void call_range(void* ctx, int begin, int end)
+    {
+        (*(const Func*)ctx)(begin, end);
+    }
+
+    class ThreadPoolPrivate;
+    ThreadPoolPrivate* const d;
+};
+
+template<typename Func>
+inline void ThreadPool::parallel_for(int begin, int end, int grain, const Func& fn, int max_threads)
+{
+    if (end <= begin)
+        return;
+
+    if (grain < 1)
+        grain = 1;
+
+    // a single chunk never leaves the calling thread
+    if (end - begin <= grain || max_threads == 1)
+    {
+        fn(begin, end);
+        return;
+    }
+
+    run(begin, end, grain, call_range<Func>, (void*)&fn, max_threads);
+}
+
+// process wide pool, one participant per cpu
+// used by Mat helpers and by layers when Option::threadpool is null
+ThreadPool* get_default_threadpool();
+
+// layer kernels, honors Option::threadpool and Option::num_threads
+template<typename Func>
+inline void parallel_for(const Option& opt, int begin, int end, int grain, const Func& fn)
+{
+    ThreadPool* pool = opt.threadpool ? opt.threadpool : get_default_threadpool();
+    pool->parallel_for(begin, end, grain, fn, opt.num_threads);
+}
+
+} // namespace tinyinfer
+
+#endif
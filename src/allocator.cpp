@@ -120,8 +120,8 @@ void PoolAllocator::fastFree(void* ptr)
 {
     d->payouts_lock.lock();
 
-    std::list<std::pair<size_t, void*> >::iterator it = d->budgets.begin();
-    for (; it != d->budgets.end(); it++)
+    std::list<std::pair<size_t, void*> >::iterator it = d->payouts.begin();
+    for (; it != d->payouts.end(); it++)
     {
         if (it->second == ptr)
         {
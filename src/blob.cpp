@@ -0,0 +1,11 @@
+#include "blob.h"
+
+namespace tinyinfer {
+
+Blob::Blob()
+{
+    producer = -1;
+    consumer = -1;
+}
+
+} // namespace tinyinfer
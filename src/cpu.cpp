@@ -0,0 +1,75 @@
+#include "cpu.h"
+
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace tinyinfer {
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+// __builtin_cpu_supports also checks the os saves the avx and avx512 register state
+static int detect_cpu_isa_level()
+{
+    __builtin_cpu_init();
+
+    if (!__builtin_cpu_supports("sse2"))
+        return TINYINFER_ISA_NAIVE;
+
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma") || !__builtin_cpu_supports("f16c"))
+        return TINYINFER_ISA_SSE2;
+
+    if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw") || !__builtin_cpu_supports("avx512vl") || !__builtin_cpu_supports("avx512dq"))
+        return TINYINFER_ISA_AVX2;
+
+    return TINYINFER_ISA_AVX512;
+}
+#else
+static int detect_cpu_isa_level()
+{
+    return TINYINFER_ISA_NAIVE;
+}
+#endif
+
+// cpuid is queried once, the first call initializes it thread safely
+int cpu_isa_level()
+{
+    static const int level = detect_cpu_isa_level();
+    return level;
+}
+
+int cpu_support_x86_sse2()
+{
+    return cpu_isa_level() >= TINYINFER_ISA_SSE2;
+}
+
+int cpu_support_x86_avx2()
+{
+    return cpu_isa_level() >= TINYINFER_ISA_AVX2;
+}
+
+int cpu_support_x86_avx512()
+{
+    return cpu_isa_level() >= TINYINFER_ISA_AVX512;
+}
+
+int get_cpu_count()
+{
+#if defined(__linux__)
+    // honor the affinity mask, containers often expose fewer cpus than the host has
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0)
+    {
+        int count = CPU_COUNT(&cpuset);
+        if (count > 0)
+            return count;
+    }
+#endif
+
+    int count = (int)std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+} // namespace tinyinfer
@@ -0,0 +1,172 @@
+#include "kvcache.h"
+
+#include "common.h"
+#include <string.h>
+#include <vector>
+
+namespace tinyinfer {
+
+struct KVCacheSlot
+{
+    KVCacheSlot()
+        : length(0)
+    {
+    }
+
+    // h is the capacity in positions
+    Mat k;
+    Mat v;
+    int length;
+};
+
+class KVCache::KVCachePrivate
+{
+public:
+    // room for at least positions rows in m, shaped like the blob appended, the stored rows are kept
+    int reserve(Mat& m, const Mat& like, int length, int positions);
+
+public:
+    std::vector<KVCacheSlot> slots;
+    int chunk_size;
+    Allocator* allocator;
+    Mat empty;
+};
+
+int KVCache::KVCachePrivate::reserve(Mat& m, const Mat& like, int length, int positions)
+{
+    if (!m.empty() && m.h >= positions)
+        return 0;
+
+    const int capacity = (positions + chunk_size - 1) / chunk_size * chunk_size;
+
+    Mat grown;
+    if (like.dims == 3)
+        grown.create(like.w, capacity, like.c, 4u, allocator);
+    else
+        grown.create(like.w, capacity, 4u, allocator);
+    if (grown.empty())
+        return -100;
+
+    if (length > 0)
+    {
+        for (int q = 0; q < grown.c; q++)
+        {
+            memcpy(grown.channel(q), m.channel(q), (size_t)length * m.w * sizeof(float));
+        }
+    }
+
+    m = grown;
+    return 0;
+}
+
+KVCache::KVCache()
+    : d(new KVCachePrivate())
+{
+    d->chunk_size = 256;
+    d->allocator = 0;
+}
+
+KVCache::~KVCache()
+{
+    release();
+
+    delete d;
+}
+
+void KVCache::set_chunk_size(int positions)
+{
+    if (positions <= 0)
+    {
+        TINYINFER_LOG("invalid kv cache chunk size %d", positions);
+        return;
+    }
+
+    d->chunk_size = positions;
+}
+
+void KVCache::set_allocator(Allocator* allocator)
+{
+    d->allocator = allocator;
+}
+
+void KVCache::clear()
+{
+    for (size_t i = 0; i < d->slots.size(); i++)
+    {
+        d->slots[i].length = 0;
+    }
+}
+
+void KVCache::release()
+{
+    d->slots.clear();
+}
+
+int KVCache::length() const
+{
+    return length(0);
+}
+
+int KVCache::length(int slot) const
+{
+    if (slot < 0 || slot >= (int)d->slots.size())
+        return 0;
+
+    return d->slots[slot].length;
+}
+
+int KVCache::append(int slot, const Mat& k, const Mat& v)
+{
+    if (slot < 0 || k.empty() || v.empty() || k.dims != v.dims || (k.dims != 2 && k.dims != 3) || k.h != v.h || k.c != v.c)
+        return -1;
+
+    if (slot >= (int)d->slots.size())
+        d->slots.resize(slot + 1);
+
+    KVCacheSlot& s = d->slots[slot];
+
+    // a cleared slot takes any shape, a running one only more positions of the same heads
+    if (s.length > 0 && (s.k.dims != k.dims || s.k.w != k.w || s.k.c != k.c || s.v.w != v.w))
+        return -1;
+
+    if (s.length == 0 && !s.k.empty() && (s.k.dims != k.dims || s.k.w != k.w || s.k.c != k.c || s.v.w != v.w))
+    {
+        s.k.release();
+        s.v.release();
+    }
+
+    const int positions = s.length + k.h;
+
+    int ret = d->reserve(s.k, k, s.length, positions);
+    if (ret == 0)
+        ret = d->reserve(s.v, v, s.length, positions);
+    if (ret != 0)
+        return ret;
+
+    for (int q = 0; q < k.c; q++)
+    {
+        memcpy((float*)s.k.channel(q) + (size_t)s.length * k.w, k.channel(q), (size_t)k.h * k.w * sizeof(float));
+        memcpy((float*)s.v.channel(q) + (size_t)s.length * v.w, v.channel(q), (size_t)v.h * v.w * sizeof(float));
+    }
+
+    s.length = positions;
+    return 0;
+}
+
+const Mat& KVCache::keys(int slot) const
+{
+    if (slot < 0 || slot >= (int)d->slots.size())
+        return d->empty;
+
+    return d->slots[slot].k;
+}
+
+const Mat& KVCache::values(int slot) const
+{
+    if (slot < 0 || slot >= (int)d->slots.size())
+        return d->empty;
+
+    return d->slots[slot].v;
+}
+
+} // namespace tinyinfer
@@ -0,0 +1,389 @@
+#include "layer.h"
+#include "common.h"
+#include "cpu.h"
+#include <string.h>
+
+namespace tinyinfer {
+
+Layer::Layer()
+{
+    one_blob_only = false;
+    support_inplace = false;
+
+    typeindex = -1;
+}
+
+Layer::~Layer()
+{
+}
+
+int Layer::load_param(const ParamDict& /*pd*/)
+{
+    return 0;
+}
+
+int Layer::load_model(const ModelBin& /*mb*/)
+{
+    return 0;
+}
+
+int Layer::create_pipeline(const Option& /*opt*/)
+{
+    return 0;
+}
+
+int Layer::destroy_pipeline(const Option& /*opt*/)
+{
+    return 0;
+}
+
+int Layer::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    if (!support_inplace)
+        return -1;
+
+    top_blobs.resize(bottom_blobs.size());
+    for (int i = 0; i < (int)top_blobs.size(); i++)
+    {
+        top_blobs[i] = bottom_blobs[i].clone(opt.blob_allocator);
+        if (top_blobs[i].empty())
+            return -100;
+    }
+
+    return forward_inplace(top_blobs, opt);
+}
+
+int Layer::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    if (!support_inplace)
+        return -1;
+
+    top_blob = bottom_blob.clone(opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return forward_inplace(top_blob, opt);
+}
+
+int Layer::forward_inplace(std::vector<Mat>& /*bottom_top_blobs*/, const Option& /*opt*/) const
+{
+    return -1;
+}
+
+int Layer::forward_inplace(Mat& /*bottom_top_blob*/, const Option& /*opt*/) const
+{
+    return -1;
+}
+
+DECLARE_LAYER_CREATOR(BatchNorm)
+DECLARE_LAYER_CREATOR(BinaryOp)
+DECLARE_LAYER_CREATOR(Clip)
+DECLARE_LAYER_CREATOR(Concat)
+DECLARE_LAYER_CREATOR(Convolution)
+DECLARE_LAYER_CREATOR(ConvolutionDepthWise)
+DECLARE_LAYER_CREATOR(DeConvolution)
+DECLARE_LAYER_CREATOR(DeConvolutionDepthWise)
+DECLARE_LAYER_CREATOR(Dropout)
+DECLARE_LAYER_CREATOR(ELU)
+DECLARE_LAYER_CREATOR(ExpandDims)
+DECLARE_LAYER_CREATOR(Flatten)
+DECLARE_LAYER_CREATOR(GELU)
+DECLARE_LAYER_CREATOR(Gemm)
+DECLARE_LAYER_CREATOR(GroupNorm)
+DECLARE_LAYER_CREATOR(HardSigmoid)
+DECLARE_LAYER_CREATOR(HardSwish)
+DECLARE_LAYER_CREATOR(InnerProduct)
+DECLARE_LAYER_CREATOR(InstanceNorm)
+DECLARE_LAYER_CREATOR(Interp)
+DECLARE_LAYER_CREATOR(Input)
+DECLARE_LAYER_CREATOR(LayerNorm)
+DECLARE_LAYER_CREATOR(MemoryData)
+DECLARE_LAYER_CREATOR(MultiHeadAttention)
+DECLARE_LAYER_CREATOR(Padding)
+DECLARE_LAYER_CREATOR(Permute)
+DECLARE_LAYER_CREATOR(Pooling)
+DECLARE_LAYER_CREATOR(Pooling1D)
+DECLARE_LAYER_CREATOR(ReLU)
+DECLARE_LAYER_CREATOR(Reshape)
+DECLARE_LAYER_CREATOR(Sigmoid)
+DECLARE_LAYER_CREATOR(Softmax)
+DECLARE_LAYER_CREATOR(Split)
+DECLARE_LAYER_CREATOR(Squeeze)
+DECLARE_LAYER_CREATOR(Swish)
+DECLARE_LAYER_CREATOR(UnaryOp)
+
+#if TINYINFER_X86
+DECLARE_LAYER_CREATOR(BatchNorm_x86)
+DECLARE_LAYER_CREATOR(BinaryOp_x86)
+DECLARE_LAYER_CREATOR(Clip_x86)
+DECLARE_LAYER_CREATOR(Convolution_x86)
+DECLARE_LAYER_CREATOR(ConvolutionDepthWise_x86)
+DECLARE_LAYER_CREATOR(DeConvolution_x86)
+DECLARE_LAYER_CREATOR(ELU_x86)
+DECLARE_LAYER_CREATOR(GELU_x86)
+DECLARE_LAYER_CREATOR(Gemm_x86)
+DECLARE_LAYER_CREATOR(GroupNorm_x86)
+DECLARE_LAYER_CREATOR(HardSigmoid_x86)
+DECLARE_LAYER_CREATOR(HardSwish_x86)
+DECLARE_LAYER_CREATOR(InnerProduct_x86)
+DECLARE_LAYER_CREATOR(InstanceNorm_x86)
+DECLARE_LAYER_CREATOR(Interp_x86)
+DECLARE_LAYER_CREATOR(LayerNorm_x86)
+DECLARE_LAYER_CREATOR(MultiHeadAttention_x86)
+DECLARE_LAYER_CREATOR(Permute_x86)
+DECLARE_LAYER_CREATOR(Pooling_x86)
+DECLARE_LAYER_CREATOR(ReLU_x86)
+DECLARE_LAYER_CREATOR(Sigmoid_x86)
+DECLARE_LAYER_CREATOR(Softmax_x86)
+DECLARE_LAYER_CREATOR(Swish_x86)
+DECLARE_LAYER_CREATOR(UnaryOp_x86)
+#endif
+#if TINYINFER_X86_AVX2
+DECLARE_LAYER_CREATOR(BatchNorm_x86_avx2)
+DECLARE_LAYER_CREATOR(BinaryOp_x86_avx2)
+DECLARE_LAYER_CREATOR(Clip_x86_avx2)
+DECLARE_LAYER_CREATOR(Convolution_x86_avx2)
+DECLARE_LAYER_CREATOR(ConvolutionDepthWise_x86_avx2)
+DECLARE_LAYER_CREATOR(DeConvolution_x86_avx2)
+DECLARE_LAYER_CREATOR(ELU_x86_avx2)
+DECLARE_LAYER_CREATOR(GELU_x86_avx2)
+DECLARE_LAYER_CREATOR(Gemm_x86_avx2)
+DECLARE_LAYER_CREATOR(GroupNorm_x86_avx2)
+DECLARE_LAYER_CREATOR(HardSigmoid_x86_avx2)
+DECLARE_LAYER_CREATOR(HardSwish_x86_avx2)
+DECLARE_LAYER_CREATOR(InnerProduct_x86_avx2)
+DECLARE_LAYER_CREATOR(InstanceNorm_x86_avx2)
+DECLARE_LAYER_CREATOR(Interp_x86_avx2)
+DECLARE_LAYER_CREATOR(LayerNorm_x86_avx2)
+DECLARE_LAYER_CREATOR(MultiHeadAttention_x86_avx2)
+DECLARE_LAYER_CREATOR(Permute_x86_avx2)
+DECLARE_LAYER_CREATOR(Pooling_x86_avx2)
+DECLARE_LAYER_CREATOR(ReLU_x86_avx2)
+DECLARE_LAYER_CREATOR(Sigmoid_x86_avx2)
+DECLARE_LAYER_CREATOR(Softmax_x86_avx2)
+DECLARE_LAYER_CREATOR(Swish_x86_avx2)
+DECLARE_LAYER_CREATOR(UnaryOp_x86_avx2)
+#endif
+#if TINYINFER_X86_AVX512
+DECLARE_LAYER_CREATOR(BatchNorm_x86_avx512)
+DECLARE_LAYER_CREATOR(BinaryOp_x86_avx512)
+DECLARE_LAYER_CREATOR(Clip_x86_avx512)
+DECLARE_LAYER_CREATOR(Convolution_x86_avx512)
+DECLARE_LAYER_CREATOR(ConvolutionDepthWise_x86_avx512)
+DECLARE_LAYER_CREATOR(DeConvolution_x86_avx512)
+DECLARE_LAYER_CREATOR(ELU_x86_avx512)
+DECLARE_LAYER_CREATOR(GELU_x86_avx512)
+DECLARE_LAYER_CREATOR(Gemm_x86_avx512)
+DECLARE_LAYER_CREATOR(GroupNorm_x86_avx512)
+DECLARE_LAYER_CREATOR(HardSigmoid_x86_avx512)
+DECLARE_LAYER_CREATOR(HardSwish_x86_avx512)
+DECLARE_LAYER_CREATOR(InnerProduct_x86_avx512)
+DECLARE_LAYER_CREATOR(InstanceNorm_x86_avx512)
+DECLARE_LAYER_CREATOR(Interp_x86_avx512)
+DECLARE_LAYER_CREATOR(LayerNorm_x86_avx512)
+DECLARE_LAYER_CREATOR(MultiHeadAttention_x86_avx512)
+DECLARE_LAYER_CREATOR(Permute_x86_avx512)
+DECLARE_LAYER_CREATOR(Pooling_x86_avx512)
+DECLARE_LAYER_CREATOR(ReLU_x86_avx512)
+DECLARE_LAYER_CREATOR(Sigmoid_x86_avx512)
+DECLARE_LAYER_CREATOR(Softmax_x86_avx512)
+DECLARE_LAYER_CREATOR(Swish_x86_avx512)
+DECLARE_LAYER_CREATOR(UnaryOp_x86_avx512)
+#endif
+
+// the position in this table is the layer type index
+// naive implementations, a null creator means the type is not implemented yet
+static const layer_registry_entry layer_registry[] = {
+    {"Input", Input_layer_creator},
+    {"MemoryData", MemoryData_layer_creator},
+    {"Split", Split_layer_creator},
+    {"BatchNorm", BatchNorm_layer_creator},
+    {"BinaryOp", BinaryOp_layer_creator},
+    {"Clip", Clip_layer_creator},
+    {"Concat", Concat_layer_creator},
+    {"Convolution", Convolution_layer_creator},
+    {"Convolution1D", 0},
+    {"ConvolutionDepthWise", ConvolutionDepthWise_layer_creator},
+    {"DeConvolution", DeConvolution_layer_creator},
+    {"DeConvolutionDepthWise", DeConvolutionDepthWise_layer_creator},
+    {"Dropout", Dropout_layer_creator},
+    {"ELU", ELU_layer_creator},
+    {"ExpandDims", ExpandDims_layer_creator},
+    {"Flatten", Flatten_layer_creator},
+    {"Gemm", Gemm_layer_creator},
+    {"HardSigmoid", HardSigmoid_layer_creator},
+    {"HardSwish", HardSwish_layer_creator},
+    {"InnerProduct", InnerProduct_layer_creator},
+    {"Interp", Interp_layer_creator},
+    {"Padding", Padding_layer_creator},
+    {"Permute", Permute_layer_creator},
+    {"Pooling", Pooling_layer_creator},
+    {"Pooling1D", Pooling1D_layer_creator},
+    {"ReLU", ReLU_layer_creator},
+    {"Reshape", Reshape_layer_creator},
+    {"Sigmoid", Sigmoid_layer_creator},
+    {"Softmax", Softmax_layer_creator},
+    {"Squeeze", Squeeze_layer_creator},
+    {"Swish", Swish_layer_creator},
+    {"UnaryOp", UnaryOp_layer_creator},
+    {"GELU", GELU_layer_creator},
+    {"LayerNorm", LayerNorm_layer_creator},
+    {"GroupNorm", GroupNorm_layer_creator},
+    {"InstanceNorm", InstanceNorm_layer_creator},
+    {"MultiHeadAttention", MultiHeadAttention_layer_creator},
+};
+
+static const int layer_registry_entry_count = sizeof(layer_registry) / sizeof(layer_registry_entry);
+
+struct layer_isa_registry_entry
+{
+    // layer type index
+    int typeindex;
+    // TINYINFER_ISA_* level the implementation is compiled for
+    int isa;
+    // layer factory entry
+    layer_creator_func creator;
+};
+
+// cpu specialized implementations, each isa variant is the same source built with different target flags
+static const layer_isa_registry_entry layer_registry_isa[] = {
+#if TINYINFER_X86
+    {LayerType::BatchNorm, TINYINFER_ISA_SSE2, BatchNorm_x86_layer_creator},
+    {LayerType::BinaryOp, TINYINFER_ISA_SSE2, BinaryOp_x86_layer_creator},
+    {LayerType::Clip, TINYINFER_ISA_SSE2, Clip_x86_layer_creator},
+    {LayerType::Convolution, TINYINFER_ISA_SSE2, Convolution_x86_layer_creator},
+    {LayerType::ConvolutionDepthWise, TINYINFER_ISA_SSE2, ConvolutionDepthWise_x86_layer_creator},
+    {LayerType::DeConvolution, TINYINFER_ISA_SSE2, DeConvolution_x86_layer_creator},
+    {LayerType::ELU, TINYINFER_ISA_SSE2, ELU_x86_layer_creator},
+    {LayerType::GELU, TINYINFER_ISA_SSE2, GELU_x86_layer_creator},
+    {LayerType::Gemm, TINYINFER_ISA_SSE2, Gemm_x86_layer_creator},
+    {LayerType::GroupNorm, TINYINFER_ISA_SSE2, GroupNorm_x86_layer_creator},
+    {LayerType::HardSigmoid, TINYINFER_ISA_SSE2, HardSigmoid_x86_layer_creator},
+    {LayerType::HardSwish, TINYINFER_ISA_SSE2, HardSwish_x86_layer_creator},
+    {LayerType::InnerProduct, TINYINFER_ISA_SSE2, InnerProduct_x86_layer_creator},
+    {LayerType::InstanceNorm, TINYINFER_ISA_SSE2, InstanceNorm_x86_layer_creator},
+    {LayerType::Interp, TINYINFER_ISA_SSE2, Interp_x86_layer_creator},
+    {LayerType::LayerNorm, TINYINFER_ISA_SSE2, LayerNorm_x86_layer_creator},
+    {LayerType::MultiHeadAttention, TINYINFER_ISA_SSE2, MultiHeadAttention_x86_layer_creator},
+    {LayerType::Permute, TINYINFER_ISA_SSE2, Permute_x86_layer_creator},
+    {LayerType::Pooling, TINYINFER_ISA_SSE2, Pooling_x86_layer_creator},
+    {LayerType::ReLU, TINYINFER_ISA_SSE2, ReLU_x86_layer_creator},
+    {LayerType::Sigmoid, TINYINFER_ISA_SSE2, Sigmoid_x86_layer_creator},
+    {LayerType::Softmax, TINYINFER_ISA_SSE2, Softmax_x86_layer_creator},
+    {LayerType::Swish, TINYINFER_ISA_SSE2, Swish_x86_layer_creator},
+    {LayerType::UnaryOp, TINYINFER_ISA_SSE2, UnaryOp_x86_layer_creator},
+#endif
+#if TINYINFER_X86_AVX2
+    {LayerType::BatchNorm, TINYINFER_ISA_AVX2, BatchNorm_x86_avx2_layer_creator},
+    {LayerType::BinaryOp, TINYINFER_ISA_AVX2, BinaryOp_x86_avx2_layer_creator},
+    {LayerType::Clip, TINYINFER_ISA_AVX2, Clip_x86_avx2_layer_creator},
+    {LayerType::Convolution, TINYINFER_ISA_AVX2, Convolution_x86_avx2_layer_creator},
+    {LayerType::ConvolutionDepthWise, TINYINFER_ISA_AVX2, ConvolutionDepthWise_x86_avx2_layer_creator},
+    {LayerType::DeConvolution, TINYINFER_ISA_AVX2, DeConvolution_x86_avx2_layer_creator},
+    {LayerType::ELU, TINYINFER_ISA_AVX2, ELU_x86_avx2_layer_creator},
+    {LayerType::GELU, TINYINFER_ISA_AVX2, GELU_x86_avx2_layer_creator},
+    {LayerType::Gemm, TINYINFER_ISA_AVX2, Gemm_x86_avx2_layer_creator},
+    {LayerType::GroupNorm, TINYINFER_ISA_AVX2, GroupNorm_x86_avx2_layer_creator},
+    {LayerType::HardSigmoid, TINYINFER_ISA_AVX2, HardSigmoid_x86_avx2_layer_creator},
+    {LayerType::HardSwish, TINYINFER_ISA_AVX2, HardSwish_x86_avx2_layer_creator},
+    {LayerType::InnerProduct, TINYINFER_ISA_AVX2, InnerProduct_x86_avx2_layer_creator},
+    {LayerType::InstanceNorm, TINYINFER_ISA_AVX2, InstanceNorm_x86_avx2_layer_creator},
+    {LayerType::Interp, TINYINFER_ISA_AVX2, Interp_x86_avx2_layer_creator},
+    {LayerType::LayerNorm, TINYINFER_ISA_AVX2, LayerNorm_x86_avx2_layer_creator},
+    {LayerType::MultiHeadAttention, TINYINFER_ISA_AVX2, MultiHeadAttention_x86_avx2_layer_creator},
+    {LayerType::Permute, TINYINFER_ISA_AVX2, Permute_x86_avx2_layer_creator},
+    {LayerType::Pooling, TINYINFER_ISA_AVX2, Pooling_x86_avx2_layer_creator},
+    {LayerType::ReLU, TINYINFER_ISA_AVX2, ReLU_x86_avx2_layer_creator},
+    {LayerType::Sigmoid, TINYINFER_ISA_AVX2, Sigmoid_x86_avx2_layer_creator},
+    {LayerType::Softmax, TINYINFER_ISA_AVX2, Softmax_x86_avx2_layer_creator},
+    {LayerType::Swish, TINYINFER_ISA_AVX2, Swish_x86_avx2_layer_creator},
+    {LayerType::UnaryOp, TINYINFER_ISA_AVX2, UnaryOp_x86_avx2_layer_creator},
+#endif
+#if TINYINFER_X86_AVX512
+    {LayerType::BatchNorm, TINYINFER_ISA_AVX512, BatchNorm_x86_avx512_layer_creator},
+    {LayerType::BinaryOp, TINYINFER_ISA_AVX512, BinaryOp_x86_avx512_layer_creator},
+    {LayerType::Clip, TINYINFER_ISA_AVX512, Clip_x86_avx512_layer_creator},
+    {LayerType::Convolution, TINYINFER_ISA_AVX512, Convolution_x86_avx512_layer_creator},
+    {LayerType::ConvolutionDepthWise, TINYINFER_ISA_AVX512, ConvolutionDepthWise_x86_avx512_layer_creator},
+    {LayerType::DeConvolution, TINYINFER_ISA_AVX512, DeConvolution_x86_avx512_layer_creator},
+    {LayerType::ELU, TINYINFER_ISA_AVX512, ELU_x86_avx512_layer_creator},
+    {LayerType::GELU, TINYINFER_ISA_AVX512, GELU_x86_avx512_layer_creator},
+    {LayerType::Gemm, TINYINFER_ISA_AVX512, Gemm_x86_avx512_layer_creator},
+    {LayerType::GroupNorm, TINYINFER_ISA_AVX512, GroupNorm_x86_avx512_layer_creator},
+    {LayerType::HardSigmoid, TINYINFER_ISA_AVX512, HardSigmoid_x86_avx512_layer_creator},
+    {LayerType::HardSwish, TINYINFER_ISA_AVX512, HardSwish_x86_avx512_layer_creator},
+    {LayerType::InnerProduct, TINYINFER_ISA_AVX512, InnerProduct_x86_avx512_layer_creator},
+    {LayerType::InstanceNorm, TINYINFER_ISA_AVX512, InstanceNorm_x86_avx512_layer_creator},
+    {LayerType::Interp, TINYINFER_ISA_AVX512, Interp_x86_avx512_layer_creator},
+    {LayerType::LayerNorm, TINYINFER_ISA_AVX512, LayerNorm_x86_avx512_layer_creator},
+    {LayerType::MultiHeadAttention, TINYINFER_ISA_AVX512, MultiHeadAttention_x86_avx512_layer_creator},
+    {LayerType::Permute, TINYINFER_ISA_AVX512, Permute_x86_avx512_layer_creator},
+    {LayerType::Pooling, TINYINFER_ISA_AVX512, Pooling_x86_avx512_layer_creator},
+    {LayerType::ReLU, TINYINFER_ISA_AVX512, ReLU_x86_avx512_layer_creator},
+    {LayerType::Sigmoid, TINYINFER_ISA_AVX512, Sigmoid_x86_avx512_layer_creator},
+    {LayerType::Softmax, TINYINFER_ISA_AVX512, Softmax_x86_avx512_layer_creator},
+    {LayerType::Swish, TINYINFER_ISA_AVX512, Swish_x86_avx512_layer_creator},
+    {LayerType::UnaryOp, TINYINFER_ISA_AVX512, UnaryOp_x86_avx512_layer_creator},
+#endif
+    {-1, TINYINFER_ISA_NAIVE, 0},
+};
+
+static const int layer_registry_isa_entry_count = sizeof(layer_registry_isa) / sizeof(layer_isa_registry_entry);
+
+int layer_to_index(const char* type)
+{
+    for (int i = 0; i < layer_registry_entry_count; i++)
+    {
+        if (strcmp(type, layer_registry[i].name) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+Layer* create_layer(const char* type)
+{
+    int index = layer_to_index(type);
+    if (index == -1)
+        return 0;
+
+    return create_layer(index);
+}
+
+Layer* create_layer(int index)
+{
+    return create_layer_isa(index, cpu_isa_level());
+}
+
+Layer* create_layer_isa(int index, int isa)
+{
+    if (index < 0 || index >= layer_registry_entry_count)
+        return 0;
+
+    // never pick a variant the running cpu cannot execute
+    if (isa > cpu_isa_level())
+        isa = cpu_isa_level();
+
+    layer_creator_func layer_creator = layer_registry[index].creator;
+
+    int best_isa = TINYINFER_ISA_NAIVE;
+    for (int i = 0; i < layer_registry_isa_entry_count; i++)
+    {
+        const layer_isa_registry_entry& entry = layer_registry_isa[i];
+        if (entry.typeindex != index || entry.isa > isa || entry.isa <= best_isa)
+            continue;
+
+        layer_creator = entry.creator;
+        best_isa = entry.isa;
+    }
+
+    if (!layer_creator)
+        return 0;
+
+    Layer* layer = layer_creator();
+    layer->typeindex = index;
+    layer->type = layer_registry[index].name;
+    return layer;
+}
+
+} // namespace tinyinfer
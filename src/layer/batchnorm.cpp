@@ -0,0 +1,114 @@
+#include "batchnorm.h"
+
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+BatchNorm::BatchNorm()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int BatchNorm::load_param(const ParamDict& pd)
+{
+    channels = pd.get(0, 0);
+    eps = pd.get(1, 0.f);
+
+    return 0;
+}
+
+int BatchNorm::load_model(const ModelBin& mb)
+{
+    // slope mean var bias, var already has epsilon added
+    Mat slope_data = mb.load(channels, 1);
+    if (slope_data.empty())
+        return -100;
+
+    Mat mean_data = mb.load(channels, 1);
+    if (mean_data.empty())
+        return -100;
+
+    Mat var_data = mb.load(channels, 1);
+    if (var_data.empty())
+        return -100;
+
+    Mat bias_data = mb.load(channels, 1);
+    if (bias_data.empty())
+        return -100;
+
+    a_data.create(channels);
+    b_data.create(channels);
+    if (a_data.empty() || b_data.empty())
+        return -100;
+
+    for (int i = 0; i < channels; i++)
+    {
+        float sqrt_var = sqrtf(var_data[i] + eps);
+        a_data[i] = bias_data[i] - slope_data[i] * mean_data[i] / sqrt_var;
+        b_data[i] = slope_data[i] / sqrt_var;
+    }
+
+    return 0;
+}
+
+int BatchNorm::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int dims = bottom_top_blob.dims;
+
+    if (dims == 1)
+    {
+        float* ptr = bottom_top_blob;
+
+        for (int i = 0; i < bottom_top_blob.w; i++)
+        {
+            ptr[i] = b_data[i] * ptr[i] + a_data[i];
+        }
+
+        return 0;
+    }
+
+    if (dims == 2)
+    {
+        const int w = bottom_top_blob.w;
+
+        parallel_for(opt, 0, bottom_top_blob.h, 1, [&](int i0, int i1) {
+            for (int i = i0; i < i1; i++)
+            {
+                float* ptr = bottom_top_blob.row(i);
+                const float a = a_data[i];
+                const float b = b_data[i];
+
+                for (int j = 0; j < w; j++)
+                {
+                    ptr[j] = b * ptr[j] + a;
+                }
+            }
+        });
+
+        return 0;
+    }
+
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d;
+
+    parallel_for(opt, 0, bottom_top_blob.c, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+            const float a = a_data[q];
+            const float b = b_data[q];
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = b * ptr[i] + a;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(BatchNorm)
+
+} // namespace tinyinfer
@@ -0,0 +1,31 @@
+#ifndef LAYER_BATCHNORM_H
+#define LAYER_BATCHNORM_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class BatchNorm : public Layer
+{
+public:
+    BatchNorm();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int load_model(const ModelBin& mb);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    int channels;
+    // added to var, the converter folds epsilon into var already
+    float eps;
+
+    // y = x * b + a
+    Mat a_data;
+    Mat b_data;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,216 @@
+#include "binaryop.h"
+
+#include "threadpool.h"
+#include <algorithm>
+#include <math.h>
+
+namespace tinyinfer {
+
+BinaryOp::BinaryOp()
+{
+    one_blob_only = false;
+    support_inplace = true;
+}
+
+int BinaryOp::load_param(const ParamDict& pd)
+{
+    op_type = pd.get(0, 0);
+    with_scalar = pd.get(1, 0);
+    b = pd.get(2, 0.f);
+
+    one_blob_only = with_scalar != 0;
+
+    if (op_type < Operation_ADD || op_type > Operation_RATAN2)
+        return -1;
+
+    return 0;
+}
+
+// same data, another shape, a blob of rank below 3 stays one contiguous channel per element of the new c
+static Mat broadcast_view(const Mat& m, int dims, int w, int h, int d, int c)
+{
+    Mat v = m;
+    v.dims = dims;
+    v.w = w;
+    v.h = h;
+    v.d = d;
+    v.c = c;
+    if (m.dims < 3)
+        v.cstep = (size_t)w * h * d;
+    return v;
+}
+
+static Mat broadcast_expand(const Mat& m, const Mat& other, int outdims)
+{
+    if (m.dims == outdims)
+        return m;
+
+    if (m.dims == 1 && outdims == 2)
+        return m.w == other.h ? broadcast_view(m, 2, 1, m.w, 1, 1) : broadcast_view(m, 2, m.w, 1, 1, 1);
+
+    if (m.dims == 1)
+        return m.w == other.c ? broadcast_view(m, outdims, 1, 1, 1, m.w) : broadcast_view(m, outdims, m.w, 1, 1, 1);
+
+    if (m.dims == 2 && outdims == 3)
+        return broadcast_view(m, 3, 1, m.w, 1, m.h);
+
+    if (m.dims == 2)
+        return broadcast_view(m, 4, 1, 1, m.w, m.h);
+
+    // 3d into 4d
+    return broadcast_view(m, 4, 1, m.w, m.h, m.c);
+}
+
+int BinaryOp::broadcast(const Mat& A, const Mat& B, Mat& A2, Mat& B2)
+{
+    if (A.dims < 1 || B.dims < 1)
+        return -1;
+
+    const int outdims = std::max(A.dims, B.dims);
+
+    A2 = broadcast_expand(A, B, outdims);
+    B2 = broadcast_expand(B, A, outdims);
+
+    if ((A2.w != B2.w && A2.w != 1 && B2.w != 1)
+            || (A2.h != B2.h && A2.h != 1 && B2.h != 1)
+            || (A2.d != B2.d && A2.d != 1 && B2.d != 1)
+            || (A2.c != B2.c && A2.c != 1 && B2.c != 1))
+        return -1;
+
+    return 0;
+}
+
+void BinaryOp::create_broadcast_output(const Mat& A2, const Mat& B2, Mat& top_blob, Allocator* allocator)
+{
+    const int outw = std::max(A2.w, B2.w);
+    const int outh = std::max(A2.h, B2.h);
+    const int outd = std::max(A2.d, B2.d);
+    const int outc = std::max(A2.c, B2.c);
+
+    if (A2.dims == 1)
+        top_blob.create(outw, 4u, allocator);
+    else if (A2.dims == 2)
+        top_blob.create(outw, outh, 4u, allocator);
+    else if (A2.dims == 3)
+        top_blob.create(outw, outh, outc, 4u, allocator);
+    else
+        top_blob.create(outw, outh, outd, outc, 4u, allocator);
+}
+
+static float binaryop_ss(float a, float b, int op_type)
+{
+    switch (op_type)
+    {
+    case BinaryOp::Operation_ADD:
+        return a + b;
+    case BinaryOp::Operation_SUB:
+        return a - b;
+    case BinaryOp::Operation_MUL:
+        return a * b;
+    case BinaryOp::Operation_DIV:
+        return a / b;
+    case BinaryOp::Operation_MAX:
+        return std::max(a, b);
+    case BinaryOp::Operation_MIN:
+        return std::min(a, b);
+    case BinaryOp::Operation_POW:
+        return powf(a, b);
+    case BinaryOp::Operation_RSUB:
+        return b - a;
+    case BinaryOp::Operation_RDIV:
+        return b / a;
+    case BinaryOp::Operation_RPOW:
+        return powf(b, a);
+    case BinaryOp::Operation_ATAN2:
+        return atan2f(a, b);
+    case BinaryOp::Operation_RATAN2:
+        return atan2f(b, a);
+    default:
+        return a;
+    }
+}
+
+int BinaryOp::forward_inplace(std::vector<Mat>& bottom_top_blobs, const Option& opt) const
+{
+    if (bottom_top_blobs.size() < 2)
+        return -1;
+
+    const Mat& A = bottom_top_blobs[0];
+    const Mat& B = bottom_top_blobs[1];
+
+    Mat A2;
+    Mat B2;
+    if (broadcast(A, B, A2, B2) != 0)
+        return -1;
+
+    const int outw = std::max(A2.w, B2.w);
+    const int outh = std::max(A2.h, B2.h);
+    const int outd = std::max(A2.d, B2.d);
+    const int outc = std::max(A2.c, B2.c);
+
+    // A is overwritten only when nothing of it is broadcast, otherwise the output gets its own blob
+    Mat top_blob;
+    if (A.dims == A2.dims && A.w == outw && A.h == outh && A.d == outd && A.c == outc)
+    {
+        top_blob = A;
+    }
+    else
+    {
+        create_broadcast_output(A2, B2, top_blob, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+    }
+
+    parallel_for(opt, 0, outc, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            const float* pa = A2.channel(A2.c == 1 ? 0 : q);
+            const float* pb = B2.channel(B2.c == 1 ? 0 : q);
+            float* outptr = top_blob.channel(q);
+
+            for (int z = 0; z < outd; z++)
+            {
+                for (int y = 0; y < outh; y++)
+                {
+                    const float* ra = pa + ((A2.d == 1 ? 0 : z) * A2.h + (A2.h == 1 ? 0 : y)) * A2.w;
+                    const float* rb = pb + ((B2.d == 1 ? 0 : z) * B2.h + (B2.h == 1 ? 0 : y)) * B2.w;
+
+                    for (int x = 0; x < outw; x++)
+                    {
+                        outptr[x] = binaryop_ss(ra[A2.w == 1 ? 0 : x], rb[B2.w == 1 ? 0 : x], op_type);
+                    }
+
+                    outptr += outw;
+                }
+            }
+        }
+    });
+
+    bottom_top_blobs[0] = top_blob;
+
+    return 0;
+}
+
+int BinaryOp::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = binaryop_ss(ptr[i], b, op_type);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(BinaryOp)
+
+} // namespace tinyinfer
@@ -0,0 +1,57 @@
+#ifndef LAYER_BINARYOP_H
+#define LAYER_BINARYOP_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class BinaryOp : public Layer
+{
+public:
+    BinaryOp();
+
+    virtual int load_param(const ParamDict& pd);
+
+    // the output replaces the first blob, written in place when it already has the broadcast shape
+    virtual int forward_inplace(std::vector<Mat>& bottom_top_blobs, const Option& opt) const;
+
+    // with_scalar, the second operand is b
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+    enum OperationType
+    {
+        Operation_ADD = 0,
+        Operation_SUB = 1,
+        Operation_MUL = 2,
+        Operation_DIV = 3,
+        Operation_MAX = 4,
+        Operation_MIN = 5,
+        Operation_POW = 6,
+        Operation_RSUB = 7,
+        Operation_RDIV = 8,
+        Operation_RPOW = 9,
+        Operation_ATAN2 = 10,
+        Operation_RATAN2 = 11
+    };
+
+    // the lower rank operand is expanded to the rank of the other one
+    //   1d   -> (w) on the channel axis when it matches the channel count, otherwise on the w axis
+    //           2d against 2d h, when w matches the other h, is (1, w)
+    //   2d   -> (1, w, h) for 3d and (1, 1, w, h) for 4d
+    //   3d   -> (1, w, h, c) for 4d
+    // then every axis must be equal or 1, the output takes the larger one
+    // A2 and B2 are header only views of A and B with the output rank, return -1 when the shapes do not broadcast
+    static int broadcast(const Mat& A, const Mat& B, Mat& A2, Mat& B2);
+
+    // output blob of the broadcast shape of A2 and B2
+    static void create_broadcast_output(const Mat& A2, const Mat& B2, Mat& top_blob, Allocator* allocator);
+
+public:
+    int op_type;
+    int with_scalar;
+    float b;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,44 @@
+#include "clip.h"
+
+#include "threadpool.h"
+#include <float.h>
+
+namespace tinyinfer {
+
+Clip::Clip()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int Clip::load_param(const ParamDict& pd)
+{
+    min = pd.get(0, -FLT_MAX);
+    max = pd.get(1, FLT_MAX);
+
+    return 0;
+}
+
+int Clip::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = ptr[i] < min ? min : (ptr[i] > max ? max : ptr[i]);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Clip)
+
+} // namespace tinyinfer
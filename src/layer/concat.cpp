@@ -0,0 +1,148 @@
+#include "concat.h"
+
+#include "threadpool.h"
+#include <string.h>
+
+namespace tinyinfer {
+
+Concat::Concat()
+{
+    one_blob_only = false;
+    support_inplace = false;
+}
+
+int Concat::load_param(const ParamDict& pd)
+{
+    axis = pd.get(0, 0);
+
+    return 0;
+}
+
+// the shape outermost first
+static int concat_shape(const Mat& m, int* shape)
+{
+    int count = 0;
+    if (m.dims >= 3)
+        shape[count++] = m.c;
+    if (m.dims == 4)
+        shape[count++] = m.d;
+    if (m.dims >= 2)
+        shape[count++] = m.h;
+    shape[count++] = m.w;
+    return count;
+}
+
+int Concat::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& bottom_blob = bottom_blobs[0];
+    const int dims = bottom_blob.dims;
+    const size_t elemsize = bottom_blob.elemsize;
+    const int positive_axis = axis < 0 ? dims + axis : axis;
+    if (positive_axis < 0 || positive_axis >= dims)
+        return -1;
+
+    int outshape[4];
+    concat_shape(bottom_blob, outshape);
+    outshape[positive_axis] = 0;
+    for (size_t b = 0; b < bottom_blobs.size(); b++)
+    {
+        const Mat& m = bottom_blobs[b];
+        int shape[4];
+        if (m.dims != dims || m.elemsize != elemsize)
+            return -1;
+
+        concat_shape(m, shape);
+        for (int i = 0; i < dims; i++)
+        {
+            if (i != positive_axis && shape[i] != outshape[i])
+                return -1;
+        }
+        outshape[positive_axis] += shape[positive_axis];
+    }
+
+    // a top handed in by the net with this shape is kept, inputs already written into their slice are skipped
+    Mat& top_blob = top_blobs[0];
+    if (dims == 1)
+        top_blob.create(outshape[0], elemsize, opt.blob_allocator);
+    if (dims == 2)
+        top_blob.create(outshape[1], outshape[0], elemsize, opt.blob_allocator);
+    if (dims == 3)
+        top_blob.create(outshape[2], outshape[1], outshape[0], elemsize, opt.blob_allocator);
+    if (dims == 4)
+        top_blob.create(outshape[3], outshape[2], outshape[1], outshape[0], elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    if (dims >= 3 && positive_axis == 0)
+    {
+        // channel ranges
+        const size_t size = (size_t)top_blob.w * top_blob.h * top_blob.d * elemsize;
+
+        int q = 0;
+        for (size_t b = 0; b < bottom_blobs.size(); b++)
+        {
+            const Mat& m = bottom_blobs[b];
+            Mat dst = top_blob.channel_range(q, m.c);
+            q += m.c;
+
+            if (dst.data == m.data)
+                continue;
+
+            add_mat_copy_bytes(size * m.c);
+            parallel_for(opt, 0, m.c, mat_parallel_grain(size), [&](int c0, int c1) {
+                for (int i = c0; i < c1; i++)
+                {
+                    memcpy(dst.channel(i), m.channel(i), size);
+                }
+            });
+        }
+
+        return 0;
+    }
+
+    // inside one channel the axis splits each plane into outer blocks of n * inner contiguous elements
+    int outer = 1;
+    for (int i = dims >= 3 ? 1 : 0; i < positive_axis; i++)
+        outer *= outshape[i];
+    size_t inner = elemsize;
+    for (int i = positive_axis + 1; i < dims; i++)
+        inner *= outshape[i];
+
+    const int channels = dims >= 3 ? top_blob.c : 1;
+    const size_t out_block = (size_t)outshape[positive_axis] * inner;
+
+    size_t offset = 0;
+    for (size_t b = 0; b < bottom_blobs.size(); b++)
+    {
+        const Mat& m = bottom_blobs[b];
+        int shape[4];
+        concat_shape(m, shape);
+        const size_t block = (size_t)shape[positive_axis] * inner;
+
+        if (channels == 1 && outer == 1 && (unsigned char*)top_blob.data + offset == m.data)
+        {
+            offset += block;
+            continue;
+        }
+
+        add_mat_copy_bytes(block * outer * channels);
+        parallel_for(opt, 0, channels * outer, mat_parallel_grain(block), [&](int t0, int t1) {
+            for (int t = t0; t < t1; t++)
+            {
+                const int q = t / outer;
+                const int o = t % outer;
+                unsigned char* outptr = (unsigned char*)top_blob.data + top_blob.cstep * q * elemsize + o * out_block + offset;
+                const unsigned char* ptr = (const unsigned char*)m.data + m.cstep * q * elemsize + o * block;
+                memcpy(outptr, ptr, block);
+            }
+        });
+
+        offset += block;
+    }
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Concat)
+
+} // namespace tinyinfer
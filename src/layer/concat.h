@@ -0,0 +1,24 @@
+#ifndef LAYER_CONCAT_H
+#define LAYER_CONCAT_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Concat : public Layer
+{
+public:
+    Concat();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+public:
+    // outermost first, negative counts from the last axis
+    int axis;
+};
+
+} // namespace tinyinfer
+
+#endif
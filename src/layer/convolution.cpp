@@ -0,0 +1,230 @@
+#include "convolution.h"
+
+#include "fused_activation.h"
+#include "threadpool.h"
+
+#include <vector>
+
+namespace tinyinfer {
+
+Convolution::Convolution()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Convolution::load_param(const ParamDict& pd)
+{
+    num_output = pd.get(0, 0);
+    kernel_w = pd.get(1, 0);
+    kernel_h = pd.get(11, kernel_w);
+    dilation_w = pd.get(2, 1);
+    dilation_h = pd.get(12, dilation_w);
+    stride_w = pd.get(3, 1);
+    stride_h = pd.get(13, stride_w);
+    pad_left = pd.get(4, 0);
+    pad_right = pd.get(15, pad_left);
+    pad_top = pd.get(14, pad_left);
+    pad_bottom = pd.get(16, pad_top);
+    pad_value = pd.get(18, 0.f);
+    bias_term = pd.get(5, 0);
+    weight_data_size = pd.get(6, 0);
+    activation_type = pd.get(9, 0);
+    activation_params = pd.get(10, Mat());
+
+    if (num_output <= 0 || kernel_w <= 0 || kernel_h <= 0 || weight_data_size % (num_output * kernel_w * kernel_h) != 0)
+        return -1;
+
+    return 0;
+}
+
+int Convolution::load_model(const ModelBin& mb)
+{
+    weight_data = mb.load(weight_data_size, 0);
+    if (weight_data.empty())
+        return -100;
+
+    if (bias_term)
+    {
+        bias_data = mb.load(num_output, 1);
+        if (bias_data.empty())
+            return -100;
+    }
+
+    return 0;
+}
+
+void Convolution::resolve_padding(int w, int h, int& pad_l, int& pad_r, int& pad_t, int& pad_b) const
+{
+    if (pad_left != -233 && pad_left != -234)
+    {
+        pad_l = pad_left;
+        pad_r = pad_right;
+        pad_t = pad_top;
+        pad_b = pad_bottom;
+        return;
+    }
+
+    // SAME keeps ceil(size / stride) outputs, the odd pixel goes after for SAME_UPPER
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    int wpad = kernel_extent_w + (w - 1) / stride_w * stride_w - w;
+    int hpad = kernel_extent_h + (h - 1) / stride_h * stride_h - h;
+    wpad = wpad > 0 ? wpad : 0;
+    hpad = hpad > 0 ? hpad : 0;
+
+    if (pad_left == -233)
+    {
+        pad_l = wpad / 2;
+        pad_t = hpad / 2;
+    }
+    else
+    {
+        pad_l = wpad - wpad / 2;
+        pad_t = hpad - hpad / 2;
+    }
+    pad_r = wpad - pad_l;
+    pad_b = hpad - pad_t;
+}
+
+int Convolution::make_padding(const Mat& bottom_blob, Mat& bottom_blob_bordered, int extra_right, int extra_bottom, const Option& opt) const
+{
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+
+    int pad_l, pad_r, pad_t, pad_b;
+    resolve_padding(w, h, pad_l, pad_r, pad_t, pad_b);
+
+    if (pad_l == 0 && pad_r == 0 && pad_t == 0 && pad_b == 0 && extra_right == 0 && extra_bottom == 0)
+    {
+        bottom_blob_bordered = bottom_blob;
+        return 0;
+    }
+
+    const int outw = w + pad_l + pad_r + extra_right;
+    const int outh = h + pad_t + pad_b + extra_bottom;
+
+    bottom_blob_bordered.create(outw, outh, bottom_blob.c, 4u, opt.workspace_allocator);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    parallel_for(opt, 0, bottom_blob.c, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = bottom_blob_bordered.channel(q);
+
+            for (int y = 0; y < outh; y++)
+            {
+                float* row = outptr + (size_t)outw * y;
+
+                if (y >= h + pad_t + pad_b)
+                {
+                    for (int x = 0; x < outw; x++)
+                        row[x] = 0.f;
+                    continue;
+                }
+
+                if (y < pad_t || y >= h + pad_t)
+                {
+                    for (int x = 0; x < outw; x++)
+                        row[x] = pad_value;
+                    continue;
+                }
+
+                const float* inrow = ptr + (size_t)w * (y - pad_t);
+                for (int x = 0; x < pad_l; x++)
+                    row[x] = pad_value;
+                for (int x = 0; x < w; x++)
+                    row[pad_l + x] = inrow[x];
+                for (int x = pad_l + w; x < outw - extra_right; x++)
+                    row[x] = pad_value;
+                for (int x = outw - extra_right; x < outw; x++)
+                    row[x] = 0.f;
+            }
+        }
+    });
+
+    return 0;
+}
+
+int Convolution::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    if (bottom_blob.dims != 3 || bottom_blob.c != num_input)
+        return -1;
+
+    Mat bottom_blob_bordered;
+    int ret = make_padding(bottom_blob, bottom_blob_bordered, 0, 0, opt);
+    if (ret != 0)
+        return ret;
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+    const int outh = (h - kernel_extent_h) / stride_h + 1;
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // offset of every kernel tap inside one input channel
+    std::vector<int> space_ofs(maxk);
+    for (int i = 0; i < kernel_h; i++)
+    {
+        for (int j = 0; j < kernel_w; j++)
+        {
+            space_ofs[i * kernel_w + j] = i * dilation_h * w + j * dilation_w;
+        }
+    }
+
+    const float* activation_ptr = activation_params;
+
+    parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+        for (int p = p0; p < p1; p++)
+        {
+            float* outptr = top_blob.channel(p);
+
+            for (int i = 0; i < outh; i++)
+            {
+                for (int j = 0; j < outw; j++)
+                {
+                    float sum = bias_term ? bias_data[p] : 0.f;
+
+                    const float* kptr = (const float*)weight_data + (size_t)maxk * num_input * p;
+
+                    for (int q = 0; q < num_input; q++)
+                    {
+                        const float* sptr = bottom_blob_bordered.channel(q).row(i * stride_h) + j * stride_w;
+
+                        for (int k = 0; k < maxk; k++)
+                        {
+                            sum += sptr[space_ofs[k]] * kptr[k];
+                        }
+
+                        kptr += maxk;
+                    }
+
+                    outptr[j] = activation_ss(sum, activation_type, activation_ptr);
+                }
+
+                outptr += outw;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Convolution)
+
+} // namespace tinyinfer
@@ -0,0 +1,57 @@
+#ifndef LAYER_CONVOLUTION_H
+#define LAYER_CONVOLUTION_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Convolution : public Layer
+{
+public:
+    Convolution();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int load_model(const ModelBin& mb);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+protected:
+    // resolve explicit or SAME padding for a w x h input
+    void resolve_padding(int w, int h, int& pad_l, int& pad_r, int& pad_t, int& pad_b) const;
+
+    // bordered copy of bottom_blob filled with pad_value, extra_right zero columns and extra_bottom zero rows are appended
+    // bottom_blob itself is referenced when nothing is added
+    int make_padding(const Mat& bottom_blob, Mat& bottom_blob_bordered, int extra_right, int extra_bottom, const Option& opt) const;
+
+public:
+    // param
+    int num_output;
+    int kernel_w;
+    int kernel_h;
+    int dilation_w;
+    int dilation_h;
+    int stride_w;
+    int stride_h;
+    // -233 = SAME_UPPER, -234 = SAME_LOWER
+    int pad_left;
+    int pad_right;
+    int pad_top;
+    int pad_bottom;
+    float pad_value;
+    int bias_term;
+
+    int weight_data_size;
+
+    // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid 5=mish 6=hardswish
+    int activation_type;
+    Mat activation_params;
+
+    // model, num_output x num_input x kernel_h x kernel_w
+    Mat weight_data;
+    Mat bias_data;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,110 @@
+#include "convolutiondepthwise.h"
+
+#include "fused_activation.h"
+#include "threadpool.h"
+
+#include <vector>
+
+namespace tinyinfer {
+
+ConvolutionDepthWise::ConvolutionDepthWise()
+{
+}
+
+int ConvolutionDepthWise::load_param(const ParamDict& pd)
+{
+    int ret = Convolution::load_param(pd);
+    if (ret != 0)
+        return ret;
+
+    group = pd.get(7, 1);
+
+    if (group <= 0 || num_output % group != 0 || weight_data_size % group != 0)
+        return -1;
+
+    return 0;
+}
+
+int ConvolutionDepthWise::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_output_g = num_output / group;
+    const int num_input_g = weight_data_size / maxk / num_output;
+    const int num_input = num_input_g * group;
+
+    if (bottom_blob.dims != 3 || bottom_blob.c != num_input)
+        return -1;
+
+    Mat bottom_blob_bordered;
+    int ret = make_padding(bottom_blob, bottom_blob_bordered, 0, 0, opt);
+    if (ret != 0)
+        return ret;
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+    const int outh = (h - kernel_extent_h) / stride_h + 1;
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // offset of every kernel tap inside one input channel
+    std::vector<int> space_ofs(maxk);
+    for (int i = 0; i < kernel_h; i++)
+    {
+        for (int j = 0; j < kernel_w; j++)
+        {
+            space_ofs[i * kernel_w + j] = i * dilation_h * w + j * dilation_w;
+        }
+    }
+
+    const float* activation_ptr = activation_params;
+
+    parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+        for (int p = p0; p < p1; p++)
+        {
+            const int g = p / num_output_g;
+
+            float* outptr = top_blob.channel(p);
+
+            for (int i = 0; i < outh; i++)
+            {
+                for (int j = 0; j < outw; j++)
+                {
+                    float sum = bias_term ? bias_data[p] : 0.f;
+
+                    const float* kptr = (const float*)weight_data + (size_t)maxk * num_input_g * p;
+
+                    for (int q = 0; q < num_input_g; q++)
+                    {
+                        const float* sptr = bottom_blob_bordered.channel(g * num_input_g + q).row(i * stride_h) + j * stride_w;
+
+                        for (int k = 0; k < maxk; k++)
+                        {
+                            sum += sptr[space_ofs[k]] * kptr[k];
+                        }
+
+                        kptr += maxk;
+                    }
+
+                    outptr[j] = activation_ss(sum, activation_type, activation_ptr);
+                }
+
+                outptr += outw;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(ConvolutionDepthWise)
+
+} // namespace tinyinfer
@@ -0,0 +1,26 @@
+#ifndef LAYER_CONVOLUTIONDEPTHWISE_H
+#define LAYER_CONVOLUTIONDEPTHWISE_H
+
+#include "convolution.h"
+
+namespace tinyinfer {
+
+// grouped convolution, every group convolves num_input / group channels into num_output / group channels
+// group == num_input == num_output is the depthwise case
+class ConvolutionDepthWise : public Convolution
+{
+public:
+    ConvolutionDepthWise();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // param, weight_data holds num_output x (num_input / group) x kernel_h x kernel_w
+    int group;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,173 @@
+#include "deconvolution.h"
+
+#include "fused_activation.h"
+#include "threadpool.h"
+
+namespace tinyinfer {
+
+DeConvolution::DeConvolution()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int DeConvolution::load_param(const ParamDict& pd)
+{
+    num_output = pd.get(0, 0);
+    kernel_w = pd.get(1, 0);
+    kernel_h = pd.get(11, kernel_w);
+    dilation_w = pd.get(2, 1);
+    dilation_h = pd.get(12, dilation_w);
+    stride_w = pd.get(3, 1);
+    stride_h = pd.get(13, stride_w);
+    pad_left = pd.get(4, 0);
+    pad_right = pd.get(15, pad_left);
+    pad_top = pd.get(14, pad_left);
+    pad_bottom = pd.get(16, pad_top);
+    output_pad_right = pd.get(18, 0);
+    output_pad_bottom = pd.get(19, output_pad_right);
+    output_w = pd.get(20, 0);
+    output_h = pd.get(21, output_w);
+    bias_term = pd.get(5, 0);
+    weight_data_size = pd.get(6, 0);
+    activation_type = pd.get(9, 0);
+    activation_params = pd.get(10, Mat());
+
+    if (num_output <= 0 || kernel_w <= 0 || kernel_h <= 0 || stride_w <= 0 || stride_h <= 0 || weight_data_size % (num_output * kernel_w * kernel_h) != 0)
+        return -1;
+
+    return 0;
+}
+
+int DeConvolution::load_model(const ModelBin& mb)
+{
+    weight_data = mb.load(weight_data_size, 0);
+    if (weight_data.empty())
+        return -100;
+
+    if (bias_term)
+    {
+        bias_data = mb.load(num_output, 1);
+        if (bias_data.empty())
+            return -100;
+    }
+
+    return 0;
+}
+
+void DeConvolution::resolve_output(int w, int h, int& outw, int& outh, int& crop_l, int& crop_t) const
+{
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int full_w = (w - 1) * stride_w + kernel_extent_w + output_pad_right;
+    const int full_h = (h - 1) * stride_h + kernel_extent_h + output_pad_bottom;
+
+    const bool same = pad_left == -233 || pad_left == -234;
+
+    if (output_w > 0 && output_h > 0)
+    {
+        outw = output_w;
+        outh = output_h;
+    }
+    else if (same)
+    {
+        // SAME keeps size * stride outputs
+        outw = w * stride_w;
+        outh = h * stride_h;
+    }
+    else
+    {
+        outw = full_w - pad_left - pad_right;
+        outh = full_h - pad_top - pad_bottom;
+        crop_l = pad_left;
+        crop_t = pad_top;
+        return;
+    }
+
+    // the odd pixel is cropped from the end for SAME_UPPER and from the start otherwise, as onnx does
+    const int wcut = full_w - outw;
+    const int hcut = full_h - outh;
+    crop_l = pad_left == -233 ? wcut / 2 : wcut - wcut / 2;
+    crop_t = pad_left == -233 ? hcut / 2 : hcut - hcut / 2;
+}
+
+int DeConvolution::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    if (bottom_blob.dims != 3 || bottom_blob.c != num_input)
+        return -1;
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+
+    int outw, outh, crop_l, crop_t;
+    resolve_output(w, h, outw, outh, crop_l, crop_t);
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const float* activation_ptr = activation_params;
+
+    // gather form, output pixel y of the full output takes tap ky from input row (y - ky * dilation) / stride when that divides
+    parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+        for (int p = p0; p < p1; p++)
+        {
+            float* outptr = top_blob.channel(p);
+
+            for (int i = 0; i < outh; i++)
+            {
+                const int y = i + crop_t;
+
+                for (int j = 0; j < outw; j++)
+                {
+                    const int x = j + crop_l;
+
+                    float sum = bias_term ? bias_data[p] : 0.f;
+
+                    const float* kptr = (const float*)weight_data + (size_t)maxk * num_input * p;
+
+                    for (int q = 0; q < num_input; q++)
+                    {
+                        const Mat img = bottom_blob.channel(q);
+
+                        for (int ky = 0; ky < kernel_h; ky++)
+                        {
+                            const int sy = y - ky * dilation_h;
+                            if (sy < 0 || sy % stride_h != 0 || sy / stride_h >= h)
+                                continue;
+
+                            const float* sptr = img.row(sy / stride_h);
+
+                            for (int kx = 0; kx < kernel_w; kx++)
+                            {
+                                const int sx = x - kx * dilation_w;
+                                if (sx < 0 || sx % stride_w != 0 || sx / stride_w >= w)
+                                    continue;
+
+                                sum += sptr[sx / stride_w] * kptr[ky * kernel_w + kx];
+                            }
+                        }
+
+                        kptr += maxk;
+                    }
+
+                    outptr[j] = activation_ss(sum, activation_type, activation_ptr);
+                }
+
+                outptr += outw;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(DeConvolution)
+
+} // namespace tinyinfer
@@ -0,0 +1,61 @@
+#ifndef LAYER_DECONVOLUTION_H
+#define LAYER_DECONVOLUTION_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+// transposed convolution, every input pixel scatters kernel_h x kernel_w taps into the output at stride spacing
+// the full output is (w - 1) * stride + kernel_extent + output_pad, pads crop it back
+class DeConvolution : public Layer
+{
+public:
+    DeConvolution();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int load_model(const ModelBin& mb);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+protected:
+    // output size for a w x h input and the offset of the output window inside the full output
+    // the offset is negative when output_w / output_h asks for more than the full output
+    void resolve_output(int w, int h, int& outw, int& outh, int& crop_l, int& crop_t) const;
+
+public:
+    // param
+    int num_output;
+    int kernel_w;
+    int kernel_h;
+    int dilation_w;
+    int dilation_h;
+    int stride_w;
+    int stride_h;
+    // cropped from the full output, -233 = SAME_UPPER, -234 = SAME_LOWER
+    int pad_left;
+    int pad_right;
+    int pad_top;
+    int pad_bottom;
+    // extra columns and rows appended to the full output
+    int output_pad_right;
+    int output_pad_bottom;
+    // explicit output size, the crop is derived from it and pads only choose the SAME side
+    int output_w;
+    int output_h;
+    int bias_term;
+
+    int weight_data_size;
+
+    // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid 5=mish 6=hardswish
+    int activation_type;
+    Mat activation_params;
+
+    // model, num_output x num_input x kernel_h x kernel_w
+    Mat weight_data;
+    Mat bias_data;
+};
+
+} // namespace tinyinfer
+
+#endif
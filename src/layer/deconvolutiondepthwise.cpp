@@ -0,0 +1,107 @@
+#include "deconvolutiondepthwise.h"
+
+#include "fused_activation.h"
+#include "threadpool.h"
+
+namespace tinyinfer {
+
+DeConvolutionDepthWise::DeConvolutionDepthWise()
+{
+}
+
+int DeConvolutionDepthWise::load_param(const ParamDict& pd)
+{
+    int ret = DeConvolution::load_param(pd);
+    if (ret != 0)
+        return ret;
+
+    group = pd.get(7, 1);
+
+    if (group <= 0 || num_output % group != 0 || weight_data_size % group != 0)
+        return -1;
+
+    return 0;
+}
+
+int DeConvolutionDepthWise::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_output_g = num_output / group;
+    const int num_input_g = weight_data_size / maxk / num_output;
+    const int num_input = num_input_g * group;
+
+    if (bottom_blob.dims != 3 || bottom_blob.c != num_input)
+        return -1;
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+
+    int outw, outh, crop_l, crop_t;
+    resolve_output(w, h, outw, outh, crop_l, crop_t);
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const float* activation_ptr = activation_params;
+
+    parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+        for (int p = p0; p < p1; p++)
+        {
+            const int g = p / num_output_g;
+
+            float* outptr = top_blob.channel(p);
+
+            for (int i = 0; i < outh; i++)
+            {
+                const int y = i + crop_t;
+
+                for (int j = 0; j < outw; j++)
+                {
+                    const int x = j + crop_l;
+
+                    float sum = bias_term ? bias_data[p] : 0.f;
+
+                    const float* kptr = (const float*)weight_data + (size_t)maxk * num_input_g * p;
+
+                    for (int q = 0; q < num_input_g; q++)
+                    {
+                        const Mat img = bottom_blob.channel(g * num_input_g + q);
+
+                        for (int ky = 0; ky < kernel_h; ky++)
+                        {
+                            const int sy = y - ky * dilation_h;
+                            if (sy < 0 || sy % stride_h != 0 || sy / stride_h >= h)
+                                continue;
+
+                            const float* sptr = img.row(sy / stride_h);
+
+                            for (int kx = 0; kx < kernel_w; kx++)
+                            {
+                                const int sx = x - kx * dilation_w;
+                                if (sx < 0 || sx % stride_w != 0 || sx / stride_w >= w)
+                                    continue;
+
+                                sum += sptr[sx / stride_w] * kptr[ky * kernel_w + kx];
+                            }
+                        }
+
+                        kptr += maxk;
+                    }
+
+                    outptr[j] = activation_ss(sum, activation_type, activation_ptr);
+                }
+
+                outptr += outw;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(DeConvolutionDepthWise)
+
+} // namespace tinyinfer
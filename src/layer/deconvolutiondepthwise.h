@@ -0,0 +1,25 @@
+#ifndef LAYER_DECONVOLUTIONDEPTHWISE_H
+#define LAYER_DECONVOLUTIONDEPTHWISE_H
+
+#include "deconvolution.h"
+
+namespace tinyinfer {
+
+// grouped transposed convolution, every group scatters num_input / group channels into num_output / group channels
+class DeConvolutionDepthWise : public DeConvolution
+{
+public:
+    DeConvolutionDepthWise();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // param, weight_data holds num_output x (num_input / group) x kernel_h x kernel_w
+    int group;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,45 @@
+#include "dropout.h"
+
+#include "threadpool.h"
+
+namespace tinyinfer {
+
+Dropout::Dropout()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int Dropout::load_param(const ParamDict& pd)
+{
+    scale = pd.get(0, 1.f);
+
+    return 0;
+}
+
+int Dropout::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    if (scale == 1.f)
+        return 0;
+
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] *= scale;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Dropout)
+
+} // namespace tinyinfer
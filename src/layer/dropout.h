@@ -0,0 +1,24 @@
+#ifndef LAYER_DROPOUT_H
+#define LAYER_DROPOUT_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Dropout : public Layer
+{
+public:
+    Dropout();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    // inference time scale, 1 leaves the blob untouched
+    float scale;
+};
+
+} // namespace tinyinfer
+
+#endif
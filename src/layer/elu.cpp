@@ -0,0 +1,44 @@
+#include "elu.h"
+
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+ELU::ELU()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int ELU::load_param(const ParamDict& pd)
+{
+    alpha = pd.get(0, 0.1f);
+
+    return 0;
+}
+
+int ELU::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                if (ptr[i] < 0.f)
+                    ptr[i] = alpha * expm1f(ptr[i]);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(ELU)
+
+} // namespace tinyinfer
@@ -0,0 +1,24 @@
+#ifndef LAYER_ELU_H
+#define LAYER_ELU_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class ELU : public Layer
+{
+public:
+    ELU();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    // x below 0 becomes alpha * (exp(x) - 1)
+    float alpha;
+};
+
+} // namespace tinyinfer
+
+#endif
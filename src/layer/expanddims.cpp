@@ -0,0 +1,68 @@
+#include "expanddims.h"
+
+namespace tinyinfer {
+
+ExpandDims::ExpandDims()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int ExpandDims::load_param(const ParamDict& pd)
+{
+    axes = pd.get(3, Mat());
+
+    return 0;
+}
+
+int ExpandDims::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int dims = bottom_blob.dims;
+    const int outdims = dims + axes.w;
+    if (axes.w == 0 || outdims > 4)
+        return -1;
+
+    bool expand[4] = {false, false, false, false};
+    const int* axes_ptr = axes;
+    for (int i = 0; i < axes.w; i++)
+    {
+        const int axis = axes_ptr[i] < 0 ? outdims + axes_ptr[i] : axes_ptr[i];
+        if (axis < 0 || axis >= outdims || expand[axis])
+            return -1;
+
+        expand[axis] = true;
+    }
+
+    // outermost first
+    int shape[4];
+    int count = 0;
+    if (dims >= 3)
+        shape[count++] = bottom_blob.c;
+    if (dims == 4)
+        shape[count++] = bottom_blob.d;
+    if (dims >= 2)
+        shape[count++] = bottom_blob.h;
+    shape[count++] = bottom_blob.w;
+
+    int outshape[4];
+    for (int i = 0, j = 0; i < outdims; i++)
+    {
+        outshape[i] = expand[i] ? 1 : shape[j++];
+    }
+
+    // a view of the bottom unless the channel padding moves
+    if (outdims == 2)
+        top_blob = bottom_blob.reshape(outshape[1], outshape[0], opt.blob_allocator);
+    if (outdims == 3)
+        top_blob = bottom_blob.reshape(outshape[2], outshape[1], outshape[0], opt.blob_allocator);
+    if (outdims == 4)
+        top_blob = bottom_blob.reshape(outshape[3], outshape[2], outshape[1], outshape[0], opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(ExpandDims)
+
+} // namespace tinyinfer
@@ -0,0 +1,25 @@
+#ifndef LAYER_EXPANDDIMS_H
+#define LAYER_EXPANDDIMS_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class ExpandDims : public Layer
+{
+public:
+    ExpandDims();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // positions of the new axes of 1 in the top, outermost first
+    // negative counts from the last axis of the top
+    Mat axes;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,23 @@
+#include "flatten.h"
+
+namespace tinyinfer {
+
+Flatten::Flatten()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Flatten::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // a view of the bottom unless its channels are padded
+    top_blob = bottom_blob.reshape(bottom_blob.w * bottom_blob.h * bottom_blob.d * bottom_blob.c, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Flatten)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_FLATTEN_H
+#define LAYER_FLATTEN_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Flatten : public Layer
+{
+public:
+    Flatten();
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef LAYER_FUSED_ACTIVATION_H
+#define LAYER_FUSED_ACTIVATION_H
+
+#include "mat.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+// activation fused into the output of gemm like layers
+// 0 = none, 1 = relu, 2 = leakyrelu(slope), 3 = clip(min, max), 4 = sigmoid, 5 = mish, 6 = hardswish(alpha, beta)
+static inline float activation_ss(float v, int activation_type, const float* activation_params)
+{
+    switch (activation_type)
+    {
+    case 1:
+        return v > 0.f ? v : 0.f;
+    case 2:
+        return v > 0.f ? v : v * activation_params[0];
+    case 3:
+        return v < activation_params[0] ? activation_params[0] : (v > activation_params[1] ? activation_params[1] : v);
+    case 4:
+        return 1.f / (1.f + expf(-v));
+    case 5:
+        return v * tanhf(log1pf(expf(v)));
+    case 6:
+    {
+        const float alpha = activation_params[0];
+        const float beta = activation_params[1];
+        const float lower = -beta / alpha;
+        const float upper = (1.f / alpha) + lower;
+        if (v < lower)
+            return 0.f;
+        if (v > upper)
+            return v;
+        return v * (v * alpha + beta);
+    }
+    default:
+        return v;
+    }
+}
+
+// the switch is hoisted out of the loop so the common cases vectorize
+static inline void activation_inplace(float* ptr, int size, int activation_type, const float* activation_params)
+{
+    if (activation_type == 0)
+        return;
+
+    if (activation_type == 1)
+    {
+        for (int i = 0; i < size; i++)
+            ptr[i] = ptr[i] > 0.f ? ptr[i] : 0.f;
+        return;
+    }
+
+    if (activation_type == 2)
+    {
+        const float slope = activation_params[0];
+        for (int i = 0; i < size; i++)
+            ptr[i] = ptr[i] > 0.f ? ptr[i] : ptr[i] * slope;
+        return;
+    }
+
+    if (activation_type == 3)
+    {
+        const float min = activation_params[0];
+        const float max = activation_params[1];
+        for (int i = 0; i < size; i++)
+            ptr[i] = ptr[i] < min ? min : (ptr[i] > max ? max : ptr[i]);
+        return;
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        ptr[i] = activation_ss(ptr[i], activation_type, activation_params);
+    }
+}
+
+} // namespace tinyinfer
+
+#endif
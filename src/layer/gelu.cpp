@@ -0,0 +1,50 @@
+#include "gelu.h"
+
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+GELU::GELU()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int GELU::load_param(const ParamDict& pd)
+{
+    approximate = pd.get(0, 0);
+
+    if (approximate != 0 && approximate != 1)
+        return -1;
+
+    return 0;
+}
+
+int GELU::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                const float x = ptr[i];
+                if (approximate)
+                    ptr[i] = 0.5f * x * (1.f + tanhf(0.79788456f * (x + 0.044715f * x * x * x)));
+                else
+                    ptr[i] = 0.5f * x * erfcf(-0.70710678f * x);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(GELU)
+
+} // namespace tinyinfer
@@ -0,0 +1,24 @@
+#ifndef LAYER_GELU_H
+#define LAYER_GELU_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class GELU : public Layer
+{
+public:
+    GELU();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    // 0 = exact x * Phi(x) through erf, 1 = tanh approximation
+    int approximate;
+};
+
+} // namespace tinyinfer
+
+#endif
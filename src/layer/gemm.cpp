@@ -0,0 +1,180 @@
+#include "gemm.h"
+
+#include "threadpool.h"
+
+namespace tinyinfer {
+
+Gemm::Gemm()
+{
+    one_blob_only = false;
+    support_inplace = false;
+}
+
+int Gemm::load_param(const ParamDict& pd)
+{
+    alpha = pd.get(0, 1.f);
+    beta = pd.get(1, 1.f);
+    transA = pd.get(2, 0);
+    transB = pd.get(3, 0);
+
+    return 0;
+}
+
+int Gemm::resolve_operands(const std::vector<Mat>& bottom_blobs, GemmOperands& g) const
+{
+    if (bottom_blobs.size() < 2)
+        return -1;
+
+    const Mat& A = bottom_blobs[0];
+    const Mat& B = bottom_blobs[1];
+    if (A.dims > 3 || B.dims > 3)
+        return -1;
+
+    g.A = A;
+    g.B = B;
+
+    // a 1d operand is a single row of A or a single column of B
+    if (A.dims == 1)
+    {
+        g.M = 1;
+        g.K = A.w;
+        g.transA = 0;
+        g.lda = A.w;
+    }
+    else
+    {
+        g.M = transA ? A.w : A.h;
+        g.K = transA ? A.h : A.w;
+        g.transA = transA;
+        g.lda = A.w;
+    }
+
+    int KB;
+    if (B.dims == 1)
+    {
+        g.N = 1;
+        KB = B.w;
+        g.transB = 0;
+        g.ldb = 1;
+    }
+    else
+    {
+        g.N = transB ? B.h : B.w;
+        KB = transB ? B.w : B.h;
+        g.transB = transB;
+        g.ldb = B.w;
+    }
+
+    if (KB != g.K)
+        return -1;
+
+    g.A_batched = A.dims == 3 && A.c > 1;
+    g.B_batched = B.dims == 3 && B.c > 1;
+    if (g.A_batched && g.B_batched && A.c != B.c)
+        return -1;
+
+    g.batch = g.A_batched ? A.c : (g.B_batched ? B.c : 1);
+
+    if (A.dims == 1 || B.dims == 1)
+        g.out_dims = 1;
+    else if (A.dims == 3 || B.dims == 3)
+        g.out_dims = 3;
+    else
+        g.out_dims = 2;
+
+    g.C_type = 0;
+    if (bottom_blobs.size() >= 3 && beta != 0.f)
+    {
+        const Mat& C = bottom_blobs[2];
+        g.C = C;
+
+        if (C.dims == 1 && C.w == 1)
+            g.C_type = 1;
+        else if (C.dims == 1 && C.w == g.N)
+            g.C_type = 3;
+        else if (C.dims == 2 && C.w == 1 && C.h == g.M)
+            g.C_type = 2;
+        else if (C.dims == 2 && C.w == g.N && C.h == 1)
+            g.C_type = 3;
+        else if (C.dims == 2 && C.w == g.N && C.h == g.M)
+            g.C_type = 4;
+        else
+            return -1;
+    }
+
+    return 0;
+}
+
+int Gemm::create_top_blob(const GemmOperands& g, Mat& top_blob, const Option& opt) const
+{
+    if (g.out_dims == 1)
+        top_blob.create(g.N == 1 ? g.M : g.N, 4u, opt.blob_allocator);
+    else if (g.out_dims == 2)
+        top_blob.create(g.N, g.M, 4u, opt.blob_allocator);
+    else
+        top_blob.create(g.N, g.M, g.batch, 4u, opt.blob_allocator);
+
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+int Gemm::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    GemmOperands g;
+    int ret = resolve_operands(bottom_blobs, g);
+    if (ret != 0)
+        return ret;
+
+    Mat& top_blob = top_blobs[0];
+    ret = create_top_blob(g, top_blob, opt);
+    if (ret != 0)
+        return ret;
+
+    const int M = g.M;
+    const int N = g.N;
+    const int K = g.K;
+    const float* cptr = g.C;
+
+    parallel_for(opt, 0, g.batch * M, 1, [&](int t0, int t1) {
+        for (int t = t0; t < t1; t++)
+        {
+            const int b = t / M;
+            const int i = t % M;
+
+            const float* ptrA = g.A_batched ? (const float*)g.A.channel(b) : (const float*)g.A;
+            const float* ptrB = g.B_batched ? (const float*)g.B.channel(b) : (const float*)g.B;
+            float* outptr = (g.out_dims == 3 ? (float*)top_blob.channel(b) : (float*)top_blob) + (size_t)N * i;
+
+            for (int j = 0; j < N; j++)
+            {
+                float sum = 0.f;
+                for (int k = 0; k < K; k++)
+                {
+                    float a = g.transA ? ptrA[(size_t)k * g.lda + i] : ptrA[(size_t)i * g.lda + k];
+                    float v = g.transB ? ptrB[(size_t)j * g.ldb + k] : ptrB[(size_t)k * g.ldb + j];
+                    sum += a * v;
+                }
+
+                float c = 0.f;
+                if (g.C_type == 1)
+                    c = cptr[0];
+                if (g.C_type == 2)
+                    c = cptr[i];
+                if (g.C_type == 3)
+                    c = cptr[j];
+                if (g.C_type == 4)
+                    c = cptr[(size_t)N * i + j];
+
+                outptr[j] = alpha * sum + beta * c;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Gemm)
+
+} // namespace tinyinfer
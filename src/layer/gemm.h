@@ -0,0 +1,59 @@
+#ifndef LAYER_GEMM_H
+#define LAYER_GEMM_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+// operands of one forward call, 3d operands are batched over channels
+struct GemmOperands
+{
+    int M;
+    int N;
+    int K;
+    int batch;
+
+    // A(m, k) = transA ? A[k * lda + m] : A[m * lda + k]
+    // B(k, n) = transB ? B[n * ldb + k] : B[k * ldb + n]
+    Mat A;
+    Mat B;
+    int transA;
+    int transB;
+    int lda;
+    int ldb;
+    bool A_batched;
+    bool B_batched;
+
+    // beta * C, 0=none 1=scalar 2=per row 3=per column 4=full M x N
+    Mat C;
+    int C_type;
+
+    // output is N wide, M high and batch deep, 1d when A or B is 1d
+    int out_dims;
+};
+
+class Gemm : public Layer
+{
+public:
+    Gemm();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+protected:
+    // shape checks and operand layout shared by every implementation
+    // return 0 if success
+    int resolve_operands(const std::vector<Mat>& bottom_blobs, GemmOperands& g) const;
+    int create_top_blob(const GemmOperands& g, Mat& top_blob, const Option& opt) const;
+
+public:
+    float alpha;
+    float beta;
+    int transA;
+    int transB;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,128 @@
+#include "groupnorm.h"
+
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+GroupNorm::GroupNorm()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int GroupNorm::load_param(const ParamDict& pd)
+{
+    group = pd.get(0, 1);
+    channels = pd.get(1, 0);
+    eps = pd.get(2, 0.001f);
+    affine = pd.get(3, 1);
+
+    if (group <= 0 || channels <= 0 || channels % group != 0)
+        return -1;
+
+    return 0;
+}
+
+int GroupNorm::load_model(const ModelBin& mb)
+{
+    if (affine == 0)
+        return 0;
+
+    gamma_data = mb.load(channels, 1);
+    if (gamma_data.empty())
+        return -100;
+
+    beta_data = mb.load(channels, 1);
+    if (beta_data.empty())
+        return -100;
+
+    return 0;
+}
+
+int GroupNorm::resolve_channels(const Mat& m, int& size) const
+{
+    int c;
+    if (m.dims == 1)
+    {
+        c = m.w;
+        size = 1;
+    }
+    else if (m.dims == 2)
+    {
+        c = m.h;
+        size = m.w;
+    }
+    else
+    {
+        c = m.c;
+        size = m.w * m.h * m.d;
+    }
+
+    return c == channels ? 0 : -1;
+}
+
+float* GroupNorm::channel_ptr(Mat& m, int q, int size)
+{
+    return m.dims <= 2 ? (float*)m.data + (size_t)q * size : (float*)m.channel(q);
+}
+
+int GroupNorm::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    int size;
+    if (resolve_channels(bottom_top_blob, size) != 0)
+        return -1;
+
+    const int channels_per_group = channels / group;
+
+    parallel_for(opt, 0, group, 1, [&](int g0, int g1) {
+        for (int g = g0; g < g1; g++)
+        {
+            const int q0 = g * channels_per_group;
+
+            float sum = 0.f;
+            for (int q = q0; q < q0 + channels_per_group; q++)
+            {
+                const float* ptr = channel_ptr(bottom_top_blob, q, size);
+                for (int i = 0; i < size; i++)
+                {
+                    sum += ptr[i];
+                }
+            }
+            const float mean = sum / (channels_per_group * size);
+
+            float sqsum = 0.f;
+            for (int q = q0; q < q0 + channels_per_group; q++)
+            {
+                const float* ptr = channel_ptr(bottom_top_blob, q, size);
+                for (int i = 0; i < size; i++)
+                {
+                    const float v = ptr[i] - mean;
+                    sqsum += v * v;
+                }
+            }
+            const float var = sqsum / (channels_per_group * size);
+
+            const float rstd = 1.f / sqrtf(var + eps);
+
+            for (int q = q0; q < q0 + channels_per_group; q++)
+            {
+                // the affine folds into the normalization, y = (x - mean) * a + b
+                const float a = affine ? rstd * gamma_data[q] : rstd;
+                const float b = affine ? beta_data[q] : 0.f;
+
+                float* ptr = channel_ptr(bottom_top_blob, q, size);
+                for (int i = 0; i < size; i++)
+                {
+                    ptr[i] = (ptr[i] - mean) * a + b;
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(GroupNorm)
+
+} // namespace tinyinfer
@@ -0,0 +1,41 @@
+#ifndef LAYER_GROUPNORM_H
+#define LAYER_GROUPNORM_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class GroupNorm : public Layer
+{
+public:
+    GroupNorm();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int load_model(const ModelBin& mb);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+protected:
+    // the channel axis of the blob, channel q holds size elements from channel_ptr(m, q, size)
+    // dims 1 has a channel per element, dims 2 a channel per row
+    // -1 if the blob does not have the channels of the layer
+    int resolve_channels(const Mat& m, int& size) const;
+
+    static float* channel_ptr(Mat& m, int q, int size);
+
+public:
+    // channels / group consecutive channels are normalized together
+    int group;
+    int channels;
+    float eps;
+    // the normalized channel q is scaled by gamma[q] and shifted by beta[q]
+    int affine;
+
+    Mat gamma_data;
+    Mat beta_data;
+};
+
+} // namespace tinyinfer
+
+#endif
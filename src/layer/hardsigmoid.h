@@ -0,0 +1,25 @@
+#ifndef LAYER_HARDSIGMOID_H
+#define LAYER_HARDSIGMOID_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class HardSigmoid : public Layer
+{
+public:
+    HardSigmoid();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    // min(max(alpha * x + beta, 0), 1)
+    float alpha;
+    float beta;
+};
+
+} // namespace tinyinfer
+
+#endif
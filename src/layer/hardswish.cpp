@@ -0,0 +1,44 @@
+#include "hardswish.h"
+
+#include "threadpool.h"
+
+namespace tinyinfer {
+
+HardSwish::HardSwish()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int HardSwish::load_param(const ParamDict& pd)
+{
+    alpha = pd.get(0, 0.2f);
+    beta = pd.get(1, 0.5f);
+
+    return 0;
+}
+
+int HardSwish::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                const float v = ptr[i] * alpha + beta;
+                ptr[i] *= v < 0.f ? 0.f : (v > 1.f ? 1.f : v);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(HardSwish)
+
+} // namespace tinyinfer
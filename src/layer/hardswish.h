@@ -0,0 +1,25 @@
+#ifndef LAYER_HARDSWISH_H
+#define LAYER_HARDSWISH_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class HardSwish : public Layer
+{
+public:
+    HardSwish();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    // x * min(max(alpha * x + beta, 0), 1), onnx uses alpha 1/6 and beta 0.5
+    float alpha;
+    float beta;
+};
+
+} // namespace tinyinfer
+
+#endif
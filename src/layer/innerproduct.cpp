@@ -0,0 +1,94 @@
+#include "innerproduct.h"
+
+#include "fused_activation.h"
+#include "threadpool.h"
+
+namespace tinyinfer {
+
+InnerProduct::InnerProduct()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int InnerProduct::load_param(const ParamDict& pd)
+{
+    num_output = pd.get(0, 0);
+    bias_term = pd.get(1, 0);
+    weight_data_size = pd.get(2, 0);
+    activation_type = pd.get(9, 0);
+    activation_params = pd.get(10, Mat());
+
+    if (num_output <= 0 || weight_data_size % num_output != 0)
+        return -1;
+
+    return 0;
+}
+
+int InnerProduct::load_model(const ModelBin& mb)
+{
+    weight_data = mb.load(weight_data_size, 0);
+    if (weight_data.empty())
+        return -100;
+
+    if (bias_term)
+    {
+        bias_data = mb.load(num_output, 1);
+        if (bias_data.empty())
+            return -100;
+    }
+
+    return 0;
+}
+
+int InnerProduct::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+
+    // 2d input of num_input wide rows keeps its rows, anything else is flattened
+    Mat bottom_blob_flattened = bottom_blob;
+    int rows = 1;
+    if (bottom_blob.dims == 2 && bottom_blob.w == num_input)
+    {
+        rows = bottom_blob.h;
+        top_blob.create(num_output, rows, 4u, opt.blob_allocator);
+    }
+    else
+    {
+        if (bottom_blob.w * bottom_blob.h * bottom_blob.d * bottom_blob.c != num_input)
+            return -1;
+
+        bottom_blob_flattened = bottom_blob.reshape(num_input, opt.workspace_allocator);
+        top_blob.create(num_output, 4u, opt.blob_allocator);
+    }
+
+    if (bottom_blob_flattened.empty() || top_blob.empty())
+        return -100;
+
+    const float* activation_ptr = activation_params;
+
+    parallel_for(opt, 0, rows * num_output, 16, [&](int t0, int t1) {
+        for (int t = t0; t < t1; t++)
+        {
+            const int i = t / num_output;
+            const int p = t % num_output;
+
+            const float* inptr = (const float*)bottom_blob_flattened + (size_t)num_input * i;
+            const float* kptr = (const float*)weight_data + (size_t)num_input * p;
+
+            float sum = bias_term ? bias_data[p] : 0.f;
+            for (int k = 0; k < num_input; k++)
+            {
+                sum += inptr[k] * kptr[k];
+            }
+
+            ((float*)top_blob)[(size_t)num_output * i + p] = activation_ss(sum, activation_type, activation_ptr);
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(InnerProduct)
+
+} // namespace tinyinfer
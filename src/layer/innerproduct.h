@@ -0,0 +1,37 @@
+#ifndef LAYER_INNERPRODUCT_H
+#define LAYER_INNERPRODUCT_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class InnerProduct : public Layer
+{
+public:
+    InnerProduct();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int load_model(const ModelBin& mb);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // param
+    int num_output;
+    int bias_term;
+
+    int weight_data_size;
+
+    // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid 5=mish 6=hardswish
+    int activation_type;
+    Mat activation_params;
+
+    // model, num_output rows of num_input
+    Mat weight_data;
+    Mat bias_data;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,28 @@
+#include "input.h"
+
+namespace tinyinfer {
+
+Input::Input()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int Input::load_param(const ParamDict& pd)
+{
+    w = pd.get(0, 0);
+    h = pd.get(1, 0);
+    d = pd.get(11, 0);
+    c = pd.get(2, 0);
+
+    return 0;
+}
+
+int Input::forward_inplace(Mat& /*bottom_top_blob*/, const Option& /*opt*/) const
+{
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Input)
+
+} // namespace tinyinfer
@@ -0,0 +1,27 @@
+#ifndef LAYER_INPUT_H
+#define LAYER_INPUT_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Input : public Layer
+{
+public:
+    Input();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    // expected shape, 0 = any
+    int w;
+    int h;
+    int d;
+    int c;
+};
+
+} // namespace tinyinfer
+
+#endif
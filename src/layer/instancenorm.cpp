@@ -0,0 +1,101 @@
+#include "instancenorm.h"
+
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+InstanceNorm::InstanceNorm()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int InstanceNorm::load_param(const ParamDict& pd)
+{
+    channels = pd.get(0, 0);
+    eps = pd.get(1, 0.001f);
+    affine = pd.get(2, 1);
+
+    if (channels <= 0)
+        return -1;
+
+    return 0;
+}
+
+int InstanceNorm::load_model(const ModelBin& mb)
+{
+    if (affine == 0)
+        return 0;
+
+    gamma_data = mb.load(channels, 1);
+    if (gamma_data.empty())
+        return -100;
+
+    beta_data = mb.load(channels, 1);
+    if (beta_data.empty())
+        return -100;
+
+    return 0;
+}
+
+int InstanceNorm::resolve_channels(const Mat& m, int& size) const
+{
+    if (m.dims == 1)
+        return -1;
+
+    const int c = m.dims == 2 ? m.h : m.c;
+    size = m.dims == 2 ? m.w : m.w * m.h * m.d;
+
+    return c == channels ? 0 : -1;
+}
+
+float* InstanceNorm::channel_ptr(Mat& m, int q, int size)
+{
+    return m.dims == 2 ? (float*)m.data + (size_t)q * size : (float*)m.channel(q);
+}
+
+int InstanceNorm::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    int size;
+    if (resolve_channels(bottom_top_blob, size) != 0)
+        return -1;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = channel_ptr(bottom_top_blob, q, size);
+
+            float sum = 0.f;
+            for (int i = 0; i < size; i++)
+            {
+                sum += ptr[i];
+            }
+            const float mean = sum / size;
+
+            float sqsum = 0.f;
+            for (int i = 0; i < size; i++)
+            {
+                const float v = ptr[i] - mean;
+                sqsum += v * v;
+            }
+            const float var = sqsum / size;
+
+            // the affine folds into the normalization, y = (x - mean) * a + b
+            const float rstd = 1.f / sqrtf(var + eps);
+            const float a = affine ? rstd * gamma_data[q] : rstd;
+            const float b = affine ? beta_data[q] : 0.f;
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = (ptr[i] - mean) * a + b;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(InstanceNorm)
+
+} // namespace tinyinfer
@@ -0,0 +1,38 @@
+#ifndef LAYER_INSTANCENORM_H
+#define LAYER_INSTANCENORM_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class InstanceNorm : public Layer
+{
+public:
+    InstanceNorm();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int load_model(const ModelBin& mb);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+protected:
+    // every channel is normalized on its own, the rows of a dims 2 blob are its channels
+    // -1 if the blob does not have the channels of the layer
+    int resolve_channels(const Mat& m, int& size) const;
+
+    static float* channel_ptr(Mat& m, int q, int size);
+
+public:
+    int channels;
+    float eps;
+    // the normalized channel q is scaled by gamma[q] and shifted by beta[q]
+    int affine;
+
+    Mat gamma_data;
+    Mat beta_data;
+};
+
+} // namespace tinyinfer
+
+#endif
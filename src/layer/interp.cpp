@@ -0,0 +1,237 @@
+#include "interp.h"
+
+#include "threadpool.h"
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+namespace tinyinfer {
+
+Interp::Interp()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Interp::load_param(const ParamDict& pd)
+{
+    resize_type = pd.get(0, 1);
+    height_scale = pd.get(1, 1.f);
+    width_scale = pd.get(2, 1.f);
+    output_height = pd.get(3, 0);
+    output_width = pd.get(4, 0);
+    dynamic_target_size = pd.get(5, 0);
+    align_corner = pd.get(6, 0);
+
+    if (resize_type < 1 || resize_type > 3)
+        return -1;
+
+    if (dynamic_target_size)
+        one_blob_only = false;
+
+    return 0;
+}
+
+int Interp::resolve_size(const Mat& bottom_blob, const Mat& reference_blob, int& outw, int& outh, float& scale_w, float& scale_h) const
+{
+    // a 1d blob is a channel of single pixels, a 2d one a set of rows
+    const int w = bottom_blob.dims == 1 ? 1 : bottom_blob.w;
+    const int h = bottom_blob.dims == 3 ? bottom_blob.h : 1;
+
+    outw = reference_blob.empty() ? output_width : reference_blob.w;
+    outh = reference_blob.empty() ? output_height : reference_blob.h;
+
+    if (outw == 0 || outh == 0)
+    {
+        outw = (int)(w * width_scale);
+        outh = (int)(h * height_scale);
+        scale_w = 1.f / width_scale;
+        scale_h = 1.f / height_scale;
+    }
+    else
+    {
+        scale_w = (float)w / outw;
+        scale_h = (float)h / outh;
+    }
+
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    if (align_corner)
+    {
+        scale_w = outw > 1 ? (float)(w - 1) / (outw - 1) : 0.f;
+        scale_h = outh > 1 ? (float)(h - 1) / (outh - 1) : 0.f;
+    }
+
+    return 0;
+}
+
+int Interp::taps() const
+{
+    return resize_type == 3 ? 4 : resize_type;
+}
+
+// keys cubic convolution with a = -0.75 at distances 1 + t, t, 1 - t and 2 - t
+static void interp_cubic_weights(float t, float* alpha)
+{
+    const float A = -0.75f;
+
+    const float x0 = 1.f + t;
+    const float x1 = t;
+    const float x2 = 1.f - t;
+
+    alpha[0] = ((A * x0 - 5 * A) * x0 + 8 * A) * x0 - 4 * A;
+    alpha[1] = ((A + 2) * x1 - (A + 3)) * x1 * x1 + 1;
+    alpha[2] = ((A + 2) * x2 - (A + 3)) * x2 * x2 + 1;
+    alpha[3] = 1.f - alpha[0] - alpha[1] - alpha[2];
+}
+
+void Interp::resolve_coeffs(int w, int outw, float scale, int* ofs, float* alpha) const
+{
+    for (int dx = 0; dx < outw; dx++)
+    {
+        // source coordinate of the output position
+        float fx = align_corner ? dx * scale : (dx + 0.5f) * scale - 0.5f;
+
+        if (resize_type == 1)
+        {
+            int sx = align_corner ? (int)roundf(fx) : (int)floorf(dx * scale);
+            ofs[dx] = std::min(std::max(sx, 0), w - 1);
+            alpha[dx] = 1.f;
+        }
+
+        if (resize_type == 2)
+        {
+            if (fx < 0.f)
+                fx = 0.f;
+
+            int sx = (int)floorf(fx);
+            fx -= sx;
+            if (sx >= w - 1)
+            {
+                sx = w - 1;
+                fx = 0.f;
+            }
+
+            ofs[dx * 2] = sx;
+            ofs[dx * 2 + 1] = std::min(sx + 1, w - 1);
+            alpha[dx * 2] = 1.f - fx;
+            alpha[dx * 2 + 1] = fx;
+        }
+
+        if (resize_type == 3)
+        {
+            int sx = (int)floorf(fx);
+            fx -= sx;
+
+            for (int k = 0; k < 4; k++)
+            {
+                ofs[dx * 4 + k] = std::min(std::max(sx - 1 + k, 0), w - 1);
+            }
+            interp_cubic_weights(fx, alpha + dx * 4);
+        }
+    }
+}
+
+int Interp::forward_resize(const Mat& bottom_blob, Mat& top_blob, int outw, int outh, float scale_w, float scale_h, const Option& opt) const
+{
+    const int dims = bottom_blob.dims;
+
+    if (dims == 1)
+    {
+        top_blob.create(outw, outh, bottom_blob.w, bottom_blob.elemsize, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        const float* ptr = bottom_blob;
+        parallel_for(opt, 0, bottom_blob.w, 1, [&](int i0, int i1) {
+            for (int q = i0; q < i1; q++)
+            {
+                top_blob.channel(q).fill(ptr[q]);
+            }
+        });
+
+        return 0;
+    }
+
+    if (dims != 2 && dims != 3)
+        return -1;
+
+    const int w = bottom_blob.w;
+    const int h = dims == 3 ? bottom_blob.h : 1;
+    const int channels = dims == 3 ? bottom_blob.c : bottom_blob.h;
+    if (dims == 2)
+        outh = 1;
+
+    if (dims == 2)
+        top_blob.create(outw, channels, bottom_blob.elemsize, opt.blob_allocator);
+    else
+        top_blob.create(outw, outh, channels, bottom_blob.elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int n = taps();
+    std::vector<int> xofs(outw * n);
+    std::vector<float> alpha(outw * n);
+    std::vector<int> yofs(outh * n);
+    std::vector<float> beta(outh * n);
+    resolve_coeffs(w, outw, scale_w, xofs.data(), alpha.data());
+    resolve_coeffs(h, outh, scale_h, yofs.data(), beta.data());
+
+    parallel_for(opt, 0, channels, 1, [&](int i0, int i1) {
+        for (int q = i0; q < i1; q++)
+        {
+            const float* ptr = dims == 3 ? (const float*)bottom_blob.channel(q) : bottom_blob.row(q);
+            float* outptr = dims == 3 ? (float*)top_blob.channel(q) : top_blob.row(q);
+
+            for (int dy = 0; dy < outh; dy++)
+            {
+                for (int dx = 0; dx < outw; dx++)
+                {
+                    float sum = 0.f;
+                    for (int ky = 0; ky < n; ky++)
+                    {
+                        const float* row = ptr + yofs[dy * n + ky] * w;
+                        for (int kx = 0; kx < n; kx++)
+                        {
+                            sum += row[xofs[dx * n + kx]] * alpha[dx * n + kx] * beta[dy * n + ky];
+                        }
+                    }
+
+                    outptr[dy * outw + dx] = sum;
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+int Interp::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int outw, outh;
+    float scale_w, scale_h;
+    int ret = resolve_size(bottom_blob, Mat(), outw, outh, scale_w, scale_h);
+    if (ret != 0)
+        return ret;
+
+    return forward_resize(bottom_blob, top_blob, outw, outh, scale_w, scale_h, opt);
+}
+
+int Interp::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    if (bottom_blobs.size() != 2 || top_blobs.size() != 1)
+        return -1;
+
+    int outw, outh;
+    float scale_w, scale_h;
+    int ret = resolve_size(bottom_blobs[0], bottom_blobs[1], outw, outh, scale_w, scale_h);
+    if (ret != 0)
+        return ret;
+
+    return forward_resize(bottom_blobs[0], top_blobs[0], outw, outh, scale_w, scale_h, opt);
+}
+
+DEFINE_LAYER_CREATOR(Interp)
+
+} // namespace tinyinfer
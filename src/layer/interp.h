@@ -0,0 +1,53 @@
+#ifndef LAYER_INTERP_H
+#define LAYER_INTERP_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Interp : public Layer
+{
+public:
+    Interp();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+    // the second blob only gives the output size
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+protected:
+    // output size from the params, or from the reference blob when it is not empty
+    // scale_w and scale_h step the source coordinate per output position
+    // return 0 if success
+    int resolve_size(const Mat& bottom_blob, const Mat& reference_blob, int& outw, int& outh, float& scale_w, float& scale_h) const;
+
+    // source index and weight of each tap of every output position along an axis of w, taps() per position
+    // indexes are clamped into the axis, so the border repeats
+    int taps() const;
+    void resolve_coeffs(int w, int outw, float scale, int* ofs, float* alpha) const;
+
+    // dims 1 fills an outw x outh map per element, dims 2 resizes every row, dims 3 every channel
+    virtual int forward_resize(const Mat& bottom_blob, Mat& top_blob, int outw, int outh, float scale_w, float scale_h, const Option& opt) const;
+
+public:
+    // 1=nearest 2=bilinear 3=bicubic
+    int resize_type;
+
+    // output size is the input size times the scale unless output_width and output_height are set
+    float height_scale;
+    float width_scale;
+    int output_height;
+    int output_width;
+
+    // take the output size from the second blob
+    int dynamic_target_size;
+
+    // corner pixels of the input and output are aligned, otherwise their centers are
+    int align_corner;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,106 @@
+#include "layernorm.h"
+
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+LayerNorm::LayerNorm()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int LayerNorm::load_param(const ParamDict& pd)
+{
+    affine_size = pd.get(0, 0);
+    eps = pd.get(1, 0.001f);
+    affine = pd.get(2, 1);
+
+    // the affine weights need their size
+    if (affine_size < 0 || (affine && affine_size == 0))
+        return -1;
+
+    return 0;
+}
+
+int LayerNorm::load_model(const ModelBin& mb)
+{
+    if (affine == 0)
+        return 0;
+
+    gamma_data = mb.load(affine_size, 1);
+    if (gamma_data.empty())
+        return -100;
+
+    beta_data = mb.load(affine_size, 1);
+    if (beta_data.empty())
+        return -100;
+
+    return 0;
+}
+
+int LayerNorm::resolve_rows(const Mat& m, int& channels, int& rows, int& size) const
+{
+    const int plane = m.w * m.h * m.d;
+
+    size = affine_size == 0 ? m.w : affine_size;
+    if (size != m.w && size != m.w * m.h && size != plane)
+        return -1;
+
+    channels = m.c;
+    rows = plane / size;
+    return 0;
+}
+
+int LayerNorm::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    int channels, rows, size;
+    if (resolve_rows(bottom_top_blob, channels, rows, size) != 0)
+        return -1;
+
+    parallel_for(opt, 0, channels * rows, 1, [&](int t0, int t1) {
+        for (int t = t0; t < t1; t++)
+        {
+            float* ptr = (float*)bottom_top_blob.channel(t / rows) + (size_t)(t % rows) * size;
+
+            float sum = 0.f;
+            for (int i = 0; i < size; i++)
+            {
+                sum += ptr[i];
+            }
+            const float mean = sum / size;
+
+            float sqsum = 0.f;
+            for (int i = 0; i < size; i++)
+            {
+                const float v = ptr[i] - mean;
+                sqsum += v * v;
+            }
+            const float var = sqsum / size;
+
+            const float a = 1.f / sqrtf(var + eps);
+
+            if (affine)
+            {
+                for (int i = 0; i < size; i++)
+                {
+                    ptr[i] = (ptr[i] - mean) * a * gamma_data[i] + beta_data[i];
+                }
+            }
+            else
+            {
+                for (int i = 0; i < size; i++)
+                {
+                    ptr[i] = (ptr[i] - mean) * a;
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(LayerNorm)
+
+} // namespace tinyinfer
@@ -0,0 +1,37 @@
+#ifndef LAYER_LAYERNORM_H
+#define LAYER_LAYERNORM_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class LayerNorm : public Layer
+{
+public:
+    LayerNorm();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int load_model(const ModelBin& mb);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+protected:
+    // the blob as rows normalized on their own, row r of channel q starts at channel(q) + r * size
+    // -1 if affine_size is not the trailing w, w * h or w * h * d of a channel
+    int resolve_rows(const Mat& m, int& channels, int& rows, int& size) const;
+
+public:
+    // elements normalized together, 0 takes every row along w
+    int affine_size;
+    float eps;
+    // y = (x - mean) / sqrt(var + eps) * gamma + beta with gamma and beta of affine_size
+    int affine;
+
+    Mat gamma_data;
+    Mat beta_data;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,58 @@
+#include "memorydata.h"
+
+namespace tinyinfer {
+
+MemoryData::MemoryData()
+{
+    one_blob_only = false;
+    support_inplace = false;
+}
+
+int MemoryData::load_param(const ParamDict& pd)
+{
+    w = pd.get(0, 0);
+    h = pd.get(1, 0);
+    d = pd.get(11, 0);
+    c = pd.get(2, 0);
+
+    return 0;
+}
+
+int MemoryData::load_model(const ModelBin& mb)
+{
+    if (d != 0)
+    {
+        data = mb.load(w * h * d * c, 1);
+        if (!data.empty())
+            data = data.reshape(w, h, d, c);
+    }
+    else if (c != 0)
+    {
+        data = mb.load(w, h, c, 1);
+    }
+    else if (h != 0)
+    {
+        data = mb.load(w, h, 1);
+    }
+    else
+    {
+        data = mb.load(w, 1);
+    }
+
+    if (data.empty())
+        return -100;
+
+    return 0;
+}
+
+int MemoryData::forward(const std::vector<Mat>& /*bottom_blobs*/, std::vector<Mat>& top_blobs, const Option& /*opt*/) const
+{
+    // the weight is shared, consumers working inplace get a copy from the net
+    top_blobs[0] = data;
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(MemoryData)
+
+} // namespace tinyinfer
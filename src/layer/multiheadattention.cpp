@@ -0,0 +1,239 @@
+#include "multiheadattention.h"
+
+#include "kvcache.h"
+#include "threadpool.h"
+#include <math.h>
+#include <vector>
+
+namespace tinyinfer {
+
+MultiHeadAttention::MultiHeadAttention()
+{
+    one_blob_only = false;
+    support_inplace = false;
+
+    kv_cache_slot = 0;
+}
+
+int MultiHeadAttention::load_param(const ParamDict& pd)
+{
+    num_heads = pd.get(0, 1);
+    scale = pd.get(1, 0.f);
+    causal = pd.get(2, 0);
+    kv_cache = pd.get(3, 0);
+
+    if (num_heads <= 0)
+        return -1;
+
+    return 0;
+}
+
+int MultiHeadAttention::resolve_operands(const std::vector<Mat>& bottom_blobs, Mat& top_blob, AttentionOperands& a, const Option& opt) const
+{
+    if (bottom_blobs.size() < 3)
+        return -1;
+
+    const Mat& q = bottom_blobs[0];
+    const Mat& k = bottom_blobs[1];
+    const Mat& v = bottom_blobs[2];
+    if (q.dims != k.dims || q.dims != v.dims || (q.dims != 2 && q.dims != 3))
+        return -1;
+
+    a.dims = q.dims;
+    a.q_len = q.h;
+    a.kv_len = k.h;
+    if (v.h != a.kv_len)
+        return -1;
+
+    if (a.dims == 3)
+    {
+        a.num_heads = q.c;
+        a.num_kv_heads = k.c;
+        a.head_dim = q.w;
+        a.v_head_dim = v.w;
+        if (k.w != a.head_dim || v.c != a.num_kv_heads)
+            return -1;
+
+        a.q_hstep = q.cstep;
+        a.k_hstep = k.cstep;
+        a.v_hstep = v.cstep;
+        a.q_rstep = q.w;
+        a.k_rstep = k.w;
+        a.v_rstep = v.w;
+    }
+    else
+    {
+        if (q.w % num_heads != 0)
+            return -1;
+
+        a.num_heads = num_heads;
+        a.head_dim = q.w / num_heads;
+        if (k.w % a.head_dim != 0)
+            return -1;
+
+        a.num_kv_heads = k.w / a.head_dim;
+        if (v.w % a.num_kv_heads != 0)
+            return -1;
+
+        a.v_head_dim = v.w / a.num_kv_heads;
+
+        a.q_hstep = a.head_dim;
+        a.k_hstep = a.head_dim;
+        a.v_hstep = a.v_head_dim;
+        a.q_rstep = q.w;
+        a.k_rstep = k.w;
+        a.v_rstep = v.w;
+    }
+
+    if (a.q_len == 0 || a.kv_len == 0 || a.num_kv_heads == 0 || a.num_heads % a.num_kv_heads != 0)
+        return -1;
+
+    a.scale = scale == 0.f ? 1.f / sqrtf((float)a.head_dim) : scale;
+    a.q = q;
+    a.k = k;
+    a.v = v;
+
+    // the new positions join the cached ones
+    const bool cached = kv_cache && opt.kv_cache;
+    if (cached)
+        a.kv_len += opt.kv_cache->length(kv_cache_slot);
+
+    a.mask = 0;
+    a.mask_hstep = 0;
+    a.mask_rstep = 0;
+    if (bottom_blobs.size() >= 4)
+    {
+        const Mat& mask = bottom_blobs[3];
+        const int mh = mask.dims >= 2 ? mask.h : 1;
+        const int mc = mask.dims == 3 ? mask.c : 1;
+        if (mask.dims > 3 || mask.w != a.kv_len || (mh != a.q_len && mh != 1) || (mc != a.num_heads && mc != 1))
+            return -1;
+
+        a.mask = mask;
+        a.mask_hstep = mc == 1 ? 0 : mask.cstep;
+        a.mask_rstep = mh == 1 ? 0 : mask.w;
+    }
+
+    // the cache is only touched once the shapes are known to be good, it is read in place
+    if (cached)
+    {
+        int ret = opt.kv_cache->append(kv_cache_slot, k, v);
+        if (ret != 0)
+            return ret;
+
+        const Mat& cached_k = opt.kv_cache->keys(kv_cache_slot);
+        const Mat& cached_v = opt.kv_cache->values(kv_cache_slot);
+
+        a.k = cached_k;
+        a.v = cached_v;
+        a.k_rstep = cached_k.w;
+        a.v_rstep = cached_v.w;
+        if (a.dims == 3)
+        {
+            a.k_hstep = cached_k.cstep;
+            a.v_hstep = cached_v.cstep;
+        }
+    }
+
+    if (a.dims == 3)
+        top_blob.create(a.v_head_dim, a.q_len, a.num_heads, 4u, opt.blob_allocator);
+    else
+        top_blob.create(a.num_heads * a.v_head_dim, a.q_len, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    a.out = top_blob;
+    a.out_hstep = a.dims == 3 ? top_blob.cstep : (size_t)a.v_head_dim;
+    a.out_rstep = top_blob.w;
+
+    return 0;
+}
+
+int MultiHeadAttention::kv_end(const AttentionOperands& a, int i) const
+{
+    if (!causal)
+        return a.kv_len;
+
+    const int end = a.kv_len - a.q_len + i + 1;
+    return end < 0 ? 0 : (end > a.kv_len ? a.kv_len : end);
+}
+
+int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    AttentionOperands a;
+    int ret = resolve_operands(bottom_blobs, top_blobs[0], a, opt);
+    if (ret != 0)
+        return ret;
+
+    const int group = a.num_heads / a.num_kv_heads;
+
+    parallel_for(opt, 0, a.num_heads * a.q_len, 1, [&](int t0, int t1) {
+        // one row of scores, the whole attention matrix never exists
+        std::vector<float> scores(a.kv_len);
+
+        for (int t = t0; t < t1; t++)
+        {
+            const int h = t / a.q_len;
+            const int i = t % a.q_len;
+            const int end = kv_end(a, i);
+
+            const float* qptr = a.q + h * a.q_hstep + (size_t)i * a.q_rstep;
+            const float* kptr = a.k + (h / group) * a.k_hstep;
+            const float* vptr = a.v + (h / group) * a.v_hstep;
+            const float* mptr = a.mask ? a.mask + h * a.mask_hstep + (size_t)i * a.mask_rstep : 0;
+            float* outptr = a.out + h * a.out_hstep + (size_t)i * a.out_rstep;
+
+            float max = -INFINITY;
+            for (int j = 0; j < end; j++)
+            {
+                const float* krow = kptr + (size_t)j * a.k_rstep;
+
+                float sum = 0.f;
+                for (int d = 0; d < a.head_dim; d++)
+                {
+                    sum += qptr[d] * krow[d];
+                }
+
+                float s = sum * a.scale;
+                if (mptr)
+                    s += mptr[j];
+
+                scores[j] = s;
+                if (s > max)
+                    max = s;
+            }
+
+            for (int d = 0; d < a.v_head_dim; d++)
+            {
+                outptr[d] = 0.f;
+            }
+
+            // a row without any visible key gives zeros
+            if (max == -INFINITY)
+                continue;
+
+            float sum = 0.f;
+            for (int j = 0; j < end; j++)
+            {
+                scores[j] = expf(scores[j] - max);
+                sum += scores[j];
+            }
+
+            for (int j = 0; j < end; j++)
+            {
+                const float* vrow = vptr + (size_t)j * a.v_rstep;
+                const float p = scores[j] / sum;
+                for (int d = 0; d < a.v_head_dim; d++)
+                {
+                    outptr[d] += p * vrow[d];
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(MultiHeadAttention)
+
+} // namespace tinyinfer
@@ -0,0 +1,82 @@
+#ifndef LAYER_MULTIHEADATTENTION_H
+#define LAYER_MULTIHEADATTENTION_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+// operands of one forward call, row r of head h of a blob starts at ptr + h * hstep + r * rstep
+struct AttentionOperands
+{
+    int num_heads;
+    // key and value heads, each shared by num_heads / num_kv_heads query heads
+    int num_kv_heads;
+    int q_len;
+    int kv_len;
+    int head_dim;
+    int v_head_dim;
+    float scale;
+
+    const float* q;
+    size_t q_hstep;
+    int q_rstep;
+
+    const float* k;
+    size_t k_hstep;
+    int k_rstep;
+
+    const float* v;
+    size_t v_hstep;
+    int v_rstep;
+
+    // additive q_len x kv_len mask, a zero step broadcasts it over heads or rows, null when absent
+    const float* mask;
+    size_t mask_hstep;
+    int mask_rstep;
+
+    // heads in channels when 3, side by side along w when 2
+    int dims;
+
+    float* out;
+    size_t out_hstep;
+    int out_rstep;
+};
+
+// softmax(q * k^T * scale + mask) * v over every head
+// q, k and v are either 3d with one head per channel, head_dim wide and seq high
+// or 2d with num_heads heads side by side in every seq row, the layout of the projections around them
+// the optional fourth blob is an additive mask kv_len wide, q_len or 1 high and 1 or num_heads deep
+// with kv_cache set and a KVCache in the option, k and v are the new positions only
+// they are appended to the cache and the queries attend over every cached position
+class MultiHeadAttention : public Layer
+{
+public:
+    MultiHeadAttention();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+protected:
+    // shape checks and strides shared by every implementation, the output is allocated here
+    // return 0 if success
+    int resolve_operands(const std::vector<Mat>& bottom_blobs, Mat& top_blob, AttentionOperands& a, const Option& opt) const;
+
+    // the keys query row i may see, the last q_len keys are the positions of the queries when causal
+    int kv_end(const AttentionOperands& a, int i) const;
+
+public:
+    // query heads of the 2d layout, 3d blobs carry them in channels
+    int num_heads;
+    // 0 takes 1 / sqrt(head_dim)
+    float scale;
+    int causal;
+    int kv_cache;
+
+    // slot of the KVCache, numbered by the net over its caching layers
+    int kv_cache_slot;
+};
+
+} // namespace tinyinfer
+
+#endif
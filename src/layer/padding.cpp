@@ -0,0 +1,46 @@
+#include "padding.h"
+
+namespace tinyinfer {
+
+Padding::Padding()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Padding::load_param(const ParamDict& pd)
+{
+    top = pd.get(0, 0);
+    bottom = pd.get(1, 0);
+    left = pd.get(2, 0);
+    right = pd.get(3, 0);
+    type = pd.get(4, 0);
+    value = pd.get(5, 0.f);
+    front = pd.get(7, 0);
+    behind = pd.get(8, 0);
+
+    if (top < 0 || bottom < 0 || left < 0 || right < 0 || front < 0 || behind < 0)
+        return -1;
+
+    if (type < 0 || type > 2)
+        return -1;
+
+    return 0;
+}
+
+int Padding::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // a 1d blob has no rows and a 2d one no planes to add
+    if ((bottom_blob.dims == 1 && (top || bottom)) || (bottom_blob.dims <= 2 && (front || behind)))
+        return -1;
+
+    copy_make_border_3d(bottom_blob, top_blob, top, bottom, left, right, front, behind, type, value, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Padding)
+
+} // namespace tinyinfer
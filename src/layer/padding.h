@@ -0,0 +1,33 @@
+#ifndef LAYER_PADDING_H
+#define LAYER_PADDING_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Padding : public Layer
+{
+public:
+    Padding();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // top and bottom pad h, left and right pad w, front and behind pad c of dims 3 and d of dims 4
+    int top;
+    int bottom;
+    int left;
+    int right;
+    int front;
+    int behind;
+
+    // 0=constant 1=replicate 2=reflect
+    int type;
+    float value;
+};
+
+} // namespace tinyinfer
+
+#endif
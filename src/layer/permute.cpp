@@ -0,0 +1,147 @@
+#include "permute.h"
+
+#include "threadpool.h"
+
+namespace tinyinfer {
+
+Permute::Permute()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Permute::load_param(const ParamDict& pd)
+{
+    order_type = pd.get(0, 0);
+
+    return 0;
+}
+
+// the order_type-th ordering of the axes, the outermost output axis picks its group from the last axis down
+// and the remaining axes are ordered the same way
+// tools/onnx2tinyinfer.cpp maps onnx perms to order_type with a copy of this, keep the two in sync
+static void permute_axes(int order_type, const int* axes, int count, int* out)
+{
+    if (count == 0)
+        return;
+
+    int group = 1;
+    for (int i = 2; i < count; i++)
+        group *= i;
+
+    const int last = count - 1 - order_type / group;
+
+    int rest[4];
+    int k = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (i != last)
+            rest[k++] = axes[i];
+    }
+
+    permute_axes(order_type % group, rest, count - 1, out);
+    out[count - 1] = axes[last];
+}
+
+int Permute::create_top_blob(const Mat& bottom_blob, Mat& top_blob, int* n, size_t* s, size_t* t, const Option& opt) const
+{
+    const int dims = bottom_blob.dims;
+
+    // input axes innermost first
+    int shape[4] = {bottom_blob.w, 1, 1, 1};
+    size_t stride[4] = {1, 0, 0, 0};
+    if (dims == 2)
+    {
+        shape[1] = bottom_blob.h;
+        stride[1] = bottom_blob.w;
+    }
+    if (dims == 3)
+    {
+        shape[1] = bottom_blob.h;
+        shape[2] = bottom_blob.c;
+        stride[1] = bottom_blob.w;
+        stride[2] = bottom_blob.cstep;
+    }
+    if (dims == 4)
+    {
+        shape[1] = bottom_blob.h;
+        shape[2] = bottom_blob.d;
+        shape[3] = bottom_blob.c;
+        stride[1] = bottom_blob.w;
+        stride[2] = (size_t)bottom_blob.w * bottom_blob.h;
+        stride[3] = bottom_blob.cstep;
+    }
+
+    int orders = 1;
+    for (int i = 2; i <= dims; i++)
+        orders *= i;
+
+    if (order_type < 0 || order_type >= orders)
+        return -1;
+
+    const int identity[4] = {0, 1, 2, 3};
+    int axes[4] = {0, 1, 2, 3};
+    permute_axes(order_type, identity, dims, axes);
+
+    for (int i = 0; i < 4; i++)
+    {
+        n[i] = i < dims ? shape[axes[i]] : 1;
+        s[i] = i < dims ? stride[axes[i]] : 0;
+    }
+
+    if (dims == 1)
+        top_blob.create(n[0], bottom_blob.elemsize, opt.blob_allocator);
+    if (dims == 2)
+        top_blob.create(n[0], n[1], bottom_blob.elemsize, opt.blob_allocator);
+    if (dims == 3)
+        top_blob.create(n[0], n[1], n[2], bottom_blob.elemsize, opt.blob_allocator);
+    if (dims == 4)
+        top_blob.create(n[0], n[1], n[2], n[3], bottom_blob.elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    t[0] = 1;
+    t[1] = n[0];
+    t[2] = dims == 3 ? top_blob.cstep : (size_t)n[0] * n[1];
+    t[3] = top_blob.cstep;
+
+    return 0;
+}
+
+int Permute::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int n[4];
+    size_t s[4];
+    size_t t[4];
+    int ret = create_top_blob(bottom_blob, top_blob, n, s, t, opt);
+    if (ret != 0)
+        return ret;
+
+    const float* ptr = bottom_blob;
+    float* outptr = top_blob;
+
+    parallel_for(opt, 0, n[3] * n[2], 1, [&](int i0, int i1) {
+        for (int i = i0; i < i1; i++)
+        {
+            const int z = i / n[2];
+            const int q = i % n[2];
+
+            for (int y = 0; y < n[1]; y++)
+            {
+                const float* p = ptr + z * s[3] + q * s[2] + y * s[1];
+                float* outp = outptr + z * t[3] + q * t[2] + y * t[1];
+
+                for (int x = 0; x < n[0]; x++)
+                {
+                    outp[x] = p[x * s[0]];
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Permute)
+
+} // namespace tinyinfer
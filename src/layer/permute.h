@@ -0,0 +1,34 @@
+#ifndef LAYER_PERMUTE_H
+#define LAYER_PERMUTE_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Permute : public Layer
+{
+public:
+    Permute();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+protected:
+    // output axes innermost first and padded to 4 with extent 1
+    // n is the extent, s the input stride and t the output stride of each output axis, in elements
+    // return 0 if success
+    int create_top_blob(const Mat& bottom_blob, Mat& top_blob, int* n, size_t* s, size_t* t, const Option& opt) const;
+
+public:
+    // the output axes innermost first
+    // dims 2: 0=w h 1=h w
+    // dims 3: 0=w h c 1=h w c 2=w c h 3=c w h 4=h c w 5=c h w
+    // dims 4: 0-5 as dims 3 with d inserted before c, then 6-11, 12-17 and 18-23 with d, h and w outermost
+    // 1 swaps the two innermost axes for every dims
+    int order_type;
+};
+
+} // namespace tinyinfer
+
+#endif
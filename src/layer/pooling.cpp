@@ -0,0 +1,238 @@
+#include "pooling.h"
+
+#include "threadpool.h"
+#include <float.h>
+
+namespace tinyinfer {
+
+Pooling::Pooling()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Pooling::load_param(const ParamDict& pd)
+{
+    pooling_type = pd.get(0, 0);
+    kernel_w = pd.get(1, 0);
+    kernel_h = pd.get(11, kernel_w);
+    stride_w = pd.get(2, 1);
+    stride_h = pd.get(12, stride_w);
+    pad_left = pd.get(3, 0);
+    pad_right = pd.get(14, pad_left);
+    pad_top = pd.get(13, pad_left);
+    pad_bottom = pd.get(15, pad_top);
+    global_pooling = pd.get(4, 0);
+    pad_mode = pd.get(5, 0);
+    avgpool_count_include_pad = pd.get(6, 0);
+    adaptive_pooling = pd.get(7, 0);
+    out_w = pd.get(8, 0);
+    out_h = pd.get(18, out_w);
+
+    if (pooling_type != PoolMethod_MAX && pooling_type != PoolMethod_AVE)
+        return -1;
+
+    if (pad_mode < 0 || pad_mode > 3)
+        return -1;
+
+    if (adaptive_pooling)
+    {
+        if ((out_w <= 0 && out_w != -233) || (out_h <= 0 && out_h != -233))
+            return -1;
+    }
+    else if (!global_pooling)
+    {
+        if (kernel_w <= 0 || kernel_h <= 0 || stride_w <= 0 || stride_h <= 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+// pads of one axis, the SAME ones out of the input size
+static int resolve_padding_1d(int size, int kernel, int stride, int pad_mode, int pad_begin, int pad_end, int& pb, int& pe, int& tail)
+{
+    pb = pad_begin;
+    pe = pad_end;
+    tail = 0;
+
+    if (pad_mode == 2 || pad_mode == 3)
+    {
+        int pad = kernel + (size - 1) / stride * stride - size;
+        if (pad < 0)
+            pad = 0;
+        pb = pad_mode == 2 ? pad / 2 : pad - pad / 2;
+        pe = pad - pb;
+    }
+
+    const int span = size + pb + pe - kernel;
+    if (span < 0)
+        return -1;
+
+    if (pad_mode == 0)
+    {
+        // ceil mode, a last window starting in the end padding is dropped
+        int out = (span + stride - 1) / stride + 1;
+        if ((out - 1) * stride >= size + pb)
+            out--;
+        tail = (out - 1) * stride + kernel - (size + pb + pe);
+        if (tail < 0)
+            tail = 0;
+    }
+
+    return 0;
+}
+
+int Pooling::resolve_padding(int w, int h, int& pad_l, int& pad_r, int& pad_t, int& pad_b, int& tail_r, int& tail_b) const
+{
+    if (resolve_padding_1d(w, kernel_w, stride_w, pad_mode, pad_left, pad_right, pad_l, pad_r, tail_r) != 0)
+        return -1;
+    if (resolve_padding_1d(h, kernel_h, stride_h, pad_mode, pad_top, pad_bottom, pad_t, pad_b, tail_b) != 0)
+        return -1;
+
+    return 0;
+}
+
+int Pooling::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    if (bottom_blob.dims != 3)
+        return -1;
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int channels = bottom_blob.c;
+    const int size = w * h;
+
+    if (global_pooling)
+    {
+        top_blob.create(channels, 4u, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+            for (int q = q0; q < q1; q++)
+            {
+                const float* ptr = bottom_blob.channel(q);
+
+                if (pooling_type == PoolMethod_MAX)
+                {
+                    float max = -FLT_MAX;
+                    for (int i = 0; i < size; i++)
+                        max = ptr[i] > max ? ptr[i] : max;
+                    top_blob[q] = max;
+                }
+                else
+                {
+                    float sum = 0.f;
+                    for (int i = 0; i < size; i++)
+                        sum += ptr[i];
+                    top_blob[q] = sum / size;
+                }
+            }
+        });
+
+        return 0;
+    }
+
+    int outw;
+    int outh;
+    int pad_l = 0;
+    int pad_r = 0;
+    int pad_t = 0;
+    int pad_b = 0;
+    int tail_r = 0;
+    int tail_b = 0;
+    if (adaptive_pooling)
+    {
+        outw = out_w == -233 ? w : out_w;
+        outh = out_h == -233 ? h : out_h;
+    }
+    else
+    {
+        if (resolve_padding(w, h, pad_l, pad_r, pad_t, pad_b, tail_r, tail_b) != 0)
+            return -1;
+
+        outw = (w + pad_l + pad_r + tail_r - kernel_w) / stride_w + 1;
+        outh = (h + pad_t + pad_b + tail_b - kernel_h) / stride_h + 1;
+    }
+
+    top_blob.create(outw, outh, channels, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            const Mat m = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
+
+            for (int i = 0; i < outh; i++)
+            {
+                for (int j = 0; j < outw; j++)
+                {
+                    // window [y0, y1) x [x0, x1) in input coordinates, padding positions included
+                    int y0, y1, x0, x1;
+                    if (adaptive_pooling)
+                    {
+                        y0 = i * h / outh;
+                        y1 = ((i + 1) * h + outh - 1) / outh;
+                        x0 = j * w / outw;
+                        x1 = ((j + 1) * w + outw - 1) / outw;
+                    }
+                    else
+                    {
+                        y0 = i * stride_h - pad_t;
+                        y1 = y0 + kernel_h;
+                        x0 = j * stride_w - pad_l;
+                        x1 = x0 + kernel_w;
+                    }
+
+                    const int ys = y0 > 0 ? y0 : 0;
+                    const int ye = y1 < h ? y1 : h;
+                    const int xs = x0 > 0 ? x0 : 0;
+                    const int xe = x1 < w ? x1 : w;
+
+                    if (pooling_type == PoolMethod_MAX)
+                    {
+                        float max = -FLT_MAX;
+                        for (int y = ys; y < ye; y++)
+                        {
+                            const float* sptr = m.row(y);
+                            for (int x = xs; x < xe; x++)
+                                max = sptr[x] > max ? sptr[x] : max;
+                        }
+                        outptr[j] = max;
+                    }
+                    else
+                    {
+                        float sum = 0.f;
+                        for (int y = ys; y < ye; y++)
+                        {
+                            const float* sptr = m.row(y);
+                            for (int x = xs; x < xe; x++)
+                                sum += sptr[x];
+                        }
+
+                        int area = (ye - ys) * (xe - xs);
+                        if (avgpool_count_include_pad)
+                        {
+                            const int pye = y1 < h + pad_b ? y1 : h + pad_b;
+                            const int pxe = x1 < w + pad_r ? x1 : w + pad_r;
+                            area = (pye - y0) * (pxe - x0);
+                        }
+
+                        outptr[j] = area > 0 ? sum / area : 0.f;
+                    }
+                }
+
+                outptr += outw;
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Pooling)
+
+} // namespace tinyinfer
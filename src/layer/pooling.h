@@ -0,0 +1,56 @@
+#ifndef LAYER_POOLING_H
+#define LAYER_POOLING_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Pooling : public Layer
+{
+public:
+    Pooling();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+    enum PoolMethod
+    {
+        PoolMethod_MAX = 0,
+        PoolMethod_AVE = 1
+    };
+
+    // padding of every side for a w x h input after pad_mode
+    // tail_right and tail_bottom extend full padding to the last window, they never count into an average
+    // return -1 if not even one window fits
+    int resolve_padding(int w, int h, int& pad_l, int& pad_r, int& pad_t, int& pad_b, int& tail_r, int& tail_b) const;
+
+public:
+    int pooling_type;
+    int kernel_w;
+    int kernel_h;
+    int stride_w;
+    int stride_h;
+    int pad_left;
+    int pad_right;
+    int pad_top;
+    int pad_bottom;
+    int global_pooling;
+
+    // 0 = full padding, ceil mode with the extra on the right and bottom
+    // 1 = valid padding, the explicit pads only
+    // 2 = SAME_UPPER, 3 = SAME_LOWER
+    int pad_mode;
+
+    // padded positions count into the average, the full padding extra never does
+    int avgpool_count_include_pad;
+
+    // out_w x out_h windows spread evenly over the input, -233 keeps the input size
+    int adaptive_pooling;
+    int out_w;
+    int out_h;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,81 @@
+#include "pooling1d.h"
+
+namespace tinyinfer {
+
+Pooling1D::Pooling1D()
+{
+}
+
+int Pooling1D::load_param(const ParamDict& pd)
+{
+    pooling_type = pd.get(0, 0);
+    kernel_w = pd.get(1, 0);
+    stride_w = pd.get(2, 1);
+    pad_left = pd.get(3, 0);
+    pad_right = pd.get(14, pad_left);
+    global_pooling = pd.get(4, 0);
+    pad_mode = pd.get(5, 0);
+    avgpool_count_include_pad = pd.get(6, 0);
+    adaptive_pooling = pd.get(7, 0);
+    out_w = pd.get(8, 0);
+
+    kernel_h = 1;
+    stride_h = 1;
+    pad_top = 0;
+    pad_bottom = 0;
+    out_h = -233;
+
+    if (pooling_type != PoolMethod_MAX && pooling_type != PoolMethod_AVE)
+        return -1;
+
+    if (pad_mode < 0 || pad_mode > 3)
+        return -1;
+
+    if (adaptive_pooling)
+    {
+        if (out_w <= 0 && out_w != -233)
+            return -1;
+    }
+    else if (!global_pooling)
+    {
+        if (kernel_w <= 0 || stride_w <= 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+int Pooling1D::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    if (bottom_blob.dims != 2)
+        return -1;
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+
+    Mat bottom_blob_3d = bottom_blob.reshape(w, 1, h, opt.workspace_allocator);
+    if (bottom_blob_3d.empty())
+        return -100;
+
+    Mat top_blob_3d;
+    int ret = Pooling::forward(bottom_blob_3d, top_blob_3d, opt);
+    if (ret != 0)
+        return ret;
+
+    // global pooling is 1d already
+    if (top_blob_3d.dims == 1)
+    {
+        top_blob = top_blob_3d;
+        return 0;
+    }
+
+    top_blob = top_blob_3d.reshape(top_blob_3d.w, h, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Pooling1D)
+
+} // namespace tinyinfer
@@ -0,0 +1,22 @@
+#ifndef LAYER_POOLING1D_H
+#define LAYER_POOLING1D_H
+
+#include "pooling.h"
+
+namespace tinyinfer {
+
+// pooling along w of a w x h blob, every row is a channel
+// runs as a 2d pooling with kernel_h 1 over the blob viewed as w x 1 x h
+class Pooling1D : public Pooling
+{
+public:
+    Pooling1D();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
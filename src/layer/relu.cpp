@@ -0,0 +1,54 @@
+#include "relu.h"
+
+#include "threadpool.h"
+
+namespace tinyinfer {
+
+ReLU::ReLU()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int ReLU::load_param(const ParamDict& pd)
+{
+    slope = pd.get(0, 0.f);
+
+    return 0;
+}
+
+int ReLU::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            if (slope == 0.f)
+            {
+                for (int i = 0; i < size; i++)
+                {
+                    if (ptr[i] < 0.f)
+                        ptr[i] = 0.f;
+                }
+            }
+            else
+            {
+                for (int i = 0; i < size; i++)
+                {
+                    if (ptr[i] < 0.f)
+                        ptr[i] *= slope;
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(ReLU)
+
+} // namespace tinyinfer
@@ -0,0 +1,24 @@
+#ifndef LAYER_RELU_H
+#define LAYER_RELU_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class ReLU : public Layer
+{
+public:
+    ReLU();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+public:
+    // negative part is multiplied by slope, 0 for plain relu
+    float slope;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,82 @@
+#include "reshape.h"
+
+namespace tinyinfer {
+
+Reshape::Reshape()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Reshape::load_param(const ParamDict& pd)
+{
+    w = pd.get(0, -233);
+    h = pd.get(1, -233);
+    d = pd.get(11, -233);
+    c = pd.get(2, -233);
+
+    return 0;
+}
+
+int Reshape::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int dims = h == -233 ? 1 : c == -233 ? 2 : d == -233 ? 3 : 4;
+
+    int shape[4] = {w, h, d, c};
+    const int bottom_shape[4] = {bottom_blob.w, bottom_blob.h, bottom_blob.d, bottom_blob.c};
+
+    const size_t total = (size_t)bottom_blob.w * bottom_blob.h * bottom_blob.d * bottom_blob.c;
+    size_t known = 1;
+    int infer = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        if (shape[i] == -233)
+            shape[i] = 1;
+        if (shape[i] == 0)
+            shape[i] = bottom_shape[i];
+
+        if (shape[i] == -1)
+        {
+            if (infer != -1)
+                return -1;
+            infer = i;
+        }
+        else if (shape[i] <= 0)
+        {
+            return -1;
+        }
+        else
+        {
+            known *= shape[i];
+        }
+    }
+
+    if (infer != -1)
+    {
+        if (total % known != 0)
+            return -1;
+        shape[infer] = (int)(total / known);
+        known = total;
+    }
+
+    if (known != total)
+        return -1;
+
+    // a view of the bottom unless the channel padding moves
+    if (dims == 1)
+        top_blob = bottom_blob.reshape(shape[0], opt.blob_allocator);
+    if (dims == 2)
+        top_blob = bottom_blob.reshape(shape[0], shape[1], opt.blob_allocator);
+    if (dims == 3)
+        top_blob = bottom_blob.reshape(shape[0], shape[1], shape[3], opt.blob_allocator);
+    if (dims == 4)
+        top_blob = bottom_blob.reshape(shape[0], shape[1], shape[2], shape[3], opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Reshape)
+
+} // namespace tinyinfer
@@ -0,0 +1,27 @@
+#ifndef LAYER_RESHAPE_H
+#define LAYER_RESHAPE_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Reshape : public Layer
+{
+public:
+    Reshape();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // -233 leaves the axis out, 0 keeps the bottom axis, -1 is inferred from the rest
+    int w;
+    int h;
+    int d;
+    int c;
+};
+
+} // namespace tinyinfer
+
+#endif
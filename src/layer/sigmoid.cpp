@@ -0,0 +1,36 @@
+#include "sigmoid.h"
+
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+Sigmoid::Sigmoid()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int Sigmoid::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = 1.f / (1.f + expf(-ptr[i]));
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Sigmoid)
+
+} // namespace tinyinfer
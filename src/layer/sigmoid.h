@@ -0,0 +1,18 @@
+#ifndef LAYER_SIGMOID_H
+#define LAYER_SIGMOID_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Sigmoid : public Layer
+{
+public:
+    Sigmoid();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,105 @@
+#include "softmax.h"
+
+#include "threadpool.h"
+#include <float.h>
+#include <math.h>
+
+namespace tinyinfer {
+
+Softmax::Softmax()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int Softmax::load_param(const ParamDict& pd)
+{
+    axis = pd.get(0, 0);
+
+    return 0;
+}
+
+int Softmax::resolve_axis(const Mat& m, int& channels, int& outer, int& n, int& inner, size_t& stride) const
+{
+    const int dims = m.dims;
+    const int positive_axis = axis < 0 ? dims + axis : axis;
+    if (positive_axis < 0 || positive_axis >= dims)
+        return -1;
+
+    if (dims >= 3 && positive_axis == 0)
+    {
+        channels = 1;
+        outer = 1;
+        n = m.c;
+        inner = m.w * m.h * m.d;
+        stride = m.cstep;
+        return 0;
+    }
+
+    // the axes inside one channel, outermost first
+    int shape[3];
+    int count = 0;
+    if (dims == 4)
+        shape[count++] = m.d;
+    if (dims >= 2)
+        shape[count++] = m.h;
+    shape[count++] = m.w;
+
+    const int a = dims >= 3 ? positive_axis - 1 : positive_axis;
+
+    channels = m.c;
+    outer = 1;
+    for (int i = 0; i < a; i++)
+        outer *= shape[i];
+    n = shape[a];
+    inner = 1;
+    for (int i = a + 1; i < count; i++)
+        inner *= shape[i];
+    stride = inner;
+
+    return 0;
+}
+
+int Softmax::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    int channels, outer, n, inner;
+    size_t stride;
+    if (resolve_axis(bottom_top_blob, channels, outer, n, inner, stride) != 0)
+        return -1;
+
+    parallel_for(opt, 0, channels * outer, 1, [&](int t0, int t1) {
+        for (int t = t0; t < t1; t++)
+        {
+            float* ptr = (float*)bottom_top_blob.channel(t / outer) + (size_t)(t % outer) * n * stride;
+
+            for (int i = 0; i < inner; i++)
+            {
+                float* p = ptr + i;
+
+                float max = -FLT_MAX;
+                for (int k = 0; k < n; k++)
+                {
+                    max = p[k * stride] > max ? p[k * stride] : max;
+                }
+
+                float sum = 0.f;
+                for (int k = 0; k < n; k++)
+                {
+                    p[k * stride] = expf(p[k * stride] - max);
+                    sum += p[k * stride];
+                }
+
+                for (int k = 0; k < n; k++)
+                {
+                    p[k * stride] /= sum;
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Softmax)
+
+} // namespace tinyinfer
@@ -0,0 +1,31 @@
+#ifndef LAYER_SOFTMAX_H
+#define LAYER_SOFTMAX_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Softmax : public Layer
+{
+public:
+    Softmax();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+protected:
+    // the axis as loops over the blob, -1 if it is outside dims
+    // every one of channels * outer groups starts at channel(q) + o * n * stride
+    // and holds inner independent softmaxes of n elements spaced stride apart
+    // the channel axis is a single group with stride cstep
+    int resolve_axis(const Mat& m, int& channels, int& outer, int& n, int& inner, size_t& stride) const;
+
+public:
+    // negative counts from the last axis
+    int axis;
+};
+
+} // namespace tinyinfer
+
+#endif
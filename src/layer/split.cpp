@@ -0,0 +1,25 @@
+#include "split.h"
+
+namespace tinyinfer {
+
+Split::Split()
+{
+    one_blob_only = false;
+    support_inplace = false;
+}
+
+int Split::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& /*opt*/) const
+{
+    // every output shares the input data by refcount
+    const Mat& bottom_blob = bottom_blobs[0];
+    for (size_t i = 0; i < top_blobs.size(); i++)
+    {
+        top_blobs[i] = bottom_blob;
+    }
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Split)
+
+} // namespace tinyinfer
@@ -0,0 +1,93 @@
+#include "squeeze.h"
+
+namespace tinyinfer {
+
+Squeeze::Squeeze()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Squeeze::load_param(const ParamDict& pd)
+{
+    squeeze_w = pd.get(0, 0);
+    squeeze_h = pd.get(1, 0);
+    squeeze_d = pd.get(11, 0);
+    squeeze_c = pd.get(2, 0);
+    axes = pd.get(3, Mat());
+
+    return 0;
+}
+
+int Squeeze::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int dims = bottom_blob.dims;
+
+    // outermost first
+    int shape[4];
+    int flags[4];
+    int count = 0;
+    if (dims >= 3)
+    {
+        shape[count] = bottom_blob.c;
+        flags[count++] = squeeze_c;
+    }
+    if (dims == 4)
+    {
+        shape[count] = bottom_blob.d;
+        flags[count++] = squeeze_d;
+    }
+    if (dims >= 2)
+    {
+        shape[count] = bottom_blob.h;
+        flags[count++] = squeeze_h;
+    }
+    shape[count] = bottom_blob.w;
+    flags[count++] = squeeze_w;
+
+    bool squeeze[4];
+    for (int i = 0; i < count; i++)
+    {
+        squeeze[i] = flags[i] && shape[i] == 1;
+    }
+
+    const int* axes_ptr = axes;
+    for (int i = 0; i < axes.w; i++)
+    {
+        const int axis = axes_ptr[i] < 0 ? dims + axes_ptr[i] : axes_ptr[i];
+        if (axis < 0 || axis >= dims || shape[axis] != 1)
+            return -1;
+
+        squeeze[axis] = true;
+    }
+
+    int outshape[4];
+    int outcount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (!squeeze[i])
+            outshape[outcount++] = shape[i];
+    }
+
+    // squeezing every axis leaves a single element
+    if (outcount == 0)
+        outshape[outcount++] = 1;
+
+    // a view of the bottom unless the channel padding moves
+    if (outcount == 1)
+        top_blob = bottom_blob.reshape(outshape[0], opt.blob_allocator);
+    if (outcount == 2)
+        top_blob = bottom_blob.reshape(outshape[1], outshape[0], opt.blob_allocator);
+    if (outcount == 3)
+        top_blob = bottom_blob.reshape(outshape[2], outshape[1], outshape[0], opt.blob_allocator);
+    if (outcount == 4)
+        top_blob = bottom_blob.reshape(outshape[3], outshape[2], outshape[1], outshape[0], opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Squeeze)
+
+} // namespace tinyinfer
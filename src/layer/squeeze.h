@@ -0,0 +1,30 @@
+#ifndef LAYER_SQUEEZE_H
+#define LAYER_SQUEEZE_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Squeeze : public Layer
+{
+public:
+    Squeeze();
+
+    virtual int load_param(const ParamDict& pd);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // drop the axis when it is 1
+    int squeeze_w;
+    int squeeze_h;
+    int squeeze_d;
+    int squeeze_c;
+
+    // outermost first, negative counts from the last axis, every one must be 1
+    Mat axes;
+};
+
+} // namespace tinyinfer
+
+#endif
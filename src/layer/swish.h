@@ -0,0 +1,18 @@
+#ifndef LAYER_SWISH_H
+#define LAYER_SWISH_H
+
+#include "layer.h"
+
+namespace tinyinfer {
+
+class Swish : public Layer
+{
+public:
+    Swish();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,96 @@
+#include "unaryop.h"
+
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+UnaryOp::UnaryOp()
+{
+    one_blob_only = true;
+    support_inplace = true;
+}
+
+int UnaryOp::load_param(const ParamDict& pd)
+{
+    op_type = pd.get(0, 0);
+
+    if (op_type < Operation_ABS || op_type > Operation_TRUNC)
+        return -1;
+
+    return 0;
+}
+
+static float unaryop_ss(float x, int op_type)
+{
+    switch (op_type)
+    {
+    case UnaryOp::Operation_ABS:
+        return fabsf(x);
+    case UnaryOp::Operation_NEG:
+        return -x;
+    case UnaryOp::Operation_FLOOR:
+        return floorf(x);
+    case UnaryOp::Operation_CEIL:
+        return ceilf(x);
+    case UnaryOp::Operation_SQUARE:
+        return x * x;
+    case UnaryOp::Operation_SQRT:
+        return sqrtf(x);
+    case UnaryOp::Operation_RSQRT:
+        return 1.f / sqrtf(x);
+    case UnaryOp::Operation_EXP:
+        return expf(x);
+    case UnaryOp::Operation_LOG:
+        return logf(x);
+    case UnaryOp::Operation_SIN:
+        return sinf(x);
+    case UnaryOp::Operation_COS:
+        return cosf(x);
+    case UnaryOp::Operation_TAN:
+        return tanf(x);
+    case UnaryOp::Operation_ASIN:
+        return asinf(x);
+    case UnaryOp::Operation_ACOS:
+        return acosf(x);
+    case UnaryOp::Operation_ATAN:
+        return atanf(x);
+    case UnaryOp::Operation_RECIPROCAL:
+        return 1.f / x;
+    case UnaryOp::Operation_TANH:
+        return tanhf(x);
+    case UnaryOp::Operation_LOG10:
+        return log10f(x);
+    case UnaryOp::Operation_ROUND:
+        // ties to even, onnx Round
+        return nearbyintf(x);
+    case UnaryOp::Operation_TRUNC:
+        return truncf(x);
+    default:
+        return x;
+    }
+}
+
+int UnaryOp::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = unaryop_ss(ptr[i], op_type);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(UnaryOp)
+
+} // namespace tinyinfer
@@ -0,0 +1,97 @@
+#include "batchnorm_x86.h"
+
+#include "threadpool.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+namespace tinyinfer {
+
+BatchNorm_x86::BatchNorm_x86()
+{
+}
+
+// ptr = ptr * b + a over one contiguous run
+static void batchnorm_affine(float* ptr, float a, float b, int size)
+{
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    __m512 _a_avx512 = _mm512_set1_ps(a);
+    __m512 _b_avx512 = _mm512_set1_ps(b);
+    for (; i + 15 < size; i += 16)
+    {
+        __m512 _p = _mm512_loadu_ps(ptr);
+        _mm512_storeu_ps(ptr, _mm512_fmadd_ps(_p, _b_avx512, _a_avx512));
+        ptr += 16;
+    }
+#endif // __AVX512F__
+    __m256 _a_avx = _mm256_set1_ps(a);
+    __m256 _b_avx = _mm256_set1_ps(b);
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = _mm256_loadu_ps(ptr);
+#if __FMA__
+        _mm256_storeu_ps(ptr, _mm256_fmadd_ps(_p, _b_avx, _a_avx));
+#else
+        _mm256_storeu_ps(ptr, _mm256_add_ps(_mm256_mul_ps(_p, _b_avx), _a_avx));
+#endif
+        ptr += 8;
+    }
+#endif // __AVX__
+    __m128 _a = _mm_set1_ps(a);
+    __m128 _b = _mm_set1_ps(b);
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p = _mm_loadu_ps(ptr);
+        _mm_storeu_ps(ptr, _mm_add_ps(_mm_mul_ps(_p, _b), _a));
+        ptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *ptr = *ptr * b + a;
+        ptr++;
+    }
+}
+
+int BatchNorm_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int dims = bottom_top_blob.dims;
+
+    // one scalar per element, nothing to broadcast
+    if (dims == 1)
+        return BatchNorm::forward_inplace(bottom_top_blob, opt);
+
+    if (dims == 2)
+    {
+        parallel_for(opt, 0, bottom_top_blob.h, 1, [&](int i0, int i1) {
+            for (int i = i0; i < i1; i++)
+            {
+                batchnorm_affine(bottom_top_blob.row(i), a_data[i], b_data[i], bottom_top_blob.w);
+            }
+        });
+
+        return 0;
+    }
+
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d;
+
+    parallel_for(opt, 0, bottom_top_blob.c, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            batchnorm_affine(bottom_top_blob.channel(q), a_data[q], b_data[q], size);
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(BatchNorm_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_BATCHNORM_X86_H
+#define LAYER_BATCHNORM_X86_H
+
+#include "batchnorm.h"
+
+namespace tinyinfer {
+
+class BatchNorm_x86 : public BatchNorm
+{
+public:
+    BatchNorm_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,287 @@
+#include "binaryop_x86.h"
+
+#include "mathfun_x86.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace tinyinfer {
+
+// floats per task when a single row is split over the threads
+#define BINARYOP_X86_GRAIN 16384
+
+BinaryOp_x86::BinaryOp_x86()
+{
+}
+
+template<int op_type>
+static inline sgemm_vec binaryop_vec(sgemm_vec _a, sgemm_vec _b)
+{
+    switch (op_type)
+    {
+    case BinaryOp::Operation_ADD:
+        return sgemm_add(_a, _b);
+    case BinaryOp::Operation_SUB:
+        return sgemm_sub(_a, _b);
+    case BinaryOp::Operation_MUL:
+        return sgemm_mul(_a, _b);
+    case BinaryOp::Operation_DIV:
+        return mathfun_div(_a, _b);
+    case BinaryOp::Operation_MAX:
+        return mathfun_max(_a, _b);
+    case BinaryOp::Operation_MIN:
+        return mathfun_min(_a, _b);
+    case BinaryOp::Operation_POW:
+        return mathfun_pow(_a, _b);
+    case BinaryOp::Operation_RSUB:
+        return sgemm_sub(_b, _a);
+    case BinaryOp::Operation_RDIV:
+        return mathfun_div(_b, _a);
+    case BinaryOp::Operation_RPOW:
+        return mathfun_pow(_b, _a);
+    case BinaryOp::Operation_ATAN2:
+        return mathfun_atan2(_a, _b);
+    case BinaryOp::Operation_RATAN2:
+        return mathfun_atan2(_b, _a);
+    default:
+        return _a;
+    }
+}
+
+// n outputs, an operand with step 1 walks along, step 0 repeats its first element
+// outptr may be pa, every element is read before it is written
+template<int op_type>
+static void binaryop_kernel(const float* pa, int a_step, const float* pb, int b_step, float* outptr, int n)
+{
+    int i = 0;
+    if (a_step && b_step)
+    {
+        for (; i + SGEMM_VL <= n; i += SGEMM_VL)
+        {
+            sgemm_store(outptr + i, binaryop_vec<op_type>(sgemm_load(pa + i), sgemm_load(pb + i)));
+        }
+    }
+    else if (a_step)
+    {
+        const sgemm_vec _b = sgemm_set1(pb[0]);
+        for (; i + SGEMM_VL <= n; i += SGEMM_VL)
+        {
+            sgemm_store(outptr + i, binaryop_vec<op_type>(sgemm_load(pa + i), _b));
+        }
+    }
+    else if (b_step)
+    {
+        const sgemm_vec _a = sgemm_set1(pa[0]);
+        for (; i + SGEMM_VL <= n; i += SGEMM_VL)
+        {
+            sgemm_store(outptr + i, binaryop_vec<op_type>(_a, sgemm_load(pb + i)));
+        }
+    }
+    else
+    {
+        const sgemm_vec _v = binaryop_vec<op_type>(sgemm_set1(pa[0]), sgemm_set1(pb[0]));
+        for (; i + SGEMM_VL <= n; i += SGEMM_VL)
+        {
+            sgemm_store(outptr + i, _v);
+        }
+    }
+
+    // the tail runs through the same vector code, every element gets the same approximation
+    if (i < n)
+    {
+        float ta[SGEMM_VL] = {0.f};
+        float tb[SGEMM_VL] = {0.f};
+        for (int j = 0; j < n - i; j++)
+        {
+            ta[j] = pa[a_step ? i + j : 0];
+            tb[j] = pb[b_step ? i + j : 0];
+        }
+        sgemm_store(ta, binaryop_vec<op_type>(sgemm_load(ta), sgemm_load(tb)));
+        memcpy(outptr + i, ta, (n - i) * sizeof(float));
+    }
+}
+
+template<int op_type>
+static void binaryop_broadcast(const Mat& A2, const Mat& B2, Mat& top_blob, const Option& opt)
+{
+    const int outw = std::max(A2.w, B2.w);
+    const int outh = std::max(A2.h, B2.h);
+    const int outd = std::max(A2.d, B2.d);
+    const int outc = std::max(A2.c, B2.c);
+
+    const int size = outw * outh * outd;
+
+    // every operand either covers the whole channel or is one value per channel, a channel is one long row
+    // otherwise the output is walked row by row, each operand row is full or one value and h and d index the rows
+    const bool a_full = A2.w == outw && A2.h == outh && A2.d == outd;
+    const bool b_full = B2.w == outw && B2.h == outh && B2.d == outd;
+    const bool a_single = A2.w * A2.h * A2.d == 1;
+    const bool b_single = B2.w * B2.h * B2.d == 1;
+    const bool flat = (a_full || a_single) && (b_full || b_single);
+
+    const int rows = flat ? 1 : outd * outh;
+    const int row_size = flat ? size : outw;
+    const int a_step = flat ? (a_full ? 1 : 0) : (A2.w == outw ? 1 : 0);
+    const int b_step = flat ? (b_full ? 1 : 0) : (B2.w == outw ? 1 : 0);
+
+    // one big row splits into chunks so that a single channel still uses every thread
+    const int chunks = outc * rows == 1 ? (row_size + BINARYOP_X86_GRAIN - 1) / BINARYOP_X86_GRAIN : 1;
+    const int chunk_size = (row_size + chunks - 1) / chunks;
+    const int grain = std::max(1, BINARYOP_X86_GRAIN / row_size);
+
+    parallel_for(opt, 0, outc * rows * chunks, grain, [&](int t0, int t1) {
+        for (int t = t0; t < t1; t++)
+        {
+            const int q = t / (rows * chunks);
+            const int r = t / chunks % rows;
+            const int i0 = t % chunks * chunk_size;
+            const int n = std::min(chunk_size, row_size - i0);
+
+            const float* pa = A2.channel(A2.c == 1 ? 0 : q);
+            const float* pb = B2.channel(B2.c == 1 ? 0 : q);
+            float* outptr = (float*)top_blob.channel(q) + (size_t)r * row_size + i0;
+
+            if (!flat)
+            {
+                const int z = r / outh;
+                const int y = r % outh;
+                pa += ((A2.d == 1 ? 0 : z) * A2.h + (A2.h == 1 ? 0 : y)) * A2.w;
+                pb += ((B2.d == 1 ? 0 : z) * B2.h + (B2.h == 1 ? 0 : y)) * B2.w;
+            }
+
+            binaryop_kernel<op_type>(pa + a_step * i0, a_step, pb + b_step * i0, b_step, outptr, n);
+        }
+    });
+}
+
+template<int op_type>
+static void binaryop_scalar(Mat& m, float b, const Option& opt)
+{
+    const sgemm_vec _b = sgemm_set1(b);
+    mathfun_inplace(m, [&](sgemm_vec _x) { return binaryop_vec<op_type>(_x, _b); }, opt);
+}
+
+int BinaryOp_x86::forward_inplace(std::vector<Mat>& bottom_top_blobs, const Option& opt) const
+{
+    if (bottom_top_blobs.size() < 2)
+        return -1;
+
+    const Mat& A = bottom_top_blobs[0];
+    const Mat& B = bottom_top_blobs[1];
+
+    Mat A2;
+    Mat B2;
+    if (broadcast(A, B, A2, B2) != 0)
+        return -1;
+
+    // A is overwritten only when nothing of it is broadcast, otherwise the output gets its own blob
+    Mat top_blob;
+    if (A.dims == A2.dims && A.w >= B2.w && A.h >= B2.h && A.d >= B2.d && A.c >= B2.c)
+    {
+        top_blob = A;
+    }
+    else
+    {
+        create_broadcast_output(A2, B2, top_blob, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+    }
+
+    switch (op_type)
+    {
+    case Operation_ADD:
+        binaryop_broadcast<Operation_ADD>(A2, B2, top_blob, opt);
+        break;
+    case Operation_SUB:
+        binaryop_broadcast<Operation_SUB>(A2, B2, top_blob, opt);
+        break;
+    case Operation_MUL:
+        binaryop_broadcast<Operation_MUL>(A2, B2, top_blob, opt);
+        break;
+    case Operation_DIV:
+        binaryop_broadcast<Operation_DIV>(A2, B2, top_blob, opt);
+        break;
+    case Operation_MAX:
+        binaryop_broadcast<Operation_MAX>(A2, B2, top_blob, opt);
+        break;
+    case Operation_MIN:
+        binaryop_broadcast<Operation_MIN>(A2, B2, top_blob, opt);
+        break;
+    case Operation_POW:
+        binaryop_broadcast<Operation_POW>(A2, B2, top_blob, opt);
+        break;
+    case Operation_RSUB:
+        binaryop_broadcast<Operation_RSUB>(A2, B2, top_blob, opt);
+        break;
+    case Operation_RDIV:
+        binaryop_broadcast<Operation_RDIV>(A2, B2, top_blob, opt);
+        break;
+    case Operation_RPOW:
+        binaryop_broadcast<Operation_RPOW>(A2, B2, top_blob, opt);
+        break;
+    case Operation_ATAN2:
+        binaryop_broadcast<Operation_ATAN2>(A2, B2, top_blob, opt);
+        break;
+    case Operation_RATAN2:
+        binaryop_broadcast<Operation_RATAN2>(A2, B2, top_blob, opt);
+        break;
+    default:
+        return -1;
+    }
+
+    bottom_top_blobs[0] = top_blob;
+
+    return 0;
+}
+
+int BinaryOp_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    switch (op_type)
+    {
+    case Operation_ADD:
+        binaryop_scalar<Operation_ADD>(bottom_top_blob, b, opt);
+        break;
+    case Operation_SUB:
+        binaryop_scalar<Operation_SUB>(bottom_top_blob, b, opt);
+        break;
+    case Operation_MUL:
+        binaryop_scalar<Operation_MUL>(bottom_top_blob, b, opt);
+        break;
+    case Operation_DIV:
+        binaryop_scalar<Operation_DIV>(bottom_top_blob, b, opt);
+        break;
+    case Operation_MAX:
+        binaryop_scalar<Operation_MAX>(bottom_top_blob, b, opt);
+        break;
+    case Operation_MIN:
+        binaryop_scalar<Operation_MIN>(bottom_top_blob, b, opt);
+        break;
+    case Operation_POW:
+        binaryop_scalar<Operation_POW>(bottom_top_blob, b, opt);
+        break;
+    case Operation_RSUB:
+        binaryop_scalar<Operation_RSUB>(bottom_top_blob, b, opt);
+        break;
+    case Operation_RDIV:
+        binaryop_scalar<Operation_RDIV>(bottom_top_blob, b, opt);
+        break;
+    case Operation_RPOW:
+        binaryop_scalar<Operation_RPOW>(bottom_top_blob, b, opt);
+        break;
+    case Operation_ATAN2:
+        binaryop_scalar<Operation_ATAN2>(bottom_top_blob, b, opt);
+        break;
+    case Operation_RATAN2:
+        binaryop_scalar<Operation_RATAN2>(bottom_top_blob, b, opt);
+        break;
+    default:
+        return -1;
+    }
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(BinaryOp_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,19 @@
+#ifndef LAYER_BINARYOP_X86_H
+#define LAYER_BINARYOP_X86_H
+
+#include "binaryop.h"
+
+namespace tinyinfer {
+
+class BinaryOp_x86 : public BinaryOp
+{
+public:
+    BinaryOp_x86();
+
+    virtual int forward_inplace(std::vector<Mat>& bottom_top_blobs, const Option& opt) const;
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
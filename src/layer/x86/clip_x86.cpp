@@ -0,0 +1,23 @@
+#include "clip_x86.h"
+
+#include "x86_activation.h"
+
+namespace tinyinfer {
+
+Clip_x86::Clip_x86()
+{
+}
+
+int Clip_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const sgemm_vec _min = sgemm_set1(min);
+    const sgemm_vec _max = sgemm_set1(max);
+
+    mathfun_inplace(bottom_top_blob, [&](sgemm_vec _x) { return activation_clip(_x, _min, _max); }, opt);
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Clip_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_CLIP_X86_H
+#define LAYER_CLIP_X86_H
+
+#include "clip.h"
+
+namespace tinyinfer {
+
+class Clip_x86 : public Clip
+{
+public:
+    Clip_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,370 @@
+#ifndef LAYER_CONVOLUTION_3X3_WINOGRAD_H
+#define LAYER_CONVOLUTION_3X3_WINOGRAD_H
+
+// winograd F(m, 3) for 3x3 stride 1 convolution, one tile of m + 2 inputs per side gives m x m outputs
+//
+// U = G g G^T is computed once per kernel and packed as the sgemm A operand of every tile position
+// V = B^T d B of a block of input tiles is written straight into packed sgemm B layout
+// the elementwise products over tile positions become one (outch x inch) * (inch x tiles) gemm per position
+// and Y = A^T M A turns every tile back into m x m outputs
+//
+// F(6,3) has 8x8 tiles, F(4,3) has 6x6 tiles and about 4x less rounding error
+
+#include "sgemm_x86.h"
+
+namespace tinyinfer {
+
+// G
+static const float winograd63_ktm[8][3] = {
+    {1.0f, 0.0f, 0.0f},
+    {-2.0f / 9, -2.0f / 9, -2.0f / 9},
+    {-2.0f / 9, 2.0f / 9, -2.0f / 9},
+    {1.0f / 90, 1.0f / 45, 2.0f / 45},
+    {1.0f / 90, -1.0f / 45, 2.0f / 45},
+    {1.0f / 45, 1.0f / 90, 1.0f / 180},
+    {1.0f / 45, -1.0f / 90, 1.0f / 180},
+    {0.0f, 0.0f, 1.0f}
+};
+
+static const float winograd43_ktm[6][3] = {
+    {1.0f / 4, 0.0f, 0.0f},
+    {-1.0f / 6, -1.0f / 6, -1.0f / 6},
+    {-1.0f / 6, 1.0f / 6, -1.0f / 6},
+    {1.0f / 24, 1.0f / 12, 1.0f / 6},
+    {1.0f / 24, -1.0f / 12, 1.0f / 6},
+    {0.0f, 0.0f, 1.0f}
+};
+
+// B^T over 8 vectors r[i * rs], written to t[i * ts]
+static inline void winograd63_transform_input(const sgemm_vec* r, int rs, sgemm_vec* t, int ts)
+{
+    const sgemm_vec _r0 = r[0];
+    const sgemm_vec _r1 = r[rs];
+    const sgemm_vec _r2 = r[rs * 2];
+    const sgemm_vec _r3 = r[rs * 3];
+    const sgemm_vec _r4 = r[rs * 4];
+    const sgemm_vec _r5 = r[rs * 5];
+    const sgemm_vec _r6 = r[rs * 6];
+    const sgemm_vec _r7 = r[rs * 7];
+
+    const sgemm_vec _v5_25 = sgemm_set1(5.25f);
+    const sgemm_vec _vm4_25 = sgemm_set1(-4.25f);
+    const sgemm_vec _vm2_5 = sgemm_set1(-2.5f);
+    const sgemm_vec _vm1_25 = sgemm_set1(-1.25f);
+    const sgemm_vec _v0_25 = sgemm_set1(0.25f);
+    const sgemm_vec _v0_5 = sgemm_set1(0.5f);
+    const sgemm_vec _v2 = sgemm_set1(2.f);
+    const sgemm_vec _v4 = sgemm_set1(4.f);
+
+    const sgemm_vec _tmp12a = sgemm_fmadd(_r4, _vm4_25, sgemm_add(_r2, _r6));
+    const sgemm_vec _tmp12b = sgemm_fmadd(_r3, _vm4_25, sgemm_add(_r1, _r5));
+    const sgemm_vec _tmp34a = sgemm_fmadd(_r4, _vm1_25, sgemm_fmadd(_r2, _v0_25, _r6));
+    const sgemm_vec _tmp34b = sgemm_fmadd(_r5, _v2, sgemm_fmadd(_r3, _vm2_5, sgemm_mul(_r1, _v0_5)));
+    const sgemm_vec _tmp56a = sgemm_fmadd(sgemm_fmadd(_r4, _vm1_25, _r2), _v4, _r6);
+    const sgemm_vec _tmp56b = sgemm_fmadd(_r5, _v0_5, sgemm_fmadd(_r3, _vm2_5, sgemm_mul(_r1, _v2)));
+
+    t[0] = sgemm_fmadd(sgemm_sub(_r4, _r2), _v5_25, sgemm_sub(_r0, _r6));
+    t[ts] = sgemm_add(_tmp12a, _tmp12b);
+    t[ts * 2] = sgemm_sub(_tmp12a, _tmp12b);
+    t[ts * 3] = sgemm_add(_tmp34a, _tmp34b);
+    t[ts * 4] = sgemm_sub(_tmp34a, _tmp34b);
+    t[ts * 5] = sgemm_add(_tmp56a, _tmp56b);
+    t[ts * 6] = sgemm_sub(_tmp56a, _tmp56b);
+    t[ts * 7] = sgemm_fmadd(sgemm_sub(_r3, _r5), _v5_25, sgemm_sub(_r7, _r1));
+}
+
+// A^T over 8 vectors r[i * rs], 6 results written to t[i * ts]
+static inline void winograd63_transform_output(const sgemm_vec* r, int rs, sgemm_vec* t, int ts)
+{
+    const sgemm_vec _tmp024a = sgemm_add(r[rs], r[rs * 2]);
+    const sgemm_vec _tmp135a = sgemm_sub(r[rs], r[rs * 2]);
+    const sgemm_vec _tmp024b = sgemm_add(r[rs * 3], r[rs * 4]);
+    const sgemm_vec _tmp135b = sgemm_sub(r[rs * 3], r[rs * 4]);
+    const sgemm_vec _tmp024c = sgemm_add(r[rs * 5], r[rs * 6]);
+    const sgemm_vec _tmp135c = sgemm_sub(r[rs * 5], r[rs * 6]);
+
+    const sgemm_vec _v2 = sgemm_set1(2.f);
+    const sgemm_vec _v4 = sgemm_set1(4.f);
+    const sgemm_vec _v8 = sgemm_set1(8.f);
+    const sgemm_vec _v16 = sgemm_set1(16.f);
+    const sgemm_vec _v32 = sgemm_set1(32.f);
+
+    t[0] = sgemm_fmadd(_tmp024c, _v32, sgemm_add(sgemm_add(r[0], _tmp024a), _tmp024b));
+    t[ts * 2] = sgemm_fmadd(_tmp024c, _v8, sgemm_fmadd(_tmp024b, _v4, _tmp024a));
+    t[ts * 4] = sgemm_fmadd(_tmp024c, _v2, sgemm_fmadd(_tmp024b, _v16, _tmp024a));
+    t[ts] = sgemm_fmadd(_tmp135c, _v16, sgemm_fmadd(_tmp135b, _v2, _tmp135a));
+    t[ts * 3] = sgemm_fmadd(_tmp135c, _v4, sgemm_fmadd(_tmp135b, _v8, _tmp135a));
+    t[ts * 5] = sgemm_add(sgemm_fmadd(_tmp135b, _v32, sgemm_add(r[rs * 7], _tmp135a)), _tmp135c);
+}
+
+// B^T over 6 vectors
+static inline void winograd43_transform_input(const sgemm_vec* r, int rs, sgemm_vec* t, int ts)
+{
+    const sgemm_vec _r0 = r[0];
+    const sgemm_vec _r1 = r[rs];
+    const sgemm_vec _r2 = r[rs * 2];
+    const sgemm_vec _r3 = r[rs * 3];
+    const sgemm_vec _r4 = r[rs * 4];
+    const sgemm_vec _r5 = r[rs * 5];
+
+    const sgemm_vec _vm5 = sgemm_set1(-5.f);
+    const sgemm_vec _vm4 = sgemm_set1(-4.f);
+    const sgemm_vec _vm2 = sgemm_set1(-2.f);
+    const sgemm_vec _v2 = sgemm_set1(2.f);
+    const sgemm_vec _v4 = sgemm_set1(4.f);
+
+    const sgemm_vec _tmp13 = sgemm_sub(_r1, _r3);
+    const sgemm_vec _tmp42 = sgemm_sub(_r4, _r2);
+
+    t[0] = sgemm_fmadd(_r2, _vm5, sgemm_fmadd(_r0, _v4, _r4));
+    t[ts] = sgemm_fmadd(sgemm_add(_r1, _r2), _vm4, sgemm_add(_r3, _r4));
+    t[ts * 2] = sgemm_fmadd(sgemm_sub(_r1, _r2), _v4, sgemm_sub(_r4, _r3));
+    t[ts * 3] = sgemm_fmadd(_tmp13, _vm2, _tmp42);
+    t[ts * 4] = sgemm_fmadd(_tmp13, _v2, _tmp42);
+    t[ts * 5] = sgemm_fmadd(_r3, _vm5, sgemm_fmadd(_r1, _v4, _r5));
+}
+
+// A^T over 6 vectors, 4 results
+static inline void winograd43_transform_output(const sgemm_vec* r, int rs, sgemm_vec* t, int ts)
+{
+    const sgemm_vec _tmp02a = sgemm_add(r[rs], r[rs * 2]);
+    const sgemm_vec _tmp13a = sgemm_sub(r[rs], r[rs * 2]);
+    const sgemm_vec _tmp02b = sgemm_add(r[rs * 3], r[rs * 4]);
+    const sgemm_vec _tmp13b = sgemm_sub(r[rs * 3], r[rs * 4]);
+
+    t[0] = sgemm_add(sgemm_add(r[0], _tmp02a), _tmp02b);
+    t[ts] = sgemm_fmadd(_tmp13b, sgemm_set1(2.f), _tmp13a);
+    t[ts * 2] = sgemm_fmadd(_tmp02b, sgemm_set1(4.f), _tmp02a);
+    t[ts * 3] = sgemm_fmadd(_tmp13b, sgemm_set1(8.f), sgemm_add(r[rs * 5], _tmp13a));
+}
+
+// U = G g G^T for every (outch, inch) pair, packed per tile position as a num_output x num_input sgemm A
+static int conv3x3s1_winograd_transform_kernel(const Mat& kernel, Mat& kernel_tm_packed, int num_input, int num_output, int tile, const Option& opt)
+{
+    const int tile_area = tile * tile;
+    const float* ktm = tile == 8 ? &winograd63_ktm[0][0] : &winograd43_ktm[0][0];
+
+    // [tile position][outch][inch]
+    Mat kernel_tm;
+    kernel_tm.create(num_input * num_output * tile_area, 4u, opt.workspace_allocator);
+    if (kernel_tm.empty())
+        return -100;
+
+    parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+        for (int p = p0; p < p1; p++)
+        {
+            for (int q = 0; q < num_input; q++)
+            {
+                const float* g = (const float*)kernel + ((size_t)p * num_input + q) * 9;
+
+                // G g
+                float tmp[8][3];
+                for (int i = 0; i < tile; i++)
+                {
+                    for (int j = 0; j < 3; j++)
+                    {
+                        tmp[i][j] = ktm[i * 3] * g[j] + ktm[i * 3 + 1] * g[3 + j] + ktm[i * 3 + 2] * g[6 + j];
+                    }
+                }
+
+                // (G g) G^T
+                for (int i = 0; i < tile; i++)
+                {
+                    for (int j = 0; j < tile; j++)
+                    {
+                        const float v = tmp[i][0] * ktm[j * 3] + tmp[i][1] * ktm[j * 3 + 1] + tmp[i][2] * ktm[j * 3 + 2];
+                        kernel_tm[((size_t)(i * tile + j) * num_output + p) * num_input + q] = v;
+                    }
+                }
+            }
+        }
+    });
+
+    const size_t packed_size = sgemm_packed_size(num_output, num_input, SGEMM_MR);
+
+    kernel_tm_packed.create((int)(packed_size * tile_area), 4u, opt.workspace_allocator);
+    if (kernel_tm_packed.empty())
+        return -100;
+
+    for (int x = 0; x < tile_area; x++)
+    {
+        const float* ptr = (const float*)kernel_tm + (size_t)x * num_output * num_input;
+        sgemm_pack(ptr, num_input, 0, num_output, num_input, SGEMM_MR, (float*)kernel_tm_packed + packed_size * x, opt);
+    }
+
+    return 0;
+}
+
+// bottom_blob_bordered covers tiles_w x tiles_h whole tiles, top_blob is cropped to outw x outh
+static void conv3x3s1_winograd(const Mat& bottom_blob_bordered, Mat& top_blob, const Mat& kernel_tm_packed, const Mat& bias_data, int tile, const sgemm_epilogue& ep, const Option& opt)
+{
+    const int num_input = bottom_blob_bordered.c;
+    const int num_output = top_blob.c;
+    const int outw = top_blob.w;
+    const int outh = top_blob.h;
+
+    const int m = tile - 2;
+    const int tile_area = tile * tile;
+    const int tiles_w = (outw + m - 1) / m;
+    const int tiles_h = (outh + m - 1) / m;
+    const int tiles = tiles_w * tiles_h;
+    const int NV = SGEMM_NR / SGEMM_VL;
+
+    // a block of tiles keeps the transformed input and output of all tile positions around l2 size
+    int block = (256 * 1024) / ((num_input + num_output) * tile_area) / SGEMM_NR * SGEMM_NR;
+    block = std::max(block, SGEMM_NR);
+    block = std::min(block, (int)sgemm_packed_size(tiles, 1, SGEMM_NR));
+
+    const size_t kernel_packed_size = sgemm_packed_size(num_output, num_input, SGEMM_MR);
+    const size_t input_packed_size = sgemm_packed_size(block, num_input, SGEMM_NR);
+
+    // [tile position] packed inch x tiles, [tile position][outch][tiles]
+    Mat input_tm;
+    input_tm.create((int)(input_packed_size * tile_area), 4u, opt.workspace_allocator);
+    Mat output_tm;
+    output_tm.create(block * num_output * tile_area, 4u, opt.workspace_allocator);
+
+    const float* biasptr = bias_data;
+
+    for (int t0 = 0; t0 < tiles; t0 += block)
+    {
+        const int nt = std::min(block, tiles - t0);
+
+        // V = B^T d B, SGEMM_NR tiles at a time so that every tile position gets one contiguous sliver row
+        parallel_for(opt, 0, num_input, 1, [&](int q0, int q1) {
+            sgemm_vec d[8 * 8][NV];
+            sgemm_vec tmp[8 * 8][NV];
+
+            for (int q = q0; q < q1; q++)
+            {
+                const Mat img = bottom_blob_bordered.channel(q);
+
+                for (int t = 0; t < nt; t += SGEMM_NR)
+                {
+                    float* dptr = (float*)d;
+                    for (int r = 0; r < SGEMM_NR; r++)
+                    {
+                        if (t + r >= nt)
+                        {
+                            for (int x = 0; x < tile_area; x++)
+                                dptr[x * SGEMM_NR + r] = 0.f;
+                            continue;
+                        }
+
+                        const int ty = (t0 + t + r) / tiles_w;
+                        const int tx = (t0 + t + r) % tiles_w;
+                        const float* r0 = img.row(ty * m) + tx * m;
+
+                        for (int i = 0; i < tile; i++)
+                        {
+                            for (int j = 0; j < tile; j++)
+                            {
+                                dptr[(i * tile + j) * SGEMM_NR + r] = r0[j];
+                            }
+                            r0 += img.w;
+                        }
+                    }
+
+                    for (int g = 0; g < NV; g++)
+                    {
+                        for (int i = 0; i < tile; i++)
+                        {
+                            if (tile == 8)
+                                winograd63_transform_input(&d[i * tile][g], NV, &tmp[i * tile][g], NV);
+                            else
+                                winograd43_transform_input(&d[i * tile][g], NV, &tmp[i * tile][g], NV);
+                        }
+                        for (int j = 0; j < tile; j++)
+                        {
+                            if (tile == 8)
+                                winograd63_transform_input(&tmp[j][g], tile * NV, &d[j][g], tile * NV);
+                            else
+                                winograd43_transform_input(&tmp[j][g], tile * NV, &d[j][g], tile * NV);
+                        }
+                    }
+
+                    const size_t offset = sgemm_packed_offset(t, q, nt, num_input, SGEMM_NR);
+                    for (int x = 0; x < tile_area; x++)
+                    {
+                        memcpy((float*)input_tm + input_packed_size * x + offset, d[x], SGEMM_NR * sizeof(float));
+                    }
+                }
+            }
+        });
+
+        // M = U V, one gemm per tile position
+        parallel_for(opt, 0, tile_area, 1, [&](int x0, int x1) {
+            for (int x = x0; x < x1; x++)
+            {
+                const float* kptr = (const float*)kernel_tm_packed + kernel_packed_size * x;
+                const float* vptr = (const float*)input_tm + input_packed_size * x;
+                float* mptr = (float*)output_tm + (size_t)block * num_output * x;
+
+                sgemm_packed(num_output, nt, num_input, kptr, vptr, mptr, block, sgemm_epilogue_default(), opt);
+            }
+        });
+
+        // Y = A^T M A, with bias and activation
+        parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+            sgemm_vec d[8 * 8][NV];
+            sgemm_vec tmp[8 * 8][NV];
+
+            for (int p = p0; p < p1; p++)
+            {
+                const float bias = biasptr ? biasptr[p] : 0.f;
+
+                for (int t = 0; t < nt; t += SGEMM_NR)
+                {
+                    // the row tail past nt is never written by the gemm, whatever it holds is transformed and dropped
+                    for (int x = 0; x < tile_area; x++)
+                    {
+                        memcpy(d[x], (const float*)output_tm + ((size_t)x * num_output + p) * block + t, SGEMM_NR * sizeof(float));
+                    }
+
+                    for (int g = 0; g < NV; g++)
+                    {
+                        for (int i = 0; i < tile; i++)
+                        {
+                            if (tile == 8)
+                                winograd63_transform_output(&d[i * tile][g], NV, &tmp[i * m][g], NV);
+                            else
+                                winograd43_transform_output(&d[i * tile][g], NV, &tmp[i * m][g], NV);
+                        }
+                        for (int j = 0; j < m; j++)
+                        {
+                            if (tile == 8)
+                                winograd63_transform_output(&tmp[j][g], m * NV, &d[j][g], m * NV);
+                            else
+                                winograd43_transform_output(&tmp[j][g], m * NV, &d[j][g], m * NV);
+                        }
+                    }
+
+                    const float* dptr = (const float*)d;
+                    const int nr = std::min(SGEMM_NR, nt - t);
+                    for (int r = 0; r < nr; r++)
+                    {
+                        const int ty = (t0 + t + r) / tiles_w;
+                        const int tx = (t0 + t + r) % tiles_w;
+                        const int rows = std::min(m, outh - ty * m);
+                        const int cols = std::min(m, outw - tx * m);
+
+                        float* outptr = top_blob.channel(p).row(ty * m) + tx * m;
+                        for (int i = 0; i < rows; i++)
+                        {
+                            for (int j = 0; j < cols; j++)
+                            {
+                                outptr[j] = dptr[(i * m + j) * SGEMM_NR + r] + bias;
+                            }
+                            activation_inplace(outptr, cols, ep.activation_type, ep.activation_params);
+                            outptr += outw;
+                        }
+                    }
+                }
+            }
+        });
+    }
+}
+
+} // namespace tinyinfer
+
+#endif // LAYER_CONVOLUTION_3X3_WINOGRAD_H
@@ -0,0 +1,418 @@
+#include "convolution_x86.h"
+
+#include "convolution_3x3_winograd.h"
+#include "sgemm_x86.h"
+
+namespace tinyinfer {
+
+// output channels computed together by the direct 3x3 kernel, all accumulators stay in registers
+#if __AVX512F__
+#define CONV3X3_OCB 8
+#else
+#define CONV3X3_OCB 4
+#endif
+
+Convolution_x86::Convolution_x86()
+{
+}
+
+int Convolution_x86::create_pipeline(const Option& opt)
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    // im2col + sgemm wins once stride 2 halves the reuse of every input load, except on the narrow stem layers
+    use_direct_3x3 = kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == stride_h
+                     && (stride_w == 1 || (stride_w == 2 && num_input <= 16));
+
+    if (use_direct_3x3)
+    {
+        const int blocks = (num_output + CONV3X3_OCB - 1) / CONV3X3_OCB;
+
+        weight_3x3_packed.create(blocks * num_input * 9 * CONV3X3_OCB, 4u, opt.workspace_allocator);
+        if (weight_3x3_packed.empty())
+            return -100;
+
+        for (int b = 0; b < blocks; b++)
+        {
+            float* kptr = (float*)weight_3x3_packed + (size_t)b * num_input * 9 * CONV3X3_OCB;
+
+            for (int q = 0; q < num_input; q++)
+            {
+                for (int k = 0; k < 9; k++)
+                {
+                    for (int i = 0; i < CONV3X3_OCB; i++)
+                    {
+                        const int p = b * CONV3X3_OCB + i;
+                        kptr[i] = p < num_output ? weight_data[((size_t)p * num_input + q) * 9 + k] : 0.f;
+                    }
+                    kptr += CONV3X3_OCB;
+                }
+            }
+        }
+    }
+
+    // the transforms only pay off once there are enough channels to share them
+    winograd_tile = 0;
+    if (use_direct_3x3 && stride_w == 1 && opt.use_winograd_convolution && num_input >= 8 && num_output >= 8)
+    {
+        winograd_tile = opt.use_winograd63_convolution ? 8 : 6;
+
+        int ret = conv3x3s1_winograd_transform_kernel(weight_data, weight_winograd_packed, num_input, num_output, winograd_tile, opt);
+        if (ret != 0)
+            return ret;
+    }
+    else
+    {
+        const int K = num_input * maxk;
+        int ret = sgemm_pack_A(weight_data, K, 0, num_output, K, weight_sgemm_packed, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int Convolution_x86::destroy_pipeline(const Option& /*opt*/)
+{
+    weight_3x3_packed.release();
+    weight_winograd_packed.release();
+    weight_sgemm_packed.release();
+    return 0;
+}
+
+template<int stride>
+static inline sgemm_vec conv_load(const float* ptr)
+{
+    return stride == 1 ? sgemm_load(ptr) : sgemm_load_s2(ptr);
+}
+
+// CONV3X3_OCB output channels over one span of n outputs, output j reads input j * stride + ky * w + kx
+// two vectors of outputs per step share every input load across the output channels
+// the last partial step is computed in full, the caller keeps 2 * SGEMM_VL * stride readable floats past the span
+template<int stride>
+static void conv3x3_direct_span(const Mat& bottom_blob_bordered, int in_offset, const float* kptr, int num_input, float* const outptrs[CONV3X3_OCB], int out_offset, int n)
+{
+    const int w = bottom_blob_bordered.w;
+
+    for (int j = 0; j < n; j += SGEMM_VL * 2)
+    {
+        sgemm_vec _sum[CONV3X3_OCB][2];
+        for (int i = 0; i < CONV3X3_OCB; i++)
+        {
+            _sum[i][0] = sgemm_set1(0.f);
+            _sum[i][1] = sgemm_set1(0.f);
+        }
+
+        const float* k0 = kptr;
+        for (int q = 0; q < num_input; q++)
+        {
+            const float* r0 = (const float*)bottom_blob_bordered.channel(q) + in_offset + j * stride;
+
+            for (int ky = 0; ky < 3; ky++)
+            {
+                for (int kx = 0; kx < 3; kx++)
+                {
+                    const float* sptr = r0 + ky * w + kx;
+                    sgemm_vec _v0 = conv_load<stride>(sptr);
+                    sgemm_vec _v1 = conv_load<stride>(sptr + SGEMM_VL * stride);
+
+                    for (int i = 0; i < CONV3X3_OCB; i++)
+                    {
+                        sgemm_vec _k = sgemm_set1(k0[i]);
+                        _sum[i][0] = sgemm_fmadd(_k, _v0, _sum[i][0]);
+                        _sum[i][1] = sgemm_fmadd(_k, _v1, _sum[i][1]);
+                    }
+
+                    k0 += CONV3X3_OCB;
+                }
+            }
+        }
+
+        if (j + SGEMM_VL * 2 <= n)
+        {
+            for (int i = 0; i < CONV3X3_OCB; i++)
+            {
+                sgemm_store(outptrs[i] + out_offset + j, _sum[i][0]);
+                sgemm_store(outptrs[i] + out_offset + j + SGEMM_VL, _sum[i][1]);
+            }
+        }
+        else
+        {
+            float tmp[SGEMM_VL * 2];
+            for (int i = 0; i < CONV3X3_OCB; i++)
+            {
+                sgemm_store(tmp, _sum[i][0]);
+                sgemm_store(tmp + SGEMM_VL, _sum[i][1]);
+                for (int jj = 0; jj < n - j; jj++)
+                {
+                    outptrs[i][out_offset + j + jj] = tmp[jj];
+                }
+            }
+        }
+    }
+}
+
+int Convolution_x86::forward_winograd_3x3(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int m = winograd_tile - 2;
+
+    int pad_l, pad_r, pad_t, pad_b;
+    resolve_padding(bottom_blob.w, bottom_blob.h, pad_l, pad_r, pad_t, pad_b);
+
+    const int w = bottom_blob.w + pad_l + pad_r;
+    const int h = bottom_blob.h + pad_t + pad_b;
+    const int outw = w - 2;
+    const int outh = h - 2;
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    // whole tiles on the right and bottom edge
+    const int tiles_w = (outw + m - 1) / m;
+    const int tiles_h = (outh + m - 1) / m;
+
+    Mat bottom_blob_bordered;
+    int ret = make_padding(bottom_blob, bottom_blob_bordered, tiles_w * m + 2 - w, tiles_h * m + 2 - h, opt);
+    if (ret != 0)
+        return ret;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    sgemm_epilogue ep = sgemm_epilogue_default();
+    ep.activation_type = activation_type;
+    ep.activation_params = activation_params;
+
+    conv3x3s1_winograd(bottom_blob_bordered, top_blob, weight_winograd_packed, bias_data, winograd_tile, ep, opt);
+
+    return 0;
+}
+
+int Convolution_x86::forward_direct_3x3(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = bottom_blob.c;
+
+    const int stride = stride_w;
+
+    // zero rows below the border keep the full vector steps past the last output inside the blob
+    int pad_l, pad_r, pad_t, pad_b;
+    resolve_padding(bottom_blob.w, bottom_blob.h, pad_l, pad_r, pad_t, pad_b);
+    const int extra_h = (SGEMM_VL * 2 * stride + 2) / (bottom_blob.w + pad_l + pad_r) + 2;
+
+    Mat bottom_blob_bordered;
+    int ret = make_padding(bottom_blob, bottom_blob_bordered, 0, extra_h, opt);
+    if (ret != 0)
+        return ret;
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h - extra_h;
+
+    const int outw = (w - 3) / stride + 1;
+    const int outh = (h - 3) / stride + 1;
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // stride 1 runs over all rows as one span as wide as the input, the 2 columns past outw are dropped later
+    // stride 2 runs row by row straight into the output
+    const int blocks = (num_output + CONV3X3_OCB - 1) / CONV3X3_OCB;
+    const int wide_w = stride == 1 ? w : outw;
+
+    Mat top_blob_wide;
+    top_blob_wide.create(wide_w * outh, 1, blocks * CONV3X3_OCB, 4u, opt.workspace_allocator);
+    if (top_blob_wide.empty())
+        return -100;
+
+    const float* activation_ptr = activation_params;
+
+    parallel_for(opt, 0, blocks, 1, [&](int b0, int b1) {
+        for (int b = b0; b < b1; b++)
+        {
+            const float* kptr = (const float*)weight_3x3_packed + (size_t)b * num_input * 9 * CONV3X3_OCB;
+
+            float* outptrs[CONV3X3_OCB];
+            for (int i = 0; i < CONV3X3_OCB; i++)
+            {
+                outptrs[i] = top_blob_wide.channel(b * CONV3X3_OCB + i);
+            }
+
+            if (stride == 1)
+            {
+                conv3x3_direct_span<1>(bottom_blob_bordered, 0, kptr, num_input, outptrs, 0, outh * w);
+            }
+            else
+            {
+                for (int y = 0; y < outh; y++)
+                {
+                    conv3x3_direct_span<2>(bottom_blob_bordered, y * 2 * w, kptr, num_input, outptrs, y * outw, outw);
+                }
+            }
+
+            for (int i = 0; i < CONV3X3_OCB; i++)
+            {
+                const int p = b * CONV3X3_OCB + i;
+                if (p >= num_output)
+                    break;
+
+                const float bias = bias_term ? bias_data[p] : 0.f;
+
+                float* outptr = top_blob.channel(p);
+                for (int y = 0; y < outh; y++)
+                {
+                    const float* ptr = outptrs[i] + (size_t)wide_w * y;
+                    for (int x = 0; x < outw; x++)
+                    {
+                        outptr[x] = ptr[x] + bias;
+                    }
+                    activation_inplace(outptr, outw, activation_type, activation_ptr);
+                    outptr += outw;
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+int Convolution_x86::forward_sgemm(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = bottom_blob.c;
+    const int maxk = kernel_w * kernel_h;
+
+    Mat bottom_blob_bordered;
+    int ret = make_padding(bottom_blob, bottom_blob_bordered, 0, 0, opt);
+    if (ret != 0)
+        return ret;
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+    const int outh = (h - kernel_extent_h) / stride_h + 1;
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int M = num_output;
+    const int N = outw * outh;
+    const int K = num_input * maxk;
+
+    sgemm_epilogue ep = sgemm_epilogue_default();
+    if (bias_term)
+    {
+        ep.bias_type = 2;
+        ep.bias = bias_data;
+    }
+    ep.activation_type = activation_type;
+    ep.activation_params = activation_params;
+
+    // 1x1 stride 1 is already a gemm over the channel major input, row k of B is input channel k
+    if (maxk == 1 && stride_w == 1 && stride_h == 1)
+    {
+        return sgemm_packed_A(M, N, K, weight_sgemm_packed, bottom_blob_bordered, (int)bottom_blob_bordered.cstep, 0, top_blob, (int)top_blob.cstep, ep, opt);
+    }
+
+    // im2col over column blocks sized to stay in l2, row q * maxk + k of B holds kernel tap k of input channel q
+    const int nb = std::max(std::min((256 * 1024 / K + SGEMM_NR - 1) / SGEMM_NR * SGEMM_NR, N), 1);
+
+    Mat bottom_im2col;
+    bottom_im2col.create(nb, K, 4u, opt.workspace_allocator);
+    if (bottom_im2col.empty())
+        return -100;
+
+    for (int n0 = 0; n0 < N; n0 += nb)
+    {
+        const int n = std::min(nb, N - n0);
+
+        parallel_for(opt, 0, num_input, 1, [&](int q0, int q1) {
+            for (int q = q0; q < q1; q++)
+            {
+                const Mat img = bottom_blob_bordered.channel(q);
+
+                for (int ky = 0; ky < kernel_h; ky++)
+                {
+                    for (int kx = 0; kx < kernel_w; kx++)
+                    {
+                        float* ptr = bottom_im2col.row(q * maxk + ky * kernel_w + kx);
+
+                        int y = n0 / outw;
+                        int x = n0 % outw;
+                        for (int j = 0; j < n;)
+                        {
+                            const float* sptr = img.row(y * stride_h + ky * dilation_h) + kx * dilation_w;
+                            const int run = std::min(outw - x, n - j);
+
+                            if (stride_w == 1)
+                            {
+                                memcpy(ptr + j, sptr + x, run * sizeof(float));
+                            }
+                            else
+                            {
+                                for (int i = 0; i < run; i++)
+                                {
+                                    ptr[j + i] = sptr[(x + i) * stride_w];
+                                }
+                            }
+
+                            j += run;
+                            x = 0;
+                            y++;
+                        }
+                    }
+                }
+            }
+        });
+
+        ret = sgemm_packed_A(M, n, K, weight_sgemm_packed, bottom_im2col, nb, 0, (float*)top_blob + n0, (int)top_blob.cstep, ep, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    if (bottom_blob.dims != 3 || bottom_blob.c != num_input)
+        return -1;
+
+    if (winograd_tile)
+    {
+        // small maps spend most of the tiles on padding, the direct kernel is faster there
+        int pad_l, pad_r, pad_t, pad_b;
+        resolve_padding(bottom_blob.w, bottom_blob.h, pad_l, pad_r, pad_t, pad_b);
+
+        const int m = winograd_tile - 2;
+        const int outw = bottom_blob.w + pad_l + pad_r - 2;
+        const int outh = bottom_blob.h + pad_t + pad_b - 2;
+        const int tiled_area = (outw + m - 1) / m * m * ((outh + m - 1) / m * m);
+
+        if (outw >= m && outh >= m && tiled_area * 2 <= outw * outh * 3)
+            return forward_winograd_3x3(bottom_blob, top_blob, opt);
+    }
+
+    if (use_direct_3x3)
+        return forward_direct_3x3(bottom_blob, top_blob, opt);
+
+    return forward_sgemm(bottom_blob, top_blob, opt);
+}
+
+DEFINE_LAYER_CREATOR(Convolution_x86)
+
+} // namespace tinyinfer
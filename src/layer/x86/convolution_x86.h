@@ -0,0 +1,39 @@
+#ifndef LAYER_CONVOLUTION_X86_H
+#define LAYER_CONVOLUTION_X86_H
+
+#include "convolution.h"
+
+namespace tinyinfer {
+
+class Convolution_x86 : public Convolution
+{
+public:
+    Convolution_x86();
+
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+protected:
+    int forward_winograd_3x3(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_direct_3x3(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_sgemm(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // 3x3 stride 1 or 2, weight as [num_output / block][num_input][9][block]
+    bool use_direct_3x3;
+    Mat weight_3x3_packed;
+
+    // 3x3 stride 1 with enough channels, 8 = F(6,3) 6 = F(4,3) 0 = off
+    // weight as G g G^T packed per tile position, the direct kernel stays as fallback for small maps
+    int winograd_tile;
+    Mat weight_winograd_packed;
+
+    // everything else, weight packed as the A operand of num_output x (num_input * maxk)
+    Mat weight_sgemm_packed;
+};
+
+} // namespace tinyinfer
+
+#endif
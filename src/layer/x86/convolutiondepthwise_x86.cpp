@@ -0,0 +1,330 @@
+#include "convolutiondepthwise_x86.h"
+
+#include "sgemm_x86.h"
+
+#include <atomic>
+#include <vector>
+
+namespace tinyinfer {
+
+ConvolutionDepthWise_x86::ConvolutionDepthWise_x86()
+{
+}
+
+int ConvolutionDepthWise_x86::create_pipeline(const Option& opt)
+{
+    const int maxk = kernel_w * kernel_h;
+
+    use_depthwise = group == num_output && weight_data_size == num_output * maxk;
+    if (!use_depthwise)
+        return 0;
+
+    // [channel block][k][SGEMM_VL], zero for the channels past num_output
+    const int blocks = (num_output + SGEMM_VL - 1) / SGEMM_VL;
+
+    weight_data_packed.create(blocks * maxk * SGEMM_VL, 4u, opt.workspace_allocator);
+    if (weight_data_packed.empty())
+        return -100;
+
+    for (int b = 0; b < blocks; b++)
+    {
+        float* kptr = (float*)weight_data_packed + (size_t)b * maxk * SGEMM_VL;
+
+        for (int k = 0; k < maxk; k++)
+        {
+            for (int i = 0; i < SGEMM_VL; i++)
+            {
+                const int p = b * SGEMM_VL + i;
+                kptr[i] = p < num_output ? weight_data[p * maxk + k] : 0.f;
+            }
+            kptr += SGEMM_VL;
+        }
+    }
+
+    return 0;
+}
+
+int ConvolutionDepthWise_x86::destroy_pipeline(const Option& /*opt*/)
+{
+    weight_data_packed.release();
+    return 0;
+}
+
+// input rows [y0, y1) of the bordered map for channels c0 .. c0 + SGEMM_VL, laid out as [y - y0][pw][SGEMM_VL]
+// the border is written here, so no padded copy of the whole blob is made
+static void convdw_pack_rows(const Mat& bottom_blob, int c0, int y0, int y1, int pad_l, int pad_t, int pw, float pad_value, float* plane)
+{
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+
+    const sgemm_vec _pad = sgemm_set1(pad_value);
+    const sgemm_vec _zero = sgemm_set1(0.f);
+
+    // border rows and the left and right border of every input row
+    for (int y = y0; y < y1; y++)
+    {
+        float* pp = plane + (size_t)(y - y0) * pw * SGEMM_VL;
+
+        const int iy = y - pad_t;
+        const bool border_row = iy < 0 || iy >= h;
+        for (int x = 0; x < pw; x++)
+        {
+            if (border_row || x < pad_l || x >= pad_l + w)
+                sgemm_store(pp + x * SGEMM_VL, _pad);
+        }
+    }
+
+    const int iy0 = std::max(y0 - pad_t, 0);
+    const int iy1 = std::min(y1 - pad_t, h);
+    if (iy0 >= iy1)
+        return;
+
+    // the input rows are contiguous in every channel, so whole vectors are transposed across row ends too
+    // and narrow maps do not fall back to scalar copies
+    const float* ptrs[SGEMM_VL];
+    for (int i = 0; i < SGEMM_VL; i++)
+    {
+        ptrs[i] = c0 + i < bottom_blob.c ? (const float*)bottom_blob.channel(c0 + i) + (size_t)iy0 * w : 0;
+    }
+
+    const int n = (iy1 - iy0) * w;
+
+    float* dst = plane + ((size_t)(iy0 + pad_t - y0) * pw + pad_l) * SGEMM_VL;
+    int x = 0;
+
+    int j = 0;
+    for (; j + SGEMM_VL <= n; j += SGEMM_VL)
+    {
+        sgemm_vec _r[SGEMM_VL];
+        for (int i = 0; i < SGEMM_VL; i++)
+        {
+            _r[i] = ptrs[i] ? sgemm_load(ptrs[i] + j) : _zero;
+        }
+
+        sgemm_transpose(_r);
+
+        for (int i = 0; i < SGEMM_VL; i++)
+        {
+            sgemm_store(dst + x * SGEMM_VL, _r[i]);
+            if (++x == w)
+            {
+                x = 0;
+                dst += pw * SGEMM_VL;
+            }
+        }
+    }
+    for (; j < n; j++)
+    {
+        for (int i = 0; i < SGEMM_VL; i++)
+        {
+            dst[x * SGEMM_VL + i] = ptrs[i] ? ptrs[i][j] : 0.f;
+        }
+        if (++x == w)
+        {
+            x = 0;
+            dst += pw * SGEMM_VL;
+        }
+    }
+}
+
+// n packed outputs back into the planes of channels c0 .. c0 + SGEMM_VL from offset p0 on
+static void convdw_unpack(const float* outp, int n, Mat& top_blob, int c0, size_t p0)
+{
+    float* ptrs[SGEMM_VL];
+    for (int i = 0; i < SGEMM_VL; i++)
+    {
+        ptrs[i] = c0 + i < top_blob.c ? (float*)top_blob.channel(c0 + i) + p0 : 0;
+    }
+
+    int j = 0;
+    for (; j + SGEMM_VL <= n; j += SGEMM_VL)
+    {
+        sgemm_vec _r[SGEMM_VL];
+        for (int i = 0; i < SGEMM_VL; i++)
+        {
+            _r[i] = sgemm_load(outp + (j + i) * SGEMM_VL);
+        }
+
+        sgemm_transpose(_r);
+
+        for (int i = 0; i < SGEMM_VL; i++)
+        {
+            if (ptrs[i])
+                sgemm_store(ptrs[i] + j, _r[i]);
+        }
+    }
+    for (; j < n; j++)
+    {
+        for (int i = 0; i < SGEMM_VL; i++)
+        {
+            if (ptrs[i])
+                ptrs[i][j] = outp[j * SGEMM_VL + i];
+        }
+    }
+}
+
+// rows x outw packed outputs of one channel block, row y reads plane row y * stride_h on
+// K = 3 or 5 unrolls the taps of a square undilated kernel and keeps them in registers, K = 0 walks space_ofs
+// four neighbouring outputs share every weight load and keep four independent fmadd chains
+template<int K>
+static void convdw_packed(const float* plane, int pw, const int* space_ofs, int maxk, int stride_w, int stride_h, const float* kptr, const float* biasptr, float* outptr, int outw, int rows)
+{
+    const int nk = K ? K * K : maxk;
+
+    sgemm_vec _k[K ? K * K : 1];
+    for (int k = 0; k < (K ? K * K : 0); k++)
+    {
+        _k[k] = sgemm_load(kptr + k * SGEMM_VL);
+    }
+
+    const sgemm_vec _bias = sgemm_load(biasptr);
+    const int sx = stride_w * SGEMM_VL;
+
+    for (int y = 0; y < rows; y++)
+    {
+        const float* r0 = plane + (size_t)y * stride_h * pw * SGEMM_VL;
+
+        int x = 0;
+        for (; x + 3 < outw; x += 4)
+        {
+            const float* sptr = r0 + x * sx;
+
+            sgemm_vec _sum0 = _bias;
+            sgemm_vec _sum1 = _bias;
+            sgemm_vec _sum2 = _bias;
+            sgemm_vec _sum3 = _bias;
+            for (int k = 0; k < nk; k++)
+            {
+                const int ofs = K ? (k / K * pw + k % K) : space_ofs[k];
+                const sgemm_vec _w = K ? _k[k] : sgemm_load(kptr + k * SGEMM_VL);
+                const float* sp = sptr + ofs * SGEMM_VL;
+                _sum0 = sgemm_fmadd(sgemm_load(sp), _w, _sum0);
+                _sum1 = sgemm_fmadd(sgemm_load(sp + sx), _w, _sum1);
+                _sum2 = sgemm_fmadd(sgemm_load(sp + sx * 2), _w, _sum2);
+                _sum3 = sgemm_fmadd(sgemm_load(sp + sx * 3), _w, _sum3);
+            }
+
+            sgemm_store(outptr, _sum0);
+            sgemm_store(outptr + SGEMM_VL, _sum1);
+            sgemm_store(outptr + SGEMM_VL * 2, _sum2);
+            sgemm_store(outptr + SGEMM_VL * 3, _sum3);
+            outptr += SGEMM_VL * 4;
+        }
+        for (; x < outw; x++)
+        {
+            const float* sptr = r0 + x * sx;
+
+            sgemm_vec _sum = _bias;
+            for (int k = 0; k < nk; k++)
+            {
+                const int ofs = K ? (k / K * pw + k % K) : space_ofs[k];
+                const sgemm_vec _w = K ? _k[k] : sgemm_load(kptr + k * SGEMM_VL);
+                _sum = sgemm_fmadd(sgemm_load(sptr + ofs * SGEMM_VL), _w, _sum);
+            }
+
+            sgemm_store(outptr, _sum);
+            outptr += SGEMM_VL;
+        }
+    }
+}
+
+int ConvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    if (!use_depthwise)
+        return ConvolutionDepthWise::forward(bottom_blob, top_blob, opt);
+
+    const int channels = num_output;
+    const int maxk = kernel_w * kernel_h;
+
+    if (bottom_blob.dims != 3 || bottom_blob.c != channels)
+        return -1;
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+
+    int pad_l, pad_r, pad_t, pad_b;
+    resolve_padding(w, h, pad_l, pad_r, pad_t, pad_b);
+
+    const int pw = w + pad_l + pad_r;
+    const int ph = h + pad_t + pad_b;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int outw = (pw - kernel_extent_w) / stride_w + 1;
+    const int outh = (ph - kernel_extent_h) / stride_h + 1;
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, channels, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int kernel = kernel_w == kernel_h && dilation_w == 1 && dilation_h == 1 && (kernel_w == 3 || kernel_w == 5) ? kernel_w : 0;
+
+    // offset of every kernel tap in pixels of the packed plane
+    std::vector<int> space_ofs(maxk);
+    for (int i = 0; i < kernel_h; i++)
+    {
+        for (int j = 0; j < kernel_w; j++)
+        {
+            space_ofs[i * kernel_w + j] = i * dilation_h * pw + j * dilation_w;
+        }
+    }
+
+    // a strip of output rows and the input rows it reads stay around 256KB, strips of every channel block are the work items
+    const int blocks = (channels + SGEMM_VL - 1) / SGEMM_VL;
+    const int strip = std::min(outh, std::max(1, 64 * 1024 / SGEMM_VL / (stride_h * pw + outw)));
+    const int strips = (outh + strip - 1) / strip;
+    const int plane_rows = (strip - 1) * stride_h + kernel_extent_h;
+
+    const float* activation_ptr = activation_params;
+
+    std::atomic<bool> alloc_failed(false);
+
+    parallel_for(opt, 0, blocks * strips, 1, [&](int i0, int i1) {
+        Mat plane(plane_rows * pw * SGEMM_VL, 4u, opt.workspace_allocator);
+        Mat outp(strip * outw * SGEMM_VL, 4u, opt.workspace_allocator);
+        if (plane.empty() || outp.empty())
+        {
+            alloc_failed = true;
+            return;
+        }
+
+        for (int i = i0; i < i1; i++)
+        {
+            const int b = i / strips;
+            const int c0 = b * SGEMM_VL;
+            const int oy0 = i % strips * strip;
+            const int rows = std::min(strip, outh - oy0);
+
+            convdw_pack_rows(bottom_blob, c0, oy0 * stride_h, (oy0 + rows - 1) * stride_h + kernel_extent_h, pad_l, pad_t, pw, pad_value, plane);
+
+            float bias[SGEMM_VL];
+            for (int j = 0; j < SGEMM_VL; j++)
+            {
+                bias[j] = bias_term && c0 + j < channels ? bias_data[c0 + j] : 0.f;
+            }
+
+            const float* kptr = (const float*)weight_data_packed + (size_t)b * maxk * SGEMM_VL;
+
+            if (kernel == 3)
+                convdw_packed<3>(plane, pw, space_ofs.data(), maxk, stride_w, stride_h, kptr, bias, outp, outw, rows);
+            else if (kernel == 5)
+                convdw_packed<5>(plane, pw, space_ofs.data(), maxk, stride_w, stride_h, kptr, bias, outp, outw, rows);
+            else
+                convdw_packed<0>(plane, pw, space_ofs.data(), maxk, stride_w, stride_h, kptr, bias, outp, outw, rows);
+
+            // elementwise, so it runs on the packed outputs before they are scattered
+            activation_inplace(outp, rows * outw * SGEMM_VL, activation_type, activation_ptr);
+
+            convdw_unpack(outp, rows * outw, top_blob, c0, (size_t)oy0 * outw);
+        }
+    });
+
+    return alloc_failed ? -100 : 0;
+}
+
+DEFINE_LAYER_CREATOR(ConvolutionDepthWise_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,29 @@
+#ifndef LAYER_CONVOLUTIONDEPTHWISE_X86_H
+#define LAYER_CONVOLUTIONDEPTHWISE_X86_H
+
+#include "convolutiondepthwise.h"
+
+namespace tinyinfer {
+
+class ConvolutionDepthWise_x86 : public ConvolutionDepthWise
+{
+public:
+    ConvolutionDepthWise_x86();
+
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // group == num_input == num_output, other groupings run the naive layer
+    // channels are processed in blocks of one vector, pack4 on sse2, pack8 on avx2 and pack16 on avx512
+    bool use_depthwise;
+
+    // weight as [num_output / vector size][kernel_h * kernel_w][vector size]
+    Mat weight_data_packed;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,415 @@
+#include "deconvolution_x86.h"
+
+#include "fused_activation.h"
+#include "sgemm_x86.h"
+
+#include <string.h>
+
+namespace tinyinfer {
+
+// a / b rounded towards negative infinity, the output window may start before the full output
+static inline int deconv_floor_div(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// taps of a kernel_size kernel that land on output phase r, taps r, r + stride, r + 2 * stride ...
+static inline int deconv_phase_taps(int kernel_size, int stride, int r)
+{
+    return kernel_size > r ? (kernel_size - r + stride - 1) / stride : 0;
+}
+
+// [i0, i1) of the full output positions i * stride + r inside the output window [crop, crop + size)
+static inline void deconv_phase_range(int crop, int size, int stride, int r, int& i0, int& i1)
+{
+    i0 = deconv_floor_div(crop - r + stride - 1, stride);
+    i1 = deconv_floor_div(crop + size - 1 - r, stride) + 1;
+    if (i1 < i0)
+        i1 = i0;
+}
+
+DeConvolution_x86::DeConvolution_x86()
+{
+}
+
+int DeConvolution_x86::create_pipeline(const Option& opt)
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    // both paths do the same multiplies, the sub-pixel one gathers num_input * maxk floats per input pixel
+    // where col2im scatters num_output * maxk, so it only wins on layers that widen the channels
+    use_subpixel = stride_w == 2 && stride_h == 2 && dilation_w == 1 && dilation_h == 1 && num_output > num_input;
+
+    if (use_subpixel)
+    {
+        weight_subpixel_packed.resize(stride_h * stride_w);
+
+        for (int ry = 0; ry < stride_h; ry++)
+        {
+            for (int rx = 0; rx < stride_w; rx++)
+            {
+                const int taps_h = deconv_phase_taps(kernel_h, stride_h, ry);
+                const int taps_w = deconv_phase_taps(kernel_w, stride_w, rx);
+                const int K = num_input * taps_h * taps_w;
+                if (K == 0)
+                    continue;
+
+                // row p, column (q * taps_h + t) * taps_w + u holds tap (ry + t * stride_h, rx + u * stride_w)
+                Mat weight_phase;
+                weight_phase.create(K * num_output, 4u, opt.workspace_allocator);
+                if (weight_phase.empty())
+                    return -100;
+
+                float* ptr = weight_phase;
+                for (int p = 0; p < num_output; p++)
+                {
+                    for (int q = 0; q < num_input; q++)
+                    {
+                        const float* kptr = (const float*)weight_data + ((size_t)p * num_input + q) * maxk;
+
+                        for (int t = 0; t < taps_h; t++)
+                        {
+                            for (int u = 0; u < taps_w; u++)
+                            {
+                                *ptr++ = kptr[(ry + t * stride_h) * kernel_w + rx + u * stride_w];
+                            }
+                        }
+                    }
+                }
+
+                int ret = sgemm_pack_A(weight_phase, K, 0, num_output, K, weight_subpixel_packed[ry * stride_w + rx], opt);
+                if (ret != 0)
+                    return ret;
+            }
+        }
+    }
+    else
+    {
+        // row p * maxk + k, column q holds tap k of input channel q
+        const int M = num_output * maxk;
+
+        Mat weight_t;
+        weight_t.create(M * num_input, 4u, opt.workspace_allocator);
+        if (weight_t.empty())
+            return -100;
+
+        for (int p = 0; p < num_output; p++)
+        {
+            for (int q = 0; q < num_input; q++)
+            {
+                const float* kptr = (const float*)weight_data + ((size_t)p * num_input + q) * maxk;
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    weight_t[((size_t)p * maxk + k) * num_input + q] = kptr[k];
+                }
+            }
+        }
+
+        int ret = sgemm_pack_A(weight_t, num_input, 0, M, num_input, weight_col2im_packed, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int DeConvolution_x86::destroy_pipeline(const Option& /*opt*/)
+{
+    weight_subpixel_packed.clear();
+    weight_col2im_packed.release();
+    return 0;
+}
+
+int DeConvolution_x86::forward_subpixel(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int num_input = bottom_blob.c;
+
+    int outw, outh, crop_l, crop_t;
+    resolve_output(w, h, outw, outh, crop_l, crop_t);
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const float* activation_ptr = activation_params;
+
+    sgemm_epilogue ep = sgemm_epilogue_default();
+    if (bias_term)
+    {
+        ep.bias_type = 2;
+        ep.bias = bias_data;
+    }
+    ep.activation_type = activation_type;
+    ep.activation_params = activation_params;
+
+    for (int ry = 0; ry < stride_h; ry++)
+    {
+        for (int rx = 0; rx < stride_w; rx++)
+        {
+            // full output position (a * stride_h + ry, b * stride_w + rx) takes tap (ry + t * stride_h, rx + u * stride_w)
+            // from input pixel (a - t, b - u), output padding and the crop only move the range of a and b
+            int a0, a1, b0, b1;
+            deconv_phase_range(crop_t, outh, stride_h, ry, a0, a1);
+            deconv_phase_range(crop_l, outw, stride_w, rx, b0, b1);
+
+            const int phase_w = b1 - b0;
+            const int N = (a1 - a0) * phase_w;
+            if (N == 0)
+                continue;
+
+            const int oy0 = a0 * stride_h + ry - crop_t;
+            const int ox0 = b0 * stride_w + rx - crop_l;
+
+            const int taps_h = deconv_phase_taps(kernel_h, stride_h, ry);
+            const int taps_w = deconv_phase_taps(kernel_w, stride_w, rx);
+            const int K = num_input * taps_h * taps_w;
+
+            if (K == 0)
+            {
+                // a kernel narrower than the stride leaves this phase with the bias only
+                parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+                    for (int p = p0; p < p1; p++)
+                    {
+                        const float v = activation_ss(bias_term ? bias_data[p] : 0.f, activation_type, activation_ptr);
+                        Mat out = top_blob.channel(p);
+
+                        for (int a = a0; a < a1; a++)
+                        {
+                            float* outptr = out.row(oy0 + (a - a0) * stride_h) + ox0;
+                            for (int b = 0; b < phase_w; b++)
+                            {
+                                outptr[b * stride_w] = v;
+                            }
+                        }
+                    }
+                });
+                continue;
+            }
+
+            // im2col over column blocks sized to stay in l2, the gemm result is interleaved into the output afterwards
+            const int nb = std::max(std::min((256 * 1024 / K + SGEMM_NR - 1) / SGEMM_NR * SGEMM_NR, N), 1);
+
+            Mat bottom_im2col;
+            bottom_im2col.create(nb, K, 4u, opt.workspace_allocator);
+            if (bottom_im2col.empty())
+                return -100;
+
+            Mat top_phase;
+            top_phase.create(nb, num_output, 4u, opt.workspace_allocator);
+            if (top_phase.empty())
+                return -100;
+
+            for (int n0 = 0; n0 < N; n0 += nb)
+            {
+                const int n = std::min(nb, N - n0);
+
+                parallel_for(opt, 0, num_input, 1, [&](int q0, int q1) {
+                    for (int q = q0; q < q1; q++)
+                    {
+                        const Mat img = bottom_blob.channel(q);
+
+                        for (int t = 0; t < taps_h; t++)
+                        {
+                            for (int u = 0; u < taps_w; u++)
+                            {
+                                float* ptr = bottom_im2col.row((q * taps_h + t) * taps_w + u);
+
+                                int a = a0 + n0 / phase_w;
+                                int b = b0 + n0 % phase_w;
+                                for (int j = 0; j < n;)
+                                {
+                                    const int run = std::min(b1 - b, n - j);
+                                    const int sy = a - t;
+                                    const int sx = b - u;
+
+                                    // input columns [sx, sx + run) clipped to the image, zeros outside
+                                    const int left = sy < 0 || sy >= h ? run : std::min(std::max(-sx, 0), run);
+                                    const int right = std::max(std::min(run, w - sx), left);
+
+                                    for (int i = 0; i < left; i++)
+                                        ptr[j + i] = 0.f;
+                                    if (right > left)
+                                        memcpy(ptr + j + left, img.row(sy) + sx + left, (right - left) * sizeof(float));
+                                    for (int i = right; i < run; i++)
+                                        ptr[j + i] = 0.f;
+
+                                    j += run;
+                                    b = b0;
+                                    a++;
+                                }
+                            }
+                        }
+                    }
+                });
+
+                int ret = sgemm_packed_A(num_output, n, K, weight_subpixel_packed[ry * stride_w + rx], bottom_im2col, nb, 0, top_phase, nb, ep, opt);
+                if (ret != 0)
+                    return ret;
+
+                parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+                    for (int p = p0; p < p1; p++)
+                    {
+                        const float* ptr = top_phase.row(p);
+                        Mat out = top_blob.channel(p);
+
+                        int a = n0 / phase_w;
+                        int b = n0 % phase_w;
+                        for (int j = 0; j < n;)
+                        {
+                            const int run = std::min(phase_w - b, n - j);
+
+                            float* outptr = out.row(oy0 + a * stride_h) + ox0 + b * stride_w;
+                            for (int i = 0; i < run; i++)
+                            {
+                                outptr[i * stride_w] = ptr[j + i];
+                            }
+
+                            j += run;
+                            b = 0;
+                            a++;
+                        }
+                    }
+                });
+            }
+        }
+    }
+
+    return 0;
+}
+
+int DeConvolution_x86::forward_col2im(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int num_input = bottom_blob.c;
+    const int maxk = kernel_w * kernel_h;
+
+    int outw, outh, crop_l, crop_t;
+    resolve_output(w, h, outw, outh, crop_l, crop_t);
+    if (outw <= 0 || outh <= 0)
+        return -1;
+
+    top_blob.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // the taps are accumulated on top of the bias
+    parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+        for (int p = p0; p < p1; p++)
+        {
+            top_blob.channel(p).fill(bias_term ? bias_data[p] : 0.f);
+        }
+    });
+
+    const int M = num_output * maxk;
+    const int N = w * h;
+    const int K = num_input;
+
+    // gemm over column blocks of input pixels sized to stay in l2, row p * maxk + k of the block holds
+    // what tap k of output channel p receives from every pixel, the scatter skips what falls outside the window
+    const int nb = std::max(std::min((256 * 1024 / M + SGEMM_NR - 1) / SGEMM_NR * SGEMM_NR, N), 1);
+
+    Mat top_col;
+    top_col.create(nb, M, 4u, opt.workspace_allocator);
+    if (top_col.empty())
+        return -100;
+
+    const sgemm_epilogue ep = sgemm_epilogue_default();
+
+    for (int n0 = 0; n0 < N; n0 += nb)
+    {
+        const int n = std::min(nb, N - n0);
+
+        int ret = sgemm_packed_A(M, n, K, weight_col2im_packed, (const float*)bottom_blob + n0, (int)bottom_blob.cstep, 0, top_col, nb, ep, opt);
+        if (ret != 0)
+            return ret;
+
+        const int y_begin = n0 / w;
+        const int y_end = (n0 + n - 1) / w + 1;
+
+        parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+            for (int p = p0; p < p1; p++)
+            {
+                Mat out = top_blob.channel(p);
+
+                for (int ky = 0; ky < kernel_h; ky++)
+                {
+                    // input rows whose tap ky lands inside the output window
+                    const int oy = ky * dilation_h - crop_t;
+                    const int iy0 = std::max(deconv_floor_div(-oy + stride_h - 1, stride_h), y_begin);
+                    const int iy1 = std::min(deconv_floor_div(outh - 1 - oy, stride_h) + 1, y_end);
+
+                    for (int kx = 0; kx < kernel_w; kx++)
+                    {
+                        const int ox = kx * dilation_w - crop_l;
+                        const int ix0 = std::max(deconv_floor_div(-ox + stride_w - 1, stride_w), 0);
+                        const int ix1 = std::min(deconv_floor_div(outw - 1 - ox, stride_w) + 1, w);
+
+                        const float* ptr = top_col.row(p * maxk + ky * kernel_w + kx);
+
+                        for (int iy = iy0; iy < iy1; iy++)
+                        {
+                            const int x0 = std::max(ix0, n0 - iy * w);
+                            const int x1 = std::min(ix1, n0 + n - iy * w);
+
+                            const float* sptr = ptr + iy * w - n0;
+                            float* outptr = out.row(iy * stride_h + oy) + ox;
+
+                            if (stride_w == 1)
+                            {
+                                for (int ix = x0; ix < x1; ix++)
+                                    outptr[ix] += sptr[ix];
+                            }
+                            else
+                            {
+                                for (int ix = x0; ix < x1; ix++)
+                                    outptr[ix * stride_w] += sptr[ix];
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    if (activation_type)
+    {
+        const float* activation_ptr = activation_params;
+
+        parallel_for(opt, 0, num_output, 1, [&](int p0, int p1) {
+            for (int p = p0; p < p1; p++)
+            {
+                activation_inplace(top_blob.channel(p), outw * outh, activation_type, activation_ptr);
+            }
+        });
+    }
+
+    return 0;
+}
+
+int DeConvolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    if (bottom_blob.dims != 3 || bottom_blob.c != num_input)
+        return -1;
+
+    if (use_subpixel)
+        return forward_subpixel(bottom_blob, top_blob, opt);
+
+    return forward_col2im(bottom_blob, top_blob, opt);
+}
+
+DEFINE_LAYER_CREATOR(DeConvolution_x86)
+
+} // namespace tinyinfer
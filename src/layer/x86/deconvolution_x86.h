@@ -0,0 +1,38 @@
+#ifndef LAYER_DECONVOLUTION_X86_H
+#define LAYER_DECONVOLUTION_X86_H
+
+#include "deconvolution.h"
+
+#include <vector>
+
+namespace tinyinfer {
+
+class DeConvolution_x86 : public DeConvolution
+{
+public:
+    DeConvolution_x86();
+
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+protected:
+    int forward_subpixel(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_col2im(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // stride 2 without dilation and more outputs than inputs, the output splits into 2 x 2 phases and every phase
+    // is a plain stride 1 convolution of the input with the taps that land on it, no zero is inserted or multiplied
+    // phase (ry, rx) weight packed as the A operand of num_output x (num_input * taps_h * taps_w)
+    bool use_subpixel;
+    std::vector<Mat> weight_subpixel_packed;
+
+    // everything else, gemm into columns of (num_output * maxk) x pixels then scatter added into the output
+    // weight packed as the A operand of (num_output * maxk) x num_input
+    Mat weight_col2im_packed;
+};
+
+} // namespace tinyinfer
+
+#endif
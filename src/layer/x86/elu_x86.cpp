@@ -0,0 +1,22 @@
+#include "elu_x86.h"
+
+#include "x86_activation.h"
+
+namespace tinyinfer {
+
+ELU_x86::ELU_x86()
+{
+}
+
+int ELU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const sgemm_vec _alpha = sgemm_set1(alpha);
+
+    mathfun_inplace(bottom_top_blob, [&](sgemm_vec _x) { return activation_elu(_x, _alpha); }, opt);
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(ELU_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_ELU_X86_H
+#define LAYER_ELU_X86_H
+
+#include "elu.h"
+
+namespace tinyinfer {
+
+class ELU_x86 : public ELU
+{
+public:
+    ELU_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,33 @@
+#include "gelu_x86.h"
+
+#include "x86_activation.h"
+
+namespace tinyinfer {
+
+GELU_x86::GELU_x86()
+{
+}
+
+int GELU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    if (approximate)
+    {
+        if (opt.use_fast_activation)
+            mathfun_inplace(bottom_top_blob, [](sgemm_vec _x) { return activation_gelu_tanh_fast(_x); }, opt);
+        else
+            mathfun_inplace(bottom_top_blob, [](sgemm_vec _x) { return activation_gelu_tanh(_x); }, opt);
+    }
+    else
+    {
+        if (opt.use_fast_activation)
+            mathfun_inplace(bottom_top_blob, [](sgemm_vec _x) { return activation_gelu_fast(_x); }, opt);
+        else
+            mathfun_inplace(bottom_top_blob, [](sgemm_vec _x) { return activation_gelu(_x); }, opt);
+    }
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(GELU_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_GELU_X86_H
+#define LAYER_GELU_X86_H
+
+#include "gelu.h"
+
+namespace tinyinfer {
+
+class GELU_x86 : public GELU
+{
+public:
+    GELU_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
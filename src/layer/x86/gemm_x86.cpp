@@ -0,0 +1,58 @@
+#include "gemm_x86.h"
+
+#include "sgemm_x86.h"
+
+namespace tinyinfer {
+
+Gemm_x86::Gemm_x86()
+{
+}
+
+int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    GemmOperands g;
+    int ret = resolve_operands(bottom_blobs, g);
+    if (ret != 0)
+        return ret;
+
+    Mat& top_blob = top_blobs[0];
+    ret = create_top_blob(g, top_blob, opt);
+    if (ret != 0)
+        return ret;
+
+    sgemm_epilogue ep = sgemm_epilogue_default();
+    ep.alpha = alpha;
+    ep.beta = beta;
+    ep.bias_type = g.C_type;
+    ep.bias = g.C;
+    ep.ldbias = g.N;
+
+    // a B shared by the whole batch is packed once
+    Mat packedB;
+    if (!g.B_batched)
+    {
+        ret = sgemm_pack_B(g.B, g.ldb, g.transB, g.N, g.K, packedB, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    for (int b = 0; b < g.batch; b++)
+    {
+        const float* ptrA = g.A_batched ? (const float*)g.A.channel(b) : (const float*)g.A;
+        float* outptr = g.out_dims == 3 ? (float*)top_blob.channel(b) : (float*)top_blob;
+
+        if (g.B_batched)
+            ret = sgemm(g.M, g.N, g.K, ptrA, g.lda, g.transA, g.B.channel(b), g.ldb, g.transB, outptr, g.N, ep, opt);
+        else
+            ret = sgemm_packed_B(g.M, g.N, g.K, ptrA, g.lda, g.transA, packedB, outptr, g.N, ep, opt);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Gemm_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_GEMM_X86_H
+#define LAYER_GEMM_X86_H
+
+#include "gemm.h"
+
+namespace tinyinfer {
+
+class Gemm_x86 : public Gemm
+{
+public:
+    Gemm_x86();
+
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
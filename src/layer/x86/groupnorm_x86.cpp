@@ -0,0 +1,118 @@
+#include "groupnorm_x86.h"
+
+#include "normalize_x86.h"
+#include "threadpool.h"
+#include <math.h>
+#include <vector>
+
+namespace tinyinfer {
+
+GroupNorm_x86::GroupNorm_x86()
+{
+}
+
+int GroupNorm_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    int size;
+    if (resolve_channels(bottom_top_blob, size) != 0)
+        return -1;
+
+    const int channels_per_group = channels / group;
+
+    // the channels of a dims 1 or 2 blob follow each other, a group is one run
+    const bool contiguous = bottom_top_blob.dims <= 2;
+
+    // fewer groups than threads, the statistics of every channel go to the threads and merge per group
+    // a GroupNorm of one group over a large feature map would run on a single thread otherwise
+    if (group < opt.num_threads && !contiguous && channels_per_group > 1)
+    {
+        std::vector<normalize_stat> stats(channels);
+
+        parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+            for (int q = q0; q < q1; q++)
+            {
+                normalize_stat_init(stats[q]);
+                normalize_welford(channel_ptr(bottom_top_blob, q, size), size, stats[q]);
+            }
+        });
+
+        std::vector<float> mean(channels);
+        std::vector<float> a(channels);
+        std::vector<float> b(channels);
+        for (int g = 0; g < group; g++)
+        {
+            normalize_stat s;
+            normalize_stat_init(s);
+            for (int q = g * channels_per_group; q < (g + 1) * channels_per_group; q++)
+            {
+                normalize_stat_merge(s, stats[q].n, stats[q].mean, stats[q].m2);
+            }
+
+            const float rstd = (float)(1.0 / sqrt(s.m2 / s.n + eps));
+            for (int q = g * channels_per_group; q < (g + 1) * channels_per_group; q++)
+            {
+                mean[q] = (float)s.mean;
+                a[q] = affine ? rstd * gamma_data[q] : rstd;
+                b[q] = affine ? beta_data[q] : 0.f;
+            }
+        }
+
+        parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+            for (int q = q0; q < q1; q++)
+            {
+                normalize_affine(channel_ptr(bottom_top_blob, q, size), size, mean[q], a[q], b[q]);
+            }
+        });
+
+        return 0;
+    }
+
+    // small groups are batched into tasks of about 16k floats
+    const int group_size = channels_per_group * size;
+    const int grain = group_size < 16384 ? 16384 / group_size : 1;
+
+    parallel_for(opt, 0, group, grain, [&](int g0, int g1) {
+        for (int g = g0; g < g1; g++)
+        {
+            const int qbegin = g * channels_per_group;
+            const int qend = qbegin + channels_per_group;
+
+            normalize_stat s;
+            normalize_stat_init(s);
+            if (contiguous)
+            {
+                normalize_welford(channel_ptr(bottom_top_blob, qbegin, size), group_size, s);
+            }
+            else
+            {
+                for (int q = qbegin; q < qend; q++)
+                {
+                    normalize_welford(channel_ptr(bottom_top_blob, q, size), size, s);
+                }
+            }
+
+            // the affine folds into the normalization, y = (x - mean) * a + b
+            const float mean = (float)s.mean;
+            const float rstd = (float)(1.0 / sqrt(s.m2 / s.n + eps));
+            if (contiguous && !affine)
+            {
+                normalize_affine(channel_ptr(bottom_top_blob, qbegin, size), group_size, mean, rstd, 0.f);
+                continue;
+            }
+
+            for (int q = qbegin; q < qend; q++)
+            {
+                const float a = affine ? rstd * gamma_data[q] : rstd;
+                const float b = affine ? beta_data[q] : 0.f;
+
+                normalize_affine(channel_ptr(bottom_top_blob, q, size), size, mean, a, b);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(GroupNorm_x86)
+
+} // namespace tinyinfer
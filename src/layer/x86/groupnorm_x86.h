@@ -0,0 +1,18 @@
+#ifndef LAYER_GROUPNORM_X86_H
+#define LAYER_GROUPNORM_X86_H
+
+#include "groupnorm.h"
+
+namespace tinyinfer {
+
+class GroupNorm_x86 : public GroupNorm
+{
+public:
+    GroupNorm_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,23 @@
+#include "hardsigmoid_x86.h"
+
+#include "x86_activation.h"
+
+namespace tinyinfer {
+
+HardSigmoid_x86::HardSigmoid_x86()
+{
+}
+
+int HardSigmoid_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const sgemm_vec _alpha = sgemm_set1(alpha);
+    const sgemm_vec _beta = sgemm_set1(beta);
+
+    mathfun_inplace(bottom_top_blob, [&](sgemm_vec _x) { return activation_hardsigmoid(_x, _alpha, _beta); }, opt);
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(HardSigmoid_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_HARDSIGMOID_X86_H
+#define LAYER_HARDSIGMOID_X86_H
+
+#include "hardsigmoid.h"
+
+namespace tinyinfer {
+
+class HardSigmoid_x86 : public HardSigmoid
+{
+public:
+    HardSigmoid_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,23 @@
+#include "hardswish_x86.h"
+
+#include "x86_activation.h"
+
+namespace tinyinfer {
+
+HardSwish_x86::HardSwish_x86()
+{
+}
+
+int HardSwish_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const sgemm_vec _alpha = sgemm_set1(alpha);
+    const sgemm_vec _beta = sgemm_set1(beta);
+
+    mathfun_inplace(bottom_top_blob, [&](sgemm_vec _x) { return activation_hardswish(_x, _alpha, _beta); }, opt);
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(HardSwish_x86)
+
+} // namespace tinyinfer
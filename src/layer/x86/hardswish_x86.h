@@ -0,0 +1,18 @@
+#ifndef LAYER_HARDSWISH_X86_H
+#define LAYER_HARDSWISH_X86_H
+
+#include "hardswish.h"
+
+namespace tinyinfer {
+
+class HardSwish_x86 : public HardSwish
+{
+public:
+    HardSwish_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,69 @@
+#include "innerproduct_x86.h"
+
+#include "sgemm_x86.h"
+
+namespace tinyinfer {
+
+InnerProduct_x86::InnerProduct_x86()
+{
+}
+
+int InnerProduct_x86::create_pipeline(const Option& opt)
+{
+    const int num_input = weight_data_size / num_output;
+
+    // top = bottom * W^T, W^T(k, n) = weight_data[n * num_input + k]
+    int ret = sgemm_pack_B(weight_data, num_input, 1, num_output, num_input, weight_data_packed, opt);
+    if (ret != 0)
+        return ret;
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int InnerProduct_x86::destroy_pipeline(const Option& /*opt*/)
+{
+    weight_data_packed.release();
+    return 0;
+}
+
+int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+
+    Mat bottom_blob_flattened = bottom_blob;
+    int rows = 1;
+    if (bottom_blob.dims == 2 && bottom_blob.w == num_input)
+    {
+        rows = bottom_blob.h;
+        top_blob.create(num_output, rows, 4u, opt.blob_allocator);
+    }
+    else
+    {
+        if (bottom_blob.w * bottom_blob.h * bottom_blob.d * bottom_blob.c != num_input)
+            return -1;
+
+        bottom_blob_flattened = bottom_blob.reshape(num_input, opt.workspace_allocator);
+        top_blob.create(num_output, 4u, opt.blob_allocator);
+    }
+
+    if (bottom_blob_flattened.empty() || top_blob.empty())
+        return -100;
+
+    sgemm_epilogue ep = sgemm_epilogue_default();
+    if (bias_term)
+    {
+        ep.bias_type = 3;
+        ep.bias = bias_data;
+    }
+    ep.activation_type = activation_type;
+    ep.activation_params = activation_params;
+
+    return sgemm_packed_B(rows, num_output, num_input, bottom_blob_flattened, num_input, 0, weight_data_packed, top_blob, num_output, ep, opt);
+}
+
+DEFINE_LAYER_CREATOR(InnerProduct_x86)
+
+} // namespace tinyinfer
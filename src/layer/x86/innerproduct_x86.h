@@ -0,0 +1,25 @@
+#ifndef LAYER_INNERPRODUCT_X86_H
+#define LAYER_INNERPRODUCT_X86_H
+
+#include "innerproduct.h"
+
+namespace tinyinfer {
+
+class InnerProduct_x86 : public InnerProduct
+{
+public:
+    InnerProduct_x86();
+
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // transposed weight packed into gemm slivers once
+    Mat weight_data_packed;
+};
+
+} // namespace tinyinfer
+
+#endif
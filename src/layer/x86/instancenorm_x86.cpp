@@ -0,0 +1,45 @@
+#include "instancenorm_x86.h"
+
+#include "normalize_x86.h"
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+InstanceNorm_x86::InstanceNorm_x86()
+{
+}
+
+int InstanceNorm_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    int size;
+    if (resolve_channels(bottom_top_blob, size) != 0)
+        return -1;
+
+    // small planes are batched into tasks of about 16k floats
+    const int grain = size < 16384 ? 16384 / size : 1;
+
+    parallel_for(opt, 0, channels, grain, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = channel_ptr(bottom_top_blob, q, size);
+
+            normalize_stat s;
+            normalize_stat_init(s);
+            normalize_welford(ptr, size, s);
+
+            // the affine folds into the normalization, y = (x - mean) * a + b
+            const float rstd = (float)(1.0 / sqrt(s.m2 / s.n + eps));
+            const float a = affine ? rstd * gamma_data[q] : rstd;
+            const float b = affine ? beta_data[q] : 0.f;
+
+            normalize_affine(ptr, size, (float)s.mean, a, b);
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(InstanceNorm_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_INSTANCENORM_X86_H
+#define LAYER_INSTANCENORM_X86_H
+
+#include "instancenorm.h"
+
+namespace tinyinfer {
+
+class InstanceNorm_x86 : public InstanceNorm
+{
+public:
+    InstanceNorm_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,277 @@
+#include "interp_x86.h"
+
+#include "sgemm_x86.h"
+#include "threadpool.h"
+#include <string.h>
+#include <vector>
+
+namespace tinyinfer {
+
+Interp_x86::Interp_x86()
+{
+}
+
+// the scale k when every output position reads source position dx / k, 0 otherwise
+static int interp_integer_scale(const std::vector<int>& ofs, int w, int outw)
+{
+    const int k = outw / w;
+    if (k < 1 || outw != w * k)
+        return 0;
+
+    for (int dx = 0; dx < outw; dx++)
+    {
+        if (ofs[dx] != dx / k)
+            return 0;
+    }
+
+    return k;
+}
+
+// every element of the row repeated k times
+static void interp_repeat_row(const float* ptr, int w, int k, float* outptr)
+{
+    if (k == 1)
+    {
+        memcpy(outptr, ptr, w * sizeof(float));
+        return;
+    }
+
+    int x = 0;
+    if (k == 2)
+    {
+#if __AVX__
+        for (; x + 8 <= w; x += 8)
+        {
+            __m256 _v = _mm256_loadu_ps(ptr + x);
+            __m256 _lo = _mm256_unpacklo_ps(_v, _v);
+            __m256 _hi = _mm256_unpackhi_ps(_v, _v);
+            _mm256_storeu_ps(outptr + x * 2, _mm256_permute2f128_ps(_lo, _hi, 0x20));
+            _mm256_storeu_ps(outptr + x * 2 + 8, _mm256_permute2f128_ps(_lo, _hi, 0x31));
+        }
+#endif // __AVX__
+#if __SSE2__
+        for (; x + 4 <= w; x += 4)
+        {
+            __m128 _v = _mm_loadu_ps(ptr + x);
+            _mm_storeu_ps(outptr + x * 2, _mm_unpacklo_ps(_v, _v));
+            _mm_storeu_ps(outptr + x * 2 + 4, _mm_unpackhi_ps(_v, _v));
+        }
+#endif // __SSE2__
+    }
+#if __SSE2__
+    if (k % 4 == 0)
+    {
+        for (; x < w; x++)
+        {
+            __m128 _v = _mm_set1_ps(ptr[x]);
+            for (int i = 0; i < k; i += 4)
+            {
+                _mm_storeu_ps(outptr + x * k + i, _v);
+            }
+        }
+    }
+#endif // __SSE2__
+    for (; x < w; x++)
+    {
+        for (int i = 0; i < k; i++)
+        {
+            outptr[x * k + i] = ptr[x];
+        }
+    }
+}
+
+// one source row resized along x
+static void interp_hresize(const float* ptr, const int* xofs, const float* alpha, int outw, int taps, float* outptr)
+{
+    if (taps == 2)
+    {
+        for (int dx = 0; dx < outw; dx++)
+        {
+            outptr[dx] = ptr[xofs[0]] * alpha[0] + ptr[xofs[1]] * alpha[1];
+            xofs += 2;
+            alpha += 2;
+        }
+    }
+    if (taps == 4)
+    {
+        for (int dx = 0; dx < outw; dx++)
+        {
+            outptr[dx] = ptr[xofs[0]] * alpha[0] + ptr[xofs[1]] * alpha[1] + ptr[xofs[2]] * alpha[2] + ptr[xofs[3]] * alpha[3];
+            xofs += 4;
+            alpha += 4;
+        }
+    }
+}
+
+// the resized rows blended along y
+static void interp_vresize(const float* const* rows, const float* beta, int outw, int taps, float* outptr)
+{
+    int i = 0;
+    if (taps == 2)
+    {
+        const sgemm_vec _b0 = sgemm_set1(beta[0]);
+        const sgemm_vec _b1 = sgemm_set1(beta[1]);
+        for (; i + SGEMM_VL <= outw; i += SGEMM_VL)
+        {
+            sgemm_vec _v = sgemm_mul(sgemm_load(rows[0] + i), _b0);
+            _v = sgemm_fmadd(sgemm_load(rows[1] + i), _b1, _v);
+            sgemm_store(outptr + i, _v);
+        }
+    }
+    if (taps == 4)
+    {
+        const sgemm_vec _b0 = sgemm_set1(beta[0]);
+        const sgemm_vec _b1 = sgemm_set1(beta[1]);
+        const sgemm_vec _b2 = sgemm_set1(beta[2]);
+        const sgemm_vec _b3 = sgemm_set1(beta[3]);
+        for (; i + SGEMM_VL <= outw; i += SGEMM_VL)
+        {
+            sgemm_vec _v = sgemm_mul(sgemm_load(rows[0] + i), _b0);
+            _v = sgemm_fmadd(sgemm_load(rows[1] + i), _b1, _v);
+            _v = sgemm_fmadd(sgemm_load(rows[2] + i), _b2, _v);
+            _v = sgemm_fmadd(sgemm_load(rows[3] + i), _b3, _v);
+            sgemm_store(outptr + i, _v);
+        }
+    }
+    for (; i < outw; i++)
+    {
+        float sum = 0.f;
+        for (int k = 0; k < taps; k++)
+        {
+            sum += rows[k][i] * beta[k];
+        }
+        outptr[i] = sum;
+    }
+}
+
+int Interp_x86::forward_resize(const Mat& bottom_blob, Mat& top_blob, int outw, int outh, float scale_w, float scale_h, const Option& opt) const
+{
+    if (bottom_blob.dims != 3)
+        return Interp::forward_resize(bottom_blob, top_blob, outw, outh, scale_w, scale_h, opt);
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int channels = bottom_blob.c;
+
+    top_blob.create(outw, outh, channels, bottom_blob.elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // coordinates and weights are the same for every channel
+    const int n = taps();
+    std::vector<int> xofs(outw * n);
+    std::vector<float> alpha(outw * n);
+    std::vector<int> yofs(outh * n);
+    std::vector<float> beta(outh * n);
+    resolve_coeffs(w, outw, scale_w, xofs.data(), alpha.data());
+    resolve_coeffs(h, outh, scale_h, yofs.data(), beta.data());
+
+    // an integer nearest scale repeats every element, the repeated rows are copied below
+    const int kx = n == 1 ? interp_integer_scale(xofs, w, outw) : 0;
+
+    // a few channels are split into bands of output rows as well
+    const int bands = std::max(1, std::min(outh, (opt.num_threads + channels - 1) / channels));
+
+    parallel_for(opt, 0, channels * bands, 1, [&](int i0, int i1) {
+        // the resized source rows in use, by source row index
+        Mat rowbuf;
+        if (n > 1)
+            rowbuf.create(outw, n, 4u, opt.workspace_allocator);
+
+        for (int i = i0; i < i1; i++)
+        {
+            const int q = i / bands;
+            const int y0 = (int)((long)outh * (i % bands) / bands);
+            const int y1 = (int)((long)outh * (i % bands + 1) / bands);
+
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
+
+            if (n == 1)
+            {
+                for (int dy = y0; dy < y1; dy++)
+                {
+                    float* outrow = outptr + dy * outw;
+
+                    // consecutive output rows reading the same source row are copies
+                    if (dy > y0 && yofs[dy] == yofs[dy - 1])
+                    {
+                        memcpy(outrow, outrow - outw, outw * sizeof(float));
+                        continue;
+                    }
+
+                    const float* row = ptr + yofs[dy] * w;
+                    if (kx)
+                    {
+                        interp_repeat_row(row, w, kx, outrow);
+                    }
+                    else
+                    {
+                        for (int dx = 0; dx < outw; dx++)
+                        {
+                            outrow[dx] = row[xofs[dx]];
+                        }
+                    }
+                }
+
+                continue;
+            }
+
+            // each source row is resized along x once and kept while the following output rows still read it
+            int held[4] = {-1, -1, -1, -1};
+            for (int dy = y0; dy < y1; dy++)
+            {
+                const int* sy = &yofs[dy * n];
+
+                const float* rows[4];
+                bool used[4] = {false, false, false, false};
+                bool found[4] = {false, false, false, false};
+                for (int k = 0; k < n; k++)
+                {
+                    for (int j = 0; j < n; j++)
+                    {
+                        if (held[j] == sy[k])
+                        {
+                            rows[k] = rowbuf.row(j);
+                            used[j] = true;
+                            found[k] = true;
+                            break;
+                        }
+                    }
+                }
+                for (int k = 0; k < n; k++)
+                {
+                    if (found[k])
+                        continue;
+
+                    int j = 0;
+                    while (used[j])
+                        j++;
+
+                    interp_hresize(ptr + sy[k] * w, &xofs[0], &alpha[0], outw, n, rowbuf.row(j));
+                    held[j] = sy[k];
+                    used[j] = true;
+                    rows[k] = rowbuf.row(j);
+
+                    // a tap repeated at the border reads the same buffer
+                    for (int k2 = k + 1; k2 < n; k2++)
+                    {
+                        if (sy[k2] == sy[k])
+                        {
+                            rows[k2] = rows[k];
+                            found[k2] = true;
+                        }
+                    }
+                }
+
+                interp_vresize(rows, &beta[dy * n], outw, n, outptr + dy * outw);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Interp_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,19 @@
+#ifndef LAYER_INTERP_X86_H
+#define LAYER_INTERP_X86_H
+
+#include "interp.h"
+
+namespace tinyinfer {
+
+class Interp_x86 : public Interp
+{
+public:
+    Interp_x86();
+
+protected:
+    virtual int forward_resize(const Mat& bottom_blob, Mat& top_blob, int outw, int outh, float scale_w, float scale_h, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,46 @@
+#include "layernorm_x86.h"
+
+#include "normalize_x86.h"
+#include "threadpool.h"
+#include <math.h>
+
+namespace tinyinfer {
+
+LayerNorm_x86::LayerNorm_x86()
+{
+}
+
+int LayerNorm_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    int channels, rows, size;
+    if (resolve_rows(bottom_top_blob, channels, rows, size) != 0)
+        return -1;
+
+    // short rows are batched into tasks of about 16k floats
+    const int grain = size < 16384 ? 16384 / size : 1;
+
+    parallel_for(opt, 0, channels * rows, grain, [&](int t0, int t1) {
+        for (int t = t0; t < t1; t++)
+        {
+            float* ptr = (float*)bottom_top_blob.channel(t / rows) + (size_t)(t % rows) * size;
+
+            normalize_stat s;
+            normalize_stat_init(s);
+            normalize_welford(ptr, size, s);
+
+            const float mean = (float)s.mean;
+            const float a = (float)(1.0 / sqrt(s.m2 / s.n + eps));
+
+            if (affine)
+                normalize_affine(ptr, size, mean, a, gamma_data, beta_data);
+            else
+                normalize_affine(ptr, size, mean, a, 0.f);
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(LayerNorm_x86)
+
+} // namespace tinyinfer
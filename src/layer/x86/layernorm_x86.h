@@ -0,0 +1,18 @@
+#ifndef LAYER_LAYERNORM_X86_H
+#define LAYER_LAYERNORM_X86_H
+
+#include "layernorm.h"
+
+namespace tinyinfer {
+
+class LayerNorm_x86 : public LayerNorm
+{
+public:
+    LayerNorm_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
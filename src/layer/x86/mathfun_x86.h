@@ -0,0 +1,747 @@
+#ifndef LAYER_MATHFUN_X86_H
+#define LAYER_MATHFUN_X86_H
+
+// vectorized libm replacements on sgemm_vec for the elementwise layers
+// compiled into every isa copy of the including layer like the sgemm helpers
+//
+// the polynomials are the cephes single precision ones, evaluated with fma where the isa has it
+// exp, log, tanh, atan, asin and acos stay within a few ulp of libm over the whole float range
+// sin, cos and tan reduce the argument with a three part pi / 4, accurate up to |x| of about 8192
+
+#include "sgemm_x86.h"
+
+#include <math.h>
+
+namespace tinyinfer {
+
+#if __AVX512F__
+typedef __mmask16 mathfun_mask;
+#elif __AVX__
+typedef __m256 mathfun_mask;
+#elif __SSE2__
+typedef __m128 mathfun_mask;
+#else
+typedef bool mathfun_mask;
+#endif
+
+static inline sgemm_vec mathfun_div(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_div_ps(_a, _b);
+#elif __AVX__
+    return _mm256_div_ps(_a, _b);
+#elif __SSE2__
+    return _mm_div_ps(_a, _b);
+#else
+    return _a / _b;
+#endif
+}
+
+// max and min return the second operand when either one is nan, pass the value to clamp last to keep its nan
+static inline sgemm_vec mathfun_max(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_max_ps(_a, _b);
+#elif __AVX__
+    return _mm256_max_ps(_a, _b);
+#elif __SSE2__
+    return _mm_max_ps(_a, _b);
+#else
+    return _a > _b ? _a : _b;
+#endif
+}
+
+static inline sgemm_vec mathfun_min(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_min_ps(_a, _b);
+#elif __AVX__
+    return _mm256_min_ps(_a, _b);
+#elif __SSE2__
+    return _mm_min_ps(_a, _b);
+#else
+    return _a < _b ? _a : _b;
+#endif
+}
+
+// sum and max of all lanes
+static inline float mathfun_reduce_add(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_reduce_add_ps(_a);
+#elif __AVX__
+    __m128 _s = _mm_add_ps(_mm256_castps256_ps128(_a), _mm256_extractf128_ps(_a, 1));
+    _s = _mm_add_ps(_s, _mm_movehl_ps(_s, _s));
+    _s = _mm_add_ss(_s, _mm_shuffle_ps(_s, _s, 1));
+    return _mm_cvtss_f32(_s);
+#elif __SSE2__
+    __m128 _s = _mm_add_ps(_a, _mm_movehl_ps(_a, _a));
+    _s = _mm_add_ss(_s, _mm_shuffle_ps(_s, _s, 1));
+    return _mm_cvtss_f32(_s);
+#else
+    return _a;
+#endif
+}
+
+static inline float mathfun_reduce_max(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_reduce_max_ps(_a);
+#elif __AVX__
+    __m128 _s = _mm_max_ps(_mm256_castps256_ps128(_a), _mm256_extractf128_ps(_a, 1));
+    _s = _mm_max_ps(_s, _mm_movehl_ps(_s, _s));
+    _s = _mm_max_ss(_s, _mm_shuffle_ps(_s, _s, 1));
+    return _mm_cvtss_f32(_s);
+#elif __SSE2__
+    __m128 _s = _mm_max_ps(_a, _mm_movehl_ps(_a, _a));
+    _s = _mm_max_ss(_s, _mm_shuffle_ps(_s, _s, 1));
+    return _mm_cvtss_f32(_s);
+#else
+    return _a;
+#endif
+}
+
+static inline sgemm_vec mathfun_sqrt(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_sqrt_ps(_a);
+#elif __AVX__
+    return _mm256_sqrt_ps(_a);
+#elif __SSE2__
+    return _mm_sqrt_ps(_a);
+#else
+    return sqrtf(_a);
+#endif
+}
+
+// _c - _a * _b
+static inline sgemm_vec mathfun_fnmadd(sgemm_vec _a, sgemm_vec _b, sgemm_vec _c)
+{
+#if __AVX512F__
+    return _mm512_fnmadd_ps(_a, _b, _c);
+#elif __AVX__ && __FMA__
+    return _mm256_fnmadd_ps(_a, _b, _c);
+#else
+    return sgemm_sub(_c, sgemm_mul(_a, _b));
+#endif
+}
+
+static inline sgemm_vec mathfun_neg(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_a), _mm512_set1_epi32(0x80000000)));
+#elif __AVX__
+    return _mm256_xor_ps(_a, _mm256_set1_ps(-0.f));
+#elif __SSE2__
+    return _mm_xor_ps(_a, _mm_set1_ps(-0.f));
+#else
+    return -_a;
+#endif
+}
+
+static inline sgemm_vec mathfun_abs(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(_a), _mm512_set1_epi32(0x7fffffff)));
+#elif __AVX__
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.f), _a);
+#elif __SSE2__
+    return _mm_andnot_ps(_mm_set1_ps(-0.f), _a);
+#else
+    return fabsf(_a);
+#endif
+}
+
+// the magnitude of _a with the sign of _b
+static inline sgemm_vec mathfun_copysign(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    const __m512i _sign = _mm512_set1_epi32(0x80000000);
+    return _mm512_castsi512_ps(_mm512_ternarylogic_epi32(_mm512_castps_si512(_a), _mm512_castps_si512(_b), _sign, 0xd8));
+#elif __AVX__
+    const __m256 _sign = _mm256_set1_ps(-0.f);
+    return _mm256_or_ps(_mm256_andnot_ps(_sign, _a), _mm256_and_ps(_sign, _b));
+#elif __SSE2__
+    const __m128 _sign = _mm_set1_ps(-0.f);
+    return _mm_or_ps(_mm_andnot_ps(_sign, _a), _mm_and_ps(_sign, _b));
+#else
+    return copysignf(_a, _b);
+#endif
+}
+
+static inline mathfun_mask mathfun_cmplt(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_cmp_ps_mask(_a, _b, _CMP_LT_OQ);
+#elif __AVX__
+    return _mm256_cmp_ps(_a, _b, _CMP_LT_OQ);
+#elif __SSE2__
+    return _mm_cmplt_ps(_a, _b);
+#else
+    return _a < _b;
+#endif
+}
+
+static inline mathfun_mask mathfun_cmpeq(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_cmp_ps_mask(_a, _b, _CMP_EQ_OQ);
+#elif __AVX__
+    return _mm256_cmp_ps(_a, _b, _CMP_EQ_OQ);
+#elif __SSE2__
+    return _mm_cmpeq_ps(_a, _b);
+#else
+    return _a == _b;
+#endif
+}
+
+// true when _a >= _b does not hold, nan included
+static inline mathfun_mask mathfun_cmpnge(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_cmp_ps_mask(_a, _b, _CMP_NGE_UQ);
+#elif __AVX__
+    return _mm256_cmp_ps(_a, _b, _CMP_NGE_UQ);
+#elif __SSE2__
+    return _mm_cmpnge_ps(_a, _b);
+#else
+    return !(_a >= _b);
+#endif
+}
+
+static inline mathfun_mask mathfun_mask_or(mathfun_mask _a, mathfun_mask _b)
+{
+#if __AVX512F__
+    return _a | _b;
+#elif __AVX__
+    return _mm256_or_ps(_a, _b);
+#elif __SSE2__
+    return _mm_or_ps(_a, _b);
+#else
+    return _a || _b;
+#endif
+}
+
+// _m ? _a : _b per lane
+static inline sgemm_vec mathfun_select(mathfun_mask _m, sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_mask_blend_ps(_m, _b, _a);
+#elif __AVX__
+    return _mm256_blendv_ps(_b, _a, _m);
+#elif __SSE2__
+    return _mm_or_ps(_mm_and_ps(_m, _a), _mm_andnot_ps(_m, _b));
+#else
+    return _m ? _a : _b;
+#endif
+}
+
+#if __SSE2__ && !__AVX__
+// sse2 has no rounding instruction, go through int32 and keep the values too large for it, they are integral already
+static inline __m128 mathfun_round_sse2(__m128 _a, __m128 _t)
+{
+    const __m128 _big = _mm_cmpnlt_ps(_mm_andnot_ps(_mm_set1_ps(-0.f), _a), _mm_set1_ps(8388608.f));
+    return _mm_or_ps(_mm_and_ps(_big, _a), _mm_andnot_ps(_big, _t));
+}
+#endif
+
+static inline sgemm_vec mathfun_floor(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_roundscale_ps(_a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+#elif __AVX__
+    return _mm256_round_ps(_a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+#elif __SSE2__
+    __m128 _t = _mm_cvtepi32_ps(_mm_cvttps_epi32(_a));
+    _t = _mm_sub_ps(_t, _mm_and_ps(_mm_cmpgt_ps(_t, _a), _mm_set1_ps(1.f)));
+    return mathfun_round_sse2(_a, _t);
+#else
+    return floorf(_a);
+#endif
+}
+
+static inline sgemm_vec mathfun_ceil(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_roundscale_ps(_a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+#elif __AVX__
+    return _mm256_round_ps(_a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+#elif __SSE2__
+    __m128 _t = _mm_cvtepi32_ps(_mm_cvttps_epi32(_a));
+    _t = _mm_add_ps(_t, _mm_and_ps(_mm_cmplt_ps(_t, _a), _mm_set1_ps(1.f)));
+    return mathfun_round_sse2(_a, _t);
+#else
+    return ceilf(_a);
+#endif
+}
+
+static inline sgemm_vec mathfun_trunc(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_roundscale_ps(_a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+#elif __AVX__
+    return _mm256_round_ps(_a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+#elif __SSE2__
+    return mathfun_round_sse2(_a, _mm_cvtepi32_ps(_mm_cvttps_epi32(_a)));
+#else
+    return truncf(_a);
+#endif
+}
+
+// to nearest, ties to even like nearbyintf under the default rounding mode
+static inline sgemm_vec mathfun_round(sgemm_vec _a)
+{
+#if __AVX512F__
+    return _mm512_roundscale_ps(_a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#elif __AVX__
+    return _mm256_round_ps(_a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#elif __SSE2__
+    return mathfun_round_sse2(_a, _mm_cvtepi32_ps(_mm_cvtps_epi32(_a)));
+#else
+    return nearbyintf(_a);
+#endif
+}
+
+// 2^n for integral n in [-126, 127]
+static inline sgemm_vec mathfun_pow2n(sgemm_vec _n)
+{
+#if __AVX512F__
+    return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(_n), _mm512_set1_epi32(127)), 23));
+#elif __AVX2__
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(_n), _mm256_set1_epi32(127)), 23));
+#elif __AVX__
+    // avx1 has no 256 bit integer ops, build the exponent on both halves
+    const __m256i _n32 = _mm256_cvtps_epi32(_n);
+    const __m128i _bias = _mm_set1_epi32(127);
+    __m128i _lo = _mm_slli_epi32(_mm_add_epi32(_mm256_castsi256_si128(_n32), _bias), 23);
+    __m128i _hi = _mm_slli_epi32(_mm_add_epi32(_mm256_extractf128_si256(_n32, 1), _bias), 23);
+    return _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(_lo), _hi, 1));
+#elif __SSE2__
+    return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(_n), _mm_set1_epi32(127)), 23));
+#else
+    return ldexpf(1.f, (int)_n);
+#endif
+}
+
+// _a = _m * 2^_e with _m in [0.5, 1) for finite positive _a, denormals included
+static inline void mathfun_frexp(sgemm_vec _a, sgemm_vec& _m, sgemm_vec& _e)
+{
+#if __AVX512F__
+    _m = _mm512_getmant_ps(_a, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_zero);
+    _e = _mm512_add_ps(_mm512_getexp_ps(_a), _mm512_set1_ps(1.f));
+#elif __SSE2__
+    // scale denormals into the normal range first
+    const mathfun_mask _denormal = mathfun_cmplt(_a, sgemm_set1(1.17549435e-38f));
+    _a = mathfun_select(_denormal, sgemm_mul(_a, sgemm_set1(33554432.f)), _a);
+    const sgemm_vec _bias = mathfun_select(_denormal, sgemm_set1(126.f + 25.f), sgemm_set1(126.f));
+#if __AVX2__
+    const __m256i _bits = _mm256_castps_si256(_a);
+    _e = _mm256_cvtepi32_ps(_mm256_srli_epi32(_bits, 23));
+#elif __AVX__
+    const __m256i _bits = _mm256_castps_si256(_a);
+    __m128i _lo = _mm_srli_epi32(_mm256_castsi256_si128(_bits), 23);
+    __m128i _hi = _mm_srli_epi32(_mm256_extractf128_si256(_bits, 1), 23);
+    _e = _mm256_cvtepi32_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(_lo), _hi, 1));
+#else
+    _e = _mm_cvtepi32_ps(_mm_srli_epi32(_mm_castps_si128(_a), 23));
+#endif
+    _e = sgemm_sub(_e, _bias);
+#if __AVX__
+    _m = _mm256_or_ps(_mm256_and_ps(_a, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff))), _mm256_set1_ps(0.5f));
+#else
+    _m = _mm_or_ps(_mm_and_ps(_a, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff))), _mm_set1_ps(0.5f));
+#endif
+#else
+    int e;
+    _m = frexpf(_a, &e);
+    _e = (float)e;
+#endif
+}
+
+// p[0] * x^(n-1) + ... + p[n-1]
+template<int n>
+static inline sgemm_vec mathfun_polynomial(sgemm_vec _x, const float* p)
+{
+    sgemm_vec _y = sgemm_set1(p[0]);
+    for (int i = 1; i < n; i++)
+    {
+        _y = sgemm_fmadd(_y, _x, sgemm_set1(p[i]));
+    }
+    return _y;
+}
+
+// exp(r) - 1 for |r| <= ln2 / 2
+static inline sgemm_vec mathfun_expm1_reduced(sgemm_vec _r)
+{
+    static const float p[6] = {1.9875691500E-4f, 1.3981999507E-3f, 8.3334519073E-3f, 4.1665795894E-2f, 1.6666665459E-1f, 5.0000001201E-1f};
+
+    return sgemm_fmadd(mathfun_polynomial<6>(_r, p), sgemm_mul(_r, _r), _r);
+}
+
+// _y * 2^n for integral n in [-252, 254], in two halves so that overflow to inf and the denormal range come out right
+static inline sgemm_vec mathfun_ldexp(sgemm_vec _y, sgemm_vec _n)
+{
+    const sgemm_vec _n1 = mathfun_floor(sgemm_mul(_n, sgemm_set1(0.5f)));
+    return sgemm_mul(sgemm_mul(_y, mathfun_pow2n(_n1)), mathfun_pow2n(sgemm_sub(_n, _n1)));
+}
+
+// x = n * ln2 + r with |r| <= ln2 / 2, ln2 split in two for an exact product
+static inline sgemm_vec mathfun_exp_reduce(sgemm_vec _x, sgemm_vec& _r)
+{
+    const sgemm_vec _n = mathfun_round(sgemm_mul(_x, sgemm_set1(1.44269504088896341f)));
+    _r = mathfun_fnmadd(_n, sgemm_set1(0.693359375f), _x);
+    _r = mathfun_fnmadd(_n, sgemm_set1(-2.12194440e-4f), _r);
+    return _n;
+}
+
+static inline sgemm_vec mathfun_exp(sgemm_vec _x)
+{
+    // past these exp is inf or below the smallest denormal, nan goes through
+    _x = mathfun_max(sgemm_set1(-104.f), mathfun_min(sgemm_set1(89.f), _x));
+
+    sgemm_vec _r;
+    const sgemm_vec _n = mathfun_exp_reduce(_x, _r);
+
+    return mathfun_ldexp(sgemm_add(mathfun_expm1_reduced(_r), sgemm_set1(1.f)), _n);
+}
+
+// exp(hi + lo), n comes from the sum but only hi goes through the exact reduction
+// so the bits of lo below the ulp of hi still count, lo may be a few units large
+static inline sgemm_vec mathfun_exp_split(sgemm_vec _hi, sgemm_vec _lo)
+{
+    // a saturated sum moves hi onto the clamp, nan goes through
+    const sgemm_vec _s = sgemm_add(_hi, _lo);
+    const sgemm_vec _cs = mathfun_max(sgemm_set1(-104.f), mathfun_min(sgemm_set1(89.f), _s));
+    _hi = sgemm_add(_hi, sgemm_sub(_cs, _s));
+
+    const sgemm_vec _n = mathfun_round(sgemm_mul(_cs, sgemm_set1(1.44269504088896341f)));
+    sgemm_vec _r = mathfun_fnmadd(_n, sgemm_set1(0.693359375f), _hi);
+    _r = mathfun_fnmadd(_n, sgemm_set1(-2.12194440e-4f), _r);
+    _r = sgemm_add(_r, _lo);
+
+    return mathfun_ldexp(sgemm_add(mathfun_expm1_reduced(_r), sgemm_set1(1.f)), _n);
+}
+
+// exp(x) - 1 without the cancellation near 0, for x <= 88
+static inline sgemm_vec mathfun_expm1(sgemm_vec _x)
+{
+    // below -88 the result is -1 already
+    _x = mathfun_max(sgemm_set1(-88.f), _x);
+
+    sgemm_vec _r;
+    const sgemm_vec _n = mathfun_exp_reduce(_x, _r);
+
+    // 2^n * (exp(r) - 1) + (2^n - 1), exact for n = 0
+    const sgemm_vec _s = mathfun_pow2n(_n);
+    return sgemm_fmadd(_s, mathfun_expm1_reduced(_r), sgemm_sub(_s, sgemm_set1(1.f)));
+}
+
+// exp with a degree 5 polynomial and one exponent scale, within 3 ulp
+// saturates to exp(-87.3) and exp(88.3) outside that range, never denormal or inf
+static inline sgemm_vec mathfun_exp_fast(sgemm_vec _x)
+{
+    static const float p[4] = {8.333837613e-03f, 4.189861193e-02f, 1.666688621e-01f, 4.999914169e-01f};
+
+    _x = mathfun_max(sgemm_set1(-87.3f), mathfun_min(sgemm_set1(88.3f), _x));
+
+    sgemm_vec _r;
+    const sgemm_vec _n = mathfun_exp_reduce(_x, _r);
+
+    const sgemm_vec _y = sgemm_fmadd(mathfun_polynomial<4>(_r, p), sgemm_mul(_r, _r), sgemm_add(_r, sgemm_set1(1.f)));
+    return sgemm_mul(_y, mathfun_pow2n(_n));
+}
+
+// 1 / x from the hardware estimate and one newton step, within 2 ulp for finite normal x
+static inline sgemm_vec mathfun_rcp_fast(sgemm_vec _x)
+{
+#if __AVX512F__
+    const sgemm_vec _r = _mm512_rcp14_ps(_x);
+#elif __AVX__
+    const sgemm_vec _r = _mm256_rcp_ps(_x);
+#elif __SSE2__
+    const sgemm_vec _r = _mm_rcp_ps(_x);
+#else
+    const sgemm_vec _r = 1.f / _x;
+#endif
+    return sgemm_fmadd(_r, mathfun_fnmadd(_x, _r, sgemm_set1(1.f)), _r);
+}
+
+// the rounding error of _p = _a * _b, so that _a * _b == _p + error exactly
+static inline sgemm_vec mathfun_mul_error(sgemm_vec _a, sgemm_vec _b, sgemm_vec _p)
+{
+#if __AVX512F__
+    return _mm512_fmsub_ps(_a, _b, _p);
+#elif __AVX__ && __FMA__
+    return _mm256_fmsub_ps(_a, _b, _p);
+#elif __SSE2__
+    // dekker, both operands split into halves whose products are exact, |a| and |b| below 1e30
+    const sgemm_vec _split = sgemm_set1(4097.f);
+    const sgemm_vec _ca = sgemm_mul(_a, _split);
+    const sgemm_vec _ah = sgemm_sub(_ca, sgemm_sub(_ca, _a));
+    const sgemm_vec _al = sgemm_sub(_a, _ah);
+    const sgemm_vec _cb = sgemm_mul(_b, _split);
+    const sgemm_vec _bh = sgemm_sub(_cb, sgemm_sub(_cb, _b));
+    const sgemm_vec _bl = sgemm_sub(_b, _bh);
+    sgemm_vec _e = sgemm_sub(sgemm_mul(_ah, _bh), _p);
+    _e = sgemm_add(_e, sgemm_mul(_ah, _bl));
+    _e = sgemm_add(_e, sgemm_mul(_al, _bh));
+    return sgemm_add(_e, sgemm_mul(_al, _bl));
+#else
+    return fmaf(_a, _b, -_p);
+#endif
+}
+
+static inline sgemm_vec mathfun_log(sgemm_vec _x)
+{
+    static const float p[9] = {7.0376836292E-2f, -1.1514610310E-1f, 1.1676998740E-1f, -1.2420140846E-1f, 1.4249322787E-1f, -1.6668057665E-1f, 2.0000714765E-1f, -2.4999993993E-1f, 3.3333331174E-1f};
+
+    const sgemm_vec _one = sgemm_set1(1.f);
+    const sgemm_vec _zero = sgemm_set1(0.f);
+
+    sgemm_vec _m, _e;
+    mathfun_frexp(_x, _m, _e);
+
+    // m in [sqrt(0.5), sqrt(2)) around 1, keep the polynomial argument small
+    const mathfun_mask _small = mathfun_cmplt(_m, sgemm_set1(0.707106781186547524f));
+    _e = sgemm_sub(_e, mathfun_select(_small, _one, _zero));
+    _m = sgemm_sub(sgemm_add(_m, mathfun_select(_small, _m, _zero)), _one);
+
+    const sgemm_vec _m2 = sgemm_mul(_m, _m);
+    sgemm_vec _y = sgemm_mul(sgemm_mul(mathfun_polynomial<9>(_m, p), _m), _m2);
+    _y = sgemm_fmadd(_e, sgemm_set1(-2.12194440e-4f), _y);
+    _y = sgemm_fmadd(_m2, sgemm_set1(-0.5f), _y);
+    _y = sgemm_add(_m, _y);
+    _y = sgemm_fmadd(_e, sgemm_set1(0.693359375f), _y);
+
+    // log(0) = -inf, log(inf) = inf, negative and nan give nan
+    _y = mathfun_select(mathfun_cmpeq(_x, _zero), sgemm_set1(-INFINITY), _y);
+    _y = mathfun_select(mathfun_cmpeq(_x, sgemm_set1(INFINITY)), _x, _y);
+    return mathfun_select(mathfun_cmpnge(_x, _zero), sgemm_set1(NAN), _y);
+}
+
+// sin and cos share the reduction, x = j * pi / 4 + r with j even and |r| <= pi / 4
+static inline void mathfun_sincos(sgemm_vec _x, sgemm_vec& _sin, sgemm_vec& _cos)
+{
+    static const float ps[3] = {-1.9515295891E-4f, 8.3321608736E-3f, -1.6666654611E-1f};
+    static const float pc[3] = {2.443315711809948E-005f, -1.388731625493765E-003f, 4.166664568298827E-002f};
+
+    const sgemm_vec _a = mathfun_abs(_x);
+
+    sgemm_vec _j = mathfun_floor(sgemm_mul(_a, sgemm_set1(1.27323954473516f)));
+    _j = sgemm_mul(mathfun_floor(sgemm_mul(sgemm_add(_j, sgemm_set1(1.f)), sgemm_set1(0.5f))), sgemm_set1(2.f));
+
+    sgemm_vec _r = mathfun_fnmadd(_j, sgemm_set1(0.78515625f), _a);
+    _r = mathfun_fnmadd(_j, sgemm_set1(2.4187564849853515625e-4f), _r);
+    _r = mathfun_fnmadd(_j, sgemm_set1(3.77489497744594108e-8f), _r);
+
+    const sgemm_vec _z = sgemm_mul(_r, _r);
+    const sgemm_vec _ys = sgemm_fmadd(sgemm_mul(mathfun_polynomial<3>(_z, ps), _z), _r, _r);
+    sgemm_vec _yc = sgemm_mul(sgemm_mul(mathfun_polynomial<3>(_z, pc), _z), _z);
+    _yc = sgemm_add(sgemm_fmadd(_z, sgemm_set1(-0.5f), _yc), sgemm_set1(1.f));
+
+    // quadrant from j mod 8, j / 2 odd swaps the polynomials, j / 4 odd flips the sign
+    const sgemm_vec _q4 = sgemm_mul(_j, sgemm_set1(0.25f));
+    const mathfun_mask _swap = mathfun_cmplt(sgemm_set1(0.25f), sgemm_sub(_q4, mathfun_floor(_q4)));
+    const sgemm_vec _q8 = sgemm_mul(_j, sgemm_set1(0.125f));
+    const sgemm_vec _f8 = sgemm_sub(_q8, mathfun_floor(_q8));
+
+    // sin flips for j mod 8 in {4, 6}, cos for j mod 8 in {2, 4}
+    sgemm_vec _s = mathfun_select(_swap, _yc, _ys);
+    sgemm_vec _c = mathfun_select(_swap, _ys, _yc);
+    _s = mathfun_select(mathfun_cmplt(_f8, sgemm_set1(0.5f)), _s, mathfun_neg(_s));
+    _c = mathfun_select(mathfun_cmplt(sgemm_set1(0.f), _f8), mathfun_select(mathfun_cmplt(_f8, sgemm_set1(0.75f)), mathfun_neg(_c), _c), _c);
+
+    _sin = mathfun_copysign(sgemm_set1(1.f), _x);
+    _sin = sgemm_mul(_s, _sin);
+    _cos = _c;
+}
+
+static inline sgemm_vec mathfun_sin(sgemm_vec _x)
+{
+    sgemm_vec _s, _c;
+    mathfun_sincos(_x, _s, _c);
+    return _s;
+}
+
+static inline sgemm_vec mathfun_cos(sgemm_vec _x)
+{
+    sgemm_vec _s, _c;
+    mathfun_sincos(_x, _s, _c);
+    return _c;
+}
+
+static inline sgemm_vec mathfun_tan(sgemm_vec _x)
+{
+    sgemm_vec _s, _c;
+    mathfun_sincos(_x, _s, _c);
+    return mathfun_div(_s, _c);
+}
+
+static inline sgemm_vec mathfun_tanh(sgemm_vec _x)
+{
+    static const float p[5] = {-5.70498872745E-3f, 2.06390887954E-2f, -5.37397155531E-2f, 1.33314422036E-1f, -3.33332819422E-1f};
+
+    const sgemm_vec _a = mathfun_abs(_x);
+
+    // small inputs, odd polynomial
+    const sgemm_vec _z = sgemm_mul(_x, _x);
+    const sgemm_vec _ys = sgemm_fmadd(sgemm_mul(mathfun_polynomial<5>(_z, p), _z), _x, _x);
+
+    // 1 - 2 / (exp(2|x|) + 1), exp saturates to inf and gives exactly 1 far out
+    const sgemm_vec _e = mathfun_exp(sgemm_add(_a, _a));
+    sgemm_vec _yl = sgemm_sub(sgemm_set1(1.f), mathfun_div(sgemm_set1(2.f), sgemm_add(_e, sgemm_set1(1.f))));
+    _yl = mathfun_copysign(_yl, _x);
+
+    return mathfun_select(mathfun_cmplt(_a, sgemm_set1(0.625f)), _ys, _yl);
+}
+
+static inline sgemm_vec mathfun_atan(sgemm_vec _x)
+{
+    static const float p[4] = {8.05374449538e-2f, -1.38776856032E-1f, 1.99777106478E-1f, -3.33329491539E-1f};
+
+    const sgemm_vec _a = mathfun_abs(_x);
+    const sgemm_vec _one = sgemm_set1(1.f);
+
+    // reduce to |t| <= tan(pi / 8) around 0, pi / 4 or pi / 2
+    const mathfun_mask _big = mathfun_cmplt(sgemm_set1(2.414213562373095f), _a);
+    const mathfun_mask _mid = mathfun_cmplt(sgemm_set1(0.4142135623730950f), _a);
+
+    sgemm_vec _t = mathfun_select(_mid, mathfun_div(sgemm_sub(_a, _one), sgemm_add(_a, _one)), _a);
+    _t = mathfun_select(_big, mathfun_div(sgemm_set1(-1.f), _a), _t);
+    sgemm_vec _y0 = mathfun_select(_mid, sgemm_set1(0.78539816339744830962f), sgemm_set1(0.f));
+    _y0 = mathfun_select(_big, sgemm_set1(1.57079632679489661923f), _y0);
+
+    const sgemm_vec _z = sgemm_mul(_t, _t);
+    sgemm_vec _y = sgemm_fmadd(sgemm_mul(mathfun_polynomial<4>(_z, p), _z), _t, _t);
+    _y = sgemm_add(_y, _y0);
+
+    return mathfun_copysign(_y, _x);
+}
+
+// asin of |x| <= 0.5 and of the half angle form above, shared by asin and acos
+// returns asin(sqrt(z)) or asin(a) in _y, _wide tells which lanes took the half angle form
+static inline sgemm_vec mathfun_asin_core(sgemm_vec _a, sgemm_vec& _y)
+{
+    static const float p[5] = {4.2163199048E-2f, 2.4181311049E-2f, 4.5470025998E-2f, 7.4953002686E-2f, 1.6666752422E-1f};
+
+    // asin(a) = pi / 2 - 2 asin(sqrt((1 - a) / 2)) for a > 0.5
+    const mathfun_mask _wide = mathfun_cmplt(sgemm_set1(0.5f), _a);
+    const sgemm_vec _zw = sgemm_mul(sgemm_sub(sgemm_set1(1.f), _a), sgemm_set1(0.5f));
+    const sgemm_vec _z = mathfun_select(_wide, _zw, sgemm_mul(_a, _a));
+    const sgemm_vec _t = mathfun_select(_wide, mathfun_sqrt(_zw), _a);
+
+    _y = sgemm_fmadd(sgemm_mul(mathfun_polynomial<5>(_z, p), _z), _t, _t);
+
+    return mathfun_select(_wide, sgemm_set1(1.f), sgemm_set1(0.f));
+}
+
+static inline sgemm_vec mathfun_asin(sgemm_vec _x)
+{
+    const sgemm_vec _a = mathfun_abs(_x);
+
+    sgemm_vec _y;
+    const sgemm_vec _wide = mathfun_asin_core(_a, _y);
+    _y = mathfun_select(mathfun_cmpeq(_wide, sgemm_set1(1.f)), mathfun_fnmadd(sgemm_set1(2.f), _y, sgemm_set1(1.57079632679489661923f)), _y);
+    _y = mathfun_copysign(_y, _x);
+
+    return mathfun_select(mathfun_cmplt(sgemm_set1(1.f), _a), sgemm_set1(NAN), _y);
+}
+
+static inline sgemm_vec mathfun_acos(sgemm_vec _x)
+{
+    const sgemm_vec _a = mathfun_abs(_x);
+
+    sgemm_vec _y;
+    const sgemm_vec _wide = mathfun_asin_core(_a, _y);
+
+    // |x| > 0.5 gives 2 asin(sqrt((1 - |x|) / 2)), mirrored around pi / 2 for negative x
+    // |x| <= 0.5 gives pi / 2 - asin(x)
+    const sgemm_vec _half_pi = sgemm_set1(1.57079632679489661923f);
+    const sgemm_vec _yw = sgemm_add(_y, _y);
+    const sgemm_vec _ywide = mathfun_select(mathfun_cmplt(_x, sgemm_set1(0.f)), sgemm_sub(sgemm_set1(3.14159265358979323846f), _yw), _yw);
+    const sgemm_vec _ynarrow = sgemm_sub(_half_pi, mathfun_copysign(_y, _x));
+
+    _y = mathfun_select(mathfun_cmpeq(_wide, sgemm_set1(1.f)), _ywide, _ynarrow);
+
+    return mathfun_select(mathfun_cmplt(sgemm_set1(1.f), _a), sgemm_set1(NAN), _y);
+}
+
+static inline sgemm_vec mathfun_atan2(sgemm_vec _y, sgemm_vec _x)
+{
+    const sgemm_vec _zero = sgemm_set1(0.f);
+
+    // atan(y / x) lands in the right half plane, the left one is shifted by pi towards the sign of y
+    sgemm_vec _r = mathfun_atan(mathfun_div(_y, _x));
+    const sgemm_vec _shift = mathfun_copysign(sgemm_set1(3.14159265358979323846f), _y);
+    _r = mathfun_select(mathfun_cmplt(_x, _zero), sgemm_add(_r, _shift), _r);
+
+    // x == 0 gives +-pi / 2, and 0 when y is 0 too
+    const sgemm_vec _axis = mathfun_select(mathfun_cmpeq(_y, _zero), _y, mathfun_copysign(sgemm_set1(1.57079632679489661923f), _y));
+    return mathfun_select(mathfun_cmpeq(_x, _zero), _axis, _r);
+}
+
+// pow through exp(b log|a|), negative a is defined for integral b like powf
+static inline sgemm_vec mathfun_pow(sgemm_vec _a, sgemm_vec _b)
+{
+    const sgemm_vec _zero = sgemm_set1(0.f);
+    const sgemm_vec _one = sgemm_set1(1.f);
+
+    sgemm_vec _r = mathfun_exp(sgemm_mul(_b, mathfun_log(mathfun_abs(_a))));
+
+    // a < 0, odd b flips the sign and fractional b is nan
+    const sgemm_vec _bh = sgemm_mul(_b, sgemm_set1(0.5f));
+    const mathfun_mask _odd = mathfun_cmplt(_zero, mathfun_abs(sgemm_sub(_bh, mathfun_floor(_bh))));
+    const mathfun_mask _fraction = mathfun_cmplt(_zero, mathfun_abs(sgemm_sub(_b, mathfun_floor(_b))));
+    sgemm_vec _rneg = mathfun_select(_odd, mathfun_neg(_r), _r);
+    _rneg = mathfun_select(_fraction, sgemm_set1(NAN), _rneg);
+    _r = mathfun_select(mathfun_cmplt(_a, _zero), _rneg, _r);
+
+    // pow(x, 0) = 1 and pow(1, y) = 1, even for nan
+    return mathfun_select(mathfun_mask_or(mathfun_cmpeq(_b, _zero), mathfun_cmpeq(_a, _one)), _one, _r);
+}
+
+// ptr[i] = f(ptr[i]) over a whole blob, parallel over channels or over chunks of a single channel
+// the tail runs through the same vector code, every element gets the same approximation
+template<typename Func>
+static void mathfun_inplace(Mat& m, const Func& f, const Option& opt)
+{
+    const int channels = m.c;
+    const int size = m.w * m.h * m.d * m.elempack;
+
+    auto run = [&](float* ptr, int n) {
+        int i = 0;
+        for (; i + SGEMM_VL <= n; i += SGEMM_VL)
+        {
+            sgemm_store(ptr + i, f(sgemm_load(ptr + i)));
+        }
+        if (i < n)
+        {
+            float tmp[SGEMM_VL] = {0.f};
+            memcpy(tmp, ptr + i, (n - i) * sizeof(float));
+            sgemm_store(tmp, f(sgemm_load(tmp)));
+            memcpy(ptr + i, tmp, (n - i) * sizeof(float));
+        }
+    };
+
+    if (channels == 1)
+    {
+        float* ptr = m;
+
+        // 64k of floats per task
+        parallel_for(opt, 0, size, 16384, [&](int i0, int i1) {
+            run(ptr + i0, i1 - i0);
+        });
+        return;
+    }
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            run(m.channel(q), size);
+        }
+    });
+}
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,413 @@
+#include "multiheadattention_x86.h"
+
+#include "mathfun_x86.h"
+#include "threadpool.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace tinyinfer {
+
+// flash attention, one task takes a tile of query rows of one head through every key tile
+// the scores of a tile never leave l1 and the output rows are rescaled by the online softmax as the max moves
+// a key and value tile of 64 rows at head_dim 128 is 64kb and stays in l2 while the query tile walks over it
+static const int attention_tile_q = 32;
+static const int attention_tile_kv = 64;
+
+MultiHeadAttention_x86::MultiHeadAttention_x86()
+{
+}
+
+// S(rows x attention_tile_kv) = Q(rows x K) * Kt(K x attention_tile_kv), four query rows by two vectors of keys
+static void attention_scores(const float* Q, const float* Kt, float* S, int rows, int K)
+{
+    int i = 0;
+    for (; i + 3 < rows; i += 4)
+    {
+        const float* q0 = Q + (size_t)i * K;
+        const float* q1 = q0 + K;
+        const float* q2 = q1 + K;
+        const float* q3 = q2 + K;
+
+        for (int j = 0; j < attention_tile_kv; j += SGEMM_VL * 2)
+        {
+            sgemm_vec _s00 = sgemm_set1(0.f);
+            sgemm_vec _s01 = _s00;
+            sgemm_vec _s10 = _s00;
+            sgemm_vec _s11 = _s00;
+            sgemm_vec _s20 = _s00;
+            sgemm_vec _s21 = _s00;
+            sgemm_vec _s30 = _s00;
+            sgemm_vec _s31 = _s00;
+
+            const float* kt = Kt + j;
+            for (int k = 0; k < K; k++)
+            {
+                const sgemm_vec _k0 = sgemm_load(kt);
+                const sgemm_vec _k1 = sgemm_load(kt + SGEMM_VL);
+                sgemm_vec _q = sgemm_set1(q0[k]);
+                _s00 = sgemm_fmadd(_q, _k0, _s00);
+                _s01 = sgemm_fmadd(_q, _k1, _s01);
+                _q = sgemm_set1(q1[k]);
+                _s10 = sgemm_fmadd(_q, _k0, _s10);
+                _s11 = sgemm_fmadd(_q, _k1, _s11);
+                _q = sgemm_set1(q2[k]);
+                _s20 = sgemm_fmadd(_q, _k0, _s20);
+                _s21 = sgemm_fmadd(_q, _k1, _s21);
+                _q = sgemm_set1(q3[k]);
+                _s30 = sgemm_fmadd(_q, _k0, _s30);
+                _s31 = sgemm_fmadd(_q, _k1, _s31);
+                kt += attention_tile_kv;
+            }
+
+            float* s = S + (size_t)i * attention_tile_kv + j;
+            sgemm_store(s, _s00);
+            sgemm_store(s + SGEMM_VL, _s01);
+            sgemm_store(s + attention_tile_kv, _s10);
+            sgemm_store(s + attention_tile_kv + SGEMM_VL, _s11);
+            sgemm_store(s + attention_tile_kv * 2, _s20);
+            sgemm_store(s + attention_tile_kv * 2 + SGEMM_VL, _s21);
+            sgemm_store(s + attention_tile_kv * 3, _s30);
+            sgemm_store(s + attention_tile_kv * 3 + SGEMM_VL, _s31);
+        }
+    }
+    for (; i < rows; i++)
+    {
+        const float* q0 = Q + (size_t)i * K;
+
+        for (int j = 0; j < attention_tile_kv; j += SGEMM_VL * 2)
+        {
+            sgemm_vec _s0 = sgemm_set1(0.f);
+            sgemm_vec _s1 = _s0;
+
+            const float* kt = Kt + j;
+            for (int k = 0; k < K; k++)
+            {
+                const sgemm_vec _q = sgemm_set1(q0[k]);
+                _s0 = sgemm_fmadd(_q, sgemm_load(kt), _s0);
+                _s1 = sgemm_fmadd(_q, sgemm_load(kt + SGEMM_VL), _s1);
+                kt += attention_tile_kv;
+            }
+
+            float* s = S + (size_t)i * attention_tile_kv + j;
+            sgemm_store(s, _s0);
+            sgemm_store(s + SGEMM_VL, _s1);
+        }
+    }
+}
+
+// O(rows x N) += P(rows x cols) * V(cols x N, ldv), four rows by two vectors of the output at a time
+static void attention_accumulate(const float* P, const float* V, int ldv, float* O, int rows, int cols, int N)
+{
+    int i = 0;
+    for (; i + 3 < rows; i += 4)
+    {
+        const float* p0 = P + (size_t)i * attention_tile_kv;
+        const float* p1 = p0 + attention_tile_kv;
+        const float* p2 = p1 + attention_tile_kv;
+        const float* p3 = p2 + attention_tile_kv;
+        float* o0 = O + (size_t)i * N;
+        float* o1 = o0 + N;
+        float* o2 = o1 + N;
+        float* o3 = o2 + N;
+
+        int d = 0;
+        for (; d + SGEMM_VL * 2 <= N; d += SGEMM_VL * 2)
+        {
+            sgemm_vec _o00 = sgemm_load(o0 + d);
+            sgemm_vec _o01 = sgemm_load(o0 + d + SGEMM_VL);
+            sgemm_vec _o10 = sgemm_load(o1 + d);
+            sgemm_vec _o11 = sgemm_load(o1 + d + SGEMM_VL);
+            sgemm_vec _o20 = sgemm_load(o2 + d);
+            sgemm_vec _o21 = sgemm_load(o2 + d + SGEMM_VL);
+            sgemm_vec _o30 = sgemm_load(o3 + d);
+            sgemm_vec _o31 = sgemm_load(o3 + d + SGEMM_VL);
+
+            const float* v = V + d;
+            for (int j = 0; j < cols; j++)
+            {
+                const sgemm_vec _v0 = sgemm_load(v);
+                const sgemm_vec _v1 = sgemm_load(v + SGEMM_VL);
+                sgemm_vec _p = sgemm_set1(p0[j]);
+                _o00 = sgemm_fmadd(_p, _v0, _o00);
+                _o01 = sgemm_fmadd(_p, _v1, _o01);
+                _p = sgemm_set1(p1[j]);
+                _o10 = sgemm_fmadd(_p, _v0, _o10);
+                _o11 = sgemm_fmadd(_p, _v1, _o11);
+                _p = sgemm_set1(p2[j]);
+                _o20 = sgemm_fmadd(_p, _v0, _o20);
+                _o21 = sgemm_fmadd(_p, _v1, _o21);
+                _p = sgemm_set1(p3[j]);
+                _o30 = sgemm_fmadd(_p, _v0, _o30);
+                _o31 = sgemm_fmadd(_p, _v1, _o31);
+                v += ldv;
+            }
+
+            sgemm_store(o0 + d, _o00);
+            sgemm_store(o0 + d + SGEMM_VL, _o01);
+            sgemm_store(o1 + d, _o10);
+            sgemm_store(o1 + d + SGEMM_VL, _o11);
+            sgemm_store(o2 + d, _o20);
+            sgemm_store(o2 + d + SGEMM_VL, _o21);
+            sgemm_store(o3 + d, _o30);
+            sgemm_store(o3 + d + SGEMM_VL, _o31);
+        }
+        for (; d + SGEMM_VL <= N; d += SGEMM_VL)
+        {
+            sgemm_vec _o0 = sgemm_load(o0 + d);
+            sgemm_vec _o1 = sgemm_load(o1 + d);
+            sgemm_vec _o2 = sgemm_load(o2 + d);
+            sgemm_vec _o3 = sgemm_load(o3 + d);
+
+            const float* v = V + d;
+            for (int j = 0; j < cols; j++)
+            {
+                const sgemm_vec _v = sgemm_load(v);
+                _o0 = sgemm_fmadd(sgemm_set1(p0[j]), _v, _o0);
+                _o1 = sgemm_fmadd(sgemm_set1(p1[j]), _v, _o1);
+                _o2 = sgemm_fmadd(sgemm_set1(p2[j]), _v, _o2);
+                _o3 = sgemm_fmadd(sgemm_set1(p3[j]), _v, _o3);
+                v += ldv;
+            }
+
+            sgemm_store(o0 + d, _o0);
+            sgemm_store(o1 + d, _o1);
+            sgemm_store(o2 + d, _o2);
+            sgemm_store(o3 + d, _o3);
+        }
+        for (; d < N; d++)
+        {
+            float sum0 = o0[d];
+            float sum1 = o1[d];
+            float sum2 = o2[d];
+            float sum3 = o3[d];
+
+            const float* v = V + d;
+            for (int j = 0; j < cols; j++)
+            {
+                sum0 += p0[j] * v[0];
+                sum1 += p1[j] * v[0];
+                sum2 += p2[j] * v[0];
+                sum3 += p3[j] * v[0];
+                v += ldv;
+            }
+
+            o0[d] = sum0;
+            o1[d] = sum1;
+            o2[d] = sum2;
+            o3[d] = sum3;
+        }
+    }
+    for (; i < rows; i++)
+    {
+        const float* p0 = P + (size_t)i * attention_tile_kv;
+        float* o0 = O + (size_t)i * N;
+
+        int d = 0;
+        for (; d + SGEMM_VL <= N; d += SGEMM_VL)
+        {
+            sgemm_vec _o = sgemm_load(o0 + d);
+
+            const float* v = V + d;
+            for (int j = 0; j < cols; j++)
+            {
+                _o = sgemm_fmadd(sgemm_set1(p0[j]), sgemm_load(v), _o);
+                v += ldv;
+            }
+
+            sgemm_store(o0 + d, _o);
+        }
+        for (; d < N; d++)
+        {
+            float sum = o0[d];
+
+            const float* v = V + d;
+            for (int j = 0; j < cols; j++)
+            {
+                sum += p0[j] * v[0];
+                v += ldv;
+            }
+
+            o0[d] = sum;
+        }
+    }
+}
+
+// max of a score row, padding included, it is -inf
+static float attention_row_max(const float* s)
+{
+    sgemm_vec _max = sgemm_load(s);
+    for (int j = SGEMM_VL; j < attention_tile_kv; j += SGEMM_VL)
+    {
+        _max = mathfun_max(_max, sgemm_load(s + j));
+    }
+    return mathfun_reduce_max(_max);
+}
+
+// s = exp(s - max) over the row, returns the sum
+static float attention_row_exp(float* s, float max)
+{
+    const sgemm_vec _max = sgemm_set1(max);
+    sgemm_vec _sum = sgemm_set1(0.f);
+    for (int j = 0; j < attention_tile_kv; j += SGEMM_VL)
+    {
+        const sgemm_vec _p = mathfun_exp(sgemm_sub(sgemm_load(s + j), _max));
+        sgemm_store(s + j, _p);
+        _sum = sgemm_add(_sum, _p);
+    }
+    return mathfun_reduce_add(_sum);
+}
+
+static void attention_row_scale(float* ptr, int size, float s)
+{
+    const sgemm_vec _s = sgemm_set1(s);
+
+    int i = 0;
+    for (; i + SGEMM_VL <= size; i += SGEMM_VL)
+    {
+        sgemm_store(ptr + i, sgemm_mul(sgemm_load(ptr + i), _s));
+    }
+    for (; i < size; i++)
+    {
+        ptr[i] *= s;
+    }
+}
+
+int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    AttentionOperands a;
+    int ret = resolve_operands(bottom_blobs, top_blobs[0], a, opt);
+    if (ret != 0)
+        return ret;
+
+    const int group = a.num_heads / a.num_kv_heads;
+    const int K = a.head_dim;
+    const int N = a.v_head_dim;
+    const int q_tiles = (a.q_len + attention_tile_q - 1) / attention_tile_q;
+
+    parallel_for(opt, 0, a.num_heads * q_tiles, 1, [&](int t0, int t1) {
+        // the working set of one task, O(tile) and independent of the sequence length
+        std::vector<float> Q((size_t)attention_tile_q * K);
+        std::vector<float> Kt((size_t)K * attention_tile_kv);
+        std::vector<float> S((size_t)attention_tile_q * attention_tile_kv);
+        std::vector<float> O((size_t)attention_tile_q * N);
+        float row_max[attention_tile_q];
+        float row_sum[attention_tile_q];
+        int row_end[attention_tile_q];
+
+        for (int t = t0; t < t1; t++)
+        {
+            const int h = t / q_tiles;
+            const int i0 = (t % q_tiles) * attention_tile_q;
+            const int rows = a.q_len - i0 < attention_tile_q ? a.q_len - i0 : attention_tile_q;
+
+            const float* kptr = a.k + (h / group) * a.k_hstep;
+            const float* vptr = a.v + (h / group) * a.v_hstep;
+
+            // the query tile with the scale folded in
+            int tile_end = 0;
+            for (int i = 0; i < rows; i++)
+            {
+                const float* qptr = a.q + h * a.q_hstep + (size_t)(i0 + i) * a.q_rstep;
+                for (int k = 0; k < K; k++)
+                {
+                    Q[(size_t)i * K + k] = qptr[k] * a.scale;
+                }
+
+                row_max[i] = -INFINITY;
+                row_sum[i] = 0.f;
+                row_end[i] = kv_end(a, i0 + i);
+                if (row_end[i] > tile_end)
+                    tile_end = row_end[i];
+            }
+            memset(O.data(), 0, (size_t)rows * N * sizeof(float));
+
+            for (int j0 = 0; j0 < tile_end; j0 += attention_tile_kv)
+            {
+                const int cols = tile_end - j0 < attention_tile_kv ? tile_end - j0 : attention_tile_kv;
+
+                // keys of the tile transposed so that the scores come out along vectors
+                for (int j = 0; j < cols; j++)
+                {
+                    const float* krow = kptr + (size_t)(j0 + j) * a.k_rstep;
+                    for (int k = 0; k < K; k++)
+                    {
+                        Kt[(size_t)k * attention_tile_kv + j] = krow[k];
+                    }
+                }
+                if (cols < attention_tile_kv)
+                {
+                    for (int k = 0; k < K; k++)
+                    {
+                        memset(Kt.data() + (size_t)k * attention_tile_kv + cols, 0, (attention_tile_kv - cols) * sizeof(float));
+                    }
+                }
+
+                attention_scores(Q.data(), Kt.data(), S.data(), rows, K);
+
+                for (int i = 0; i < rows; i++)
+                {
+                    float* s = S.data() + (size_t)i * attention_tile_kv;
+
+                    if (a.mask)
+                    {
+                        const float* mptr = a.mask + h * a.mask_hstep + (size_t)(i0 + i) * a.mask_rstep + j0;
+                        for (int j = 0; j < cols; j++)
+                        {
+                            s[j] += mptr[j];
+                        }
+                    }
+
+                    // keys past the causal edge of this row and the padding of the last tile drop out
+                    const int end = row_end[i] - j0 < cols ? row_end[i] - j0 : cols;
+                    for (int j = end < 0 ? 0 : end; j < attention_tile_kv; j++)
+                    {
+                        s[j] = -INFINITY;
+                    }
+
+                    const float max = attention_row_max(s);
+                    const float new_max = max > row_max[i] ? max : row_max[i];
+                    if (new_max == -INFINITY)
+                    {
+                        // nothing visible yet, the row stays empty
+                        memset(s, 0, attention_tile_kv * sizeof(float));
+                        continue;
+                    }
+
+                    const float sum = attention_row_exp(s, new_max);
+
+                    // the max moved, what was accumulated so far is rescaled to it
+                    if (new_max != row_max[i])
+                    {
+                        const float correction = row_max[i] == -INFINITY ? 0.f : expf(row_max[i] - new_max);
+                        row_sum[i] *= correction;
+                        attention_row_scale(O.data() + (size_t)i * N, N, correction);
+                        row_max[i] = new_max;
+                    }
+                    row_sum[i] += sum;
+                }
+
+                attention_accumulate(S.data(), vptr + (size_t)j0 * a.v_rstep, a.v_rstep, O.data(), rows, cols, N);
+            }
+
+            for (int i = 0; i < rows; i++)
+            {
+                float* outptr = a.out + h * a.out_hstep + (size_t)(i0 + i) * a.out_rstep;
+                const float* optr = O.data() + (size_t)i * N;
+
+                // a row without any visible key gives zeros
+                const float r = row_sum[i] == 0.f ? 0.f : 1.f / row_sum[i];
+                for (int d = 0; d < N; d++)
+                {
+                    outptr[d] = optr[d] * r;
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(MultiHeadAttention_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,175 @@
+#ifndef LAYER_NORMALIZE_X86_H
+#define LAYER_NORMALIZE_X86_H
+
+// shared by the LayerNorm, GroupNorm and InstanceNorm x86 layers
+// the statistics take a single welford pass over the data, the affine a second one that writes it
+
+#include "sgemm_x86.h"
+
+namespace tinyinfer {
+
+// count, mean and sum of squared deviations of everything accumulated so far
+struct normalize_stat
+{
+    double n;
+    double mean;
+    double m2;
+};
+
+static inline void normalize_stat_init(normalize_stat& s)
+{
+    s.n = 0.0;
+    s.mean = 0.0;
+    s.m2 = 0.0;
+}
+
+// chan's formula, merges a partial (n, mean, m2) into s
+static inline void normalize_stat_merge(normalize_stat& s, double n, double mean, double m2)
+{
+    if (n == 0.0)
+        return;
+
+    const double total = s.n + n;
+    const double delta = mean - s.mean;
+    s.mean += delta * (n / total);
+    s.m2 += m2 + delta * delta * (s.n * n / total);
+    s.n = total;
+}
+
+// welford over one contiguous run, merged into s
+// four vector accumulators take every fourth vector, all lanes see the same count k
+// so the update step 1 / k is shared and the lanes merge without a division
+static inline void normalize_welford(const float* ptr, int size, normalize_stat& s)
+{
+    int i = 0;
+
+    if (size >= SGEMM_VL * 4)
+    {
+        const sgemm_vec _zero = sgemm_set1(0.f);
+        sgemm_vec _mean0 = _zero;
+        sgemm_vec _mean1 = _zero;
+        sgemm_vec _mean2 = _zero;
+        sgemm_vec _mean3 = _zero;
+        sgemm_vec _m20 = _zero;
+        sgemm_vec _m21 = _zero;
+        sgemm_vec _m22 = _zero;
+        sgemm_vec _m23 = _zero;
+
+        int k = 0;
+        for (; i + SGEMM_VL * 4 <= size; i += SGEMM_VL * 4)
+        {
+            k++;
+            const sgemm_vec _rk = sgemm_set1(1.f / k);
+
+            const sgemm_vec _x0 = sgemm_load(ptr + i);
+            const sgemm_vec _x1 = sgemm_load(ptr + i + SGEMM_VL);
+            const sgemm_vec _x2 = sgemm_load(ptr + i + SGEMM_VL * 2);
+            const sgemm_vec _x3 = sgemm_load(ptr + i + SGEMM_VL * 3);
+            const sgemm_vec _d0 = sgemm_sub(_x0, _mean0);
+            const sgemm_vec _d1 = sgemm_sub(_x1, _mean1);
+            const sgemm_vec _d2 = sgemm_sub(_x2, _mean2);
+            const sgemm_vec _d3 = sgemm_sub(_x3, _mean3);
+            _mean0 = sgemm_fmadd(_d0, _rk, _mean0);
+            _mean1 = sgemm_fmadd(_d1, _rk, _mean1);
+            _mean2 = sgemm_fmadd(_d2, _rk, _mean2);
+            _mean3 = sgemm_fmadd(_d3, _rk, _mean3);
+            _m20 = sgemm_fmadd(_d0, sgemm_sub(_x0, _mean0), _m20);
+            _m21 = sgemm_fmadd(_d1, sgemm_sub(_x1, _mean1), _m21);
+            _m22 = sgemm_fmadd(_d2, sgemm_sub(_x2, _mean2), _m22);
+            _m23 = sgemm_fmadd(_d3, sgemm_sub(_x3, _mean3), _m23);
+        }
+
+        float mean[SGEMM_VL * 4];
+        float m2[SGEMM_VL * 4];
+        sgemm_store(mean, _mean0);
+        sgemm_store(mean + SGEMM_VL, _mean1);
+        sgemm_store(mean + SGEMM_VL * 2, _mean2);
+        sgemm_store(mean + SGEMM_VL * 3, _mean3);
+        sgemm_store(m2, _m20);
+        sgemm_store(m2 + SGEMM_VL, _m21);
+        sgemm_store(m2 + SGEMM_VL * 2, _m22);
+        sgemm_store(m2 + SGEMM_VL * 3, _m23);
+
+        // equal counts, the mean of the lane means and the spread of the lane means weighted by k
+        double lane_mean = 0.0;
+        for (int j = 0; j < SGEMM_VL * 4; j++)
+        {
+            lane_mean += mean[j];
+        }
+        lane_mean /= SGEMM_VL * 4;
+
+        double lane_m2 = 0.0;
+        double spread = 0.0;
+        for (int j = 0; j < SGEMM_VL * 4; j++)
+        {
+            const double delta = mean[j] - lane_mean;
+            lane_m2 += m2[j];
+            spread += delta * delta;
+        }
+
+        normalize_stat_merge(s, (double)k * SGEMM_VL * 4, lane_mean, lane_m2 + spread * k);
+    }
+
+    // the tail in scalar welford, at most four vectors
+    if (i < size)
+    {
+        float mean = 0.f;
+        float m2 = 0.f;
+        int n = 0;
+        for (; i < size; i++)
+        {
+            n++;
+            const float d = ptr[i] - mean;
+            mean += d / n;
+            m2 += d * (ptr[i] - mean);
+        }
+
+        normalize_stat_merge(s, n, mean, m2);
+    }
+}
+
+// ptr = (ptr - mean) * a + b
+// centering first keeps the precision of the input when the mean is far larger than the spread
+static inline void normalize_affine(float* ptr, int size, float mean, float a, float b)
+{
+    const sgemm_vec _mean = sgemm_set1(mean);
+    const sgemm_vec _a = sgemm_set1(a);
+    const sgemm_vec _b = sgemm_set1(b);
+
+    int i = 0;
+    for (; i + SGEMM_VL * 2 <= size; i += SGEMM_VL * 2)
+    {
+        sgemm_store(ptr + i, sgemm_fmadd(sgemm_sub(sgemm_load(ptr + i), _mean), _a, _b));
+        sgemm_store(ptr + i + SGEMM_VL, sgemm_fmadd(sgemm_sub(sgemm_load(ptr + i + SGEMM_VL), _mean), _a, _b));
+    }
+    for (; i + SGEMM_VL <= size; i += SGEMM_VL)
+    {
+        sgemm_store(ptr + i, sgemm_fmadd(sgemm_sub(sgemm_load(ptr + i), _mean), _a, _b));
+    }
+    for (; i < size; i++)
+    {
+        ptr[i] = (ptr[i] - mean) * a + b;
+    }
+}
+
+// ptr = (ptr - mean) * a * gamma + beta with gamma and beta along the run
+static inline void normalize_affine(float* ptr, int size, float mean, float a, const float* gamma, const float* beta)
+{
+    const sgemm_vec _mean = sgemm_set1(mean);
+    const sgemm_vec _a = sgemm_set1(a);
+
+    int i = 0;
+    for (; i + SGEMM_VL <= size; i += SGEMM_VL)
+    {
+        const sgemm_vec _n = sgemm_mul(sgemm_sub(sgemm_load(ptr + i), _mean), _a);
+        sgemm_store(ptr + i, sgemm_fmadd(_n, sgemm_load(gamma + i), sgemm_load(beta + i)));
+    }
+    for (; i < size; i++)
+    {
+        ptr[i] = (ptr[i] - mean) * a * gamma[i] + beta[i];
+    }
+}
+
+} // namespace tinyinfer
+
+#endif // LAYER_NORMALIZE_X86_H
@@ -0,0 +1,122 @@
+#include "permute_x86.h"
+
+#include "sgemm_x86.h"
+#include "threadpool.h"
+#include <string.h>
+
+namespace tinyinfer {
+
+// edge of the square blocks a transpose is split into, 64 x 64 floats read and written stay within 32k of l1
+static const int permute_block = 64;
+
+Permute_x86::Permute_x86()
+{
+}
+
+// dst[y * dst_stride + x] = src[x * src_stride + y] for x < nx and y < ny
+static void permute_transpose_block(const float* src, size_t src_stride, float* dst, size_t dst_stride, int nx, int ny)
+{
+    int x = 0;
+    for (; x + SGEMM_VL <= nx; x += SGEMM_VL)
+    {
+        int y = 0;
+        for (; y + SGEMM_VL <= ny; y += SGEMM_VL)
+        {
+            sgemm_vec _r[SGEMM_VL];
+            for (int i = 0; i < SGEMM_VL; i++)
+            {
+                _r[i] = sgemm_load(src + (x + i) * src_stride + y);
+            }
+
+            sgemm_transpose(_r);
+
+            for (int i = 0; i < SGEMM_VL; i++)
+            {
+                sgemm_store(dst + (y + i) * dst_stride + x, _r[i]);
+            }
+        }
+        for (; y < ny; y++)
+        {
+            for (int i = 0; i < SGEMM_VL; i++)
+            {
+                dst[y * dst_stride + x + i] = src[(x + i) * src_stride + y];
+            }
+        }
+    }
+    for (; x < nx; x++)
+    {
+        for (int y = 0; y < ny; y++)
+        {
+            dst[y * dst_stride + x] = src[x * src_stride + y];
+        }
+    }
+}
+
+int Permute_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int n[4];
+    size_t s[4];
+    size_t t[4];
+    int ret = create_top_blob(bottom_blob, top_blob, n, s, t, opt);
+    if (ret != 0)
+        return ret;
+
+    const float* ptr = bottom_blob;
+    float* outptr = top_blob;
+
+    // the innermost axis stays innermost, every output row is a contiguous input row
+    if (s[0] == 1)
+    {
+        const int rows = n[3] * n[2] * n[1];
+        parallel_for(opt, 0, rows, mat_parallel_grain(n[0] * sizeof(float)), [&](int i0, int i1) {
+            for (int i = i0; i < i1; i++)
+            {
+                const int z = i / (n[2] * n[1]);
+                const int q = i / n[1] % n[2];
+                const int y = i % n[1];
+
+                memcpy(outptr + z * t[3] + q * t[2] + y * t[1], ptr + z * s[3] + q * s[2] + y * s[1], n[0] * sizeof(float));
+            }
+        });
+
+        return 0;
+    }
+
+    // the input innermost axis went to output axis p, transpose it against output axis 0 for every position of the other two
+    int p = 1;
+    while (s[p] != 1)
+        p++;
+
+    const int a = p == 1 ? 2 : 1;
+    const int b = p == 3 ? 2 : 3;
+
+    const int nx = n[0];
+    const int ny = n[p];
+    const int yblocks = (ny + permute_block - 1) / permute_block;
+
+    // each task writes its own block of output rows
+    parallel_for(opt, 0, n[b] * n[a] * yblocks, 1, [&](int i0, int i1) {
+        for (int i = i0; i < i1; i++)
+        {
+            const int zb = i / (n[a] * yblocks);
+            const int za = i / yblocks % n[a];
+            const int y = i % yblocks * permute_block;
+            const int by = std::min(ny - y, permute_block);
+
+            const float* p0 = ptr + zb * s[b] + za * s[a] + y;
+            float* outp0 = outptr + zb * t[b] + za * t[a] + y * t[p];
+
+            for (int x = 0; x < nx; x += permute_block)
+            {
+                const int bx = std::min(nx - x, permute_block);
+                permute_transpose_block(p0 + x * s[0], s[0], outp0 + x, t[p], bx, by);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Permute_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_PERMUTE_X86_H
+#define LAYER_PERMUTE_X86_H
+
+#include "permute.h"
+
+namespace tinyinfer {
+
+class Permute_x86 : public Permute
+{
+public:
+    Permute_x86();
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
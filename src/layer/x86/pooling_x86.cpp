@@ -0,0 +1,307 @@
+#include "pooling_x86.h"
+
+#include "mathfun_x86.h"
+#include "threadpool.h"
+#include <float.h>
+#include <string.h>
+
+namespace tinyinfer {
+
+Pooling_x86::Pooling_x86()
+{
+}
+
+template<int op>
+static inline sgemm_vec pooling_op(sgemm_vec _a, sgemm_vec _b)
+{
+    return op == Pooling::PoolMethod_MAX ? mathfun_max(_a, _b) : sgemm_add(_a, _b);
+}
+
+template<int op>
+static inline float pooling_op_ss(float a, float b)
+{
+    return op == Pooling::PoolMethod_MAX ? (b > a ? b : a) : a + b;
+}
+
+// max or sum of a whole channel, four accumulators to hide the add latency
+template<int op>
+static float pooling_global(const float* ptr, int size)
+{
+    const float init = op == Pooling::PoolMethod_MAX ? -FLT_MAX : 0.f;
+
+    sgemm_vec _s0 = sgemm_set1(init);
+    sgemm_vec _s1 = _s0;
+    sgemm_vec _s2 = _s0;
+    sgemm_vec _s3 = _s0;
+
+    int i = 0;
+    for (; i + SGEMM_VL * 4 <= size; i += SGEMM_VL * 4)
+    {
+        _s0 = pooling_op<op>(_s0, sgemm_load(ptr + i));
+        _s1 = pooling_op<op>(_s1, sgemm_load(ptr + i + SGEMM_VL));
+        _s2 = pooling_op<op>(_s2, sgemm_load(ptr + i + SGEMM_VL * 2));
+        _s3 = pooling_op<op>(_s3, sgemm_load(ptr + i + SGEMM_VL * 3));
+    }
+    for (; i + SGEMM_VL <= size; i += SGEMM_VL)
+    {
+        _s0 = pooling_op<op>(_s0, sgemm_load(ptr + i));
+    }
+    _s0 = pooling_op<op>(pooling_op<op>(_s0, _s1), pooling_op<op>(_s2, _s3));
+
+    float s = op == Pooling::PoolMethod_MAX ? mathfun_reduce_max(_s0) : mathfun_reduce_add(_s0);
+    for (; i < size; i++)
+    {
+        s = pooling_op_ss<op>(s, ptr[i]);
+    }
+    return s;
+}
+
+int Pooling_x86::forward_global(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int channels = bottom_blob.c;
+    const int size = bottom_blob.w * bottom_blob.h;
+
+    top_blob.create(channels, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+
+            if (pooling_type == PoolMethod_MAX)
+                top_blob[q] = pooling_global<PoolMethod_MAX>(ptr, size);
+            else
+                top_blob[q] = pooling_global<PoolMethod_AVE>(ptr, size) / size;
+        }
+    });
+
+    return 0;
+}
+
+// rows [ys, ye) of one channel reduced into the middle of the row buffer, the padding around it is left as it is
+template<int op>
+static void pooling_rows(const Mat& m, int ys, int ye, float* buf, float pad_value)
+{
+    const int w = m.w;
+
+    if (ys >= ye)
+    {
+        for (int x = 0; x < w; x++)
+            buf[x] = pad_value;
+        return;
+    }
+
+    memcpy(buf, m.row(ys), w * sizeof(float));
+
+    for (int y = ys + 1; y < ye; y++)
+    {
+        const float* sptr = m.row(y);
+
+        int x = 0;
+        for (; x + SGEMM_VL <= w; x += SGEMM_VL)
+        {
+            sgemm_store(buf + x, pooling_op<op>(sgemm_load(buf + x), sgemm_load(sptr + x)));
+        }
+        for (; x < w; x++)
+        {
+            buf[x] = pooling_op_ss<op>(buf[x], sptr[x]);
+        }
+    }
+}
+
+// one output row out of the row buffer, output j reduces buf[j * stride, j * stride + kernel)
+// stride 1 and 2 are vector loads, kernel 2 and 3 unroll at compile time
+// the last partial vector reads into the slack of the buffer and stores through a temporary
+// scale is the per column average divisor times factor, or null for max
+template<int op, int stride, int kernel>
+static void pooling_row(const float* buf, float* outptr, int outw, int _kernel, const float* scale, float factor)
+{
+    const int k = kernel ? kernel : _kernel;
+    const sgemm_vec _factor = sgemm_set1(factor);
+
+    for (int j = 0; j < outw; j += SGEMM_VL)
+    {
+        const float* p = buf + j * stride;
+
+        sgemm_vec _v = stride == 1 ? sgemm_load(p) : sgemm_load_s2(p);
+        for (int kj = 1; kj < k; kj++)
+        {
+            _v = pooling_op<op>(_v, stride == 1 ? sgemm_load(p + kj) : sgemm_load_s2(p + kj));
+        }
+
+        if (scale)
+            _v = sgemm_mul(_v, sgemm_mul(sgemm_load(scale + j), _factor));
+
+        if (j + SGEMM_VL <= outw)
+        {
+            sgemm_store(outptr + j, _v);
+        }
+        else
+        {
+            float tmp[SGEMM_VL];
+            sgemm_store(tmp, _v);
+            memcpy(outptr + j, tmp, (outw - j) * sizeof(float));
+        }
+    }
+}
+
+template<int op>
+static void pooling_row_any(const float* buf, float* outptr, int outw, int kernel, int stride, const float* scale, float factor)
+{
+    if (stride == 2 && kernel == 2)
+        return pooling_row<op, 2, 2>(buf, outptr, outw, kernel, scale, factor);
+    if (stride == 2 && kernel == 3)
+        return pooling_row<op, 2, 3>(buf, outptr, outw, kernel, scale, factor);
+    if (stride == 2)
+        return pooling_row<op, 2, 0>(buf, outptr, outw, kernel, scale, factor);
+    if (stride == 1 && kernel == 3)
+        return pooling_row<op, 1, 3>(buf, outptr, outw, kernel, scale, factor);
+    if (stride == 1)
+        return pooling_row<op, 1, 0>(buf, outptr, outw, kernel, scale, factor);
+
+    for (int j = 0; j < outw; j++)
+    {
+        const float* p = buf + j * stride;
+
+        float v = p[0];
+        for (int kj = 1; kj < kernel; kj++)
+        {
+            v = pooling_op_ss<op>(v, p[kj]);
+        }
+
+        outptr[j] = scale ? v * (scale[j] * factor) : v;
+    }
+}
+
+int Pooling_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    if (bottom_blob.dims != 3)
+        return -1;
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int channels = bottom_blob.c;
+
+    if (global_pooling)
+        return forward_global(bottom_blob, top_blob, opt);
+
+    int kw = kernel_w;
+    int kh = kernel_h;
+    int sw = stride_w;
+    int sh = stride_h;
+    int pad_l = 0;
+    int pad_r = 0;
+    int pad_t = 0;
+    int pad_b = 0;
+    int tail_r = 0;
+    int tail_b = 0;
+    if (adaptive_pooling)
+    {
+        const int outw = out_w == -233 ? w : out_w;
+        const int outh = out_h == -233 ? h : out_h;
+
+        if (outw == 1 && outh == 1)
+        {
+            int ret = forward_global(bottom_blob, top_blob, opt);
+            if (ret != 0)
+                return ret;
+
+            top_blob = top_blob.reshape(1, 1, channels, opt.blob_allocator);
+            return top_blob.empty() ? -100 : 0;
+        }
+
+        // uneven windows overlap, only the naive layer walks them
+        if (w % outw != 0 || h % outh != 0)
+            return Pooling::forward(bottom_blob, top_blob, opt);
+
+        kw = w / outw;
+        kh = h / outh;
+        sw = kw;
+        sh = kh;
+    }
+    else
+    {
+        if (resolve_padding(w, h, pad_l, pad_r, pad_t, pad_b, tail_r, tail_b) != 0)
+            return -1;
+    }
+
+    const int outw = (w + pad_l + pad_r + tail_r - kw) / sw + 1;
+    const int outh = (h + pad_t + pad_b + tail_b - kh) / sh + 1;
+
+    top_blob.create(outw, outh, channels, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const bool is_max = pooling_type == PoolMethod_MAX;
+    const float pad_value = is_max ? -FLT_MAX : 0.f;
+
+    // average divisor of every column, the row part comes in per output row
+    Mat col_scale;
+    if (!is_max)
+    {
+        col_scale.create((outw + SGEMM_VL - 1) / SGEMM_VL * SGEMM_VL, 4u, opt.workspace_allocator);
+        if (col_scale.empty())
+            return -100;
+
+        col_scale.fill(0.f);
+        for (int j = 0; j < outw; j++)
+        {
+            const int x0 = j * sw - pad_l;
+            const int x1 = x0 + kw;
+            int count;
+            if (avgpool_count_include_pad)
+                count = (x1 < w + pad_r ? x1 : w + pad_r) - x0;
+            else
+                count = (x1 < w ? x1 : w) - (x0 > 0 ? x0 : 0);
+            col_scale[j] = count > 0 ? 1.f / count : 0.f;
+        }
+    }
+
+    // padded row plus slack for the reads past the last output
+    const int bufw = pad_l + w + pad_r + tail_r + (sw + 2) * SGEMM_VL + kw;
+
+    parallel_for(opt, 0, channels * outh, 1, [&](int t0, int t1) {
+        Mat rowbuf(bufw, 4u, opt.workspace_allocator);
+        rowbuf.fill(pad_value);
+        float* buf = rowbuf;
+
+        for (int t = t0; t < t1; t++)
+        {
+            const int q = t / outh;
+            const int i = t % outh;
+
+            const Mat m = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q).row(i);
+
+            const int y0 = i * sh - pad_t;
+            const int y1 = y0 + kh;
+            const int ys = y0 > 0 ? y0 : 0;
+            const int ye = y1 < h ? y1 : h;
+
+            if (is_max)
+            {
+                pooling_rows<PoolMethod_MAX>(m, ys, ye, buf + pad_l, pad_value);
+                pooling_row_any<PoolMethod_MAX>(buf, outptr, outw, kw, sw, 0, 1.f);
+            }
+            else
+            {
+                int count;
+                if (avgpool_count_include_pad)
+                    count = (y1 < h + pad_b ? y1 : h + pad_b) - y0;
+                else
+                    count = ye - ys;
+
+                pooling_rows<PoolMethod_AVE>(m, ys, ye, buf + pad_l, pad_value);
+                pooling_row_any<PoolMethod_AVE>(buf, outptr, outw, kw, sw, col_scale, count > 0 ? 1.f / count : 0.f);
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Pooling_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,21 @@
+#ifndef LAYER_POOLING_X86_H
+#define LAYER_POOLING_X86_H
+
+#include "pooling.h"
+
+namespace tinyinfer {
+
+class Pooling_x86 : public Pooling
+{
+public:
+    Pooling_x86();
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+protected:
+    int forward_global(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
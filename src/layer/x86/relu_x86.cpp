@@ -0,0 +1,122 @@
+#include "relu_x86.h"
+
+#include "threadpool.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+namespace tinyinfer {
+
+ReLU_x86::ReLU_x86()
+{
+}
+
+int ReLU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int channels = bottom_top_blob.c;
+    const int size = bottom_top_blob.w * bottom_top_blob.h * bottom_top_blob.d * bottom_top_blob.elempack;
+
+    parallel_for(opt, 0, channels, 1, [&](int q0, int q1) {
+        for (int q = q0; q < q1; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            int i = 0;
+            if (slope == 0.f)
+            {
+    #if __SSE2__
+    #if __AVX__
+    #if __AVX512F__
+                __m512 _zero_avx512 = _mm512_setzero_ps();
+                for (; i + 15 < size; i += 16)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    _mm512_storeu_ps(ptr, _mm512_max_ps(_p, _zero_avx512));
+                    ptr += 16;
+                }
+    #endif // __AVX512F__
+                __m256 _zero_avx = _mm256_setzero_ps();
+                for (; i + 7 < size; i += 8)
+                {
+                    __m256 _p = _mm256_loadu_ps(ptr);
+                    _mm256_storeu_ps(ptr, _mm256_max_ps(_p, _zero_avx));
+                    ptr += 8;
+                }
+    #endif // __AVX__
+                __m128 _zero = _mm_setzero_ps();
+                for (; i + 3 < size; i += 4)
+                {
+                    __m128 _p = _mm_loadu_ps(ptr);
+                    _mm_storeu_ps(ptr, _mm_max_ps(_p, _zero));
+                    ptr += 4;
+                }
+    #endif // __SSE2__
+                for (; i < size; i++)
+                {
+                    *ptr = *ptr < 0.f ? 0.f : *ptr;
+                    ptr++;
+                }
+            }
+            else
+            {
+                // max(x, 0) + min(x, 0) * slope
+    #if __SSE2__
+    #if __AVX__
+    #if __AVX512F__
+                __m512 _zero_avx512 = _mm512_setzero_ps();
+                __m512 _slope_avx512 = _mm512_set1_ps(slope);
+                for (; i + 15 < size; i += 16)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    __m512 _pos = _mm512_max_ps(_p, _zero_avx512);
+                    __m512 _neg = _mm512_min_ps(_p, _zero_avx512);
+                    _mm512_storeu_ps(ptr, _mm512_fmadd_ps(_neg, _slope_avx512, _pos));
+                    ptr += 16;
+                }
+    #endif // __AVX512F__
+                __m256 _zero_avx = _mm256_setzero_ps();
+                __m256 _slope_avx = _mm256_set1_ps(slope);
+                for (; i + 7 < size; i += 8)
+                {
+                    __m256 _p = _mm256_loadu_ps(ptr);
+                    __m256 _pos = _mm256_max_ps(_p, _zero_avx);
+                    __m256 _neg = _mm256_min_ps(_p, _zero_avx);
+    #if __FMA__
+                    _mm256_storeu_ps(ptr, _mm256_fmadd_ps(_neg, _slope_avx, _pos));
+    #else
+                    _mm256_storeu_ps(ptr, _mm256_add_ps(_mm256_mul_ps(_neg, _slope_avx), _pos));
+    #endif
+                    ptr += 8;
+                }
+    #endif // __AVX__
+                __m128 _zero = _mm_setzero_ps();
+                __m128 _slope = _mm_set1_ps(slope);
+                for (; i + 3 < size; i += 4)
+                {
+                    __m128 _p = _mm_loadu_ps(ptr);
+                    __m128 _pos = _mm_max_ps(_p, _zero);
+                    __m128 _neg = _mm_min_ps(_p, _zero);
+                    _mm_storeu_ps(ptr, _mm_add_ps(_mm_mul_ps(_neg, _slope), _pos));
+                    ptr += 4;
+                }
+    #endif // __SSE2__
+                for (; i < size; i++)
+                {
+                    if (*ptr < 0.f)
+                        *ptr *= slope;
+                    ptr++;
+                }
+            }
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(ReLU_x86)
+
+} // namespace tinyinfer
@@ -0,0 +1,18 @@
+#ifndef LAYER_RELU_X86_H
+#define LAYER_RELU_X86_H
+
+#include "relu.h"
+
+namespace tinyinfer {
+
+class ReLU_x86 : public ReLU
+{
+public:
+    ReLU_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,615 @@
+#ifndef LAYER_SGEMM_X86_H
+#define LAYER_SGEMM_X86_H
+
+// cache blocked single precision gemm shared by the x86 gemm like layers
+// compiled into every isa copy of the including layer, so the tile shape follows the target flags
+//
+// both operands are packed into slivers of one register tile row or column, k blocked by SGEMM_KC
+// the micro kernel keeps an SGEMM_MR x SGEMM_NR block of C in registers while streaming one k block
+// work is split over SGEMM_MC x SGEMM_NC tiles of C, the epilogue runs while the tile is still in cache
+
+#include "fused_activation.h"
+#include "mat.h"
+#include "option.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <string.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+namespace tinyinfer {
+
+#if __AVX512F__
+typedef __m512 sgemm_vec;
+#define SGEMM_VL 16
+#define SGEMM_MR 8
+#define SGEMM_NR 32
+#elif __AVX__
+typedef __m256 sgemm_vec;
+#define SGEMM_VL 8
+#define SGEMM_MR 6
+#define SGEMM_NR 16
+#elif __SSE2__
+typedef __m128 sgemm_vec;
+#define SGEMM_VL 4
+#define SGEMM_MR 4
+#define SGEMM_NR 8
+#else
+typedef float sgemm_vec;
+#define SGEMM_VL 1
+#define SGEMM_MR 4
+#define SGEMM_NR 4
+#endif
+
+// a packed A block of SGEMM_MC rows stays in l2, one B sliver of SGEMM_KC x SGEMM_NR stays in l1
+#define SGEMM_KC 256
+#define SGEMM_MC (SGEMM_MR * 8)
+#define SGEMM_NC (SGEMM_NR * 8)
+
+static inline sgemm_vec sgemm_load(const float* ptr)
+{
+#if __AVX512F__
+    return _mm512_loadu_ps(ptr);
+#elif __AVX__
+    return _mm256_loadu_ps(ptr);
+#elif __SSE2__
+    return _mm_loadu_ps(ptr);
+#else
+    return *ptr;
+#endif
+}
+
+// every other float starting at ptr, reads 2 * SGEMM_VL floats
+static inline sgemm_vec sgemm_load_s2(const float* ptr)
+{
+#if __AVX512F__
+    const __m512i _idx = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    return _mm512_permutex2var_ps(_mm512_loadu_ps(ptr), _idx, _mm512_loadu_ps(ptr + 16));
+#elif __AVX2__
+    __m256 _t = _mm256_shuffle_ps(_mm256_loadu_ps(ptr), _mm256_loadu_ps(ptr + 8), _MM_SHUFFLE(2, 0, 2, 0));
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_t), _MM_SHUFFLE(3, 1, 2, 0)));
+#elif __AVX__
+    return _mm256_setr_ps(ptr[0], ptr[2], ptr[4], ptr[6], ptr[8], ptr[10], ptr[12], ptr[14]);
+#elif __SSE2__
+    return _mm_shuffle_ps(_mm_loadu_ps(ptr), _mm_loadu_ps(ptr + 4), _MM_SHUFFLE(2, 0, 2, 0));
+#else
+    return ptr[0];
+#endif
+}
+
+static inline void sgemm_store(float* ptr, sgemm_vec _v)
+{
+#if __AVX512F__
+    _mm512_storeu_ps(ptr, _v);
+#elif __AVX__
+    _mm256_storeu_ps(ptr, _v);
+#elif __SSE2__
+    _mm_storeu_ps(ptr, _v);
+#else
+    *ptr = _v;
+#endif
+}
+
+static inline sgemm_vec sgemm_set1(float v)
+{
+#if __AVX512F__
+    return _mm512_set1_ps(v);
+#elif __AVX__
+    return _mm256_set1_ps(v);
+#elif __SSE2__
+    return _mm_set1_ps(v);
+#else
+    return v;
+#endif
+}
+
+static inline sgemm_vec sgemm_add(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_add_ps(_a, _b);
+#elif __AVX__
+    return _mm256_add_ps(_a, _b);
+#elif __SSE2__
+    return _mm_add_ps(_a, _b);
+#else
+    return _a + _b;
+#endif
+}
+
+static inline sgemm_vec sgemm_sub(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_sub_ps(_a, _b);
+#elif __AVX__
+    return _mm256_sub_ps(_a, _b);
+#elif __SSE2__
+    return _mm_sub_ps(_a, _b);
+#else
+    return _a - _b;
+#endif
+}
+
+static inline sgemm_vec sgemm_mul(sgemm_vec _a, sgemm_vec _b)
+{
+#if __AVX512F__
+    return _mm512_mul_ps(_a, _b);
+#elif __AVX__
+    return _mm256_mul_ps(_a, _b);
+#elif __SSE2__
+    return _mm_mul_ps(_a, _b);
+#else
+    return _a * _b;
+#endif
+}
+
+// _c + _a * _b
+static inline sgemm_vec sgemm_fmadd(sgemm_vec _a, sgemm_vec _b, sgemm_vec _c)
+{
+#if __AVX512F__
+    return _mm512_fmadd_ps(_a, _b, _c);
+#elif __AVX__
+#if __FMA__
+    return _mm256_fmadd_ps(_a, _b, _c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(_a, _b), _c);
+#endif
+#elif __SSE2__
+    return _mm_add_ps(_mm_mul_ps(_a, _b), _c);
+#else
+    return _c + _a * _b;
+#endif
+}
+
+// SGEMM_VL x SGEMM_VL transpose, lane j of r[i] becomes lane i of r[j]
+static inline void sgemm_transpose(sgemm_vec* r)
+{
+#if __AVX512F__
+    __m512 _t[16];
+    for (int i = 0; i < 16; i += 2)
+    {
+        _t[i] = _mm512_unpacklo_ps(r[i], r[i + 1]);
+        _t[i + 1] = _mm512_unpackhi_ps(r[i], r[i + 1]);
+    }
+
+    // _u[4 * b + m] holds column 4 * lane + m of rows 4 * b .. 4 * b + 3
+    __m512 _u[16];
+    for (int b = 0; b < 4; b++)
+    {
+        _u[b * 4] = _mm512_shuffle_ps(_t[b * 4], _t[b * 4 + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        _u[b * 4 + 1] = _mm512_shuffle_ps(_t[b * 4], _t[b * 4 + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        _u[b * 4 + 2] = _mm512_shuffle_ps(_t[b * 4 + 1], _t[b * 4 + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        _u[b * 4 + 3] = _mm512_shuffle_ps(_t[b * 4 + 1], _t[b * 4 + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    for (int m = 0; m < 4; m++)
+    {
+        __m512 _a = _mm512_shuffle_f32x4(_u[m], _u[4 + m], _MM_SHUFFLE(2, 0, 2, 0));
+        __m512 _b = _mm512_shuffle_f32x4(_u[8 + m], _u[12 + m], _MM_SHUFFLE(2, 0, 2, 0));
+        __m512 _c = _mm512_shuffle_f32x4(_u[m], _u[4 + m], _MM_SHUFFLE(3, 1, 3, 1));
+        __m512 _d = _mm512_shuffle_f32x4(_u[8 + m], _u[12 + m], _MM_SHUFFLE(3, 1, 3, 1));
+        r[m] = _mm512_shuffle_f32x4(_a, _b, _MM_SHUFFLE(2, 0, 2, 0));
+        r[4 + m] = _mm512_shuffle_f32x4(_c, _d, _MM_SHUFFLE(2, 0, 2, 0));
+        r[8 + m] = _mm512_shuffle_f32x4(_a, _b, _MM_SHUFFLE(3, 1, 3, 1));
+        r[12 + m] = _mm512_shuffle_f32x4(_c, _d, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+#elif __AVX__
+    __m256 _t[8];
+    for (int i = 0; i < 8; i += 2)
+    {
+        _t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        _t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+
+    __m256 _u[8];
+    for (int b = 0; b < 2; b++)
+    {
+        _u[b * 4] = _mm256_shuffle_ps(_t[b * 4], _t[b * 4 + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        _u[b * 4 + 1] = _mm256_shuffle_ps(_t[b * 4], _t[b * 4 + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        _u[b * 4 + 2] = _mm256_shuffle_ps(_t[b * 4 + 1], _t[b * 4 + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        _u[b * 4 + 3] = _mm256_shuffle_ps(_t[b * 4 + 1], _t[b * 4 + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    for (int m = 0; m < 4; m++)
+    {
+        r[m] = _mm256_permute2f128_ps(_u[m], _u[4 + m], 0x20);
+        r[4 + m] = _mm256_permute2f128_ps(_u[m], _u[4 + m], 0x31);
+    }
+#elif __SSE2__
+    _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+#else
+    (void)r;
+#endif
+}
+
+// what happens to the A * B tile before it is left in C
+struct sgemm_epilogue
+{
+    float alpha;
+
+    // beta * bias, 0=none 1=scalar 2=per row 3=per column 4=full matrix with ldbias
+    float beta;
+    int bias_type;
+    const float* bias;
+    int ldbias;
+
+    int activation_type;
+    const float* activation_params;
+};
+
+static inline sgemm_epilogue sgemm_epilogue_default()
+{
+    sgemm_epilogue ep;
+    ep.alpha = 1.f;
+    ep.beta = 1.f;
+    ep.bias_type = 0;
+    ep.bias = 0;
+    ep.ldbias = 0;
+    ep.activation_type = 0;
+    ep.activation_params = 0;
+    return ep;
+}
+
+// floats needed to pack rows x K into slivers of R rows
+static inline size_t sgemm_packed_size(int rows, int K, int R)
+{
+    return (size_t)((rows + R - 1) / R) * R * K;
+}
+
+// pack X(r, k) into slivers of R rows, zero padding the last one
+// X(r, k) = k_major ? X[k * ld + r] : X[r * ld + k]
+// layout is [k block][sliver][k][r], so one k block of one sliver is a contiguous kc x R panel
+static inline void sgemm_pack(const float* X, int ld, int k_major, int rows, int K, int R, float* packed, const Option& opt)
+{
+    const int slivers = (rows + R - 1) / R;
+    const size_t rows_padded = (size_t)slivers * R;
+
+    parallel_for(opt, 0, slivers, 1, [&](int s0, int s1) {
+        for (int k0 = 0; k0 < K; k0 += SGEMM_KC)
+        {
+            const int kc = std::min(SGEMM_KC, K - k0);
+
+            for (int s = s0; s < s1; s++)
+            {
+                float* pp = packed + k0 * rows_padded + (size_t)s * kc * R;
+
+                const int r0 = s * R;
+                const int rn = std::min(R, rows - r0);
+
+                if (k_major)
+                {
+                    for (int k = 0; k < kc; k++)
+                    {
+                        const float* ptr = X + (size_t)(k0 + k) * ld + r0;
+                        for (int r = 0; r < rn; r++)
+                        {
+                            pp[r] = ptr[r];
+                        }
+                        for (int r = rn; r < R; r++)
+                        {
+                            pp[r] = 0.f;
+                        }
+                        pp += R;
+                    }
+                }
+                else
+                {
+                    for (int r = 0; r < rn; r++)
+                    {
+                        const float* ptr = X + (size_t)(r0 + r) * ld + k0;
+                        for (int k = 0; k < kc; k++)
+                        {
+                            pp[k * R + r] = ptr[k];
+                        }
+                    }
+                    for (int r = rn; r < R; r++)
+                    {
+                        for (int k = 0; k < kc; k++)
+                        {
+                            pp[k * R + r] = 0.f;
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+// position of X(r, k) inside a buffer laid out by sgemm_pack, for producers that write packed data directly
+static inline size_t sgemm_packed_offset(int r, int k, int rows, int K, int R)
+{
+    const int k0 = k / SGEMM_KC * SGEMM_KC;
+    const int kc = std::min(SGEMM_KC, K - k0);
+    const size_t rows_padded = sgemm_packed_size(rows, 1, R);
+    return k0 * rows_padded + (size_t)(r / R) * kc * R + (k - k0) * R + r % R;
+}
+
+// A(m, k) = transA ? A[k * lda + m] : A[m * lda + k]
+static inline int sgemm_pack_A(const float* A, int lda, int transA, int M, int K, Mat& packedA, const Option& opt)
+{
+    const size_t size = sgemm_packed_size(M, K, SGEMM_MR);
+    if (size == 0)
+        return 0;
+
+    packedA.create((int)size, 4u, opt.workspace_allocator);
+    if (packedA.empty())
+        return -100;
+
+    sgemm_pack(A, lda, transA, M, K, SGEMM_MR, packedA, opt);
+    return 0;
+}
+
+// B(k, n) = transB ? B[n * ldb + k] : B[k * ldb + n]
+static inline int sgemm_pack_B(const float* B, int ldb, int transB, int N, int K, Mat& packedB, const Option& opt)
+{
+    const size_t size = sgemm_packed_size(N, K, SGEMM_NR);
+    if (size == 0)
+        return 0;
+
+    packedB.create((int)size, 4u, opt.workspace_allocator);
+    if (packedB.empty())
+        return -100;
+
+    sgemm_pack(B, ldb, !transB, N, K, SGEMM_NR, packedB, opt);
+    return 0;
+}
+
+// C[mr x nr] (+)= one kc x SGEMM_MR panel of A times one kc x SGEMM_NR panel of B
+static inline void sgemm_kernel(int kc, const float* pA, const float* pB, float* C, int ldc, int mr, int nr, bool accumulate)
+{
+    const int NV = SGEMM_NR / SGEMM_VL;
+
+    if (mr == 1)
+    {
+        // a single row, gemv against the panel without wasting the other SGEMM_MR - 1 lanes
+        sgemm_vec _sum[NV];
+        for (int v = 0; v < NV; v++)
+        {
+            _sum[v] = sgemm_set1(0.f);
+        }
+
+        for (int k = 0; k < kc; k++)
+        {
+            sgemm_vec _a = sgemm_set1(pA[0]);
+            for (int v = 0; v < NV; v++)
+            {
+                _sum[v] = sgemm_fmadd(_a, sgemm_load(pB + v * SGEMM_VL), _sum[v]);
+            }
+            pA += SGEMM_MR;
+            pB += SGEMM_NR;
+        }
+
+        if (nr == SGEMM_NR)
+        {
+            for (int v = 0; v < NV; v++)
+            {
+                sgemm_vec _c = accumulate ? sgemm_add(_sum[v], sgemm_load(C + v * SGEMM_VL)) : _sum[v];
+                sgemm_store(C + v * SGEMM_VL, _c);
+            }
+            return;
+        }
+
+        float tmp[SGEMM_NR];
+        for (int v = 0; v < NV; v++)
+        {
+            sgemm_store(tmp + v * SGEMM_VL, _sum[v]);
+        }
+        for (int j = 0; j < nr; j++)
+        {
+            C[j] = accumulate ? C[j] + tmp[j] : tmp[j];
+        }
+        return;
+    }
+
+    sgemm_vec _sum[SGEMM_MR][NV];
+    for (int r = 0; r < SGEMM_MR; r++)
+    {
+        for (int v = 0; v < NV; v++)
+        {
+            _sum[r][v] = sgemm_set1(0.f);
+        }
+    }
+
+    for (int k = 0; k < kc; k++)
+    {
+        sgemm_vec _b[NV];
+        for (int v = 0; v < NV; v++)
+        {
+            _b[v] = sgemm_load(pB + v * SGEMM_VL);
+        }
+
+        for (int r = 0; r < SGEMM_MR; r++)
+        {
+            sgemm_vec _a = sgemm_set1(pA[r]);
+            for (int v = 0; v < NV; v++)
+            {
+                _sum[r][v] = sgemm_fmadd(_a, _b[v], _sum[r][v]);
+            }
+        }
+
+        pA += SGEMM_MR;
+        pB += SGEMM_NR;
+    }
+
+    if (mr == SGEMM_MR && nr == SGEMM_NR)
+    {
+        for (int r = 0; r < SGEMM_MR; r++)
+        {
+            float* ptr = C + (size_t)r * ldc;
+            for (int v = 0; v < NV; v++)
+            {
+                sgemm_vec _c = accumulate ? sgemm_add(_sum[r][v], sgemm_load(ptr + v * SGEMM_VL)) : _sum[r][v];
+                sgemm_store(ptr + v * SGEMM_VL, _c);
+            }
+        }
+        return;
+    }
+
+    // edge tile, spill the registers and copy the valid part
+    float tmp[SGEMM_MR * SGEMM_NR];
+    for (int r = 0; r < SGEMM_MR; r++)
+    {
+        for (int v = 0; v < NV; v++)
+        {
+            sgemm_store(tmp + r * SGEMM_NR + v * SGEMM_VL, _sum[r][v]);
+        }
+    }
+    for (int r = 0; r < mr; r++)
+    {
+        float* ptr = C + (size_t)r * ldc;
+        const float* tptr = tmp + r * SGEMM_NR;
+        for (int j = 0; j < nr; j++)
+        {
+            ptr[j] = accumulate ? ptr[j] + tptr[j] : tptr[j];
+        }
+    }
+}
+
+// alpha, bias and activation over the finished rows [m0, m0 + mr) and columns [n0, n0 + nr)
+static inline void sgemm_epilogue_tile(float* C, int ldc, int m0, int n0, int mr, int nr, const sgemm_epilogue& ep)
+{
+    for (int i = m0; i < m0 + mr; i++)
+    {
+        float* ptr = C + (size_t)i * ldc + n0;
+
+        if (ep.alpha != 1.f)
+        {
+            for (int j = 0; j < nr; j++)
+            {
+                ptr[j] *= ep.alpha;
+            }
+        }
+
+        if (ep.bias_type == 1 || ep.bias_type == 2)
+        {
+            const float b = ep.beta * ep.bias[ep.bias_type == 1 ? 0 : i];
+            for (int j = 0; j < nr; j++)
+            {
+                ptr[j] += b;
+            }
+        }
+        if (ep.bias_type == 3 || ep.bias_type == 4)
+        {
+            const float* bptr = ep.bias + n0 + (ep.bias_type == 4 ? (size_t)i * ep.ldbias : 0);
+            if (ep.beta == 1.f)
+            {
+                for (int j = 0; j < nr; j++)
+                {
+                    ptr[j] += bptr[j];
+                }
+            }
+            else
+            {
+                for (int j = 0; j < nr; j++)
+                {
+                    ptr[j] += ep.beta * bptr[j];
+                }
+            }
+        }
+
+        activation_inplace(ptr, nr, ep.activation_type, ep.activation_params);
+    }
+}
+
+// C(M x N, ldc) = epilogue(packedA * packedB)
+static inline void sgemm_packed(int M, int N, int K, const float* packedA, const float* packedB, float* C, int ldc, const sgemm_epilogue& ep, const Option& opt)
+{
+    if (K == 0)
+    {
+        // nothing to multiply, the epilogue still sees a zero product
+        for (int i = 0; i < M; i++)
+        {
+            memset(C + (size_t)i * ldc, 0, N * sizeof(float));
+        }
+        sgemm_epilogue_tile(C, ldc, 0, 0, M, N, ep);
+        return;
+    }
+
+    const size_t M_padded = sgemm_packed_size(M, 1, SGEMM_MR);
+    const size_t N_padded = sgemm_packed_size(N, 1, SGEMM_NR);
+
+    const int mtiles = (M + SGEMM_MC - 1) / SGEMM_MC;
+
+    // narrow the column tiles when there are too few tiles to keep every thread busy
+    int nc = SGEMM_NC;
+    while (nc > SGEMM_NR && mtiles * ((N + nc - 1) / nc) < opt.num_threads * 2)
+        nc /= 2;
+
+    const int ntiles = (N + nc - 1) / nc;
+
+    parallel_for(opt, 0, mtiles * ntiles, 1, [&](int t0, int t1) {
+        for (int t = t0; t < t1; t++)
+        {
+            const int mstart = (t / ntiles) * SGEMM_MC;
+            const int mend = std::min(mstart + SGEMM_MC, M);
+            const int nstart = (t % ntiles) * nc;
+            const int nend = std::min(nstart + nc, N);
+
+            for (int k0 = 0; k0 < K; k0 += SGEMM_KC)
+            {
+                const int kc = std::min(SGEMM_KC, K - k0);
+
+                for (int n0 = nstart; n0 < nend; n0 += SGEMM_NR)
+                {
+                    const int nr = std::min(SGEMM_NR, nend - n0);
+                    const float* pB = packedB + k0 * N_padded + (size_t)n0 * kc;
+
+                    for (int m0 = mstart; m0 < mend; m0 += SGEMM_MR)
+                    {
+                        const int mr = std::min(SGEMM_MR, mend - m0);
+                        const float* pA = packedA + k0 * M_padded + (size_t)m0 * kc;
+
+                        sgemm_kernel(kc, pA, pB, C + (size_t)m0 * ldc + n0, ldc, mr, nr, k0 != 0);
+                    }
+                }
+            }
+
+            sgemm_epilogue_tile(C, ldc, mstart, nstart, mend - mstart, nend - nstart, ep);
+        }
+    });
+}
+
+// B packed ahead of time, typically constant weights
+static inline int sgemm_packed_B(int M, int N, int K, const float* A, int lda, int transA, const Mat& packedB, float* C, int ldc, const sgemm_epilogue& ep, const Option& opt)
+{
+    Mat packedA;
+    int ret = sgemm_pack_A(A, lda, transA, M, K, packedA, opt);
+    if (ret != 0)
+        return ret;
+
+    sgemm_packed(M, N, K, packedA, packedB, C, ldc, ep, opt);
+    return 0;
+}
+
+// A packed ahead of time, typically constant weights
+static inline int sgemm_packed_A(int M, int N, int K, const Mat& packedA, const float* B, int ldb, int transB, float* C, int ldc, const sgemm_epilogue& ep, const Option& opt)
+{
+    Mat packedB;
+    int ret = sgemm_pack_B(B, ldb, transB, N, K, packedB, opt);
+    if (ret != 0)
+        return ret;
+
+    sgemm_packed(M, N, K, packedA, packedB, C, ldc, ep, opt);
+    return 0;
+}
+
+// C(M x N, ldc) = epilogue(A * B)
+// A(m, k) = transA ? A[k * lda + m] : A[m * lda + k], B(k, n) = transB ? B[n * ldb + k] : B[k * ldb + n]
+static inline int sgemm(int M, int N, int K, const float* A, int lda, int transA, const float* B, int ldb, int transB, float* C, int ldc, const sgemm_epilogue& ep, const Option& opt)
+{
+    Mat packedB;
+    int ret = sgemm_pack_B(B, ldb, transB, N, K, packedB, opt);
+    if (ret != 0)
+        return ret;
+
+    return sgemm_packed_B(M, N, K, A, lda, transA, packedB, C, ldc, ep, opt);
+}
+
+} // namespace tinyinfer
+
+#endif // LAYER_SGEMM_X86_H
@@ -0,0 +1,23 @@
+#include "sigmoid_x86.h"
+
+#include "x86_activation.h"
+
+namespace tinyinfer {
+
+Sigmoid_x86::Sigmoid_x86()
+{
+}
+
+int Sigmoid_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    if (opt.use_fast_activation)
+        mathfun_inplace(bottom_top_blob, [](sgemm_vec _x) { return activation_sigmoid_fast(_x); }, opt);
+    else
+        mathfun_inplace(bottom_top_blob, [](sgemm_vec _x) { return activation_sigmoid(_x); }, opt);
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Sigmoid_x86)
+
+} // namespace tinyinfer
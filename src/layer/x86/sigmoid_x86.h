@@ -0,0 +1,18 @@
+#ifndef LAYER_SIGMOID_X86_H
+#define LAYER_SIGMOID_X86_H
+
+#include "sigmoid.h"
+
+namespace tinyinfer {
+
+class Sigmoid_x86 : public Sigmoid
+{
+public:
+    Sigmoid_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
@@ -0,0 +1,371 @@
+#include "softmax_x86.h"
+
+#include "mathfun_x86.h"
+#include "threadpool.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+namespace tinyinfer {
+
+// chunk of the online softmax, 32k of floats stay in the l1 or l2 cache between the passes over a chunk
+static const int softmax_chunk = 8192;
+
+// one thread takes the online softmax for rows of 8mb and more, shorter rows still come from l2 or l3
+// and the exp keeps both compute bound, there the plain two-pass softmax is a few percent faster
+static const int softmax_online_row_min = 1 << 21;
+
+Softmax_x86::Softmax_x86()
+{
+}
+
+// the last n < SGEMM_VL elements as a full vector, the missing lanes are -inf so they drop out of max and sum
+static inline sgemm_vec softmax_load_tail(const float* ptr, int n)
+{
+    float tmp[SGEMM_VL];
+    for (int i = 0; i < SGEMM_VL; i++)
+    {
+        tmp[i] = i < n ? ptr[i] : -INFINITY;
+    }
+    return sgemm_load(tmp);
+}
+
+static inline void softmax_store_tail(float* ptr, sgemm_vec _v, int n)
+{
+    float tmp[SGEMM_VL];
+    sgemm_store(tmp, _v);
+    memcpy(ptr, tmp, n * sizeof(float));
+}
+
+// exp(x - max) with the rounding error of the subtraction handed to exp as a low part
+// a gap of 16 between the logits would otherwise cost up to 8 ulp, it is the largest error term of the whole softmax
+// below -104 the result is 0 and the error is dropped, that keeps masked -inf lanes out of nan
+static inline sgemm_vec softmax_exp_sub(sgemm_vec _x, sgemm_vec _max)
+{
+    const sgemm_vec _d = sgemm_sub(_x, _max);
+    const sgemm_vec _t = sgemm_sub(_d, _x);
+    sgemm_vec _lo = sgemm_sub(sgemm_sub(_x, sgemm_sub(_d, _t)), sgemm_add(_max, _t));
+    _lo = mathfun_select(mathfun_cmplt(_d, sgemm_set1(-104.f)), sgemm_set1(0.f), _lo);
+
+    return mathfun_exp_split(mathfun_max(sgemm_set1(-128.f), _d), _lo);
+}
+
+// max, then exp(x - max) stored over the row and summed
+static void softmax_exp_sum(float* ptr, int n, float& max, float& sum)
+{
+    sgemm_vec _m0 = sgemm_set1(-FLT_MAX);
+    sgemm_vec _m1 = _m0;
+    sgemm_vec _m2 = _m0;
+    sgemm_vec _m3 = _m0;
+
+    int i = 0;
+    for (; i + SGEMM_VL * 4 <= n; i += SGEMM_VL * 4)
+    {
+        _m0 = mathfun_max(_m0, sgemm_load(ptr + i));
+        _m1 = mathfun_max(_m1, sgemm_load(ptr + i + SGEMM_VL));
+        _m2 = mathfun_max(_m2, sgemm_load(ptr + i + SGEMM_VL * 2));
+        _m3 = mathfun_max(_m3, sgemm_load(ptr + i + SGEMM_VL * 3));
+    }
+    for (; i + SGEMM_VL <= n; i += SGEMM_VL)
+    {
+        _m0 = mathfun_max(_m0, sgemm_load(ptr + i));
+    }
+    if (i < n)
+    {
+        _m1 = mathfun_max(_m1, softmax_load_tail(ptr + i, n - i));
+    }
+
+    max = mathfun_reduce_max(mathfun_max(mathfun_max(_m0, _m1), mathfun_max(_m2, _m3)));
+    const sgemm_vec _max = sgemm_set1(max);
+
+    // four vector sums over blocks of 4096, the block totals add up in double
+    // so the rounding of the sum stays that of a short row however long the row is
+    double total = 0.0;
+    for (int b = 0; b < n; b += 4096)
+    {
+        float* p = ptr + b;
+        const int len = n - b < 4096 ? n - b : 4096;
+
+        sgemm_vec _s0 = sgemm_set1(0.f);
+        sgemm_vec _s1 = _s0;
+        sgemm_vec _s2 = _s0;
+        sgemm_vec _s3 = _s0;
+
+        i = 0;
+        for (; i + SGEMM_VL * 4 <= len; i += SGEMM_VL * 4)
+        {
+            sgemm_vec _e0 = softmax_exp_sub(sgemm_load(p + i), _max);
+            sgemm_vec _e1 = softmax_exp_sub(sgemm_load(p + i + SGEMM_VL), _max);
+            sgemm_vec _e2 = softmax_exp_sub(sgemm_load(p + i + SGEMM_VL * 2), _max);
+            sgemm_vec _e3 = softmax_exp_sub(sgemm_load(p + i + SGEMM_VL * 3), _max);
+            sgemm_store(p + i, _e0);
+            sgemm_store(p + i + SGEMM_VL, _e1);
+            sgemm_store(p + i + SGEMM_VL * 2, _e2);
+            sgemm_store(p + i + SGEMM_VL * 3, _e3);
+            _s0 = sgemm_add(_s0, _e0);
+            _s1 = sgemm_add(_s1, _e1);
+            _s2 = sgemm_add(_s2, _e2);
+            _s3 = sgemm_add(_s3, _e3);
+        }
+        for (; i + SGEMM_VL <= len; i += SGEMM_VL)
+        {
+            sgemm_vec _e = softmax_exp_sub(sgemm_load(p + i), _max);
+            sgemm_store(p + i, _e);
+            _s0 = sgemm_add(_s0, _e);
+        }
+        if (i < len)
+        {
+            sgemm_vec _e = softmax_exp_sub(softmax_load_tail(p + i, len - i), _max);
+            softmax_store_tail(p + i, _e, len - i);
+            _s1 = sgemm_add(_s1, _e);
+        }
+
+        total += mathfun_reduce_add(sgemm_add(sgemm_add(_s0, _s1), sgemm_add(_s2, _s3)));
+    }
+
+    sum = (float)total;
+}
+
+static void softmax_scale(float* ptr, int n, float scale)
+{
+    const sgemm_vec _scale = sgemm_set1(scale);
+
+    int i = 0;
+    for (; i + SGEMM_VL <= n; i += SGEMM_VL)
+    {
+        sgemm_store(ptr + i, sgemm_mul(sgemm_load(ptr + i), _scale));
+    }
+    for (; i < n; i++)
+    {
+        ptr[i] *= scale;
+    }
+}
+
+// the two passes of softmax_exp_sum find the row in cache, the scaling multiplies by the reciprocal of the sum
+static void softmax_row(float* ptr, int n)
+{
+    float max;
+    float sum;
+    softmax_exp_sum(ptr, n, max, sum);
+    softmax_scale(ptr, n, 1.f / sum);
+}
+
+// online softmax over chunks of a long row
+// every chunk is left holding exp(x - chunk max) with its own (max, sum), the row sum is the chunk sums
+// rescaled by exp(chunk max - max), and a last pass multiplies each chunk by exp(chunk max - max) / sum
+// one exp per element and two walks over the row in memory, the chunk is still cached for its second pass
+// rescaling per element would read the row once less but takes two exps per element, which costs more than the read
+static int softmax_chunk_count(int n)
+{
+    return (n + softmax_chunk - 1) / softmax_chunk;
+}
+
+static int softmax_chunk_size(int n, int i)
+{
+    return n - i * softmax_chunk < softmax_chunk ? n - i * softmax_chunk : softmax_chunk;
+}
+
+// the (max, sum) pairs turned into the scale of every chunk, in double so the rescaling adds no error
+static void softmax_chunk_merge(float* stats, int chunks)
+{
+    double max = -FLT_MAX;
+    for (int i = 0; i < chunks; i++)
+    {
+        max = stats[i * 2] > max ? stats[i * 2] : max;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < chunks; i++)
+    {
+        sum += stats[i * 2 + 1] * exp(stats[i * 2] - max);
+    }
+
+    for (int i = 0; i < chunks; i++)
+    {
+        stats[i * 2] = (float)(exp(stats[i * 2] - max) / sum);
+    }
+}
+
+static void softmax_row_online(float* ptr, int n, float* stats)
+{
+    const int chunks = softmax_chunk_count(n);
+
+    for (int i = 0; i < chunks; i++)
+    {
+        softmax_exp_sum(ptr + i * softmax_chunk, softmax_chunk_size(n, i), stats[i * 2], stats[i * 2 + 1]);
+    }
+
+    softmax_chunk_merge(stats, chunks);
+
+    for (int i = 0; i < chunks; i++)
+    {
+        softmax_scale(ptr + i * softmax_chunk, softmax_chunk_size(n, i), stats[i * 2]);
+    }
+}
+
+// width adjacent softmaxes along a strided axis, one lane per column
+// the max and the sum live in buffers of width rounded up to SGEMM_VL and the n rows are walked three times
+static void softmax_cols(float* ptr, int n, size_t stride, int width, float* maxptr, float* sumptr)
+{
+    const int widthr = (width + SGEMM_VL - 1) / SGEMM_VL * SGEMM_VL;
+
+    for (int j = 0; j < widthr; j++)
+    {
+        maxptr[j] = j < width ? ptr[j] : 0.f;
+        sumptr[j] = 0.f;
+    }
+
+    for (int k = 1; k < n; k++)
+    {
+        const float* p = ptr + k * stride;
+
+        int j = 0;
+        for (; j + SGEMM_VL <= width; j += SGEMM_VL)
+        {
+            sgemm_store(maxptr + j, mathfun_max(sgemm_load(maxptr + j), sgemm_load(p + j)));
+        }
+        for (; j < width; j++)
+        {
+            maxptr[j] = p[j] > maxptr[j] ? p[j] : maxptr[j];
+        }
+    }
+
+    for (int k = 0; k < n; k++)
+    {
+        float* p = ptr + k * stride;
+
+        int j = 0;
+        for (; j + SGEMM_VL <= width; j += SGEMM_VL)
+        {
+            sgemm_vec _e = softmax_exp_sub(sgemm_load(p + j), sgemm_load(maxptr + j));
+            sgemm_store(p + j, _e);
+            sgemm_store(sumptr + j, sgemm_add(sgemm_load(sumptr + j), _e));
+        }
+        if (j < width)
+        {
+            sgemm_vec _e = softmax_exp_sub(softmax_load_tail(p + j, width - j), sgemm_load(maxptr + j));
+            softmax_store_tail(p + j, _e, width - j);
+            sgemm_store(sumptr + j, sgemm_add(sgemm_load(sumptr + j), _e));
+        }
+    }
+
+    const sgemm_vec _one = sgemm_set1(1.f);
+    for (int j = 0; j < widthr; j += SGEMM_VL)
+    {
+        sgemm_store(sumptr + j, mathfun_div(_one, sgemm_load(sumptr + j)));
+    }
+
+    for (int k = 0; k < n; k++)
+    {
+        float* p = ptr + k * stride;
+
+        int j = 0;
+        for (; j + SGEMM_VL <= width; j += SGEMM_VL)
+        {
+            sgemm_store(p + j, sgemm_mul(sgemm_load(p + j), sgemm_load(sumptr + j)));
+        }
+        for (; j < width; j++)
+        {
+            p[j] *= sumptr[j];
+        }
+    }
+}
+
+int Softmax_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    int channels, outer, n, inner;
+    size_t stride;
+    if (resolve_axis(bottom_top_blob, channels, outer, n, inner, stride) != 0)
+        return -1;
+
+    const int groups = channels * outer;
+
+    if (inner == 1 && stride == 1)
+    {
+        // fewer rows than threads, the chunks of every long row go to the threads
+        if (groups < opt.num_threads && n >= softmax_chunk * 2)
+        {
+            const int chunks = softmax_chunk_count(n);
+
+            Mat stats(chunks * 2, 4u, opt.workspace_allocator);
+            if (stats.empty())
+                return -100;
+
+            for (int t = 0; t < groups; t++)
+            {
+                float* ptr = (float*)bottom_top_blob.channel(t / outer) + (size_t)(t % outer) * n;
+
+                parallel_for(opt, 0, chunks, 1, [&](int i0, int i1) {
+                    for (int i = i0; i < i1; i++)
+                    {
+                        softmax_exp_sum(ptr + i * softmax_chunk, softmax_chunk_size(n, i), stats[i * 2], stats[i * 2 + 1]);
+                    }
+                });
+
+                softmax_chunk_merge(stats, chunks);
+
+                parallel_for(opt, 0, chunks, 1, [&](int i0, int i1) {
+                    for (int i = i0; i < i1; i++)
+                    {
+                        softmax_scale(ptr + i * softmax_chunk, softmax_chunk_size(n, i), stats[i * 2]);
+                    }
+                });
+            }
+
+            return 0;
+        }
+
+        // short rows are batched into tasks of about 16k floats
+        const int grain = n < 16384 ? 16384 / n : 1;
+
+        parallel_for(opt, 0, groups, grain, [&](int t0, int t1) {
+            Mat stats;
+            if (n >= softmax_online_row_min)
+                stats.create(softmax_chunk_count(n) * 2, 4u, opt.workspace_allocator);
+
+            for (int t = t0; t < t1; t++)
+            {
+                float* ptr = (float*)bottom_top_blob.channel(t / outer) + (size_t)(t % outer) * n;
+
+                if (n >= softmax_online_row_min)
+                    softmax_row_online(ptr, n, stats);
+                else
+                    softmax_row(ptr, n);
+            }
+        });
+
+        return 0;
+    }
+
+    // column blocks whose n rows take about 16k floats, so the three walks over them hit the cache
+    int block = 16384 / n / SGEMM_VL * SGEMM_VL;
+    if (block < SGEMM_VL)
+        block = SGEMM_VL;
+    if (block > inner)
+        block = inner;
+    const int blocks = (inner + block - 1) / block;
+    const int blockr = (block + SGEMM_VL - 1) / SGEMM_VL * SGEMM_VL;
+
+    parallel_for(opt, 0, groups * blocks, 1, [&](int t0, int t1) {
+        Mat buf(blockr * 2, 4u, opt.workspace_allocator);
+        float* maxptr = buf;
+        float* sumptr = maxptr + blockr;
+
+        for (int t = t0; t < t1; t++)
+        {
+            const int g = t / blocks;
+            const int b = t % blocks;
+
+            float* ptr = (float*)bottom_top_blob.channel(g / outer) + (size_t)(g % outer) * n * stride + b * block;
+            const int width = inner - b * block < block ? inner - b * block : block;
+
+            softmax_cols(ptr, n, stride, width, maxptr, sumptr);
+        }
+    });
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(Softmax_x86)
+
+} // namespace tinyinfer
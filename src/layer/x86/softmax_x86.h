@@ -0,0 +1,18 @@
+#ifndef LAYER_SOFTMAX_X86_H
+#define LAYER_SOFTMAX_X86_H
+
+#include "softmax.h"
+
+namespace tinyinfer {
+
+class Softmax_x86 : public Softmax
+{
+public:
+    Softmax_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
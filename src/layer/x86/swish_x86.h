@@ -0,0 +1,18 @@
+#ifndef LAYER_SWISH_X86_H
+#define LAYER_SWISH_X86_H
+
+#include "swish.h"
+
+namespace tinyinfer {
+
+class Swish_x86 : public Swish
+{
+public:
+    Swish_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
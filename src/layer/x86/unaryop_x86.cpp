@@ -0,0 +1,140 @@
+#include "unaryop_x86.h"
+
+#include "mathfun_x86.h"
+
+namespace tinyinfer {
+
+UnaryOp_x86::UnaryOp_x86()
+{
+}
+
+template<int op_type>
+static inline sgemm_vec unaryop_vec(sgemm_vec _x)
+{
+    switch (op_type)
+    {
+    case UnaryOp::Operation_ABS:
+        return mathfun_abs(_x);
+    case UnaryOp::Operation_NEG:
+        return mathfun_neg(_x);
+    case UnaryOp::Operation_FLOOR:
+        return mathfun_floor(_x);
+    case UnaryOp::Operation_CEIL:
+        return mathfun_ceil(_x);
+    case UnaryOp::Operation_SQUARE:
+        return sgemm_mul(_x, _x);
+    case UnaryOp::Operation_SQRT:
+        return mathfun_sqrt(_x);
+    case UnaryOp::Operation_RSQRT:
+        return mathfun_div(sgemm_set1(1.f), mathfun_sqrt(_x));
+    case UnaryOp::Operation_EXP:
+        return mathfun_exp(_x);
+    case UnaryOp::Operation_LOG:
+        return mathfun_log(_x);
+    case UnaryOp::Operation_SIN:
+        return mathfun_sin(_x);
+    case UnaryOp::Operation_COS:
+        return mathfun_cos(_x);
+    case UnaryOp::Operation_TAN:
+        return mathfun_tan(_x);
+    case UnaryOp::Operation_ASIN:
+        return mathfun_asin(_x);
+    case UnaryOp::Operation_ACOS:
+        return mathfun_acos(_x);
+    case UnaryOp::Operation_ATAN:
+        return mathfun_atan(_x);
+    case UnaryOp::Operation_RECIPROCAL:
+        return mathfun_div(sgemm_set1(1.f), _x);
+    case UnaryOp::Operation_TANH:
+        return mathfun_tanh(_x);
+    case UnaryOp::Operation_LOG10:
+        return sgemm_mul(mathfun_log(_x), sgemm_set1(0.434294481903251828f));
+    case UnaryOp::Operation_ROUND:
+        return mathfun_round(_x);
+    case UnaryOp::Operation_TRUNC:
+        return mathfun_trunc(_x);
+    default:
+        return _x;
+    }
+}
+
+template<int op_type>
+static void unaryop_forward(Mat& m, const Option& opt)
+{
+    mathfun_inplace(m, [](sgemm_vec _x) { return unaryop_vec<op_type>(_x); }, opt);
+}
+
+int UnaryOp_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    switch (op_type)
+    {
+    case Operation_ABS:
+        unaryop_forward<Operation_ABS>(bottom_top_blob, opt);
+        break;
+    case Operation_NEG:
+        unaryop_forward<Operation_NEG>(bottom_top_blob, opt);
+        break;
+    case Operation_FLOOR:
+        unaryop_forward<Operation_FLOOR>(bottom_top_blob, opt);
+        break;
+    case Operation_CEIL:
+        unaryop_forward<Operation_CEIL>(bottom_top_blob, opt);
+        break;
+    case Operation_SQUARE:
+        unaryop_forward<Operation_SQUARE>(bottom_top_blob, opt);
+        break;
+    case Operation_SQRT:
+        unaryop_forward<Operation_SQRT>(bottom_top_blob, opt);
+        break;
+    case Operation_RSQRT:
+        unaryop_forward<Operation_RSQRT>(bottom_top_blob, opt);
+        break;
+    case Operation_EXP:
+        unaryop_forward<Operation_EXP>(bottom_top_blob, opt);
+        break;
+    case Operation_LOG:
+        unaryop_forward<Operation_LOG>(bottom_top_blob, opt);
+        break;
+    case Operation_SIN:
+        unaryop_forward<Operation_SIN>(bottom_top_blob, opt);
+        break;
+    case Operation_COS:
+        unaryop_forward<Operation_COS>(bottom_top_blob, opt);
+        break;
+    case Operation_TAN:
+        unaryop_forward<Operation_TAN>(bottom_top_blob, opt);
+        break;
+    case Operation_ASIN:
+        unaryop_forward<Operation_ASIN>(bottom_top_blob, opt);
+        break;
+    case Operation_ACOS:
+        unaryop_forward<Operation_ACOS>(bottom_top_blob, opt);
+        break;
+    case Operation_ATAN:
+        unaryop_forward<Operation_ATAN>(bottom_top_blob, opt);
+        break;
+    case Operation_RECIPROCAL:
+        unaryop_forward<Operation_RECIPROCAL>(bottom_top_blob, opt);
+        break;
+    case Operation_TANH:
+        unaryop_forward<Operation_TANH>(bottom_top_blob, opt);
+        break;
+    case Operation_LOG10:
+        unaryop_forward<Operation_LOG10>(bottom_top_blob, opt);
+        break;
+    case Operation_ROUND:
+        unaryop_forward<Operation_ROUND>(bottom_top_blob, opt);
+        break;
+    case Operation_TRUNC:
+        unaryop_forward<Operation_TRUNC>(bottom_top_blob, opt);
+        break;
+    default:
+        return -1;
+    }
+
+    return 0;
+}
+
+DEFINE_LAYER_CREATOR(UnaryOp_x86)
+
+} // namespace tinyinfer
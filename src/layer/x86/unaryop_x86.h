@@ -0,0 +1,18 @@
+#ifndef LAYER_UNARYOP_X86_H
+#define LAYER_UNARYOP_X86_H
+
+#include "unaryop.h"
+
+namespace tinyinfer {
+
+class UnaryOp_x86 : public UnaryOp
+{
+public:
+    UnaryOp_x86();
+
+    virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+};
+
+} // namespace tinyinfer
+
+#endif
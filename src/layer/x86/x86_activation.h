@@ -0,0 +1,113 @@
+#ifndef LAYER_X86_ACTIVATION_H
+#define LAYER_X86_ACTIVATION_H
+
+// vector activations for the x86 activation layers, on the mathfun_x86.h lane type
+// sigmoid, swish and gelu come in an exact form within a few ulp of the true value
+// and a _fast form on mathfun_exp_fast and mathfun_rcp_fast, picked by Option::use_fast_activation
+
+#include "mathfun_x86.h"
+
+namespace tinyinfer {
+
+// 1 / (1 + exp(-x)), exp(-|x|) never overflows so the negative side keeps its tiny results
+static inline sgemm_vec activation_sigmoid(sgemm_vec _x)
+{
+    const sgemm_vec _e = mathfun_exp(mathfun_neg(mathfun_abs(_x)));
+    const sgemm_vec _r = mathfun_div(sgemm_set1(1.f), sgemm_add(_e, sgemm_set1(1.f)));
+    return mathfun_select(mathfun_cmplt(_x, sgemm_set1(0.f)), sgemm_mul(_e, _r), _r);
+}
+
+static inline sgemm_vec activation_sigmoid_fast(sgemm_vec _x)
+{
+    return mathfun_rcp_fast(sgemm_add(mathfun_exp_fast(mathfun_neg(_x)), sgemm_set1(1.f)));
+}
+
+static inline sgemm_vec activation_swish(sgemm_vec _x)
+{
+    return sgemm_mul(_x, activation_sigmoid(_x));
+}
+
+static inline sgemm_vec activation_swish_fast(sgemm_vec _x)
+{
+    return sgemm_mul(_x, activation_sigmoid_fast(_x));
+}
+
+// min(max(alpha * x + beta, 0), 1)
+static inline sgemm_vec activation_hardsigmoid(sgemm_vec _x, sgemm_vec _alpha, sgemm_vec _beta)
+{
+    return mathfun_min(sgemm_set1(1.f), mathfun_max(sgemm_set1(0.f), sgemm_fmadd(_x, _alpha, _beta)));
+}
+
+static inline sgemm_vec activation_hardswish(sgemm_vec _x, sgemm_vec _alpha, sgemm_vec _beta)
+{
+    return sgemm_mul(_x, activation_hardsigmoid(_x, _alpha, _beta));
+}
+
+static inline sgemm_vec activation_clip(sgemm_vec _x, sgemm_vec _min, sgemm_vec _max)
+{
+    return mathfun_min(_max, mathfun_max(_min, _x));
+}
+
+// alpha * (exp(x) - 1) below 0, expm1 keeps the relative accuracy of small negative x
+// there is no fast form, exp(x) - 1 cancels near 0 and the reduction is the same cost
+static inline sgemm_vec activation_elu(sgemm_vec _x, sgemm_vec _alpha)
+{
+    const sgemm_vec _zero = sgemm_set1(0.f);
+    return mathfun_select(mathfun_cmplt(_x, _zero), sgemm_mul(_alpha, mathfun_expm1(mathfun_min(_zero, _x))), _x);
+}
+
+// x * Phi(x) with the normal cdf Phi(-a) = erfc(a / sqrt(2)) / 2 for a = |x|
+// erfc(z) = t * exp(-z^2 + q(t)), t = 1 / (1 + z / 2), the chebyshev fit of numerical recipes with fractional error below 1.2e-7
+// -z^2 = -a^2 / 2 goes into exp as an exact hi + lo pair, its rounding would cost up to 100 ulp in the far negative tail
+static inline sgemm_vec activation_gelu(sgemm_vec _x)
+{
+    static const float p[10] = {1.7087277e-1f, -8.2215223e-1f, 1.48851587f, -1.13520398f, 2.7886807e-1f, -1.8628806e-1f, 9.678418e-2f, 3.7409196e-1f, 1.00002368f, -1.26551223f};
+
+    // erfc is 0 in float long before 15 / sqrt(2)
+    const sgemm_vec _a = mathfun_min(sgemm_set1(15.f), mathfun_abs(_x));
+
+    const sgemm_vec _z = sgemm_mul(_a, sgemm_set1(0.707106781186547524f));
+    const sgemm_vec _t = mathfun_div(sgemm_set1(1.f), sgemm_fmadd(_z, sgemm_set1(0.5f), sgemm_set1(1.f)));
+    const sgemm_vec _q = mathfun_polynomial<10>(_t, p);
+
+    const sgemm_vec _a2 = sgemm_mul(_a, _a);
+    const sgemm_vec _a2e = mathfun_mul_error(_a, _a, _a2);
+    const sgemm_vec _hi = sgemm_mul(_a2, sgemm_set1(-0.5f));
+    const sgemm_vec _lo = sgemm_fmadd(_a2e, sgemm_set1(-0.5f), _q);
+
+    const sgemm_vec _phi = sgemm_mul(sgemm_mul(_t, mathfun_exp_split(_hi, _lo)), sgemm_set1(0.5f));
+    return sgemm_mul(_x, mathfun_select(mathfun_cmplt(_x, sgemm_set1(0.f)), _phi, sgemm_sub(sgemm_set1(1.f), _phi)));
+}
+
+// erfc from abramowitz and stegun 7.1.26, absolute error below 1.5e-7
+static inline sgemm_vec activation_gelu_fast(sgemm_vec _x)
+{
+    static const float p[5] = {1.061405429f, -1.453152027f, 1.421413741f, -0.284496736f, 0.254829592f};
+
+    const sgemm_vec _a = mathfun_min(sgemm_set1(15.f), mathfun_abs(_x));
+
+    const sgemm_vec _z = sgemm_mul(_a, sgemm_set1(0.707106781186547524f));
+    const sgemm_vec _t = mathfun_rcp_fast(sgemm_fmadd(_z, sgemm_set1(0.3275911f), sgemm_set1(1.f)));
+    const sgemm_vec _e = mathfun_exp_fast(sgemm_mul(sgemm_mul(_a, _a), sgemm_set1(-0.5f)));
+
+    const sgemm_vec _phi = sgemm_mul(sgemm_mul(sgemm_mul(mathfun_polynomial<5>(_t, p), _t), _e), sgemm_set1(0.5f));
+    return sgemm_mul(_x, mathfun_select(mathfun_cmplt(_x, sgemm_set1(0.f)), _phi, sgemm_sub(sgemm_set1(1.f), _phi)));
+}
+
+// 0.5 * x * (1 + tanh(u)) = x * sigmoid(2 u), u = sqrt(2 / pi) * (x + 0.044715 * x^3)
+// the sigmoid form does not cancel on the negative side the way 1 + tanh does
+static inline sgemm_vec activation_gelu_tanh(sgemm_vec _x)
+{
+    const sgemm_vec _u2 = sgemm_mul(_x, sgemm_fmadd(sgemm_mul(_x, _x), sgemm_set1(0.0713548162726008f), sgemm_set1(1.59576912160573f)));
+    return sgemm_mul(_x, activation_sigmoid(_u2));
+}
+
+static inline sgemm_vec activation_gelu_tanh_fast(sgemm_vec _x)
+{
+    const sgemm_vec _u2 = sgemm_mul(_x, sgemm_fmadd(sgemm_mul(_x, _x), sgemm_set1(0.0713548162726008f), sgemm_set1(1.59576912160573f)));
+    return sgemm_mul(_x, activation_sigmoid_fast(_u2));
+}
+
+} // namespace tinyinfer
+
+#endif
@@ -1,9 +1,55 @@
 #include "common.h"
 #include "mat.h"
 #include "string.h"
+#include "threadpool.h"
+#include <algorithm>
 
 namespace tinyinfer {
 
+// large copies are split across the default pool, small ones stay on the caller
+static void parallel_memcpy(void* dst, const void* src, size_t size)
+{
+    const size_t block = TINYINFER_MAT_PARALLEL_BYTES;
+    if (size < block * 2)
+    {
+        memcpy(dst, src, size);
+        return;
+    }
+
+    const int block_count = (int)((size + block - 1) / block);
+    get_default_threadpool()->parallel_for(0, block_count, 1, [&](int b0, int b1) {
+        size_t offset = block * b0;
+        size_t len = std::min(block * b1, size) - offset;
+        memcpy((unsigned char*)dst + offset, (const unsigned char*)src + offset, len);
+    });
+}
+
+static std::atomic<size_t> g_mat_copy_bytes(0);
+
+void add_mat_copy_bytes(size_t bytes)
+{
+    g_mat_copy_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+size_t get_mat_copy_bytes()
+{
+    return g_mat_copy_bytes.load(std::memory_order_relaxed);
+}
+
+void reset_mat_copy_bytes()
+{
+    g_mat_copy_bytes.store(0, std::memory_order_relaxed);
+}
+
+// create keeps the data of a matching blob nobody else references, a view of external memory or the only reference
+// so a producer handed a slice of a larger blob writes straight into it
+static bool mat_reusable(const Mat& m, int dims, int w, int h, int d, int c, size_t cstep, size_t elemsize, int elempack, Allocator* allocator)
+{
+    return m.data && (!m.refcount || *m.refcount == 1)
+           && m.dims == dims && m.w == w && m.h == h && m.d == d && m.c == c && m.cstep == cstep
+           && m.elemsize == elemsize && m.elempack == elempack && m.allocator == allocator;
+}
+
 Mat Mat::clone(Allocator* _allocator) const
 {
     if (empty())
@@ -21,15 +67,19 @@ Mat Mat::clone(Allocator* _allocator) const
 
     if (total() > 0)
     {
+        add_mat_copy_bytes((size_t)w * h * d * c * elemsize);
+
         if (cstep == m.cstep)
-            memcpy(m.data, data, total() * elemsize);
+            parallel_memcpy(m.data, data, total() * elemsize);
         else
         {
             size_t size = (size_t) w * h * d * elemsize;
-            for (int i = 0; i < c; i++)
-            {
-                memcpy(m.channel(i), channel(i), size);
-            }
+            get_default_threadpool()->parallel_for(0, c, mat_parallel_grain(size), [&](int q0, int q1) {
+                for (int i = q0; i < q1; i++)
+                {
+                    memcpy(m.channel(i), channel(i), size);
+                }
+            });
         }
     }
     
@@ -43,26 +93,29 @@ void Mat::clone_from(const Mat& mat, Allocator* _allocator)
 
 void Mat::create(int _w, size_t _elemsize, Allocator* _allocator)
 {
-    create(_w, _elemsize, 0, _allocator);
+    create(_w, _elemsize, 1, _allocator);
 }
 
 void Mat::create(int _w, int _h, size_t _elemsize, Allocator* _allocator)
 {
-    create(_w, _h, _elemsize, 0, _allocator);
+    create(_w, _h, _elemsize, 1, _allocator);
 }
 
 void Mat::create(int _w, int _h, int _c, size_t _elemsize, Allocator* _allocator)
 {
-    create(_w, _h, _c, _elemsize, 0, _allocator);
+    create(_w, _h, _c, _elemsize, 1, _allocator);
 }
 
 void Mat::create(int _w, int _h, int _d, int _c, size_t _elemsize, Allocator* _allocator)
 {
-    create(_w, _h, _d, _c, _elemsize, 0, _allocator);
+    create(_w, _h, _d, _c, _elemsize, 1, _allocator);
 }
 
 void Mat::create(int _w, size_t _elemsize, int _elempack, Allocator* _allocator)
 {
+    if (mat_reusable(*this, 1, _w, 1, 1, 1, _w, _elemsize, _elempack, _allocator))
+        return;
+
     release();
 
     elemsize = _elemsize;
@@ -96,6 +149,9 @@ void Mat::create(int _w, size_t _elemsize, int _elempack, Allocator* _allocator)
 
 void Mat::create(int _w, int _h, size_t _elemsize, int _elempack, Allocator* _allocator)
 {
+    if (mat_reusable(*this, 2, _w, _h, 1, 1, (size_t)_w * _h, _elemsize, _elempack, _allocator))
+        return;
+
     release();
 
     elemsize = _elemsize;
@@ -129,6 +185,9 @@ void Mat::create(int _w, int _h, size_t _elemsize, int _elempack, Allocator* _al
 
 void Mat::create(int _w, int _h, int _c, size_t _elemsize, int _elempack, Allocator* _allocator)
 {
+    if (_elemsize && mat_reusable(*this, 3, _w, _h, 1, _c, alignSize((size_t)_w * _h * _elemsize, 16) / _elemsize, _elemsize, _elempack, _allocator))
+        return;
+
     release();
 
     elemsize = _elemsize;
@@ -162,6 +221,9 @@ void Mat::create(int _w, int _h, int _c, size_t _elemsize, int _elempack, Alloca
 
 void Mat::create(int _w, int _h, int _d, int _c, size_t _elemsize, int _elempack, Allocator* _allocator)
 {
+    if (_elemsize && mat_reusable(*this, 4, _w, _h, _d, _c, alignSize((size_t)_w * _h * _d * _elemsize, 16) / _elemsize, _elemsize, _elempack, _allocator))
+        return;
+
     release();
 
     elemsize = _elemsize;
@@ -234,144 +296,105 @@ bool Mat::empty() const
 /**
  * reshape
 */
-Mat Mat::reshape(int _w, Allocator* _allocator) const
+// copy in flat element order between two channel layouts, either side may pad its channels
+static void reshape_copy(const Mat& src, Mat& dst)
 {
-    if (w * h * d * c != _w)
-        return Mat();
-    
-    if (dims >= 3 && cstep != (size_t) w * h * d)
-    {
-        Mat m;
-        m.create(_w, elemsize, elempack, _allocator);
-        for (int i = 0; i < c; i++)
-        {
-            const void* ptr = (unsigned char*)data + i * cstep * elemsize;
-            void* mptr = (unsigned char*)m.data + (size_t)i * w * h * d * elemsize;
-            memcpy(mptr, ptr,  (size_t)w * h * d * elemsize);
-        }
-        
-        return m;
-    }
+    const size_t src_plane = (size_t)src.w * src.h * src.d;
+    const size_t dst_plane = (size_t)dst.w * dst.h * dst.d;
+    const size_t elemsize = src.elemsize;
 
-    Mat m = *this;
-    m.dims = 1;
-    m.w = _w;
-    m.h = 1;
-    m.d = 1;
-    m.c = 1;
-    m.cstep = _w;
-    
-    return m;
-}
+    size_t remain = src_plane * src.c;
+    add_mat_copy_bytes(remain * elemsize);
 
-Mat Mat::reshape(int _w, int _h, Allocator* _allocator) const
-{
-    if (w * h * d * c != _w * _h)
-        return Mat();
-    
-    if (dims >= 3 && cstep != (size_t) w * h * d)
+    int sq = 0;
+    int dq = 0;
+    size_t si = 0;
+    size_t di = 0;
+    while (remain > 0)
     {
-        Mat m;
-        m.create(_w, _h, elemsize, elempack, _allocator);
-        for (int i = 0; i < c; i++)
+        const size_t n = std::min(src_plane - si, dst_plane - di);
+        memcpy((unsigned char*)dst.data + (dq * dst.cstep + di) * elemsize, (const unsigned char*)src.data + (sq * src.cstep + si) * elemsize, n * elemsize);
+
+        remain -= n;
+        si += n;
+        di += n;
+        if (si == src_plane)
         {
-            const void* ptr = (unsigned char*)data + i * cstep * elemsize;
-            void* mptr = (unsigned char*)m.data + (size_t)i * w * h * d * elemsize;
-            memcpy(mptr, ptr,  (size_t)w * h * d * elemsize);
+            sq++;
+            si = 0;
         }
-        
-        return m;
-    }
-
-    Mat m = *this;
-    m.dims = 1;
-    m.w = _w;
-    m.h = _h;
-    m.d = 1;
-    m.c = 1;
-    m.cstep = (size_t)_w * _h;
-    
-    return m;
-}
-
-Mat Mat::reshape(int _w, int _h, int _c, Allocator* _allocator) const
-{
-    if (w * h * d * c != _w * _h * _c)
-        return Mat();
-    
-    if (dims < 3)
-    {
-        if ((size_t)_w * _h != alignSize((size_t)_w * _h * elemsize, 16) / elemsize)
+        if (di == dst_plane)
         {
-            Mat m;
-            m.create(_w, _h, _c, elemsize, elempack, _allocator);
-            for (int i = 0; i < _c; i++)
-            {
-                const void* ptr = (unsigned char*)data + (size_t)i * _w * _h * elemsize;
-                void* mptr = (unsigned char*)m.data + i * m.cstep * m.elemsize;
-                memcpy(mptr, ptr,  (size_t)_w * _h * elemsize);
-            }
-            return m;
+            dq++;
+            di = 0;
         }
     }
-    else if (c != _c)
-    {
-        Mat tmp = reshape(_w * _h * _c, _allocator);
-        return tmp.reshape(_w, _h, _c, _allocator);
-    }
-
-    Mat m = *this;
-    m.dims = 3;
-    m.w = _w;
-    m.h = _h;
-    m.d = 1;
-    m.c = _c;
-    m.cstep = alignSize((size_t)_w * _h * elemsize, 16) / elemsize;
-    
-    return m;
 }
 
-Mat Mat::reshape(int _w, int _h, int _d, int _c, Allocator* _allocator) const
+// a view whenever the new channels line up with the old ones, a copy only when the channel padding moves
+static Mat reshape_to(const Mat& m, int dims, int _w, int _h, int _d, int _c, Allocator* _allocator)
 {
-    if (w * h * d * c != _w * _h * _d * _c)
+    if ((size_t)m.w * m.h * m.d * m.c != (size_t)_w * _h * _d * _c)
         return Mat();
 
-    if (dims < 3)
-    {
-        if ((size_t)_w * _h * _d != alignSize((size_t)_w * _h * _d * elemsize, 16) / elemsize)
-        {
-            Mat m;
-            m.create(_w, _h, _d, _c, elemsize, elempack, _allocator);
+    const size_t plane = (size_t)_w * _h * _d;
+    const size_t aligned_plane = dims >= 3 ? alignSize(plane * m.elemsize, 16) / m.elemsize : plane;
 
-            // align channel
-            for (int i = 0; i < _c; i++)
-            {
-                const void* ptr = (unsigned char*)data + (size_t)i * _w * _h * _d * elemsize;
-                void* mptr = (unsigned char*)m.data + i * m.cstep * m.elemsize;
-                memcpy(mptr, ptr, (size_t)_w * _h * _d * elemsize);
-            }
+    // no padding between the channels, a single channel never has any
+    const bool contiguous = m.c == 1 || m.cstep == (size_t)m.w * m.h * m.d;
 
-            return m;
-        }
-    }
-    else if (c != _c)
+    size_t cstep = 0;
+    if (contiguous && (_c == 1 || plane == aligned_plane))
+        cstep = plane;
+    else if (m.dims >= 3 && _c == m.c && plane == (size_t)m.w * m.h * m.d)
+        cstep = m.cstep;
+
+    if (cstep == 0)
     {
-        // flatten and then align
-        Mat tmp = reshape(_w * _h * _d * _c, _allocator);
-        return tmp.reshape(_w, _h, _d, _c, _allocator);
+        Mat r;
+        if (dims == 1)
+            r.create(_w, m.elemsize, m.elempack, _allocator);
+        else if (dims == 2)
+            r.create(_w, _h, m.elemsize, m.elempack, _allocator);
+        else if (dims == 3)
+            r.create(_w, _h, _c, m.elemsize, m.elempack, _allocator);
+        else
+            r.create(_w, _h, _d, _c, m.elemsize, m.elempack, _allocator);
+        if (r.empty())
+            return r;
+
+        reshape_copy(m, r);
+        return r;
     }
 
-    Mat m = *this;
+    Mat r = m;
+    r.dims = dims;
+    r.w = _w;
+    r.h = _h;
+    r.d = _d;
+    r.c = _c;
+    r.cstep = cstep;
+    return r;
+}
 
-    m.dims = 4;
-    m.w = _w;
-    m.h = _h;
-    m.d = _d;
-    m.c = _c;
+Mat Mat::reshape(int _w, Allocator* _allocator) const
+{
+    return reshape_to(*this, 1, _w, 1, 1, 1, _allocator);
+}
 
-    m.cstep = alignSize((size_t)_w * _h * _d * elemsize, 16) / elemsize;
+Mat Mat::reshape(int _w, int _h, Allocator* _allocator) const
+{
+    return reshape_to(*this, 2, _w, _h, 1, 1, _allocator);
+}
 
-    return m;
+Mat Mat::reshape(int _w, int _h, int _c, Allocator* _allocator) const
+{
+    return reshape_to(*this, 3, _w, _h, 1, _c, _allocator);
+}
+
+Mat Mat::reshape(int _w, int _h, int _d, int _c, Allocator* _allocator) const
+{
+    return reshape_to(*this, 4, _w, _h, _d, _c, _allocator);
 }
 
 /**
@@ -413,7 +436,7 @@ float* Mat::row(int y)
 
 Mat Mat::row_range(int y, int rows)
 {
-    return Mat(w, rows, (unsigned char*)data + (size_t)w * y * elemsize);
+    return Mat(w, rows, (unsigned char*)data + (size_t)w * y * elemsize, elemsize, elempack, allocator);
 }
 
 const Mat Mat::channel(int c) const
@@ -451,7 +474,7 @@ const float* Mat::row(int y) const
 
 const Mat Mat::row_range(int y, int rows) const
 {
-    return Mat(w, rows, (unsigned char*)data + (size_t)w * y * elemsize);
+    return Mat(w, rows, (unsigned char*)data + (size_t)w * y * elemsize, elemsize, elempack, allocator);
 }
 
 float& Mat::operator[](size_t i)
@@ -464,4 +487,262 @@ const float& Mat::operator[](size_t i) const
     return ((const float*)data)[i];
 }
 
+/**
+ * copy make border
+*/
+// source index of position i along an axis of n after the border, -1 for a constant border
+static int border_index(int i, int n, int type)
+{
+    if (i >= 0 && i < n)
+        return i;
+
+    if (type == 0)
+        return -1;
+
+    if (type == 1 || n == 1)
+        return i < 0 ? 0 : n - 1;
+
+    // reflect about the first and last element, folding again for pads wider than the axis
+    const int period = 2 * n - 2;
+    i = i % period;
+    if (i < 0)
+        i += period;
+    return i < n ? i : period - i;
+}
+
+static void border_row(const float* ptr, int w, int left, int right, int type, float v, float* outptr)
+{
+    for (int x = 0; x < left; x++)
+    {
+        const int sx = border_index(x - left, w, type);
+        outptr[x] = sx < 0 ? v : ptr[sx];
+    }
+
+    memcpy(outptr + left, ptr, w * sizeof(float));
+
+    for (int x = 0; x < right; x++)
+    {
+        const int sx = border_index(w + x, w, type);
+        outptr[left + w + x] = sx < 0 ? v : ptr[sx];
+    }
+}
+
+static void border_plane(const float* ptr, int w, int h, int top, int bottom, int left, int right, int type, float v, float* outptr)
+{
+    const int outw = w + left + right;
+    const int outh = h + top + bottom;
+
+    for (int y = 0; y < outh; y++)
+    {
+        const int sy = border_index(y - top, h, type);
+        float* outrow = outptr + (size_t)outw * y;
+
+        if (sy < 0)
+        {
+            std::fill(outrow, outrow + outw, v);
+            continue;
+        }
+
+        border_row(ptr + (size_t)w * sy, w, left, right, type, v, outrow);
+    }
+}
+
+void copy_make_border(const Mat& src, Mat& dst, int top, int bottom, int left, int right, int type, float v, const Option& opt)
+{
+    copy_make_border_3d(src, dst, top, bottom, left, right, 0, 0, type, v, opt);
+}
+
+void copy_make_border_3d(const Mat& src, Mat& dst, int top, int bottom, int left, int right, int front, int behind, int type, float v, const Option& opt)
+{
+    if (top == 0 && bottom == 0 && left == 0 && right == 0 && front == 0 && behind == 0)
+    {
+        dst = src;
+        return;
+    }
+
+    const int dims = src.dims;
+    const int w = src.w;
+    const int h = src.h;
+    const int outw = w + left + right;
+    const int outh = h + top + bottom;
+
+    if (dims == 1)
+    {
+        dst.create(outw, src.elemsize, opt.blob_allocator);
+        if (dst.empty())
+            return;
+
+        border_row(src, w, left, right, type, v, dst);
+        return;
+    }
+
+    if (dims == 2)
+    {
+        dst.create(outw, outh, src.elemsize, opt.blob_allocator);
+        if (dst.empty())
+            return;
+
+        border_plane(src, w, h, top, bottom, left, right, type, v, dst);
+        return;
+    }
+
+    // planes along c for dims 3 and along d within each channel for dims 4
+    const int planes = dims == 3 ? src.c : src.d;
+    const int outplanes = planes + front + behind;
+    const int channels = dims == 3 ? 1 : src.c;
+
+    if (dims == 3)
+        dst.create(outw, outh, outplanes, src.elemsize, opt.blob_allocator);
+    else
+        dst.create(outw, outh, outplanes, src.c, src.elemsize, opt.blob_allocator);
+    if (dst.empty())
+        return;
+
+    const size_t plane_size = (size_t)w * h;
+    const size_t outplane_size = (size_t)outw * outh;
+    const size_t src_stride = dims == 3 ? src.cstep : plane_size;
+    const size_t dst_stride = dims == 3 ? dst.cstep : outplane_size;
+
+    parallel_for(opt, 0, channels * outplanes, mat_parallel_grain(outplane_size * sizeof(float)), [&](int i0, int i1) {
+        for (int i = i0; i < i1; i++)
+        {
+            const int q = i / outplanes;
+            const int z = i % outplanes;
+            const int sz = border_index(z - front, planes, type);
+
+            float* outptr = (float*)dst.channel(q) + dst_stride * z;
+
+            if (sz < 0)
+            {
+                std::fill(outptr, outptr + outplane_size, v);
+                continue;
+            }
+
+            const float* ptr = (const float*)src.channel(q) + src_stride * sz;
+            border_plane(ptr, w, h, top, bottom, left, right, type, v, outptr);
+        }
+    });
+}
+
+/**
+ * fp16 conversion
+*/
+unsigned short float32_to_float16(float value)
+{
+    // 1 : 8 : 23
+    union
+    {
+        unsigned int u;
+        float f;
+    } tmp;
+
+    tmp.f = value;
+
+    unsigned short sign = (tmp.u & 0x80000000) >> 31;
+    unsigned short exponent = (tmp.u & 0x7F800000) >> 23;
+    unsigned int significand = tmp.u & 0x7FFFFF;
+
+    // 1 : 5 : 10
+    unsigned short fp16;
+    if (exponent == 0)
+    {
+        // zero or float32 denormal, always underflow
+        fp16 = (sign << 15);
+    }
+    else if (exponent == 0xFF)
+    {
+        // infinity or NaN
+        fp16 = (sign << 15) | (0x1F << 10) | (significand ? 0x200 : 0x00);
+    }
+    else
+    {
+        int newexp = exponent + (-127 + 15);
+        if (newexp >= 31)
+        {
+            // overflow, return infinity
+            fp16 = (sign << 15) | (0x1F << 10);
+        }
+        else if (newexp <= 0)
+        {
+            if (newexp >= -10)
+            {
+                // denormal half-precision
+                unsigned int sig = significand | 0x800000;
+                int shift = 14 - newexp;
+                unsigned int half = sig >> shift;
+                unsigned int rem = sig & ((1u << shift) - 1);
+                unsigned int halfway = 1u << (shift - 1);
+                if (rem > halfway || (rem == halfway && (half & 1)))
+                    half++;
+                fp16 = (sign << 15) | half;
+            }
+            else
+            {
+                // underflow
+                fp16 = (sign << 15);
+            }
+        }
+        else
+        {
+            unsigned int half = ((unsigned int)newexp << 10) | (significand >> 13);
+            unsigned int rem = significand & 0x1FFF;
+            // a carry out of the mantissa bumps the exponent, up to infinity
+            if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+                half++;
+            fp16 = (sign << 15) | half;
+        }
+    }
+
+    return fp16;
+}
+
+float float16_to_float32(unsigned short value)
+{
+    // 1 : 5 : 10
+    unsigned short sign = (value & 0x8000) >> 15;
+    unsigned short exponent = (value & 0x7c00) >> 10;
+    unsigned short significand = value & 0x03FF;
+
+    // 1 : 8 : 23
+    union
+    {
+        unsigned int u;
+        float f;
+    } tmp;
+
+    if (exponent == 0)
+    {
+        if (significand == 0)
+        {
+            // zero
+            tmp.u = (sign << 31);
+        }
+        else
+        {
+            // denormal, normalize it
+            exponent = 0;
+            while ((significand & 0x200) == 0)
+            {
+                significand <<= 1;
+                exponent++;
+            }
+            significand <<= 1;
+            significand &= 0x3FF;
+            tmp.u = (sign << 31) | ((-exponent + (-15 + 127)) << 23) | (significand << 13);
+        }
+    }
+    else if (exponent == 0x1F)
+    {
+        // infinity or NaN
+        tmp.u = (sign << 31) | (0xFF << 23) | (significand << 13);
+    }
+    else
+    {
+        // normalized
+        tmp.u = (sign << 31) | ((exponent + (-15 + 127)) << 23) | (significand << 13);
+    }
+
+    return tmp.f;
+}
+
 } // namespace tinyinfer
\ No newline at end of file
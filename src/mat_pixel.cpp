@@ -1,140 +1,122 @@
 #include "mat.h"
 #include "common.h"
+#include "threadpool.h"
+#include <algorithm>
 
 namespace tinyinfer {
 
+#define SATURATE_CAST_UCHAR(X) (unsigned char)::std::min(::std::max((int)(X), 0), 255);
+
+// rows are converted in parallel once an image is large enough
+static int pixel_rows_grain(int w, int cn)
+{
+    return mat_parallel_grain((size_t)w * cn * sizeof(float));
+}
+
 static int from_rgb(const unsigned char* rgb, int w, int h, int stride, Mat& m, Allocator* allocator)
 {
     m.create(w, h, 3, 4u, allocator);
     if (m.empty())
         return -1;
 
-    const int wgap = stride - w * 3;
-    if (wgap == 0)
-    {
-        w = w * h;
-        h = 1;
-    }
-
     float* ptr0 = m.channel(0);
     float* ptr1 = m.channel(1);
     float* ptr2 = m.channel(2);
 
-    for (int y = 0; y < h; y++)
-    {
-        int remain = w;
-        for (; remain > 0; remain--)
+    get_default_threadpool()->parallel_for(0, h, pixel_rows_grain(w, 3), [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
         {
-            *ptr0 = rgb[0];
-            *ptr1 = rgb[1];
-            *ptr2 = rgb[2];
-
-            rgb += 3;
-            ptr0++;
-            ptr1++;
-            ptr2++; 
+            const unsigned char* p = rgb + (size_t)stride * y;
+            float* outptr0 = ptr0 + (size_t)w * y;
+            float* outptr1 = ptr1 + (size_t)w * y;
+            float* outptr2 = ptr2 + (size_t)w * y;
+
+            for (int x = 0; x < w; x++)
+            {
+                outptr0[x] = p[0];
+                outptr1[x] = p[1];
+                outptr2[x] = p[2];
+
+                p += 3;
+            }
         }
-        rgb += wgap;
-    }
+    });
+
     return 0;
 }
 
 static void to_rgb(const Mat& m, unsigned char* rgb, int stride)
 {
-    int w = m.w;
-    int h = m.h;
-
-    const int wgap = stride - w * 3;
-    if (wgap == 0)
-    {
-        w = w * h;
-        h = 1;
-    }
+    const int w = m.w;
+    const int h = m.h;
 
     const float* ptr0 = m.channel(0);
     const float* ptr1 = m.channel(1);
     const float* ptr2 = m.channel(2);
 
-    for (int y = 0; y < h; y++)
-    {
-#define SATURATE_CAST_UCHAR(X) (unsigned char)::std::min(::std::max((int)(X), 0), 255);
-
-        int remain = w;
-        for (; remain > 0; remain--)
+    get_default_threadpool()->parallel_for(0, h, pixel_rows_grain(w, 3), [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
         {
-            rgb[0] = SATURATE_CAST_UCHAR(*ptr0);
-            rgb[1] = SATURATE_CAST_UCHAR(*ptr1);
-            rgb[2] = SATURATE_CAST_UCHAR(*ptr2);
-
-            rgb += 3;
-            ptr0++;
-            ptr1++;
-            ptr2++;
+            unsigned char* p = rgb + (size_t)stride * y;
+            const float* inptr0 = ptr0 + (size_t)w * y;
+            const float* inptr1 = ptr1 + (size_t)w * y;
+            const float* inptr2 = ptr2 + (size_t)w * y;
+
+            for (int x = 0; x < w; x++)
+            {
+                p[0] = SATURATE_CAST_UCHAR(inptr0[x]);
+                p[1] = SATURATE_CAST_UCHAR(inptr1[x]);
+                p[2] = SATURATE_CAST_UCHAR(inptr2[x]);
+
+                p += 3;
+            }
         }
-        rgb += wgap;
-    }
+    });
 }
 
-
 static int from_gray(const unsigned char* gray, int w, int h, int stride, Mat& m, Allocator* allocator)
 {
     m.create(w, h, 1, 4u, allocator);
     if (m.empty())
         return -1;
 
-    const int wgap = stride - w;
-    if (wgap == 0)
-    {
-        w = w * h;
-        h = 1;
-    }
-
     float* ptr = m;
 
-    for (int y = 0; y < h; y++)
-    {
-        int remain = w;
-        for (; remain > 0; remain--)
+    get_default_threadpool()->parallel_for(0, h, pixel_rows_grain(w, 1), [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
         {
-            *ptr = *gray;
+            const unsigned char* p = gray + (size_t)stride * y;
+            float* outptr = ptr + (size_t)w * y;
 
-            gray++;
-            ptr++;
+            for (int x = 0; x < w; x++)
+            {
+                outptr[x] = p[x];
+            }
         }
-        gray += wgap;
-    }
+    });
 
     return 0;
 }
 
 static void to_gray(const Mat& m, unsigned char* gray, int stride)
 {
-    int w = m.w;
-    int h = m.h;
-
-    const int wgap = stride - w;
-    if (wgap == 0)
-    {
-        w = w * h;
-        h = 1;
-    }
+    const int w = m.w;
+    const int h = m.h;
 
     const float* ptr = m;
 
-    for (int y = 0; y < h; y++)
-    {
-#define SATURATE_CAST_UCHAR(X) (unsigned char)::std::min(::std::max((int)(X), 0), 255);
-
-        int remain = w;
-        for (; remain > 0; remain--)
+    get_default_threadpool()->parallel_for(0, h, pixel_rows_grain(w, 1), [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
         {
-            *gray = SATURATE_CAST_UCHAR(*ptr);
+            unsigned char* p = gray + (size_t)stride * y;
+            const float* inptr = ptr + (size_t)w * y;
 
-            gray++;
-            ptr++;
+            for (int x = 0; x < w; x++)
+            {
+                p[x] = SATURATE_CAST_UCHAR(inptr[x]);
+            }
         }
-        gray += wgap;
-    }
+    });
 }
 
 Mat Mat::from_pixels(const unsigned char* pixels, int type, int w, int h, Allocator* allocator)
@@ -199,4 +181,19 @@ void Mat::to_pixels(unsigned char* pixels, int type, int stride) const
     }
 }
 
+void Mat::substract_mean_normalize(const float* mean_vals, const float* norm_vals)
+{
+    int size = w * h * d;
+    for (int q = 0; q < c; q++)
+    {
+        float* ptr = channel(q);
+        const float mean = mean_vals ? mean_vals[q] : 0.f;
+        const float norm = norm_vals ? norm_vals[q] : 1.f;
+        for (int i = 0; i < size; i++)
+        {
+            ptr[i] = (ptr[i] - mean) * norm;
+        }
+    }
+}
+
 }
\ No newline at end of file
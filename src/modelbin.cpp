@@ -0,0 +1,122 @@
+#include "modelbin.h"
+#include "common.h"
+
+namespace tinyinfer {
+
+ModelBin::ModelBin()
+{
+}
+
+ModelBin::~ModelBin()
+{
+}
+
+Mat ModelBin::load(int w, int h, int type) const
+{
+    Mat m = load(w * h, type);
+    if (m.empty())
+        return m;
+
+    return m.reshape(w, h);
+}
+
+Mat ModelBin::load(int w, int h, int c, int type) const
+{
+    Mat m = load(w * h * c, type);
+    if (m.empty())
+        return m;
+
+    return m.reshape(w, h, c);
+}
+
+ModelBinFromStdio::ModelBinFromStdio(FILE* _binfp)
+    : binfp(_binfp)
+{
+}
+
+Mat ModelBinFromStdio::load(int w, int type) const
+{
+    if (!binfp)
+        return Mat();
+
+    if (type == 1)
+    {
+        Mat m(w, (size_t)4u);
+        if (m.empty())
+            return m;
+
+        if (fread(m.data, sizeof(float), w, binfp) != (size_t)w)
+        {
+            TINYINFER_LOG("ModelBin read float32 weight data failed");
+            return Mat();
+        }
+
+        return m;
+    }
+
+    if (type != 0)
+    {
+        TINYINFER_LOG("ModelBin load type %d not implemented", type);
+        return Mat();
+    }
+
+    unsigned int flag = 0;
+    if (fread(&flag, sizeof(flag), 1, binfp) != 1)
+    {
+        TINYINFER_LOG("ModelBin read weight tag failed");
+        return Mat();
+    }
+
+    if (flag == TINYINFER_WEIGHT_TAG_FLOAT32)
+    {
+        return load(w, 1);
+    }
+
+    if (flag != TINYINFER_WEIGHT_TAG_FLOAT16)
+    {
+        TINYINFER_LOG("ModelBin unknown weight tag %x", flag);
+        return Mat();
+    }
+
+    // float16 data is padded to 4 bytes, the allocation is aligned the same way
+    Mat m16(w, (size_t)2u);
+    if (m16.empty())
+        return m16;
+
+    size_t align_data_size = alignSize((size_t)w * sizeof(unsigned short), 4);
+    if (fread(m16.data, 1, align_data_size, binfp) != align_data_size)
+    {
+        TINYINFER_LOG("ModelBin read float16 weight data failed");
+        return Mat();
+    }
+
+    Mat m(w, (size_t)4u);
+    if (m.empty())
+        return m;
+
+    const unsigned short* ptr16 = m16;
+    float* ptr = m;
+    for (int i = 0; i < w; i++)
+    {
+        ptr[i] = float16_to_float32(ptr16[i]);
+    }
+
+    return m;
+}
+
+ModelBinFromMatArray::ModelBinFromMatArray(const Mat* _weights)
+    : weights(_weights)
+{
+}
+
+Mat ModelBinFromMatArray::load(int /*w*/, int /*type*/) const
+{
+    if (!weights)
+        return Mat();
+
+    Mat m = weights[0];
+    weights++;
+    return m;
+}
+
+} // namespace tinyinfer
@@ -0,0 +1,962 @@
+#include "net.h"
+#include "common.h"
+#include "convolution.h"
+#include "gemm.h"
+#include "multiheadattention.h"
+#include "padding.h"
+#include "permute.h"
+#include "pooling.h"
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tinyinfer {
+
+// an outermost axis Concat output and the slice of every input along that axis
+struct ConcatPlan
+{
+    ConcatPlan()
+        : dims(0), w(0), h(0), d(0), c(0), elemsize(0)
+    {
+    }
+
+    int dims;
+    int w;
+    int h;
+    int d;
+    int c;
+    size_t elemsize;
+
+    std::vector<int> offsets;
+    std::vector<int> extents;
+};
+
+class Net::NetPrivate
+{
+public:
+    // let a Gemm read the bottom of a Permute swapping its two innermost axes through the opposite transpose flag
+    void fold_permute_gemm();
+
+    // let a Convolution or average Pooling read the bottom of a constant Padding and add the pads to its own
+    void fold_padding();
+
+    // mark the blobs that can be written straight into their slice of a Concat output
+    void plan_inplace_concat();
+
+    // give every MultiHeadAttention layer with kv_cache set its own slot of the KVCache, in layer order
+    void assign_kv_cache_slots();
+
+    // the preallocated output of a Concat layer, empty until a forward has recorded its shape
+    Mat concat_output(int layer_index, std::vector<Mat>& concat_mats, const Option& opt);
+
+    // the slice of a Concat output that a marked blob is written into, empty if there is none
+    Mat concat_slice(int blob_index, std::vector<Mat>& concat_mats, const Option& opt);
+
+    // whether a marked blob still points into the concat output, rather than memory the layer allocated or the user passed in
+    bool in_concat_output(int blob_index, const Mat& m, const std::vector<Mat>& concat_mats) const;
+
+    // remember the shape of an outermost axis concat for the next forward
+    void record_concat(int layer_index, const std::vector<Mat>& bottom_blobs, const Mat& top_blob);
+
+public:
+    std::vector<Blob> blobs;
+    std::vector<Layer*> layers;
+
+    std::vector<int> input_indexes;
+    std::vector<int> output_indexes;
+
+    // number of layers reading each blob
+    std::vector<int> blob_consumer_counts;
+
+    // only used by the name based api, the forward path works on indexes
+    std::unordered_map<std::string, int> blob_index_by_name;
+    std::unordered_map<std::string, int> layer_index_by_name;
+
+    // the Concat layer and input position of blobs written into a Concat output, -1 for other blobs
+    // the top of the layer allocating it and every inplace layer from there to the Concat, read by nothing else
+    std::vector<int> blob_concat_layers;
+    std::vector<int> blob_concat_inputs;
+
+    // by layer index, shared by every extractor
+    std::vector<ConcatPlan> concat_plans;
+    std::mutex concat_plans_lock;
+};
+
+void Net::NetPrivate::fold_permute_gemm()
+{
+    for (int i = 0; i < (int)layers.size(); i++)
+    {
+        Layer* layer = layers[i];
+        if (layer->typeindex != LayerType::Gemm || layer->bottoms.size() < 2)
+            continue;
+
+        Gemm* gemm = (Gemm*)layer;
+
+        // A and B only, the packing reads either layout at the same cost
+        for (int j = 0; j < 2; j++)
+        {
+            const int blob_index = layer->bottoms[j];
+            const Layer* permute = layers[blobs[blob_index].producer];
+            if (permute->typeindex != LayerType::Permute || ((const Permute*)permute)->order_type != 1 || blob_consumer_counts[blob_index] != 1)
+                continue;
+
+            // the permute still runs when its top is extracted, its read of the bottom moves to the gemm
+            const int bottom_blob_index = permute->bottoms[0];
+            if (blobs[bottom_blob_index].consumer == blobs[blob_index].producer)
+                blobs[bottom_blob_index].consumer = i;
+
+            layer->bottoms[j] = bottom_blob_index;
+            blob_consumer_counts[blob_index] = 0;
+
+            if (j == 0)
+                gemm->transA = !gemm->transA;
+            else
+                gemm->transB = !gemm->transB;
+        }
+    }
+}
+
+// the pads can be added when the consumer pads with the same value, or has no pads yet and takes the value over
+static bool fold_padding_into(Layer* layer, const Padding* padding)
+{
+    if (layer->typeindex == LayerType::Convolution || layer->typeindex == LayerType::ConvolutionDepthWise)
+    {
+        Convolution* conv = (Convolution*)layer;
+
+        // SAME padding is resolved from the input size, which the padding changes
+        if (conv->pad_left < 0)
+            return false;
+
+        const bool padded = conv->pad_left || conv->pad_right || conv->pad_top || conv->pad_bottom;
+        if (padded && conv->pad_value != padding->value)
+            return false;
+
+        conv->pad_left += padding->left;
+        conv->pad_right += padding->right;
+        conv->pad_top += padding->top;
+        conv->pad_bottom += padding->bottom;
+        conv->pad_value = padding->value;
+        return true;
+    }
+
+    if (layer->typeindex == LayerType::Pooling)
+    {
+        Pooling* pooling = (Pooling*)layer;
+
+        // zeros padded in are averaged like the input, max pooling and the ceil mode windows see them differently
+        if (pooling->pooling_type != Pooling::PoolMethod_AVE || pooling->global_pooling || pooling->adaptive_pooling || pooling->pad_mode != 1 || padding->value != 0.f)
+            return false;
+
+        const bool padded = pooling->pad_left || pooling->pad_right || pooling->pad_top || pooling->pad_bottom;
+        if (padded && !pooling->avgpool_count_include_pad)
+            return false;
+
+        pooling->pad_left += padding->left;
+        pooling->pad_right += padding->right;
+        pooling->pad_top += padding->top;
+        pooling->pad_bottom += padding->bottom;
+        pooling->avgpool_count_include_pad = 1;
+        return true;
+    }
+
+    return false;
+}
+
+void Net::NetPrivate::fold_padding()
+{
+    for (int i = 0; i < (int)layers.size(); i++)
+    {
+        Layer* layer = layers[i];
+        if (layer->bottoms.size() != 1)
+            continue;
+
+        const int blob_index = layer->bottoms[0];
+        const Layer* producer = layers[blobs[blob_index].producer];
+        if (producer->typeindex != LayerType::Padding || blob_consumer_counts[blob_index] != 1)
+            continue;
+
+        const Padding* padding = (const Padding*)producer;
+        if (padding->type != 0 || padding->front || padding->behind)
+            continue;
+
+        if (!fold_padding_into(layer, padding))
+            continue;
+
+        // the padding still runs when its top is extracted, its read of the bottom moves to the consumer
+        const int bottom_blob_index = producer->bottoms[0];
+        if (blobs[bottom_blob_index].consumer == blobs[blob_index].producer)
+            blobs[bottom_blob_index].consumer = i;
+
+        layer->bottoms[0] = bottom_blob_index;
+        blob_consumer_counts[blob_index] = 0;
+    }
+}
+
+void Net::NetPrivate::assign_kv_cache_slots()
+{
+    int slot = 0;
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (layers[i]->typeindex != LayerType::MultiHeadAttention)
+            continue;
+
+        MultiHeadAttention* attention = (MultiHeadAttention*)layers[i];
+        if (attention->kv_cache)
+            attention->kv_cache_slot = slot++;
+    }
+}
+
+void Net::NetPrivate::plan_inplace_concat()
+{
+    blob_concat_layers.assign(blobs.size(), -1);
+    blob_concat_inputs.assign(blobs.size(), -1);
+    concat_plans.clear();
+    concat_plans.resize(layers.size());
+
+    std::vector<int> chain;
+    for (int i = 0; i < (int)layers.size(); i++)
+    {
+        const Layer* concat = layers[i];
+        if (concat->typeindex != LayerType::Concat)
+            continue;
+
+        for (int j = 0; j < (int)concat->bottoms.size(); j++)
+        {
+            // walk up through the inplace layers to the one allocating the blob
+            chain.clear();
+            int blob_index = concat->bottoms[j];
+            bool writable = true;
+            while (writable)
+            {
+                if (blob_consumer_counts[blob_index] != 1 || blob_concat_layers[blob_index] != -1)
+                {
+                    writable = false;
+                    break;
+                }
+
+                chain.push_back(blob_index);
+
+                // inputs, weights and shared blobs are not ours to write
+                const Layer* layer = layers[blobs[blob_index].producer];
+                if (layer->typeindex == LayerType::Input || layer->typeindex == LayerType::MemoryData || layer->typeindex == LayerType::Split)
+                    writable = false;
+                else if (!layer->support_inplace)
+                    break;
+                else if (!layer->one_blob_only)
+                    writable = false;
+                else
+                    blob_index = layer->bottoms[0];
+            }
+
+            if (!writable)
+                continue;
+
+            for (size_t k = 0; k < chain.size(); k++)
+            {
+                blob_concat_layers[chain[k]] = i;
+                blob_concat_inputs[chain[k]] = j;
+            }
+        }
+    }
+}
+
+Mat Net::NetPrivate::concat_output(int layer_index, std::vector<Mat>& concat_mats, const Option& opt)
+{
+    const int top_blob_index = layers[layer_index]->tops[0];
+    Mat& out = concat_mats[top_blob_index];
+    if (!out.empty())
+        return out;
+
+    // a concat feeding another one lives in the slice of the outer output
+    if (blob_concat_layers[top_blob_index] != -1)
+    {
+        out = concat_slice(top_blob_index, concat_mats, opt);
+        return out;
+    }
+
+    ConcatPlan plan;
+    {
+        std::lock_guard<std::mutex> lock(concat_plans_lock);
+        plan = concat_plans[layer_index];
+    }
+
+    if (plan.dims == 1)
+        out.create(plan.w, plan.elemsize, opt.blob_allocator);
+    if (plan.dims == 2)
+        out.create(plan.w, plan.h, plan.elemsize, opt.blob_allocator);
+    if (plan.dims == 3)
+        out.create(plan.w, plan.h, plan.c, plan.elemsize, opt.blob_allocator);
+    if (plan.dims == 4)
+        out.create(plan.w, plan.h, plan.d, plan.c, plan.elemsize, opt.blob_allocator);
+
+    return out;
+}
+
+Mat Net::NetPrivate::concat_slice(int blob_index, std::vector<Mat>& concat_mats, const Option& opt)
+{
+    const int layer_index = blob_concat_layers[blob_index];
+    const int input = blob_concat_inputs[blob_index];
+
+    Mat out = concat_output(layer_index, concat_mats, opt);
+    if (out.empty())
+        return Mat();
+
+    int offset;
+    int extent;
+    {
+        std::lock_guard<std::mutex> lock(concat_plans_lock);
+        const ConcatPlan& plan = concat_plans[layer_index];
+
+        // another extractor may have recorded a new shape since the output was allocated
+        if (plan.dims != out.dims || plan.w != out.w || plan.h != out.h || plan.d != out.d || plan.c != out.c)
+            return Mat();
+
+        offset = plan.offsets[input];
+        extent = plan.extents[input];
+    }
+
+    if (out.dims == 1)
+        return Mat(extent, (unsigned char*)out.data + offset * out.elemsize, out.elemsize, out.elempack, out.allocator);
+    if (out.dims == 2)
+        return out.row_range(offset, extent);
+
+    return out.channel_range(offset, extent);
+}
+
+bool Net::NetPrivate::in_concat_output(int blob_index, const Mat& m, const std::vector<Mat>& concat_mats) const
+{
+    const int layer_index = blob_concat_layers[blob_index];
+    if (layer_index == -1 || !m.data)
+        return false;
+
+    const Mat& out = concat_mats[layers[layer_index]->tops[0]];
+    const unsigned char* begin = (const unsigned char*)out.data;
+    const unsigned char* end = begin + out.total() * out.elemsize;
+    return (const unsigned char*)m.data >= begin && (const unsigned char*)m.data < end;
+}
+
+void Net::NetPrivate::record_concat(int layer_index, const std::vector<Mat>& bottom_blobs, const Mat& top_blob)
+{
+    ConcatPlan plan;
+    plan.offsets.resize(bottom_blobs.size());
+    plan.extents.resize(bottom_blobs.size());
+
+    int outer = 0;
+    bool outermost = true;
+    for (size_t i = 0; i < bottom_blobs.size(); i++)
+    {
+        const Mat& m = bottom_blobs[i];
+        if (m.dims != top_blob.dims || m.elemsize != top_blob.elemsize)
+            outermost = false;
+        if (m.dims >= 2 && m.w != top_blob.w)
+            outermost = false;
+        if (m.dims >= 3 && (m.h != top_blob.h || m.d != top_blob.d))
+            outermost = false;
+
+        plan.offsets[i] = outer;
+        plan.extents[i] = m.dims == 1 ? m.w : m.dims == 2 ? m.h : m.c;
+        outer += plan.extents[i];
+    }
+
+    if (outermost && outer == (top_blob.dims == 1 ? top_blob.w : top_blob.dims == 2 ? top_blob.h : top_blob.c))
+    {
+        plan.dims = top_blob.dims;
+        plan.w = top_blob.w;
+        plan.h = top_blob.h;
+        plan.d = top_blob.d;
+        plan.c = top_blob.c;
+        plan.elemsize = top_blob.elemsize;
+    }
+
+    std::lock_guard<std::mutex> lock(concat_plans_lock);
+    concat_plans[layer_index] = plan;
+}
+
+Net::Net()
+    : d(new NetPrivate())
+{
+}
+
+Net::~Net()
+{
+    clear();
+
+    delete d;
+}
+
+int Net::load_param(FILE* fp)
+{
+    int magic = 0;
+    if (fscanf(fp, "%d", &magic) != 1)
+    {
+        TINYINFER_LOG("read magic failed");
+        return -1;
+    }
+
+    if (magic != 202303)
+    {
+        TINYINFER_LOG("param is too old, please regenerate");
+        return -1;
+    }
+
+    int layer_count = 0;
+    int blob_count = 0;
+    if (fscanf(fp, "%d %d", &layer_count, &blob_count) != 2)
+    {
+        TINYINFER_LOG("read layer_count and blob_count failed");
+        return -1;
+    }
+
+    if (layer_count <= 0 || blob_count <= 0)
+    {
+        TINYINFER_LOG("invalid layer_count or blob_count");
+        return -1;
+    }
+
+    clear();
+
+    d->layers.resize(layer_count);
+    d->blobs.resize(blob_count);
+    d->blob_consumer_counts.resize(blob_count, 0);
+
+    ParamDict pd;
+
+    int blob_index = 0;
+    for (int i = 0; i < layer_count; i++)
+    {
+        char layer_type[256];
+        char layer_name[256];
+        int bottom_count = 0;
+        int top_count = 0;
+        if (fscanf(fp, "%255s %255s %d %d", layer_type, layer_name, &bottom_count, &top_count) != 4)
+        {
+            TINYINFER_LOG("read layer line %d failed", i);
+            clear();
+            return -1;
+        }
+
+        Layer* layer = create_layer(layer_type);
+        if (!layer)
+        {
+            TINYINFER_LOG("layer %s not exists or registered", layer_type);
+            clear();
+            return -1;
+        }
+
+        layer->name = std::string(layer_name);
+        d->layers[i] = layer;
+        d->layer_index_by_name[layer->name] = i;
+
+        layer->bottoms.resize(bottom_count);
+        for (int j = 0; j < bottom_count; j++)
+        {
+            char bottom_name[256];
+            if (fscanf(fp, "%255s", bottom_name) != 1)
+            {
+                TINYINFER_LOG("read bottom blob of %s failed", layer_name);
+                clear();
+                return -1;
+            }
+
+            // layers are executed in file order, a blob must be produced before it is consumed
+            std::unordered_map<std::string, int>::const_iterator it = d->blob_index_by_name.find(bottom_name);
+            if (it == d->blob_index_by_name.end())
+            {
+                TINYINFER_LOG("bottom blob %s of %s is not produced by any previous layer", bottom_name, layer_name);
+                clear();
+                return -1;
+            }
+
+            int bottom_blob_index = it->second;
+            d->blobs[bottom_blob_index].consumer = i;
+            d->blob_consumer_counts[bottom_blob_index]++;
+            layer->bottoms[j] = bottom_blob_index;
+        }
+
+        layer->tops.resize(top_count);
+        for (int j = 0; j < top_count; j++)
+        {
+            char blob_name[256];
+            if (fscanf(fp, "%255s", blob_name) != 1)
+            {
+                TINYINFER_LOG("read top blob of %s failed", layer_name);
+                clear();
+                return -1;
+            }
+
+            if (blob_index >= blob_count)
+            {
+                TINYINFER_LOG("blob_count %d is less than the blobs in param", blob_count);
+                clear();
+                return -1;
+            }
+
+            Blob& blob = d->blobs[blob_index];
+            blob.name = std::string(blob_name);
+            blob.producer = i;
+            d->blob_index_by_name[blob.name] = blob_index;
+
+            layer->tops[j] = blob_index;
+
+            blob_index++;
+        }
+
+        if (pd.load_param(fp) != 0)
+        {
+            TINYINFER_LOG("ParamDict load_param %d %s failed", i, layer_name);
+            clear();
+            return -1;
+        }
+
+        if (layer->load_param(pd) != 0)
+        {
+            TINYINFER_LOG("layer load_param %d %s failed", i, layer_name);
+            clear();
+            return -1;
+        }
+
+        if (layer->typeindex == LayerType::Input)
+        {
+            d->input_indexes.push_back(layer->tops[0]);
+        }
+    }
+
+    if (blob_index != blob_count)
+    {
+        // tolerate a larger header count, the unused tail is dropped
+        TINYINFER_LOG("blob_count %d in header but %d blobs in param", blob_count, blob_index);
+        d->blobs.resize(blob_index);
+        d->blob_consumer_counts.resize(blob_index);
+    }
+
+    for (int i = 0; i < (int)d->blobs.size(); i++)
+    {
+        if (d->blobs[i].consumer == -1)
+            d->output_indexes.push_back(i);
+    }
+
+    if (opt.use_permute_fold)
+        d->fold_permute_gemm();
+    if (opt.use_padding_fold)
+        d->fold_padding();
+
+    d->plan_inplace_concat();
+    d->assign_kv_cache_slots();
+
+    return 0;
+}
+
+int Net::load_param(const char* protopath)
+{
+    FILE* fp = fopen(protopath, "rb");
+    if (!fp)
+    {
+        TINYINFER_LOG("fopen %s failed", protopath);
+        return -1;
+    }
+
+    int ret = load_param(fp);
+    fclose(fp);
+    return ret;
+}
+
+int Net::load_model(FILE* fp)
+{
+    if (d->layers.empty())
+    {
+        TINYINFER_LOG("network graph not ready");
+        return -1;
+    }
+
+    ModelBinFromStdio mb(fp);
+    for (size_t i = 0; i < d->layers.size(); i++)
+    {
+        Layer* layer = d->layers[i];
+
+        if (layer->load_model(mb) != 0)
+        {
+            TINYINFER_LOG("layer load_model %d %s failed", (int)i, layer->name.c_str());
+            return -1;
+        }
+
+        if (layer->create_pipeline(opt) != 0)
+        {
+            TINYINFER_LOG("layer create_pipeline %d %s failed", (int)i, layer->name.c_str());
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int Net::load_model(const char* modelpath)
+{
+    FILE* fp = fopen(modelpath, "rb");
+    if (!fp)
+    {
+        TINYINFER_LOG("fopen %s failed", modelpath);
+        return -1;
+    }
+
+    int ret = load_model(fp);
+    fclose(fp);
+    return ret;
+}
+
+void Net::clear()
+{
+    for (size_t i = 0; i < d->layers.size(); i++)
+    {
+        Layer* layer = d->layers[i];
+        if (!layer)
+            continue;
+
+        layer->destroy_pipeline(opt);
+        delete layer;
+    }
+
+    d->blobs.clear();
+    d->layers.clear();
+    d->input_indexes.clear();
+    d->output_indexes.clear();
+    d->blob_consumer_counts.clear();
+    d->blob_index_by_name.clear();
+    d->layer_index_by_name.clear();
+    d->blob_concat_layers.clear();
+    d->blob_concat_inputs.clear();
+    d->concat_plans.clear();
+}
+
+Extractor Net::create_extractor() const
+{
+    return Extractor(this, d->blobs.size());
+}
+
+int Net::find_blob_index_by_name(const char* name) const
+{
+    std::unordered_map<std::string, int>::const_iterator it = d->blob_index_by_name.find(name);
+    if (it == d->blob_index_by_name.end())
+    {
+        TINYINFER_LOG("find_blob_index_by_name %s failed", name);
+        return -1;
+    }
+
+    return it->second;
+}
+
+int Net::find_layer_index_by_name(const char* name) const
+{
+    std::unordered_map<std::string, int>::const_iterator it = d->layer_index_by_name.find(name);
+    if (it == d->layer_index_by_name.end())
+    {
+        TINYINFER_LOG("find_layer_index_by_name %s failed", name);
+        return -1;
+    }
+
+    return it->second;
+}
+
+const std::vector<Blob>& Net::blobs() const
+{
+    return d->blobs;
+}
+
+const std::vector<Layer*>& Net::layers() const
+{
+    return d->layers;
+}
+
+const std::vector<int>& Net::input_indexes() const
+{
+    return d->input_indexes;
+}
+
+const std::vector<int>& Net::output_indexes() const
+{
+    return d->output_indexes;
+}
+
+// an inplace layer may only write into a blob nobody else references
+static int make_writable(Mat& m, const Option& opt)
+{
+    if (m.refcount && *m.refcount == 1)
+        return 0;
+
+    m = m.clone(opt.blob_allocator);
+    if (m.empty())
+        return -100;
+
+    return 0;
+}
+
+int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<int>& blob_refs, std::vector<Mat>& concat_mats, const Option& opt) const
+{
+    const Layer* layer = d->layers[layer_index];
+
+    std::vector<Mat> bottom_blobs(layer->bottoms.size());
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        bottom_blobs[i] = blob_mats[bottom_blob_index];
+
+        // the last consumer takes the blob over, so inplace layers can skip the copy
+        if (opt.lightmode && --blob_refs[bottom_blob_index] <= 0)
+        {
+            blob_mats[bottom_blob_index].release();
+        }
+    }
+
+    // every blob written into a concat output is read by its next layer only, which light mode lets write into it
+    const bool inplace_concat = opt.lightmode && opt.use_inplace_concat;
+
+    std::vector<Mat> top_blobs(layer->tops.size());
+    if (inplace_concat && !layer->support_inplace)
+    {
+        // create keeps a top of the right shape, so the layer writes into the slice or the whole preallocated output
+        if (layer->typeindex == LayerType::Concat)
+        {
+            top_blobs[0] = d->concat_output(layer_index, concat_mats, opt);
+            concat_mats[layer->tops[0]].release();
+        }
+        else
+        {
+            for (size_t i = 0; i < layer->tops.size(); i++)
+            {
+                if (d->blob_concat_layers[layer->tops[i]] != -1)
+                    top_blobs[i] = d->concat_slice(layer->tops[i], concat_mats, opt);
+            }
+        }
+    }
+
+    int ret = 0;
+    if (layer->one_blob_only)
+    {
+        if (layer->support_inplace)
+        {
+            if (!inplace_concat || !d->in_concat_output(layer->bottoms[0], bottom_blobs[0], concat_mats))
+                ret = make_writable(bottom_blobs[0], opt);
+            if (ret == 0)
+                ret = layer->forward_inplace(bottom_blobs[0], opt);
+            top_blobs[0] = bottom_blobs[0];
+        }
+        else
+        {
+            ret = layer->forward(bottom_blobs[0], top_blobs[0], opt);
+        }
+    }
+    else
+    {
+        if (layer->support_inplace)
+        {
+            // only the leading blobs that become tops are written, the rest stay shared
+            for (size_t i = 0; i < layer->tops.size() && i < bottom_blobs.size() && ret == 0; i++)
+            {
+                ret = make_writable(bottom_blobs[i], opt);
+            }
+            if (ret == 0)
+                ret = layer->forward_inplace(bottom_blobs, opt);
+            top_blobs = bottom_blobs;
+        }
+        else
+        {
+            ret = layer->forward(bottom_blobs, top_blobs, opt);
+        }
+    }
+
+    if (ret != 0)
+        return ret;
+
+    if (inplace_concat && layer->typeindex == LayerType::Concat)
+        d->record_concat(layer_index, bottom_blobs, top_blobs[0]);
+
+    for (size_t i = 0; i < layer->tops.size(); i++)
+    {
+        int top_blob_index = layer->tops[i];
+
+        blob_mats[top_blob_index] = top_blobs[i];
+        blob_refs[top_blob_index] = d->blob_consumer_counts[top_blob_index];
+    }
+
+    return 0;
+}
+
+class Extractor::ExtractorPrivate
+{
+public:
+    const Net* net;
+    std::vector<Mat> blob_mats;
+    std::vector<int> blob_refs;
+    // preallocated concat outputs by top blob index
+    std::vector<Mat> concat_mats;
+    Option opt;
+};
+
+Extractor::Extractor(const Net* _net, size_t blob_count)
+    : d(new ExtractorPrivate())
+{
+    d->net = _net;
+    d->blob_mats.resize(blob_count);
+    d->blob_refs.resize(blob_count, 0);
+    d->concat_mats.resize(blob_count);
+    d->opt = _net->opt;
+}
+
+Extractor::~Extractor()
+{
+    clear();
+
+    delete d;
+}
+
+Extractor::Extractor(const Extractor& rhs)
+    : d(new ExtractorPrivate())
+{
+    d->net = rhs.d->net;
+    d->blob_mats = rhs.d->blob_mats;
+    d->blob_refs = rhs.d->blob_refs;
+    d->concat_mats = rhs.d->concat_mats;
+    d->opt = rhs.d->opt;
+}
+
+Extractor& Extractor::operator=(const Extractor& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    d->net = rhs.d->net;
+    d->blob_mats = rhs.d->blob_mats;
+    d->blob_refs = rhs.d->blob_refs;
+    d->concat_mats = rhs.d->concat_mats;
+    d->opt = rhs.d->opt;
+
+    return *this;
+}
+
+void Extractor::clear()
+{
+    d->blob_mats.clear();
+    d->blob_refs.clear();
+    d->concat_mats.clear();
+}
+
+void Extractor::set_light_mode(bool enable)
+{
+    d->opt.lightmode = enable;
+}
+
+void Extractor::set_blob_allocator(Allocator* allocator)
+{
+    d->opt.blob_allocator = allocator;
+}
+
+void Extractor::set_workspace_allocator(Allocator* allocator)
+{
+    d->opt.workspace_allocator = allocator;
+}
+
+void Extractor::set_kv_cache(KVCache* cache)
+{
+    d->opt.kv_cache = cache;
+}
+
+int Extractor::input(const char* blob_name, const Mat& in)
+{
+    int blob_index = d->net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+        return -1;
+
+    return input(blob_index, in);
+}
+
+int Extractor::extract(const char* blob_name, Mat& feat)
+{
+    int blob_index = d->net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+        return -1;
+
+    return extract(blob_index, feat);
+}
+
+int Extractor::input(int blob_index, const Mat& in)
+{
+    if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
+        return -1;
+
+    d->blob_mats[blob_index] = in;
+    d->blob_refs[blob_index] = d->net->d->blob_consumer_counts[blob_index];
+
+    return 0;
+}
+
+int Extractor::extract(int blob_index, Mat& feat)
+{
+    if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
+        return -1;
+
+    if (d->blob_mats[blob_index].dims == 0)
+    {
+        const std::vector<Blob>& blobs = d->net->blobs();
+        const std::vector<Layer*>& layers = d->net->layers();
+
+        // walk back from the producer and collect every layer with a missing bottom
+        // cached blobs stop the walk, so unrelated branches are never visited
+        std::vector<int> pending;
+        std::vector<int> stack(1, blobs[blob_index].producer);
+        std::vector<unsigned char> visited(layers.size(), 0);
+        while (!stack.empty())
+        {
+            int layer_index = stack.back();
+            stack.pop_back();
+
+            if (visited[layer_index])
+                continue;
+
+            visited[layer_index] = 1;
+
+            const Layer* layer = layers[layer_index];
+            if (layer->typeindex == LayerType::Input)
+            {
+                TINYINFER_LOG("input blob %s not set", blobs[layer->tops[0]].name.c_str());
+                return -1;
+            }
+
+            pending.push_back(layer_index);
+
+            for (size_t i = 0; i < layer->bottoms.size(); i++)
+            {
+                int bottom_blob_index = layer->bottoms[i];
+                if (d->blob_mats[bottom_blob_index].dims == 0)
+                    stack.push_back(blobs[bottom_blob_index].producer);
+            }
+        }
+
+        // layers are stored in topological order
+        std::sort(pending.begin(), pending.end());
+
+        for (size_t i = 0; i < pending.size(); i++)
+        {
+            int ret = d->net->forward_layer(pending[i], d->blob_mats, d->blob_refs, d->concat_mats, d->opt);
+            if (ret != 0)
+            {
+                TINYINFER_LOG("layer %d %s forward failed %d", pending[i], layers[pending[i]]->name.c_str(), ret);
+                return ret;
+            }
+        }
+    }
+
+    feat = d->blob_mats[blob_index];
+
+    // a slice of a concat output is only valid while the extractor holds the output
+    if (feat.data && !feat.refcount && d->net->d->blob_concat_layers[blob_index] != -1)
+    {
+        feat = feat.clone(d->opt.blob_allocator);
+        if (feat.empty())
+            return -100;
+    }
+
+    return 0;
+}
+
+} // namespace tinyinfer
@@ -0,0 +1,29 @@
+#include "option.h"
+#include "cpu.h"
+
+namespace tinyinfer {
+
+Option::Option()
+{
+    lightmode = true;
+
+    blob_allocator = 0;
+    workspace_allocator = 0;
+
+    num_threads = get_cpu_count();
+    threadpool = 0;
+
+    kv_cache = 0;
+
+    use_winograd_convolution = true;
+    use_winograd63_convolution = true;
+
+    use_fast_activation = false;
+
+    use_inplace_concat = true;
+
+    use_permute_fold = true;
+    use_padding_fold = true;
+}
+
+} // namespace tinyinfer
@@ -0,0 +1,165 @@
+#include "paramdict.h"
+#include "common.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace tinyinfer {
+
+ParamDict::ParamDict()
+{
+    clear();
+}
+
+ParamDict::~ParamDict()
+{
+}
+
+int ParamDict::type(int id) const
+{
+    return params[id].type;
+}
+
+int ParamDict::get(int id, int def) const
+{
+    if (params[id].type == 3)
+        return (int)params[id].f;
+
+    return params[id].type ? params[id].i : def;
+}
+
+float ParamDict::get(int id, float def) const
+{
+    if (params[id].type == 2)
+        return (float)params[id].i;
+
+    return params[id].type ? params[id].f : def;
+}
+
+Mat ParamDict::get(int id, const Mat& def) const
+{
+    return params[id].type ? params[id].v : def;
+}
+
+void ParamDict::set(int id, int i)
+{
+    params[id].type = 2;
+    params[id].i = i;
+}
+
+void ParamDict::set(int id, float f)
+{
+    params[id].type = 3;
+    params[id].f = f;
+}
+
+void ParamDict::set(int id, const Mat& v)
+{
+    params[id].type = 4;
+    params[id].v = v;
+}
+
+void ParamDict::clear()
+{
+    for (int i = 0; i < TINYINFER_MAX_PARAM_COUNT; i++)
+    {
+        params[i].type = 0;
+        params[i].i = 0;
+        params[i].v = Mat();
+    }
+}
+
+static bool vstr_is_float(const char* vstr)
+{
+    for (int j = 0; vstr[j] != '\0'; j++)
+    {
+        if (vstr[j] == '.' || tolower(vstr[j]) == 'e')
+            return true;
+    }
+
+    return false;
+}
+
+int ParamDict::load_param(FILE* fp)
+{
+    clear();
+
+    // a layer line ends when the next token is not id=value,
+    // layer types never start with a digit so fscanf stops right there
+    int id = 0;
+    while (fscanf(fp, "%d=", &id) == 1)
+    {
+        bool is_array = id <= -23300;
+        if (is_array)
+        {
+            id = -id - 23300;
+        }
+
+        if (id < 0 || id >= TINYINFER_MAX_PARAM_COUNT)
+        {
+            TINYINFER_LOG("id < TINYINFER_MAX_PARAM_COUNT failed (id=%d, TINYINFER_MAX_PARAM_COUNT=%d)", id, TINYINFER_MAX_PARAM_COUNT);
+            return -1;
+        }
+
+        if (is_array)
+        {
+            int len = 0;
+            if (fscanf(fp, "%d", &len) != 1)
+            {
+                TINYINFER_LOG("ParamDict read array length failed");
+                return -1;
+            }
+
+            params[id].v.create(len);
+
+            bool is_float = false;
+            for (int j = 0; j < len; j++)
+            {
+                char vstr[16];
+                if (fscanf(fp, ",%15[^,\n ]", vstr) != 1)
+                {
+                    TINYINFER_LOG("ParamDict read array element failed");
+                    return -1;
+                }
+
+                is_float = vstr_is_float(vstr);
+                if (is_float)
+                {
+                    float* ptr = params[id].v;
+                    ptr[j] = (float)strtod(vstr, 0);
+                }
+                else
+                {
+                    int* ptr = params[id].v;
+                    ptr[j] = (int)strtol(vstr, 0, 10);
+                }
+            }
+
+            params[id].type = is_float ? 5 : 4;
+        }
+        else
+        {
+            char vstr[64];
+            if (fscanf(fp, "%63s", vstr) != 1)
+            {
+                TINYINFER_LOG("ParamDict read value failed");
+                return -1;
+            }
+
+            if (vstr_is_float(vstr))
+            {
+                params[id].f = (float)strtod(vstr, 0);
+                params[id].type = 3;
+            }
+            else
+            {
+                params[id].i = (int)strtol(vstr, 0, 10);
+                params[id].type = 2;
+            }
+        }
+    }
+
+    return 0;
+}
+
+} // namespace tinyinfer
@@ -0,0 +1,370 @@
+#include "threadpool.h"
+#include "common.h"
+#include "cpu.h"
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace tinyinfer {
+
+// spin iterations before an idle worker goes to sleep, roughly tens of microseconds
+#define TINYINFER_THREADPOOL_SPIN_COUNT 20000
+
+static inline void cpu_relax()
+{
+#if __SSE2__
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// set while the thread executes chunks, nested loops then run serially
+static thread_local bool g_in_parallel = false;
+
+// chunk range [lo, hi) packed as lo | hi << 32
+// the owner pops from lo and thieves split off the upper half, both with one compare exchange
+struct alignas(64) RangeSlot
+{
+    std::atomic<uint64_t> range;
+};
+
+static inline uint64_t pack_range(uint32_t lo, uint32_t hi)
+{
+    return (uint64_t)lo | ((uint64_t)hi << 32);
+}
+
+class ThreadPool::ThreadPoolPrivate
+{
+public:
+    void start();
+    void worker_main(int worker_index);
+    void work(int slot_index);
+    bool pop(int slot_index, int& chunk);
+    bool steal(int slot_index);
+    void apply_affinity(int worker_index);
+
+public:
+    int num_threads;
+    bool started;
+    std::vector<std::thread> workers;
+    std::vector<int> affinity;
+
+    // slot 0 is the calling thread, slot i + 1 is worker i
+    RangeSlot* slots;
+
+    // current job, written only while no worker is inside
+    range_func func;
+    void* ctx;
+    int begin;
+    int end;
+    int grain;
+    int participants;
+
+    std::atomic<int> epoch;
+    std::atomic<bool> open;
+    std::atomic<int> active;
+    std::atomic<int> sleepers;
+    std::atomic<bool> stop;
+
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cond;
+
+    // one job at a time
+    std::mutex job_mutex;
+};
+
+void ThreadPool::ThreadPoolPrivate::start()
+{
+    workers.reserve(num_threads - 1);
+    for (int i = 0; i < num_threads - 1; i++)
+    {
+        workers.push_back(std::thread(&ThreadPoolPrivate::worker_main, this, i));
+    }
+
+    started = true;
+}
+
+void ThreadPool::ThreadPoolPrivate::apply_affinity(int worker_index)
+{
+#if defined(__linux__)
+    if (affinity.empty() || worker_index >= (int)workers.size())
+        return;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(affinity[worker_index % affinity.size()], &cpuset);
+
+    int ret = pthread_setaffinity_np(workers[worker_index].native_handle(), sizeof(cpu_set_t), &cpuset);
+    if (ret != 0)
+    {
+        TINYINFER_LOG("pthread_setaffinity_np failed %d", ret);
+    }
+#else
+    (void)worker_index;
+#endif
+}
+
+bool ThreadPool::ThreadPoolPrivate::pop(int slot_index, int& chunk)
+{
+    std::atomic<uint64_t>& range = slots[slot_index].range;
+
+    uint64_t r = range.load(std::memory_order_acquire);
+    for (;;)
+    {
+        uint32_t lo = (uint32_t)r;
+        uint32_t hi = (uint32_t)(r >> 32);
+        if (lo >= hi)
+            return false;
+
+        if (range.compare_exchange_weak(r, pack_range(lo + 1, hi), std::memory_order_acq_rel))
+        {
+            chunk = (int)lo;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::ThreadPoolPrivate::steal(int slot_index)
+{
+    for (int k = 1; k < participants; k++)
+    {
+        std::atomic<uint64_t>& range = slots[(slot_index + k) % participants].range;
+
+        uint64_t r = range.load(std::memory_order_acquire);
+        for (;;)
+        {
+            uint32_t lo = (uint32_t)r;
+            uint32_t hi = (uint32_t)(r >> 32);
+            if (lo >= hi)
+                break;
+
+            // victim keeps [lo, mid), the thief moves [mid, hi) into its own empty slot
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (range.compare_exchange_weak(r, pack_range(lo, mid), std::memory_order_acq_rel))
+            {
+                slots[slot_index].range.store(pack_range(mid, hi), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::ThreadPoolPrivate::work(int slot_index)
+{
+    for (;;)
+    {
+        int chunk;
+        while (pop(slot_index, chunk))
+        {
+            int i0 = begin + chunk * grain;
+            int i1 = end - i0 > grain ? i0 + grain : end;
+            func(ctx, i0, i1);
+        }
+
+        if (!steal(slot_index))
+            break;
+    }
+}
+
+void ThreadPool::ThreadPoolPrivate::worker_main(int worker_index)
+{
+    g_in_parallel = true;
+
+    int seen = 0;
+    for (;;)
+    {
+        int e;
+        int spin = 0;
+        while ((e = epoch.load(std::memory_order_acquire)) == seen && !stop.load(std::memory_order_acquire))
+        {
+            if (spin < TINYINFER_THREADPOOL_SPIN_COUNT)
+            {
+                spin++;
+                cpu_relax();
+                continue;
+            }
+
+            // the job poster reads sleepers after bumping epoch, one of the two sides always sees the other
+            sleepers.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                sleep_cond.wait(lock, [&] { return epoch.load() != seen || stop.load(); });
+            }
+            sleepers.fetch_sub(1);
+        }
+
+        if (stop.load(std::memory_order_acquire))
+            break;
+
+        seen = e;
+
+        // join only while the job is open, the poster waits for active to drop before the next job
+        active.fetch_add(1);
+        if (open.load() && worker_index + 1 < participants)
+        {
+            work(worker_index + 1);
+        }
+        active.fetch_sub(1);
+    }
+}
+
+ThreadPool::ThreadPool(int num_threads)
+    : d(new ThreadPoolPrivate())
+{
+    d->num_threads = num_threads > 0 ? num_threads : get_cpu_count();
+    d->started = false;
+    d->slots = new RangeSlot[d->num_threads];
+    for (int i = 0; i < d->num_threads; i++)
+    {
+        d->slots[i].range.store(0);
+    }
+
+    d->func = 0;
+    d->ctx = 0;
+    d->begin = 0;
+    d->end = 0;
+    d->grain = 1;
+    d->participants = 0;
+
+    d->epoch.store(0);
+    d->open.store(false);
+    d->active.store(0);
+    d->sleepers.store(0);
+    d->stop.store(false);
+}
+
+ThreadPool::~ThreadPool()
+{
+    d->stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(d->sleep_mutex);
+    }
+    d->sleep_cond.notify_all();
+
+    for (size_t i = 0; i < d->workers.size(); i++)
+    {
+        d->workers[i].join();
+    }
+
+    delete[] d->slots;
+    delete d;
+}
+
+int ThreadPool::num_threads() const
+{
+    return d->num_threads;
+}
+
+int ThreadPool::set_affinity(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+    std::lock_guard<std::mutex> lock(d->job_mutex);
+
+    d->affinity = cpus;
+    for (size_t i = 0; i < d->workers.size(); i++)
+    {
+        d->apply_affinity((int)i);
+    }
+
+    return 0;
+#else
+    (void)cpus;
+    return -1;
+#endif
+}
+
+void ThreadPool::run(int begin, int end, int grain, range_func func, void* ctx, int max_threads)
+{
+    if (g_in_parallel || !d->job_mutex.try_lock())
+    {
+        func(ctx, begin, end);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(d->job_mutex, std::adopt_lock);
+
+    const int chunk_count = (int)(((int64_t)end - begin + grain - 1) / grain);
+
+    int participants = d->num_threads;
+    if (max_threads > 0 && max_threads < participants)
+        participants = max_threads;
+    if (chunk_count < participants)
+        participants = chunk_count;
+
+    if (participants <= 1)
+    {
+        func(ctx, begin, end);
+        return;
+    }
+
+    if (!d->started)
+    {
+        d->start();
+        for (size_t i = 0; i < d->workers.size(); i++)
+        {
+            d->apply_affinity((int)i);
+        }
+    }
+
+    d->func = func;
+    d->ctx = ctx;
+    d->begin = begin;
+    d->end = end;
+    d->grain = grain;
+    d->participants = participants;
+
+    for (int i = 0; i < d->num_threads; i++)
+    {
+        uint32_t lo = i < participants ? (uint32_t)((int64_t)chunk_count * i / participants) : 0;
+        uint32_t hi = i < participants ? (uint32_t)((int64_t)chunk_count * (i + 1) / participants) : 0;
+        d->slots[i].range.store(pack_range(lo, hi), std::memory_order_relaxed);
+    }
+
+    d->open.store(true);
+    d->epoch.fetch_add(1);
+
+    if (d->sleepers.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> sleep_lock(d->sleep_mutex);
+        }
+        d->sleep_cond.notify_all();
+    }
+
+    g_in_parallel = true;
+    d->work(0);
+    g_in_parallel = false;
+
+    // every chunk is claimed, wait for the workers still executing theirs
+    // yield once spinning stops paying off, an oversubscribed worker may need this cpu to finish
+    d->open.store(false);
+    for (int spin = 0; d->active.load() != 0; spin++)
+    {
+        if (spin < TINYINFER_THREADPOOL_SPIN_COUNT)
+            cpu_relax();
+        else
+            std::this_thread::yield();
+    }
+}
+
+ThreadPool* get_default_threadpool()
+{
+    static ThreadPool default_threadpool(get_cpu_count());
+    return &default_threadpool;
+}
+
+} // namespace tinyinfer
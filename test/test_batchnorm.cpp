@@ -0,0 +1,62 @@
+#include "testutil.h"
+
+static int test_batchnorm(const tinyinfer::Mat& a, float eps)
+{
+    int channels;
+    if (a.dims == 1) channels = a.w;
+    if (a.dims == 2) channels = a.h;
+    if (a.dims == 3) channels = a.c;
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, channels);
+    pd.set(1, eps);
+
+    // slope mean var bias, var must be positive
+    std::vector<tinyinfer::Mat> weights(4);
+    weights[0] = RandomMat(channels);
+    weights[1] = RandomMat(channels);
+    weights[2] = RandomMat(channels, 0.001f, 2.f);
+    weights[3] = RandomMat(channels);
+
+    int ret = test_layer("BatchNorm", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_batchnorm failed a.dims=%d a=(%d %d %d) eps=%f\n", a.dims, a.w, a.h, a.c, eps);
+    }
+
+    return ret;
+}
+
+static int test_batchnorm_0()
+{
+    return 0
+           || test_batchnorm(RandomMat(5, 7, 24), 0.f)
+           || test_batchnorm(RandomMat(7, 9, 12), 0.01f)
+           || test_batchnorm(RandomMat(3, 5, 13), 0.001f);
+}
+
+static int test_batchnorm_1()
+{
+    return 0
+           || test_batchnorm(RandomMat(15, 24), 0.f)
+           || test_batchnorm(RandomMat(19, 12), 0.01f)
+           || test_batchnorm(RandomMat(17, 15), 0.001f);
+}
+
+static int test_batchnorm_2()
+{
+    return 0
+           || test_batchnorm(RandomMat(128), 0.f)
+           || test_batchnorm(RandomMat(124), 0.01f)
+           || test_batchnorm(RandomMat(127), 0.001f);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_batchnorm_0()
+           || test_batchnorm_1()
+           || test_batchnorm_2();
+}
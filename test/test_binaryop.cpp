@@ -0,0 +1,216 @@
+#include "testutil.h"
+
+#define OP_TYPE_MAX 12
+
+static bool pow_base_is_a(int op_type)
+{
+    return op_type == 6;
+}
+
+static bool pow_base_is_b(int op_type)
+{
+    return op_type == 9;
+}
+
+static int test_binaryop(const tinyinfer::Mat& _a, const tinyinfer::Mat& _b, int op_type)
+{
+    tinyinfer::Mat a = _a.clone();
+    tinyinfer::Mat b = _b.clone();
+
+    // pow of a negative base is nan for most exponents, the comparison would not see it
+    if (pow_base_is_a(op_type))
+        Randomize(a, 0.001f, 2.f);
+    if (pow_base_is_b(op_type))
+        Randomize(b, 0.001f, 2.f);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, op_type);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    std::vector<tinyinfer::Mat> ab(2);
+    ab[0] = a;
+    ab[1] = b;
+
+    int ret = test_layer("BinaryOp", pd, weights, ab, 1);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_binaryop failed a.dims=%d a=(%d %d %d %d) b.dims=%d b=(%d %d %d %d) op_type=%d\n", a.dims, a.w, a.h, a.d, a.c, b.dims, b.w, b.h, b.d, b.c, op_type);
+    }
+
+    return ret;
+}
+
+// both orders, the broadcast is symmetric but the non commutative ops are not
+static int test_binaryop_pair(const tinyinfer::Mat& a, const tinyinfer::Mat& b)
+{
+    for (int op_type = 0; op_type < OP_TYPE_MAX; op_type++)
+    {
+        int ret = test_binaryop(a, b, op_type) || test_binaryop(b, a, op_type);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_binaryop_scalar(const tinyinfer::Mat& _a, float b)
+{
+    for (int op_type = 0; op_type < OP_TYPE_MAX; op_type++)
+    {
+        tinyinfer::Mat a = _a.clone();
+        if (pow_base_is_a(op_type))
+            Randomize(a, 0.001f, 2.f);
+
+        // rpow raises b, keep the base positive
+        const float bb = pow_base_is_b(op_type) ? fabsf(b) + 0.1f : b;
+
+        tinyinfer::ParamDict pd;
+        pd.set(0, op_type);
+        pd.set(1, 1);
+        pd.set(2, bb);
+
+        std::vector<tinyinfer::Mat> weights(0);
+
+        int ret = test_layer("BinaryOp", pd, weights, a);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_binaryop_scalar failed a.dims=%d a=(%d %d %d %d) b=%f op_type=%d\n", a.dims, a.w, a.h, a.d, a.c, bb, op_type);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+// same shape and one value against everything
+static int test_binaryop_0()
+{
+    return 0
+           || test_binaryop_pair(RandomMat(13), RandomMat(13))
+           || test_binaryop_pair(RandomMat(11, 7), RandomMat(11, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(5, 6, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(5, 6, 3, 7))
+           || test_binaryop_pair(RandomMat(35), RandomMat(1))
+           || test_binaryop_pair(RandomMat(11, 7), RandomMat(1))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(1))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(1))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(1, 1, 1))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(1, 1, 1, 1));
+}
+
+// a lower rank operand expanded onto the higher rank one
+static int test_binaryop_1()
+{
+    return 0
+           // 1d against 2d, along h and along w
+           || test_binaryop_pair(RandomMat(11, 7), RandomMat(7))
+           || test_binaryop_pair(RandomMat(11, 7), RandomMat(11))
+           // 1d against 3d and 4d, per channel and along w
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(7))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(5))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(7))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(5))
+           // 2d against 3d and 4d on the outer axes
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(6, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(1, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(6, 1))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(3, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(1, 7))
+           // 3d against 4d
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(6, 3, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(1, 3, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(6, 1, 1));
+}
+
+// axes of 1 within the same rank, including both operands broadcast into a larger output
+static int test_binaryop_2()
+{
+    return 0
+           || test_binaryop_pair(RandomMat(11, 7), RandomMat(1, 7))
+           || test_binaryop_pair(RandomMat(11, 7), RandomMat(11, 1))
+           || test_binaryop_pair(RandomMat(11, 1), RandomMat(1, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(1, 1, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(5, 6, 1))
+           || test_binaryop_pair(RandomMat(5, 6, 7), RandomMat(5, 1, 7))
+           || test_binaryop_pair(RandomMat(5, 1, 7), RandomMat(1, 6, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 1), RandomMat(1, 1, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(1, 1, 1, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(5, 6, 1, 7))
+           || test_binaryop_pair(RandomMat(5, 6, 3, 7), RandomMat(5, 1, 3, 1))
+           || test_binaryop_pair(RandomMat(5, 1, 3, 1), RandomMat(1, 6, 1, 7));
+}
+
+// large single channel and many channel blobs, split into chunks and rows across the threads
+static int test_binaryop_3()
+{
+    return 0
+           || test_binaryop_pair(RandomMat(70001), RandomMat(70001))
+           || test_binaryop_pair(RandomMat(300, 200), RandomMat(1))
+           || test_binaryop_pair(RandomMat(300, 200), RandomMat(200))
+           || test_binaryop_pair(RandomMat(64, 64, 64), RandomMat(64))
+           || test_binaryop_pair(RandomMat(64, 64, 64), RandomMat(64, 1, 64));
+}
+
+static int test_binaryop_4()
+{
+    return 0
+           || test_binaryop_scalar(RandomMat(5, 6, 3, 7), 0.3f)
+           || test_binaryop_scalar(RandomMat(5, 6, 7), -1.4f)
+           || test_binaryop_scalar(RandomMat(11, 7), 2.f)
+           || test_binaryop_scalar(RandomMat(70001), 0.7f)
+           || test_binaryop_scalar(RandomMat(13), 0.f);
+}
+
+// shapes that do not broadcast are rejected, and a full size first operand is written in place
+static int test_binaryop_5()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, 0);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    for (int isa = TINYINFER_ISA_NAIVE; isa <= tinyinfer::cpu_isa_level(); isa++)
+    {
+        tinyinfer::Layer* op = tinyinfer::create_layer_isa(tinyinfer::layer_to_index("BinaryOp"), isa);
+        op->load_param(pd);
+        op->create_pipeline(opt);
+
+        std::vector<tinyinfer::Mat> bad(2);
+        bad[0] = RandomMat(5, 6, 7);
+        bad[1] = RandomMat(4, 6, 7);
+        const int ret_bad = op->forward_inplace(bad, opt);
+
+        std::vector<tinyinfer::Mat> ab(2);
+        ab[0] = RandomMat(5, 6, 7);
+        ab[1] = RandomMat(1, 6, 7);
+        const void* adata = ab[0].data;
+        const int ret = op->forward_inplace(ab, opt);
+
+        op->destroy_pipeline(opt);
+        delete op;
+
+        if (ret_bad == 0 || ret != 0 || ab[0].data != adata)
+        {
+            fprintf(stderr, "test_binaryop_5 isa %d failed ret_bad=%d ret=%d inplace=%d\n", isa, ret_bad, ret, ab[0].data == adata);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_binaryop_0()
+           || test_binaryop_1()
+           || test_binaryop_2()
+           || test_binaryop_3()
+           || test_binaryop_4()
+           || test_binaryop_5();
+}
@@ -0,0 +1,53 @@
+#include "testutil.h"
+
+static int test_clip(const tinyinfer::Mat& a, float min, float max)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, min);
+    pd.set(1, max);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("Clip", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_clip failed a.dims=%d a=(%d %d %d %d) min=%f max=%f\n", a.dims, a.w, a.h, a.d, a.c, min, max);
+    }
+
+    return ret;
+}
+
+static int test_clip_0()
+{
+    return 0
+           || test_clip(RandomMat(5, 6, 7, 24), -1.f, 1.f)
+           || test_clip(RandomMat(7, 9, 12), 0.f, 0.6f)
+           || test_clip(RandomMat(3, 5, 13), -0.2f, 0.2f);
+}
+
+static int test_clip_1()
+{
+    return 0
+           || test_clip(RandomMat(15, 24), -1.f, 1.f)
+           || test_clip(RandomMat(19, 12), 0.f, 0.6f)
+           || test_clip(RandomMat(17, 15), -0.2f, 0.2f);
+}
+
+static int test_clip_2()
+{
+    return 0
+           || test_clip(RandomMat(128), -1.f, 1.f)
+           || test_clip(RandomMat(127), 0.f, 0.6f)
+           || test_clip(RandomMat(40000), -0.2f, 0.2f)
+           || test_clip(RandomMat(124), -FLT_MAX, FLT_MAX);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_clip_0()
+           || test_clip_1()
+           || test_clip_2();
+}
@@ -0,0 +1,152 @@
+#include "testutil.h"
+
+// the element at outermost first coordinates, padded to four axes
+static float concat_at(const tinyinfer::Mat& m, const int* i4)
+{
+    return ((const float*)m.data)[m.cstep * i4[0] + ((size_t)i4[1] * m.h + i4[2]) * m.w + i4[3]];
+}
+
+static void concat_shape(const tinyinfer::Mat& m, int* s4)
+{
+    s4[0] = m.c;
+    s4[1] = m.d;
+    s4[2] = m.h;
+    s4[3] = m.w;
+}
+
+static int test_concat(const std::vector<tinyinfer::Mat>& a, int axis)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, axis);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    std::vector<tinyinfer::Mat> b(1);
+    int ret = test_layer_forward(tinyinfer::layer_to_index("Concat"), TINYINFER_ISA_NAIVE, pd, weights, a, b);
+
+    // the axis among the four padded ones, a 3d blob has no depth
+    const int dims = a[0].dims;
+    const int positive_axis = axis < 0 ? dims + axis : axis;
+    const int axis4 = dims == 3 ? (positive_axis == 0 ? 0 : positive_axis + 1) : 4 - dims + positive_axis;
+
+    int os[4];
+    concat_shape(b[0], os);
+    for (int i0 = 0; ret == 0 && i0 < os[0]; i0++)
+    {
+        for (int i1 = 0; ret == 0 && i1 < os[1]; i1++)
+        {
+            for (int i2 = 0; ret == 0 && i2 < os[2]; i2++)
+            {
+                for (int i3 = 0; ret == 0 && i3 < os[3]; i3++)
+                {
+                    int i4[4] = {i0, i1, i2, i3};
+                    float expect = 0.f;
+                    int k = i4[axis4];
+                    for (size_t j = 0; j < a.size(); j++)
+                    {
+                        int s4[4];
+                        concat_shape(a[j], s4);
+                        if (k < s4[axis4])
+                        {
+                            int j4[4] = {i0, i1, i2, i3};
+                            j4[axis4] = k;
+                            expect = concat_at(a[j], j4);
+                            break;
+                        }
+                        k -= s4[axis4];
+                    }
+
+                    const int o4[4] = {i0, i1, i2, i3};
+                    if (concat_at(b[0], o4) != expect)
+                        ret = -1;
+                }
+            }
+        }
+    }
+
+    if (ret != 0 || b[0].dims != dims)
+    {
+        fprintf(stderr, "test_concat failed a.dims=%d a=(%d %d %d %d) inputs=%d axis=%d\n", dims, a[0].w, a[0].h, a[0].d, a[0].c, (int)a.size(), axis);
+        return -1;
+    }
+
+    return 0;
+}
+
+static std::vector<tinyinfer::Mat> concat_inputs(const tinyinfer::Mat& a, const tinyinfer::Mat& b, const tinyinfer::Mat& c = tinyinfer::Mat())
+{
+    std::vector<tinyinfer::Mat> v;
+    v.push_back(a);
+    v.push_back(b);
+    if (!c.empty())
+        v.push_back(c);
+    return v;
+}
+
+// every axis of every rank, including planes that are not a multiple of four floats
+static int test_concat_0()
+{
+    return 0
+           || test_concat(concat_inputs(RandomMat(7), RandomMat(9), RandomMat(1)), 0)
+           || test_concat(concat_inputs(RandomMat(7), RandomMat(9)), -1)
+           || test_concat(concat_inputs(RandomMat(5, 3), RandomMat(5, 4), RandomMat(5, 1)), 0)
+           || test_concat(concat_inputs(RandomMat(5, 3), RandomMat(2, 3), RandomMat(7, 3)), 1)
+           || test_concat(concat_inputs(RandomMat(5, 3, 4), RandomMat(5, 3, 6)), 0)
+           || test_concat(concat_inputs(RandomMat(5, 3, 4), RandomMat(5, 2, 4), RandomMat(5, 1, 4)), 1)
+           || test_concat(concat_inputs(RandomMat(5, 3, 4), RandomMat(2, 3, 4)), 2)
+           || test_concat(concat_inputs(RandomMat(5, 3, 4), RandomMat(2, 3, 4)), -1)
+           || test_concat(concat_inputs(RandomMat(5, 3, 2, 4), RandomMat(5, 3, 2, 3)), 0)
+           || test_concat(concat_inputs(RandomMat(5, 3, 2, 4), RandomMat(5, 3, 3, 4)), 1)
+           || test_concat(concat_inputs(RandomMat(5, 3, 2, 4), RandomMat(5, 1, 2, 4)), 2)
+           || test_concat(concat_inputs(RandomMat(5, 3, 2, 4), RandomMat(6, 3, 2, 4)), 3)
+           || test_concat(concat_inputs(RandomMat(56, 56, 64), RandomMat(56, 56, 32)), 0);
+}
+
+// mismatched shapes are rejected, an input already in its slice of the top is not copied
+static int test_concat_1()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, 0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Layer* op = tinyinfer::create_layer(tinyinfer::layer_to_index("Concat"));
+    op->load_param(pd);
+
+    std::vector<tinyinfer::Mat> bad = concat_inputs(RandomMat(5, 3, 4), RandomMat(5, 2, 4));
+    std::vector<tinyinfer::Mat> top(1);
+    const int ret_bad = op->forward(bad, top, opt);
+
+    // the first input lives in the front channels of a preallocated top
+    tinyinfer::Mat out(5, 3, 6);
+    tinyinfer::Mat a = out.channel_range(0, 4);
+    Randomize(a);
+    tinyinfer::Mat b = RandomMat(5, 3, 2);
+
+    top[0] = out;
+    out.release();
+    const void* outdata = top[0].data;
+
+    tinyinfer::reset_mat_copy_bytes();
+    const int ret = op->forward(concat_inputs(a, b), top, opt);
+    const size_t copied = tinyinfer::get_mat_copy_bytes();
+
+    delete op;
+
+    if (ret_bad == 0 || ret != 0 || top[0].data != outdata || copied != (size_t)5 * 3 * 2 * sizeof(float))
+    {
+        fprintf(stderr, "test_concat_1 failed ret_bad=%d ret=%d kept=%d copied=%d\n", ret_bad, ret, top[0].data == outdata, (int)copied);
+        return -1;
+    }
+
+    return test_concat(concat_inputs(a, b), 0);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_concat_0()
+           || test_concat_1();
+}
@@ -0,0 +1,132 @@
+#include "testutil.h"
+
+static int test_convolution(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias, int activation_type = 0)
+{
+    tinyinfer::Mat a = RandomMat(w, h, c);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, kernel);
+    pd.set(2, dilation);
+    pd.set(3, stride);
+    pd.set(4, pad);
+    pd.set(5, bias);
+    pd.set(6, outch * c * kernel * kernel);
+    pd.set(9, activation_type);
+
+    tinyinfer::Mat activation_params(2);
+    activation_params[0] = activation_type == 3 ? -0.5f : 0.1f;
+    activation_params[1] = 0.5f;
+    pd.set(10, activation_params);
+
+    std::vector<tinyinfer::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * c * kernel * kernel);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    int ret = test_layer("Convolution", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d act=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias, activation_type);
+    }
+
+    return ret;
+}
+
+// 3x3 stride 1 and 2, the direct kernels
+static int test_convolution_0()
+{
+    return 0
+           || test_convolution(9, 7, 1, 1, 3, 1, 1, 1, 1)
+           || test_convolution(9, 7, 3, 5, 3, 1, 1, 0, 0)
+           || test_convolution(40, 11, 4, 8, 3, 1, 1, 1, 1, 1)
+           || test_convolution(13, 13, 16, 17, 3, 1, 1, 1, 1, 2)
+           || test_convolution(7, 7, 32, 12, 3, 1, 1, 1, 0, 3)
+           || test_convolution(9, 7, 3, 5, 3, 1, 2, 1, 1)
+           || test_convolution(40, 9, 4, 8, 3, 1, 2, 0, 1, 1)
+           || test_convolution(69, 21, 5, 6, 3, 1, 2, 1, 1, 4)
+           || test_convolution(14, 14, 24, 33, 3, 1, 2, -233, 1)
+           || test_convolution(15, 15, 8, 8, 3, 1, 1, -234, 0);
+}
+
+// 1x1 as gemm on the channel major input
+static int test_convolution_1()
+{
+    return 0
+           || test_convolution(1, 1, 1, 1, 1, 1, 1, 0, 1)
+           || test_convolution(9, 7, 3, 5, 1, 1, 1, 0, 0)
+           || test_convolution(13, 11, 16, 33, 1, 1, 1, 0, 1, 1)
+           || test_convolution(28, 28, 64, 24, 1, 1, 1, 0, 1, 3)
+           || test_convolution(6, 5, 7, 9, 1, 1, 1, 1, 1);
+}
+
+// generic im2col, other kernels, dilation and strides
+static int test_convolution_2()
+{
+    return 0
+           || test_convolution(9, 7, 3, 5, 1, 1, 2, 0, 1)
+           || test_convolution(9, 7, 3, 5, 2, 1, 1, 0, 1)
+           || test_convolution(16, 15, 4, 6, 3, 2, 1, 2, 1, 1)
+           || test_convolution(17, 13, 3, 16, 5, 1, 1, 2, 1)
+           || test_convolution(23, 23, 3, 8, 7, 1, 2, 3, 1, 2)
+           || test_convolution(12, 12, 6, 7, 3, 1, 3, 1, 0)
+           || test_convolution(10, 10, 5, 9, 4, 1, 2, -233, 1);
+}
+
+// winograd against the naive direct convolution, maps large enough to take the winograd path
+static int test_convolution_winograd(int w, int h, int c, int outch, int pad, int bias, bool winograd63, int activation_type = 0)
+{
+    tinyinfer::Mat a = RandomMat(w, h, c);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, 3);
+    pd.set(4, pad);
+    pd.set(5, bias);
+    pd.set(6, outch * c * 9);
+    pd.set(9, activation_type);
+
+    std::vector<tinyinfer::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * c * 9);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    tinyinfer::Option opt;
+    opt.use_winograd_convolution = true;
+    opt.use_winograd63_convolution = winograd63;
+
+    // F(6,3) transforms have entries up to 32 and 5.25, it loses a little more precision than F(4,3)
+    float epsilon = winograd63 ? 0.002f : 0.001f;
+
+    int ret = test_layer("Convolution", pd, weights, opt, a, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_winograd failed w=%d h=%d c=%d outch=%d pad=%d bias=%d winograd63=%d act=%d\n", w, h, c, outch, pad, bias, winograd63, activation_type);
+    }
+
+    return ret;
+}
+
+static int test_convolution_3()
+{
+    return 0
+           || test_convolution_winograd(12, 12, 8, 8, 1, 1, true)
+           || test_convolution_winograd(14, 20, 16, 24, 1, 1, true, 1)
+           || test_convolution_winograd(38, 25, 32, 19, 0, 0, true)
+           || test_convolution_winograd(58, 58, 64, 64, 1, 1, true)
+           || test_convolution_winograd(12, 12, 8, 8, 1, 1, false)
+           || test_convolution_winograd(13, 11, 16, 24, 1, 1, false, 1)
+           || test_convolution_winograd(38, 25, 32, 19, 0, 0, false)
+           || test_convolution_winograd(58, 58, 64, 64, 1, 1, false);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_convolution_0()
+           || test_convolution_1()
+           || test_convolution_2()
+           || test_convolution_3();
+}
@@ -0,0 +1,91 @@
+#include "testutil.h"
+
+static int test_convolutiondepthwise(int w, int h, int c, int outch, int group, int kernel, int dilation, int stride, int pad, int bias, int activation_type = 0)
+{
+    tinyinfer::Mat a = RandomMat(w, h, c);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, kernel);
+    pd.set(2, dilation);
+    pd.set(3, stride);
+    pd.set(4, pad);
+    pd.set(5, bias);
+    pd.set(6, outch / group * c * kernel * kernel);
+    pd.set(7, group);
+    pd.set(9, activation_type);
+
+    tinyinfer::Mat activation_params(2);
+    activation_params[0] = activation_type == 3 ? -0.5f : 0.1f;
+    activation_params[1] = 0.5f;
+    pd.set(10, activation_params);
+
+    std::vector<tinyinfer::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch / group * c * kernel * kernel);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    int ret = test_layer("ConvolutionDepthWise", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolutiondepthwise failed w=%d h=%d c=%d outch=%d group=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d act=%d\n", w, h, c, outch, group, kernel, dilation, stride, pad, bias, activation_type);
+    }
+
+    return ret;
+}
+
+// depthwise 3x3 and 5x5 with their taps unrolled, channel counts off the vector width and maps narrower than it
+static int test_convolutiondepthwise_0()
+{
+    return 0
+           || test_convolutiondepthwise(9, 7, 1, 1, 1, 3, 1, 1, 1, 1)
+           || test_convolutiondepthwise(7, 7, 32, 32, 32, 3, 1, 1, 1, 1, 1)
+           || test_convolutiondepthwise(40, 11, 17, 17, 17, 3, 1, 1, 0, 0)
+           || test_convolutiondepthwise(14, 14, 24, 24, 24, 3, 1, 2, 1, 1, 3)
+           || test_convolutiondepthwise(33, 21, 5, 5, 5, 3, 1, 2, 0, 1, 2)
+           || test_convolutiondepthwise(13, 13, 16, 16, 16, 5, 1, 1, 2, 1, 4)
+           || test_convolutiondepthwise(28, 28, 8, 8, 8, 5, 1, 2, 2, 0, 1)
+           || test_convolutiondepthwise(15, 15, 12, 12, 12, 3, 1, 2, -233, 1)
+           || test_convolutiondepthwise(16, 10, 12, 12, 12, 5, 1, 1, -234, 1);
+}
+
+// depthwise with other kernels and dilation, the generic tap loop
+static int test_convolutiondepthwise_1()
+{
+    return 0
+           || test_convolutiondepthwise(9, 7, 4, 4, 4, 1, 1, 1, 0, 1)
+           || test_convolutiondepthwise(16, 15, 6, 6, 6, 3, 2, 1, 2, 1, 1)
+           || test_convolutiondepthwise(23, 23, 3, 3, 3, 7, 1, 2, 3, 1)
+           || test_convolutiondepthwise(12, 12, 5, 5, 5, 4, 1, 2, -233, 0)
+           || test_convolutiondepthwise(12, 12, 5, 5, 5, 3, 1, 3, 1, 1);
+}
+
+// grouped convolution with several channels per group
+static int test_convolutiondepthwise_2()
+{
+    return 0
+           || test_convolutiondepthwise(9, 7, 8, 8, 4, 3, 1, 1, 1, 1)
+           || test_convolutiondepthwise(11, 13, 6, 12, 3, 3, 1, 2, 1, 0, 1)
+           || test_convolutiondepthwise(8, 8, 4, 8, 4, 1, 1, 1, 0, 1)
+           || test_convolutiondepthwise(10, 10, 16, 16, 2, 5, 1, 1, 2, 1);
+}
+
+// wide maps split into several strips of output rows
+static int test_convolutiondepthwise_3()
+{
+    return 0
+           || test_convolutiondepthwise(200, 24, 3, 3, 3, 3, 1, 1, 1, 1, 1)
+           || test_convolutiondepthwise(301, 30, 18, 18, 18, 3, 1, 2, 1, 1)
+           || test_convolutiondepthwise(250, 19, 4, 4, 4, 5, 1, 2, 2, 0, 3);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_convolutiondepthwise_0()
+           || test_convolutiondepthwise_1()
+           || test_convolutiondepthwise_2()
+           || test_convolutiondepthwise_3();
+}
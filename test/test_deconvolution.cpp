@@ -0,0 +1,183 @@
+#include "testutil.h"
+
+static int test_deconvolution(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int output_pad, int output_size, int bias, int activation_type = 0)
+{
+    tinyinfer::Mat a = RandomMat(w, h, c);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, kernel);
+    pd.set(2, dilation);
+    pd.set(3, stride);
+    pd.set(4, pad);
+    pd.set(5, bias);
+    pd.set(6, outch * c * kernel * kernel);
+    pd.set(9, activation_type);
+    pd.set(18, output_pad);
+    pd.set(20, output_size);
+
+    tinyinfer::Mat activation_params(2);
+    activation_params[0] = activation_type == 3 ? -0.5f : 0.1f;
+    activation_params[1] = 0.5f;
+    pd.set(10, activation_params);
+
+    std::vector<tinyinfer::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * c * kernel * kernel);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    int ret = test_layer("DeConvolution", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_deconvolution failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d output_pad=%d output_size=%d bias=%d act=%d\n", w, h, c, outch, kernel, dilation, stride, pad, output_pad, output_size, bias, activation_type);
+    }
+
+    return ret;
+}
+
+// the naive layer itself, 2x2 stride 2 copies every input pixel into its own 2x2 block
+static int test_deconvolution_reference()
+{
+    tinyinfer::Mat a(2, 2, 1);
+    for (int i = 0; i < 4; i++)
+        a[i] = (float)(i + 1);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, 1);
+    pd.set(1, 2);
+    pd.set(3, 2);
+    pd.set(6, 4);
+
+    std::vector<tinyinfer::Mat> weights(1);
+    weights[0] = tinyinfer::Mat(4);
+    weights[0].fill(1.f);
+
+    tinyinfer::Option opt;
+    opt.num_threads = 1;
+
+    tinyinfer::Mat b;
+    if (test_layer_forward(tinyinfer::layer_to_index("DeConvolution"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b) != 0)
+    {
+        fprintf(stderr, "test_deconvolution_reference forward failed\n");
+        return -1;
+    }
+
+    tinyinfer::Mat expect(4, 4, 1);
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 4; x++)
+        {
+            expect.row(y)[x] = a.row(y / 2)[x / 2];
+        }
+    }
+
+    if (CompareMat(b, expect) != 0)
+    {
+        fprintf(stderr, "test_deconvolution_reference output mismatch\n");
+        return -1;
+    }
+
+    // onnx output sizes, explicit pads with output_padding, SAME and output_shape
+    const int cases[][5] = {
+        // pad output_pad output_size expected_w input_w
+        {1, 1, 0, 10, 5},
+        {-233, 0, 0, 10, 5},
+        {-234, 0, 0, 10, 5},
+        {0, 0, 9, 9, 4},
+    };
+
+    for (int i = 0; i < 4; i++)
+    {
+        tinyinfer::ParamDict pd2;
+        pd2.set(0, 1);
+        pd2.set(1, 3);
+        pd2.set(3, 2);
+        pd2.set(4, cases[i][0]);
+        pd2.set(6, 9);
+        pd2.set(18, cases[i][1]);
+        pd2.set(20, cases[i][2]);
+
+        std::vector<tinyinfer::Mat> weights2(1);
+        weights2[0] = RandomMat(9);
+
+        tinyinfer::Mat a2 = RandomMat(cases[i][4], cases[i][4], 1);
+        tinyinfer::Mat b2;
+        if (test_layer_forward(tinyinfer::layer_to_index("DeConvolution"), TINYINFER_ISA_NAIVE, pd2, weights2, opt, a2, b2) != 0 || b2.w != cases[i][3] || b2.h != cases[i][3])
+        {
+            fprintf(stderr, "test_deconvolution_reference output size mismatch case %d\n", i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// stride 2 sub-pixel path on layers that widen the channels, kernels wider, equal and narrower than the stride
+static int test_deconvolution_0()
+{
+    return 0
+           || test_deconvolution(9, 7, 1, 2, 3, 1, 2, 0, 0, 0, 1)
+           || test_deconvolution(8, 8, 8, 16, 4, 1, 2, 1, 0, 0, 1, 1)
+           || test_deconvolution(7, 5, 12, 24, 2, 1, 2, 0, 0, 0, 0)
+           || test_deconvolution(6, 6, 5, 7, 3, 1, 2, 1, 1, 0, 1, 2)
+           || test_deconvolution(10, 9, 4, 6, 1, 1, 2, 0, 1, 0, 1, 3)
+           || test_deconvolution(5, 5, 8, 12, 5, 1, 2, 2, 1, 0, 1, 4)
+           || test_deconvolution(40, 33, 3, 17, 4, 1, 2, 1, 0, 0, 1);
+}
+
+// gemm + col2im, stride 1 and 3, dilation and stride 2 layers that narrow the channels
+static int test_deconvolution_1()
+{
+    return 0
+           || test_deconvolution(9, 7, 1, 1, 3, 1, 1, 0, 0, 0, 1)
+           || test_deconvolution(8, 8, 16, 8, 3, 1, 1, 1, 0, 0, 1, 1)
+           || test_deconvolution(7, 5, 12, 24, 1, 1, 1, 0, 0, 0, 0)
+           || test_deconvolution(6, 6, 5, 7, 4, 2, 1, 2, 0, 0, 1, 6)
+           || test_deconvolution(10, 9, 4, 3, 3, 1, 3, 1, 2, 0, 1, 2)
+           || test_deconvolution(5, 5, 8, 8, 3, 2, 2, 1, 1, 0, 1)
+           || test_deconvolution(40, 33, 3, 17, 2, 1, 3, 0, 0, 0, 1, 1)
+           || test_deconvolution(9, 8, 16, 8, 4, 1, 2, 1, 0, 0, 1, 1)
+           || test_deconvolution(7, 7, 12, 6, 3, 1, 2, 1, 1, 0, 1);
+}
+
+// SAME padding and explicit output size, including windows larger than the full output
+static int test_deconvolution_2()
+{
+    return 0
+           || test_deconvolution(9, 7, 4, 6, 3, 1, 2, -233, 0, 0, 1)
+           || test_deconvolution(9, 7, 4, 6, 3, 1, 2, -234, 0, 0, 1, 1)
+           || test_deconvolution(8, 8, 4, 6, 4, 1, 1, -233, 0, 0, 1)
+           || test_deconvolution(6, 6, 5, 3, 3, 1, 2, 0, 0, 12, 1)
+           || test_deconvolution(6, 6, 5, 3, 3, 1, 2, -233, 0, 12, 1)
+           || test_deconvolution(9, 7, 3, 6, 3, 1, 2, -234, 0, 0, 1)
+           || test_deconvolution(6, 6, 3, 5, 3, 1, 2, 0, 0, 13, 1)
+           || test_deconvolution(6, 6, 3, 5, 4, 1, 2, -233, 0, 15, 1, 1)
+           || test_deconvolution(6, 6, 5, 3, 1, 1, 2, -233, 0, 0, 1)
+           || test_deconvolution(6, 6, 5, 3, 3, 1, 3, 0, 0, 20, 1)
+           || test_deconvolution(6, 6, 5, 3, 3, 1, 1, 0, 0, 6, 1);
+}
+
+// large maps split into several column blocks
+static int test_deconvolution_3()
+{
+    return 0
+           || test_deconvolution(64, 48, 32, 16, 4, 1, 2, 1, 0, 0, 1, 1)
+           || test_deconvolution(64, 48, 32, 16, 3, 1, 2, 1, 1, 0, 1)
+           || test_deconvolution(64, 48, 16, 32, 4, 1, 2, 1, 0, 0, 1)
+           || test_deconvolution(48, 40, 48, 64, 4, 1, 2, 1, 0, 0, 1, 1)
+           || test_deconvolution(47, 41, 48, 56, 3, 1, 2, 1, 1, 0, 1)
+           || test_deconvolution(64, 48, 32, 16, 3, 1, 1, 1, 0, 0, 1)
+           || test_deconvolution(50, 41, 64, 64, 2, 1, 3, 0, 0, 0, 0);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_deconvolution_reference()
+           || test_deconvolution_0()
+           || test_deconvolution_1()
+           || test_deconvolution_2()
+           || test_deconvolution_3();
+}
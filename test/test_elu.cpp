@@ -0,0 +1,61 @@
+#include "testutil.h"
+
+static int test_elu(const tinyinfer::Mat& a, float alpha)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, alpha);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("ELU", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_elu failed a.dims=%d a=(%d %d %d %d) alpha=%f\n", a.dims, a.w, a.h, a.d, a.c, alpha);
+    }
+
+    return ret;
+}
+
+static int test_elu_0()
+{
+    return 0
+           || test_elu(RandomMat(5, 6, 7, 24, -5.f, 5.f), 0.1f)
+           || test_elu(RandomMat(7, 9, 12, -5.f, 5.f), 1.f)
+           || test_elu(RandomMat(3, 5, 13, -5.f, 5.f), 1.5f)
+           || test_elu(RandomMat(19, 12, -5.f, 5.f), 0.1f)
+           || test_elu(RandomMat(127, -5.f, 5.f), 1.f)
+           || test_elu(RandomMat(40000, -100.f, 100.f), 1.f);
+}
+
+static double ref_elu(double x)
+{
+    return x < 0.0 ? expm1(x) : x;
+}
+
+// alpha 1, expm1 keeps small negative inputs accurate where exp(x) - 1 would cancel
+static int test_elu_1()
+{
+    const float specials[] = {0.f, -0.f, INFINITY, -INFINITY, NAN, -FLT_TRUE_MIN, -FLT_MAX, 1e-20f, -1e-20f};
+    const int count = sizeof(specials) / sizeof(float);
+
+    tinyinfer::Mat x(count);
+    for (int i = 0; i < count; i++)
+        x[i] = specials[i];
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, 1.f);
+
+    return 0
+           || test_layer_accuracy("ELU", pd, tinyinfer::Option(), SweepMat(100000, -100.f, 20.f, false), ref_elu, 1)
+           || test_layer_accuracy("ELU", pd, tinyinfer::Option(), SweepMat(100000, -1e-30f, -1.f, true), ref_elu, 1)
+           || test_layer_accuracy("ELU", pd, tinyinfer::Option(), x, ref_elu, 1);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_elu_0()
+           || test_elu_1();
+}
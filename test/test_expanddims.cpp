@@ -0,0 +1,89 @@
+#include "testutil.h"
+
+static int test_expanddims(const tinyinfer::Mat& a, const std::vector<int>& axes, int dims, int w, int h, int d, int c, bool view)
+{
+    tinyinfer::ParamDict pd;
+    tinyinfer::Mat axes_mat((int)axes.size());
+    for (size_t i = 0; i < axes.size(); i++)
+        ((int*)axes_mat.data)[i] = axes[i];
+    pd.set(3, axes_mat);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Mat b;
+    tinyinfer::reset_mat_copy_bytes();
+    int ret = test_layer_forward(tinyinfer::layer_to_index("ExpandDims"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b);
+    const size_t copied = tinyinfer::get_mat_copy_bytes();
+
+    if (ret != 0 || b.dims != dims || b.w != w || b.h != h || b.d != d || b.c != c || CompareMatFlat(a, b) != 0 || (view && (b.data != a.data || copied != 0)))
+    {
+        fprintf(stderr, "test_expanddims failed a.dims=%d a=(%d %d %d %d) axes=%d b.dims=%d b=(%d %d %d %d)\n", a.dims, a.w, a.h, a.d, a.c, (int)axes.size(), b.dims, b.w, b.h, b.d, b.c);
+        return -1;
+    }
+
+    return 0;
+}
+
+static std::vector<int> expand_axes(int a0, int a1 = -233)
+{
+    std::vector<int> axes(1, a0);
+    if (a1 != -233)
+        axes.push_back(a1);
+    return axes;
+}
+
+// a new leading axis of 1 is always a view, the others are unless the channel padding moves
+static int test_expanddims_0()
+{
+    return 0
+           || test_expanddims(RandomMat(7), expand_axes(0), 2, 7, 1, 1, 1, true)
+           || test_expanddims(RandomMat(7), expand_axes(-1), 2, 1, 7, 1, 1, true)
+           || test_expanddims(RandomMat(7), expand_axes(0, 1), 3, 7, 1, 1, 1, true)
+           || test_expanddims(RandomMat(7, 5), expand_axes(0), 3, 7, 5, 1, 1, true)
+           || test_expanddims(RandomMat(7, 5), expand_axes(1), 3, 7, 1, 1, 5, false)
+           || test_expanddims(RandomMat(8, 5), expand_axes(1), 3, 8, 1, 1, 5, true)
+           || test_expanddims(RandomMat(7, 5), expand_axes(-1), 3, 1, 7, 1, 5, false)
+           || test_expanddims(RandomMat(3, 5, 6), expand_axes(1), 4, 3, 5, 1, 6, true)
+           || test_expanddims(RandomMat(3, 5, 6), expand_axes(0), 4, 3, 5, 6, 1, false)
+           || test_expanddims(RandomMat(3, 5, 1), expand_axes(0), 4, 3, 5, 1, 1, true)
+           || test_expanddims(RandomMat(3, 5, 6), expand_axes(-1), 4, 1, 3, 5, 6, false);
+}
+
+// too many axes or a repeated one is rejected
+static int test_expanddims_1()
+{
+    tinyinfer::ParamDict pd;
+    tinyinfer::Mat axes_mat(2);
+    ((int*)axes_mat.data)[0] = 0;
+    ((int*)axes_mat.data)[1] = 0;
+    pd.set(3, axes_mat);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Mat b;
+    const int ret0 = test_layer_forward(tinyinfer::layer_to_index("ExpandDims"), TINYINFER_ISA_NAIVE, pd, weights, opt, RandomMat(5, 6), b);
+
+    ((int*)axes_mat.data)[1] = 1;
+    const int ret1 = test_layer_forward(tinyinfer::layer_to_index("ExpandDims"), TINYINFER_ISA_NAIVE, pd, weights, opt, RandomMat(3, 5, 6), b);
+
+    if (ret0 == 0 || ret1 == 0)
+    {
+        fprintf(stderr, "test_expanddims_1 failed ret0=%d ret1=%d\n", ret0, ret1);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_expanddims_0()
+           || test_expanddims_1();
+}
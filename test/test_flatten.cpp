@@ -0,0 +1,44 @@
+#include "testutil.h"
+
+static int test_flatten(const tinyinfer::Mat& a, bool view)
+{
+    tinyinfer::ParamDict pd;
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Mat b;
+    tinyinfer::reset_mat_copy_bytes();
+    int ret = test_layer_forward(tinyinfer::layer_to_index("Flatten"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b);
+    const size_t copied = tinyinfer::get_mat_copy_bytes();
+
+    if (ret != 0 || b.dims != 1 || b.w != a.w * a.h * a.d * a.c || CompareMatFlat(a, b) != 0 || (view != (b.data == a.data)) || (view && copied != 0))
+    {
+        fprintf(stderr, "test_flatten failed a.dims=%d a=(%d %d %d %d) view=%d copied=%d\n", a.dims, a.w, a.h, a.d, a.c, b.data == a.data, (int)copied);
+        return -1;
+    }
+
+    return 0;
+}
+
+// a view unless the channels are padded
+static int test_flatten_0()
+{
+    return 0
+           || test_flatten(RandomMat(13), true)
+           || test_flatten(RandomMat(13, 7), true)
+           || test_flatten(RandomMat(8, 7, 5), true)
+           || test_flatten(RandomMat(13, 7, 1), true)
+           || test_flatten(RandomMat(3, 3, 2, 5), false)
+           || test_flatten(RandomMat(4, 3, 2, 5), true)
+           || test_flatten(RandomMat(7, 7, 64), false)
+           || test_flatten(RandomMat(1, 1, 1280), false);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return test_flatten_0();
+}
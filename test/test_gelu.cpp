@@ -0,0 +1,90 @@
+#include "testutil.h"
+
+static int test_gelu(const tinyinfer::Mat& a, int approximate, bool fast)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, approximate);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+    opt.use_fast_activation = fast;
+
+    int ret = test_layer("GELU", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_gelu failed a.dims=%d a=(%d %d %d %d) approximate=%d fast=%d\n", a.dims, a.w, a.h, a.d, a.c, approximate, fast);
+    }
+
+    return ret;
+}
+
+static int test_gelu_0()
+{
+    for (int approximate = 0; approximate < 2; approximate++)
+    {
+        for (int fast = 0; fast < 2; fast++)
+        {
+            int ret = 0
+                      || test_gelu(RandomMat(5, 6, 7, 24, -8.f, 8.f), approximate, fast)
+                      || test_gelu(RandomMat(7, 9, 12, -8.f, 8.f), approximate, fast)
+                      || test_gelu(RandomMat(3, 5, 13, -8.f, 8.f), approximate, fast)
+                      || test_gelu(RandomMat(19, 12, -8.f, 8.f), approximate, fast)
+                      || test_gelu(RandomMat(127, -8.f, 8.f), approximate, fast)
+                      || test_gelu(RandomMat(40000, -100.f, 100.f), approximate, fast);
+
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+static double ref_gelu(double x)
+{
+    return 0.5 * x * erfc(-x * 0.70710678118654752);
+}
+
+// x * sigmoid(2u), 1 + tanh(u) cancels in double as well
+static double ref_gelu_tanh(double x)
+{
+    double u = 0.79788456080286536 * (x + 0.044715 * x * x * x);
+    return x / (1.0 + exp(-2.0 * u));
+}
+
+// exact mode, the erf form stays within a few ulp until the result leaves the normal range
+// the tanh form goes through exp of a rounded cubic 2u, its negative tail loses up to |2u| ulp to that rounding
+static int test_gelu_1()
+{
+    const float specials[] = {0.f, -0.f, INFINITY, -INFINITY, NAN, FLT_TRUE_MIN, -FLT_TRUE_MIN, FLT_MAX, -FLT_MAX, 1e-20f, -1e-20f};
+    const int count = sizeof(specials) / sizeof(float);
+
+    tinyinfer::Mat x(count);
+    for (int i = 0; i < count; i++)
+        x[i] = specials[i];
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, 0);
+
+    tinyinfer::ParamDict pd_tanh;
+    pd_tanh.set(0, 1);
+
+    return 0
+           || test_layer_accuracy("GELU", pd, tinyinfer::Option(), SweepMat(100000, -12.f, 20.f, false), ref_gelu, 8)
+           || test_layer_accuracy("GELU", pd, tinyinfer::Option(), SweepMat(100000, -30.f, -12.f, false), ref_gelu, 8, 1e-43)
+           || test_layer_accuracy("GELU", pd, tinyinfer::Option(), SweepMat(100000, 1e-30f, 1.f, true), ref_gelu, 8)
+           || test_layer_accuracy("GELU", pd, tinyinfer::Option(), x, ref_gelu, 8)
+           || test_layer_accuracy("GELU", pd_tanh, tinyinfer::Option(), SweepMat(100000, -1.f, 20.f, false), ref_gelu_tanh, 3)
+           || test_layer_accuracy("GELU", pd_tanh, tinyinfer::Option(), SweepMat(100000, -30.f, -1.f, false), ref_gelu_tanh, 256)
+           || test_layer_accuracy("GELU", pd_tanh, tinyinfer::Option(), x, ref_gelu_tanh, 3);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_gelu_0()
+           || test_gelu_1();
+}
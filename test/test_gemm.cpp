@@ -0,0 +1,84 @@
+#include "testutil.h"
+
+static int test_gemm(const tinyinfer::Mat& A, const tinyinfer::Mat& B, const tinyinfer::Mat& C, float alpha, float beta, int transA, int transB)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, alpha);
+    pd.set(1, beta);
+    pd.set(2, transA);
+    pd.set(3, transB);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    std::vector<tinyinfer::Mat> a(C.empty() ? 2 : 3);
+    a[0] = A;
+    a[1] = B;
+    if (!C.empty())
+        a[2] = C;
+
+    int ret = test_layer("Gemm", pd, weights, a, 1);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_gemm failed A=(%d %d %d) B=(%d %d %d) C.dims=%d alpha=%f beta=%f transA=%d transB=%d\n", A.w, A.h, A.c, B.w, B.h, B.c, C.dims, alpha, beta, transA, transB);
+    }
+
+    return ret;
+}
+
+// A(M x K) * B(K x N) with every transpose combination
+static int test_gemm(int M, int N, int K, float alpha)
+{
+    return 0
+           || test_gemm(RandomMat(K, M), RandomMat(N, K), tinyinfer::Mat(), alpha, 1.f, 0, 0)
+           || test_gemm(RandomMat(M, K), RandomMat(N, K), tinyinfer::Mat(), alpha, 1.f, 1, 0)
+           || test_gemm(RandomMat(K, M), RandomMat(K, N), tinyinfer::Mat(), alpha, 1.f, 0, 1)
+           || test_gemm(RandomMat(M, K), RandomMat(K, N), tinyinfer::Mat(), alpha, 1.f, 1, 1);
+}
+
+static int test_gemm_0()
+{
+    return 0
+           || test_gemm(1, 1, 1, 1.f)
+           || test_gemm(5, 7, 3, 1.f)
+           || test_gemm(8, 32, 16, 0.5f)
+           || test_gemm(13, 31, 29, 1.f)
+           || test_gemm(1, 100, 300, 1.f)
+           || test_gemm(64, 48, 257, 2.f)
+           || test_gemm(97, 129, 260, 1.f);
+}
+
+// every C broadcast
+static int test_gemm_1()
+{
+    const int M = 19;
+    const int N = 23;
+    const int K = 17;
+
+    return 0
+           || test_gemm(RandomMat(K, M), RandomMat(N, K), RandomMat(1), 1.f, 0.5f, 0, 0)
+           || test_gemm(RandomMat(K, M), RandomMat(N, K), RandomMat(N), 1.f, 1.f, 0, 0)
+           || test_gemm(RandomMat(K, M), RandomMat(K, N), RandomMat(N, 1), 0.5f, 2.f, 0, 1)
+           || test_gemm(RandomMat(M, K), RandomMat(N, K), RandomMat(1, M), 1.f, 1.f, 1, 0)
+           || test_gemm(RandomMat(K, M), RandomMat(N, K), RandomMat(N, M), 1.5f, -1.f, 0, 0);
+}
+
+// 1d operands and batched 3d operands
+static int test_gemm_2()
+{
+    return 0
+           || test_gemm(RandomMat(33), RandomMat(40, 33), tinyinfer::Mat(), 1.f, 1.f, 0, 0)
+           || test_gemm(RandomMat(27, 50), RandomMat(27), tinyinfer::Mat(), 1.f, 1.f, 0, 0)
+           || test_gemm(RandomMat(17, 9, 4), RandomMat(21, 17, 4), tinyinfer::Mat(), 1.f, 1.f, 0, 0)
+           || test_gemm(RandomMat(17, 9, 3), RandomMat(17, 21), RandomMat(21), 1.f, 1.f, 0, 1)
+           || test_gemm(RandomMat(9, 17), RandomMat(21, 17, 5), tinyinfer::Mat(), 1.f, 1.f, 1, 0);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_gemm_0()
+           || test_gemm_1()
+           || test_gemm_2();
+}
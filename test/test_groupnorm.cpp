@@ -0,0 +1,105 @@
+#include "testutil.h"
+
+static int test_groupnorm(const tinyinfer::Mat& a, int group, float eps, int affine, int num_threads = 0)
+{
+    const int channels = a.dims == 1 ? a.w : (a.dims == 2 ? a.h : a.c);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, group);
+    pd.set(1, channels);
+    pd.set(2, eps);
+    pd.set(3, affine);
+
+    std::vector<tinyinfer::Mat> weights(affine ? 2 : 0);
+    if (affine)
+    {
+        weights[0] = RandomMat(channels);
+        weights[1] = RandomMat(channels);
+    }
+
+    tinyinfer::Option opt;
+    if (num_threads > 0)
+        opt.num_threads = num_threads;
+
+    int ret = test_layer("GroupNorm", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_groupnorm failed a.dims=%d a=(%d %d %d %d) group=%d eps=%f affine=%d\n", a.dims, a.w, a.h, a.d, a.c, group, eps, affine);
+    }
+
+    return ret;
+}
+
+// a group per channel, a few groups and a single group over the whole blob
+static int test_groupnorm_0()
+{
+    for (int affine = 0; affine < 2; affine++)
+    {
+        int ret = 0
+                  || test_groupnorm(RandomMat(24), 4, 0.001f, affine)
+                  || test_groupnorm(RandomMat(19, 12), 3, 0.00001f, affine)
+                  || test_groupnorm(RandomMat(19, 12), 1, 0.00001f, affine)
+                  || test_groupnorm(RandomMat(5, 6, 12), 12, 0.001f, affine)
+                  || test_groupnorm(RandomMat(5, 6, 12), 4, 0.001f, affine)
+                  || test_groupnorm(RandomMat(5, 6, 12), 1, 0.001f, affine)
+                  || test_groupnorm(RandomMat(5, 6, 3, 8), 2, 0.00001f, affine);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// feature maps of style and diffusion models, 32 groups and one group over many channels
+// fewer groups than threads split the statistics per channel
+static int test_groupnorm_1()
+{
+    return 0
+           || test_groupnorm(RandomMat(32, 32, 64), 32, 0.00001f, 1)
+           || test_groupnorm(RandomMat(48, 40, 64), 1, 0.00001f, 1)
+           || test_groupnorm(RandomMat(47, 41, 96), 3, 0.00001f, 0)
+           || test_groupnorm(RandomMat(48, 40, 64), 1, 0.00001f, 1, 4)
+           || test_groupnorm(RandomMat(47, 41, 96), 3, 0.00001f, 0, 4)
+           || test_groupnorm(RandomMat(5, 6, 3, 8), 2, 0.001f, 1, 4);
+}
+
+// channels that do not split into the groups and a blob of other channels are rejected
+static int test_groupnorm_2()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, 5);
+    pd.set(1, 12);
+
+    tinyinfer::Layer* op = tinyinfer::create_layer(tinyinfer::layer_to_index("GroupNorm"));
+    const int ret_param = op->load_param(pd);
+    delete op;
+
+    tinyinfer::ParamDict pd2;
+    pd2.set(0, 2);
+    pd2.set(1, 8);
+    pd2.set(3, 0);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Mat b;
+    const int ret_forward = test_layer_forward(tinyinfer::layer_to_index("GroupNorm"), TINYINFER_ISA_NAIVE, pd2, weights, tinyinfer::Option(), RandomMat(5, 6, 7), b);
+
+    if (ret_param == 0 || ret_forward == 0)
+    {
+        fprintf(stderr, "test_groupnorm_2 failed ret_param=%d ret_forward=%d\n", ret_param, ret_forward);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_groupnorm_0()
+           || test_groupnorm_1()
+           || test_groupnorm_2();
+}
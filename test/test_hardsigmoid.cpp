@@ -0,0 +1,52 @@
+#include "testutil.h"
+
+static int test_hardsigmoid(const tinyinfer::Mat& a, float alpha, float beta)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, alpha);
+    pd.set(1, beta);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("HardSigmoid", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_hardsigmoid failed a.dims=%d a=(%d %d %d %d) alpha=%f beta=%f\n", a.dims, a.w, a.h, a.d, a.c, alpha, beta);
+    }
+
+    return ret;
+}
+
+static int test_hardsigmoid_0()
+{
+    return 0
+           || test_hardsigmoid(RandomMat(5, 6, 7, 24, -5.f, 5.f), 0.2f, 0.5f)
+           || test_hardsigmoid(RandomMat(7, 9, 12, -5.f, 5.f), 1.f / 6, 0.5f)
+           || test_hardsigmoid(RandomMat(3, 5, 13, -5.f, 5.f), 0.5f, 0.1f);
+}
+
+static int test_hardsigmoid_1()
+{
+    return 0
+           || test_hardsigmoid(RandomMat(15, 24, -5.f, 5.f), 0.2f, 0.5f)
+           || test_hardsigmoid(RandomMat(19, 12, -5.f, 5.f), 1.f / 6, 0.5f)
+           || test_hardsigmoid(RandomMat(17, 15, -5.f, 5.f), 0.5f, 0.1f);
+}
+
+static int test_hardsigmoid_2()
+{
+    return 0
+           || test_hardsigmoid(RandomMat(128, -5.f, 5.f), 0.2f, 0.5f)
+           || test_hardsigmoid(RandomMat(127, -5.f, 5.f), 1.f / 6, 0.5f)
+           || test_hardsigmoid(RandomMat(40000, -5.f, 5.f), 0.5f, 0.1f);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_hardsigmoid_0()
+           || test_hardsigmoid_1()
+           || test_hardsigmoid_2();
+}
@@ -0,0 +1,70 @@
+#include "testutil.h"
+
+static int test_innerproduct(const tinyinfer::Mat& a, int outch, int bias, int activation_type = 0)
+{
+    int num_input = a.w * a.h * a.c;
+    if (a.dims == 2)
+        num_input = a.w;
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, bias);
+    pd.set(2, outch * num_input);
+    pd.set(9, activation_type);
+
+    tinyinfer::Mat activation_params(2);
+    activation_params[0] = activation_type == 3 ? -0.5f : 0.1f;
+    activation_params[1] = 0.5f;
+    pd.set(10, activation_params);
+
+    std::vector<tinyinfer::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * num_input);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    int ret = test_layer("InnerProduct", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct failed a.dims=%d a=(%d %d %d) outch=%d bias=%d act=%d\n", a.dims, a.w, a.h, a.c, outch, bias, activation_type);
+    }
+
+    return ret;
+}
+
+// flattened input, a single output row
+static int test_innerproduct_0()
+{
+    return 0
+           || test_innerproduct(RandomMat(1, 3, 1), 1, 1)
+           || test_innerproduct(RandomMat(3, 2, 2), 2, 0)
+           || test_innerproduct(RandomMat(9, 3, 8), 7, 1)
+           || test_innerproduct(RandomMat(2, 2, 8), 8, 1, 1)
+           || test_innerproduct(RandomMat(4, 3, 15), 8, 1, 2)
+           || test_innerproduct(RandomMat(6, 2, 16), 16, 1, 3)
+           || test_innerproduct(RandomMat(6, 7, 31), 33, 1, 4)
+           || test_innerproduct(RandomMat(129), 17, 0)
+           || test_innerproduct(RandomMat(2048), 1000, 1)
+           || test_innerproduct(RandomMat(700), 67, 1, 1);
+}
+
+// row wise gemm, edge tiles in both directions and k longer than one block
+static int test_innerproduct_1()
+{
+    return 0
+           || test_innerproduct(RandomMat(1, 5), 1, 1)
+           || test_innerproduct(RandomMat(3, 7), 13, 0)
+           || test_innerproduct(RandomMat(16, 8), 32, 1, 1)
+           || test_innerproduct(RandomMat(33, 17), 31, 1, 2)
+           || test_innerproduct(RandomMat(64, 64), 64, 1)
+           || test_innerproduct(RandomMat(300, 53), 77, 1, 3)
+           || test_innerproduct(RandomMat(513, 70), 129, 0, 4);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_innerproduct_0()
+           || test_innerproduct_1();
+}
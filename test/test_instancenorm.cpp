@@ -0,0 +1,76 @@
+#include "testutil.h"
+
+static int test_instancenorm(const tinyinfer::Mat& a, float eps, int affine)
+{
+    const int channels = a.dims == 2 ? a.h : a.c;
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, channels);
+    pd.set(1, eps);
+    pd.set(2, affine);
+
+    std::vector<tinyinfer::Mat> weights(affine ? 2 : 0);
+    if (affine)
+    {
+        weights[0] = RandomMat(channels);
+        weights[1] = RandomMat(channels);
+    }
+
+    int ret = test_layer("InstanceNorm", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_instancenorm failed a.dims=%d a=(%d %d %d %d) eps=%f affine=%d\n", a.dims, a.w, a.h, a.d, a.c, eps, affine);
+    }
+
+    return ret;
+}
+
+static int test_instancenorm_0()
+{
+    for (int affine = 0; affine < 2; affine++)
+    {
+        int ret = 0
+                  || test_instancenorm(RandomMat(19, 12), 0.001f, affine)
+                  || test_instancenorm(RandomMat(3, 5, 13), 0.00001f, affine)
+                  || test_instancenorm(RandomMat(5, 6, 7), 0.001f, affine)
+                  || test_instancenorm(RandomMat(5, 6, 3, 7), 0.001f, affine)
+                  || test_instancenorm(RandomMat(64, 64, 3), 0.00001f, affine)
+                  || test_instancenorm(RandomMat(128, 96, 32), 0.00001f, affine);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// a dims 1 blob has no channels to normalize and other channel counts are rejected
+static int test_instancenorm_1()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, 7);
+    pd.set(2, 0);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Mat b;
+    const int ret_1d = test_layer_forward(tinyinfer::layer_to_index("InstanceNorm"), TINYINFER_ISA_NAIVE, pd, weights, tinyinfer::Option(), RandomMat(7), b);
+    const int ret_channels = test_layer_forward(tinyinfer::layer_to_index("InstanceNorm"), TINYINFER_ISA_NAIVE, pd, weights, tinyinfer::Option(), RandomMat(5, 6, 8), b);
+
+    if (ret_1d == 0 || ret_channels == 0)
+    {
+        fprintf(stderr, "test_instancenorm_1 failed ret_1d=%d ret_channels=%d\n", ret_1d, ret_channels);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_instancenorm_0()
+           || test_instancenorm_1();
+}
@@ -0,0 +1,166 @@
+#include "testutil.h"
+
+static int test_interp(const tinyinfer::Mat& a, int resize_type, float height_scale, float width_scale, int output_height, int output_width, int align_corner)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, resize_type);
+    pd.set(1, height_scale);
+    pd.set(2, width_scale);
+    pd.set(3, output_height);
+    pd.set(4, output_width);
+    pd.set(6, align_corner);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("Interp", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_interp failed a.dims=%d a=(%d %d %d) resize_type=%d scale=%f %f output=%d %d align_corner=%d\n", a.dims, a.w, a.h, a.c, resize_type, height_scale, width_scale, output_height, output_width, align_corner);
+    }
+
+    return ret;
+}
+
+static int test_interp_dynamic(const tinyinfer::Mat& a, const tinyinfer::Mat& reference, int resize_type)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, resize_type);
+    pd.set(5, 1);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    std::vector<tinyinfer::Mat> ab(2);
+    ab[0] = a;
+    ab[1] = reference;
+
+    int ret = test_layer("Interp", pd, weights, ab, 1);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_interp_dynamic failed a=(%d %d %d) reference=(%d %d) resize_type=%d\n", a.w, a.h, a.c, reference.w, reference.h, resize_type);
+    }
+
+    return ret;
+}
+
+static tinyinfer::Mat forward_naive(const tinyinfer::Mat& a, int resize_type, int output_height, int output_width, int align_corner)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, resize_type);
+    pd.set(3, output_height);
+    pd.set(4, output_width);
+    pd.set(6, align_corner);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+    opt.num_threads = 1;
+
+    tinyinfer::Mat b;
+    test_layer_forward(tinyinfer::layer_to_index("Interp"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b);
+    return b;
+}
+
+// the naive layer itself on small maps with known results
+static int test_interp_reference()
+{
+    tinyinfer::Mat a(2, 2, 1);
+    a[0] = 1.f;
+    a[1] = 2.f;
+    a[2] = 3.f;
+    a[3] = 4.f;
+
+    // nearest 2x repeats every pixel into a 2x2 block
+    tinyinfer::Mat b = forward_naive(a, 1, 4, 4, 0);
+    tinyinfer::Mat expect(4, 4, 1);
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 4; x++)
+        {
+            expect.row(y)[x] = a.row(y / 2)[x / 2];
+        }
+    }
+    if (CompareMat(b, expect) != 0)
+    {
+        fprintf(stderr, "test_interp_reference nearest mismatch\n");
+        return -1;
+    }
+
+    // bilinear with aligned corners keeps the corners and puts the mean in the middle
+    b = forward_naive(a, 2, 3, 3, 1);
+    const float expect_bilinear[9] = {1.f, 1.5f, 2.f, 2.f, 2.5f, 3.f, 3.f, 3.5f, 4.f};
+    for (int i = 0; i < 9; i++)
+    {
+        if (b.dims != 3 || b.w != 3 || b.h != 3 || fabsf(b[i] - expect_bilinear[i]) > 1e-6f)
+        {
+            fprintf(stderr, "test_interp_reference bilinear mismatch\n");
+            return -1;
+        }
+    }
+
+    // bicubic keeps the samples at aligned corners and puts the mean of a ramp between them, away from the clamped border
+    tinyinfer::Mat ramp(8, 1, 1);
+    for (int x = 0; x < 8; x++)
+        ramp[x] = (float)x;
+
+    b = forward_naive(ramp, 3, 1, 15, 1);
+    for (int dx = 2; dx < 12; dx++)
+    {
+        if (fabsf(b[dx] - dx * 0.5f) > 1e-5f)
+        {
+            fprintf(stderr, "test_interp_reference bicubic mismatch at %d\n", dx);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// every mode upsampling and downsampling, by scale and by size, with and without aligned corners
+static int test_interp_0()
+{
+    for (int resize_type = 1; resize_type <= 3; resize_type++)
+    {
+        for (int align_corner = 0; align_corner < 2; align_corner++)
+        {
+            int ret = 0
+                      || test_interp(RandomMat(15, 13, 5), resize_type, 2.f, 2.f, 0, 0, align_corner)
+                      || test_interp(RandomMat(15, 13, 5), resize_type, 4.f, 3.f, 0, 0, align_corner)
+                      || test_interp(RandomMat(15, 13, 5), resize_type, 3.f, 4.f, 0, 0, align_corner)
+                      || test_interp(RandomMat(15, 13, 5), resize_type, 0.5f, 0.5f, 0, 0, align_corner)
+                      || test_interp(RandomMat(15, 13, 5), resize_type, 1.f, 1.f, 23, 17, align_corner)
+                      || test_interp(RandomMat(15, 13, 5), resize_type, 1.f, 1.f, 7, 9, align_corner)
+                      || test_interp(RandomMat(15, 13, 5), resize_type, 1.f, 1.f, 1, 1, align_corner)
+                      || test_interp(RandomMat(1, 1, 3), resize_type, 1.f, 1.f, 5, 6, align_corner)
+                      || test_interp(RandomMat(64, 48, 3), resize_type, 2.f, 2.f, 0, 0, align_corner)
+                      || test_interp(RandomMat(33, 31, 2), resize_type, 1.f, 1.f, 120, 100, align_corner);
+
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+// 1d blobs become maps, rows of 2d blobs are resized on their own, and the size taken from a second blob
+static int test_interp_1()
+{
+    return 0
+           || test_interp(RandomMat(7), 1, 3.f, 2.f, 0, 0, 0)
+           || test_interp(RandomMat(11, 5), 1, 1.f, 3.f, 0, 0, 0)
+           || test_interp(RandomMat(11, 5), 2, 1.f, 1.f, 1, 20, 0)
+           || test_interp(RandomMat(11, 5), 3, 1.f, 1.f, 1, 20, 1)
+           || test_interp_dynamic(RandomMat(15, 13, 5), RandomMat(30, 26, 1), 1)
+           || test_interp_dynamic(RandomMat(15, 13, 5), RandomMat(29, 20, 2), 2)
+           || test_interp_dynamic(RandomMat(15, 13, 5), RandomMat(8, 8), 3);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_interp_reference()
+           || test_interp_0()
+           || test_interp_1();
+}
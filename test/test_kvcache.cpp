@@ -0,0 +1,210 @@
+#include "kvcache.h"
+#include "testutil.h"
+#include <string.h>
+
+// rows [y, y + n) of every channel
+static tinyinfer::Mat slice_rows(const tinyinfer::Mat& m, int y, int n)
+{
+    tinyinfer::Mat s = m.dims == 3 ? tinyinfer::Mat(m.w, n, m.c) : tinyinfer::Mat(m.w, n);
+    for (int q = 0; q < m.c; q++)
+    {
+        memcpy(s.channel(q), (const float*)m.channel(q) + (size_t)y * m.w, (size_t)n * m.w * sizeof(float));
+    }
+
+    return s;
+}
+
+// appended rows land behind the stored ones across growth, clear keeps the storage
+static int test_kvcache_append()
+{
+    tinyinfer::KVCache cache;
+    cache.set_chunk_size(4);
+
+    tinyinfer::Mat k = RandomMat(6, 11, 2);
+    tinyinfer::Mat v = RandomMat(5, 11, 2);
+
+    const int steps[] = {3, 1, 1, 4, 2};
+    int y = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        if (cache.append(1, slice_rows(k, y, steps[i]), slice_rows(v, y, steps[i])) != 0)
+        {
+            fprintf(stderr, "test_kvcache_append append failed at %d\n", y);
+            return -1;
+        }
+        y += steps[i];
+    }
+
+    const tinyinfer::Mat& ck = cache.keys(1);
+    const tinyinfer::Mat& cv = cache.values(1);
+    if (cache.length(1) != 11 || cache.length(0) != 0 || ck.h != 12 || cv.h != 12 || ck.c != 2 || cv.w != 5)
+    {
+        fprintf(stderr, "test_kvcache_append shape mismatch length=%d capacity=%d\n", cache.length(1), ck.h);
+        return -1;
+    }
+
+    if (CompareMat(slice_rows(ck, 0, 11), k, 0.f) != 0 || CompareMat(slice_rows(cv, 0, 11), v, 0.f) != 0)
+    {
+        fprintf(stderr, "test_kvcache_append value mismatch\n");
+        return -1;
+    }
+
+    // other heads or head sizes do not continue the sequence
+    if (cache.append(1, RandomMat(6, 1, 3), RandomMat(5, 1, 3)) == 0 || cache.append(1, RandomMat(6, 1, 2), RandomMat(4, 1, 2)) == 0 || cache.length(1) != 11)
+    {
+        fprintf(stderr, "test_kvcache_append accepted a mismatched shape\n");
+        return -1;
+    }
+
+    const void* storage = ck.data;
+    cache.clear();
+    if (cache.length(1) != 0 || cache.append(1, slice_rows(k, 0, 2), slice_rows(v, 0, 2)) != 0 || cache.keys(1).data != storage)
+    {
+        fprintf(stderr, "test_kvcache_append clear did not keep the storage\n");
+        return -1;
+    }
+
+    // a cleared slot takes a new shape
+    cache.clear();
+    if (cache.append(1, RandomMat(8, 3), RandomMat(8, 3)) != 0 || cache.keys(1).dims != 2 || cache.length(1) != 3)
+    {
+        fprintf(stderr, "test_kvcache_append cleared slot kept the old shape\n");
+        return -1;
+    }
+
+    cache.release();
+    if (cache.length(1) != 0 || !cache.keys(1).empty())
+    {
+        fprintf(stderr, "test_kvcache_append release kept the storage\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+// the sequence fed through a cached causal layer a few tokens at a time against one forward over all of it
+static int test_kvcache_layer(int isa, const tinyinfer::Mat& q, const tinyinfer::Mat& k, const tinyinfer::Mat& v, int num_heads, int prefill)
+{
+    const int typeindex = tinyinfer::layer_to_index("MultiHeadAttention");
+    const int seq = q.h;
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, num_heads);
+    pd.set(2, 1);
+
+    std::vector<tinyinfer::Mat> weights(0);
+    std::vector<tinyinfer::Mat> a(3);
+    a[0] = q;
+    a[1] = k;
+    a[2] = v;
+    std::vector<tinyinfer::Mat> expect(1);
+    if (test_layer_forward(typeindex, TINYINFER_ISA_NAIVE, pd, weights, a, expect) != 0)
+        return -1;
+
+    pd.set(3, 1);
+
+    tinyinfer::Layer* op = tinyinfer::create_layer_isa(typeindex, isa);
+    tinyinfer::KVCache cache;
+    cache.set_chunk_size(8);
+
+    tinyinfer::Option opt;
+    opt.num_threads = 1;
+    opt.kv_cache = &cache;
+
+    int ret = op->load_param(pd);
+    if (ret == 0)
+        ret = op->create_pipeline(opt);
+
+    for (int y = 0; ret == 0 && y < seq;)
+    {
+        const int n = y == 0 ? prefill : 1;
+
+        std::vector<tinyinfer::Mat> step(3);
+        step[0] = slice_rows(q, y, n);
+        step[1] = slice_rows(k, y, n);
+        step[2] = slice_rows(v, y, n);
+        std::vector<tinyinfer::Mat> out(1);
+        ret = op->forward(step, out, opt);
+
+        if (ret == 0 && (cache.length() != y + n || CompareMat(out[0], slice_rows(expect[0], y, n), 0.001f) != 0))
+        {
+            fprintf(stderr, "test_kvcache_layer failed isa=%d at %d length=%d\n", isa, y, cache.length());
+            ret = -1;
+        }
+
+        y += n;
+    }
+
+    op->destroy_pipeline(opt);
+    delete op;
+
+    if (ret != 0)
+        fprintf(stderr, "test_kvcache_layer failed isa=%d q=(%d %d %d) num_heads=%d prefill=%d\n", isa, q.w, q.h, q.c, num_heads, prefill);
+
+    return ret;
+}
+
+static int test_kvcache_layer(const tinyinfer::Mat& q, const tinyinfer::Mat& k, const tinyinfer::Mat& v, int num_heads, int prefill)
+{
+    for (int isa = TINYINFER_ISA_NAIVE; isa <= tinyinfer::cpu_isa_level(); isa++)
+    {
+        if (test_kvcache_layer(isa, q, k, v, num_heads, prefill) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int test_kvcache_0()
+{
+    return 0
+           || test_kvcache_layer(RandomMat(16, 20, 2), RandomMat(16, 20, 2), RandomMat(16, 20, 2), 1, 1)
+           || test_kvcache_layer(RandomMat(32, 70, 4), RandomMat(32, 70, 2), RandomMat(24, 70, 2), 1, 37)
+           || test_kvcache_layer(RandomMat(64 * 4, 40), RandomMat(64 * 2, 40), RandomMat(64 * 2, 40), 4, 9);
+}
+
+// a mask that does not cover the cached positions is rejected before the cache grows
+static int test_kvcache_1()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(3, 1);
+
+    tinyinfer::Layer* op = tinyinfer::create_layer(tinyinfer::layer_to_index("MultiHeadAttention"));
+    op->load_param(pd);
+
+    tinyinfer::KVCache cache;
+    tinyinfer::Option opt;
+    opt.num_threads = 1;
+    opt.kv_cache = &cache;
+
+    std::vector<tinyinfer::Mat> a(4);
+    a[0] = RandomMat(8, 1, 1);
+    a[1] = RandomMat(8, 1, 1);
+    a[2] = RandomMat(8, 1, 1);
+    a[3] = RandomMat(1, 1);
+    std::vector<tinyinfer::Mat> b(1);
+
+    int ret = op->forward(a, b, opt);
+    const int ret_bad = op->forward(a, b, opt);
+    const int length = cache.length();
+
+    delete op;
+
+    if (ret != 0 || ret_bad == 0 || length != 1)
+    {
+        fprintf(stderr, "test_kvcache_1 failed ret=%d ret_bad=%d length=%d\n", ret, ret_bad, length);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_kvcache_append()
+           || test_kvcache_0()
+           || test_kvcache_1();
+}
@@ -0,0 +1,146 @@
+#include "testutil.h"
+
+static int test_layernorm(const tinyinfer::Mat& a, int affine_size, float eps, int affine)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, affine_size);
+    pd.set(1, eps);
+    pd.set(2, affine);
+
+    std::vector<tinyinfer::Mat> weights(affine ? 2 : 0);
+    if (affine)
+    {
+        weights[0] = RandomMat(affine_size);
+        weights[1] = RandomMat(affine_size);
+    }
+
+    int ret = test_layer("LayerNorm", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_layernorm failed a.dims=%d a=(%d %d %d %d) affine_size=%d eps=%f affine=%d\n", a.dims, a.w, a.h, a.d, a.c, affine_size, eps, affine);
+    }
+
+    return ret;
+}
+
+// rows along w, short rows below a vector and transformer widths
+static int test_layernorm_0()
+{
+    return 0
+           || test_layernorm(RandomMat(3), 3, 0.001f, 1)
+           || test_layernorm(RandomMat(127), 127, 0.00001f, 1)
+           || test_layernorm(RandomMat(768), 768, 0.00001f, 0)
+           || test_layernorm(RandomMat(33, 9), 33, 0.001f, 1)
+           || test_layernorm(RandomMat(768, 17), 768, 0.00001f, 1)
+           || test_layernorm(RandomMat(64, 130), 0, 0.00001f, 0)
+           || test_layernorm(RandomMat(5, 6, 7), 5, 0.001f, 1)
+           || test_layernorm(RandomMat(5, 6, 3, 7), 5, 0.001f, 0);
+}
+
+// planes and whole channels
+static int test_layernorm_1()
+{
+    return 0
+           || test_layernorm(RandomMat(19, 12), 19 * 12, 0.001f, 1)
+           || test_layernorm(RandomMat(13, 11, 7), 13 * 11, 0.00001f, 1)
+           || test_layernorm(RandomMat(64, 64, 3), 64 * 64, 0.00001f, 0)
+           || test_layernorm(RandomMat(5, 6, 3, 7), 5 * 6, 0.001f, 1)
+           || test_layernorm(RandomMat(5, 6, 3, 7), 5 * 6 * 3, 0.001f, 1)
+           || test_layernorm(RandomMat(40000), 40000, 0.00001f, 1);
+}
+
+// a large offset over a small spread, the single pass statistics of the isa variants against double precision
+// a sum of squares would cancel to nothing here, the float mean itself is still up to a hundredth of the spread off
+static int test_layernorm_2()
+{
+    const int w = 4099;
+    const int h = 5;
+
+    tinyinfer::Mat a = RandomMat(w, h);
+    for (int i = 0; i < w * h; i++)
+        a[i] = 1000.f + a[i] * 0.01f;
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, w);
+    pd.set(1, 0.f);
+    pd.set(2, 0);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    for (int isa = TINYINFER_ISA_SSE2; isa <= tinyinfer::cpu_isa_level(); isa++)
+    {
+        tinyinfer::Mat b;
+        if (test_layer_forward(tinyinfer::layer_to_index("LayerNorm"), isa, pd, weights, tinyinfer::Option(), a, b) != 0)
+        {
+            fprintf(stderr, "test_layernorm_2 isa %d forward failed\n", isa);
+            return -1;
+        }
+
+        for (int y = 0; y < h; y++)
+        {
+            const float* ptr = a.row(y);
+
+            double mean = 0.0;
+            for (int x = 0; x < w; x++)
+                mean += ptr[x];
+            mean /= w;
+
+            double var = 0.0;
+            for (int x = 0; x < w; x++)
+                var += (ptr[x] - mean) * (ptr[x] - mean);
+            var /= w;
+
+            for (int x = 0; x < w; x++)
+            {
+                const double expect = (ptr[x] - mean) / sqrt(var);
+                if (fabs(b.row(y)[x] - expect) > 0.02)
+                {
+                    fprintf(stderr, "test_layernorm_2 isa %d at (%d %d) expect %f but got %f\n", isa, x, y, expect, b.row(y)[x]);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+// affine without its size and a size that is not the trailing axes of a channel are rejected
+static int test_layernorm_3()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, 0);
+    pd.set(2, 1);
+
+    tinyinfer::Layer* op = tinyinfer::create_layer(tinyinfer::layer_to_index("LayerNorm"));
+    const int ret_param = op->load_param(pd);
+    delete op;
+
+    tinyinfer::ParamDict pd2;
+    pd2.set(0, 6);
+    pd2.set(2, 0);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Mat b;
+    const int ret_forward = test_layer_forward(tinyinfer::layer_to_index("LayerNorm"), TINYINFER_ISA_NAIVE, pd2, weights, tinyinfer::Option(), RandomMat(5, 6, 7), b);
+
+    if (ret_param == 0 || ret_forward == 0)
+    {
+        fprintf(stderr, "test_layernorm_3 failed ret_param=%d ret_forward=%d\n", ret_param, ret_forward);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_layernorm_0()
+           || test_layernorm_1()
+           || test_layernorm_2()
+           || test_layernorm_3();
+}
@@ -0,0 +1,86 @@
+#include "mat.h"
+#include "modelbin.h"
+#include <math.h>
+#include <stdio.h>
+
+static int test_float16_roundtrip()
+{
+    // values exactly representable in float16
+    const float values[] = {0.f, -0.f, 1.f, -2.5f, 0.099975586f, 65504.f, 6.1035156e-05f, 5.9604645e-08f, -3.0517578e-05f};
+    for (int i = 0; i < (int)(sizeof(values) / sizeof(float)); i++)
+    {
+        float v = tinyinfer::float16_to_float32(tinyinfer::float32_to_float16(values[i]));
+        if (v != values[i])
+        {
+            fprintf(stderr, "test_float16_roundtrip failed %g -> %g\n", values[i], v);
+            return -1;
+        }
+    }
+
+    // ties round to even, overflow saturates to infinity
+    if (tinyinfer::float32_to_float16(1.f + 1.f / 2048) != 0x3c00
+            || tinyinfer::float32_to_float16(1.f + 3.f / 2048) != 0x3c02
+            || tinyinfer::float32_to_float16(65520.f) != 0x7c00
+            || !isnan(tinyinfer::float16_to_float32(tinyinfer::float32_to_float16(NAN))))
+    {
+        fprintf(stderr, "test_float16_roundtrip rounding failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_modelbin_stdio()
+{
+    FILE* fp = tmpfile();
+    if (!fp)
+        return 0;
+
+    // [fp16 tag] 3 halfs + padding, [fp32 tag] 2 floats, 2 untagged floats
+    unsigned int tag16 = TINYINFER_WEIGHT_TAG_FLOAT16;
+    unsigned short halfs[4] = {tinyinfer::float32_to_float16(1.f), tinyinfer::float32_to_float16(-0.5f), tinyinfer::float32_to_float16(3.f), 0};
+    unsigned int tag32 = TINYINFER_WEIGHT_TAG_FLOAT32;
+    float floats[4] = {4.f, 5.f, 6.f, 7.f};
+
+    fwrite(&tag16, sizeof(tag16), 1, fp);
+    fwrite(halfs, sizeof(unsigned short), 4, fp);
+    fwrite(&tag16, sizeof(tag16), 1, fp);
+    fwrite(halfs, sizeof(unsigned short), 4, fp);
+    fwrite(&tag32, sizeof(tag32), 1, fp);
+    fwrite(floats, sizeof(float), 2, fp);
+    fwrite(floats + 2, sizeof(float), 2, fp);
+    rewind(fp);
+
+    tinyinfer::ModelBinFromStdio mb(fp);
+
+    tinyinfer::Mat a = mb.load(3, 0);
+    tinyinfer::Mat b = mb.load(3, 0);
+    tinyinfer::Mat c = mb.load(2, 0);
+    tinyinfer::Mat d = mb.load(2, 1);
+    // weights always come back as float32, there is no undecoded float16 type
+    tinyinfer::Mat e = mb.load(1, 2);
+    fclose(fp);
+
+    if (a.empty() || b.empty() || c.empty() || d.empty() || !e.empty())
+    {
+        fprintf(stderr, "test_modelbin_stdio load failed\n");
+        return -1;
+    }
+
+    if (a.elemsize != 4 || a[0] != 1.f || a[1] != -0.5f || a[2] != 3.f
+            || b.elemsize != 4 || b[0] != 1.f || b[2] != 3.f
+            || c.elemsize != 4 || c[0] != 4.f || c[1] != 5.f
+            || d[0] != 6.f || d[1] != 7.f)
+    {
+        fprintf(stderr, "test_modelbin_stdio value mismatch\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    return 0 || test_float16_roundtrip()
+             || test_modelbin_stdio();
+}
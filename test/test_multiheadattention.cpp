@@ -0,0 +1,256 @@
+#include "testutil.h"
+#include <math.h>
+
+// mask_type 0=none 1=q_len x kv_len 2=one row for every query 3=one q_len x kv_len per head
+static tinyinfer::Mat make_mask(int q_len, int kv_len, int heads, int mask_type)
+{
+    if (mask_type == 1)
+        return RandomMat(kv_len, q_len, -2.f, 2.f);
+    if (mask_type == 2)
+    {
+        // a padding mask, the last keys are hidden
+        tinyinfer::Mat m(kv_len, 1);
+        for (int j = 0; j < kv_len; j++)
+            m[j] = j < kv_len * 3 / 4 ? 0.f : -INFINITY;
+        return m;
+    }
+    return RandomMat(kv_len, q_len, heads, -2.f, 2.f);
+}
+
+static int test_multiheadattention(const std::vector<tinyinfer::Mat>& a, int num_heads, float scale, int causal, int num_threads = 0)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, num_heads);
+    pd.set(1, scale);
+    pd.set(2, causal);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+    if (num_threads > 0)
+        opt.num_threads = num_threads;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, opt, a, 1);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention failed q=(%d %d %d) k=(%d %d %d) v=(%d %d %d) mask=%d num_heads=%d scale=%f causal=%d\n", a[0].w, a[0].h, a[0].c, a[1].w, a[1].h, a[1].c, a[2].w, a[2].h, a[2].c, a.size() > 3 ? a[3].dims : 0, num_heads, scale, causal);
+    }
+
+    return ret;
+}
+
+// one head per channel
+static int test_multiheadattention_3d(int q_len, int kv_len, int head_dim, int v_head_dim, int heads, int kv_heads, int mask_type, int causal, int num_threads = 0)
+{
+    std::vector<tinyinfer::Mat> a(mask_type ? 4 : 3);
+    a[0] = RandomMat(head_dim, q_len, heads);
+    a[1] = RandomMat(head_dim, kv_len, kv_heads);
+    a[2] = RandomMat(v_head_dim, kv_len, kv_heads);
+    if (mask_type)
+        a[3] = make_mask(q_len, kv_len, heads, mask_type);
+
+    return test_multiheadattention(a, 1, 0.f, causal, num_threads);
+}
+
+// heads side by side along w
+static int test_multiheadattention_2d(int q_len, int kv_len, int head_dim, int v_head_dim, int heads, int kv_heads, int mask_type, int causal, int num_threads = 0)
+{
+    std::vector<tinyinfer::Mat> a(mask_type ? 4 : 3);
+    a[0] = RandomMat(head_dim * heads, q_len);
+    a[1] = RandomMat(head_dim * kv_heads, kv_len);
+    a[2] = RandomMat(v_head_dim * kv_heads, kv_len);
+    if (mask_type)
+        a[3] = make_mask(q_len, kv_len, heads, mask_type);
+
+    return test_multiheadattention(a, heads, 1.f / head_dim, causal, num_threads);
+}
+
+static int test_multiheadattention_0()
+{
+    return 0
+           || test_multiheadattention_3d(1, 1, 8, 8, 1, 1, 0, 0)
+           || test_multiheadattention_3d(7, 13, 16, 16, 3, 3, 0, 0)
+           || test_multiheadattention_3d(64, 64, 64, 64, 4, 4, 0, 0)
+           || test_multiheadattention_3d(77, 150, 40, 24, 2, 2, 0, 0)
+           || test_multiheadattention_3d(33, 129, 13, 17, 2, 1, 0, 0)
+           || test_multiheadattention_3d(1, 300, 64, 64, 8, 2, 0, 0)
+           || test_multiheadattention_3d(100, 100, 32, 32, 2, 2, 1, 0)
+           || test_multiheadattention_3d(40, 90, 16, 16, 3, 3, 2, 0)
+           || test_multiheadattention_3d(40, 90, 16, 16, 3, 3, 3, 0)
+           || test_multiheadattention_3d(97, 97, 32, 32, 2, 2, 0, 1)
+           || test_multiheadattention_3d(5, 133, 32, 32, 2, 2, 1, 1)
+           // more queries than keys leaves the first rows without a visible key
+           || test_multiheadattention_3d(40, 30, 8, 8, 1, 1, 0, 1);
+}
+
+static int test_multiheadattention_1()
+{
+    return 0
+           || test_multiheadattention_2d(1, 1, 8, 8, 2, 2, 0, 0)
+           || test_multiheadattention_2d(50, 50, 64, 64, 12, 12, 0, 0)
+           || test_multiheadattention_2d(31, 70, 20, 12, 4, 2, 1, 0)
+           || test_multiheadattention_2d(64, 64, 32, 32, 4, 4, 3, 1)
+           || test_multiheadattention_2d(1, 257, 64, 64, 8, 1, 2, 1);
+}
+
+// more tasks than threads and a single head spread over threads by query tiles
+static int test_multiheadattention_2()
+{
+    return 0
+           || test_multiheadattention_3d(200, 200, 32, 32, 3, 3, 0, 1, 4)
+           || test_multiheadattention_3d(150, 65, 16, 16, 1, 1, 1, 0, 4)
+           || test_multiheadattention_2d(70, 70, 16, 16, 6, 3, 3, 0, 4);
+}
+
+// the naive layer against the attention matrix written out in double
+static int test_multiheadattention_reference()
+{
+    const int q_len = 9;
+    const int kv_len = 21;
+    const int head_dim = 6;
+    const int heads = 2;
+
+    std::vector<tinyinfer::Mat> a(4);
+    a[0] = RandomMat(head_dim, q_len, heads);
+    a[1] = RandomMat(head_dim, kv_len, heads);
+    a[2] = RandomMat(head_dim, kv_len, heads);
+    a[3] = RandomMat(kv_len, q_len);
+
+    tinyinfer::ParamDict pd;
+    pd.set(1, 0.5f);
+    pd.set(2, 1);
+
+    std::vector<tinyinfer::Mat> weights(0);
+    std::vector<tinyinfer::Mat> b(1);
+    if (test_layer_forward(tinyinfer::layer_to_index("MultiHeadAttention"), TINYINFER_ISA_NAIVE, pd, weights, a, b) != 0)
+        return -1;
+
+    for (int h = 0; h < heads; h++)
+    {
+        const tinyinfer::Mat q = a[0].channel(h);
+        const tinyinfer::Mat k = a[1].channel(h);
+        const tinyinfer::Mat v = a[2].channel(h);
+        const tinyinfer::Mat out = b[0].channel(h);
+
+        for (int i = 0; i < q_len; i++)
+        {
+            const int end = kv_len - q_len + i + 1;
+
+            double s[kv_len];
+            double max = -1e30;
+            for (int j = 0; j < end; j++)
+            {
+                double sum = 0.0;
+                for (int d = 0; d < head_dim; d++)
+                    sum += (double)q[i * head_dim + d] * k[j * head_dim + d];
+                s[j] = sum * 0.5 + a[3][i * kv_len + j];
+                max = s[j] > max ? s[j] : max;
+            }
+
+            double total = 0.0;
+            for (int j = 0; j < end; j++)
+            {
+                s[j] = exp(s[j] - max);
+                total += s[j];
+            }
+
+            for (int d = 0; d < head_dim; d++)
+            {
+                double expect = 0.0;
+                for (int j = 0; j < end; j++)
+                    expect += s[j] / total * v[j * head_dim + d];
+
+                if (fabs(out[i * head_dim + d] - expect) > 1e-5)
+                {
+                    fprintf(stderr, "test_multiheadattention_reference failed at (%d %d %d) got %f expect %f\n", d, i, h, out[i * head_dim + d], expect);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+// mismatched shapes and params are rejected
+static int test_multiheadattention_3()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, 3);
+
+    const int typeindex = tinyinfer::layer_to_index("MultiHeadAttention");
+    std::vector<tinyinfer::Mat> weights(0);
+
+    std::vector<std::vector<tinyinfer::Mat> > bad;
+    {
+        // head_dim of q and k differ
+        std::vector<tinyinfer::Mat> a(3);
+        a[0] = RandomMat(8, 4, 2);
+        a[1] = RandomMat(6, 5, 2);
+        a[2] = RandomMat(8, 5, 2);
+        bad.push_back(a);
+    }
+    {
+        // 3 heads do not share 2 key heads
+        std::vector<tinyinfer::Mat> a(3);
+        a[0] = RandomMat(8, 4, 3);
+        a[1] = RandomMat(8, 5, 2);
+        a[2] = RandomMat(8, 5, 2);
+        bad.push_back(a);
+    }
+    {
+        // 16 wide rows do not split into 3 heads
+        std::vector<tinyinfer::Mat> a(3);
+        a[0] = RandomMat(16, 4);
+        a[1] = RandomMat(16, 5);
+        a[2] = RandomMat(16, 5);
+        bad.push_back(a);
+    }
+    {
+        // the mask is not kv_len wide
+        std::vector<tinyinfer::Mat> a(4);
+        a[0] = RandomMat(8, 4, 2);
+        a[1] = RandomMat(8, 5, 2);
+        a[2] = RandomMat(8, 5, 2);
+        a[3] = RandomMat(4, 5);
+        bad.push_back(a);
+    }
+
+    for (size_t i = 0; i < bad.size(); i++)
+    {
+        for (int isa = TINYINFER_ISA_NAIVE; isa <= tinyinfer::cpu_isa_level(); isa++)
+        {
+            std::vector<tinyinfer::Mat> b(1);
+            if (test_layer_forward(typeindex, isa, pd, weights, bad[i], b) == 0)
+            {
+                fprintf(stderr, "test_multiheadattention_3 accepted case %d isa %d\n", (int)i, isa);
+                return -1;
+            }
+        }
+    }
+
+    tinyinfer::ParamDict pd0;
+    pd0.set(0, 0);
+    tinyinfer::Layer* op = tinyinfer::create_layer(typeindex);
+    const int ret = op->load_param(pd0);
+    delete op;
+    if (ret == 0)
+    {
+        fprintf(stderr, "test_multiheadattention_3 accepted num_heads=0\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_multiheadattention_0()
+           || test_multiheadattention_1()
+           || test_multiheadattention_2()
+           || test_multiheadattention_reference()
+           || test_multiheadattention_3();
+}
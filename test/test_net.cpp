@@ -0,0 +1,511 @@
+#include "net.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static FILE* make_file(const char* text)
+{
+    FILE* fp = tmpfile();
+    if (!fp)
+        return 0;
+
+    fwrite(text, 1, strlen(text), fp);
+    rewind(fp);
+    return fp;
+}
+
+static int load_net(tinyinfer::Net& net, const char* paramstr, const float* weights, int weight_count)
+{
+    FILE* pp = make_file(paramstr);
+    FILE* bp = tmpfile();
+    if (!pp || !bp)
+        return -1;
+
+    fwrite(weights, sizeof(float), weight_count, bp);
+    rewind(bp);
+
+    int ret = net.load_param(pp);
+    if (ret == 0)
+        ret = net.load_model(bp);
+
+    fclose(pp);
+    fclose(bp);
+    return ret;
+}
+
+static int test_net_extract()
+{
+    const char* paramstr = "202303\n"
+                           "4 5\n"
+                           "Input            data 0 1 data 0=4\n"
+                           "MemoryData       weight 0 1 weight 0=3 1=2\n"
+                           "Split            splitncnn_0 1 2 weight weight_splitncnn_0 weight_splitncnn_1\n"
+                           "Split            splitncnn_1 1 1 data data_splitncnn_0\n";
+    const float weights[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+
+    tinyinfer::Net net;
+    if (load_net(net, paramstr, weights, 6) != 0)
+    {
+        fprintf(stderr, "test_net_extract load failed\n");
+        return -1;
+    }
+
+    if (net.layers().size() != 4 || net.blobs().size() != 5 || net.input_indexes().size() != 1 || net.output_indexes().size() != 3)
+    {
+        fprintf(stderr, "test_net_extract graph mismatch\n");
+        return -1;
+    }
+
+    tinyinfer::Extractor ex = net.create_extractor();
+
+    // the weight branch does not need the input
+    tinyinfer::Mat w1;
+    if (ex.extract("weight_splitncnn_1", w1) != 0 || w1.dims != 2 || w1.w != 3 || w1.h != 2)
+    {
+        fprintf(stderr, "test_net_extract weight shape mismatch\n");
+        return -1;
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (((const float*)w1.data)[i] != weights[i])
+        {
+            fprintf(stderr, "test_net_extract weight value mismatch\n");
+            return -1;
+        }
+    }
+
+    // the input branch fails until the input is set
+    tinyinfer::Mat out;
+    if (ex.extract("data_splitncnn_0", out) == 0)
+    {
+        fprintf(stderr, "test_net_extract extracted without input\n");
+        return -1;
+    }
+
+    tinyinfer::Mat in(4);
+    for (int i = 0; i < 4; i++)
+        ((float*)in.data)[i] = (float)i;
+
+    ex.input("data", in);
+    if (ex.extract("data_splitncnn_0", out) != 0 || out.data != in.data)
+    {
+        fprintf(stderr, "test_net_extract input passthrough failed\n");
+        return -1;
+    }
+
+    // a fresh extractor starts with no blob computed
+    tinyinfer::Extractor ex2 = net.create_extractor();
+    if (ex2.extract("data", out) == 0)
+    {
+        fprintf(stderr, "test_net_extract extractor state leaked\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_net_lazy(bool lightmode)
+{
+    // two heads, one needs data and one needs data2
+    const char* paramstr = "202303\n"
+                           "5 6\n"
+                           "Input            data 0 1 data 0=4\n"
+                           "Input            data2 0 1 data2 0=4\n"
+                           "MemoryData       weight 0 1 weight 0=2\n"
+                           "Split            splitncnn_0 1 2 weight weight_splitncnn_0 weight_splitncnn_1\n"
+                           "Split            splitncnn_1 1 1 data data_splitncnn_0\n";
+    const float weights[2] = {1.f, 2.f};
+
+    tinyinfer::Net net;
+    if (load_net(net, paramstr, weights, 2) != 0)
+    {
+        fprintf(stderr, "test_net_lazy load failed\n");
+        return -1;
+    }
+
+    tinyinfer::Extractor ex = net.create_extractor();
+    ex.set_light_mode(lightmode);
+
+    // neither input is needed for the weight head
+    tinyinfer::Mat w0;
+    if (ex.extract("weight_splitncnn_0", w0) != 0)
+    {
+        fprintf(stderr, "test_net_lazy weight head failed\n");
+        return -1;
+    }
+
+    // layer weight, two split outputs and w0, the consumed weight blob is released in lightmode
+    int expect_refcount = lightmode ? 4 : 5;
+    if (!w0.refcount || *w0.refcount != expect_refcount)
+    {
+        fprintf(stderr, "test_net_lazy refcount %d expect %d\n", w0.refcount ? (int)*w0.refcount : 0, expect_refcount);
+        return -1;
+    }
+
+    // the cached sibling comes back without running the split again
+    tinyinfer::Mat w1;
+    if (ex.extract("weight_splitncnn_1", w1) != 0 || w1.data != w0.data || *w0.refcount != expect_refcount + 1)
+    {
+        fprintf(stderr, "test_net_lazy cached head failed\n");
+        return -1;
+    }
+
+    // the data head only needs data, data2 stays unset
+    tinyinfer::Mat in(4);
+    in.fill(1.f);
+    ex.input("data", in);
+
+    tinyinfer::Mat out;
+    if (ex.extract("data_splitncnn_0", out) != 0 || out.data != in.data)
+    {
+        fprintf(stderr, "test_net_lazy data head failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_net_bad_param()
+{
+    const float weights[1] = {0.f};
+
+    // unknown layer type
+    tinyinfer::Net net0;
+    if (load_net(net0, "202303\n1 1\nNoSuchLayer a 0 1 a\n", weights, 1) == 0)
+    {
+        fprintf(stderr, "test_net_bad_param accepted unknown layer\n");
+        return -1;
+    }
+
+    // bottom used before it is produced
+    tinyinfer::Net net1;
+    if (load_net(net1, "202303\n2 2\nSplit s 1 1 x y\nInput x 0 1 x\n", weights, 1) == 0)
+    {
+        fprintf(stderr, "test_net_bad_param accepted unsorted graph\n");
+        return -1;
+    }
+
+    // wrong magic
+    tinyinfer::Net net2;
+    if (load_net(net2, "7767517\n1 1\nInput x 0 1 x\n", weights, 1) == 0)
+    {
+        fprintf(stderr, "test_net_bad_param accepted wrong magic\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int forward_concat_net(const tinyinfer::Net& net, const tinyinfer::Mat& in, tinyinfer::Mat& out, tinyinfer::Mat& branch, size_t& copied)
+{
+    tinyinfer::Extractor ex = net.create_extractor();
+    ex.input("data", in);
+
+    // a branch taken out before the concat runs is a copy of its slice
+    int ret = ex.extract("p1", branch);
+
+    tinyinfer::reset_mat_copy_bytes();
+    if (ret == 0)
+        ret = ex.extract("flat", out);
+    copied = tinyinfer::get_mat_copy_bytes();
+
+    return ret;
+}
+
+// the concat producers write into its output from the second forward on, the flatten after it is a view
+static int test_net_inplace_concat(bool use_inplace_concat)
+{
+    const char* paramstr = "202303\n"
+                           "8 9\n"
+                           "Input            data 0 1 data 0=8 1=8 2=4\n"
+                           "Split            splitncnn_0 1 2 data data_splitncnn_0 data_splitncnn_1\n"
+                           "Pooling          p0 1 1 data_splitncnn_0 p0 0=0 1=3 3=1\n"
+                           "ReLU             r0 1 1 p0 r0\n"
+                           "Pooling          p1 1 1 data_splitncnn_1 p1 0=1 1=1\n"
+                           "Concat           cat 2 1 r0 p1 cat 0=0\n"
+                           "ReLU             r1 1 1 cat r1\n"
+                           "Flatten          flat 1 1 r1 flat\n";
+    const float weights[1] = {0.f};
+
+    tinyinfer::Net net;
+    net.opt.use_inplace_concat = use_inplace_concat;
+    if (load_net(net, paramstr, weights, 1) != 0)
+    {
+        fprintf(stderr, "test_net_inplace_concat load failed\n");
+        return -1;
+    }
+
+    tinyinfer::Mat in(8, 8, 4);
+    for (int q = 0; q < in.c; q++)
+    {
+        float* ptr = in.channel(q);
+        for (int i = 0; i < in.w * in.h; i++)
+            ptr[i] = (float)((i * 7 + q * 3) % 11) - 5.f;
+    }
+    tinyinfer::Mat in0 = in.clone();
+
+    tinyinfer::Mat out0, out1, branch0, branch1;
+    size_t copied0 = 0;
+    size_t copied1 = 0;
+    if (forward_concat_net(net, in, out0, branch0, copied0) != 0 || forward_concat_net(net, in, out1, branch1, copied1) != 0)
+    {
+        fprintf(stderr, "test_net_inplace_concat forward failed\n");
+        return -1;
+    }
+
+    // the second half of the output is the relu of the input, the input itself is left alone
+    const size_t size = (size_t)in.w * in.h * in.c;
+    bool ok = out0.dims == 1 && out1.dims == 1 && (size_t)out0.w == size * 2 && (size_t)out1.w == size * 2 && branch1.refcount;
+    for (size_t i = 0; ok && i < size; i++)
+    {
+        const float x = ((const float*)in0.data)[i];
+        ok = ((const float*)in.data)[i] == x && ((const float*)branch1.data)[i] == x;
+        ok = ok && out1[size + i] == (x > 0.f ? x : 0.f);
+    }
+    for (size_t i = 0; ok && i < size * 2; i++)
+    {
+        ok = out0[i] == out1[i];
+    }
+
+    // the first forward copies both concat inputs, the second none unless disabled
+    if (!ok || copied0 == 0 || (use_inplace_concat && copied1 != 0) || (!use_inplace_concat && copied1 == 0))
+    {
+        fprintf(stderr, "test_net_inplace_concat %d failed ok=%d copied0=%d copied1=%d\n", use_inplace_concat, ok, (int)copied0, (int)copied1);
+        return -1;
+    }
+
+    return 0;
+}
+
+// a gemm reading both operands through a permute that swaps their axes reads the inputs transposed instead
+static int test_net_permute_fold(bool use_permute_fold)
+{
+    const char* paramstr = "202303\n"
+                           "5 5\n"
+                           "Input            a 0 1 a 0=3 1=4\n"
+                           "Input            b 0 1 b 0=4 1=5\n"
+                           "Permute          pa 1 1 a pa 0=1\n"
+                           "Permute          pb 1 1 b pb 0=1\n"
+                           "Gemm             gemm 2 1 pa pb out\n";
+    const float weights[1] = {0.f};
+
+    tinyinfer::Net net;
+    net.opt.use_permute_fold = use_permute_fold;
+    if (load_net(net, paramstr, weights, 1) != 0)
+    {
+        fprintf(stderr, "test_net_permute_fold load failed\n");
+        return -1;
+    }
+
+    const tinyinfer::Layer* gemm = net.layers()[net.find_layer_index_by_name("gemm")];
+    const bool folded = gemm->bottoms[0] == net.find_blob_index_by_name("a") && gemm->bottoms[1] == net.find_blob_index_by_name("b");
+
+    // a is K x M and b is N x K
+    tinyinfer::Mat a(3, 4);
+    tinyinfer::Mat b(4, 5);
+    for (int i = 0; i < 12; i++)
+        a[i] = (float)(i % 5) - 2.f;
+    for (int i = 0; i < 20; i++)
+        b[i] = (float)(i % 7) - 3.f;
+
+    tinyinfer::Extractor ex = net.create_extractor();
+    ex.input("a", a);
+    ex.input("b", b);
+
+    tinyinfer::Mat out;
+    bool ok = ex.extract("out", out) == 0 && out.dims == 2 && out.w == 5 && out.h == 3;
+    for (int m = 0; ok && m < 3; m++)
+    {
+        for (int n = 0; ok && n < 5; n++)
+        {
+            float sum = 0.f;
+            for (int k = 0; k < 4; k++)
+                sum += a.row(k)[m] * b.row(n)[k];
+
+            ok = out.row(m)[n] == sum;
+        }
+    }
+
+    // the permute still runs when its own top is asked for
+    tinyinfer::Extractor ex2 = net.create_extractor();
+    ex2.input("a", a);
+
+    tinyinfer::Mat pa;
+    ok = ok && ex2.extract("pa", pa) == 0 && pa.w == 4 && pa.h == 3 && pa.row(2)[1] == a.row(1)[2];
+
+    if (!ok || folded != use_permute_fold)
+    {
+        fprintf(stderr, "test_net_permute_fold %d failed ok=%d folded=%d\n", use_permute_fold, ok, folded);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int forward_padding_net(const tinyinfer::Net& net, const tinyinfer::Mat& in, tinyinfer::Mat& conv, tinyinfer::Mat& pool)
+{
+    tinyinfer::Extractor ex = net.create_extractor();
+    ex.input("data", in);
+
+    int ret = ex.extract("conv", conv);
+    if (ret == 0)
+        ret = ex.extract("pool", pool);
+
+    return ret;
+}
+
+// constant paddings in front of a convolution padding with the same value and of an average pooling are folded into them
+static int test_net_padding_fold()
+{
+    const char* paramstr = "202303\n"
+                           "6 7\n"
+                           "Input            data 0 1 data 0=6 1=5 2=2\n"
+                           "Split            splitncnn_0 1 2 data d0 d1\n"
+                           "Padding          pad0 1 1 d0 pad0 0=1 1=2 2=1 3=0 5=0.5\n"
+                           "Convolution      conv 1 1 pad0 conv 0=1 1=3 4=1 18=0.5 5=1 6=18\n"
+                           "Padding          pad1 1 1 d1 pad1 0=1 1=1 2=2 3=2\n"
+                           "Pooling          pool 1 1 pad1 pool 0=1 1=3 5=1\n";
+
+    // float32 tag, 18 weights, bias
+    float weights[20];
+    weights[0] = 0.f;
+    for (int i = 0; i < 18; i++)
+        weights[1 + i] = (float)(i % 5 - 2) * 0.25f;
+    weights[19] = 0.125f;
+
+    tinyinfer::Net net;
+    tinyinfer::Net net_fold;
+    net.opt.use_padding_fold = false;
+    if (load_net(net, paramstr, weights, 20) != 0 || load_net(net_fold, paramstr, weights, 20) != 0)
+    {
+        fprintf(stderr, "test_net_padding_fold load failed\n");
+        return -1;
+    }
+
+    const int conv_index = net_fold.find_layer_index_by_name("conv");
+    const int pool_index = net_fold.find_layer_index_by_name("pool");
+    const bool folded = net_fold.layers()[conv_index]->bottoms[0] == net_fold.find_blob_index_by_name("d0")
+                        && net_fold.layers()[pool_index]->bottoms[0] == net_fold.find_blob_index_by_name("d1")
+                        && net.layers()[conv_index]->bottoms[0] == net.find_blob_index_by_name("pad0");
+
+    tinyinfer::Mat in(6, 5, 2);
+    for (int i = 0; i < (int)in.total(); i++)
+        in[i] = (float)((i * 7) % 11) - 5.f;
+
+    tinyinfer::Mat conv0, pool0, conv1, pool1;
+    if (forward_padding_net(net, in, conv0, pool0) != 0 || forward_padding_net(net_fold, in, conv1, pool1) != 0)
+    {
+        fprintf(stderr, "test_net_padding_fold forward failed\n");
+        return -1;
+    }
+
+    // 6 + 1 + 0 + 2 - 2 wide and 5 + 1 + 2 + 2 - 2 high, 6 + 4 - 2 wide and 5 + 2 - 2 high
+    bool ok = conv0.w == 7 && conv0.h == 8 && pool0.w == 8 && pool0.h == 5;
+    ok = ok && conv1.w == conv0.w && conv1.h == conv0.h && pool1.w == pool0.w && pool1.h == pool0.h;
+    for (int y = 0; ok && y < conv0.h; y++)
+    {
+        for (int x = 0; ok && x < conv0.w; x++)
+            ok = fabsf(conv0.row(y)[x] - conv1.row(y)[x]) < 1e-5f;
+    }
+    for (int q = 0; ok && q < pool0.c; q++)
+    {
+        for (int i = 0; ok && i < pool0.w * pool0.h; i++)
+            ok = fabsf(((const float*)pool0.channel(q))[i] - ((const float*)pool1.channel(q))[i]) < 1e-5f;
+    }
+
+    if (!ok || !folded)
+    {
+        fprintf(stderr, "test_net_padding_fold failed ok=%d folded=%d\n", ok, folded);
+        return -1;
+    }
+
+    return 0;
+}
+
+// two cached self attention layers fed one token per extractor against the whole sequence without a cache
+static int test_net_kv_cache()
+{
+    const char* paramstr = "202303\n"
+                           "5 9\n"
+                           "Input              data 0 1 data\n"
+                           "Split              splitncnn_0 1 3 data d0 d1 d2\n"
+                           "MultiHeadAttention attn0 3 1 d0 d1 d2 x 2=1 3=1\n"
+                           "Split              splitncnn_1 1 3 x x0 x1 x2\n"
+                           "MultiHeadAttention attn1 3 1 x0 x1 x2 out 2=1 3=1\n";
+    const float weights[1] = {0.f};
+
+    tinyinfer::Net net;
+    if (load_net(net, paramstr, weights, 1) != 0)
+    {
+        fprintf(stderr, "test_net_kv_cache load failed\n");
+        return -1;
+    }
+
+    const int seq = 6;
+    const int head_dim = 8;
+    tinyinfer::Mat in(head_dim, seq, 2);
+    for (int i = 0; i < (int)in.total(); i++)
+        in[i] = (float)((i * 7) % 13) * 0.125f - 0.75f;
+
+    // without a cache in the extractor the layers attend to their inputs only
+    tinyinfer::Mat expect;
+    {
+        tinyinfer::Extractor ex = net.create_extractor();
+        ex.input("data", in);
+        if (ex.extract("out", expect) != 0)
+        {
+            fprintf(stderr, "test_net_kv_cache full forward failed\n");
+            return -1;
+        }
+    }
+
+    tinyinfer::KVCache cache;
+    cache.set_chunk_size(4);
+
+    bool ok = true;
+    for (int y = 0; ok && y < seq; y++)
+    {
+        tinyinfer::Mat token(head_dim, 1, 2);
+        for (int q = 0; q < 2; q++)
+            memcpy(token.channel(q), in.channel(q).row(y), head_dim * sizeof(float));
+
+        tinyinfer::Extractor ex = net.create_extractor();
+        ex.set_kv_cache(&cache);
+        ex.input("data", token);
+
+        tinyinfer::Mat out;
+        ok = ex.extract("out", out) == 0 && out.w == head_dim && out.h == 1 && out.c == 2;
+        for (int q = 0; ok && q < 2; q++)
+        {
+            for (int i = 0; ok && i < head_dim; i++)
+                ok = fabsf(out.channel(q).row(0)[i] - expect.channel(q).row(y)[i]) < 1e-5f;
+        }
+    }
+
+    // one slot per cached layer
+    ok = ok && cache.length(0) == seq && cache.length(1) == seq && cache.length(2) == 0;
+
+    if (!ok)
+    {
+        fprintf(stderr, "test_net_kv_cache failed length=%d %d\n", cache.length(0), cache.length(1));
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    return 0
+           || test_net_extract()
+           || test_net_lazy(true)
+           || test_net_lazy(false)
+           || test_net_bad_param()
+           || test_net_inplace_concat(true)
+           || test_net_inplace_concat(false)
+           || test_net_permute_fold(true)
+           || test_net_permute_fold(false)
+           || test_net_padding_fold()
+           || test_net_kv_cache();
+}
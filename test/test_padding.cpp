@@ -0,0 +1,232 @@
+#include "testutil.h"
+#include <string.h>
+
+static int test_padding(const tinyinfer::Mat& a, int top, int bottom, int left, int right, int front, int behind, int type, float value)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, top);
+    pd.set(1, bottom);
+    pd.set(2, left);
+    pd.set(3, right);
+    pd.set(4, type);
+    pd.set(5, value);
+    pd.set(7, front);
+    pd.set(8, behind);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("Padding", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_padding failed a.dims=%d a=(%d %d %d %d) pad=%d %d %d %d %d %d type=%d value=%f\n", a.dims, a.w, a.h, a.d, a.c, top, bottom, left, right, front, behind, type, value);
+    }
+
+    return ret;
+}
+
+// the source index of an output position, -1 for the constant border
+static int reference_index(int i, int n, int type)
+{
+    if (i >= 0 && i < n)
+        return i;
+    if (type == 0)
+        return -1;
+    if (type == 1)
+        return i < 0 ? 0 : n - 1;
+
+    // reflect bounces off both edges without repeating them
+    while (i < 0 || i >= n)
+    {
+        if (i < 0)
+            i = -i;
+        if (i >= n)
+            i = 2 * (n - 1) - i;
+    }
+    return i;
+}
+
+static tinyinfer::Mat forward_naive(const tinyinfer::Mat& a, int top, int bottom, int left, int right, int front, int behind, int type, float value)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, top);
+    pd.set(1, bottom);
+    pd.set(2, left);
+    pd.set(3, right);
+    pd.set(4, type);
+    pd.set(5, value);
+    pd.set(7, front);
+    pd.set(8, behind);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+    opt.num_threads = 1;
+
+    tinyinfer::Mat b;
+    test_layer_forward(tinyinfer::layer_to_index("Padding"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b);
+    return b;
+}
+
+// the naive layer against an element wise reference, the outer axis of a 3d blob is padded by front and behind
+static int test_padding_reference(const tinyinfer::Mat& a, int top, int bottom, int left, int right, int front, int behind, int type, float value)
+{
+    tinyinfer::Mat b = forward_naive(a, top, bottom, left, right, front, behind, type, value);
+
+    const int outw = a.w + left + right;
+    const int outh = a.dims >= 2 ? a.h + top + bottom : 1;
+    const int outd = a.dims == 4 ? a.d + front + behind : 1;
+    const int outc = a.dims == 3 ? a.c + front + behind : a.c;
+
+    if (b.dims != a.dims || b.w != outw || (a.dims >= 2 && b.h != outh) || b.d != outd || b.c != outc)
+    {
+        fprintf(stderr, "test_padding_reference shape mismatch a.dims=%d b=(%d %d %d %d)\n", a.dims, b.w, b.h, b.d, b.c);
+        return -1;
+    }
+
+    for (int q = 0; q < outc; q++)
+    {
+        const int sq = a.dims == 3 ? reference_index(q - front, a.c, type) : q;
+        for (int z = 0; z < outd; z++)
+        {
+            const int sz = a.dims == 4 ? reference_index(z - front, a.d, type) : z;
+            for (int y = 0; y < outh; y++)
+            {
+                const int sy = a.dims >= 2 ? reference_index(y - top, a.h, type) : y;
+                for (int x = 0; x < outw; x++)
+                {
+                    const int sx = reference_index(x - left, a.w, type);
+
+                    float expect = value;
+                    if (sq >= 0 && sz >= 0 && sy >= 0 && sx >= 0)
+                        expect = ((const float*)a.channel(sq).depth(sz))[sy * a.w + sx];
+
+                    const float got = ((const float*)b.channel(q).depth(z))[y * outw + x];
+                    if (got != expect)
+                    {
+                        fprintf(stderr, "test_padding_reference failed a.dims=%d type=%d at (%d %d %d %d) got %f expect %f\n", a.dims, type, x, y, z, q, got, expect);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+// [1 2 3] padded by 2 on each side in the three modes
+static int test_padding_example()
+{
+    tinyinfer::Mat a(3);
+    a[0] = 1.f;
+    a[1] = 2.f;
+    a[2] = 3.f;
+
+    const float expect[3][7] = {
+        {-1.f, -1.f, 1.f, 2.f, 3.f, -1.f, -1.f},
+        {1.f, 1.f, 1.f, 2.f, 3.f, 3.f, 3.f},
+        {3.f, 2.f, 1.f, 2.f, 3.f, 2.f, 1.f},
+    };
+
+    for (int type = 0; type < 3; type++)
+    {
+        tinyinfer::Mat b = forward_naive(a, 0, 0, 2, 2, 0, 0, type, -1.f);
+        if (b.dims != 1 || b.w != 7 || memcmp((const float*)b, expect[type], 7 * sizeof(float)) != 0)
+        {
+            fprintf(stderr, "test_padding_example failed type=%d\n", type);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_padding_0()
+{
+    for (int type = 0; type < 3; type++)
+    {
+        int ret = 0
+                  || test_padding_reference(RandomMat(7), 0, 0, 3, 5, 0, 0, type, 0.5f)
+                  || test_padding_reference(RandomMat(9, 6), 2, 4, 1, 0, 0, 0, type, -2.f)
+                  || test_padding_reference(RandomMat(8, 5, 4), 1, 3, 4, 2, 2, 1, type, 0.f)
+                  || test_padding_reference(RandomMat(6, 5, 4, 3), 3, 0, 2, 5, 1, 3, type, 1.5f)
+                  // pads wider than the input bounce more than once
+                  || test_padding_reference(RandomMat(3, 2), 5, 4, 6, 7, 0, 0, type, 0.f);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_padding_1()
+{
+    for (int type = 0; type < 3; type++)
+    {
+        int ret = 0
+                  || test_padding(RandomMat(127), 0, 0, 1, 2, 0, 0, type, 0.f)
+                  || test_padding(RandomMat(19, 12), 1, 1, 1, 1, 0, 0, type, 0.25f)
+                  || test_padding(RandomMat(5, 6, 7), 0, 2, 3, 0, 0, 0, type, 0.f)
+                  || test_padding(RandomMat(5, 6, 7), 1, 1, 1, 1, 2, 3, type, -1.f)
+                  || test_padding(RandomMat(5, 6, 3, 7), 2, 1, 0, 4, 1, 2, type, 0.f)
+                  || test_padding(RandomMat(56, 56, 32), 1, 1, 1, 1, 0, 0, type, 0.f)
+                  || test_padding(RandomMat(40000), 0, 0, 16, 16, 0, 0, type, 3.f);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// no padding shares the input, pads the input rank does not have and bad params are rejected
+static int test_padding_2()
+{
+    tinyinfer::Mat a = RandomMat(5, 6, 7);
+    tinyinfer::Mat b;
+    tinyinfer::copy_make_border(a, b, 0, 0, 0, 0, 0, 0.f, tinyinfer::Option());
+    if (b.data != a.data)
+    {
+        fprintf(stderr, "test_padding_2 zero pads copied\n");
+        return -1;
+    }
+
+    tinyinfer::Mat a1 = RandomMat(9);
+    tinyinfer::Mat a2 = RandomMat(9, 4);
+    if (!forward_naive(a1, 1, 0, 0, 0, 0, 0, 0, 0.f).empty() || !forward_naive(a2, 0, 0, 0, 0, 1, 0, 0, 0.f).empty())
+    {
+        fprintf(stderr, "test_padding_2 accepted pads beyond the input rank\n");
+        return -1;
+    }
+
+    const int bad[][2] = {{0, -1}, {2, -3}, {8, -1}, {4, 3}};
+    for (int i = 0; i < 4; i++)
+    {
+        tinyinfer::ParamDict pd;
+        pd.set(bad[i][0], bad[i][1]);
+
+        tinyinfer::Layer* op = tinyinfer::create_layer(tinyinfer::layer_to_index("Padding"));
+        const int ret = op->load_param(pd);
+        delete op;
+
+        if (ret == 0)
+        {
+            fprintf(stderr, "test_padding_2 accepted param %d=%d\n", bad[i][0], bad[i][1]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_padding_example()
+           || test_padding_0()
+           || test_padding_1()
+           || test_padding_2();
+}
@@ -0,0 +1,50 @@
+#include "paramdict.h"
+#include <stdio.h>
+#include <string.h>
+
+static int test_paramdict_load()
+{
+    FILE* fp = tmpfile();
+    if (!fp)
+        return 0;
+
+    const char* text = "0=16 1=3 11=5 3=0.500000 4=-233 -23309=3,1,-2,3\nReLU relu0 1 1 a b\n";
+    fwrite(text, 1, strlen(text), fp);
+    rewind(fp);
+
+    tinyinfer::ParamDict pd;
+    int ret = pd.load_param(fp);
+
+    // the next layer line must be left untouched
+    char type[16];
+    int next = fscanf(fp, "%15s", type);
+    fclose(fp);
+
+    if (ret != 0 || next != 1 || strcmp(type, "ReLU") != 0)
+    {
+        fprintf(stderr, "test_paramdict_load stop at line end failed\n");
+        return -1;
+    }
+
+    if (pd.get(0, 0) != 16 || pd.get(11, 0) != 5 || pd.get(4, 0) != -233 || pd.get(7, 42) != 42
+            || pd.type(3) != 3 || pd.get(3, 0.f) != 0.5f || pd.get(1, 0.f) != 3.f)
+    {
+        fprintf(stderr, "test_paramdict_load scalar mismatch\n");
+        return -1;
+    }
+
+    tinyinfer::Mat axes = pd.get(9, tinyinfer::Mat());
+    const int* p = axes;
+    if (pd.type(9) != 4 || axes.w != 3 || p[0] != 1 || p[1] != -2 || p[2] != 3)
+    {
+        fprintf(stderr, "test_paramdict_load array mismatch\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    return 0 || test_paramdict_load();
+}
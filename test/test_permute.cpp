@@ -0,0 +1,163 @@
+#include "testutil.h"
+#include <string.h>
+
+static int test_permute(const tinyinfer::Mat& a, int order_type)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, order_type);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("Permute", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_permute failed a.dims=%d a=(%d %d %d %d) order_type=%d\n", a.dims, a.w, a.h, a.d, a.c, order_type);
+    }
+
+    return ret;
+}
+
+static int test_permute_all(const tinyinfer::Mat& a)
+{
+    const int orders = a.dims == 4 ? 24 : a.dims == 3 ? 6 : a.dims;
+    for (int order_type = 0; order_type < orders; order_type++)
+    {
+        int ret = test_permute(a, order_type);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// the naive layer itself, order lists the input axis of every output axis innermost first
+static int test_permute_reference(const tinyinfer::Mat& a, int order_type, const char* order)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, order_type);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+    opt.num_threads = 1;
+
+    tinyinfer::Mat b;
+    if (test_layer_forward(tinyinfer::layer_to_index("Permute"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b) != 0 || b.dims != a.dims)
+    {
+        fprintf(stderr, "test_permute_reference forward failed order_type=%d\n", order_type);
+        return -1;
+    }
+
+    const int bd = b.dims == 4 ? b.d : 1;
+    for (int q = 0; q < b.c; q++)
+    {
+        for (int z = 0; z < bd; z++)
+        {
+            for (int y = 0; y < b.h; y++)
+            {
+                for (int x = 0; x < b.w; x++)
+                {
+                    // position along w, h, d and c of the input, d stays 0 for dims 3
+                    int pos[4] = {0, 0, 0, 0};
+                    const int outpos[4] = {x, y, b.dims == 4 ? z : q, q};
+                    for (int i = 0; i < a.dims; i++)
+                    {
+                        const char* axis = strchr("whdc", order[i]);
+                        pos[axis - "whdc"] = outpos[i];
+                    }
+
+                    const float* ptr = a.channel(pos[3]);
+                    const float* outptr = b.channel(q);
+                    const float v = ptr[(pos[2] * a.h + pos[1]) * a.w + pos[0]];
+                    if (outptr[(z * b.h + y) * b.w + x] != v)
+                    {
+                        fprintf(stderr, "test_permute_reference value mismatch order_type=%d\n", order_type);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int test_permute_0()
+{
+    const char* orders3[] = {"whc", "hwc", "wch", "cwh", "hcw", "chw"};
+    for (int i = 0; i < 6; i++)
+    {
+        if (test_permute_reference(RandomMat(5, 3, 4), i, orders3[i]) != 0)
+            return -1;
+    }
+
+    return 0
+           || test_permute_reference(RandomMat(5, 3, 2, 4), 0, "whdc")
+           || test_permute_reference(RandomMat(5, 3, 2, 4), 1, "hwdc")
+           || test_permute_reference(RandomMat(5, 3, 2, 4), 5, "dhwc")
+           || test_permute_reference(RandomMat(5, 3, 2, 4), 6, "whcd")
+           || test_permute_reference(RandomMat(5, 3, 2, 4), 23, "cdhw");
+}
+
+// every order on odd shapes, smaller and larger than one register tile
+static int test_permute_1()
+{
+    return 0
+           || test_permute_all(RandomMat(13))
+           || test_permute_all(RandomMat(7, 9))
+           || test_permute_all(RandomMat(19, 33))
+           || test_permute_all(RandomMat(5, 7, 3))
+           || test_permute_all(RandomMat(17, 9, 21))
+           || test_permute_all(RandomMat(2, 3, 5, 7))
+           || test_permute_all(RandomMat(17, 5, 9, 19));
+}
+
+// large planes split into several blocks, and 1 sized axes
+static int test_permute_2()
+{
+    return 0
+           || test_permute(RandomMat(300, 129), 1)
+           || test_permute(RandomMat(64, 64, 64), 1)
+           || test_permute(RandomMat(130, 67, 3), 5)
+           || test_permute(RandomMat(67, 130, 3), 4)
+           || test_permute(RandomMat(33, 2, 150), 3)
+           || test_permute(RandomMat(31, 20, 4, 24), 23)
+           || test_permute(RandomMat(32, 16, 8, 12), 14)
+           || test_permute_all(RandomMat(1, 1, 6))
+           || test_permute_all(RandomMat(1, 1, 3, 5))
+           || test_permute_all(RandomMat(1, 7, 1, 5));
+}
+
+// orders past the ones of the dims are rejected
+static int test_permute_3()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, 6);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    for (int isa = TINYINFER_ISA_NAIVE; isa <= tinyinfer::cpu_isa_level(); isa++)
+    {
+        tinyinfer::Mat b;
+        if (test_layer_forward(tinyinfer::layer_to_index("Permute"), isa, pd, weights, opt, RandomMat(5, 6, 7), b) == 0)
+        {
+            fprintf(stderr, "test_permute_3 isa %d accepted order_type 6 for dims 3\n", isa);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_permute_0()
+           || test_permute_1()
+           || test_permute_2()
+           || test_permute_3();
+}
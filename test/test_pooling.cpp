@@ -0,0 +1,199 @@
+#include "testutil.h"
+
+static int test_pooling(int w, int h, int c, int pooling_type, int kernel, int stride, int pad, int pad_mode, int count_include_pad, int global_pooling = 0)
+{
+    tinyinfer::Mat a = RandomMat(w, h, c);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, pooling_type);
+    pd.set(1, kernel);
+    pd.set(2, stride);
+    pd.set(3, pad);
+    pd.set(4, global_pooling);
+    pd.set(5, pad_mode);
+    pd.set(6, count_include_pad);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("Pooling", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_pooling failed w=%d h=%d c=%d pooling_type=%d kernel=%d stride=%d pad=%d pad_mode=%d count_include_pad=%d global_pooling=%d\n", w, h, c, pooling_type, kernel, stride, pad, pad_mode, count_include_pad, global_pooling);
+    }
+
+    return ret;
+}
+
+static int test_pooling_adaptive(int w, int h, int c, int pooling_type, int out_w, int out_h)
+{
+    tinyinfer::Mat a = RandomMat(w, h, c);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, pooling_type);
+    pd.set(7, 1);
+    pd.set(8, out_w);
+    pd.set(18, out_h);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("Pooling", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_pooling_adaptive failed w=%d h=%d c=%d pooling_type=%d out_w=%d out_h=%d\n", w, h, c, pooling_type, out_w, out_h);
+    }
+
+    return ret;
+}
+
+// output sizes of the pad modes and the averages next to the padding, on the naive layer itself
+static int test_pooling_reference()
+{
+    tinyinfer::Option opt;
+    opt.num_threads = 1;
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    const int cases[][7] = {
+        // w kernel stride pad pad_mode expected_outw unused
+        {6, 3, 2, 0, 0, 3, 0},
+        {6, 3, 2, 0, 1, 2, 0},
+        {5, 2, 2, 1, 0, 3, 0},
+        {7, 3, 2, 0, 2, 4, 0},
+        {7, 3, 2, 0, 3, 4, 0},
+        {8, 2, 2, 0, 2, 4, 0},
+        {3, 3, 1, 1, 1, 3, 0},
+    };
+
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++)
+    {
+        tinyinfer::ParamDict pd;
+        pd.set(1, cases[i][1]);
+        pd.set(2, cases[i][2]);
+        pd.set(3, cases[i][3]);
+        pd.set(5, cases[i][4]);
+
+        tinyinfer::Mat b;
+        if (test_layer_forward(tinyinfer::layer_to_index("Pooling"), TINYINFER_ISA_NAIVE, pd, weights, opt, RandomMat(cases[i][0], cases[i][0], 1), b) != 0 || b.w != cases[i][5] || b.h != cases[i][5])
+        {
+            fprintf(stderr, "test_pooling_reference output size mismatch case %d got %d\n", i, b.w);
+            return -1;
+        }
+    }
+
+    // 2 x 2 ones, 3 x 3 average with pad 1, the corner window holds one value and three padded positions
+    tinyinfer::Mat a(2, 2, 1);
+    a.fill(1.f);
+
+    for (int count_include_pad = 0; count_include_pad < 2; count_include_pad++)
+    {
+        tinyinfer::ParamDict pd;
+        pd.set(0, 1);
+        pd.set(1, 2);
+        pd.set(2, 1);
+        pd.set(3, 1);
+        pd.set(5, 1);
+        pd.set(6, count_include_pad);
+
+        tinyinfer::Mat b;
+        if (test_layer_forward(tinyinfer::layer_to_index("Pooling"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b) != 0 || b.w != 3 || b.h != 3)
+        {
+            fprintf(stderr, "test_pooling_reference average forward failed\n");
+            return -1;
+        }
+
+        const float corner = count_include_pad ? 0.25f : 1.f;
+        const float edge = count_include_pad ? 0.5f : 1.f;
+        if (b.row(0)[0] != corner || b.row(0)[1] != edge || b.row(1)[1] != 1.f)
+        {
+            fprintf(stderr, "test_pooling_reference average count_include_pad=%d got %f %f %f\n", count_include_pad, b.row(0)[0], b.row(0)[1], b.row(1)[1]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// the 2x2s2 and 3x3s2 max kernels, odd and even sizes, every pad mode
+static int test_pooling_0()
+{
+    const int sizes[][2] = {{112, 112}, {56, 55}, {13, 13}, {7, 9}, {4, 3}};
+
+    for (int i = 0; i < 5; i++)
+    {
+        const int w = sizes[i][0];
+        const int h = sizes[i][1];
+        for (int pad_mode = 0; pad_mode < 4; pad_mode++)
+        {
+            int ret = 0
+                      || test_pooling(w, h, 5, 0, 2, 2, 0, pad_mode, 0)
+                      || test_pooling(w, h, 5, 0, 3, 2, 1, pad_mode, 0)
+                      || test_pooling(w, h, 5, 0, 3, 2, 0, pad_mode, 0);
+
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+// averages with and without the padding, stride 1 and generic kernels and strides
+static int test_pooling_1()
+{
+    const int sizes[][2] = {{35, 35}, {17, 16}, {8, 8}, {5, 7}};
+
+    for (int i = 0; i < 4; i++)
+    {
+        const int w = sizes[i][0];
+        const int h = sizes[i][1];
+        for (int pooling_type = 0; pooling_type < 2; pooling_type++)
+        {
+            for (int pad_mode = 0; pad_mode < 4; pad_mode++)
+            {
+                int ret = 0
+                          || test_pooling(w, h, 3, pooling_type, 2, 2, 0, pad_mode, 0)
+                          || test_pooling(w, h, 3, pooling_type, 3, 2, 1, pad_mode, 1)
+                          || test_pooling(w, h, 3, pooling_type, 3, 1, 1, pad_mode, 0)
+                          || test_pooling(w, h, 3, pooling_type, 3, 1, 1, pad_mode, 1)
+                          || test_pooling(w, h, 3, pooling_type, 2, 1, 0, pad_mode, 0)
+                          || test_pooling(w, h, 3, pooling_type, 5, 3, 2, pad_mode, 1)
+                          || test_pooling(w, h, 3, pooling_type, 4, 2, 1, pad_mode, 0)
+                          || test_pooling(w, h, 3, pooling_type, 1, 1, 0, pad_mode, 0);
+
+                if (ret != 0)
+                    return ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// global and adaptive, even and uneven windows
+static int test_pooling_2()
+{
+    return 0
+           || test_pooling(7, 7, 64, 0, 0, 1, 0, 0, 0, 1)
+           || test_pooling(7, 7, 64, 1, 0, 1, 0, 0, 0, 1)
+           || test_pooling(13, 11, 16, 0, 0, 1, 0, 0, 0, 1)
+           || test_pooling(13, 11, 16, 1, 0, 1, 0, 0, 0, 1)
+           || test_pooling(1, 1, 8, 1, 0, 1, 0, 0, 0, 1)
+           || test_pooling(300, 200, 2, 1, 0, 1, 0, 0, 0, 1)
+           || test_pooling_adaptive(7, 7, 16, 1, 1, 1)
+           || test_pooling_adaptive(14, 14, 16, 1, 7, 7)
+           || test_pooling_adaptive(14, 14, 16, 0, 7, 7)
+           || test_pooling_adaptive(13, 10, 16, 1, 7, 4)
+           || test_pooling_adaptive(13, 10, 16, 0, 7, 4)
+           || test_pooling_adaptive(5, 6, 4, 1, -233, 3);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_pooling_reference()
+           || test_pooling_0()
+           || test_pooling_1()
+           || test_pooling_2();
+}
@@ -0,0 +1,94 @@
+#include "testutil.h"
+
+static int test_pooling1d(int w, int h, int pooling_type, int kernel, int stride, int pad, int pad_mode, int count_include_pad, int global_pooling = 0)
+{
+    tinyinfer::Mat a = RandomMat(w, h);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, pooling_type);
+    pd.set(1, kernel);
+    pd.set(2, stride);
+    pd.set(3, pad);
+    pd.set(4, global_pooling);
+    pd.set(5, pad_mode);
+    pd.set(6, count_include_pad);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("Pooling1D", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_pooling1d failed w=%d h=%d pooling_type=%d kernel=%d stride=%d pad=%d pad_mode=%d count_include_pad=%d global_pooling=%d\n", w, h, pooling_type, kernel, stride, pad, pad_mode, count_include_pad, global_pooling);
+    }
+
+    return ret;
+}
+
+// rows stay rows, padding is along w only
+static int test_pooling1d_reference()
+{
+    tinyinfer::Mat a(4, 2);
+    for (int i = 0; i < 8; i++)
+        a[i] = (float)i;
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, 1);
+    pd.set(1, 2);
+    pd.set(2, 2);
+    pd.set(3, 1);
+    pd.set(5, 1);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Mat b;
+    if (test_layer_forward(tinyinfer::layer_to_index("Pooling1D"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b) != 0 || b.dims != 2 || b.w != 3 || b.h != 2)
+    {
+        fprintf(stderr, "test_pooling1d_reference forward failed\n");
+        return -1;
+    }
+
+    const float expect[6] = {0.f, 1.5f, 3.f, 4.f, 5.5f, 7.f};
+    for (int i = 0; i < 6; i++)
+    {
+        if (b[i] != expect[i])
+        {
+            fprintf(stderr, "test_pooling1d_reference expect %f but got %f at %d\n", expect[i], b[i], i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_pooling1d_0()
+{
+    for (int pooling_type = 0; pooling_type < 2; pooling_type++)
+    {
+        for (int pad_mode = 0; pad_mode < 4; pad_mode++)
+        {
+            int ret = 0
+                      || test_pooling1d(32, 8, pooling_type, 2, 2, 0, pad_mode, 0)
+                      || test_pooling1d(31, 5, pooling_type, 3, 2, 1, pad_mode, 1)
+                      || test_pooling1d(17, 3, pooling_type, 3, 1, 1, pad_mode, 0)
+                      || test_pooling1d(9, 4, pooling_type, 4, 3, 2, pad_mode, 1);
+
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    return 0
+           || test_pooling1d(50, 16, 0, 0, 1, 0, 0, 0, 1)
+           || test_pooling1d(50, 16, 1, 0, 1, 0, 0, 0, 1);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_pooling1d_reference()
+           || test_pooling1d_0();
+}
@@ -0,0 +1,51 @@
+#include "testutil.h"
+
+static int test_relu(const tinyinfer::Mat& a, float slope)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, slope);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("ReLU", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_relu failed a.dims=%d a=(%d %d %d) slope=%f\n", a.dims, a.w, a.h, a.c, slope);
+    }
+
+    return ret;
+}
+
+static int test_relu_0()
+{
+    return 0
+           || test_relu(RandomMat(5, 7, 24), 0.f)
+           || test_relu(RandomMat(7, 9, 12), 0.1f)
+           || test_relu(RandomMat(3, 5, 13), 0.f);
+}
+
+static int test_relu_1()
+{
+    return 0
+           || test_relu(RandomMat(15, 24), 0.f)
+           || test_relu(RandomMat(19, 12), 0.1f)
+           || test_relu(RandomMat(17, 15), 0.f);
+}
+
+static int test_relu_2()
+{
+    return 0
+           || test_relu(RandomMat(128), 0.f)
+           || test_relu(RandomMat(124), 0.1f)
+           || test_relu(RandomMat(127), 0.f);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_relu_0()
+           || test_relu_1()
+           || test_relu_2();
+}
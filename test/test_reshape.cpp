@@ -0,0 +1,95 @@
+#include "testutil.h"
+
+// view tells whether the top must share the bottom data without copying
+static int test_reshape(const tinyinfer::Mat& a, int outw, int outh, int outd, int outc, int dims, int w, int h, int d, int c, bool view)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, outw);
+    pd.set(1, outh);
+    pd.set(11, outd);
+    pd.set(2, outc);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Mat b;
+    tinyinfer::reset_mat_copy_bytes();
+    int ret = test_layer_forward(tinyinfer::layer_to_index("Reshape"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b);
+    const size_t copied = tinyinfer::get_mat_copy_bytes();
+
+    if (ret != 0 || b.dims != dims || b.w != w || b.h != h || b.d != d || b.c != c || CompareMatFlat(a, b) != 0 || (view && (b.data != a.data || copied != 0)))
+    {
+        fprintf(stderr, "test_reshape failed a.dims=%d a=(%d %d %d %d) param=(%d %d %d %d) b.dims=%d b=(%d %d %d %d) view=%d copied=%d\n", a.dims, a.w, a.h, a.d, a.c, outw, outh, outd, outc, b.dims, b.w, b.h, b.d, b.c, b.data == a.data, (int)copied);
+        return -1;
+    }
+
+    return 0;
+}
+
+// views, padding kept or absent
+static int test_reshape_0()
+{
+    return 0
+           || test_reshape(RandomMat(24), 6, 4, -233, -233, 2, 6, 4, 1, 1, true)
+           || test_reshape(RandomMat(24), 2, 3, -233, 4, 3, 2, 3, 1, 4, false)
+           || test_reshape(RandomMat(32), 4, 2, -233, 4, 3, 4, 2, 1, 4, true)
+           || test_reshape(RandomMat(32), 2, 2, 2, 4, 4, 2, 2, 2, 4, true)
+           || test_reshape(RandomMat(8, 4, 6), -1, -233, -233, -233, 1, 192, 1, 1, 1, true)
+           || test_reshape(RandomMat(8, 4, 6), 4, 8, -233, 0, 3, 4, 8, 1, 6, true)
+           || test_reshape(RandomMat(3, 5, 6), 15, 1, -233, 0, 3, 15, 1, 1, 6, true)
+           || test_reshape(RandomMat(3, 5, 2, 6), 5, 3, 2, 6, 4, 5, 3, 2, 6, true)
+           || test_reshape(RandomMat(3, 5, 2, 6), 6, 5, -233, 6, 3, 6, 5, 1, 6, true)
+           || test_reshape(RandomMat(7, 3, 1), 21, -233, -233, -233, 1, 21, 1, 1, 1, true)
+           || test_reshape(RandomMat(21), 7, 3, -233, 1, 3, 7, 3, 1, 1, true);
+}
+
+// the channel padding moves, inferred and kept axes
+static int test_reshape_1()
+{
+    return 0
+           || test_reshape(RandomMat(3, 5, 6), -1, -233, -233, -233, 1, 90, 1, 1, 1, false)
+           || test_reshape(RandomMat(3, 5, 6), 9, 5, -233, -1, 3, 9, 5, 1, 2, false)
+           || test_reshape(RandomMat(3, 5, 6), 5, -1, -233, 3, 3, 5, 6, 1, 3, false)
+           || test_reshape(RandomMat(3, 5, 6), 0, 0, -233, 0, 3, 3, 5, 1, 6, true)
+           || test_reshape(RandomMat(3, 5, 2, 6), 10, -1, -233, -233, 2, 10, 18, 1, 1, false)
+           || test_reshape(RandomMat(3, 5, 2, 6), 3, 5, 4, 3, 4, 3, 5, 4, 3, false)
+           || test_reshape(RandomMat(30, 12), 5, 6, -233, -1, 3, 5, 6, 1, 12, false)
+           || test_reshape(RandomMat(30, 12), 5, 6, 2, -1, 4, 5, 6, 2, 6, true);
+}
+
+// a size that does not divide or match is rejected
+static int test_reshape_2()
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, 7);
+    pd.set(1, -1);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Mat b;
+    const int ret0 = test_layer_forward(tinyinfer::layer_to_index("Reshape"), TINYINFER_ISA_NAIVE, pd, weights, opt, RandomMat(3, 5, 6), b);
+
+    pd.set(1, 4);
+    const int ret1 = test_layer_forward(tinyinfer::layer_to_index("Reshape"), TINYINFER_ISA_NAIVE, pd, weights, opt, RandomMat(3, 5, 6), b);
+
+    if (ret0 == 0 || ret1 == 0)
+    {
+        fprintf(stderr, "test_reshape_2 failed ret0=%d ret1=%d\n", ret0, ret1);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_reshape_0()
+           || test_reshape_1()
+           || test_reshape_2();
+}
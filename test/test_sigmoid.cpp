@@ -0,0 +1,70 @@
+#include "testutil.h"
+
+static int test_sigmoid(const tinyinfer::Mat& a, bool fast)
+{
+    tinyinfer::ParamDict pd;
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+    opt.use_fast_activation = fast;
+
+    int ret = test_layer("Sigmoid", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_sigmoid failed a.dims=%d a=(%d %d %d %d) fast=%d\n", a.dims, a.w, a.h, a.d, a.c, fast);
+    }
+
+    return ret;
+}
+
+static int test_sigmoid_0()
+{
+    for (int fast = 0; fast < 2; fast++)
+    {
+        int ret = 0
+                  || test_sigmoid(RandomMat(5, 6, 7, 24, -12.f, 12.f), fast)
+                  || test_sigmoid(RandomMat(7, 9, 12, -12.f, 12.f), fast)
+                  || test_sigmoid(RandomMat(3, 5, 13, -12.f, 12.f), fast)
+                  || test_sigmoid(RandomMat(19, 12, -12.f, 12.f), fast)
+                  || test_sigmoid(RandomMat(127, -12.f, 12.f), fast)
+                  || test_sigmoid(RandomMat(40000, -100.f, 100.f), fast);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static double ref_sigmoid(double x)
+{
+    return 1.0 / (1.0 + exp(-x));
+}
+
+// exact mode down into the denormal tail and at the specials
+static int test_sigmoid_1()
+{
+    const float specials[] = {0.f, -0.f, INFINITY, -INFINITY, NAN, FLT_TRUE_MIN, -FLT_MAX, FLT_MAX, 1e-20f};
+    const int count = sizeof(specials) / sizeof(float);
+
+    tinyinfer::Mat x(count);
+    for (int i = 0; i < count; i++)
+        x[i] = specials[i];
+
+    tinyinfer::ParamDict pd;
+
+    return 0
+           || test_layer_accuracy("Sigmoid", pd, tinyinfer::Option(), SweepMat(100000, -20.f, 20.f, false), ref_sigmoid, 3)
+           || test_layer_accuracy("Sigmoid", pd, tinyinfer::Option(), SweepMat(100000, -110.f, 110.f, false), ref_sigmoid, 3)
+           || test_layer_accuracy("Sigmoid", pd, tinyinfer::Option(), x, ref_sigmoid, 3);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_sigmoid_0()
+           || test_sigmoid_1();
+}
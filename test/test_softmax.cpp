@@ -0,0 +1,204 @@
+#include "testutil.h"
+
+static int test_softmax(const tinyinfer::Mat& a, int axis)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, axis);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("Softmax", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_softmax failed a.dims=%d a=(%d %d %d %d) axis=%d\n", a.dims, a.w, a.h, a.d, a.c, axis);
+    }
+
+    return ret;
+}
+
+// every axis of the blob, positive and negative
+static int test_softmax_all_axes(const tinyinfer::Mat& a)
+{
+    for (int axis = -a.dims; axis < a.dims; axis++)
+    {
+        int ret = test_softmax(a, axis);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// the element at (c, d, h, w) of a blob of any dims, missing axes are 0
+static const float* softmax_at(const tinyinfer::Mat& m, const int* i4)
+{
+    return (const float*)m.data + m.cstep * i4[0] + ((size_t)i4[1] * m.h + i4[2]) * m.w + i4[3];
+}
+
+// every isa layer against softmax in double, within max_ulp of it
+static int test_softmax_accuracy(const tinyinfer::Mat& a, int axis, double max_ulp, int num_threads = 1)
+{
+    // axis index into (c, d, h, w)
+    const int dims = a.dims;
+    const int positive_axis = axis < 0 ? dims + axis : axis;
+    const int axis4 = dims == 1 ? 3 : dims == 2 ? 2 + positive_axis : dims == 3 ? (positive_axis == 0 ? 0 : positive_axis + 1) : positive_axis;
+    const int shape4[4] = {a.c, a.d, a.h, a.w};
+    const int n = shape4[axis4];
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, axis);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+    opt.num_threads = num_threads;
+
+    std::vector<double> ref(n);
+
+    for (int isa = TINYINFER_ISA_SSE2; isa <= tinyinfer::cpu_isa_level(); isa++)
+    {
+        tinyinfer::Mat b;
+        if (test_layer_forward(tinyinfer::layer_to_index("Softmax"), isa, pd, weights, opt, a, b) != 0)
+        {
+            fprintf(stderr, "test_softmax_accuracy isa %d forward failed\n", isa);
+            return -1;
+        }
+
+        // every softmax, the position along the axis is left at 0
+        const int count = a.c * a.d * a.h * a.w / n;
+        for (int t = 0; t < count; t++)
+        {
+            int i4[4];
+            int r = t;
+            for (int j = 3; j >= 0; j--)
+            {
+                if (j == axis4)
+                {
+                    i4[j] = 0;
+                    continue;
+                }
+                i4[j] = r % shape4[j];
+                r /= shape4[j];
+            }
+
+            double max = -INFINITY;
+            for (int k = 0; k < n; k++)
+            {
+                i4[axis4] = k;
+                const double x = *softmax_at(a, i4);
+                max = x > max ? x : max;
+            }
+            double sum = 0.0;
+            for (int k = 0; k < n; k++)
+            {
+                i4[axis4] = k;
+                ref[k] = exp((double)*softmax_at(a, i4) - max);
+                sum += ref[k];
+            }
+
+            for (int k = 0; k < n; k++)
+            {
+                i4[axis4] = k;
+                const double r = ref[k] / sum;
+                const float y = *softmax_at(b, i4);
+                const double e = ulp_error(y, r);
+                if (e > max_ulp)
+                {
+                    fprintf(stderr, "test_softmax_accuracy isa %d a.dims=%d a=(%d %d %d %d) axis=%d x=%.9g expect %.9g but got %.9g, %.1f ulp\n", isa, a.dims, a.w, a.h, a.d, a.c, axis, *softmax_at(a, i4), r, y, e);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int test_softmax_0()
+{
+    return 0
+           || test_softmax_all_axes(RandomMat(5, 6, 7, 24))
+           || test_softmax_all_axes(RandomMat(16, 3, 2, 13))
+           || test_softmax_all_axes(RandomMat(7, 9, 12))
+           || test_softmax_all_axes(RandomMat(32, 5, 17))
+           || test_softmax_all_axes(RandomMat(1, 1, 40))
+           || test_softmax_all_axes(RandomMat(19, 12))
+           || test_softmax_all_axes(RandomMat(128, 3))
+           || test_softmax_all_axes(RandomMat(127))
+           || test_softmax_all_axes(RandomMat(1000))
+           || test_softmax_all_axes(RandomMat(1));
+}
+
+// rows long enough for the online softmax, and channel softmax over large planes split into column blocks
+static int test_softmax_1()
+{
+    return 0
+           || test_softmax(RandomMat(30000, -20.f, 20.f), 0)
+           || test_softmax(RandomMat(9000, 3, -20.f, 20.f), 1)
+           || test_softmax(RandomMat(64, 64, 64), 0)
+           || test_softmax(RandomMat(300, 200), 0)
+           || test_softmax(RandomMat(20, 30, 3000), 0);
+}
+
+// logits far from 0, with a huge common offset, masked with -inf and at the ends of the float range
+static int test_softmax_2()
+{
+    tinyinfer::Mat wide = RandomMat(257, 5, -1000.f, 1000.f);
+    tinyinfer::Mat offset = RandomMat(77, 6, 8, 1e4f - 5.f, 1e4f + 5.f);
+    tinyinfer::Mat negative = RandomMat(333, -1e4f - 30.f, -1e4f);
+    tinyinfer::Mat equal(50, 3);
+    equal.fill(3.5f);
+
+    tinyinfer::Mat masked = RandomMat(100, 4, -8.f, 8.f);
+    for (int i = 0; i < masked.h; i++)
+    {
+        for (int j = i * 10; j < masked.w; j += 3)
+            masked.row(i)[j] = -INFINITY;
+    }
+
+    tinyinfer::Mat extreme = RandomMat(37, -8.f, 8.f);
+    extreme[3] = FLT_MAX;
+    extreme[5] = -FLT_MAX;
+    extreme[20] = FLT_MAX * 0.5f;
+
+    return 0
+           || test_softmax_accuracy(RandomMat(1000, -8.f, 8.f), 0, 8)
+           || test_softmax_accuracy(RandomMat(13, 7, 37, -8.f, 8.f), 0, 8)
+           || test_softmax_accuracy(RandomMat(13, 7, 37, -8.f, 8.f), 1, 8)
+           || test_softmax_accuracy(RandomMat(13, 7, 3, 5, -8.f, 8.f), 1, 8)
+           || test_softmax_accuracy(wide, 1, 8)
+           || test_softmax_accuracy(wide, 0, 8)
+           || test_softmax_accuracy(offset, 0, 8)
+           || test_softmax_accuracy(offset, 2, 8)
+           || test_softmax_accuracy(negative, 0, 8)
+           || test_softmax_accuracy(equal, 1, 1)
+           || test_softmax_accuracy(masked, 1, 8)
+           || test_softmax_accuracy(masked, 0, 8)
+           || test_softmax_accuracy(extreme, 0, 8);
+}
+
+// long rows, vocabulary sized ones in one piece and split across threads, and the online softmax
+static int test_softmax_3()
+{
+    tinyinfer::Mat vocab = RandomMat(50257, -30.f, 30.f);
+    tinyinfer::Mat logits = RandomMat(32000, 2, -15.f, 15.f);
+
+    return 0
+           || test_softmax_accuracy(vocab, 0, 8)
+           || test_softmax_accuracy(vocab, 0, 8, 4)
+           || test_softmax_accuracy(logits, 1, 8)
+           || test_softmax_accuracy(logits, 1, 8, 4)
+           || test_softmax_accuracy(RandomMat(20000, -2.f, 2.f), 0, 8)
+           || test_softmax_accuracy(RandomMat((1 << 21) + 3, -10.f, 10.f), 0, 8);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_softmax_0()
+           || test_softmax_1()
+           || test_softmax_2()
+           || test_softmax_3();
+}
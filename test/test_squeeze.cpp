@@ -0,0 +1,102 @@
+#include "testutil.h"
+
+static int test_squeeze(const tinyinfer::Mat& a, int squeeze_w, int squeeze_h, int squeeze_d, int squeeze_c, const std::vector<int>& axes, int dims, int w, int h, int d, int c)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, squeeze_w);
+    pd.set(1, squeeze_h);
+    pd.set(11, squeeze_d);
+    pd.set(2, squeeze_c);
+    if (!axes.empty())
+    {
+        tinyinfer::Mat axes_mat((int)axes.size());
+        for (size_t i = 0; i < axes.size(); i++)
+            ((int*)axes_mat.data)[i] = axes[i];
+        pd.set(3, axes_mat);
+    }
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Mat b;
+    int ret = test_layer_forward(tinyinfer::layer_to_index("Squeeze"), TINYINFER_ISA_NAIVE, pd, weights, opt, a, b);
+    if (ret != 0 || b.dims != dims || b.w != w || b.h != h || b.d != d || b.c != c || CompareMatFlat(a, b) != 0)
+    {
+        fprintf(stderr, "test_squeeze failed a.dims=%d a=(%d %d %d %d) flags=(%d %d %d %d) axes=%d b.dims=%d b=(%d %d %d %d)\n", a.dims, a.w, a.h, a.d, a.c, squeeze_w, squeeze_h, squeeze_d, squeeze_c, (int)axes.size(), b.dims, b.w, b.h, b.d, b.c);
+        return -1;
+    }
+
+    return 0;
+}
+
+static std::vector<int> squeeze_axes(int a0, int a1 = -233)
+{
+    std::vector<int> axes(1, a0);
+    if (a1 != -233)
+        axes.push_back(a1);
+    return axes;
+}
+
+// every axis of 1 by flags
+static int test_squeeze_0()
+{
+    const std::vector<int> none;
+
+    return 0
+           || test_squeeze(RandomMat(1, 5, 6), 1, 1, 1, 1, none, 2, 5, 6, 1, 1)
+           || test_squeeze(RandomMat(5, 1, 6), 1, 1, 1, 1, none, 2, 5, 6, 1, 1)
+           || test_squeeze(RandomMat(5, 6, 1), 1, 1, 1, 1, none, 2, 5, 6, 1, 1)
+           || test_squeeze(RandomMat(5, 6, 1), 1, 1, 1, 0, none, 3, 5, 6, 1, 1)
+           || test_squeeze(RandomMat(1, 1, 7), 1, 1, 1, 1, none, 1, 7, 1, 1, 1)
+           || test_squeeze(RandomMat(1, 1, 1), 1, 1, 1, 1, none, 1, 1, 1, 1, 1)
+           || test_squeeze(RandomMat(3, 5, 1, 6), 1, 1, 1, 1, none, 3, 3, 5, 1, 6)
+           || test_squeeze(RandomMat(1, 7), 1, 1, 1, 1, none, 1, 7, 1, 1, 1)
+           || test_squeeze(RandomMat(7, 1), 0, 1, 0, 0, none, 1, 7, 1, 1, 1);
+}
+
+// explicit axes outermost first, negative ones from the end
+static int test_squeeze_1()
+{
+    const std::vector<int> none;
+
+    return 0
+           || test_squeeze(RandomMat(1, 5, 6), 0, 0, 0, 0, squeeze_axes(2), 2, 5, 6, 1, 1)
+           || test_squeeze(RandomMat(1, 5, 6), 0, 0, 0, 0, squeeze_axes(-1), 2, 5, 6, 1, 1)
+           || test_squeeze(RandomMat(5, 6, 1), 0, 0, 0, 0, squeeze_axes(0), 2, 5, 6, 1, 1)
+           || test_squeeze(RandomMat(1, 1, 7), 0, 0, 0, 0, squeeze_axes(1), 2, 1, 7, 1, 1)
+           || test_squeeze(RandomMat(3, 1, 1, 6), 0, 0, 0, 0, squeeze_axes(1, 2), 2, 3, 6, 1, 1)
+           || test_squeeze(RandomMat(3, 5, 1, 6), 0, 0, 0, 0, squeeze_axes(-3), 3, 3, 5, 1, 6);
+}
+
+// an axis that is not 1 is rejected
+static int test_squeeze_2()
+{
+    tinyinfer::ParamDict pd;
+    tinyinfer::Mat axes_mat(1);
+    ((int*)axes_mat.data)[0] = 1;
+    pd.set(3, axes_mat);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+
+    tinyinfer::Mat b;
+    if (test_layer_forward(tinyinfer::layer_to_index("Squeeze"), TINYINFER_ISA_NAIVE, pd, weights, opt, RandomMat(5, 6, 1), b) == 0)
+    {
+        fprintf(stderr, "test_squeeze_2 failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_squeeze_0()
+           || test_squeeze_1()
+           || test_squeeze_2();
+}
@@ -0,0 +1,63 @@
+#include "testutil.h"
+
+static int test_swish(const tinyinfer::Mat& a, bool fast)
+{
+    tinyinfer::ParamDict pd;
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    tinyinfer::Option opt;
+    opt.use_fast_activation = fast;
+
+    int ret = test_layer("Swish", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_swish failed a.dims=%d a=(%d %d %d %d) fast=%d\n", a.dims, a.w, a.h, a.d, a.c, fast);
+    }
+
+    return ret;
+}
+
+static int test_swish_0()
+{
+    for (int fast = 0; fast < 2; fast++)
+    {
+        int ret = 0
+                  || test_swish(RandomMat(5, 6, 7, 24, -12.f, 12.f), fast)
+                  || test_swish(RandomMat(7, 9, 12, -12.f, 12.f), fast)
+                  || test_swish(RandomMat(3, 5, 13, -12.f, 12.f), fast)
+                  || test_swish(RandomMat(19, 12, -12.f, 12.f), fast)
+                  || test_swish(RandomMat(127, -12.f, 12.f), fast)
+                  || test_swish(RandomMat(40000, -100.f, 100.f), fast);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static double ref_swish(double x)
+{
+    return x / (1.0 + exp(-x));
+}
+
+// exact mode, the negative side stays within a few ulp while the result is normal
+static int test_swish_1()
+{
+    tinyinfer::ParamDict pd;
+
+    return 0
+           || test_layer_accuracy("Swish", pd, tinyinfer::Option(), SweepMat(100000, -20.f, 20.f, false), ref_swish, 4)
+           || test_layer_accuracy("Swish", pd, tinyinfer::Option(), SweepMat(100000, -80.f, 100.f, false), ref_swish, 4)
+           || test_layer_accuracy("Swish", pd, tinyinfer::Option(), SweepMat(100000, 1e-30f, 1.f, true), ref_swish, 4);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_swish_0()
+           || test_swish_1();
+}
@@ -0,0 +1,181 @@
+#include "threadpool.h"
+#include "mat.h"
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// every index visited exactly once, sub ranges respect the grain
+static int test_threadpool_cover(tinyinfer::ThreadPool& pool, int begin, int end, int grain, int max_threads)
+{
+    std::vector<std::atomic<int> > visits(end > begin ? end - begin : 1);
+    for (size_t i = 0; i < visits.size(); i++)
+        visits[i].store(0);
+
+    std::atomic<int> bad_range(0);
+    pool.parallel_for(begin, end, grain, [&](int i0, int i1) {
+        if (i0 >= i1 || (i1 - i0 > grain && i1 - i0 != end - begin))
+            bad_range.fetch_add(1);
+
+        for (int i = i0; i < i1; i++)
+            visits[i - begin].fetch_add(1);
+    }, max_threads);
+
+    for (int i = begin; i < end; i++)
+    {
+        if (visits[i - begin].load() != 1)
+        {
+            fprintf(stderr, "test_threadpool_cover failed [%d %d) grain=%d index %d visited %d times\n", begin, end, grain, i, visits[i - begin].load());
+            return -1;
+        }
+    }
+
+    if (bad_range.load() != 0)
+    {
+        fprintf(stderr, "test_threadpool_cover failed [%d %d) grain=%d bad sub range\n", begin, end, grain);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_threadpool_0()
+{
+    tinyinfer::ThreadPool pool(4);
+
+    return 0
+           || test_threadpool_cover(pool, 0, 0, 1, 0)
+           || test_threadpool_cover(pool, 0, 1, 1, 0)
+           || test_threadpool_cover(pool, 0, 3, 1, 0)
+           || test_threadpool_cover(pool, 5, 1000, 1, 0)
+           || test_threadpool_cover(pool, -7, 1001, 16, 0)
+           || test_threadpool_cover(pool, 0, 100000, 7, 0)
+           || test_threadpool_cover(pool, 0, 1000, 1, 2)
+           || test_threadpool_cover(pool, 0, 1000, 1, 1);
+}
+
+// uneven work per item, stealing has to rebalance it
+static int test_threadpool_1()
+{
+    tinyinfer::ThreadPool pool(4);
+
+    std::atomic<long> sum(0);
+    pool.parallel_for(0, 64, 1, [&](int i0, int i1) {
+        for (int i = i0; i < i1; i++)
+        {
+            long local = 0;
+            const int work = i < 8 ? 200000 : 10;
+            for (int j = 0; j < work; j++)
+                local += j % 3;
+            sum.fetch_add(local + i);
+        }
+    });
+
+    long expect = 0;
+    for (int i = 0; i < 64; i++)
+    {
+        const int work = i < 8 ? 200000 : 10;
+        for (int j = 0; j < work; j++)
+            expect += j % 3;
+        expect += i;
+    }
+
+    if (sum.load() != expect)
+    {
+        fprintf(stderr, "test_threadpool_1 failed %ld expect %ld\n", sum.load(), expect);
+        return -1;
+    }
+
+    return 0;
+}
+
+// nested loops run serially inside a chunk, concurrent callers share one pool
+static int test_threadpool_2()
+{
+    tinyinfer::ThreadPool pool(4);
+
+    std::atomic<int> count(0);
+    pool.parallel_for(0, 16, 1, [&](int i0, int i1) {
+        for (int i = i0; i < i1; i++)
+        {
+            pool.parallel_for(0, 100, 1, [&](int j0, int j1) {
+                count.fetch_add(j1 - j0);
+            });
+        }
+    });
+
+    if (count.load() != 1600)
+    {
+        fprintf(stderr, "test_threadpool_2 nested failed %d\n", count.load());
+        return -1;
+    }
+
+    std::atomic<int> count2(0);
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 3; t++)
+    {
+        callers.push_back(std::thread([&]() {
+            for (int r = 0; r < 200; r++)
+            {
+                pool.parallel_for(0, 50, 1, [&](int j0, int j1) {
+                    count2.fetch_add(j1 - j0);
+                });
+            }
+        }));
+    }
+    for (size_t t = 0; t < callers.size(); t++)
+        callers[t].join();
+
+    if (count2.load() != 3 * 200 * 50)
+    {
+        fprintf(stderr, "test_threadpool_2 concurrent failed %d\n", count2.load());
+        return -1;
+    }
+
+    return 0;
+}
+
+// pinning is best effort, the pool keeps working afterwards
+static int test_threadpool_affinity()
+{
+    tinyinfer::ThreadPool pool(3);
+
+    std::vector<int> cpus(1, 0);
+    pool.set_affinity(cpus);
+
+    return test_threadpool_cover(pool, 0, 4096, 3, 0);
+}
+
+// Mat helpers large enough to use the default pool
+static int test_threadpool_mat()
+{
+    tinyinfer::Mat a;
+    a.create(333, 257, 5);
+    a.fill(2.5f);
+
+    tinyinfer::Mat b = a.clone();
+    for (int q = 0; q < b.c; q++)
+    {
+        const float* p = b.channel(q);
+        for (int i = 0; i < b.w * b.h; i++)
+        {
+            if (p[i] != 2.5f)
+            {
+                fprintf(stderr, "test_threadpool_mat failed at %d %d\n", q, i);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    return 0
+           || test_threadpool_0()
+           || test_threadpool_1()
+           || test_threadpool_2()
+           || test_threadpool_affinity()
+           || test_threadpool_mat();
+}
@@ -0,0 +1,141 @@
+#include "testutil.h"
+
+#define OP_TYPE_MAX 20
+
+static int test_unaryop(const tinyinfer::Mat& _a, int op_type)
+{
+    tinyinfer::Mat a = _a.clone();
+
+    // keep inside the domain, the comparison would not see a nan
+    if (op_type == 5 || op_type == 6 || op_type == 8 || op_type == 17)
+        Randomize(a, 0.001f, 2.f);
+    if (op_type == 12 || op_type == 13)
+        Randomize(a, -0.999f, 0.999f);
+    if (op_type == 2 || op_type == 3 || op_type == 18 || op_type == 19)
+        Randomize(a, -20.f, 20.f);
+
+    tinyinfer::ParamDict pd;
+    pd.set(0, op_type);
+
+    std::vector<tinyinfer::Mat> weights(0);
+
+    int ret = test_layer("UnaryOp", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_unaryop failed a.dims=%d a=(%d %d %d %d) op_type=%d\n", a.dims, a.w, a.h, a.d, a.c, op_type);
+    }
+
+    return ret;
+}
+
+static int test_unaryop_0()
+{
+    for (int op_type = 0; op_type < OP_TYPE_MAX; op_type++)
+    {
+        int ret = 0
+                  || test_unaryop(RandomMat(5, 6, 7, 24), op_type)
+                  || test_unaryop(RandomMat(7, 9, 12), op_type)
+                  || test_unaryop(RandomMat(3, 5, 13), op_type)
+                  || test_unaryop(RandomMat(19, 12), op_type)
+                  || test_unaryop(RandomMat(127), op_type)
+                  || test_unaryop(RandomMat(40000), op_type);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// the vector approximation of every isa variant against double precision libm
+static int test_unaryop_accuracy(int op_type, double (*ref)(double), const tinyinfer::Mat& x, double max_ulp, double abs_error)
+{
+    tinyinfer::ParamDict pd;
+    pd.set(0, op_type);
+
+    int ret = test_layer_accuracy("UnaryOp", pd, tinyinfer::Option(), x, ref, max_ulp, abs_error);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_unaryop_accuracy failed op_type=%d\n", op_type);
+    }
+
+    return ret;
+}
+
+static double ref_rsqrt(double x)
+{
+    return 1.0 / sqrt(x);
+}
+
+static double ref_reciprocal(double x)
+{
+    return 1.0 / x;
+}
+
+static double ref_round(double x)
+{
+    return nearbyint(x);
+}
+
+static int test_unaryop_1()
+{
+    const int n = 100000;
+
+    return 0
+           || test_unaryop_accuracy(7, exp, SweepMat(n, -110.f, 90.f, false), 2, 0)
+           || test_unaryop_accuracy(7, exp, SweepMat(n, -1.f, 1.f, false), 2, 0)
+           || test_unaryop_accuracy(8, log, SweepMat(n, FLT_TRUE_MIN, FLT_MAX, true), 1, 0)
+           || test_unaryop_accuracy(8, log, SweepMat(n, 0.5f, 2.f, false), 1, 0)
+           || test_unaryop_accuracy(17, log10, SweepMat(n, 1e-30f, 1e30f, true), 2, 0)
+           || test_unaryop_accuracy(16, tanh, SweepMat(n, -12.f, 12.f, false), 2, 0)
+           || test_unaryop_accuracy(14, atan, SweepMat(n, -100.f, 100.f, false), 3, 0)
+           || test_unaryop_accuracy(14, atan, SweepMat(n, 1e-20f, 1e20f, true), 3, 0)
+           || test_unaryop_accuracy(12, asin, SweepMat(n, -1.f, 1.f, false), 3, 0)
+           || test_unaryop_accuracy(13, acos, SweepMat(n, -1.f, 1.f, false), 2, 0)
+           || test_unaryop_accuracy(9, sin, SweepMat(n, -4.f, 4.f, false), 2, 0)
+           || test_unaryop_accuracy(9, sin, SweepMat(n, -100.f, 100.f, false), 2, 0)
+           || test_unaryop_accuracy(10, cos, SweepMat(n, -100.f, 100.f, false), 2, 0)
+           || test_unaryop_accuracy(9, sin, SweepMat(n, -8192.f, 8192.f, false), 4, 6e-8)
+           || test_unaryop_accuracy(10, cos, SweepMat(n, -8192.f, 8192.f, false), 4, 6e-8)
+           || test_unaryop_accuracy(11, tan, SweepMat(n, -1.5f, 1.5f, false), 3, 0)
+           || test_unaryop_accuracy(5, sqrt, SweepMat(n, FLT_TRUE_MIN, FLT_MAX, true), 0.5, 0)
+           || test_unaryop_accuracy(6, ref_rsqrt, SweepMat(n, 1e-30f, 1e30f, true), 2, 0)
+           || test_unaryop_accuracy(15, ref_reciprocal, SweepMat(n, -1000.f, 1000.f, false), 0.5, 0)
+           || test_unaryop_accuracy(2, floor, SweepMat(n, -3e7f, 3e7f, false), 0, 0)
+           || test_unaryop_accuracy(3, ceil, SweepMat(n, -3e7f, 3e7f, false), 0, 0)
+           || test_unaryop_accuracy(18, ref_round, SweepMat(n, -40.f, 40.f, false), 0, 0)
+           || test_unaryop_accuracy(19, trunc, SweepMat(n, -3e7f, 3e7f, false), 0, 0);
+}
+
+// infinities, nan, zeros and denormals follow libm
+static int test_unaryop_2()
+{
+    const float specials[] = {0.f, -0.f, INFINITY, -INFINITY, NAN, FLT_TRUE_MIN, -FLT_TRUE_MIN, FLT_MIN, FLT_MAX, -FLT_MAX, 1.f, -1.f, 0.5f, -2.5f, 1e-20f, 8388609.f};
+    const int count = sizeof(specials) / sizeof(float);
+
+    tinyinfer::Mat x(count);
+    for (int i = 0; i < count; i++)
+        x[i] = specials[i];
+
+    return 0
+           || test_unaryop_accuracy(7, exp, x, 2, 0)
+           || test_unaryop_accuracy(8, log, x, 2, 0)
+           || test_unaryop_accuracy(16, tanh, x, 3, 0)
+           || test_unaryop_accuracy(14, atan, x, 2, 0)
+           || test_unaryop_accuracy(12, asin, x, 3, 0)
+           || test_unaryop_accuracy(13, acos, x, 3, 0)
+           || test_unaryop_accuracy(2, floor, x, 0, 0)
+           || test_unaryop_accuracy(3, ceil, x, 0, 0)
+           || test_unaryop_accuracy(18, ref_round, x, 0, 0)
+           || test_unaryop_accuracy(19, trunc, x, 0, 0);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_unaryop_0()
+           || test_unaryop_1()
+           || test_unaryop_2();
+}
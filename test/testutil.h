@@ -0,0 +1,296 @@
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#include "modelbin.h"
+#include "paramdict.h"
+#include "prng.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+static struct prng_rand_t g_prng_rand_state;
+#define SRAND(seed) prng_srand(seed, &g_prng_rand_state)
+#define RAND()      prng_rand(&g_prng_rand_state)
+
+static float RandomFloat(float a = -1.2f, float b = 1.2f)
+{
+    float random = ((float)RAND()) / (float)PRNG_RAND_MAX;
+    return a + random * (b - a);
+}
+
+static void Randomize(tinyinfer::Mat& m, float a = -1.2f, float b = 1.2f)
+{
+    for (int q = 0; q < m.c; q++)
+    {
+        float* p = m.channel(q);
+        for (int i = 0; i < m.w * m.h * m.d * m.elempack; i++)
+        {
+            p[i] = RandomFloat(a, b);
+        }
+    }
+}
+
+static tinyinfer::Mat RandomMat(int w, float a = -1.2f, float b = 1.2f)
+{
+    tinyinfer::Mat m(w);
+    Randomize(m, a, b);
+    return m;
+}
+
+static tinyinfer::Mat RandomMat(int w, int h, float a = -1.2f, float b = 1.2f)
+{
+    tinyinfer::Mat m(w, h);
+    Randomize(m, a, b);
+    return m;
+}
+
+static tinyinfer::Mat RandomMat(int w, int h, int c, float a = -1.2f, float b = 1.2f)
+{
+    tinyinfer::Mat m;
+    m.create(w, h, c);
+    Randomize(m, a, b);
+    return m;
+}
+
+static tinyinfer::Mat RandomMat(int w, int h, int d, int c, float a = -1.2f, float b = 1.2f)
+{
+    tinyinfer::Mat m;
+    m.create(w, h, d, c);
+    Randomize(m, a, b);
+    return m;
+}
+
+static int CompareMat(const tinyinfer::Mat& a, const tinyinfer::Mat& b, float epsilon = 0.001f)
+{
+    if (a.dims != b.dims || a.w != b.w || a.h != b.h || a.d != b.d || a.c != b.c || a.elempack != b.elempack)
+    {
+        fprintf(stderr, "shape not match %d %d %d %d %d  vs  %d %d %d %d %d\n", a.dims, a.w, a.h, a.d, a.c, b.dims, b.w, b.h, b.d, b.c);
+        return -1;
+    }
+
+    for (int q = 0; q < a.c; q++)
+    {
+        const float* pa = a.channel(q);
+        const float* pb = b.channel(q);
+        for (int i = 0; i < a.w * a.h * a.d * a.elempack; i++)
+        {
+            float ea = pa[i];
+            float eb = pb[i];
+            if (fabsf(ea - eb) > epsilon * (fabsf(ea) + fabsf(eb) + 1.f) * 0.5f)
+            {
+                fprintf(stderr, "value not match at c:%d i:%d expect %f but got %f\n", q, i, ea, eb);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// same elements in flat order, the shapes and channel padding may differ
+static int CompareMatFlat(const tinyinfer::Mat& a, const tinyinfer::Mat& b)
+{
+    const size_t a_plane = (size_t)a.w * a.h * a.d;
+    const size_t b_plane = (size_t)b.w * b.h * b.d;
+    if (a_plane * a.c != b_plane * b.c)
+    {
+        fprintf(stderr, "size not match %d %d %d %d  vs  %d %d %d %d\n", a.w, a.h, a.d, a.c, b.w, b.h, b.d, b.c);
+        return -1;
+    }
+
+    for (size_t i = 0; i < a_plane * a.c; i++)
+    {
+        float ea = ((const float*)a.data)[a.cstep * (i / a_plane) + i % a_plane];
+        float eb = ((const float*)b.data)[b.cstep * (i / b_plane) + i % b_plane];
+        if (ea != eb)
+        {
+            fprintf(stderr, "value not match at %d expect %f but got %f\n", (int)i, ea, eb);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// floats between lo and hi, evenly spaced or geometric for a positive range over many binades
+static tinyinfer::Mat SweepMat(int n, float lo, float hi, bool geometric)
+{
+    tinyinfer::Mat m(n);
+    for (int i = 0; i < n; i++)
+    {
+        const double t = (double)i / (n - 1);
+        m[i] = geometric ? (float)(lo * pow((double)hi / lo, t)) : (float)(lo + (hi - lo) * t);
+    }
+    return m;
+}
+
+// distance in units of the float spacing at the exact result
+static double ulp_error(float y, double r)
+{
+    if (isnan(r) || isnan(y))
+        return isnan(r) && isnan(y) ? 0.0 : 1e30;
+    // beyond FLT_MAX the correctly rounded result is inf
+    if (isinf((float)r) || isinf(y))
+        return y == (float)r ? 0.0 : 1e30;
+
+    const float rf = (float)fabs(r);
+    const double ulp = rf == 0.f ? FLT_TRUE_MIN : (double)nextafterf(rf, INFINITY) - rf;
+    return fabs(y - r) / ulp;
+}
+
+// run one single-blob layer created at the given isa level
+static int test_layer_forward(int typeindex, int isa, const tinyinfer::ParamDict& pd, const std::vector<tinyinfer::Mat>& weights, const tinyinfer::Option& opt, const tinyinfer::Mat& a, tinyinfer::Mat& b)
+{
+    tinyinfer::Layer* op = tinyinfer::create_layer_isa(typeindex, isa);
+    if (!op)
+        return -1;
+
+    int ret = op->load_param(pd);
+    if (ret == 0)
+        ret = op->load_model(tinyinfer::ModelBinFromMatArray(weights.data()));
+    if (ret == 0)
+        ret = op->create_pipeline(opt);
+    if (ret == 0)
+        ret = op->forward(a, b, opt);
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return ret;
+}
+
+// every isa variant the cpu supports must match the naive implementation
+static int test_layer(const char* layer_type, const tinyinfer::ParamDict& pd, const std::vector<tinyinfer::Mat>& weights, const tinyinfer::Option& opt, const tinyinfer::Mat& a, float epsilon = 0.001f)
+{
+    int typeindex = tinyinfer::layer_to_index(layer_type);
+
+    tinyinfer::Mat b;
+    if (test_layer_forward(typeindex, TINYINFER_ISA_NAIVE, pd, weights, opt, a, b) != 0)
+    {
+        fprintf(stderr, "test_layer %s naive forward failed\n", layer_type);
+        return -1;
+    }
+
+    for (int isa = TINYINFER_ISA_SSE2; isa <= tinyinfer::cpu_isa_level(); isa++)
+    {
+        tinyinfer::Mat c;
+        if (test_layer_forward(typeindex, isa, pd, weights, opt, a, c) != 0)
+        {
+            fprintf(stderr, "test_layer %s isa %d forward failed\n", layer_type, isa);
+            return -1;
+        }
+
+        if (CompareMat(b, c, epsilon) != 0)
+        {
+            fprintf(stderr, "test_layer %s isa %d output mismatch\n", layer_type, isa);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_layer(const char* layer_type, const tinyinfer::ParamDict& pd, const std::vector<tinyinfer::Mat>& weights, const tinyinfer::Mat& a, float epsilon = 0.001f)
+{
+    return test_layer(layer_type, pd, weights, tinyinfer::Option(), a, epsilon);
+}
+
+// every isa variant of a weightless elementwise layer against a double precision reference
+// abs_error forgives results whose ulp is far below what the float input already costs, near zero crossings and in underflowing tails
+static int test_layer_accuracy(const char* layer_type, const tinyinfer::ParamDict& pd, const tinyinfer::Option& opt, const tinyinfer::Mat& x, double (*ref)(double), double max_ulp, double abs_error = 0)
+{
+    std::vector<tinyinfer::Mat> weights(0);
+
+    for (int isa = TINYINFER_ISA_SSE2; isa <= tinyinfer::cpu_isa_level(); isa++)
+    {
+        tinyinfer::Mat y;
+        if (test_layer_forward(tinyinfer::layer_to_index(layer_type), isa, pd, weights, opt, x, y) != 0)
+        {
+            fprintf(stderr, "test_layer_accuracy %s isa %d forward failed\n", layer_type, isa);
+            return -1;
+        }
+
+        for (int i = 0; i < x.w; i++)
+        {
+            const double r = ref((double)x[i]);
+            const double e = ulp_error(y[i], r);
+            if (e > max_ulp && !(fabs(y[i] - r) <= abs_error))
+            {
+                fprintf(stderr, "test_layer_accuracy %s isa %d x=%.9g expect %.9g but got %.9g, %.1f ulp\n", layer_type, isa, x[i], r, y[i], e);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// run one multi-blob layer created at the given isa level
+static int test_layer_forward(int typeindex, int isa, const tinyinfer::ParamDict& pd, const std::vector<tinyinfer::Mat>& weights, const tinyinfer::Option& opt, const std::vector<tinyinfer::Mat>& a, std::vector<tinyinfer::Mat>& b)
+{
+    tinyinfer::Layer* op = tinyinfer::create_layer_isa(typeindex, isa);
+    if (!op)
+        return -1;
+
+    int ret = op->load_param(pd);
+    if (ret == 0)
+        ret = op->load_model(tinyinfer::ModelBinFromMatArray(weights.data()));
+    if (ret == 0)
+        ret = op->create_pipeline(opt);
+    if (ret == 0)
+        ret = op->forward(a, b, opt);
+
+    op->destroy_pipeline(opt);
+    delete op;
+    return ret;
+}
+
+static int test_layer_forward(int typeindex, int isa, const tinyinfer::ParamDict& pd, const std::vector<tinyinfer::Mat>& weights, const std::vector<tinyinfer::Mat>& a, std::vector<tinyinfer::Mat>& b)
+{
+    return test_layer_forward(typeindex, isa, pd, weights, tinyinfer::Option(), a, b);
+}
+
+// multi-blob flavor of test_layer, top_count outputs are compared
+static int test_layer(const char* layer_type, const tinyinfer::ParamDict& pd, const std::vector<tinyinfer::Mat>& weights, const tinyinfer::Option& opt, const std::vector<tinyinfer::Mat>& a, int top_count, float epsilon = 0.001f)
+{
+    int typeindex = tinyinfer::layer_to_index(layer_type);
+
+    std::vector<tinyinfer::Mat> b(top_count);
+    if (test_layer_forward(typeindex, TINYINFER_ISA_NAIVE, pd, weights, opt, a, b) != 0)
+    {
+        fprintf(stderr, "test_layer %s naive forward failed\n", layer_type);
+        return -1;
+    }
+
+    for (int isa = TINYINFER_ISA_SSE2; isa <= tinyinfer::cpu_isa_level(); isa++)
+    {
+        std::vector<tinyinfer::Mat> c(top_count);
+        if (test_layer_forward(typeindex, isa, pd, weights, opt, a, c) != 0)
+        {
+            fprintf(stderr, "test_layer %s isa %d forward failed\n", layer_type, isa);
+            return -1;
+        }
+
+        for (int i = 0; i < top_count; i++)
+        {
+            if (CompareMat(b[i], c[i], epsilon) != 0)
+            {
+                fprintf(stderr, "test_layer %s isa %d output %d mismatch\n", layer_type, isa, i);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int test_layer(const char* layer_type, const tinyinfer::ParamDict& pd, const std::vector<tinyinfer::Mat>& weights, const std::vector<tinyinfer::Mat>& a, int top_count, float epsilon = 0.001f)
+{
+    return test_layer(layer_type, pd, weights, tinyinfer::Option(), a, top_count, epsilon);
+}
+
+#endif // TESTUTIL_H
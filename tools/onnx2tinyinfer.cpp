@@ -1,11 +1,24 @@
 #include "onnx.pb.h"
+#include "mat.h"
+#include "modelbin.h"
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/text_format.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
 #include <iomanip>
 #include <fstream>
 #include <string>
+#include <map>
+#include <set>
+#include <queue>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 #include <float.h>
 
 static float get_node_attr_f(const onnx::NodeProto& node, const char* key, float def=0.f)
@@ -34,7 +47,7 @@ static float get_node_attr_i(const onnx::NodeProto& node, const char* key, float
     return def;
 }
 
-static onnx::TensorProto get_node_attr_tensor(const onnx::NodeProto& node, const char* key)
+static const onnx::TensorProto& get_node_attr_tensor(const onnx::NodeProto& node, const char* key)
 {
     for (int i = 0; i < node.attribute_size(); i++)
     {
@@ -44,7 +57,7 @@ static onnx::TensorProto get_node_attr_tensor(const onnx::NodeProto& node, const
             return attr.t();
         }
     }
-    return onnx::TensorProto();
+    return onnx::TensorProto::default_instance();
 }
 
 static std::vector<int> get_node_attr_ai(const onnx::NodeProto& node, const char* key)
@@ -53,7 +66,7 @@ static std::vector<int> get_node_attr_ai(const onnx::NodeProto& node, const char
     for (int i = 0; i < node.attribute_size(); i++)
     {
         const onnx::AttributeProto& attr = node.attribute(i);
-        if (attr.name() == "key")
+        if (attr.name() == key)
         {
             v.resize(attr.ints_size());
             for (int j = 0; j < attr.ints_size(); j++)
@@ -67,6 +80,26 @@ static std::vector<int> get_node_attr_ai(const onnx::NodeProto& node, const char
     return v;
 }
 
+static std::vector<float> get_node_attr_af(const onnx::NodeProto& node, const char* key)
+{
+    std::vector<float> v;
+    for (int i = 0; i < node.attribute_size(); i++)
+    {
+        const onnx::AttributeProto& attr = node.attribute(i);
+        if (attr.name() == key)
+        {
+            v.resize(attr.floats_size());
+            for (int j = 0; j < attr.floats_size(); j++)
+            {
+                v[j] = attr.floats(j);
+            }
+            break;
+        }
+    }
+
+    return v;
+}
+
 static std::string get_node_attr_s(const onnx::NodeProto& node, const char* key, const std::string& def = std::string())
 {
     for (int i = 0; i < node.attribute_size(); i++)
@@ -81,17 +114,231 @@ static std::string get_node_attr_s(const onnx::NodeProto& node, const char* key,
     return def;
 }
 
+// tensors with data_location EXTERNAL keep their bytes in files next to the model,
+// each file is mmaped once and tensor data is read straight from the mapping
+class ExternalData
+{
+public:
+    ~ExternalData()
+    {
+        for (std::map<std::string, std::pair<void*, size_t> >::iterator it = mapped.begin(); it != mapped.end(); it++)
+        {
+            munmap(it->second.first, it->second.second);
+        }
+    }
+
+    const char* map(const std::string& location, size_t* filesize)
+    {
+        std::map<std::string, std::pair<void*, size_t> >::iterator it = mapped.find(location);
+        if (it != mapped.end())
+        {
+            *filesize = it->second.second;
+            return (const char*)it->second.first;
+        }
+
+        std::string path = basedir.empty() ? location : basedir + "/" + location;
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            fprintf(stderr, "open external data %s failed\n", path.c_str());
+            return 0;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            fprintf(stderr, "stat external data %s failed\n", path.c_str());
+            close(fd);
+            return 0;
+        }
+        size_t size = (size_t)st.st_size;
+
+        void* ptr = size ? mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (ptr == MAP_FAILED)
+        {
+            fprintf(stderr, "mmap external data %s failed\n", path.c_str());
+            return 0;
+        }
+
+        // weights are consumed front to back while writing the bin
+        madvise(ptr, size, MADV_SEQUENTIAL);
+
+        mapped[location] = std::make_pair(ptr, size);
+        *filesize = size;
+        return (const char*)ptr;
+    }
+
+public:
+    // directory of the onnx model, external data locations are relative to it
+    std::string basedir;
+
+private:
+    std::map<std::string, std::pair<void*, size_t> > mapped;
+};
+
+static ExternalData g_external_data;
+
+// bytes per element of a tensor data type, 0 for string and the types the converter does not read
+static size_t get_tensor_proto_element_size(int data_type)
+{
+    switch (data_type)
+    {
+    case 2:  // uint8
+    case 3:  // int8
+    case 9:  // bool
+        return 1;
+    case 4:  // uint16
+    case 5:  // int16
+    case 10: // float16
+    case 16: // bfloat16
+        return 2;
+    case 1:  // float
+    case 6:  // int32
+    case 12: // uint32
+        return 4;
+    case 7:  // int64
+    case 11: // double
+    case 13: // uint64
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+// the bytes of a tensor with data_location EXTERNAL, the range must lie in the file and hold every element
+// size is the byte size of the elements, the length entry may only pad past them
+// return 0 if success
+static int get_tensor_proto_external_data(const onnx::TensorProto& tp, const char** data, size_t* size)
+{
+    std::string location;
+    size_t offset = 0;
+    size_t length = 0;
+    bool has_length = false;
+    for (int i = 0; i < tp.external_data_size(); i++)
+    {
+        const onnx::StringStringEntryProto& entry = tp.external_data(i);
+        if (entry.key() == "location")
+        {
+            location = entry.value();
+        }
+        else if (entry.key() == "offset")
+        {
+            offset = strtoull(entry.value().c_str(), 0, 10);
+        }
+        else if (entry.key() == "length")
+        {
+            length = strtoull(entry.value().c_str(), 0, 10);
+            has_length = true;
+        }
+    }
+
+    const size_t element_size = get_tensor_proto_element_size(tp.data_type());
+    if (location.empty() || element_size == 0)
+    {
+        fprintf(stderr, "invalid external data location %s or data type %d of tensor %s\n", location.c_str(), tp.data_type(), tp.name().c_str());
+        return -1;
+    }
+
+    size_t count = 1;
+    for (int i = 0; i < tp.dims_size(); i++)
+    {
+        count *= (size_t)tp.dims(i);
+    }
+
+    size_t filesize = 0;
+    const char* mapped = g_external_data.map(location, &filesize);
+    if (!mapped)
+        return -1;
+
+    // offset + length is not formed, it could wrap around
+    if (offset > filesize || (has_length && length > filesize - offset))
+    {
+        fprintf(stderr, "external data %s of tensor %s at offset %zu length %zu is past the %zu bytes file\n", location.c_str(), tp.name().c_str(), offset, length, filesize);
+        return -1;
+    }
+
+    const size_t available = has_length ? length : filesize - offset;
+    if (available < count * element_size)
+    {
+        fprintf(stderr, "external data %s of tensor %s holds %zu bytes, %zu elements need %zu\n", location.c_str(), tp.name().c_str(), available, count, count * element_size);
+        return -1;
+    }
+
+    *data = mapped + offset;
+    *size = count * element_size;
+    return 0;
+}
+
+// every external tensor of the graph resolves before anything is written
+// return 0 if success
+static int check_external_data(const onnx::GraphProto& graph)
+{
+    const char* data = 0;
+    size_t size = 0;
+
+    for (int i = 0; i < graph.initializer_size(); i++)
+    {
+        const onnx::TensorProto& tp = graph.initializer(i);
+        if (tp.data_location() == onnx::TensorProto::EXTERNAL && get_tensor_proto_external_data(tp, &data, &size) != 0)
+            return -1;
+    }
+
+    for (int i = 0; i < graph.node_size(); i++)
+    {
+        const onnx::NodeProto& node = graph.node(i);
+        for (int j = 0; j < node.attribute_size(); j++)
+        {
+            const onnx::TensorProto& tp = node.attribute(j).t();
+            if (tp.data_location() == onnx::TensorProto::EXTERNAL && get_tensor_proto_external_data(tp, &data, &size) != 0)
+                return -1;
+        }
+    }
+
+    return 0;
+}
+
+// raw bytes of the tensor, inline raw_data or external data, size is 0 when tensor uses typed fields
+static const char* get_tensor_proto_raw_data(const onnx::TensorProto& tp, size_t* size)
+{
+    if (tp.data_location() != onnx::TensorProto::EXTERNAL)
+    {
+        *size = tp.raw_data().size();
+        return tp.raw_data().data();
+    }
+
+    // check_external_data has resolved every external tensor of the graph, typed fields are empty for them
+    const char* data = 0;
+    if (get_tensor_proto_external_data(tp, &data, size) != 0)
+        abort();
+
+    return data;
+}
+
+static const float* get_tensor_proto_float_data(const onnx::TensorProto& tp)
+{
+    size_t raw_size = 0;
+    const char* raw_data = get_tensor_proto_raw_data(tp, &raw_size);
+    if (raw_size)
+        return (const float*)raw_data;
+
+    return tp.float_data().data();
+}
+
 static float get_node_attr_from_input_f(const onnx::TensorProto& tp)
 {
     float v = 0.f;
 
+    size_t raw_size = 0;
+    const char* raw_data = get_tensor_proto_raw_data(tp, &raw_size);
+
     // float
     if (tp.data_type() == 1)
     {
         const float* shape_data = 0;
-        if (tp.raw_data().size())
+        if (raw_size)
         {
-            shape_data = (const float*)tp.raw_data().data();
+            shape_data = (const float*)raw_data;
         }
         else
         {
@@ -103,9 +350,9 @@ static float get_node_attr_from_input_f(const onnx::TensorProto& tp)
     else if (tp.data_type() == 11)
     {
         const double* shape_data = 0;
-        if (tp.raw_data().size())
+        if (raw_size)
         {
-            shape_data = (const double*)tp.raw_data().data();
+            shape_data = (const double*)raw_data;
         }
         else
         {
@@ -117,9 +364,9 @@ static float get_node_attr_from_input_f(const onnx::TensorProto& tp)
     else if (tp.data_type() == 7)
     {
         const int64_t* shape_data = 0;
-        if (tp.raw_data().size())
+        if (raw_size)
         {
-            shape_data = (const int64_t*)tp.raw_data().data();
+            shape_data = (const int64_t*)raw_data;
         }
         else
         {
@@ -131,9 +378,9 @@ static float get_node_attr_from_input_f(const onnx::TensorProto& tp)
     else if (tp.data_type() == 6)
     {
         const int32_t* shape_data = 0;
-        if (tp.raw_data().size())
+        if (raw_size)
         {
-            shape_data = (const int32_t*)tp.raw_data().data();
+            shape_data = (const int32_t*)raw_data;
         }
         else
         {
@@ -150,119 +397,1161 @@ static float get_node_attr_from_input_f(const onnx::TensorProto& tp)
     return v;
 }
 
-static std::vector<int> get_node_attr_from_input_ai(const onnx::TensorProto& tp)
-{
-    int size = 0;
+static std::vector<int> get_node_attr_from_input_ai(const onnx::TensorProto& tp)
+{
+    int size = 0;
+
+    size_t raw_size = 0;
+    const char* raw_data = get_tensor_proto_raw_data(tp, &raw_size);
+
+    std::vector<int> v;
+
+    // int64
+    if (tp.data_type() == 7)
+    {
+        const int64_t* shape_data = 0;
+        if (raw_size)
+        {
+            shape_data = (const int64_t*)raw_data;
+            size = (int)(raw_size / 8);
+        }
+        else
+        {
+            shape_data = tp.int64_data().data();
+            size = tp.int64_data_size();
+        }
+        for (int j = 0; j < size; j++)
+        {
+            int vi = std::max(std::min(shape_data[j], (::google::protobuf::int64)INT_MAX), (::google::protobuf::int64)INT_MIN);
+            v.push_back(vi);
+        }
+    }
+    // int32
+    else if (tp.data_type() == 6)
+    {
+        const int32_t* shape_data = 0;
+        if (raw_size)
+        {
+            shape_data = (const int32_t*)raw_data;
+            size = (int)(raw_size / 4);
+        }
+        else
+        {
+            shape_data = tp.int32_data().data();
+            size = tp.int32_data_size();
+        }
+        for (int j = 0; j < size; j++)
+        {
+            v.push_back(shape_data[j]);
+        }
+    }
+    else
+    {
+        fprintf(stderr, "Unknown data type %d\n", tp.data_type());
+    }
+
+    return v;
+}
+
+static int get_tensor_proto_data_size(const onnx::TensorProto& tp)
+{
+    size_t raw_size = 0;
+    get_tensor_proto_raw_data(tp, &raw_size);
+    if (raw_size > 0)
+    {
+        int size = (int)(raw_size / 4);
+        return size;
+    }
+    else if (tp.data_type() == 1)
+    {
+        return tp.float_data_size();
+    }
+    return 0;
+}
+
+static const onnx::TensorProto& get_weight(const std::map<std::string, const onnx::TensorProto*>& weights, const std::string& name)
+{
+    std::map<std::string, const onnx::TensorProto*>::const_iterator it = weights.find(name);
+    if (it == weights.end())
+        return onnx::TensorProto::default_instance();
+
+    return *it->second;
+}
+
+static bool read_onnx_model(const char* filepath, onnx::ModelProto& message)
+{
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Open failed %s\n", filepath);
+        return false;
+    }
+
+    google::protobuf::io::FileInputStream input(fd);
+    input.SetCloseOnDelete(true);
+
+    // lift the default message size limit, graphs beyond it keep their weights as external data
+    google::protobuf::io::CodedInputStream decoder(&input);
+    decoder.SetTotalBytesLimit(INT_MAX);
+
+    if (!message.ParseFromCodedStream(&decoder) || !decoder.ConsumedEntireMessage())
+    {
+        fprintf(stderr, "Failed to parse onnx model.%s\n", filepath);
+        return false;
+    }
+
+    std::string path(filepath);
+    size_t slash = path.find_last_of('/');
+    g_external_data.basedir = slash == std::string::npos ? std::string() : path.substr(0, slash);
+
+    return true;
+}
+
+static void ofstream_tensor_proto_data(const onnx::TensorProto& tp, std::ofstream& ofs)
+{
+    int size = get_tensor_proto_data_size(tp);
+
+    size_t raw_size = 0;
+    const char* raw_data = get_tensor_proto_raw_data(tp, &raw_size);
+    if (raw_size > 0)
+    {
+        ofs.write(raw_data, (size_t)size * sizeof(float));
+    }else if (tp.data_type() == 1)
+    {
+        ofs.write((const char*)tp.float_data().data(), size * sizeof(float));
+    }
+}
+
+// tagged weight data is written as [tag] [payload] [padding]
+// payload is float32, or float16 padded to 4 bytes when fp16 is enabled
+static void ofstream_weight_tag(bool fp16, std::ofstream& ofs)
+{
+    unsigned int tag = fp16 ? TINYINFER_WEIGHT_TAG_FLOAT16 : TINYINFER_WEIGHT_TAG_FLOAT32;
+    ofs.write((const char*)&tag, sizeof(tag));
+}
+
+static void ofstream_weight_data(const float* data, size_t size, bool fp16, std::ofstream& ofs)
+{
+    if (!fp16)
+    {
+        ofs.write((const char*)data, size * sizeof(float));
+        return;
+    }
+
+    unsigned short buffer[4096];
+    for (size_t i = 0; i < size;)
+    {
+        size_t n = std::min(size - i, (size_t)4096);
+        for (size_t j = 0; j < n; j++)
+        {
+            buffer[j] = tinyinfer::float32_to_float16(data[i + j]);
+        }
+        ofs.write((const char*)buffer, n * sizeof(unsigned short));
+        i += n;
+    }
+}
+
+static void ofstream_weight_padding(size_t size, bool fp16, std::ofstream& ofs)
+{
+    if (fp16 && size % 2)
+    {
+        unsigned short zero = 0;
+        ofs.write((const char*)&zero, sizeof(zero));
+    }
+}
+
+static void ofstream_tensor_proto_weight(const onnx::TensorProto& tp, bool fp16, std::ofstream& ofs)
+{
+    size_t size = get_tensor_proto_data_size(tp);
+
+    ofstream_weight_tag(fp16, ofs);
+    ofstream_weight_data(get_tensor_proto_float_data(tp), size, fp16, ofs);
+    ofstream_weight_padding(size, fp16, ofs);
+}
+
+// the order_type-th ordering of the axes as the Permute layer enumerates them, innermost first
+// a copy of permute_axes in src/layer/permute.cpp, the two must enumerate the same orders
+static void permute_axes(int order_type, const int* axes, int count, int* out)
+{
+    if (count == 0)
+        return;
+
+    int group = 1;
+    for (int i = 2; i < count; i++)
+        group *= i;
+
+    const int last = count - 1 - order_type / group;
+
+    int rest[4];
+    int k = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (i != last)
+            rest[k++] = axes[i];
+    }
+
+    permute_axes(order_type % group, rest, count - 1, out);
+    out[count - 1] = axes[last];
+}
+
+// Permute order_type of an onnx perm that keeps the batch axis first, -1 if there is none
+static int permute_order_type(const std::vector<int>& perm)
+{
+    const int dims = (int)perm.size() - 1;
+    if (dims < 1 || dims > 4 || perm[0] != 0)
+        return -1;
+
+    // output axes innermost first as input axes innermost first
+    int axes[4];
+    for (int i = 0; i < dims; i++)
+    {
+        axes[i] = dims - perm[dims - i];
+    }
+
+    const int identity[4] = {0, 1, 2, 3};
+
+    int orders = 1;
+    for (int i = 2; i <= dims; i++)
+        orders *= i;
+
+    for (int order_type = 0; order_type < orders; order_type++)
+    {
+        int out[4];
+        permute_axes(order_type, identity, dims, out);
+        if (std::equal(out, out + dims, axes))
+            return order_type;
+    }
+
+    return -1;
+}
+
+// Kahn's algorithm over a producer index, the ready queue is ordered by the
+// original node index so an already sorted graph keeps its node order.
+// Nodes are permuted in place with pointer swaps, no NodeProto is copied.
+static int topological_sort(onnx::GraphProto* mutable_graph, const std::map<std::string, const onnx::TensorProto*>& weights)
+{
+    const int node_num = mutable_graph->node_size();
+
+    std::unordered_set<std::string> graph_inputs;
+    for (int i = 0; i < mutable_graph->input_size(); i++)
+    {
+        graph_inputs.insert(mutable_graph->input(i).name());
+    }
+
+    // blob name -> index of the node that produces it
+    std::unordered_map<std::string, int> producer;
+    producer.reserve(node_num * 2);
+    for (int i = 0; i < node_num; i++)
+    {
+        const onnx::NodeProto& node = mutable_graph->node(i);
+        for (int j = 0; j < node.output_size(); j++)
+        {
+            const std::string& output_name = node.output(j);
+            if (output_name.empty())
+                continue;
+
+            producer[output_name] = i;
+        }
+    }
+
+    // producer -> consumer edges in compressed row storage
+    std::vector<int> indegree(node_num, 0);
+    std::vector<int> consumer_offset(node_num + 1, 0);
+    std::vector<std::pair<int, int> > edges;
+    edges.reserve(node_num * 2);
+    for (int i = 0; i < node_num; i++)
+    {
+        const onnx::NodeProto& node = mutable_graph->node(i);
+        for (int j = 0; j < node.input_size(); j++)
+        {
+            const std::string& input_name = node.input(j);
+            if (input_name.empty())
+                continue;
+
+            if (graph_inputs.find(input_name) != graph_inputs.end() || weights.find(input_name) != weights.end())
+                continue;
+
+            std::unordered_map<std::string, int>::const_iterator it = producer.find(input_name);
+            if (it == producer.end())
+            {
+                fprintf(stderr, "cannot find node produces %s but node %d requires it\n", input_name.c_str(), i);
+                return -1;
+            }
+
+            edges.push_back(std::make_pair(it->second, i));
+            consumer_offset[it->second + 1]++;
+            indegree[i]++;
+        }
+    }
+
+    for (int i = 0; i < node_num; i++)
+    {
+        consumer_offset[i + 1] += consumer_offset[i];
+    }
+
+    std::vector<int> consumers(edges.size());
+    {
+        std::vector<int> fill = consumer_offset;
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            consumers[fill[edges[i].first]++] = edges[i].second;
+        }
+    }
+
+    std::priority_queue<int, std::vector<int>, std::greater<int> > ready;
+    for (int i = 0; i < node_num; i++)
+    {
+        if (indegree[i] == 0)
+            ready.push(i);
+    }
+
+    std::vector<int> order;
+    order.reserve(node_num);
+    while (!ready.empty())
+    {
+        int i = ready.top();
+        ready.pop();
+        order.push_back(i);
+
+        for (int k = consumer_offset[i]; k < consumer_offset[i + 1]; k++)
+        {
+            int q = consumers[k];
+            if (--indegree[q] == 0)
+                ready.push(q);
+        }
+    }
+
+    if ((int)order.size() != node_num)
+    {
+        fprintf(stderr, "graph has a cycle, %d of %d nodes cannot be ordered\n", node_num - (int)order.size(), node_num);
+        return -1;
+    }
+
+    // apply the permutation, at[] is the original index of the node at each position
+    std::vector<int> at(node_num);
+    std::vector<int> where(node_num);
+    for (int i = 0; i < node_num; i++)
+    {
+        at[i] = i;
+        where[i] = i;
+    }
+
+    int swap_cnt = 0;
+    for (int k = 0; k < node_num; k++)
+    {
+        int p = where[order[k]];
+        if (p == k)
+            continue;
+
+        mutable_graph->mutable_node()->SwapElements(k, p);
+
+        int displaced = at[k];
+        at[k] = order[k];
+        at[p] = displaced;
+        where[order[k]] = k;
+        where[displaced] = p;
+        swap_cnt++;
+    }
+
+    if (swap_cnt)
+        fprintf(stderr, "topological sort moved %d nodes\n", swap_cnt);
+
+    return 0;
+}
+
+// Gemm / MatMul written as InnerProduct or Conv written as Convolution / ConvolutionDepthWise - Relu / LeakyRelu / Clip / Sigmoid
+// the activation moves into the layer epilogue as activation_type and activation_params
+static void fuse_activation(onnx::GraphProto* mutable_graph, const std::map<std::string, const onnx::TensorProto*>& weights, std::map<std::string, int>& node_reference, std::set<std::string>& blob_names, int& reduced_node_count)
+{
+    int node_count = mutable_graph->node_size();
+    for (int i = 0; i + 1 < node_count; i++)
+    {
+        onnx::NodeProto* node = mutable_graph->mutable_node(i);
+
+        bool is_innerproduct = false;
+        if (node->op_type() == "Gemm")
+        {
+            float alpha = get_node_attr_f(*node, "alpha", 1.f);
+            float beta = get_node_attr_f(*node, "beta", 1.f);
+            int transA = get_node_attr_i(*node, "transA", 0);
+            int transB = get_node_attr_i(*node, "transB", 0);
+            is_innerproduct = alpha == 1.f && beta == 1.f && transA == 0 && transB == 1;
+        }
+        if (node->op_type() == "MatMul")
+        {
+            is_innerproduct = weights.find(node->input(1)) != weights.end() && get_weight(weights, node->input(1)).dims_size() == 2;
+        }
+
+        bool is_convolution = false;
+        if (node->op_type() == "Conv")
+        {
+            is_convolution = get_node_attr_ai(*node, "kernel_shape").size() == 2;
+        }
+
+        if (!is_innerproduct && !is_convolution)
+            continue;
+
+        // the activation must be the only consumer
+        if (node_reference[node->output(0)] != 1)
+            continue;
+
+        onnx::NodeProto* node2 = mutable_graph->mutable_node(i + 1);
+        if (node2->input_size() == 0 || node2->input(0) != node->output(0))
+            continue;
+
+        int activation_type = 0;
+        std::vector<float> activation_params;
+        if (node2->op_type() == "Relu")
+        {
+            activation_type = 1;
+        }
+        else if (node2->op_type() == "LeakyRelu")
+        {
+            activation_type = 2;
+            activation_params.push_back(get_node_attr_f(*node2, "alpha", 0.01f));
+        }
+        else if (node2->op_type() == "Clip")
+        {
+            float min = -FLT_MAX;
+            float max = FLT_MAX;
+            if (node2->input_size() == 1)
+            {
+                min = get_node_attr_f(*node2, "min", -FLT_MAX);
+                max = get_node_attr_f(*node2, "max", FLT_MAX);
+            }
+            else
+            {
+                // bounds given as inputs must be constant
+                bool min_const = node2->input(1).empty() || weights.find(node2->input(1)) != weights.end();
+                bool max_const = node2->input_size() < 3 || node2->input(2).empty() || weights.find(node2->input(2)) != weights.end();
+                if (!min_const || !max_const)
+                    continue;
+
+                if (!node2->input(1).empty())
+                    min = get_node_attr_from_input_f(get_weight(weights, node2->input(1)));
+                if (node2->input_size() == 3 && !node2->input(2).empty())
+                    max = get_node_attr_from_input_f(get_weight(weights, node2->input(2)));
+
+                for (int j = 1; j < node2->input_size(); j++)
+                {
+                    if (!node2->input(j).empty())
+                        node_reference[node2->input(j)] -= 1;
+                }
+            }
+
+            activation_type = 3;
+            activation_params.push_back(min);
+            activation_params.push_back(max);
+        }
+        else if (node2->op_type() == "Sigmoid")
+        {
+            activation_type = 4;
+        }
+        else
+        {
+            continue;
+        }
+
+        node2->set_op_type("noop_reduced");
+
+        node_reference[node->output(0)] -= 1;
+        blob_names.erase(node->output(0));
+        node->set_output(0, node2->output(0));
+
+        onnx::AttributeProto* attr_type = node->add_attribute();
+        attr_type->set_name("activation_type");
+        attr_type->set_i(activation_type);
+
+        onnx::AttributeProto* attr_params = node->add_attribute();
+        attr_params->set_name("activation_params");
+        for (size_t j = 0; j < activation_params.size(); j++)
+        {
+            attr_params->add_floats(activation_params[j]);
+        }
+
+        reduced_node_count += 1;
+        i += 1;
+    }
+}
+
+// fused activation of innerproduct and convolution, 9=activation_type -23310=activation_params
+static std::string activation_attributes(const onnx::NodeProto& node)
+{
+    std::string attributes;
+
+    int activation_type = get_node_attr_i(node, "activation_type", 0);
+    if (activation_type == 0)
+        return attributes;
+
+    attributes += " 9=" + std::to_string(activation_type);
+
+    std::vector<float> activation_params = get_node_attr_af(node, "activation_params");
+    if (!activation_params.empty())
+    {
+        attributes += " -23310=" + std::to_string(activation_params.size());
+        for (size_t j = 0; j < activation_params.size(); j++)
+        {
+            // %e keeps +-FLT_MAX short enough for the param reader
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%e", activation_params[j]);
+            attributes += std::string(",") + buf;
+        }
+    }
+
+    return attributes;
+}
+
+// index of the first node from begin on that reads blob, -1 if there is none
+static int find_consumer(const onnx::GraphProto& graph, const std::string& blob, int begin)
+{
+    for (int i = begin; i < graph.node_size(); i++)
+    {
+        const onnx::NodeProto& node = graph.node(i);
+        for (int j = 0; j < node.input_size(); j++)
+        {
+            if (node.input(j) == blob)
+                return i;
+        }
+    }
+
+    return -1;
+}
+
+// the other operand of a two input node reading blob, empty if blob is not an operand
+static std::string other_input(const onnx::NodeProto& node, const std::string& blob)
+{
+    if (node.input_size() != 2)
+        return std::string();
+    if (node.input(0) == blob)
+        return node.input(1);
+    if (node.input(1) == blob)
+        return node.input(0);
+    return std::string();
+}
+
+// a float constant with a single element
+static bool is_scalar_weight(const std::map<std::string, const onnx::TensorProto*>& weights, const std::string& name)
+{
+    if (weights.find(name) == weights.end())
+        return false;
+
+    const onnx::TensorProto& tp = get_weight(weights, name);
+    return tp.data_type() == 1 && get_tensor_proto_data_size(tp) == 1;
+}
+
+// a float constant with more than one element along a single axis, the per element scale or bias of a normalization
+static bool is_vector_weight(const std::map<std::string, const onnx::TensorProto*>& weights, const std::string& name)
+{
+    if (weights.find(name) == weights.end())
+        return false;
+
+    const onnx::TensorProto& tp = get_weight(weights, name);
+    if (tp.data_type() != 1 || get_tensor_proto_data_size(tp) < 2)
+        return false;
+
+    int axes = 0;
+    for (int i = 0; i < tp.dims_size(); i++)
+    {
+        if (tp.dims(i) != 1)
+            axes++;
+    }
+    return axes == 1;
+}
+
+// every element of a float constant equals v
+static bool is_constant_fill(const onnx::TensorProto& tp, float v)
+{
+    const int size = get_tensor_proto_data_size(tp);
+    const float* data = get_tensor_proto_float_data(tp);
+    for (int i = 0; i < size; i++)
+    {
+        if (data[i] != v)
+            return false;
+    }
+    return true;
+}
+
+// ReduceMean over the last axis keeping it, the axes are an input since opset 18
+static bool is_last_axis_mean(const onnx::NodeProto& node, const std::map<std::string, const onnx::TensorProto*>& weights)
+{
+    if (node.op_type() != "ReduceMean" || get_node_attr_i(node, "keepdims", 1) != 1)
+        return false;
+
+    std::vector<int> axes = get_node_attr_ai(node, "axes");
+    if (node.input_size() > 1 && weights.find(node.input(1)) != weights.end())
+        axes = get_node_attr_from_input_ai(get_weight(weights, node.input(1)));
+
+    return axes.size() == 1 && axes[0] == -1;
+}
+
+// the last of nodes becomes op_type over inputs, the other nodes are reduced
+// it comes after every producer of the chain, so the fused layer still follows its inputs
+// references of the old inputs are dropped and those of the new inputs added, the intermediate blobs disappear
+static onnx::NodeProto* fuse_nodes(onnx::GraphProto* mutable_graph, const std::vector<int>& nodes, const char* op_type, const std::vector<std::string>& inputs, std::map<std::string, int>& node_reference, std::set<std::string>& blob_names, int& reduced_node_count)
+{
+    for (size_t k = 0; k < nodes.size(); k++)
+    {
+        onnx::NodeProto* node = mutable_graph->mutable_node(nodes[k]);
+        for (int j = 0; j < node->input_size(); j++)
+        {
+            node_reference[node->input(j)] -= 1;
+        }
+
+        if (k + 1 < nodes.size())
+        {
+            blob_names.erase(node->output(0));
+            node->set_op_type("noop_reduced");
+            reduced_node_count += 1;
+        }
+    }
+
+    onnx::NodeProto* node = mutable_graph->mutable_node(nodes.back());
+    node->set_op_type(op_type);
+    node->clear_attribute();
+    node->clear_input();
+    for (size_t j = 0; j < inputs.size(); j++)
+    {
+        node->add_input(inputs[j]);
+        if (!inputs[j].empty())
+            node_reference[inputs[j]] += 1;
+    }
+
+    return node;
+}
+
+// ReduceMean - Sub - Pow - ReduceMean - Add - Sqrt - Div [- Mul] [- Add] over the last axis
+// the layer normalization of exports before opset 17, written as LayerNormalization
+static void fuse_layernorm(onnx::GraphProto* mutable_graph, const std::map<std::string, const onnx::TensorProto*>& weights, std::map<std::string, int>& node_reference, std::set<std::string>& blob_names, int& reduced_node_count)
+{
+    const onnx::GraphProto& graph = *mutable_graph;
+
+    for (int i = 0; i < graph.node_size(); i++)
+    {
+        const onnx::NodeProto& mean = graph.node(i);
+        if (!is_last_axis_mean(mean, weights) || node_reference[mean.output(0)] != 1)
+            continue;
+
+        const std::string& x = mean.input(0);
+
+        // x - mean
+        const int isub = find_consumer(graph, mean.output(0), i + 1);
+        if (isub < 0)
+            continue;
+        const onnx::NodeProto& sub = graph.node(isub);
+        if (sub.op_type() != "Sub" || sub.input_size() != 2 || sub.input(0) != x || sub.input(1) != mean.output(0))
+            continue;
+        const std::string& d = sub.output(0);
+
+        // squared as Pow(d, 2) or Mul(d, d), the deviation is read once more by the Div
+        const int ipow = find_consumer(graph, d, isub + 1);
+        if (ipow < 0)
+            continue;
+        const onnx::NodeProto& pow = graph.node(ipow);
+        const bool is_pow = pow.op_type() == "Pow" && pow.input_size() == 2 && pow.input(0) == d && is_scalar_weight(weights, pow.input(1)) && get_node_attr_from_input_f(get_weight(weights, pow.input(1))) == 2.f;
+        const bool is_mul = pow.op_type() == "Mul" && pow.input_size() == 2 && pow.input(0) == d && pow.input(1) == d;
+        if (!(is_pow || is_mul) || node_reference[d] != (is_pow ? 2 : 3) || node_reference[pow.output(0)] != 1)
+            continue;
+
+        const int ivar = find_consumer(graph, pow.output(0), ipow + 1);
+        if (ivar < 0)
+            continue;
+        const onnx::NodeProto& var = graph.node(ivar);
+        if (!is_last_axis_mean(var, weights) || var.input(0) != pow.output(0) || node_reference[var.output(0)] != 1)
+            continue;
+
+        const int iadd = find_consumer(graph, var.output(0), ivar + 1);
+        if (iadd < 0)
+            continue;
+        const onnx::NodeProto& add = graph.node(iadd);
+        const std::string eps = other_input(add, var.output(0));
+        if (add.op_type() != "Add" || !is_scalar_weight(weights, eps) || node_reference[add.output(0)] != 1)
+            continue;
+
+        const int isqrt = find_consumer(graph, add.output(0), iadd + 1);
+        if (isqrt < 0)
+            continue;
+        const onnx::NodeProto& sqrt = graph.node(isqrt);
+        if (sqrt.op_type() != "Sqrt" || node_reference[sqrt.output(0)] != 1)
+            continue;
+
+        const int idiv = find_consumer(graph, sqrt.output(0), isqrt + 1);
+        if (idiv < 0)
+            continue;
+        const onnx::NodeProto& div = graph.node(idiv);
+        if (div.op_type() != "Div" || div.input_size() != 2 || div.input(0) != d || div.input(1) != sqrt.output(0))
+            continue;
+
+        std::vector<int> nodes;
+        nodes.push_back(i);
+        nodes.push_back(isub);
+        nodes.push_back(ipow);
+        nodes.push_back(ivar);
+        nodes.push_back(iadd);
+        nodes.push_back(isqrt);
+        nodes.push_back(idiv);
+
+        // the affine, Mul by gamma and Add of beta along the normalized axis
+        std::string gamma;
+        std::string beta;
+        std::string output = div.output(0);
+        if (node_reference[output] == 1)
+        {
+            const int imul = find_consumer(graph, output, idiv + 1);
+            const std::string w = imul < 0 ? std::string() : other_input(graph.node(imul), output);
+            if (imul >= 0 && graph.node(imul).op_type() == "Mul" && is_vector_weight(weights, w))
+            {
+                gamma = w;
+                nodes.push_back(imul);
+                output = graph.node(imul).output(0);
+            }
+        }
+        if (node_reference[output] == 1)
+        {
+            const int ibias = find_consumer(graph, output, nodes.back() + 1);
+            const std::string w = ibias < 0 ? std::string() : other_input(graph.node(ibias), output);
+            const bool same_size = gamma.empty() || get_tensor_proto_data_size(get_weight(weights, gamma)) == get_tensor_proto_data_size(get_weight(weights, w));
+            if (ibias >= 0 && graph.node(ibias).op_type() == "Add" && is_vector_weight(weights, w) && same_size)
+            {
+                beta = w;
+                nodes.push_back(ibias);
+            }
+        }
+
+        const float epsilon = get_node_attr_from_input_f(get_weight(weights, eps));
+
+        std::vector<std::string> inputs;
+        inputs.push_back(x);
+        inputs.push_back(gamma);
+        inputs.push_back(beta);
+        onnx::NodeProto* node = fuse_nodes(mutable_graph, nodes, "LayerNormalization", inputs, node_reference, blob_names, reduced_node_count);
+
+        onnx::AttributeProto* attr_epsilon = node->add_attribute();
+        attr_epsilon->set_name("epsilon");
+        attr_epsilon->set_f(epsilon);
+    }
+}
+
+// Reshape to (n, group, -1) - InstanceNormalization - Reshape back - Mul [- Add]
+// the group normalization of torch exports, written as GroupNormalization with per channel scale and bias
+static void fuse_groupnorm(onnx::GraphProto* mutable_graph, const std::map<std::string, const onnx::TensorProto*>& weights, std::map<std::string, int>& node_reference, std::set<std::string>& blob_names, int& reduced_node_count)
+{
+    const onnx::GraphProto& graph = *mutable_graph;
+
+    for (int i = 0; i < graph.node_size(); i++)
+    {
+        const onnx::NodeProto& reshape = graph.node(i);
+        if (reshape.op_type() != "Reshape" || reshape.input_size() != 2 || weights.find(reshape.input(1)) == weights.end() || node_reference[reshape.output(0)] != 1)
+            continue;
+
+        const std::string& x = reshape.input(0);
+        const std::vector<int> shape = get_node_attr_from_input_ai(get_weight(weights, reshape.input(1)));
+        if (shape.size() != 3 || shape[1] <= 0 || shape[2] != -1)
+            continue;
+        const int group = shape[1];
+
+        // the statistics, without an affine of its own
+        const int iin = find_consumer(graph, reshape.output(0), i + 1);
+        if (iin < 0)
+            continue;
+        const onnx::NodeProto& in = graph.node(iin);
+        if (in.op_type() != "InstanceNormalization" || in.input_size() != 3 || node_reference[in.output(0)] != 1)
+            continue;
+        const onnx::TensorProto& in_scale = get_weight(weights, in.input(1));
+        const onnx::TensorProto& in_bias = get_weight(weights, in.input(2));
+        if (get_tensor_proto_data_size(in_scale) != group || !is_constant_fill(in_scale, 1.f) || !is_constant_fill(in_bias, 0.f))
+            continue;
+
+        // back to the shape of x, from a constant or from Shape(x)
+        const int iback = find_consumer(graph, in.output(0), iin + 1);
+        if (iback < 0)
+            continue;
+        const onnx::NodeProto& back = graph.node(iback);
+        if (back.op_type() != "Reshape" || back.input_size() != 2 || back.input(0) != in.output(0) || node_reference[back.output(0)] != 1)
+            continue;
+
+        int ishape = -1;
+        if (weights.find(back.input(1)) == weights.end())
+        {
+            for (int j = 0; j < iback; j++)
+            {
+                const onnx::NodeProto& node = graph.node(j);
+                if (node.op_type() == "Shape" && node.input_size() == 1 && node.input(0) == x && node.output(0) == back.input(1))
+                    ishape = j;
+            }
+            if (ishape < 0 || node_reference[back.input(1)] != 1)
+                continue;
+        }
+
+        // the per channel affine carries the channel count
+        const int imul = find_consumer(graph, back.output(0), iback + 1);
+        if (imul < 0)
+            continue;
+        const onnx::NodeProto& mul = graph.node(imul);
+        const std::string gamma = other_input(mul, back.output(0));
+        if (mul.op_type() != "Mul" || !is_vector_weight(weights, gamma))
+            continue;
+        const int channels = get_tensor_proto_data_size(get_weight(weights, gamma));
+        if (channels % group != 0)
+            continue;
+
+        std::vector<int> nodes;
+        nodes.push_back(i);
+        nodes.push_back(iin);
+        if (ishape >= 0)
+            nodes.push_back(ishape);
+        nodes.push_back(iback);
+        nodes.push_back(imul);
+
+        std::string beta;
+        if (node_reference[mul.output(0)] == 1)
+        {
+            const int ibias = find_consumer(graph, mul.output(0), imul + 1);
+            const std::string w = ibias < 0 ? std::string() : other_input(graph.node(ibias), mul.output(0));
+            if (ibias >= 0 && graph.node(ibias).op_type() == "Add" && is_vector_weight(weights, w) && get_tensor_proto_data_size(get_weight(weights, w)) == channels)
+            {
+                beta = w;
+                nodes.push_back(ibias);
+            }
+        }
+
+        const float epsilon = get_node_attr_f(in, "epsilon", 1e-5f);
+
+        std::vector<std::string> inputs;
+        inputs.push_back(x);
+        inputs.push_back(gamma);
+        inputs.push_back(beta);
+        onnx::NodeProto* node = fuse_nodes(mutable_graph, nodes, "GroupNormalization", inputs, node_reference, blob_names, reduced_node_count);
+        onnx::AttributeProto* attr_groups = node->add_attribute();
+        attr_groups->set_name("num_groups");
+        attr_groups->set_i(group);
+        onnx::AttributeProto* attr_epsilon = node->add_attribute();
+        attr_epsilon->set_name("epsilon");
+        attr_epsilon->set_f(epsilon);
+    }
+}
+
+// index of the node before end producing blob, -1 for graph inputs and weights
+static int find_producer(const onnx::GraphProto& graph, const std::string& blob, int end)
+{
+    for (int i = end - 1; i >= 0; i--)
+    {
+        const onnx::NodeProto& node = graph.node(i);
+        if (node.output_size() > 0 && node.output(0) == blob)
+            return i;
+    }
+
+    return -1;
+}
+
+static bool is_transpose(const onnx::NodeProto& node, int p0, int p1, int p2, int p3)
+{
+    if (node.op_type() != "Transpose")
+        return false;
+
+    const std::vector<int> perm = get_node_attr_ai(node, "perm");
+    return perm.size() == 4 && perm[0] == p0 && perm[1] == p1 && perm[2] == p2 && perm[3] == p3;
+}
+
+// blob = Transpose(Reshape(x, [n, seq, heads, head_dim])) with the given perm
+// the head split of a projection whose heads sit side by side in every row, the nodes are appended
+static bool match_split_heads(const onnx::GraphProto& graph, const std::map<std::string, const onnx::TensorProto*>& weights, std::map<std::string, int>& node_reference, const std::string& blob, int end, int p1, int p2, int p3, std::vector<int>& nodes, std::string& x, int& heads, int& head_dim)
+{
+    const int itranspose = find_producer(graph, blob, end);
+    if (itranspose < 0 || !is_transpose(graph.node(itranspose), 0, p1, p2, p3) || node_reference[blob] != 1)
+        return false;
+
+    const std::string& split = graph.node(itranspose).input(0);
+    const int ireshape = find_producer(graph, split, itranspose);
+    if (ireshape < 0 || node_reference[split] != 1)
+        return false;
+
+    const onnx::NodeProto& reshape = graph.node(ireshape);
+    if (reshape.op_type() != "Reshape" || reshape.input_size() != 2 || weights.find(reshape.input(1)) == weights.end())
+        return false;
+
+    const std::vector<int> shape = get_node_attr_from_input_ai(get_weight(weights, reshape.input(1)));
+    if (shape.size() != 4 || shape[2] <= 0 || shape[3] <= 0)
+        return false;
+
+    nodes.push_back(ireshape);
+    nodes.push_back(itranspose);
+    x = reshape.input(0);
+    heads = shape[2];
+    head_dim = shape[3];
+    return true;
+}
+
+// a Mul or Div of blob by a float scalar, the factor it applies
+static bool match_scalar_scale(const onnx::NodeProto& node, const std::map<std::string, const onnx::TensorProto*>& weights, std::string& blob, float& factor)
+{
+    if (node.input_size() != 2 || (node.op_type() != "Mul" && node.op_type() != "Div"))
+        return false;
+
+    const bool second = is_scalar_weight(weights, node.input(1));
+    if (!second && (node.op_type() == "Div" || !is_scalar_weight(weights, node.input(0))))
+        return false;
+
+    const float c = get_node_attr_from_input_f(get_weight(weights, node.input(second ? 1 : 0)));
+    if (c == 0.f)
+        return false;
+
+    blob = node.input(second ? 0 : 1);
+    factor = node.op_type() == "Mul" ? c : 1.f / c;
+    return true;
+}
+
+// MatMul(q, k^T) [* scale] [+ mask] - Softmax - MatMul(p, v), the scaled dot product attention of transformer exports
+// the scale is taken from the scores or from q and k^T, as the torch export writes it
+// when q, k and v are head splits of row projections and the output is merged back the same way
+// the layer reads the projections with their heads side by side and the Transpose and Reshape nodes go away
+// otherwise it takes the per head blobs
+static void fuse_attention(onnx::GraphProto* mutable_graph, const std::map<std::string, const onnx::TensorProto*>& weights, std::map<std::string, int>& node_reference, std::set<std::string>& blob_names, int& reduced_node_count, int opset)
+{
+    const onnx::GraphProto& graph = *mutable_graph;
+
+    for (int i = 0; i < graph.node_size(); i++)
+    {
+        const onnx::NodeProto& softmax = graph.node(i);
+        if (softmax.op_type() != "Softmax" || node_reference[softmax.input(0)] != 1 || node_reference[softmax.output(0)] != 1)
+            continue;
+
+        const int axis = get_node_attr_i(softmax, "axis", opset >= 13 ? -1 : 1);
+        if (axis != -1 && axis != 3)
+            continue;
+
+        std::vector<int> nodes;
+        nodes.push_back(i);
+
+        float scale = 1.f;
+        std::string mask;
+
+        // back from the scores through the mask and the scale to q k^T
+        std::string scores = softmax.input(0);
+        int iscores = find_producer(graph, scores, i);
+        if (iscores >= 0 && graph.node(iscores).op_type() == "Add" && graph.node(iscores).input_size() == 2)
+        {
+            const onnx::NodeProto& add = graph.node(iscores);
+            const int i0 = find_producer(graph, add.input(0), iscores);
+            const bool first = i0 >= 0 && (graph.node(i0).op_type() == "MatMul" || graph.node(i0).op_type() == "Mul" || graph.node(i0).op_type() == "Div");
+            mask = add.input(first ? 1 : 0);
+            scores = add.input(first ? 0 : 1);
+            if (node_reference[scores] != 1 || is_scalar_weight(weights, mask))
+                continue;
+
+            nodes.push_back(iscores);
+            iscores = find_producer(graph, scores, iscores);
+        }
+        if (iscores >= 0)
+        {
+            std::string blob;
+            float factor;
+            if (match_scalar_scale(graph.node(iscores), weights, blob, factor))
+            {
+                if (node_reference[blob] != 1)
+                    continue;
+
+                scale *= factor;
+                nodes.push_back(iscores);
+                scores = blob;
+                iscores = find_producer(graph, scores, iscores);
+            }
+        }
+        if (iscores < 0 || graph.node(iscores).op_type() != "MatMul")
+            continue;
+
+        const int iqk = iscores;
+        nodes.push_back(iqk);
+
+        std::string q = graph.node(iqk).input(0);
+        std::string kt = graph.node(iqk).input(1);
+        bool scaled_operands = true;
+        for (int j = 0; j < 2; j++)
+        {
+            std::string& operand = j == 0 ? q : kt;
+            const int iscale = find_producer(graph, operand, iqk);
+
+            std::string blob;
+            float factor;
+            if (iscale >= 0 && match_scalar_scale(graph.node(iscale), weights, blob, factor))
+            {
+                if (node_reference[operand] != 1)
+                    scaled_operands = false;
+
+                scale *= factor;
+                nodes.push_back(iscale);
+                operand = blob;
+            }
+        }
+        if (!scaled_operands)
+            continue;
+
+        // k^T as a swap of the last two axes of the per head keys or straight from the projection
+        const int ikt = find_producer(graph, kt, iqk);
+        if (ikt < 0 || node_reference[kt] != 1)
+            continue;
+
+        const bool kt_of_heads = is_transpose(graph.node(ikt), 0, 1, 3, 2);
+        const bool kt_of_rows = is_transpose(graph.node(ikt), 0, 2, 3, 1);
+        if (!kt_of_heads && !kt_of_rows)
+            continue;
+
+        nodes.push_back(ikt);
+        const std::string k = graph.node(ikt).input(0);
+
+        // forward to the weighted sum of the values
+        const int ipv = find_consumer(graph, softmax.output(0), i + 1);
+        if (ipv < 0)
+            continue;
+
+        const onnx::NodeProto& pv = graph.node(ipv);
+        if (pv.op_type() != "MatMul" || pv.input(0) != softmax.output(0))
+            continue;
 
-    std::vector<int> v;
+        nodes.push_back(ipv);
+        const std::string v = pv.input(1);
+        const std::string& out = pv.output(0);
 
-    // int64
-    if (tp.data_type() == 7)
-    {
-        const int64_t* shape_data = 0;
-        if (tp.raw_data().size())
+        // the row layout around the attention
+        std::vector<int> merged_nodes;
+        std::string xq, xk, xv;
+        int q_heads = 0, q_head_dim = 0, k_heads = 0, k_head_dim = 0, v_heads = 0, v_head_dim = 0;
+        bool merged = match_split_heads(graph, weights, node_reference, q, iqk, 2, 1, 3, merged_nodes, xq, q_heads, q_head_dim)
+                      && match_split_heads(graph, weights, node_reference, v, ipv, 2, 1, 3, merged_nodes, xv, v_heads, v_head_dim);
+        if (merged && kt_of_rows)
         {
-            shape_data = (const int64_t*)tp.raw_data().data();
-            size = (int)(tp.raw_data().size() / 8);
+            // the Transpose already counted is the head split of the keys
+            nodes.erase(std::find(nodes.begin(), nodes.end(), ikt));
+            merged = match_split_heads(graph, weights, node_reference, kt, iqk, 2, 3, 1, merged_nodes, xk, k_heads, k_head_dim);
         }
-        else
+        else if (merged)
         {
-            shape_data = tp.int64_data().data();
-            size = tp.int64_data_size();
+            merged = match_split_heads(graph, weights, node_reference, k, ikt, 2, 1, 3, merged_nodes, xk, k_heads, k_head_dim);
         }
-        for (int j = 0; j < size; j++)
+
+        merged = merged && q_head_dim == k_head_dim && k_heads == v_heads && q_heads % k_heads == 0;
+
+        int imerge = -1;
+        if (merged && node_reference[out] == 1)
         {
-            int vi = std::max(std::min(shape_data[j], (::google::protobuf::int64)INT_MAX), (::google::protobuf::int64)INT_MIN);
-            v.push_back(vi);
+            const int itranspose = find_consumer(graph, out, ipv + 1);
+            if (itranspose >= 0 && is_transpose(graph.node(itranspose), 0, 2, 1, 3) && node_reference[graph.node(itranspose).output(0)] == 1)
+            {
+                const std::string& t = graph.node(itranspose).output(0);
+                const int ireshape = find_consumer(graph, t, itranspose + 1);
+                if (ireshape >= 0 && graph.node(ireshape).op_type() == "Reshape" && graph.node(ireshape).input_size() == 2 && weights.find(graph.node(ireshape).input(1)) != weights.end())
+                {
+                    const std::vector<int> shape = get_node_attr_from_input_ai(get_weight(weights, graph.node(ireshape).input(1)));
+                    if (shape.size() == 3 && (shape[2] == -1 || shape[2] == q_heads * v_head_dim))
+                    {
+                        merged_nodes.push_back(itranspose);
+                        merged_nodes.push_back(ireshape);
+                        imerge = ireshape;
+                    }
+                }
+            }
         }
-    }
-    // int32
-    else if (tp.data_type() == 6)
-    {
-        const int32_t* shape_data = 0;
-        if (tp.raw_data().size())
+
+        std::vector<std::string> inputs;
+        if (imerge >= 0)
         {
-            shape_data = (const int32_t*)tp.raw_data().data();
-            size = (int)(tp.raw_data().size() / 4);
+            nodes.insert(nodes.end(), merged_nodes.begin(), merged_nodes.end());
+            inputs.push_back(xq);
+            inputs.push_back(xk);
+            inputs.push_back(xv);
         }
         else
         {
-            shape_data = tp.int32_data().data();
-            size = tp.int32_data_size();
-        }
-        for (int j = 0; j < size; j++)
-        {
-            v.push_back(shape_data[j]);
+            // k^T straight from the projection has no per head keys to read
+            if (kt_of_rows)
+                continue;
+
+            q_heads = 1;
+            inputs.push_back(q);
+            inputs.push_back(k);
+            inputs.push_back(v);
         }
-    }
-    else
-    {
-        fprintf(stderr, "Unknown data type %d\n", tp.data_type());
-    }
+        if (!mask.empty())
+            inputs.push_back(mask);
 
-    return v;
-}
+        std::sort(nodes.begin(), nodes.end());
 
-static int get_tensor_proto_data_size(const onnx::TensorProto& tp)
-{
-    if (tp.raw_data().size() > 0)
-    {
-        const std::string& raw_data = tp.raw_data();
-        int size = (int)raw_data.size() / 4;
-        return size;
-    }
-    else if (tp.data_type() == 1)
-    {
-        return tp.float_data_size();
+        onnx::NodeProto* node = fuse_nodes(mutable_graph, nodes, "MultiHeadAttention", inputs, node_reference, blob_names, reduced_node_count);
+
+        onnx::AttributeProto* attr_heads = node->add_attribute();
+        attr_heads->set_name("num_heads");
+        attr_heads->set_i(q_heads);
+        onnx::AttributeProto* attr_scale = node->add_attribute();
+        attr_scale->set_name("scale");
+        attr_scale->set_f(scale);
     }
-    return 0;
 }
 
-static bool read_onnx_model(const char* filepath, onnx::ModelProto& message)
+// the channel count of a blob from the shapes the graph declares, 0 if it is not known
+static int get_blob_channels(const onnx::GraphProto& graph, const std::string& name)
 {
-    std::ifstream ifs(filepath, std::ifstream::in | std::ifstream::binary);
-    
-    if (!ifs.is_open())
-    {
-        fprintf(stderr, "Open failed %s\n", filepath);
-        return false;
-    }
-    
-    if (!message.ParseFromIstream(&ifs))
+    for (int k = 0; k < 2; k++)
     {
-        fprintf(stderr, "Failed to parse onnx model.%s\n", filepath);
-        return false;
+        const int count = k == 0 ? graph.input_size() : graph.value_info_size();
+        for (int i = 0; i < count; i++)
+        {
+            const onnx::ValueInfoProto& info = k == 0 ? graph.input(i) : graph.value_info(i);
+            if (info.name() != name || !info.type().has_tensor_type())
+                continue;
+
+            const onnx::TensorShapeProto& shape = info.type().tensor_type().shape();
+            if (shape.dim_size() >= 2 && shape.dim(1).has_dim_value())
+                return (int)shape.dim(1).dim_value();
+        }
     }
 
-    return true;
+    return 0;
 }
 
-static void ofstream_tensor_proto_data(const onnx::TensorProto& tp, std::ofstream& ofs)
+// the affine of a normalization as raw floats, every element repeated repeat times
+// an absent scale or bias is written as fill
+static void ofstream_affine_data(const onnx::TensorProto& tp, int size, int repeat, float fill, std::ofstream& ofs)
 {
-    int size = get_tensor_proto_data_size(tp);
-
-    if (tp.raw_data().size() > 0)
-    {
-        const std::string& raw_data = tp.raw_data();
-        ofs.write(raw_data.data(), size);
-    }else if (tp.data_type() == 1)
+    const float* data = get_tensor_proto_data_size(tp) == size ? get_tensor_proto_float_data(tp) : 0;
+    for (int i = 0; i < size; i++)
     {
-        ofs.write((const char*)tp.float_data().data(), size);
+        const float v = data ? data[i] : fill;
+        for (int j = 0; j < repeat; j++)
+        {
+            ofs.write((const char*)&v, sizeof(float));
+        }
     }
 }
 
+// %e keeps small epsilons like 1e-12 that std::to_string rounds to zero
+static std::string float_attribute(float v)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%e", v);
+    return buf;
+}
 
 int main(int argc, char** argv)
 {
-    if (!(argc == 2 || argc ==4))
+    // --fp16 stores convolution and innerproduct weights as float16
+    bool fp16 = false;
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--fp16")
+            fp16 = true;
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (!(args.size() == 1 || args.size() == 3))
     {
-        fprintf(stderr, "Usage: %s [onnxpb] [param] [bin]\n", argv[0]);
+        fprintf(stderr, "Usage: %s [onnxpb] [param] [bin] [--fp16]\n", argv[0]);
         return -1;
     }
 
-    const char* onnxpb = argv[1];
-    const char* tinyinfer_prorotxt = argc == 2 ? "tinyinfer.param" : argv[2];
-    const char* tinyinfer_modelbin = argc == 2 ? "tinyinfer.bin" : argv[3];
+    const char* onnxpb = args[0];
+    const char* tinyinfer_prorotxt = args.size() == 1 ? "tinyinfer.param" : args[1];
+    const char* tinyinfer_modelbin = args.size() == 1 ? "tinyinfer.bin" : args[2];
 
     onnx::ModelProto model;
     bool s1 = read_onnx_model(onnxpb, model);
@@ -272,6 +1561,21 @@ int main(int argc, char** argv)
         return -1;
     }
 
+    // version of the default onnx domain, a few attribute defaults depend on it
+    int opset = 0;
+    for (int i = 0; i < model.opset_import_size(); i++)
+    {
+        const onnx::OperatorSetIdProto& opset_import = model.opset_import(i);
+        if (opset_import.domain().empty() || opset_import.domain() == "ai.onnx")
+            opset = (int)opset_import.version();
+    }
+
+    if (check_external_data(model.graph()) != 0)
+    {
+        fprintf(stderr, "read external data failed\n");
+        return -1;
+    }
+
     std::ofstream pofs(tinyinfer_prorotxt, std::fstream::out);
     std::ofstream bofs(tinyinfer_modelbin, std::fstream::out | std::fstream::binary);
 
@@ -282,96 +1586,20 @@ int main(int argc, char** argv)
     int node_num = graph.node_size();
 
     std::map<std::string, int> node_reference_cnt;
-    std::map<std::string, onnx::TensorProto> weights;
+
+    // weights reference initializers and constant node tensors in place,
+    // model must outlive them and must not be modified after they are collected
+    std::map<std::string, const onnx::TensorProto*> weights;
 
     for (int i = 0; i < graph.initializer_size(); i++)
     {
         const onnx::TensorProto& initializer = graph.initializer(i);
         // fprintf(stderr, "weight = %s %d\n", initializer.name().c_str(), initializer.data_type());
-        weights[initializer.name()] = initializer;
+        weights[initializer.name()] = &initializer;
     }
 
-    {
-        // topological order
-        std::set<std::string> producers;
-        for (int i = 0; i < graph.input_size(); i++)
-        {
-            const std::string& input_name = graph.input(i).name();
-            producers.insert(input_name);
-        }
-
-        for (int i = 0; i < node_num;)
-        {
-            onnx::NodeProto* node = mutable_graph->mutable_node(i);
-            
-            // swapnode: the input of this node comes form its subsequent node
-            bool swapnode = false; 
-            std::string missing_input_name;
-            for (int j = 0; j < (int)node->input_size(); j++)
-            {
-                const std::string& input_name = node->input(j);
-                if (input_name.empty())
-                    continue;
-                
-                if (producers.find(input_name) == producers.end() && weights.find(input_name) == weights.end())
-                {
-                    swapnode = true;
-                    missing_input_name = input_name;
-                    break;
-                }
-            }
-
-            // if the node is not swapnode, insert it into producers, then judge the next node
-            if (!swapnode)
-            {
-                for (int j = 0; j < (int)node->output_size(); j++)
-                {
-                    const std::string& output_name = node->output(j);
-                    if (output_name.empty())
-                        continue;
-                    
-                    producers.insert(output_name);
-                }
-                
-                i++;
-                continue;
-            }
-
-            // find node that produces missing_input_name
-            int q = i + 1;
-            for (; q < node_num; q++)
-            {
-                onnx::NodeProto* nodeq = mutable_graph->mutable_node(q);
-                bool found = false;
-                for (int k = 0; k < (int)nodeq->output_size(); k++)
-                {
-                    const std::string& output_name = nodeq->output(k);
-                    if (output_name == missing_input_name)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-                
-                if (found)
-                    break;
-            }
-
-            // fail to find node that produces missing_input_name 
-            if (q == node_num)
-            {
-                fprintf(stderr, "cannot find node produces %s but node %d requires it\n", missing_input_name.c_str(), i);
-                return -1;
-            }
-
-            // succeed, swap the pair of nodes
-            fprintf(stderr, "swap node %d %d", i, q);
-            onnx::NodeProto* nodeq = mutable_graph->mutable_node(q);
-            onnx::NodeProto tmp = *node;
-            *node = *nodeq;
-            *nodeq = tmp;
-        }
-    }
+    if (topological_sort(mutable_graph, weights) != 0)
+        return -1;
 
     // collect blobs
     std::set<std::string> blob_names;
@@ -389,8 +1617,7 @@ int main(int argc, char** argv)
         // treat constant node as weight or binaryop_weights
         if(op == "Constant")
         {
-            onnx::TensorProto tensor = get_node_attr_tensor(node, "value");
-            weights[node.output(0)] = tensor;
+            weights[node.output(0)] = &get_node_attr_tensor(node, "value");
         }
 
         for (int j = 0; j < (int)node.input_size(); j++)
@@ -436,6 +1663,10 @@ int main(int argc, char** argv)
     // fprintf(stderr, "node num: %d blob num: %ld\n", node_num, blob_names.size());
     int reduced_node_cnt = 0;
     // fuse operations
+    fuse_layernorm(mutable_graph, weights, node_reference_cnt, blob_names, reduced_node_cnt);
+    fuse_groupnorm(mutable_graph, weights, node_reference_cnt, blob_names, reduced_node_cnt);
+    fuse_attention(mutable_graph, weights, node_reference_cnt, blob_names, reduced_node_cnt, opset);
+    fuse_activation(mutable_graph, weights, node_reference_cnt, blob_names, reduced_node_cnt);
 
     // reduce common const weight node_reference
     for (int i = 0; i < node_num; i++)
@@ -472,10 +1703,53 @@ int main(int argc, char** argv)
                 node_reference_cnt[node.input(2)] -= 1;
             }
         }
+        else if (op == "Reshape" || op == "Squeeze" || op == "Unsqueeze")
+        {
+            // a constant shape or axes input is folded into the params
+            if (node.input_size() > 1 && weights.find(node.input(1)) != weights.end())
+            {
+                node_reference_cnt[node.input(1)] -= 1;
+            }
+        }
+        else if (op == "Pad")
+        {
+            // constant pads and value are folded into the params
+            for (int j = 1; j < node.input_size(); j++)
+            {
+                if (weights.find(node.input(j)) != weights.end())
+                    node_reference_cnt[node.input(j)] -= 1;
+            }
+        }
+        else if (op == "GroupNormalization" || op == "InstanceNormalization" || op == "LayerNormalization")
+        {
+            // constant scale and bias are written as the affine weights
+            for (int j = 1; j < node.input_size(); j++)
+            {
+                if (weights.find(node.input(j)) != weights.end())
+                    node_reference_cnt[node.input(j)] -= 1;
+            }
+        }
+        else if (op == "Upsample" || op == "Resize")
+        {
+            // constant roi, scales and sizes are folded into the params
+            for (int j = 1; j < node.input_size(); j++)
+            {
+                if (weights.find(node.input(j)) != weights.end())
+                    node_reference_cnt[node.input(j)] -= 1;
+            }
+        }
+        else if (op == "MatMul")
+        {
+            // constant 2d B is written as InnerProduct weight
+            if (get_weight(weights, node.input(1)).dims_size() == 2)
+            {
+                node_reference_cnt[node.input(1)] -= 1;
+            }
+        }
     }
 
     int zero_inference_weight_node_cnt = 0;
-    for (std::map<std::string, onnx::TensorProto>::iterator it = weights.begin(); it != weights.end(); it++)
+    for (std::map<std::string, const onnx::TensorProto*>::iterator it = weights.begin(); it != weights.end(); it++)
     {
         const std::string& input_name = it->first;
 
@@ -519,11 +1793,12 @@ int main(int argc, char** argv)
         }
     }
 
-    int blob_num1 = node_num + input_node_cnt + splittinyinfer_blob_cnt - reduced_node_cnt \
+    int layer_num = node_num + input_node_cnt + split_layer_count - reduced_node_cnt \
                     - constant_node_count_moved_to_weight + weights.size() - zero_inference_weight_node_cnt;
-    int blob_num2 = blob_names.size() - zero_inference_weight_node_cnt + splittinyinfer_blob_cnt;
-    
-    pofs << blob_num1 << " " << blob_num2 << std::endl;
+    int blob_num = blob_names.size() - zero_inference_weight_node_cnt + splittinyinfer_blob_cnt;
+
+    // [layer count] [blob count]
+    pofs << layer_num << " " << blob_num << std::endl;
 
     int internal_split = 0;
 
@@ -555,7 +1830,7 @@ int main(int argc, char** argv)
     }
 
     // MemoryData information line
-    for (std::map<std::string, onnx::TensorProto>::iterator weight_it = weights.begin(); weight_it != weights.end(); weight_it++)
+    for (std::map<std::string, const onnx::TensorProto*>::iterator weight_it = weights.begin(); weight_it != weights.end(); weight_it++)
     {
         const std::string& input_name = weight_it->first;
 
@@ -566,7 +1841,7 @@ int main(int argc, char** argv)
         pofs << std::left << std::setw(16) << "MemoryData" << " " << std::setw(24) << input_name << " ";
         pofs << "0 1 " << input_name;
         
-        const onnx::TensorProto& M = weights[input_name];
+        const onnx::TensorProto& M = get_weight(weights, input_name);
 
         if (M.dims_size() == 0)
         {
@@ -725,22 +2000,18 @@ int main(int argc, char** argv)
                 attributes += " 12=" + std::to_string(strides[0]);
             }
 
-            // pads
-            if (pads.size() == 1)
-            {
-                attributes += " 3=" + std::to_string(strides[0]);
-            }
-            else if (pads.size() == 2)
+            // pads, onnx lists every axis begin then every axis end
+            if (pads.size() == 2)
             {
-                attributes += " 3=" + std::to_string(strides[1]);
-                attributes += " 13=" + std::to_string(strides[0]);
+                attributes += " 3=" + std::to_string(pads[0]);
+                attributes += " 14=" + std::to_string(pads[1]);
             }
             else if (pads.size() == 4)
             {
-                attributes += " 3=" + std::to_string(strides[1]);
-                attributes += " 13=" + std::to_string(strides[0]);
-                attributes += " 14=" + std::to_string(strides[3]);
-                attributes += " 15=" + std::to_string(strides[2]);
+                attributes += " 3=" + std::to_string(pads[1]);
+                attributes += " 13=" + std::to_string(pads[0]);
+                attributes += " 14=" + std::to_string(pads[3]);
+                attributes += " 15=" + std::to_string(pads[2]);
             }
 
             // auto_pad
@@ -774,10 +2045,10 @@ int main(int argc, char** argv)
             tinyinfer_op_name = "BatchNorm";
             float epsilon = get_node_attr_f(node, "epsilon", 1e-5f);
 
-            const onnx::TensorProto& scale = weights[node.input(1)];
-            const onnx::TensorProto& B = weights[node.input(2)];
-            const onnx::TensorProto& mean = weights[node.input(3)];
-            const onnx::TensorProto& var = weights[node.input(4)];
+            const onnx::TensorProto& scale = get_weight(weights, node.input(1));
+            const onnx::TensorProto& B = get_weight(weights, node.input(2));
+            const onnx::TensorProto& mean = get_weight(weights, node.input(3));
+            const onnx::TensorProto& var = get_weight(weights, node.input(4));
             int channels = get_tensor_proto_data_size(scale);
 
             attributes += "0=" + std::to_string(channels);
@@ -785,13 +2056,14 @@ int main(int argc, char** argv)
             ofstream_tensor_proto_data(scale, bofs);
             ofstream_tensor_proto_data(mean, bofs);
             {
-                const float* v = var.raw_data().size() ? (const float*)var.raw_data().data() : var.float_data().data();
+                const float* v = get_tensor_proto_float_data(var);
                 for (int j = 0; j < channels; j++)
                 {
                     float ve = v[j] + epsilon;
                     bofs.write((const char*)&ve, sizeof(float));
                 }
             }
+            ofstream_tensor_proto_data(B, bofs);
         }
         else if (op == "Clip")
         {
@@ -805,16 +2077,16 @@ int main(int argc, char** argv)
             }
             else
             {
-                min = weights.find(node.input(1)) != weights.end() ? get_node_attr_from_input_f(weights[node.input(1)]) : -FLT_MAX;
-                max = weights.find(node.input(2)) != weights.end() ? get_node_attr_from_input_f(weights[node.input(2)]) : FLT_MAX;
+                min = weights.find(node.input(1)) != weights.end() ? get_node_attr_from_input_f(get_weight(weights, node.input(1))) : -FLT_MAX;
+                max = weights.find(node.input(2)) != weights.end() ? get_node_attr_from_input_f(get_weight(weights, node.input(2))) : FLT_MAX;
             }
             attributes += "0=" + std::to_string(min);
             attributes += " 1=" + std::to_string(max);
         }
         else if (op == "Concat")
         {
-            tinyinfer_op_name = "Constant";
-            
+            tinyinfer_op_name = "Concat";
+
             int axis = get_node_attr_i(node, "axis", 1);
             attributes += "0=" + std::to_string(axis > 0 ? axis - 1 : axis);
         }
@@ -843,7 +2115,7 @@ int main(int argc, char** argv)
                 }
             }
 
-            const onnx::TensorProto& W = weights[node.input(1)];
+            const onnx::TensorProto& W = get_weight(weights, node.input(1));
 
             int num_filter = W.dims(0);
             int has_bias = node.input_size() == 3 ? 1 : 0;
@@ -927,10 +2199,12 @@ int main(int argc, char** argv)
                 attributes += " 7=" + std::to_string(group);
             }
 
-            ofstream_tensor_proto_data(W, bofs);
+            attributes += activation_attributes(node);
+
+            ofstream_tensor_proto_weight(W, fp16, bofs);
             if (has_bias)
             {
-                const onnx::TensorProto& B = weights[node.input(2)];
+                const onnx::TensorProto& B = get_weight(weights, node.input(2));
                 ofstream_tensor_proto_data(B, bofs);
             }
         }
@@ -947,7 +2221,7 @@ int main(int argc, char** argv)
                 tinyinfer_op_name = "DeConvolution";
             }
 
-            const onnx::TensorProto& W = weights[node.input(1)];
+            const onnx::TensorProto& W = get_weight(weights, node.input(1));
 
             int has_bias = node.input_size() == 3 ? 1 : 0;
 
@@ -1063,15 +2337,8 @@ int main(int argc, char** argv)
                 maxk = kernel_shape[0] * kernel_shape[0];
             }
             int weight_data_size = get_tensor_proto_data_size(W);
-            const float* weight_data = 0;
-            if (W.raw_data().size())
-            {
-                weight_data = (const float*)W.raw_data().data();
-            }
-            else if (W.data_type() == 1)
-            {
-                weight_data = W.float_data().data();
-            }
+            const float* weight_data = get_tensor_proto_float_data(W);
+            ofstream_weight_tag(fp16, bofs);
             for (int g = 0; g < group; g++)
             {
                 // reorder weight from inch-outch to outch-inch
@@ -1082,13 +2349,14 @@ int main(int argc, char** argv)
                 {
                     for (int j = 0; j < num_input; j++)
                     {
-                        bofs.write((const char*)weight_data_ptr + (j * num_filter_g + k) * maxk, weight_data_size);
+                        ofstream_weight_data(weight_data_ptr + (j * num_filter_g + k) * maxk, maxk, fp16, bofs);
                     }
                 }
             }
+            ofstream_weight_padding(weight_data_size, fp16, bofs);
             if (has_bias)
             {
-                const onnx::TensorProto& B = weights[node.input(2)];
+                const onnx::TensorProto& B = get_weight(weights, node.input(2));
                 ofstream_tensor_proto_data(B, bofs);
             }
         }
@@ -1132,8 +2400,12 @@ int main(int argc, char** argv)
         }
         else if (op == "Gelu")
         {
-            tinyinfer_op_name = "Flatten";
-            attributes += "0=1";
+            tinyinfer_op_name = "GELU";
+            std::string approximate = get_node_attr_s(node, "approximate", "none");
+            if (approximate == "tanh")
+            {
+                attributes += "0=1";
+            }
         }
         else if (op == "Gemm")
         {
@@ -1147,13 +2419,14 @@ int main(int argc, char** argv)
                 // InnerProduct-like A * B + C
                 tinyinfer_op_name = "InnerProduct";
 
-                const onnx::TensorProto& B = weights[node.input(1)];
-                const onnx::TensorProto& C = weights[node.input(2)];
+                const onnx::TensorProto& B = get_weight(weights, node.input(1));
+                const onnx::TensorProto& C = get_weight(weights, node.input(2));
                 attributes += "0=" + std::to_string(get_tensor_proto_data_size(C));
                 attributes += " 1=1";
                 attributes += " 2=" + std::to_string(get_tensor_proto_data_size(B));
+                attributes += activation_attributes(node);
 
-                ofstream_tensor_proto_data(B, bofs);
+                ofstream_tensor_proto_weight(B, fp16, bofs);
                 ofstream_tensor_proto_data(C, bofs);
             }
             else
@@ -1186,6 +2459,44 @@ int main(int argc, char** argv)
             attributes += "0=" + std::to_string(pool);
             attributes += " 4=" + std::to_string(global_pool);
         }
+        else if (op == "GroupNormalization")
+        {
+            // https://github.com/onnx/onnx/blob/main/docs/Operators.md#GroupNormalization
+            tinyinfer_op_name = "GroupNorm";
+
+            int num_groups = get_node_attr_i(node, "num_groups", 1);
+            float epsilon = get_node_attr_f(node, "epsilon", 1e-5f);
+
+            const onnx::TensorProto& scale = node.input_size() > 1 ? get_weight(weights, node.input(1)) : onnx::TensorProto::default_instance();
+            const onnx::TensorProto& B = node.input_size() > 2 ? get_weight(weights, node.input(2)) : onnx::TensorProto::default_instance();
+
+            // scale and bias were per group before opset 21, the layer takes them per channel
+            int channels = get_tensor_proto_data_size(scale);
+            int repeat = 1;
+            if (channels == num_groups && opset < 21)
+            {
+                channels = get_blob_channels(graph, node.input(0));
+                if (channels == 0 || channels % num_groups != 0)
+                {
+                    fprintf(stderr, "GroupNormalization %s channels unknown, per group scale kept\n", node.name().c_str());
+                    channels = num_groups;
+                }
+                repeat = channels / num_groups;
+            }
+
+            int affine = is_constant_fill(scale, 1.f) && is_constant_fill(B, 0.f) ? 0 : 1;
+
+            attributes += "0=" + std::to_string(num_groups);
+            attributes += " 1=" + std::to_string(channels);
+            attributes += " 2=" + float_attribute(epsilon);
+            attributes += " 3=" + std::to_string(affine);
+
+            if (affine)
+            {
+                ofstream_affine_data(scale, channels / repeat, repeat, 1.f, bofs);
+                ofstream_affine_data(B, channels / repeat, repeat, 0.f, bofs);
+            }
+        }
         else if (op == "adaptive_avg_pool2d" || op == "adaptive_max_pool2d")
         {
             tinyinfer_op_name = "Pooling";
@@ -1196,11 +2507,11 @@ int main(int argc, char** argv)
                 pool = 1;
             }
             int adaptive_pooling = 1;
-            const onnx::TensorProto& out_shape_tp = weights[node.input(1)];
+            const onnx::TensorProto& out_shape_tp = get_weight(weights, node.input(1));
             std::vector<int> out_shape = get_node_attr_from_input_ai(out_shape_tp);
 
             attributes += "0=" + std::to_string(pool);
-            attributes += " 7=" + std::to_string(pool);
+            attributes += " 7=" + std::to_string(adaptive_pooling);
             if (out_shape.size() == 1)
             {
                 attributes += " 8=" + std::to_string(out_shape[0]);
@@ -1225,11 +2536,67 @@ int main(int argc, char** argv)
         {
             tinyinfer_op_name = "HardSwish";
 
-            float alpha = get_node_attr_f(node, "alpha", 0.2f);
-            float beta = get_node_attr_f(node, "beta", 0.5f);
+            // onnx HardSwish has no attributes, x * HardSigmoid(x) with alpha 1/6 and beta 0.5
+            float alpha = 1.f / 6;
+            float beta = 0.5f;
             attributes += "0=" + std::to_string(alpha);
             attributes += " 1=" + std::to_string(beta);
         }
+        else if (op == "InstanceNormalization")
+        {
+            // https://github.com/onnx/onnx/blob/main/docs/Operators.md#InstanceNormalization
+            tinyinfer_op_name = "InstanceNorm";
+
+            float epsilon = get_node_attr_f(node, "epsilon", 1e-5f);
+
+            const onnx::TensorProto& scale = get_weight(weights, node.input(1));
+            const onnx::TensorProto& B = get_weight(weights, node.input(2));
+            int channels = get_tensor_proto_data_size(scale);
+
+            int affine = is_constant_fill(scale, 1.f) && is_constant_fill(B, 0.f) ? 0 : 1;
+
+            attributes += "0=" + std::to_string(channels);
+            attributes += " 1=" + float_attribute(epsilon);
+            attributes += " 2=" + std::to_string(affine);
+
+            if (affine)
+            {
+                ofstream_affine_data(scale, channels, 1, 1.f, bofs);
+                ofstream_affine_data(B, channels, 1, 0.f, bofs);
+            }
+        }
+        else if (op == "LayerNormalization")
+        {
+            // https://github.com/onnx/onnx/blob/main/docs/Operators.md#LayerNormalization
+            tinyinfer_op_name = "LayerNorm";
+
+            int axis = get_node_attr_i(node, "axis", -1);
+            float epsilon = get_node_attr_f(node, "epsilon", 1e-5f);
+            if (axis != -1)
+            {
+                fprintf(stderr, "LayerNormalization %s axis %d not supported yet, normalized over the last axis\n", node.name().c_str(), axis);
+            }
+
+            const onnx::TensorProto& scale = node.input_size() > 1 && !node.input(1).empty() ? get_weight(weights, node.input(1)) : onnx::TensorProto::default_instance();
+            const onnx::TensorProto& B = node.input_size() > 2 && !node.input(2).empty() ? get_weight(weights, node.input(2)) : onnx::TensorProto::default_instance();
+
+            // an absent scale or bias is the identity, the present one gives the row size
+            int affine_size = get_tensor_proto_data_size(scale);
+            if (affine_size == 0)
+                affine_size = get_tensor_proto_data_size(B);
+
+            int affine = affine_size > 0 && !(is_constant_fill(scale, 1.f) && is_constant_fill(B, 0.f)) ? 1 : 0;
+
+            attributes += "0=" + std::to_string(affine ? affine_size : 0);
+            attributes += " 1=" + float_attribute(epsilon);
+            attributes += " 2=" + std::to_string(affine);
+
+            if (affine)
+            {
+                ofstream_affine_data(scale, affine_size, 1, 1.f, bofs);
+                ofstream_affine_data(B, affine_size, 1, 0.f, bofs);
+            }
+        }
         else if (op == "Log")
         {
             tinyinfer_op_name = "UnaryOp";
@@ -1238,11 +2605,11 @@ int main(int argc, char** argv)
         }
         else if (op == "MatMul")
         {
-            if (weights.find(node.input(1)) != weights.end() && weights[node.input(1)].dims_size() == 2)
+            if (weights.find(node.input(1)) != weights.end() && get_weight(weights, node.input(1)).dims_size() == 2)
             {
                 tinyinfer_op_name = "InnerProduct";
 
-                const onnx::TensorProto& B = weights[node.input(1)];
+                const onnx::TensorProto& B = get_weight(weights, node.input(1));
                 int weight_data_size = get_tensor_proto_data_size(B);
                 int num_output = B.dims(B.dims_size() - 1);
                 int num_input = weight_data_size / num_output;
@@ -1250,18 +2617,23 @@ int main(int argc, char** argv)
                 attributes += "0=" + std::to_string(num_output);
                 attributes += " 1=0";
                 attributes += " 2=" + std::to_string(weight_data_size);
+                attributes += activation_attributes(node);
 
                 {
-                    const float* bptr = B.raw_data().size() ? (const float*)B.raw_data().data() : B.float_data().data();
+                    const float* bptr = get_tensor_proto_float_data(B);
 
+                    // transpose one output row at a time straight into the bin
+                    std::vector<float> row(num_input);
+                    ofstream_weight_tag(fp16, bofs);
                     for (int j = 0; j < num_output; j++)
                     {
                         for (int k = 0; k < num_input; k++)
                         {
-                            float vb = bptr[k * num_output + j];
-                            bofs.write((const char*)&vb, sizeof(float));
+                            row[k] = bptr[(size_t)k * num_output + j];
                         }
+                        ofstream_weight_data(row.data(), num_input, fp16, bofs);
                     }
+                    ofstream_weight_padding(weight_data_size, fp16, bofs);
                 }
             }
             else
@@ -1290,13 +2662,30 @@ int main(int argc, char** argv)
             int op_type = 2;
             attributes += "0=" + std::to_string(op_type);
         }
+        else if (op == "MultiHeadAttention")
+        {
+            // written by fuse_attention, q k v and the optional mask
+            tinyinfer_op_name = "MultiHeadAttention";
+
+            int num_heads = get_node_attr_i(node, "num_heads", 1);
+            float scale = get_node_attr_f(node, "scale", 1.f);
+
+            attributes += "0=" + std::to_string(num_heads);
+            attributes += " 1=" + float_attribute(scale);
+        }
         else if (op == "Pad")
         {
-            tinyinfer_op_name = "BinaryOp";
+            tinyinfer_op_name = "Padding";
 
             std::string mode = get_node_attr_s(node, "mode");
             float value = get_node_attr_f(node, "value", 0.f);
 
+            // pads and the constant value moved from the attributes to inputs 1 and 2 in opset 11
+            if (node.input_size() > 2 && !node.input(2).empty())
+            {
+                value = get_node_attr_from_input_f(get_weight(weights, node.input(2)));
+            }
+
             std::vector<int> pads;
             if (node.input_size() == 1)
             {
@@ -1304,7 +2693,7 @@ int main(int argc, char** argv)
             }
             else
             {
-                pads = get_node_attr_from_input_ai(weights[node.input(1)]);
+                pads = get_node_attr_from_input_ai(get_weight(weights, node.input(1)));
             }
 
             int type = 0;
@@ -1359,12 +2748,12 @@ int main(int argc, char** argv)
             attributes += " 3=" + std::to_string(right);
             attributes += " 4=" + std::to_string(type);
             attributes += " 5=" + std::to_string(value);
-            attributes += " 6=" + std::to_string(front);
-            attributes += " 7=" + std::to_string(behind);
+            attributes += " 7=" + std::to_string(front);
+            attributes += " 8=" + std::to_string(behind);
         }
         else if (op == "Relu")
         {
-            tinyinfer_op_name = "RelU";
+            tinyinfer_op_name = "ReLU";
         }
         else if (op == "Reshape")
         {
@@ -1378,7 +2767,7 @@ int main(int argc, char** argv)
             }
             else
             {
-                shape = get_node_attr_from_input_ai(weights[node.input(1)]);
+                shape = get_node_attr_from_input_ai(get_weight(weights, node.input(1)));
             }
 
             if (shape.size() == 1)
@@ -1414,15 +2803,16 @@ int main(int argc, char** argv)
         else if (op == "Softmax")
         {
             tinyinfer_op_name = "Softmax";
-            int axis = get_node_attr_i(node, "axis", 1);
-            attributes += "0=" + std::to_string(axis - 1);
-            attributes += " 1=1";
+            // the default axis moved from 1 to the last one in opset 13, negative axes count from the end either way
+            int axis = get_node_attr_i(node, "axis", opset >= 13 ? -1 : 1);
+            attributes += "0=" + std::to_string(axis > 0 ? axis - 1 : axis);
         }
         else if (op == "Squeeze")
         {
             tinyinfer_op_name = "Squeeze";
-            
-            std::vector<int> axes = get_node_attr_ai(node, "axes");
+
+            // axes moved from the attribute to the second input in opset 13
+            std::vector<int> axes = node.input_size() > 1 ? get_node_attr_from_input_ai(get_weight(weights, node.input(1))) : get_node_attr_ai(node, "axes");
             if (axes.empty())
             {
                 attributes += "0=1 1=1 2=1";
@@ -1440,9 +2830,13 @@ int main(int argc, char** argv)
         }
         else if (op == "Sum")
         {
-            tinyinfer_op_name = "Sum";
+            tinyinfer_op_name = "BinaryOp";
+
+            // BinaryOp adds two blobs
+            if (input_size != 2)
+                fprintf(stderr, "Unsupported Sum of %d inputs !\n", input_size);
 
-            int op_type = 1;
+            int op_type = 0;
             attributes += "0=" + std::to_string(op_type);
         }
         else if (op == "Swish")
@@ -1452,14 +2846,96 @@ int main(int argc, char** argv)
         else if (op == "Transpose")
         {
             tinyinfer_op_name = "Permute";
+
+            // the default perm reverses every axis, the batch one included
+            std::vector<int> perm = get_node_attr_ai(node, "perm");
+            if (perm.empty())
+            {
+                fprintf(stderr, "Unsupported transpose without perm !\n");
+            }
+
+            const int order_type = permute_order_type(perm);
+            if (order_type == -1)
+            {
+                fprintf(stderr, "Unsupported transpose perm !\n");
+            }
+
+            attributes += "0=" + std::to_string(order_type == -1 ? 0 : order_type);
         }
         else if (op == "Upsample" || op == "Resize")
         {
             tinyinfer_op_name = "Interp";
+
+            std::string mode = get_node_attr_s(node, "mode", "nearest");
+            std::string coordinate_transformation_mode = get_node_attr_s(node, "coordinate_transformation_mode", "half_pixel");
+
+            // nchw scales or sizes, Upsample and Resize-10 take scales as input 1, Resize-11 takes roi, scales and sizes
+            std::vector<float> scales;
+            std::vector<int> sizes;
+            if (op == "Upsample" && node.input_size() == 1)
+            {
+                scales = get_node_attr_af(node, "scales");
+            }
+            else if (node.input_size() == 2)
+            {
+                const onnx::TensorProto& tp = get_weight(weights, node.input(1));
+                const float* ptr = get_tensor_proto_float_data(tp);
+                scales.assign(ptr, ptr + get_tensor_proto_data_size(tp));
+            }
+            else
+            {
+                if (node.input_size() > 2 && !node.input(2).empty())
+                {
+                    const onnx::TensorProto& tp = get_weight(weights, node.input(2));
+                    const float* ptr = get_tensor_proto_float_data(tp);
+                    scales.assign(ptr, ptr + get_tensor_proto_data_size(tp));
+                }
+                if (node.input_size() > 3 && !node.input(3).empty())
+                {
+                    sizes = get_node_attr_from_input_ai(get_weight(weights, node.input(3)));
+                }
+            }
+
+            int resize_type = 1;
+            if (mode == "linear" || mode == "bilinear")
+                resize_type = 2;
+            else if (mode == "cubic")
+                resize_type = 3;
+            else if (mode != "nearest")
+                fprintf(stderr, "Unsupported %s mode %s !\n", op.c_str(), mode.c_str());
+
+            attributes += "0=" + std::to_string(resize_type);
+            if (sizes.size() == 4)
+            {
+                attributes += " 3=" + std::to_string(sizes[2]);
+                attributes += " 4=" + std::to_string(sizes[3]);
+            }
+            else if (scales.size() == 4)
+            {
+                attributes += " 1=" + std::to_string(scales[2]);
+                attributes += " 2=" + std::to_string(scales[3]);
+            }
+            else
+            {
+                fprintf(stderr, "Unsupported %s without constant nchw scales or sizes !\n", op.c_str());
+            }
+
+            if (coordinate_transformation_mode == "align_corners")
+                attributes += " 6=1";
         }
         else if (op == "Unsqueeze")
         {
             tinyinfer_op_name = "ExpandDims";
+
+            // positions in the output, negative ones count from its end
+            std::vector<int> axes = node.input_size() > 1 ? get_node_attr_from_input_ai(get_weight(weights, node.input(1))) : get_node_attr_ai(node, "axes");
+            attributes += "-23303=" + std::to_string(axes.size());
+            for (int i = 0; i < (int)axes.size(); i++)
+            {
+                if (axes[i] == 0 || axes[i] > 4 || axes[i] < -4)
+                    fprintf(stderr, "Unsupported unsqueeze axes !\n");
+                attributes += "," + std::to_string(axes[i] > 0 ? axes[i] - 1 : axes[i]);
+            }
         }
         else
         {
@@ -1486,8 +2962,8 @@ int main(int argc, char** argv)
                 std::string split_suffix = "_split_" + std::to_string(refidx);
                 input_name = input_name + split_suffix;
             }
+            if (!input_names.empty()) input_names += " ";
             input_names += input_name;
-            if (j < input_size - 1) input_names += " ";
         }
 
 
@@ -0,0 +1,504 @@
+// int8 post training quantization calibration
+// per output channel weight scales come from the loaded layers, activation scales from
+// kl-divergence or percentile thresholds over the bottom blobs the net computes for a representative image set
+#include "convolution.h"
+#include "innerproduct.h"
+#include "mat.h"
+#include "net.h"
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class QuantBlobStat
+{
+public:
+    QuantBlobStat()
+        : absmax(0.f), histogram(2048, 0.f)
+    {
+    }
+
+    // pass 1, absolute max over all images
+    void update_absmax(const tinyinfer::Mat& m)
+    {
+        int size = m.w * m.h * m.d;
+        for (int q = 0; q < m.c; q++)
+        {
+            const float* ptr = m.channel(q);
+            for (int i = 0; i < size; i++)
+            {
+                absmax = std::max(absmax, fabsf(ptr[i]));
+            }
+        }
+    }
+
+    // pass 2, histogram of absolute values in [0, absmax]
+    void update_histogram(const tinyinfer::Mat& m)
+    {
+        if (absmax == 0.f)
+            return;
+
+        const int num_bins = (int)histogram.size();
+        const float bin_scale = num_bins / absmax;
+
+        int size = m.w * m.h * m.d;
+        for (int q = 0; q < m.c; q++)
+        {
+            const float* ptr = m.channel(q);
+            for (int i = 0; i < size; i++)
+            {
+                if (ptr[i] == 0.f)
+                    continue;
+
+                int index = std::min((int)(fabsf(ptr[i]) * bin_scale), num_bins - 1);
+                histogram[index] += 1.f;
+            }
+        }
+    }
+
+    // threshold minimizing kl(P||Q) between the clipped and the 128 bins quantized distribution
+    float threshold_kl() const
+    {
+        const int num_bins = (int)histogram.size();
+        const int target_bins = 128;
+
+        std::vector<float> hist = normalized_histogram();
+
+        int target_threshold = num_bins - 1;
+        float kl_min = FLT_MAX;
+        for (int threshold = target_bins; threshold < num_bins; threshold++)
+        {
+            // reference distribution, outliers are folded into the last bin
+            const float kl_eps = 0.0001f;
+            std::vector<float> clip_distribution(threshold, kl_eps);
+            for (int i = 0; i < threshold; i++)
+            {
+                clip_distribution[i] += hist[i];
+            }
+            for (int i = threshold; i < num_bins; i++)
+            {
+                clip_distribution[threshold - 1] += hist[i];
+            }
+
+            // merge into target_bins, then spread back over the non-empty source bins
+            const float num_per_bin = (float)threshold / target_bins;
+
+            std::vector<float> quantize_distribution(target_bins, 0.f);
+            for (int i = 0; i < target_bins; i++)
+            {
+                const float start = i * num_per_bin;
+                const float end = start + num_per_bin;
+
+                const int left_upper = (int)ceilf(start);
+                if (left_upper > start)
+                {
+                    quantize_distribution[i] += (left_upper - start) * hist[left_upper - 1];
+                }
+
+                const int right_lower = (int)floorf(end);
+                if (right_lower < end)
+                {
+                    quantize_distribution[i] += (end - right_lower) * hist[right_lower];
+                }
+
+                for (int j = left_upper; j < right_lower; j++)
+                {
+                    quantize_distribution[i] += hist[j];
+                }
+            }
+
+            std::vector<float> expand_distribution(threshold, 0.f);
+            for (int i = 0; i < target_bins; i++)
+            {
+                const float start = i * num_per_bin;
+                const float end = start + num_per_bin;
+
+                float count = 0.f;
+
+                const int left_upper = (int)ceilf(start);
+                const float left_scale = left_upper > start ? left_upper - start : 0.f;
+                if (left_scale > 0.f && hist[left_upper - 1] != 0.f)
+                    count += left_scale;
+
+                const int right_lower = (int)floorf(end);
+                const float right_scale = right_lower < end ? end - right_lower : 0.f;
+                if (right_scale > 0.f && hist[right_lower] != 0.f)
+                    count += right_scale;
+
+                for (int j = left_upper; j < right_lower; j++)
+                {
+                    if (hist[j] != 0.f)
+                        count += 1.f;
+                }
+
+                if (count == 0.f)
+                    continue;
+
+                const float expand_value = quantize_distribution[i] / count;
+
+                if (left_scale > 0.f && hist[left_upper - 1] != 0.f)
+                    expand_distribution[left_upper - 1] += expand_value * left_scale;
+
+                if (right_scale > 0.f && hist[right_lower] != 0.f)
+                    expand_distribution[right_lower] += expand_value * right_scale;
+
+                for (int j = left_upper; j < right_lower; j++)
+                {
+                    if (hist[j] != 0.f)
+                        expand_distribution[j] += expand_value;
+                }
+            }
+
+            float kl = kl_divergence(clip_distribution, expand_distribution);
+            if (kl < kl_min)
+            {
+                kl_min = kl;
+                target_threshold = threshold;
+            }
+        }
+
+        return (target_threshold + 0.5f) * absmax / num_bins;
+    }
+
+    // smallest threshold covering the given fraction of values
+    float threshold_percentile(float percentile) const
+    {
+        const int num_bins = (int)histogram.size();
+
+        std::vector<float> hist = normalized_histogram();
+
+        float acc = 0.f;
+        for (int i = 0; i < num_bins; i++)
+        {
+            acc += hist[i];
+            if (acc >= percentile)
+                return (i + 0.5f) * absmax / num_bins;
+        }
+
+        return absmax;
+    }
+
+private:
+    std::vector<float> normalized_histogram() const
+    {
+        float sum = 0.f;
+        for (size_t i = 0; i < histogram.size(); i++)
+        {
+            sum += histogram[i];
+        }
+
+        std::vector<float> hist(histogram.size(), 0.f);
+        if (sum == 0.f)
+            return hist;
+
+        for (size_t i = 0; i < histogram.size(); i++)
+        {
+            hist[i] = histogram[i] / sum;
+        }
+
+        return hist;
+    }
+
+    static float kl_divergence(const std::vector<float>& p, const std::vector<float>& q)
+    {
+        float psum = 0.f;
+        float qsum = 0.f;
+        for (size_t i = 0; i < p.size(); i++)
+        {
+            psum += p[i];
+            qsum += q[i];
+        }
+
+        float kl = 0.f;
+        for (size_t i = 0; i < p.size(); i++)
+        {
+            float pi = p[i] / psum;
+            float qi = q[i] / qsum;
+            if (pi == 0.f)
+                continue;
+
+            kl += pi * logf(pi / std::max(qi, 1e-10f));
+        }
+
+        return kl;
+    }
+
+public:
+    float absmax;
+    std::vector<float> histogram;
+};
+
+struct QuantLayer
+{
+    std::string name;
+    int bottom;
+    std::vector<float> weight_scales;
+};
+
+static std::vector<float> parse_floats(const char* s)
+{
+    std::vector<float> v;
+    while (*s)
+    {
+        char* end = 0;
+        float f = strtof(s, &end);
+        if (end == s)
+            break;
+        v.push_back(f);
+        s = *end == ',' ? end + 1 : end;
+    }
+    return v;
+}
+
+// per output channel 127 / absmax
+static std::vector<float> compute_weight_scales(const tinyinfer::Mat& weight_data, int num_output)
+{
+    std::vector<float> scales(num_output, 1.f);
+
+    const int size = weight_data.w / num_output;
+    for (int n = 0; n < num_output; n++)
+    {
+        const float* ptr = (const float*)weight_data.data + (size_t)n * size;
+
+        float absmax = 0.f;
+        for (int i = 0; i < size; i++)
+        {
+            absmax = std::max(absmax, fabsf(ptr[i]));
+        }
+
+        scales[n] = absmax == 0.f ? 1.f : 127 / absmax;
+    }
+
+    return scales;
+}
+
+// Convolution, ConvolutionDepthWise and InnerProduct with the blob they read after the net folded its graph
+static int collect_quant_layers(const tinyinfer::Net& net, std::vector<QuantLayer>& layers)
+{
+    const std::vector<tinyinfer::Layer*>& net_layers = net.layers();
+    for (size_t i = 0; i < net_layers.size(); i++)
+    {
+        const tinyinfer::Layer* layer = net_layers[i];
+
+        const tinyinfer::Mat* weight_data = 0;
+        int num_output = 0;
+        if (layer->typeindex == tinyinfer::LayerType::Convolution || layer->typeindex == tinyinfer::LayerType::ConvolutionDepthWise)
+        {
+            const tinyinfer::Convolution* convolution = (const tinyinfer::Convolution*)layer;
+            weight_data = &convolution->weight_data;
+            num_output = convolution->num_output;
+        }
+        else if (layer->typeindex == tinyinfer::LayerType::InnerProduct)
+        {
+            const tinyinfer::InnerProduct* innerproduct = (const tinyinfer::InnerProduct*)layer;
+            weight_data = &innerproduct->weight_data;
+            num_output = innerproduct->num_output;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (weight_data->empty() || num_output <= 0)
+        {
+            fprintf(stderr, "weight of %s not loaded\n", layer->name.c_str());
+            return -1;
+        }
+
+        QuantLayer quant_layer;
+        quant_layer.name = layer->name;
+        quant_layer.bottom = layer->bottoms[0];
+        quant_layer.weight_scales = compute_weight_scales(*weight_data, num_output);
+        layers.push_back(quant_layer);
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 5)
+    {
+        fprintf(stderr, "Usage: %s [param] [bin] [imagelist] [table] [key=value...]\n", argv[0]);
+        fprintf(stderr, "  mean=104.0,117.0,123.0\n");
+        fprintf(stderr, "  norm=1.0,1.0,1.0\n");
+        fprintf(stderr, "  shape=224,224\n");
+        fprintf(stderr, "  pixel=BGR\n");
+        fprintf(stderr, "  method=kl (or percentile)\n");
+        fprintf(stderr, "  percentile=0.9999\n");
+        return -1;
+    }
+
+    const char* parampath = argv[1];
+    const char* binpath = argv[2];
+    const char* listpath = argv[3];
+    const char* tablepath = argv[4];
+
+    std::vector<float> mean_vals;
+    std::vector<float> norm_vals;
+    std::vector<float> shape;
+    std::string pixel = "BGR";
+    std::string method = "kl";
+    float percentile = 0.9999f;
+    for (int i = 5; i < argc; i++)
+    {
+        const char* kv = argv[i];
+        const char* eq = strchr(kv, '=');
+        if (!eq)
+        {
+            fprintf(stderr, "unrecognized arg %s\n", kv);
+            continue;
+        }
+
+        std::string key(kv, eq - kv);
+        const char* value = eq + 1;
+        if (key == "mean")
+            mean_vals = parse_floats(value);
+        else if (key == "norm")
+            norm_vals = parse_floats(value);
+        else if (key == "shape")
+            shape = parse_floats(value);
+        else if (key == "pixel")
+            pixel = value;
+        else if (key == "method")
+            method = value;
+        else if (key == "percentile")
+            percentile = (float)atof(value);
+        else
+            fprintf(stderr, "unrecognized arg %s\n", kv);
+    }
+
+    // the layers keep their weights next to the packed ones and every computed blob stays in the extractor
+    tinyinfer::Net net;
+    net.opt.lightmode = false;
+    if (net.load_param(parampath) != 0 || net.load_model(binpath) != 0)
+    {
+        fprintf(stderr, "load %s %s failed\n", parampath, binpath);
+        return -1;
+    }
+
+    if (net.input_indexes().empty())
+    {
+        fprintf(stderr, "no Input layer in %s\n", parampath);
+        return -1;
+    }
+
+    std::vector<QuantLayer> layers;
+    if (collect_quant_layers(net, layers) != 0)
+        return -1;
+
+    std::vector<std::string> imagepaths;
+    {
+        FILE* lfp = fopen(listpath, "rb");
+        if (!lfp)
+        {
+            fprintf(stderr, "open %s failed\n", listpath);
+            return -1;
+        }
+
+        char line[1024];
+        while (fgets(line, sizeof(line), lfp))
+        {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] != '\0')
+                imagepaths.push_back(line);
+        }
+        fclose(lfp);
+    }
+
+    // one statistic per distinct bottom blob, layers reading the same blob share it
+    std::map<int, QuantBlobStat> blob_stats;
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        blob_stats[layers[i].bottom] = QuantBlobStat();
+    }
+
+    const int input_index = net.input_indexes()[0];
+    for (int pass = 0; pass < 2 && !blob_stats.empty(); pass++)
+    {
+        for (size_t i = 0; i < imagepaths.size(); i++)
+        {
+            cv::Mat bgr = cv::imread(imagepaths[i], cv::IMREAD_COLOR);
+            if (bgr.empty())
+            {
+                fprintf(stderr, "cv::imread %s failed\n", imagepaths[i].c_str());
+                continue;
+            }
+
+            if (shape.size() >= 2)
+                cv::resize(bgr, bgr, cv::Size((int)shape[0], (int)shape[1]));
+
+            if (pixel == "RGB")
+                cv::cvtColor(bgr, bgr, cv::COLOR_BGR2RGB);
+
+            int type = pixel == "RGB" ? tinyinfer::Mat::PIXEL_RGB : tinyinfer::Mat::PIXEL_BGR;
+            tinyinfer::Mat in = tinyinfer::Mat::from_pixels(bgr.data, type, bgr.cols, bgr.rows, (int)bgr.step[0]);
+            in.substract_mean_normalize(mean_vals.empty() ? 0 : mean_vals.data(), norm_vals.empty() ? 0 : norm_vals.data());
+
+            // the blobs computed for one bottom are reused by the later ones
+            tinyinfer::Extractor ex = net.create_extractor();
+            ex.input(input_index, in);
+
+            for (std::map<int, QuantBlobStat>::iterator it = blob_stats.begin(); it != blob_stats.end(); ++it)
+            {
+                tinyinfer::Mat blob;
+                if (ex.extract(it->first, blob) != 0)
+                {
+                    fprintf(stderr, "extract %s for %s failed\n", net.blobs()[it->first].name.c_str(), imagepaths[i].c_str());
+                    return -1;
+                }
+
+                if (pass == 0)
+                    it->second.update_absmax(blob);
+                else
+                    it->second.update_histogram(blob);
+            }
+        }
+    }
+
+    FILE* tfp = fopen(tablepath, "wb");
+    if (!tfp)
+    {
+        fprintf(stderr, "open %s failed\n", tablepath);
+        return -1;
+    }
+
+    // [layer]_param_0 [per output channel weight scales]
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        fprintf(tfp, "%s_param_0", layers[i].name.c_str());
+        for (size_t j = 0; j < layers[i].weight_scales.size(); j++)
+        {
+            fprintf(tfp, " %f", layers[i].weight_scales[j]);
+        }
+        fprintf(tfp, "\n");
+    }
+
+    // [layer] [bottom blob scale]
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        std::map<int, QuantBlobStat>::const_iterator it = blob_stats.find(layers[i].bottom);
+        if (it == blob_stats.end() || it->second.absmax == 0.f)
+        {
+            fprintf(stderr, "%s bottom blob %s not calibrated\n", layers[i].name.c_str(), net.blobs()[layers[i].bottom].name.c_str());
+            continue;
+        }
+
+        float threshold = method == "percentile" ? it->second.threshold_percentile(percentile) : it->second.threshold_kl();
+        float scale = 127 / threshold;
+
+        fprintf(stderr, "%-24s absmax = %f threshold = %f scale = %f\n", layers[i].name.c_str(), it->second.absmax, threshold, scale);
+        fprintf(tfp, "%s %f\n", layers[i].name.c_str(), scale);
+    }
+
+    fclose(tfp);
+
+    return 0;
+}